@@ -0,0 +1,537 @@
+/* GStreamer
+ *
+ * gstsrtp.c: SRTP/SRTCP packet transforms (RFC 3711)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/* Implements the AES_CM_128_HMAC_SHA1_80 and AES_CM_128_HMAC_SHA1_32 crypto
+ * suites with a key derivation rate of 0. All transforms work in place on the
+ * packet data, only the authentication tag (and the SRTCP index) is written
+ * to separate memory so that the caller can append it without copying the
+ * packet.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <string.h>
+
+#include <nettle/ctr.h>
+
+#include "gstsrtp.h"
+#include "gstsrtpenc.h"
+#include "gstsrtpdec.h"
+
+/* key derivation labels, RFC 3711 section 4.3.1 */
+#define LABEL_RTP_ENCRYPTION   0x00
+#define LABEL_RTCP_ENCRYPTION  0x03
+
+GType
+gst_srtp_auth_get_type (void)
+{
+  static volatile gsize auth_type = 0;
+  static const GEnumValue auth[] = {
+    {GST_SRTP_AUTH_HMAC_SHA1_80, "HMAC-SHA1 with an 80 bits tag",
+        "hmac-sha1-80"},
+    {GST_SRTP_AUTH_HMAC_SHA1_32, "HMAC-SHA1 with a 32 bits tag",
+        "hmac-sha1-32"},
+    {0, NULL, NULL},
+  };
+
+  if (g_once_init_enter (&auth_type)) {
+    GType tmp = g_enum_register_static ("GstSrtpAuth", auth);
+    g_once_init_leave (&auth_type, tmp);
+  }
+  return (GType) auth_type;
+}
+
+/* AES in counter mode, the IV is (salt << 16) ^ (ssrc << 64) ^ (index << 16) */
+static void
+aes_cm (GstSrtpSessionKeys * keys, guint32 ssrc, guint64 index, guint8 * data,
+    gsize len)
+{
+  guint8 iv[AES_BLOCK_SIZE];
+
+  memcpy (iv, keys->salt, GST_SRTP_MASTER_SALT_LEN);
+  iv[14] = iv[15] = 0;
+
+  iv[4] ^= ssrc >> 24;
+  iv[5] ^= ssrc >> 16;
+  iv[6] ^= ssrc >> 8;
+  iv[7] ^= ssrc;
+
+  iv[8] ^= index >> 40;
+  iv[9] ^= index >> 32;
+  iv[10] ^= index >> 24;
+  iv[11] ^= index >> 16;
+  iv[12] ^= index >> 8;
+  iv[13] ^= index;
+
+  ctr_crypt (&keys->aes, (nettle_crypt_func *) aes_encrypt, AES_BLOCK_SIZE,
+      iv, len, data, data);
+}
+
+static void
+derive_key (struct aes_ctx *master, const guint8 * master_salt, guint8 label,
+    guint8 * out, guint len)
+{
+  guint8 iv[AES_BLOCK_SIZE];
+
+  /* key_id = label || r with r = 0, aligned right in the salt */
+  memcpy (iv, master_salt, GST_SRTP_MASTER_SALT_LEN);
+  iv[7] ^= label;
+  iv[14] = iv[15] = 0;
+
+  memset (out, 0, len);
+  ctr_crypt (master, (nettle_crypt_func *) aes_encrypt, AES_BLOCK_SIZE, iv,
+      len, out, out);
+}
+
+static void
+derive_session_keys (struct aes_ctx *master, const guint8 * master_salt,
+    guint8 label, GstSrtpSessionKeys * keys)
+{
+  guint8 enc[GST_SRTP_MASTER_KEY_LEN];
+  guint8 auth[GST_SRTP_AUTH_KEY_LEN];
+
+  derive_key (master, master_salt, label, enc, sizeof (enc));
+  aes_set_encrypt_key (&keys->aes, sizeof (enc), enc);
+
+  derive_key (master, master_salt, label + 1, auth, sizeof (auth));
+  hmac_sha1_set_key (&keys->hmac, sizeof (auth), auth);
+
+  derive_key (master, master_salt, label + 2, keys->salt, sizeof (keys->salt));
+
+  memset (enc, 0, sizeof (enc));
+  memset (auth, 0, sizeof (auth));
+}
+
+/**
+ * gst_srtp_stream_new:
+ * @ssrc: the SSRC of the stream
+ * @key: %GST_SRTP_KEY_LEN bytes of master key followed by the master salt
+ *
+ * Derive the RTP and RTCP session keys of a new stream.
+ *
+ * Returns: a new #GstSrtpStream or %NULL when @key has the wrong size.
+ */
+GstSrtpStream *
+gst_srtp_stream_new (guint32 ssrc, GstBuffer * key)
+{
+  GstSrtpStream *stream;
+  struct aes_ctx master;
+  guint8 data[GST_SRTP_KEY_LEN];
+
+  if (gst_buffer_get_size (key) != GST_SRTP_KEY_LEN)
+    return NULL;
+  gst_buffer_extract (key, 0, data, GST_SRTP_KEY_LEN);
+
+  stream = g_slice_new0 (GstSrtpStream);
+  stream->ssrc = ssrc;
+
+  aes_set_encrypt_key (&master, GST_SRTP_MASTER_KEY_LEN, data);
+  derive_session_keys (&master, data + GST_SRTP_MASTER_KEY_LEN,
+      LABEL_RTP_ENCRYPTION, &stream->rtp);
+  derive_session_keys (&master, data + GST_SRTP_MASTER_KEY_LEN,
+      LABEL_RTCP_ENCRYPTION, &stream->rtcp);
+  memset (&master, 0, sizeof (master));
+  memset (data, 0, sizeof (data));
+
+  return stream;
+}
+
+void
+gst_srtp_stream_free (GstSrtpStream * stream)
+{
+  memset (stream, 0, sizeof (GstSrtpStream));
+  g_slice_free (GstSrtpStream, stream);
+}
+
+/* RTP and RTCP can be told apart by the payload type, RFC 5761 */
+gboolean
+gst_srtp_is_rtcp (const guint8 * data, gsize size)
+{
+  return size >= 2 && data[1] >= 192 && data[1] <= 223;
+}
+
+gboolean
+gst_srtp_get_ssrc (const guint8 * data, gsize size, guint32 * ssrc)
+{
+  if (gst_srtp_is_rtcp (data, size)) {
+    if (size < 8)
+      return FALSE;
+    *ssrc = GST_READ_UINT32_BE (data + 4);
+  } else {
+    if (size < 12)
+      return FALSE;
+    *ssrc = GST_READ_UINT32_BE (data + 8);
+  }
+  return TRUE;
+}
+
+static gboolean
+get_rtp_header_len (const guint8 * data, gsize size, guint * len)
+{
+  guint hlen;
+
+  if (size < 12 || (data[0] >> 6) != 2)
+    return FALSE;
+
+  hlen = 12 + (data[0] & 0x0f) * 4;
+  if (data[0] & 0x10) {
+    if (size < hlen + 4)
+      return FALSE;
+    hlen += 4 + GST_READ_UINT16_BE (data + hlen + 2) * 4;
+  }
+  if (size < hlen)
+    return FALSE;
+
+  *len = hlen;
+  return TRUE;
+}
+
+/* guess the rollover counter of @seq, RFC 3711 appendix A */
+static guint64
+estimate_index (GstSrtpStream * stream, guint16 seq, guint32 * v)
+{
+  if (!stream->have_seq) {
+    *v = stream->roc;
+  } else if (stream->s_l < 32768) {
+    if ((gint) seq - (gint) stream->s_l > 32768)
+      *v = stream->roc > 0 ? stream->roc - 1 : 0;
+    else
+      *v = stream->roc;
+  } else {
+    if ((gint) stream->s_l - 32768 > (gint) seq)
+      *v = stream->roc + 1;
+    else
+      *v = stream->roc;
+  }
+  return ((guint64) * v << 16) | seq;
+}
+
+static void
+update_index (GstSrtpStream * stream, guint16 seq, guint32 v)
+{
+  if (!stream->have_seq) {
+    stream->have_seq = TRUE;
+    stream->roc = v;
+    stream->s_l = seq;
+  } else if (v == stream->roc + 1) {
+    stream->roc = v;
+    stream->s_l = seq;
+  } else if (v == stream->roc && seq > stream->s_l) {
+    stream->s_l = seq;
+  }
+}
+
+static gboolean
+replay_check (GstSrtpReplay * replay, guint64 index)
+{
+  guint64 delta;
+
+  if (!replay->valid || index > replay->max_index)
+    return TRUE;
+
+  delta = replay->max_index - index;
+  if (delta >= GST_SRTP_REPLAY_WINDOW)
+    return FALSE;
+
+  return (replay->bitmap & (G_GUINT64_CONSTANT (1) << delta)) == 0;
+}
+
+static void
+replay_update (GstSrtpReplay * replay, guint64 index)
+{
+  guint64 delta;
+
+  if (!replay->valid) {
+    replay->valid = TRUE;
+    replay->max_index = index;
+    replay->bitmap = 1;
+  } else if (index > replay->max_index) {
+    delta = index - replay->max_index;
+    replay->bitmap = delta >= GST_SRTP_REPLAY_WINDOW ? 0 :
+        replay->bitmap << delta;
+    replay->bitmap |= 1;
+    replay->max_index = index;
+  } else {
+    replay->bitmap |= G_GUINT64_CONSTANT (1) << (replay->max_index - index);
+  }
+}
+
+static void
+compute_tag (GstSrtpSessionKeys * keys, const guint8 * data, gsize size,
+    const guint8 * extra, guint extra_len, guint8 * tag, guint tag_len)
+{
+  hmac_sha1_update (&keys->hmac, size, data);
+  if (extra_len)
+    hmac_sha1_update (&keys->hmac, extra_len, extra);
+  /* also resets the context to the keyed state for the next packet */
+  hmac_sha1_digest (&keys->hmac, tag_len, tag);
+}
+
+static gboolean
+tag_equal (const guint8 * a, const guint8 * b, guint len)
+{
+  guint8 diff = 0;
+  guint i;
+
+  /* don't leak the position of the first mismatch */
+  for (i = 0; i < len; i++)
+    diff |= a[i] ^ b[i];
+
+  return diff == 0;
+}
+
+/**
+ * gst_srtp_protect_rtp:
+ * @stream: the stream of the packet
+ * @data: the RTP packet
+ * @size: the size of @data
+ * @tag: location of @tag_len bytes for the authentication tag
+ * @tag_len: the length of the authentication tag
+ *
+ * Encrypt the payload of the RTP packet in @data in place and compute the
+ * authentication tag that has to be appended to it.
+ */
+GstSrtpResult
+gst_srtp_protect_rtp (GstSrtpStream * stream, guint8 * data, gsize size,
+    guint8 * tag, guint tag_len)
+{
+  guint8 roc[4];
+  guint64 index;
+  guint hlen;
+  guint32 v;
+  guint16 seq;
+
+  if (!get_rtp_header_len (data, size, &hlen))
+    return GST_SRTP_INVALID;
+
+  seq = GST_READ_UINT16_BE (data + 2);
+  index = estimate_index (stream, seq, &v);
+  update_index (stream, seq, v);
+
+  aes_cm (&stream->rtp, stream->ssrc, index, data + hlen, size - hlen);
+
+  GST_WRITE_UINT32_BE (roc, v);
+  compute_tag (&stream->rtp, data, size, roc, 4, tag, tag_len);
+
+  return GST_SRTP_OK;
+}
+
+/**
+ * gst_srtp_unprotect_rtp:
+ * @stream: the stream of the packet
+ * @data: the SRTP packet
+ * @size: the size of @data, including the tag
+ * @tag_len: the length of the authentication tag
+ *
+ * Authenticate the SRTP packet in @data, check it against the replay window
+ * and decrypt it in place. On success the first @size - @tag_len bytes of
+ * @data contain the RTP packet.
+ */
+GstSrtpResult
+gst_srtp_unprotect_rtp (GstSrtpStream * stream, guint8 * data, gsize size,
+    guint tag_len)
+{
+  guint8 roc[4], tag[SHA1_DIGEST_SIZE];
+  guint64 index;
+  guint hlen;
+  guint32 v;
+  guint16 seq;
+
+  if (size < tag_len)
+    return GST_SRTP_INVALID;
+  size -= tag_len;
+
+  if (!get_rtp_header_len (data, size, &hlen))
+    return GST_SRTP_INVALID;
+
+  seq = GST_READ_UINT16_BE (data + 2);
+  index = estimate_index (stream, seq, &v);
+
+  if (!replay_check (&stream->rtp_replay, index))
+    return GST_SRTP_REPLAYED;
+
+  GST_WRITE_UINT32_BE (roc, v);
+  compute_tag (&stream->rtp, data, size, roc, 4, tag, tag_len);
+  if (!tag_equal (tag, data + size, tag_len))
+    return GST_SRTP_AUTH_FAILED;
+
+  aes_cm (&stream->rtp, stream->ssrc, index, data + hlen, size - hlen);
+
+  update_index (stream, seq, v);
+  replay_update (&stream->rtp_replay, index);
+
+  return GST_SRTP_OK;
+}
+
+/**
+ * gst_srtp_protect_rtcp:
+ * @stream: the stream of the packet
+ * @data: the compound RTCP packet
+ * @size: the size of @data
+ * @trailer: location of %GST_SRTCP_TRAILER_LEN + %GST_SRTCP_TAG_LEN bytes
+ *
+ * Encrypt the compound RTCP packet in @data in place and compute the SRTCP
+ * index and authentication tag that have to be appended to it.
+ */
+GstSrtpResult
+gst_srtp_protect_rtcp (GstSrtpStream * stream, guint8 * data, gsize size,
+    guint8 * trailer)
+{
+  guint32 index;
+
+  if (size < 8)
+    return GST_SRTP_INVALID;
+
+  index = stream->rtcp_index;
+  stream->rtcp_index = (stream->rtcp_index + 1) & 0x7fffffff;
+
+  /* the first header and the sender SSRC stay in the clear */
+  aes_cm (&stream->rtcp, stream->ssrc, index, data + 8, size - 8);
+
+  GST_WRITE_UINT32_BE (trailer, 0x80000000 | index);
+  compute_tag (&stream->rtcp, data, size, trailer, GST_SRTCP_TRAILER_LEN,
+      trailer + GST_SRTCP_TRAILER_LEN, GST_SRTCP_TAG_LEN);
+
+  return GST_SRTP_OK;
+}
+
+/**
+ * gst_srtp_unprotect_rtcp:
+ * @stream: the stream of the packet
+ * @data: the SRTCP packet
+ * @size: the size of @data, including the index and the tag
+ *
+ * Authenticate and decrypt the SRTCP packet in @data in place. On success the
+ * first @size - %GST_SRTCP_TRAILER_LEN - %GST_SRTCP_TAG_LEN bytes of @data
+ * contain the compound RTCP packet.
+ */
+GstSrtpResult
+gst_srtp_unprotect_rtcp (GstSrtpStream * stream, guint8 * data, gsize size)
+{
+  guint8 tag[SHA1_DIGEST_SIZE];
+  guint32 e_index, index;
+
+  if (size < 8 + GST_SRTCP_TRAILER_LEN + GST_SRTCP_TAG_LEN)
+    return GST_SRTP_INVALID;
+  size -= GST_SRTCP_TRAILER_LEN + GST_SRTCP_TAG_LEN;
+
+  e_index = GST_READ_UINT32_BE (data + size);
+  index = e_index & 0x7fffffff;
+
+  if (!replay_check (&stream->rtcp_replay, index))
+    return GST_SRTP_REPLAYED;
+
+  compute_tag (&stream->rtcp, data, size + GST_SRTCP_TRAILER_LEN, NULL, 0,
+      tag, GST_SRTCP_TAG_LEN);
+  if (!tag_equal (tag, data + size + GST_SRTCP_TRAILER_LEN, GST_SRTCP_TAG_LEN))
+    return GST_SRTP_AUTH_FAILED;
+
+  if (e_index & 0x80000000)
+    aes_cm (&stream->rtcp, stream->ssrc, index, data + 8, size - 8);
+
+  replay_update (&stream->rtcp_replay, index);
+
+  return GST_SRTP_OK;
+}
+
+/* rename application/x-rtp to application/x-srtp and back, the fields are
+ * the same on both sides */
+GstCaps *
+gst_srtp_transform_caps (GstCaps * caps, gboolean to_srtp)
+{
+  static const gchar *names[][2] = {
+    {"application/x-rtp", "application/x-srtp"},
+    {"application/x-rtcp", "application/x-srtcp"}
+  };
+  guint i, j, n;
+
+  caps = gst_caps_copy (caps);
+
+  n = gst_caps_get_size (caps);
+  for (i = 0; i < n; i++) {
+    GstStructure *s = gst_caps_get_structure (caps, i);
+
+    for (j = 0; j < G_N_ELEMENTS (names); j++) {
+      if (gst_structure_has_name (s, names[j][to_srtp ? 0 : 1])) {
+        gst_structure_set_name (s, names[j][to_srtp ? 1 : 0]);
+        break;
+      }
+    }
+  }
+  return caps;
+}
+
+/* answer a caps query on @pad with the caps of the peer of @otherpad,
+ * @to_srtp tells in which direction the caps of @pad are renamed */
+gboolean
+gst_srtp_query_caps (GstPad * pad, GstPad * otherpad, GstQuery * query,
+    gboolean to_srtp)
+{
+  GstCaps *filter, *peer_filter = NULL, *peer_caps, *caps, *templ, *tmp;
+
+  gst_query_parse_caps (query, &filter);
+  if (filter)
+    peer_filter = gst_srtp_transform_caps (filter, to_srtp);
+
+  peer_caps = gst_pad_peer_query_caps (otherpad, peer_filter);
+  caps = gst_srtp_transform_caps (peer_caps, !to_srtp);
+  gst_caps_unref (peer_caps);
+  if (peer_filter)
+    gst_caps_unref (peer_filter);
+
+  templ = gst_pad_get_pad_template_caps (pad);
+  tmp = gst_caps_intersect_full (caps, templ, GST_CAPS_INTERSECT_FIRST);
+  gst_caps_unref (caps);
+  gst_caps_unref (templ);
+  caps = tmp;
+
+  if (filter) {
+    tmp = gst_caps_intersect_full (filter, caps, GST_CAPS_INTERSECT_FIRST);
+    gst_caps_unref (caps);
+    caps = tmp;
+  }
+
+  gst_query_set_caps_result (query, caps);
+  gst_caps_unref (caps);
+
+  return TRUE;
+}
+
+static gboolean
+plugin_init (GstPlugin * plugin)
+{
+  if (!gst_element_register (plugin, "srtpenc", GST_RANK_NONE,
+          GST_TYPE_SRTP_ENC))
+    return FALSE;
+
+  if (!gst_element_register (plugin, "srtpdec", GST_RANK_NONE,
+          GST_TYPE_SRTP_DEC))
+    return FALSE;
+
+  return TRUE;
+}
+
+GST_PLUGIN_DEFINE (GST_VERSION_MAJOR,
+    GST_VERSION_MINOR,
+    srtp,
+    "Secure RTP encryption and decryption",
+    plugin_init, VERSION, GST_LICENSE, GST_PACKAGE_NAME, GST_PACKAGE_ORIGIN);
@@ -0,0 +1,122 @@
+/* GStreamer
+ *
+ * gstsrtp.h: SRTP/SRTCP packet transforms (RFC 3711)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#ifndef __GST_SRTP_H__
+#define __GST_SRTP_H__
+
+#include <gst/gst.h>
+
+#include <nettle/aes.h>
+#include <nettle/hmac.h>
+
+G_BEGIN_DECLS
+
+/* AES_CM_128: 128 bits master key followed by 112 bits master salt */
+#define GST_SRTP_MASTER_KEY_LEN   16
+#define GST_SRTP_MASTER_SALT_LEN  14
+#define GST_SRTP_KEY_LEN          (GST_SRTP_MASTER_KEY_LEN + GST_SRTP_MASTER_SALT_LEN)
+
+#define GST_SRTP_AUTH_KEY_LEN     20
+#define GST_SRTCP_TRAILER_LEN     4
+#define GST_SRTCP_TAG_LEN         10
+
+/* size of the replay window, in packets */
+#define GST_SRTP_REPLAY_WINDOW    64
+
+typedef enum
+{
+  GST_SRTP_AUTH_HMAC_SHA1_80,
+  GST_SRTP_AUTH_HMAC_SHA1_32
+} GstSrtpAuth;
+
+#define GST_TYPE_SRTP_AUTH (gst_srtp_auth_get_type())
+GType gst_srtp_auth_get_type (void);
+
+#define GST_SRTP_AUTH_TAG_LEN(auth) \
+  ((auth) == GST_SRTP_AUTH_HMAC_SHA1_32 ? 4 : 10)
+
+typedef enum
+{
+  GST_SRTP_OK,
+  GST_SRTP_INVALID,
+  GST_SRTP_AUTH_FAILED,
+  GST_SRTP_REPLAYED
+} GstSrtpResult;
+
+/* session keys derived from the master key for one direction */
+typedef struct
+{
+  struct aes_ctx aes;
+  struct hmac_sha1_ctx hmac;
+  guint8 salt[GST_SRTP_MASTER_SALT_LEN];
+} GstSrtpSessionKeys;
+
+typedef struct
+{
+  guint64 max_index;
+  guint64 bitmap;
+  gboolean valid;
+} GstSrtpReplay;
+
+/* the crypto context of one SSRC */
+typedef struct
+{
+  guint32 ssrc;
+
+  GstSrtpSessionKeys rtp;
+  GstSrtpSessionKeys rtcp;
+
+  /* rollover counter and highest sequence number seen */
+  gboolean have_seq;
+  guint32 roc;
+  guint16 s_l;
+  GstSrtpReplay rtp_replay;
+
+  /* next SRTCP index when sending */
+  guint32 rtcp_index;
+  GstSrtpReplay rtcp_replay;
+} GstSrtpStream;
+
+GstSrtpStream * gst_srtp_stream_new  (guint32 ssrc, GstBuffer * key);
+void            gst_srtp_stream_free (GstSrtpStream * stream);
+
+gboolean        gst_srtp_is_rtcp     (const guint8 * data, gsize size);
+gboolean        gst_srtp_get_ssrc    (const guint8 * data, gsize size,
+                                      guint32 * ssrc);
+
+GstSrtpResult   gst_srtp_protect_rtp      (GstSrtpStream * stream,
+                                           guint8 * data, gsize size,
+                                           guint8 * tag, guint tag_len);
+GstSrtpResult   gst_srtp_unprotect_rtp    (GstSrtpStream * stream,
+                                           guint8 * data, gsize size,
+                                           guint tag_len);
+GstSrtpResult   gst_srtp_protect_rtcp     (GstSrtpStream * stream,
+                                           guint8 * data, gsize size,
+                                           guint8 * trailer);
+GstSrtpResult   gst_srtp_unprotect_rtcp   (GstSrtpStream * stream,
+                                           guint8 * data, gsize size);
+
+GstCaps *       gst_srtp_transform_caps   (GstCaps * caps, gboolean to_srtp);
+gboolean        gst_srtp_query_caps       (GstPad * pad, GstPad * otherpad,
+                                           GstQuery * query, gboolean to_srtp);
+
+G_END_DECLS
+
+#endif /* __GST_SRTP_H__ */
@@ -0,0 +1,541 @@
+/* GStreamer
+ *
+ * gstsrtpdec.c: authenticate and decrypt SRTP and SRTCP packets
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/**
+ * SECTION:element-srtpdec
+ * @see_also: srtpenc, rtpbin
+ *
+ * srtpdec authenticates and decrypts the SRTP and SRTCP packets made by
+ * srtpenc. Packets with a wrong authentication tag and packets that were
+ * already received or fall behind the replay window of 64 packets are
+ * dropped and counted in the #GstSrtpDec:auth-failures and
+ * #GstSrtpDec:replayed properties.
+ *
+ * Every SSRC gets its own crypto context. The master key of a new SSRC is
+ * asked with the #GstSrtpDec::request-key signal and falls back to the
+ * #GstSrtpDec:key property, packets of SSRCs without a key are dropped. The
+ * packets are decrypted in place when the buffer is writable.
+ *
+ * To receive protected streams in an rtpbin session, return a srtpdec from
+ * the #GstRtpBin::request-rtp-decoder and #GstRtpBin::request-rtcp-decoder
+ * signals.
+ *
+ * <refsect2>
+ * <title>Example pipeline</title>
+ * |[
+ * gst-launch-1.0 udpsrc port=5004 caps='application/x-srtp, payload=(int)8, clock-rate=(int)8000, encoding-name=(string)PCMA' ! srtpdec key="000102030405060708090A0B0C0D0E0F101112131415161718191A1B1C1D" ! rtppcmadepay ! alawdec ! autoaudiosink
+ * ]| Receive the stream of the srtpenc example.
+ * </refsect2>
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <string.h>
+
+#include "gstsrtpdec.h"
+
+GST_DEBUG_CATEGORY_STATIC (gst_srtp_dec_debug);
+#define GST_CAT_DEFAULT gst_srtp_dec_debug
+
+#define DEFAULT_RTP_AUTH GST_SRTP_AUTH_HMAC_SHA1_80
+
+enum
+{
+  SIGNAL_REQUEST_KEY,
+  LAST_SIGNAL
+};
+
+enum
+{
+  PROP_0,
+  PROP_KEY,
+  PROP_RTP_AUTH,
+  PROP_AUTH_FAILURES,
+  PROP_REPLAYED
+};
+
+static GstStaticPadTemplate sink_template = GST_STATIC_PAD_TEMPLATE ("sink",
+    GST_PAD_SINK,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS ("application/x-srtp; application/x-srtcp")
+    );
+
+static GstStaticPadTemplate src_template = GST_STATIC_PAD_TEMPLATE ("src",
+    GST_PAD_SRC,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS ("application/x-rtp; application/x-rtcp")
+    );
+
+static guint gst_srtp_dec_signals[LAST_SIGNAL] = { 0 };
+
+static void gst_srtp_dec_finalize (GObject * object);
+static void gst_srtp_dec_set_property (GObject * object, guint prop_id,
+    const GValue * value, GParamSpec * pspec);
+static void gst_srtp_dec_get_property (GObject * object, guint prop_id,
+    GValue * value, GParamSpec * pspec);
+static GstStateChangeReturn gst_srtp_dec_change_state (GstElement * element,
+    GstStateChange transition);
+
+static GstFlowReturn gst_srtp_dec_chain (GstPad * pad, GstObject * parent,
+    GstBuffer * buffer);
+static GstFlowReturn gst_srtp_dec_chain_list (GstPad * pad, GstObject * parent,
+    GstBufferList * list);
+static gboolean gst_srtp_dec_sink_event (GstPad * pad, GstObject * parent,
+    GstEvent * event);
+static gboolean gst_srtp_dec_sink_query (GstPad * pad, GstObject * parent,
+    GstQuery * query);
+static gboolean gst_srtp_dec_src_query (GstPad * pad, GstObject * parent,
+    GstQuery * query);
+
+#define gst_srtp_dec_parent_class parent_class
+G_DEFINE_TYPE (GstSrtpDec, gst_srtp_dec, GST_TYPE_ELEMENT);
+
+static void
+gst_srtp_dec_class_init (GstSrtpDecClass * klass)
+{
+  GObjectClass *gobject_class = (GObjectClass *) klass;
+  GstElementClass *element_class = (GstElementClass *) klass;
+
+  gobject_class->finalize = gst_srtp_dec_finalize;
+  gobject_class->set_property = gst_srtp_dec_set_property;
+  gobject_class->get_property = gst_srtp_dec_get_property;
+
+  g_object_class_install_property (gobject_class, PROP_KEY,
+      g_param_spec_boxed ("key", "Key",
+          "Master key followed by the master salt (30 bytes), used for the "
+          "SSRCs without a key from the request-key signal",
+          GST_TYPE_BUFFER, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  g_object_class_install_property (gobject_class, PROP_RTP_AUTH,
+      g_param_spec_enum ("rtp-auth", "RTP authentication",
+          "Authentication tag of the SRTP packets, SRTCP always uses 80 bits",
+          GST_TYPE_SRTP_AUTH, DEFAULT_RTP_AUTH,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  g_object_class_install_property (gobject_class, PROP_AUTH_FAILURES,
+      g_param_spec_uint64 ("auth-failures", "Authentication failures",
+          "Number of packets dropped because of a wrong authentication tag",
+          0, G_MAXUINT64, 0, G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+
+  g_object_class_install_property (gobject_class, PROP_REPLAYED,
+      g_param_spec_uint64 ("replayed", "Replayed",
+          "Number of packets dropped by the replay protection",
+          0, G_MAXUINT64, 0, G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstSrtpDec::request-key:
+   * @dec: the object which received the signal
+   * @ssrc: the SSRC of the new stream
+   *
+   * Request the master key and salt of a new SSRC. Return %NULL to use the
+   * #GstSrtpDec:key property.
+   *
+   * Returns: a #GstBuffer with 30 bytes of key and salt.
+   */
+  gst_srtp_dec_signals[SIGNAL_REQUEST_KEY] =
+      g_signal_new ("request-key", G_TYPE_FROM_CLASS (klass),
+      G_SIGNAL_RUN_LAST, G_STRUCT_OFFSET (GstSrtpDecClass, request_key),
+      g_signal_accumulator_first_wins, NULL, g_cclosure_marshal_generic,
+      GST_TYPE_BUFFER, 1, G_TYPE_UINT);
+
+  element_class->change_state = GST_DEBUG_FUNCPTR (gst_srtp_dec_change_state);
+
+  gst_element_class_add_pad_template (element_class,
+      gst_static_pad_template_get (&sink_template));
+  gst_element_class_add_pad_template (element_class,
+      gst_static_pad_template_get (&src_template));
+
+  gst_element_class_set_static_metadata (element_class, "SRTP decoder",
+      "Filter/Network/SRTP",
+      "Authenticates and decrypts SRTP and SRTCP packets",
+      "GStreamer maintainers <gstreamer-devel@lists.freedesktop.org>");
+
+  GST_DEBUG_CATEGORY_INIT (gst_srtp_dec_debug, "srtpdec", 0, "SRTP decoder");
+}
+
+static void
+gst_srtp_dec_init (GstSrtpDec * dec)
+{
+  dec->sinkpad = gst_pad_new_from_static_template (&sink_template, "sink");
+  gst_pad_set_chain_function (dec->sinkpad,
+      GST_DEBUG_FUNCPTR (gst_srtp_dec_chain));
+  gst_pad_set_chain_list_function (dec->sinkpad,
+      GST_DEBUG_FUNCPTR (gst_srtp_dec_chain_list));
+  gst_pad_set_event_function (dec->sinkpad,
+      GST_DEBUG_FUNCPTR (gst_srtp_dec_sink_event));
+  gst_pad_set_query_function (dec->sinkpad,
+      GST_DEBUG_FUNCPTR (gst_srtp_dec_sink_query));
+  gst_element_add_pad (GST_ELEMENT (dec), dec->sinkpad);
+
+  dec->srcpad = gst_pad_new_from_static_template (&src_template, "src");
+  gst_pad_set_query_function (dec->srcpad,
+      GST_DEBUG_FUNCPTR (gst_srtp_dec_src_query));
+  gst_element_add_pad (GST_ELEMENT (dec), dec->srcpad);
+
+  dec->rtp_auth = DEFAULT_RTP_AUTH;
+  dec->rtp_tag_len = GST_SRTP_AUTH_TAG_LEN (DEFAULT_RTP_AUTH);
+  dec->streams = g_hash_table_new_full (NULL, NULL, NULL,
+      (GDestroyNotify) gst_srtp_stream_free);
+}
+
+static void
+gst_srtp_dec_finalize (GObject * object)
+{
+  GstSrtpDec *dec = GST_SRTP_DEC (object);
+
+  if (dec->key)
+    gst_buffer_unref (dec->key);
+  g_hash_table_destroy (dec->streams);
+
+  G_OBJECT_CLASS (parent_class)->finalize (object);
+}
+
+static void
+gst_srtp_dec_set_property (GObject * object, guint prop_id,
+    const GValue * value, GParamSpec * pspec)
+{
+  GstSrtpDec *dec = GST_SRTP_DEC (object);
+
+  switch (prop_id) {
+    case PROP_KEY:
+      GST_OBJECT_LOCK (dec);
+      if (dec->key)
+        gst_buffer_unref (dec->key);
+      dec->key = g_value_dup_boxed (value);
+      /* the streaming thread derives the session keys again */
+      dec->key_changed = TRUE;
+      GST_OBJECT_UNLOCK (dec);
+      break;
+    case PROP_RTP_AUTH:
+      GST_OBJECT_LOCK (dec);
+      dec->rtp_auth = g_value_get_enum (value);
+      GST_OBJECT_UNLOCK (dec);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
+static void
+gst_srtp_dec_get_property (GObject * object, guint prop_id,
+    GValue * value, GParamSpec * pspec)
+{
+  GstSrtpDec *dec = GST_SRTP_DEC (object);
+
+  switch (prop_id) {
+    case PROP_KEY:
+      GST_OBJECT_LOCK (dec);
+      g_value_set_boxed (value, dec->key);
+      GST_OBJECT_UNLOCK (dec);
+      break;
+    case PROP_RTP_AUTH:
+      GST_OBJECT_LOCK (dec);
+      g_value_set_enum (value, dec->rtp_auth);
+      GST_OBJECT_UNLOCK (dec);
+      break;
+    case PROP_AUTH_FAILURES:
+      GST_OBJECT_LOCK (dec);
+      g_value_set_uint64 (value, dec->auth_failures);
+      GST_OBJECT_UNLOCK (dec);
+      break;
+    case PROP_REPLAYED:
+      GST_OBJECT_LOCK (dec);
+      g_value_set_uint64 (value, dec->replayed);
+      GST_OBJECT_UNLOCK (dec);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
+/* pick up property changes, called from the streaming thread */
+static void
+gst_srtp_dec_update_settings (GstSrtpDec * dec)
+{
+  GST_OBJECT_LOCK (dec);
+  if (dec->key_changed) {
+    GST_DEBUG_OBJECT (dec, "key changed, dropping %u contexts",
+        g_hash_table_size (dec->streams));
+    g_hash_table_remove_all (dec->streams);
+    dec->key_changed = FALSE;
+  }
+  dec->rtp_tag_len = GST_SRTP_AUTH_TAG_LEN (dec->rtp_auth);
+  GST_OBJECT_UNLOCK (dec);
+}
+
+static GstSrtpStream *
+gst_srtp_dec_get_stream (GstSrtpDec * dec, guint32 ssrc)
+{
+  GstSrtpStream *stream;
+  GstBuffer *key = NULL;
+
+  stream = g_hash_table_lookup (dec->streams, GUINT_TO_POINTER (ssrc));
+  if (G_LIKELY (stream))
+    return stream;
+
+  g_signal_emit (dec, gst_srtp_dec_signals[SIGNAL_REQUEST_KEY], 0, ssrc, &key);
+  if (key == NULL) {
+    GST_OBJECT_LOCK (dec);
+    if (dec->key)
+      key = gst_buffer_ref (dec->key);
+    GST_OBJECT_UNLOCK (dec);
+  }
+  if (key == NULL)
+    goto no_key;
+
+  stream = gst_srtp_stream_new (ssrc, key);
+  gst_buffer_unref (key);
+  if (stream == NULL)
+    goto invalid_key;
+
+  GST_DEBUG_OBJECT (dec, "new crypto context for SSRC %08x", ssrc);
+  g_hash_table_insert (dec->streams, GUINT_TO_POINTER (ssrc), stream);
+
+  return stream;
+
+  /* ERRORS */
+no_key:
+  {
+    GST_WARNING_OBJECT (dec, "no key for SSRC %08x", ssrc);
+    return NULL;
+  }
+invalid_key:
+  {
+    GST_WARNING_OBJECT (dec, "the key for SSRC %08x is not %d bytes", ssrc,
+        GST_SRTP_KEY_LEN);
+    return NULL;
+  }
+}
+
+/* authenticate and decrypt @buffer in place, sets @buffer to NULL when the
+ * packet is dropped */
+static GstFlowReturn
+gst_srtp_dec_unprotect (GstSrtpDec * dec, GstBuffer ** buffer)
+{
+  GstSrtpStream *stream;
+  GstSrtpResult res;
+  GstMapInfo map;
+  guint8 header[12];
+  guint32 ssrc;
+  gboolean rtcp;
+  gsize len;
+  guint tag_len;
+
+  len = gst_buffer_extract (*buffer, 0, header, sizeof (header));
+  if (!gst_srtp_get_ssrc (header, len, &ssrc))
+    goto invalid;
+
+  /* packets of unknown streams are dropped, the key may come later */
+  stream = gst_srtp_dec_get_stream (dec, ssrc);
+  if (stream == NULL)
+    goto drop;
+
+  rtcp = gst_srtp_is_rtcp (header, len);
+  if (rtcp)
+    tag_len = GST_SRTCP_TRAILER_LEN + GST_SRTCP_TAG_LEN;
+  else
+    tag_len = dec->rtp_tag_len;
+
+  *buffer = gst_buffer_make_writable (*buffer);
+  if (!gst_buffer_map (*buffer, &map, GST_MAP_READWRITE))
+    goto map_failed;
+
+  len = map.size;
+  if (rtcp)
+    res = gst_srtp_unprotect_rtcp (stream, map.data, map.size);
+  else
+    res = gst_srtp_unprotect_rtp (stream, map.data, map.size, tag_len);
+  gst_buffer_unmap (*buffer, &map);
+
+  switch (res) {
+    case GST_SRTP_OK:
+      break;
+    case GST_SRTP_AUTH_FAILED:
+      GST_LOG_OBJECT (dec, "authentication failed for SSRC %08x", ssrc);
+      GST_OBJECT_LOCK (dec);
+      dec->auth_failures++;
+      GST_OBJECT_UNLOCK (dec);
+      goto drop;
+    case GST_SRTP_REPLAYED:
+      GST_LOG_OBJECT (dec, "replayed packet for SSRC %08x", ssrc);
+      GST_OBJECT_LOCK (dec);
+      dec->replayed++;
+      GST_OBJECT_UNLOCK (dec);
+      goto drop;
+    default:
+      goto invalid;
+  }
+
+  /* strip the tag and the SRTCP index */
+  gst_buffer_resize (*buffer, 0, len - tag_len);
+
+  return GST_FLOW_OK;
+
+  /* ERRORS */
+invalid:
+  {
+    GST_WARNING_OBJECT (dec, "dropping invalid packet");
+    goto drop;
+  }
+drop:
+  {
+    gst_buffer_unref (*buffer);
+    *buffer = NULL;
+    return GST_FLOW_OK;
+  }
+map_failed:
+  {
+    GST_ELEMENT_ERROR (dec, RESOURCE, FAILED, (NULL),
+        ("could not map the buffer"));
+    gst_buffer_unref (*buffer);
+    *buffer = NULL;
+    return GST_FLOW_ERROR;
+  }
+}
+
+static GstFlowReturn
+gst_srtp_dec_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
+{
+  GstSrtpDec *dec = GST_SRTP_DEC (parent);
+  GstFlowReturn ret;
+
+  gst_srtp_dec_update_settings (dec);
+
+  ret = gst_srtp_dec_unprotect (dec, &buffer);
+  if (buffer == NULL)
+    return ret;
+
+  return gst_pad_push (dec->srcpad, buffer);
+}
+
+typedef struct
+{
+  GstSrtpDec *dec;
+  GstFlowReturn ret;
+} UnprotectListData;
+
+static gboolean
+unprotect_list_func (GstBuffer ** buffer, guint idx, gpointer user_data)
+{
+  UnprotectListData *data = user_data;
+
+  data->ret = gst_srtp_dec_unprotect (data->dec, buffer);
+
+  return data->ret == GST_FLOW_OK;
+}
+
+static GstFlowReturn
+gst_srtp_dec_chain_list (GstPad * pad, GstObject * parent,
+    GstBufferList * list)
+{
+  GstSrtpDec *dec = GST_SRTP_DEC (parent);
+  UnprotectListData data;
+
+  gst_srtp_dec_update_settings (dec);
+
+  data.dec = dec;
+  data.ret = GST_FLOW_OK;
+
+  list = gst_buffer_list_make_writable (list);
+  gst_buffer_list_foreach (list, unprotect_list_func, &data);
+
+  if (data.ret != GST_FLOW_OK || gst_buffer_list_length (list) == 0) {
+    gst_buffer_list_unref (list);
+    return data.ret;
+  }
+
+  return gst_pad_push_list (dec->srcpad, list);
+}
+
+static gboolean
+gst_srtp_dec_sink_event (GstPad * pad, GstObject * parent, GstEvent * event)
+{
+  GstSrtpDec *dec = GST_SRTP_DEC (parent);
+  gboolean ret;
+
+  switch (GST_EVENT_TYPE (event)) {
+    case GST_EVENT_CAPS:
+    {
+      GstCaps *caps, *outcaps;
+
+      gst_event_parse_caps (event, &caps);
+      outcaps = gst_srtp_transform_caps (caps, FALSE);
+      gst_event_unref (event);
+
+      GST_DEBUG_OBJECT (dec, "caps %" GST_PTR_FORMAT, outcaps);
+      ret = gst_pad_push_event (dec->srcpad, gst_event_new_caps (outcaps));
+      gst_caps_unref (outcaps);
+      break;
+    }
+    default:
+      ret = gst_pad_event_default (pad, parent, event);
+      break;
+  }
+  return ret;
+}
+
+static gboolean
+gst_srtp_dec_sink_query (GstPad * pad, GstObject * parent, GstQuery * query)
+{
+  GstSrtpDec *dec = GST_SRTP_DEC (parent);
+
+  switch (GST_QUERY_TYPE (query)) {
+    case GST_QUERY_CAPS:
+      return gst_srtp_query_caps (pad, dec->srcpad, query, FALSE);
+    default:
+      return gst_pad_query_default (pad, parent, query);
+  }
+}
+
+static gboolean
+gst_srtp_dec_src_query (GstPad * pad, GstObject * parent, GstQuery * query)
+{
+  GstSrtpDec *dec = GST_SRTP_DEC (parent);
+
+  switch (GST_QUERY_TYPE (query)) {
+    case GST_QUERY_CAPS:
+      return gst_srtp_query_caps (pad, dec->sinkpad, query, TRUE);
+    default:
+      return gst_pad_query_default (pad, parent, query);
+  }
+}
+
+static GstStateChangeReturn
+gst_srtp_dec_change_state (GstElement * element, GstStateChange transition)
+{
+  GstSrtpDec *dec = GST_SRTP_DEC (element);
+  GstStateChangeReturn ret;
+
+  ret = GST_ELEMENT_CLASS (parent_class)->change_state (element, transition);
+
+  switch (transition) {
+    case GST_STATE_CHANGE_PAUSED_TO_READY:
+      /* start with fresh rollover counters and replay windows */
+      g_hash_table_remove_all (dec->streams);
+      break;
+    default:
+      break;
+  }
+  return ret;
+}
@@ -0,0 +1,73 @@
+/* GStreamer
+ *
+ * gstsrtpdec.h: authenticate and decrypt SRTP and SRTCP packets
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#ifndef __GST_SRTP_DEC_H__
+#define __GST_SRTP_DEC_H__
+
+#include <gst/gst.h>
+
+#include "gstsrtp.h"
+
+G_BEGIN_DECLS
+
+#define GST_TYPE_SRTP_DEC \
+  (gst_srtp_dec_get_type())
+#define GST_SRTP_DEC(obj) \
+  (G_TYPE_CHECK_INSTANCE_CAST((obj),GST_TYPE_SRTP_DEC,GstSrtpDec))
+#define GST_SRTP_DEC_CLASS(klass) \
+  (G_TYPE_CHECK_CLASS_CAST((klass),GST_TYPE_SRTP_DEC,GstSrtpDecClass))
+#define GST_IS_SRTP_DEC(obj) \
+  (G_TYPE_CHECK_INSTANCE_TYPE((obj),GST_TYPE_SRTP_DEC))
+#define GST_IS_SRTP_DEC_CLASS(klass) \
+  (G_TYPE_CHECK_CLASS_TYPE((klass),GST_TYPE_SRTP_DEC))
+
+typedef struct _GstSrtpDec GstSrtpDec;
+typedef struct _GstSrtpDecClass GstSrtpDecClass;
+
+struct _GstSrtpDec {
+  GstElement element;
+
+  GstPad *sinkpad;
+  GstPad *srcpad;
+
+  /* properties and statistics, protected by the object lock */
+  GstBuffer *key;
+  GstSrtpAuth rtp_auth;
+  gboolean key_changed;
+  guint64 auth_failures;
+  guint64 replayed;
+
+  /* streaming thread only */
+  GHashTable *streams;
+  guint rtp_tag_len;
+};
+
+struct _GstSrtpDecClass {
+  GstElementClass parent_class;
+
+  /* signals */
+  GstBuffer * (*request_key) (GstSrtpDec * dec, guint ssrc);
+};
+
+GType gst_srtp_dec_get_type (void);
+
+G_END_DECLS
+
+#endif /* __GST_SRTP_DEC_H__ */
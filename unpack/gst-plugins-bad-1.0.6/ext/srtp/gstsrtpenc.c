@@ -0,0 +1,508 @@
+/* GStreamer
+ *
+ * gstsrtpenc.c: encrypt RTP and RTCP packets
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/**
+ * SECTION:element-srtpenc
+ * @see_also: srtpdec, rtpbin
+ *
+ * srtpenc turns RTP and RTCP packets into SRTP and SRTCP packets (RFC 3711)
+ * with the AES_CM_128_HMAC_SHA1_80 or AES_CM_128_HMAC_SHA1_32 crypto suite.
+ * RTP and RTCP are told apart by their payload type so a single element can
+ * also handle a multiplexed stream.
+ *
+ * Every SSRC gets its own crypto context. The master key of a new SSRC is
+ * asked with the #GstSrtpEnc::request-key signal and falls back to the
+ * #GstSrtpEnc:key property. The payload is encrypted in place when the buffer
+ * is writable, only the authentication tag is added as a new memory block.
+ *
+ * To protect the streams of an rtpbin session, return a srtpenc from the
+ * #GstRtpBin::request-rtp-encoder and #GstRtpBin::request-rtcp-encoder
+ * signals.
+ *
+ * <refsect2>
+ * <title>Example pipeline</title>
+ * |[
+ * gst-launch-1.0 audiotestsrc ! alawenc ! rtppcmapay ! 'application/x-rtp, payload=(int)8, ssrc=(uint)1356955624' ! srtpenc key="000102030405060708090A0B0C0D0E0F101112131415161718191A1B1C1D" ! udpsink port=5004
+ * ]| Send an SRTP protected A-law stream.
+ * </refsect2>
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <string.h>
+
+#include "gstsrtpenc.h"
+
+GST_DEBUG_CATEGORY_STATIC (gst_srtp_enc_debug);
+#define GST_CAT_DEFAULT gst_srtp_enc_debug
+
+#define DEFAULT_RTP_AUTH GST_SRTP_AUTH_HMAC_SHA1_80
+
+enum
+{
+  SIGNAL_REQUEST_KEY,
+  LAST_SIGNAL
+};
+
+enum
+{
+  PROP_0,
+  PROP_KEY,
+  PROP_RTP_AUTH
+};
+
+static GstStaticPadTemplate sink_template = GST_STATIC_PAD_TEMPLATE ("sink",
+    GST_PAD_SINK,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS ("application/x-rtp; application/x-rtcp")
+    );
+
+static GstStaticPadTemplate src_template = GST_STATIC_PAD_TEMPLATE ("src",
+    GST_PAD_SRC,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS ("application/x-srtp; application/x-srtcp")
+    );
+
+static guint gst_srtp_enc_signals[LAST_SIGNAL] = { 0 };
+
+static void gst_srtp_enc_finalize (GObject * object);
+static void gst_srtp_enc_set_property (GObject * object, guint prop_id,
+    const GValue * value, GParamSpec * pspec);
+static void gst_srtp_enc_get_property (GObject * object, guint prop_id,
+    GValue * value, GParamSpec * pspec);
+static GstStateChangeReturn gst_srtp_enc_change_state (GstElement * element,
+    GstStateChange transition);
+
+static GstFlowReturn gst_srtp_enc_chain (GstPad * pad, GstObject * parent,
+    GstBuffer * buffer);
+static GstFlowReturn gst_srtp_enc_chain_list (GstPad * pad, GstObject * parent,
+    GstBufferList * list);
+static gboolean gst_srtp_enc_sink_event (GstPad * pad, GstObject * parent,
+    GstEvent * event);
+static gboolean gst_srtp_enc_sink_query (GstPad * pad, GstObject * parent,
+    GstQuery * query);
+static gboolean gst_srtp_enc_src_query (GstPad * pad, GstObject * parent,
+    GstQuery * query);
+
+#define gst_srtp_enc_parent_class parent_class
+G_DEFINE_TYPE (GstSrtpEnc, gst_srtp_enc, GST_TYPE_ELEMENT);
+
+static void
+gst_srtp_enc_class_init (GstSrtpEncClass * klass)
+{
+  GObjectClass *gobject_class = (GObjectClass *) klass;
+  GstElementClass *element_class = (GstElementClass *) klass;
+
+  gobject_class->finalize = gst_srtp_enc_finalize;
+  gobject_class->set_property = gst_srtp_enc_set_property;
+  gobject_class->get_property = gst_srtp_enc_get_property;
+
+  g_object_class_install_property (gobject_class, PROP_KEY,
+      g_param_spec_boxed ("key", "Key",
+          "Master key followed by the master salt (30 bytes), used for the "
+          "SSRCs without a key from the request-key signal",
+          GST_TYPE_BUFFER, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  g_object_class_install_property (gobject_class, PROP_RTP_AUTH,
+      g_param_spec_enum ("rtp-auth", "RTP authentication",
+          "Authentication tag of the SRTP packets, SRTCP always uses 80 bits",
+          GST_TYPE_SRTP_AUTH, DEFAULT_RTP_AUTH,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstSrtpEnc::request-key:
+   * @enc: the object which received the signal
+   * @ssrc: the SSRC of the new stream
+   *
+   * Request the master key and salt of a new SSRC. Return %NULL to use the
+   * #GstSrtpEnc:key property.
+   *
+   * Returns: a #GstBuffer with 30 bytes of key and salt.
+   */
+  gst_srtp_enc_signals[SIGNAL_REQUEST_KEY] =
+      g_signal_new ("request-key", G_TYPE_FROM_CLASS (klass),
+      G_SIGNAL_RUN_LAST, G_STRUCT_OFFSET (GstSrtpEncClass, request_key),
+      g_signal_accumulator_first_wins, NULL, g_cclosure_marshal_generic,
+      GST_TYPE_BUFFER, 1, G_TYPE_UINT);
+
+  element_class->change_state = GST_DEBUG_FUNCPTR (gst_srtp_enc_change_state);
+
+  gst_element_class_add_pad_template (element_class,
+      gst_static_pad_template_get (&sink_template));
+  gst_element_class_add_pad_template (element_class,
+      gst_static_pad_template_get (&src_template));
+
+  gst_element_class_set_static_metadata (element_class, "SRTP encoder",
+      "Filter/Network/SRTP", "Encrypts and authenticates RTP and RTCP packets",
+      "GStreamer maintainers <gstreamer-devel@lists.freedesktop.org>");
+
+  GST_DEBUG_CATEGORY_INIT (gst_srtp_enc_debug, "srtpenc", 0, "SRTP encoder");
+}
+
+static void
+gst_srtp_enc_init (GstSrtpEnc * enc)
+{
+  enc->sinkpad = gst_pad_new_from_static_template (&sink_template, "sink");
+  gst_pad_set_chain_function (enc->sinkpad,
+      GST_DEBUG_FUNCPTR (gst_srtp_enc_chain));
+  gst_pad_set_chain_list_function (enc->sinkpad,
+      GST_DEBUG_FUNCPTR (gst_srtp_enc_chain_list));
+  gst_pad_set_event_function (enc->sinkpad,
+      GST_DEBUG_FUNCPTR (gst_srtp_enc_sink_event));
+  gst_pad_set_query_function (enc->sinkpad,
+      GST_DEBUG_FUNCPTR (gst_srtp_enc_sink_query));
+  gst_element_add_pad (GST_ELEMENT (enc), enc->sinkpad);
+
+  enc->srcpad = gst_pad_new_from_static_template (&src_template, "src");
+  gst_pad_set_query_function (enc->srcpad,
+      GST_DEBUG_FUNCPTR (gst_srtp_enc_src_query));
+  gst_element_add_pad (GST_ELEMENT (enc), enc->srcpad);
+
+  enc->rtp_auth = DEFAULT_RTP_AUTH;
+  enc->rtp_tag_len = GST_SRTP_AUTH_TAG_LEN (DEFAULT_RTP_AUTH);
+  enc->streams = g_hash_table_new_full (NULL, NULL, NULL,
+      (GDestroyNotify) gst_srtp_stream_free);
+}
+
+static void
+gst_srtp_enc_finalize (GObject * object)
+{
+  GstSrtpEnc *enc = GST_SRTP_ENC (object);
+
+  if (enc->key)
+    gst_buffer_unref (enc->key);
+  g_hash_table_destroy (enc->streams);
+
+  G_OBJECT_CLASS (parent_class)->finalize (object);
+}
+
+static void
+gst_srtp_enc_set_property (GObject * object, guint prop_id,
+    const GValue * value, GParamSpec * pspec)
+{
+  GstSrtpEnc *enc = GST_SRTP_ENC (object);
+
+  switch (prop_id) {
+    case PROP_KEY:
+      GST_OBJECT_LOCK (enc);
+      if (enc->key)
+        gst_buffer_unref (enc->key);
+      enc->key = g_value_dup_boxed (value);
+      /* the streaming thread derives the session keys again */
+      enc->key_changed = TRUE;
+      GST_OBJECT_UNLOCK (enc);
+      break;
+    case PROP_RTP_AUTH:
+      GST_OBJECT_LOCK (enc);
+      enc->rtp_auth = g_value_get_enum (value);
+      GST_OBJECT_UNLOCK (enc);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
+static void
+gst_srtp_enc_get_property (GObject * object, guint prop_id,
+    GValue * value, GParamSpec * pspec)
+{
+  GstSrtpEnc *enc = GST_SRTP_ENC (object);
+
+  switch (prop_id) {
+    case PROP_KEY:
+      GST_OBJECT_LOCK (enc);
+      g_value_set_boxed (value, enc->key);
+      GST_OBJECT_UNLOCK (enc);
+      break;
+    case PROP_RTP_AUTH:
+      GST_OBJECT_LOCK (enc);
+      g_value_set_enum (value, enc->rtp_auth);
+      GST_OBJECT_UNLOCK (enc);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
+/* pick up property changes, called from the streaming thread */
+static void
+gst_srtp_enc_update_settings (GstSrtpEnc * enc)
+{
+  GST_OBJECT_LOCK (enc);
+  if (enc->key_changed) {
+    GST_DEBUG_OBJECT (enc, "key changed, dropping %u contexts",
+        g_hash_table_size (enc->streams));
+    g_hash_table_remove_all (enc->streams);
+    enc->key_changed = FALSE;
+  }
+  enc->rtp_tag_len = GST_SRTP_AUTH_TAG_LEN (enc->rtp_auth);
+  GST_OBJECT_UNLOCK (enc);
+}
+
+static GstSrtpStream *
+gst_srtp_enc_get_stream (GstSrtpEnc * enc, guint32 ssrc)
+{
+  GstSrtpStream *stream;
+  GstBuffer *key = NULL;
+
+  stream = g_hash_table_lookup (enc->streams, GUINT_TO_POINTER (ssrc));
+  if (G_LIKELY (stream))
+    return stream;
+
+  g_signal_emit (enc, gst_srtp_enc_signals[SIGNAL_REQUEST_KEY], 0, ssrc, &key);
+  if (key == NULL) {
+    GST_OBJECT_LOCK (enc);
+    if (enc->key)
+      key = gst_buffer_ref (enc->key);
+    GST_OBJECT_UNLOCK (enc);
+  }
+  if (key == NULL)
+    goto no_key;
+
+  stream = gst_srtp_stream_new (ssrc, key);
+  gst_buffer_unref (key);
+  if (stream == NULL)
+    goto invalid_key;
+
+  GST_DEBUG_OBJECT (enc, "new crypto context for SSRC %08x", ssrc);
+  g_hash_table_insert (enc->streams, GUINT_TO_POINTER (ssrc), stream);
+
+  return stream;
+
+  /* ERRORS */
+no_key:
+  {
+    GST_ELEMENT_ERROR (enc, STREAM, FAILED, (NULL),
+        ("no key for SSRC %08x", ssrc));
+    return NULL;
+  }
+invalid_key:
+  {
+    GST_ELEMENT_ERROR (enc, STREAM, FAILED, (NULL),
+        ("the key for SSRC %08x is not %d bytes", ssrc, GST_SRTP_KEY_LEN));
+    return NULL;
+  }
+}
+
+/* encrypt @buffer in place and append the tag, sets @buffer to NULL when the
+ * packet is dropped */
+static GstFlowReturn
+gst_srtp_enc_protect (GstSrtpEnc * enc, GstBuffer ** buffer)
+{
+  GstSrtpStream *stream;
+  GstSrtpResult res;
+  GstMemory *mem;
+  GstMapInfo map, tmap;
+  guint8 header[12];
+  guint32 ssrc;
+  gboolean rtcp;
+  gsize len;
+  guint tag_len;
+
+  len = gst_buffer_extract (*buffer, 0, header, sizeof (header));
+  if (!gst_srtp_get_ssrc (header, len, &ssrc))
+    goto invalid;
+
+  stream = gst_srtp_enc_get_stream (enc, ssrc);
+  if (stream == NULL)
+    goto no_stream;
+
+  rtcp = gst_srtp_is_rtcp (header, len);
+  if (rtcp)
+    tag_len = GST_SRTCP_TRAILER_LEN + GST_SRTCP_TAG_LEN;
+  else
+    tag_len = enc->rtp_tag_len;
+
+  *buffer = gst_buffer_make_writable (*buffer);
+  if (!gst_buffer_map (*buffer, &map, GST_MAP_READWRITE))
+    goto map_failed;
+
+  mem = gst_allocator_alloc (NULL, tag_len, NULL);
+  gst_memory_map (mem, &tmap, GST_MAP_WRITE);
+  if (rtcp)
+    res = gst_srtp_protect_rtcp (stream, map.data, map.size, tmap.data);
+  else
+    res = gst_srtp_protect_rtp (stream, map.data, map.size, tmap.data,
+        tag_len);
+  gst_memory_unmap (mem, &tmap);
+  gst_buffer_unmap (*buffer, &map);
+
+  if (res != GST_SRTP_OK) {
+    gst_memory_unref (mem);
+    goto invalid;
+  }
+
+  gst_buffer_append_memory (*buffer, mem);
+
+  return GST_FLOW_OK;
+
+  /* ERRORS */
+invalid:
+  {
+    GST_WARNING_OBJECT (enc, "dropping invalid packet");
+    gst_buffer_unref (*buffer);
+    *buffer = NULL;
+    return GST_FLOW_OK;
+  }
+no_stream:
+  {
+    gst_buffer_unref (*buffer);
+    *buffer = NULL;
+    return GST_FLOW_ERROR;
+  }
+map_failed:
+  {
+    GST_ELEMENT_ERROR (enc, RESOURCE, FAILED, (NULL),
+        ("could not map the buffer"));
+    gst_buffer_unref (*buffer);
+    *buffer = NULL;
+    return GST_FLOW_ERROR;
+  }
+}
+
+static GstFlowReturn
+gst_srtp_enc_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
+{
+  GstSrtpEnc *enc = GST_SRTP_ENC (parent);
+  GstFlowReturn ret;
+
+  gst_srtp_enc_update_settings (enc);
+
+  ret = gst_srtp_enc_protect (enc, &buffer);
+  if (buffer == NULL)
+    return ret;
+
+  return gst_pad_push (enc->srcpad, buffer);
+}
+
+typedef struct
+{
+  GstSrtpEnc *enc;
+  GstFlowReturn ret;
+} ProtectListData;
+
+static gboolean
+protect_list_func (GstBuffer ** buffer, guint idx, gpointer user_data)
+{
+  ProtectListData *data = user_data;
+
+  data->ret = gst_srtp_enc_protect (data->enc, buffer);
+
+  return data->ret == GST_FLOW_OK;
+}
+
+static GstFlowReturn
+gst_srtp_enc_chain_list (GstPad * pad, GstObject * parent,
+    GstBufferList * list)
+{
+  GstSrtpEnc *enc = GST_SRTP_ENC (parent);
+  ProtectListData data;
+
+  gst_srtp_enc_update_settings (enc);
+
+  data.enc = enc;
+  data.ret = GST_FLOW_OK;
+
+  list = gst_buffer_list_make_writable (list);
+  gst_buffer_list_foreach (list, protect_list_func, &data);
+
+  if (data.ret != GST_FLOW_OK || gst_buffer_list_length (list) == 0) {
+    gst_buffer_list_unref (list);
+    return data.ret;
+  }
+
+  return gst_pad_push_list (enc->srcpad, list);
+}
+
+static gboolean
+gst_srtp_enc_sink_event (GstPad * pad, GstObject * parent, GstEvent * event)
+{
+  GstSrtpEnc *enc = GST_SRTP_ENC (parent);
+  gboolean ret;
+
+  switch (GST_EVENT_TYPE (event)) {
+    case GST_EVENT_CAPS:
+    {
+      GstCaps *caps, *outcaps;
+
+      gst_event_parse_caps (event, &caps);
+      outcaps = gst_srtp_transform_caps (caps, TRUE);
+      gst_event_unref (event);
+
+      GST_DEBUG_OBJECT (enc, "caps %" GST_PTR_FORMAT, outcaps);
+      ret = gst_pad_push_event (enc->srcpad, gst_event_new_caps (outcaps));
+      gst_caps_unref (outcaps);
+      break;
+    }
+    default:
+      ret = gst_pad_event_default (pad, parent, event);
+      break;
+  }
+  return ret;
+}
+
+static gboolean
+gst_srtp_enc_sink_query (GstPad * pad, GstObject * parent, GstQuery * query)
+{
+  GstSrtpEnc *enc = GST_SRTP_ENC (parent);
+
+  switch (GST_QUERY_TYPE (query)) {
+    case GST_QUERY_CAPS:
+      return gst_srtp_query_caps (pad, enc->srcpad, query, TRUE);
+    default:
+      return gst_pad_query_default (pad, parent, query);
+  }
+}
+
+static gboolean
+gst_srtp_enc_src_query (GstPad * pad, GstObject * parent, GstQuery * query)
+{
+  GstSrtpEnc *enc = GST_SRTP_ENC (parent);
+
+  switch (GST_QUERY_TYPE (query)) {
+    case GST_QUERY_CAPS:
+      return gst_srtp_query_caps (pad, enc->sinkpad, query, FALSE);
+    default:
+      return gst_pad_query_default (pad, parent, query);
+  }
+}
+
+static GstStateChangeReturn
+gst_srtp_enc_change_state (GstElement * element, GstStateChange transition)
+{
+  GstSrtpEnc *enc = GST_SRTP_ENC (element);
+  GstStateChangeReturn ret;
+
+  ret = GST_ELEMENT_CLASS (parent_class)->change_state (element, transition);
+
+  switch (transition) {
+    case GST_STATE_CHANGE_PAUSED_TO_READY:
+      /* start with fresh rollover counters and SRTCP indexes */
+      g_hash_table_remove_all (enc->streams);
+      break;
+    default:
+      break;
+  }
+  return ret;
+}
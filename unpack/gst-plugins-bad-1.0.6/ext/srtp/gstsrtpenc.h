@@ -0,0 +1,71 @@
+/* GStreamer
+ *
+ * gstsrtpenc.h: encrypt RTP and RTCP packets
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#ifndef __GST_SRTP_ENC_H__
+#define __GST_SRTP_ENC_H__
+
+#include <gst/gst.h>
+
+#include "gstsrtp.h"
+
+G_BEGIN_DECLS
+
+#define GST_TYPE_SRTP_ENC \
+  (gst_srtp_enc_get_type())
+#define GST_SRTP_ENC(obj) \
+  (G_TYPE_CHECK_INSTANCE_CAST((obj),GST_TYPE_SRTP_ENC,GstSrtpEnc))
+#define GST_SRTP_ENC_CLASS(klass) \
+  (G_TYPE_CHECK_CLASS_CAST((klass),GST_TYPE_SRTP_ENC,GstSrtpEncClass))
+#define GST_IS_SRTP_ENC(obj) \
+  (G_TYPE_CHECK_INSTANCE_TYPE((obj),GST_TYPE_SRTP_ENC))
+#define GST_IS_SRTP_ENC_CLASS(klass) \
+  (G_TYPE_CHECK_CLASS_TYPE((klass),GST_TYPE_SRTP_ENC))
+
+typedef struct _GstSrtpEnc GstSrtpEnc;
+typedef struct _GstSrtpEncClass GstSrtpEncClass;
+
+struct _GstSrtpEnc {
+  GstElement element;
+
+  GstPad *sinkpad;
+  GstPad *srcpad;
+
+  /* properties, protected by the object lock */
+  GstBuffer *key;
+  GstSrtpAuth rtp_auth;
+  gboolean key_changed;
+
+  /* streaming thread only */
+  GHashTable *streams;
+  guint rtp_tag_len;
+};
+
+struct _GstSrtpEncClass {
+  GstElementClass parent_class;
+
+  /* signals */
+  GstBuffer * (*request_key) (GstSrtpEnc * enc, guint ssrc);
+};
+
+GType gst_srtp_enc_get_type (void);
+
+G_END_DECLS
+
+#endif /* __GST_SRTP_ENC_H__ */
@@ -19,8 +19,17 @@
  * Boston, MA 02111-1307, USA.
  */
 
+#ifdef HAVE_CONFIG_H
+#  include "config.h"
+#endif
+
+#include <string.h>
 #include <glib.h>
 #include <gst/base/gsttypefindhelper.h>
+#ifdef HAVE_NETTLE
+#include <nettle/aes.h>
+#include <nettle/cbc.h>
+#endif
 #include "gstfragmented.h"
 #include "gstfragment.h"
 
@@ -45,6 +54,12 @@ struct _GstFragmentPrivate
   GstBuffer *buffer;
   GstCaps *caps;
   GMutex lock;
+#ifdef HAVE_NETTLE
+  gboolean decrypt;
+  struct CBC_CTX (struct aes_ctx, AES_BLOCK_SIZE) aes;
+  guint8 partial[AES_BLOCK_SIZE];       /* received data not decrypted yet */
+  gsize n_partial;
+#endif
 };
 
 G_DEFINE_TYPE (GstFragment, gst_fragment, G_TYPE_OBJECT);
@@ -243,6 +258,84 @@ gst_fragment_get_caps (GstFragment * fragment)
   return fragment->priv->caps;
 }
 
+/* Makes the fragment decrypt the buffers added to it with AES-128 in CBC
+ * mode. Returns FALSE if this build can't decrypt fragments */
+gboolean
+gst_fragment_set_decryption (GstFragment * fragment, const guint8 * key,
+    const guint8 * iv)
+{
+  g_return_val_if_fail (fragment != NULL, FALSE);
+  g_return_val_if_fail (fragment->priv->buffer == NULL, FALSE);
+
+#ifdef HAVE_NETTLE
+  aes_set_decrypt_key (&fragment->priv->aes.ctx, AES_BLOCK_SIZE, key);
+  CBC_SET_IV (&fragment->priv->aes, iv);
+  fragment->priv->n_partial = 0;
+  fragment->priv->decrypt = TRUE;
+  return TRUE;
+#else
+  GST_WARNING ("Built without nettle, can't decrypt fragments");
+  return FALSE;
+#endif
+}
+
+#ifdef HAVE_NETTLE
+/* Decrypts the whole blocks of @buffer in place as they arrive, so that the
+ * data doesn't need to be read again once the fragment is complete. The
+ * block split between two buffers is kept until the next one arrives */
+static GstBuffer *
+gst_fragment_decrypt_buffer (GstFragment * fragment, GstBuffer * buffer)
+{
+  GstFragmentPrivate *priv = fragment->priv;
+  GstBuffer *out = NULL;
+  GstMapInfo map;
+  gsize offset = 0, len, rest;
+
+  buffer = gst_buffer_make_writable (buffer);
+  if (!gst_buffer_map (buffer, &map, GST_MAP_READWRITE)) {
+    GST_WARNING ("Could not map buffer for decryption");
+    gst_buffer_unref (buffer);
+    return NULL;
+  }
+
+  if (priv->n_partial > 0) {
+    offset = MIN (AES_BLOCK_SIZE - priv->n_partial, map.size);
+    memcpy (priv->partial + priv->n_partial, map.data, offset);
+    priv->n_partial += offset;
+    if (priv->n_partial == AES_BLOCK_SIZE) {
+      CBC_DECRYPT (&priv->aes, aes_decrypt, AES_BLOCK_SIZE, priv->partial,
+          priv->partial);
+      out = gst_buffer_new_wrapped (g_memdup (priv->partial, AES_BLOCK_SIZE),
+          AES_BLOCK_SIZE);
+      priv->n_partial = 0;
+    }
+  }
+
+  len = (map.size - offset) & ~(AES_BLOCK_SIZE - 1);
+  if (len > 0)
+    CBC_DECRYPT (&priv->aes, aes_decrypt, len, map.data + offset,
+        map.data + offset);
+
+  rest = map.size - offset - len;
+  if (rest > 0) {
+    memcpy (priv->partial, map.data + offset + len, rest);
+    priv->n_partial = rest;
+  }
+  gst_buffer_unmap (buffer, &map);
+
+  if (len == 0) {
+    gst_buffer_unref (buffer);
+    return out;
+  }
+
+  /* the buffer is writable, drop the bytes kept in the partial block */
+  if (len != map.size)
+    gst_buffer_resize (buffer, offset, len);
+
+  return out ? gst_buffer_append (out, buffer) : buffer;
+}
+#endif
+
 gboolean
 gst_fragment_add_buffer (GstFragment * fragment, GstBuffer * buffer)
 {
@@ -254,6 +347,14 @@ gst_fragment_add_buffer (GstFragment * fragment, GstBuffer * buffer)
     return FALSE;
   }
 
+#ifdef HAVE_NETTLE
+  if (fragment->priv->decrypt) {
+    buffer = gst_fragment_decrypt_buffer (fragment, buffer);
+    if (buffer == NULL)
+      return TRUE;
+  }
+#endif
+
   GST_DEBUG ("Adding new buffer to the fragment");
   /* We steal the buffers you pass in */
   if (fragment->priv->buffer == NULL)
@@ -262,3 +363,36 @@ gst_fragment_add_buffer (GstFragment * fragment, GstBuffer * buffer)
     fragment->priv->buffer = gst_buffer_append (fragment->priv->buffer, buffer);
   return TRUE;
 }
+
+/* Marks the fragment as completed, removing the padding of the decrypted
+ * data. Returns FALSE if the decrypted data is not valid */
+gboolean
+gst_fragment_finish (GstFragment * fragment)
+{
+  g_return_val_if_fail (fragment != NULL, FALSE);
+
+#ifdef HAVE_NETTLE
+  if (fragment->priv->decrypt) {
+    GstFragmentPrivate *priv = fragment->priv;
+    gsize size;
+    guint8 pad;
+
+    if (priv->buffer == NULL || priv->n_partial > 0) {
+      GST_WARNING ("Encrypted data is not a multiple of the block size");
+      return FALSE;
+    }
+
+    /* PKCS7 padding, the last byte is the number of padding bytes */
+    size = gst_buffer_get_size (priv->buffer);
+    gst_buffer_extract (priv->buffer, size - 1, &pad, 1);
+    if (pad == 0 || pad > AES_BLOCK_SIZE) {
+      GST_WARNING ("Invalid padding, wrong key?");
+      return FALSE;
+    }
+    gst_buffer_resize (priv->buffer, 0, size - pad);
+  }
+#endif
+
+  fragment->completed = TRUE;
+  return TRUE;
+}
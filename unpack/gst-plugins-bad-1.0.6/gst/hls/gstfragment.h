@@ -64,6 +64,8 @@ GstBuffer * gst_fragment_get_buffer (GstFragment *fragment);
 void gst_fragment_set_caps (GstFragment * fragment, GstCaps * caps);
 GstCaps * gst_fragment_get_caps (GstFragment * fragment);
 gboolean gst_fragment_add_buffer (GstFragment *fragment, GstBuffer *buffer);
+gboolean gst_fragment_set_decryption (GstFragment *fragment, const guint8 *key, const guint8 *iv);
+gboolean gst_fragment_finish (GstFragment *fragment);
 GstFragment * gst_fragment_new (void);
 
 G_END_DECLS
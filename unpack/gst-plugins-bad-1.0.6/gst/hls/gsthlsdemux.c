@@ -46,6 +46,7 @@
 #define GLIB_DISABLE_DEPRECATION_WARNINGS
 
 #include <string.h>
+#include <math.h>
 #include <gst/glib-compat-private.h>
 #include "gsthlsdemux.h"
 
@@ -69,6 +70,8 @@ enum
   PROP_FRAGMENTS_CACHE,
   PROP_BITRATE_LIMIT,
   PROP_CONNECTION_SPEED,
+  PROP_PARALLEL_DOWNLOADS,
+  PROP_MAX_BUFFERED_FRAGMENTS,
   PROP_LAST
 };
 
@@ -78,6 +81,41 @@ static const float update_interval_factor[] = { 1, 0.5, 1.5, 3 };
 #define DEFAULT_FAILED_COUNT 3
 #define DEFAULT_BITRATE_LIMIT 0.8
 #define DEFAULT_CONNECTION_SPEED    0
+#define DEFAULT_PARALLEL_DOWNLOADS  2
+#define DEFAULT_MAX_BUFFERED_FRAGMENTS 6
+
+/* Keys are usually rotated every few fragments, don't keep all of them for
+ * long live streams */
+#define MAX_CACHED_KEYS 16
+
+/* Half-lives, in seconds of download time, of the two moving averages of the
+ * measured throughput. The fast one reacts to drops quickly, the slow one
+ * keeps short bursts from making us switch up */
+#define BANDWIDTH_FAST_HALF_LIFE 2.0
+#define BANDWIDTH_SLOW_HALF_LIFE 5.0
+/* Bytes that need to be measured before the estimate is trusted */
+#define BANDWIDTH_MIN_BYTES (64 * 1024)
+
+typedef enum
+{
+  DOWNLOAD_QUEUED,
+  DOWNLOAD_RUNNING,
+  DOWNLOAD_DONE
+} GstHLSDemuxDownloadState;
+
+struct _GstHLSDemuxDownload
+{
+  GstHLSDemuxDownloadState state;
+  gchar *uri;
+  GstClockTime duration;
+  GstClockTime timestamp;
+  gboolean discont;
+  gchar *key;                   /* URI of the AES-128 key, NULL if not encrypted */
+  guint8 iv[16];
+  gboolean typefind;            /* Whether the caps of the fragment are unknown */
+  guint concurrency;            /* Downloads running when this one started */
+  GstFragment *fragment;        /* The downloaded fragment, NULL on errors */
+};
 
 /* GObject */
 static void gst_hls_demux_set_property (GObject * object, guint prop_id,
@@ -85,6 +123,7 @@ static void gst_hls_demux_set_property (GObject * object, guint prop_id,
 static void gst_hls_demux_get_property (GObject * object, guint prop_id,
     GValue * value, GParamSpec * pspec);
 static void gst_hls_demux_dispose (GObject * obj);
+static void gst_hls_demux_finalize (GObject * obj);
 
 /* GstElement */
 static GstStateChangeReturn
@@ -106,8 +145,11 @@ static void gst_hls_demux_pause_tasks (GstHLSDemux * demux, gboolean caching);
 static gboolean gst_hls_demux_cache_fragments (GstHLSDemux * demux);
 static gboolean gst_hls_demux_schedule (GstHLSDemux * demux);
 static gboolean gst_hls_demux_switch_playlist (GstHLSDemux * demux);
-static gboolean gst_hls_demux_get_next_fragment (GstHLSDemux * demux,
-    gboolean caching);
+static void gst_hls_demux_download_func (GstHLSDemuxDownload * download,
+    GstHLSDemux * demux);
+static void gst_hls_demux_fill_prefetch (GstHLSDemux * demux);
+static void gst_hls_demux_cancel_downloads (GstHLSDemux * demux);
+static void gst_hls_demux_flush_fragments (GstHLSDemux * demux);
 static gboolean gst_hls_demux_update_playlist (GstHLSDemux * demux,
     gboolean update);
 static void gst_hls_demux_reset (GstHLSDemux * demux, gboolean dispose);
@@ -140,7 +182,7 @@ gst_hls_demux_dispose (GObject * obj)
     if (GST_TASK_STATE (demux->updates_task) != GST_TASK_STOPPED) {
       GST_DEBUG_OBJECT (demux, "Leaving updates task");
       demux->cancelled = TRUE;
-      gst_uri_downloader_cancel (demux->downloader);
+      gst_hls_demux_cancel_downloads (demux);
       gst_task_stop (demux->updates_task);
       g_mutex_lock (&demux->updates_timed_lock);
       GST_TASK_SIGNAL (demux->updates_task);
@@ -162,11 +204,27 @@ gst_hls_demux_dispose (GObject * obj)
 
   gst_hls_demux_reset (demux, TRUE);
 
+  g_thread_pool_free (demux->download_pool, FALSE, TRUE);
+  g_queue_foreach (demux->idle_downloaders, (GFunc) g_object_unref, NULL);
+  g_queue_free (demux->idle_downloaders);
+  g_queue_free (demux->downloads);
   g_queue_free (demux->queue);
 
   G_OBJECT_CLASS (parent_class)->dispose (obj);
 }
 
+static void
+gst_hls_demux_finalize (GObject * obj)
+{
+  GstHLSDemux *demux = GST_HLS_DEMUX (obj);
+
+  g_mutex_clear (&demux->download_lock);
+  g_cond_clear (&demux->download_cond);
+  g_hash_table_destroy (demux->keys);
+
+  G_OBJECT_CLASS (parent_class)->finalize (obj);
+}
+
 static void
 gst_hls_demux_class_init (GstHLSDemuxClass * klass)
 {
@@ -179,6 +237,7 @@ gst_hls_demux_class_init (GstHLSDemuxClass * klass)
   gobject_class->set_property = gst_hls_demux_set_property;
   gobject_class->get_property = gst_hls_demux_get_property;
   gobject_class->dispose = gst_hls_demux_dispose;
+  gobject_class->finalize = gst_hls_demux_finalize;
 
   g_object_class_install_property (gobject_class, PROP_FRAGMENTS_CACHE,
       g_param_spec_uint ("fragments-cache", "Fragments cache",
@@ -199,6 +258,19 @@ gst_hls_demux_class_init (GstHLSDemuxClass * klass)
           0, G_MAXUINT / 1000, DEFAULT_CONNECTION_SPEED,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  g_object_class_install_property (gobject_class, PROP_PARALLEL_DOWNLOADS,
+      g_param_spec_uint ("parallel-downloads", "Parallel downloads",
+          "Number of fragments that are downloaded at the same time",
+          1, 16, DEFAULT_PARALLEL_DOWNLOADS,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  g_object_class_install_property (gobject_class, PROP_MAX_BUFFERED_FRAGMENTS,
+      g_param_spec_uint ("max-buffered-fragments", "Max buffered fragments",
+          "Maximum number of fragments downloaded ahead of the playback "
+          "position (never less than fragments-cache)",
+          1, G_MAXUINT, DEFAULT_MAX_BUFFERED_FRAGMENTS,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   element_class->change_state = GST_DEBUG_FUNCPTR (gst_hls_demux_change_state);
 
   gst_element_class_add_pad_template (element_class,
@@ -238,9 +310,21 @@ gst_hls_demux_init (GstHLSDemux * demux)
   demux->fragments_cache = DEFAULT_FRAGMENTS_CACHE;
   demux->bitrate_limit = DEFAULT_BITRATE_LIMIT;
   demux->connection_speed = DEFAULT_CONNECTION_SPEED;
+  demux->parallel_downloads = DEFAULT_PARALLEL_DOWNLOADS;
+  demux->max_buffered_fragments = DEFAULT_MAX_BUFFERED_FRAGMENTS;
 
   demux->queue = g_queue_new ();
 
+  /* Fragment downloads */
+  g_mutex_init (&demux->download_lock);
+  g_cond_init (&demux->download_cond);
+  demux->downloads = g_queue_new ();
+  demux->idle_downloaders = g_queue_new ();
+  demux->keys = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
+  demux->download_pool =
+      g_thread_pool_new ((GFunc) gst_hls_demux_download_func, demux,
+      demux->parallel_downloads, FALSE, NULL);
+
   /* Updates task */
   g_rec_mutex_init (&demux->updates_lock);
   demux->updates_task =
@@ -271,6 +355,16 @@ gst_hls_demux_set_property (GObject * object, guint prop_id,
     case PROP_CONNECTION_SPEED:
       demux->connection_speed = g_value_get_uint (value) * 1000;
       break;
+    case PROP_PARALLEL_DOWNLOADS:
+      g_mutex_lock (&demux->download_lock);
+      demux->parallel_downloads = g_value_get_uint (value);
+      g_thread_pool_set_max_threads (demux->download_pool,
+          demux->parallel_downloads, NULL);
+      g_mutex_unlock (&demux->download_lock);
+      break;
+    case PROP_MAX_BUFFERED_FRAGMENTS:
+      demux->max_buffered_fragments = g_value_get_uint (value);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -293,6 +387,12 @@ gst_hls_demux_get_property (GObject * object, guint prop_id, GValue * value,
     case PROP_CONNECTION_SPEED:
       g_value_set_uint (value, demux->connection_speed / 1000);
       break;
+    case PROP_PARALLEL_DOWNLOADS:
+      g_value_set_uint (value, demux->parallel_downloads);
+      break;
+    case PROP_MAX_BUFFERED_FRAGMENTS:
+      g_value_set_uint (value, demux->max_buffered_fragments);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -326,13 +426,14 @@ gst_hls_demux_change_state (GstElement * element, GstStateChange transition)
   switch (transition) {
     case GST_STATE_CHANGE_PLAYING_TO_PAUSED:
       demux->cancelled = TRUE;
-      gst_uri_downloader_cancel (demux->downloader);
+      gst_hls_demux_cancel_downloads (demux);
       gst_task_stop (demux->updates_task);
       g_mutex_lock (&demux->updates_timed_lock);
       GST_TASK_SIGNAL (demux->updates_task);
       g_mutex_unlock (&demux->updates_timed_lock);
       g_rec_mutex_lock (&demux->updates_lock);
       g_rec_mutex_unlock (&demux->updates_lock);
+      gst_uri_downloader_reset (demux->downloader);
       demux->cancelled = FALSE;
       break;
     case GST_STATE_CHANGE_PAUSED_TO_READY:
@@ -362,10 +463,11 @@ gst_hls_demux_src_event (GstPad * pad, GstObject * parent, GstEvent * event)
       GstSeekFlags flags;
       GstSeekType start_type, stop_type;
       gint64 start, stop;
-      GList *walk;
-      GstClockTime position, current_pos, target_pos;
-      gint current_sequence;
+      GPtrArray *files;
+      GstClockTime position, target_pos;
+      gint current_sequence = -1;
       GstM3U8MediaFile *file;
+      guint lo, hi, mid;
 
       GST_INFO_OBJECT (demux, "Received GST_EVENT_SEEK");
 
@@ -384,24 +486,31 @@ gst_hls_demux_src_event (GstPad * pad, GstObject * parent, GstEvent * event)
           " stop: %" GST_TIME_FORMAT, rate, GST_TIME_ARGS (start),
           GST_TIME_ARGS (stop));
 
+      /* the files are sorted by offset, bisect to the one containing the
+       * target position */
       GST_M3U8_CLIENT_LOCK (demux->client);
-      file = GST_M3U8_MEDIA_FILE (demux->client->current->files->data);
-      current_sequence = file->sequence;
-      current_pos = 0;
-      target_pos = (GstClockTime) start;
-      for (walk = demux->client->current->files; walk; walk = walk->next) {
-        file = walk->data;
-
-        current_sequence = file->sequence;
-        if (current_pos <= target_pos
-            && target_pos < current_pos + file->duration) {
-          break;
+      files = demux->client->current->files;
+      if (files->len > 0) {
+        file = g_ptr_array_index (files, 0);
+        target_pos = file->offset + (GstClockTime) start;
+        lo = 0;
+        hi = files->len;
+        while (lo < hi) {
+          mid = lo + (hi - lo) / 2;
+          file = g_ptr_array_index (files, mid);
+          if (target_pos < file->offset) {
+            hi = mid;
+          } else if (target_pos >= file->offset + file->duration) {
+            lo = mid + 1;
+          } else {
+            current_sequence = file->sequence;
+            break;
+          }
         }
-        current_pos += file->duration;
       }
       GST_M3U8_CLIENT_UNLOCK (demux->client);
 
-      if (walk == NULL) {
+      if (current_sequence == -1) {
         GST_WARNING_OBJECT (demux, "Could not find seeked fragment");
         return FALSE;
       }
@@ -413,7 +522,7 @@ gst_hls_demux_src_event (GstPad * pad, GstObject * parent, GstEvent * event)
 
       demux->cancelled = TRUE;
       gst_task_pause (demux->stream_task);
-      gst_uri_downloader_cancel (demux->downloader);
+      gst_hls_demux_cancel_downloads (demux);
       gst_task_stop (demux->updates_task);
       g_mutex_lock (&demux->updates_timed_lock);
       GST_TASK_SIGNAL (demux->updates_task);
@@ -426,11 +535,7 @@ gst_hls_demux_src_event (GstPad * pad, GstObject * parent, GstEvent * event)
       g_rec_mutex_lock (&demux->stream_lock);
 
       demux->need_cache = TRUE;
-      while (!g_queue_is_empty (demux->queue)) {
-        GstFragment *fragment = g_queue_pop_head (demux->queue);
-        g_object_unref (fragment);
-      }
-      g_queue_clear (demux->queue);
+      gst_hls_demux_flush_fragments (demux);
 
       GST_M3U8_CLIENT_LOCK (demux->client);
       GST_DEBUG_OBJECT (demux, "seeking to sequence %d", current_sequence);
@@ -446,6 +551,7 @@ gst_hls_demux_src_event (GstPad * pad, GstObject * parent, GstEvent * event)
         gst_pad_push_event (demux->srcpad, gst_event_new_flush_stop (TRUE));
       }
 
+      gst_uri_downloader_reset (demux->downloader);
       demux->cancelled = FALSE;
       gst_task_start (demux->stream_task);
       g_rec_mutex_unlock (&demux->stream_lock);
@@ -611,7 +717,7 @@ gst_hls_demux_pause_tasks (GstHLSDemux * demux, gboolean caching)
 {
   if (GST_TASK_STATE (demux->updates_task) != GST_TASK_STOPPED) {
     demux->cancelled = TRUE;
-    gst_uri_downloader_cancel (demux->downloader);
+    gst_hls_demux_cancel_downloads (demux);
     gst_task_pause (demux->updates_task);
     if (!caching)
       g_mutex_lock (&demux->updates_timed_lock);
@@ -629,11 +735,12 @@ gst_hls_demux_pause_tasks (GstHLSDemux * demux, gboolean caching)
 static void
 gst_hls_demux_stop (GstHLSDemux * demux)
 {
-  gst_uri_downloader_cancel (demux->downloader);
+  gst_hls_demux_cancel_downloads (demux);
+  gst_hls_demux_flush_fragments (demux);
 
   if (GST_TASK_STATE (demux->updates_task) != GST_TASK_STOPPED) {
     demux->cancelled = TRUE;
-    gst_uri_downloader_cancel (demux->downloader);
+    gst_hls_demux_cancel_downloads (demux);
     gst_task_stop (demux->updates_task);
     g_mutex_lock (&demux->updates_timed_lock);
     GST_TASK_SIGNAL (demux->updates_task);
@@ -711,14 +818,28 @@ gst_hls_demux_stream_loop (GstHLSDemux * demux)
     GST_INFO_OBJECT (demux, "First fragments cached successfully");
   }
 
+  /* fragments are queued and the task restarted with the download lock held,
+   * so check for an empty queue and pause with the lock held too */
+  g_mutex_lock (&demux->download_lock);
   if (g_queue_is_empty (demux->queue)) {
-    if (demux->end_of_playlist)
+    /* live playlists get more fragments with the next update */
+    if (demux->end_of_playlist && g_queue_is_empty (demux->downloads) &&
+        !gst_m3u8_client_is_live (demux->client)) {
+      g_mutex_unlock (&demux->download_lock);
       goto end_of_playlist;
+    }
 
-    goto pause_task;
+    gst_task_pause (demux->stream_task);
+    g_mutex_unlock (&demux->download_lock);
+    return;
   }
 
   fragment = g_queue_pop_head (demux->queue);
+  demux->queued_duration -= fragment->stop_time - fragment->start_time;
+  /* there is room for another fragment now */
+  gst_hls_demux_fill_prefetch (demux);
+  g_mutex_unlock (&demux->download_lock);
+
   buf = gst_fragment_get_buffer (fragment);
 
   /* Figure out if we need to create/switch pads */
@@ -789,12 +910,6 @@ error_pushing:
     gst_hls_demux_pause_tasks (demux, FALSE);
     return;
   }
-
-pause_task:
-  {
-    gst_task_pause (demux->stream_task);
-    return;
-  }
 }
 
 static void
@@ -804,6 +919,8 @@ gst_hls_demux_reset (GstHLSDemux * demux, gboolean dispose)
   demux->end_of_playlist = FALSE;
   demux->cancelled = FALSE;
   demux->do_typefind = TRUE;
+  if (demux->downloader)
+    gst_uri_downloader_reset (demux->downloader);
 
   if (demux->input_caps) {
     gst_caps_unref (demux->input_caps);
@@ -824,11 +941,16 @@ gst_hls_demux_reset (GstHLSDemux * demux, gboolean dispose)
     demux->client = gst_m3u8_client_new ("");
   }
 
-  while (!g_queue_is_empty (demux->queue)) {
-    GstFragment *fragment = g_queue_pop_head (demux->queue);
-    g_object_unref (fragment);
-  }
-  g_queue_clear (demux->queue);
+  gst_hls_demux_flush_fragments (demux);
+
+  g_mutex_lock (&demux->download_lock);
+  demux->download_failed = FALSE;
+  demux->bw_fast = 0;
+  demux->bw_slow = 0;
+  demux->bw_weight = 0;
+  demux->bw_bytes = 0;
+  g_hash_table_remove_all (demux->keys);
+  g_mutex_unlock (&demux->download_lock);
 
   demux->position_shift = 0;
   demux->need_segment = TRUE;
@@ -847,6 +969,8 @@ gst_hls_demux_set_location (GstHLSDemux * demux, const gchar * uri)
 void
 gst_hls_demux_updates_loop (GstHLSDemux * demux)
 {
+  guint failed_count;
+
   /* Loop for the updates. It's started when the first fragments are cached and
    * schedules the next update of the playlist (for lives sources) and the next
    * update of fragments. When a new fragment is downloaded, it compares the
@@ -877,8 +1001,10 @@ gst_hls_demux_updates_loop (GstHLSDemux * demux)
       if (!gst_hls_demux_update_playlist (demux, TRUE)) {
         if (demux->cancelled)
           goto quit;
-        demux->client->update_failed_count++;
-        if (demux->client->update_failed_count < DEFAULT_FAILED_COUNT) {
+        GST_M3U8_CLIENT_LOCK (demux->client);
+        failed_count = ++demux->client->update_failed_count;
+        GST_M3U8_CLIENT_UNLOCK (demux->client);
+        if (failed_count < DEFAULT_FAILED_COUNT) {
           GST_WARNING_OBJECT (demux, "Could not update the playlist");
           continue;
         } else {
@@ -892,43 +1018,33 @@ gst_hls_demux_updates_loop (GstHLSDemux * demux)
     /* if it's a live source and the playlist couldn't be updated, there aren't
      * more fragments in the playlist, so we just wait for the next schedulled
      * update */
-    if (gst_m3u8_client_is_live (demux->client) &&
-        demux->client->update_failed_count > 0) {
+    GST_M3U8_CLIENT_LOCK (demux->client);
+    failed_count = demux->client->update_failed_count;
+    GST_M3U8_CLIENT_UNLOCK (demux->client);
+    if (gst_m3u8_client_is_live (demux->client) && failed_count > 0) {
       GST_WARNING_OBJECT (demux,
-          "The playlist hasn't been updated, failed count is %d",
-          demux->client->update_failed_count);
+          "The playlist hasn't been updated, failed count is %d", failed_count);
       continue;
     }
 
     if (demux->cancelled)
       goto quit;
 
-    /* fetch the next fragment */
-    if (g_queue_is_empty (demux->queue)) {
-      if (!gst_hls_demux_get_next_fragment (demux, FALSE)) {
-        if (demux->cancelled) {
-          goto quit;
-        } else if (!demux->end_of_playlist && !demux->cancelled) {
-          demux->client->update_failed_count++;
-          if (demux->client->update_failed_count < DEFAULT_FAILED_COUNT) {
-            GST_WARNING_OBJECT (demux, "Could not fetch the next fragment");
-            continue;
-          } else {
-            GST_ELEMENT_ERROR (demux, RESOURCE, NOT_FOUND,
-                ("Could not fetch the next fragment"), (NULL));
-            goto error;
-          }
-        }
-      } else {
-        demux->client->update_failed_count = 0;
+    /* start downloading the fragments that fit in the prefetch window, the
+     * download threads keep it filled until the next update */
+    g_mutex_lock (&demux->download_lock);
+    if (demux->download_failed) {
+      g_mutex_unlock (&demux->download_lock);
+      goto error;
+    }
+    gst_hls_demux_fill_prefetch (demux);
+    g_mutex_unlock (&demux->download_lock);
 
-        if (demux->cancelled)
-          goto quit;
+    if (demux->cancelled)
+      goto quit;
 
-        /* try to switch to another bitrate if needed */
-        gst_hls_demux_switch_playlist (demux);
-      }
-    }
+    /* try to switch to another bitrate if needed */
+    gst_hls_demux_switch_playlist (demux);
   }
 
 quit:
@@ -986,24 +1102,42 @@ gst_hls_demux_cache_fragments (GstHLSDemux * demux)
           gst_message_new_duration_changed (GST_OBJECT (demux)));
   }
 
-  /* Cache the first fragments */
-  for (i = 0; i < demux->fragments_cache; i++) {
-    gst_element_post_message (GST_ELEMENT (demux),
-        gst_message_new_buffering (GST_OBJECT (demux),
-            100 * i / demux->fragments_cache));
-    g_get_current_time (&demux->next_update);
-    if (!gst_hls_demux_get_next_fragment (demux, TRUE)) {
-      if (demux->end_of_playlist)
-        break;
+  /* Cache the first fragments. They are downloaded in parallel by the
+   * download threads, we only wait for them to be queued */
+  g_mutex_lock (&demux->download_lock);
+  gst_hls_demux_fill_prefetch (demux);
+  i = -1;
+  while (TRUE) {
+    gint queued = g_queue_get_length (demux->queue);
+
+    if (queued >= demux->fragments_cache || (demux->end_of_playlist
+            && g_queue_is_empty (demux->downloads)))
+      break;
+
+    /* make sure we stop caching fragments if something cancelled it */
+    if (demux->cancelled || demux->download_failed) {
+      g_mutex_unlock (&demux->download_lock);
       if (!demux->cancelled)
         GST_ERROR_OBJECT (demux, "Error caching the first fragments");
       return FALSE;
     }
-    /* make sure we stop caching fragments if something cancelled it */
-    if (demux->cancelled)
-      return FALSE;
-    gst_hls_demux_switch_playlist (demux);
+
+    if (queued != i) {
+      i = queued;
+      g_mutex_unlock (&demux->download_lock);
+      gst_element_post_message (GST_ELEMENT (demux),
+          gst_message_new_buffering (GST_OBJECT (demux),
+              100 * i / demux->fragments_cache));
+      if (i > 0)
+        gst_hls_demux_switch_playlist (demux);
+      g_mutex_lock (&demux->download_lock);
+      continue;
+    }
+
+    g_cond_wait (&demux->download_cond, &demux->download_lock);
   }
+  g_mutex_unlock (&demux->download_lock);
+
   gst_element_post_message (GST_ELEMENT (demux),
       gst_message_new_buffering (GST_OBJECT (demux), 100));
 
@@ -1070,14 +1204,16 @@ gst_hls_demux_update_playlist (GstHLSDemux * demux, gboolean update)
    * three fragments before the end of the list */
   if (updated && update == FALSE && demux->client->current &&
       gst_m3u8_client_is_live (demux->client)) {
+    GPtrArray *files;
     guint last_sequence;
 
     GST_M3U8_CLIENT_LOCK (demux->client);
-    last_sequence =
-        GST_M3U8_MEDIA_FILE (g_list_last (demux->client->current->
-            files)->data)->sequence;
+    files = demux->client->current->files;
+    last_sequence = files->len == 0 ? 0 :
+        GST_M3U8_MEDIA_FILE (g_ptr_array_index (files,
+            files->len - 1))->sequence;
 
-    if (demux->client->sequence >= last_sequence - 3) {
+    if (files->len > 0 && demux->client->sequence >= last_sequence - 3) {
       GST_DEBUG_OBJECT (demux, "Sequence is beyond playlist. Moving back to %d",
           last_sequence - 3);
       demux->need_segment = TRUE;
@@ -1152,8 +1288,11 @@ retry_failover_protection:
       return gst_hls_demux_change_playlist (demux, new_bandwidth - 1);
   }
 
-  /* Force typefinding since we might have changed media type */
+  /* Force typefinding since we might have changed media type. The flag is
+   * read by the download threads when they queue the next fragment */
+  g_mutex_lock (&demux->download_lock);
   demux->do_typefind = TRUE;
+  g_mutex_unlock (&demux->download_lock);
 
   return TRUE;
 }
@@ -1170,7 +1309,9 @@ gst_hls_demux_schedule (GstHLSDemux * demux)
    * minimum delay is a multiple of the target duration.  This multiple is
    * 0.5 for the first attempt, 1.5 for the second, and 3.0 thereafter."
    */
+  GST_M3U8_CLIENT_LOCK (demux->client);
   count = demux->client->update_failed_count;
+  GST_M3U8_CLIENT_UNLOCK (demux->client);
   if (count < 3)
     update_factor = update_interval_factor[count];
   else
@@ -1187,99 +1328,394 @@ gst_hls_demux_schedule (GstHLSDemux * demux)
   return TRUE;
 }
 
+static void
+gst_hls_demux_update_bandwidth (GstHLSDemux * demux, gsize size,
+    GstClockTime time)
+{
+  gdouble seconds, bps, alpha;
+
+  /* must be called with the download lock */
+  if (time == 0)
+    return;
+
+  seconds = (gdouble) time / GST_SECOND;
+  bps = size * 8 / seconds;
+
+  /* moving averages where each sample is weighted by its download time, so
+   * that a small fragment that happened to be fast doesn't count as much as
+   * a large one */
+  alpha = pow (0.5, seconds / BANDWIDTH_FAST_HALF_LIFE);
+  demux->bw_fast = alpha * demux->bw_fast + (1 - alpha) * bps;
+  alpha = pow (0.5, seconds / BANDWIDTH_SLOW_HALF_LIFE);
+  demux->bw_slow = alpha * demux->bw_slow + (1 - alpha) * bps;
+  demux->bw_weight += seconds;
+  demux->bw_bytes += size;
+
+  GST_DEBUG_OBJECT (demux, "Downloaded %" G_GSIZE_FORMAT " bytes in %"
+      GST_TIME_FORMAT ". Bitrate is : %.0f", size, GST_TIME_ARGS (time), bps);
+}
+
+static guint
+gst_hls_demux_get_bandwidth (GstHLSDemux * demux)
+{
+  gdouble fast, slow;
+
+  /* must be called with the download lock */
+  if (demux->bw_bytes < BANDWIDTH_MIN_BYTES)
+    return 0;
+
+  /* both averages start from 0, correct for the missing history */
+  fast = demux->bw_fast / (1 - pow (0.5,
+          demux->bw_weight / BANDWIDTH_FAST_HALF_LIFE));
+  slow = demux->bw_slow / (1 - pow (0.5,
+          demux->bw_weight / BANDWIDTH_SLOW_HALF_LIFE));
+
+  /* drops are followed quickly, increases only when they last */
+  return MIN (MIN (fast, slow), G_MAXUINT);
+}
+
 static gboolean
 gst_hls_demux_switch_playlist (GstHLSDemux * demux)
 {
-  GTimeVal now;
-  GstClockTime diff;
-  gsize size;
-  gint bitrate;
-  GstFragment *fragment = g_queue_peek_tail (demux->queue);
-  GstBuffer *buffer;
+  GstClockTime buffered, low_watermark;
+  guint bitrate, max_bitrate, current_bitrate;
 
   GST_M3U8_CLIENT_LOCK (demux->client);
   if (!demux->client->main->lists) {
     GST_M3U8_CLIENT_UNLOCK (demux->client);
     return TRUE;
   }
+  current_bitrate =
+      GST_M3U8 (demux->client->main->current_variant->data)->bandwidth;
   GST_M3U8_CLIENT_UNLOCK (demux->client);
 
-  /* compare the time when the fragment was downloaded with the time when it was
-   * scheduled */
-  g_get_current_time (&now);
-  diff = (GST_TIMEVAL_TO_TIME (now) - GST_TIMEVAL_TO_TIME (demux->next_update));
-  buffer = gst_fragment_get_buffer (fragment);
-  size = gst_buffer_get_size (buffer);
-  bitrate = (size * 8) / ((double) diff / GST_SECOND);
+  g_mutex_lock (&demux->download_lock);
+  bitrate = gst_hls_demux_get_bandwidth (demux);
+  buffered = demux->queued_duration;
+  g_mutex_unlock (&demux->download_lock);
+
+  /* not enough data measured yet */
+  if (bitrate == 0)
+    return TRUE;
+
+  GST_DEBUG_OBJECT (demux, "Estimated bitrate is : %u, %" GST_TIME_FORMAT
+      " queued", bitrate, GST_TIME_ARGS (buffered));
+
+  /* The queue of downloaded fragments decides how much the estimate is
+   * trusted. Going up needs as much queued as we cache before starting, so
+   * that a wrong estimate doesn't stall playback. Going down is delayed
+   * while the queue is twice that and the current variant still fits in the
+   * bandwidth without the bitrate-limit margin. This keeps us from switching
+   * back and forth around a variant's bitrate */
+  low_watermark = demux->fragments_cache *
+      gst_m3u8_client_get_target_duration (demux->client);
+  max_bitrate = bitrate * demux->bitrate_limit;
+
+  if (max_bitrate > current_bitrate) {
+    if (!demux->need_cache && buffered < low_watermark)
+      max_bitrate = current_bitrate;
+  } else if (current_bitrate <= bitrate && buffered >= 2 * low_watermark) {
+    max_bitrate = current_bitrate;
+  }
 
-  GST_DEBUG ("Downloaded %d bytes in %" GST_TIME_FORMAT ". Bitrate is : %d",
-      (guint) size, GST_TIME_ARGS (diff), bitrate);
+  return gst_hls_demux_change_playlist (demux, max_bitrate);
+}
 
-  gst_buffer_unref (buffer);
-  return gst_hls_demux_change_playlist (demux, bitrate * demux->bitrate_limit);
+static void
+gst_hls_demux_download_free (GstHLSDemuxDownload * download)
+{
+  if (download->fragment)
+    g_object_unref (download->fragment);
+  g_free (download->uri);
+  g_free (download->key);
+  g_slice_free (GstHLSDemuxDownload, download);
 }
 
-static gboolean
-gst_hls_demux_get_next_fragment (GstHLSDemux * demux, gboolean caching)
+static void
+gst_hls_demux_start_download (GstHLSDemux * demux,
+    GstHLSDemuxDownload * download)
 {
-  GstFragment *download;
-  const gchar *next_fragment_uri;
-  GstClockTime duration;
-  GstClockTime timestamp;
-  GstBuffer *buf;
-  gboolean discont;
+  GST_INFO_OBJECT (demux, "Fetching next fragment %s", download->uri);
 
-  if (!gst_m3u8_client_get_next_fragment (demux->client, &discont,
-          &next_fragment_uri, &duration, &timestamp)) {
-    GST_INFO_OBJECT (demux, "This playlist doesn't contain more fragments");
-    demux->end_of_playlist = TRUE;
-    gst_task_start (demux->stream_task);
-    return FALSE;
-  }
+  download->state = DOWNLOAD_RUNNING;
+  download->concurrency = ++demux->n_downloading;
+  g_thread_pool_push (demux->download_pool, download, NULL);
+}
 
-  GST_INFO_OBJECT (demux, "Fetching next fragment %s", next_fragment_uri);
+/* Starts downloading fragments until parallel-downloads are running or the
+ * downloaded and downloading fragments fill max-buffered-fragments. Must be
+ * called with the download lock */
+static void
+gst_hls_demux_fill_prefetch (GstHLSDemux * demux)
+{
+  GstHLSDemuxDownload *download;
+  guint max_buffered;
+  GList *walk;
 
-  download = gst_uri_downloader_fetch_uri (demux->downloader,
-      next_fragment_uri);
+  if (demux->cancelled || demux->download_flushing || demux->download_failed)
+    return;
 
-  if (download == NULL)
-    goto error;
+  /* first restart the downloads that were cancelled by a state change */
+  for (walk = demux->downloads->head; walk; walk = walk->next) {
+    download = walk->data;
 
-  buf = gst_fragment_get_buffer (download);
-  GST_BUFFER_DURATION (buf) = duration;
-  GST_BUFFER_PTS (buf) = timestamp;
-
-  /* We actually need to do this every time we switch bitrate */
-  if (G_UNLIKELY (demux->do_typefind)) {
-    GstCaps *caps = gst_fragment_get_caps (download);
-
-    if (!demux->input_caps || !gst_caps_is_equal (caps, demux->input_caps)) {
-      gst_caps_replace (&demux->input_caps, caps);
-      /* gst_pad_set_caps (demux->srcpad, demux->input_caps); */
-      GST_INFO_OBJECT (demux, "Input source caps: %" GST_PTR_FORMAT,
-          demux->input_caps);
-      demux->do_typefind = FALSE;
+    if (demux->n_downloading >= demux->parallel_downloads)
+      return;
+    if (download->state == DOWNLOAD_QUEUED)
+      gst_hls_demux_start_download (demux, download);
+  }
+
+  max_buffered = MAX (demux->max_buffered_fragments, demux->fragments_cache);
+  while (demux->n_downloading < demux->parallel_downloads &&
+      g_queue_get_length (demux->queue) +
+      g_queue_get_length (demux->downloads) < max_buffered) {
+    download = g_slice_new0 (GstHLSDemuxDownload);
+
+    if (!gst_m3u8_client_get_next_fragment (demux->client, &download->discont,
+            &download->uri, &download->duration, &download->timestamp,
+            &download->key, download->iv)) {
+      GST_INFO_OBJECT (demux, "This playlist doesn't contain more fragments");
+      g_slice_free (GstHLSDemuxDownload, download);
+      demux->end_of_playlist = TRUE;
+      gst_task_start (demux->stream_task);
+      return;
     }
-    gst_caps_unref (caps);
-  } else {
-    gst_fragment_set_caps (download, demux->input_caps);
+    /* live playlists get more fragments with the updates */
+    demux->end_of_playlist = FALSE;
+
+    download->typefind = demux->do_typefind;
+    demux->do_typefind = FALSE;
+    g_queue_push_tail (demux->downloads, download);
+    gst_hls_demux_start_download (demux, download);
   }
+}
+
+/* Moves the downloaded fragments at the head of the downloads to the queue of
+ * the streaming task, so that they are pushed in playlist order. Must be
+ * called with the download lock */
+static void
+gst_hls_demux_collect_downloads (GstHLSDemux * demux)
+{
+  GstHLSDemuxDownload *download;
+  gboolean collected = FALSE;
+
+  while ((download = g_queue_peek_head (demux->downloads)) != NULL &&
+      download->state == DOWNLOAD_DONE && download->fragment != NULL) {
+    GstFragment *fragment = download->fragment;
+    GstBuffer *buf;
+
+    g_queue_pop_head (demux->downloads);
+    download->fragment = NULL;
+
+    buf = gst_fragment_get_buffer (fragment);
+    GST_BUFFER_DURATION (buf) = download->duration;
+    GST_BUFFER_PTS (buf) = download->timestamp;
+
+    /* We actually need to do this every time we switch bitrate */
+    if (G_UNLIKELY (download->typefind)) {
+      GstCaps *caps = gst_fragment_get_caps (fragment);
 
-  if (discont) {
-    GST_DEBUG_OBJECT (demux, "Marking fragment as discontinuous");
-    GST_BUFFER_FLAG_SET (buf, GST_BUFFER_FLAG_DISCONT);
+      if (!demux->input_caps || !gst_caps_is_equal (caps, demux->input_caps)) {
+        gst_caps_replace (&demux->input_caps, caps);
+        GST_INFO_OBJECT (demux, "Input source caps: %" GST_PTR_FORMAT,
+            demux->input_caps);
+      }
+      gst_caps_unref (caps);
+    } else {
+      gst_fragment_set_caps (fragment, demux->input_caps);
+    }
+
+    if (download->discont) {
+      GST_DEBUG_OBJECT (demux, "Marking fragment as discontinuous");
+      GST_BUFFER_FLAG_SET (buf, GST_BUFFER_FLAG_DISCONT);
+    }
+    gst_buffer_unref (buf);
+
+    /* the streaming task uses these to keep track of the queued duration */
+    fragment->start_time = download->timestamp;
+    fragment->stop_time = download->timestamp + download->duration;
+    demux->queued_duration += download->duration;
+
+    g_queue_push_tail (demux->queue, fragment);
+    gst_hls_demux_download_free (download);
+    collected = TRUE;
   }
 
-  g_queue_push_tail (demux->queue, download);
-  if (!caching) {
-    GST_TASK_SIGNAL (demux->updates_task);
+  if (collected && !demux->download_flushing) {
+    GST_M3U8_CLIENT_LOCK (demux->client);
+    demux->client->update_failed_count = 0;
+    GST_M3U8_CLIENT_UNLOCK (demux->client);
     gst_task_start (demux->stream_task);
   }
-  return TRUE;
+}
 
-error:
-  {
-    gst_hls_demux_stop (demux);
+/* Gets the AES-128 key at @uri, from the cache when a previous fragment used
+ * the same key. Must be called without the download lock */
+static gboolean
+gst_hls_demux_get_key (GstHLSDemux * demux, GstUriDownloader * downloader,
+    const gchar * uri, guint8 * key)
+{
+  GstFragment *fragment;
+  GstBuffer *buf;
+  guint8 *cached;
+  gboolean ret = FALSE;
+
+  g_mutex_lock (&demux->download_lock);
+  cached = g_hash_table_lookup (demux->keys, uri);
+  if (cached)
+    memcpy (key, cached, 16);
+  g_mutex_unlock (&demux->download_lock);
+
+  if (cached)
+    return TRUE;
+
+  GST_INFO_OBJECT (demux, "Fetching key %s", uri);
+  fragment = gst_uri_downloader_fetch_uri (downloader, uri);
+  if (fragment == NULL)
     return FALSE;
+
+  buf = gst_fragment_get_buffer (fragment);
+  if (buf != NULL && gst_buffer_get_size (buf) == 16) {
+    gst_buffer_extract (buf, 0, key, 16);
+
+    g_mutex_lock (&demux->download_lock);
+    if (g_hash_table_size (demux->keys) >= MAX_CACHED_KEYS)
+      g_hash_table_remove_all (demux->keys);
+    g_hash_table_insert (demux->keys, g_strdup (uri), g_memdup (key, 16));
+    g_mutex_unlock (&demux->download_lock);
+    ret = TRUE;
+  } else {
+    GST_WARNING_OBJECT (demux, "Invalid key %s", uri);
   }
+
+  if (buf)
+    gst_buffer_unref (buf);
+  g_object_unref (fragment);
+
+  return ret;
+}
+
+static void
+gst_hls_demux_download_func (GstHLSDemuxDownload * download,
+    GstHLSDemux * demux)
+{
+  GstUriDownloader *downloader;
+  GstFragment *fragment = NULL;
+  guint8 key[16];
+  gboolean encrypted = download->key != NULL;
+  gboolean failed = FALSE;
+  guint retries = 0;
+
+  g_mutex_lock (&demux->download_lock);
+  downloader = g_queue_pop_head (demux->idle_downloaders);
+  if (downloader == NULL)
+    downloader = gst_uri_downloader_new ();
+  demux->active_downloaders =
+      g_list_prepend (demux->active_downloaders, downloader);
+
+  while (fragment == NULL && retries < DEFAULT_FAILED_COUNT &&
+      !demux->cancelled && !demux->download_flushing) {
+    if (retries > 0)
+      GST_WARNING_OBJECT (demux, "Could not fetch the next fragment, retrying");
+
+    /* the downloader is in the active list from here, a cancel happening
+     * after the unlock makes the fetch fail even if it hasn't started yet */
+    gst_uri_downloader_reset (downloader);
+    g_mutex_unlock (&demux->download_lock);
+    if (download->key == NULL) {
+      fragment = gst_uri_downloader_fetch_uri (downloader, download->uri);
+    } else if (gst_hls_demux_get_key (demux, downloader, download->key, key)) {
+      /* decrypted as it is received */
+      fragment = gst_uri_downloader_fetch_uri_with_key (downloader,
+          download->uri, key, download->iv);
+    }
+    g_mutex_lock (&demux->download_lock);
+
+    if (fragment != NULL && !fragment->completed) {
+      g_object_unref (fragment);
+      fragment = NULL;
+    }
+    retries++;
+  }
+
+  demux->active_downloaders =
+      g_list_remove (demux->active_downloaders, downloader);
+  g_queue_push_head (demux->idle_downloaders, downloader);
+  demux->n_downloading--;
+
+  if (fragment != NULL) {
+    GstBuffer *buf = gst_fragment_get_buffer (fragment);
+    guint concurrency;
+
+    /* The downloads running at the same time share the link, scale the
+     * throughput of this one by the number of downloads that were running
+     * during all of it */
+    concurrency = MIN (download->concurrency, demux->n_downloading + 1);
+    gst_hls_demux_update_bandwidth (demux,
+        gst_buffer_get_size (buf) * concurrency,
+        fragment->download_stop_time - fragment->download_start_time);
+    gst_buffer_unref (buf);
+
+    download->fragment = fragment;
+    download->state = DOWNLOAD_DONE;
+  } else if (demux->cancelled || demux->download_flushing) {
+    /* restarted by the next gst_hls_demux_fill_prefetch() */
+    download->state = DOWNLOAD_QUEUED;
+  } else {
+    download->state = DOWNLOAD_DONE;
+    demux->download_failed = TRUE;
+    failed = TRUE;
+  }
+
+  gst_hls_demux_collect_downloads (demux);
+  gst_hls_demux_fill_prefetch (demux);
+  g_cond_broadcast (&demux->download_cond);
+  g_mutex_unlock (&demux->download_lock);
+
+  if (failed && encrypted)
+    GST_ELEMENT_ERROR (demux, STREAM, DECRYPT,
+        ("Could not fetch or decrypt the next fragment"), (NULL));
+  else if (failed)
+    GST_ELEMENT_ERROR (demux, RESOURCE, NOT_FOUND,
+        ("Could not fetch the next fragment"), (NULL));
+}
+
+static void
+gst_hls_demux_cancel_downloads (GstHLSDemux * demux)
+{
+  gst_uri_downloader_cancel (demux->downloader);
+
+  g_mutex_lock (&demux->download_lock);
+  g_list_foreach (demux->active_downloaders,
+      (GFunc) gst_uri_downloader_cancel, NULL);
+  /* wake up the streaming task if it waits for the first fragments */
+  g_cond_broadcast (&demux->download_cond);
+  g_mutex_unlock (&demux->download_lock);
+}
+
+/* Cancels the downloads, waits until the download threads are done with them
+ * and drops all downloaded fragments */
+static void
+gst_hls_demux_flush_fragments (GstHLSDemux * demux)
+{
+  GstHLSDemuxDownload *download;
+  GstFragment *fragment;
+
+  g_mutex_lock (&demux->download_lock);
+  demux->download_flushing = TRUE;
+  /* the cancel is kept until the download threads check the flushing flag,
+   * so downloads that didn't start to fetch yet are cancelled too */
+  g_list_foreach (demux->active_downloaders,
+      (GFunc) gst_uri_downloader_cancel, NULL);
+  while (demux->n_downloading > 0)
+    g_cond_wait (&demux->download_cond, &demux->download_lock);
+
+  while ((download = g_queue_pop_head (demux->downloads)))
+    gst_hls_demux_download_free (download);
+  while ((fragment = g_queue_pop_head (demux->queue)))
+    g_object_unref (fragment);
+  demux->queued_duration = 0;
+  demux->end_of_playlist = FALSE;
+  demux->download_flushing = FALSE;
+  g_mutex_unlock (&demux->download_lock);
 }
@@ -45,6 +45,7 @@ G_BEGIN_DECLS
   (G_TYPE_INSTANCE_GET_CLASS ((obj),GST_TYPE_HLS_DEMUX,GstHLSDemuxClass))
 typedef struct _GstHLSDemux GstHLSDemux;
 typedef struct _GstHLSDemuxClass GstHLSDemuxClass;
+typedef struct _GstHLSDemuxDownload GstHLSDemuxDownload;
 
 /**
  * GstHLSDemux:
@@ -63,6 +64,7 @@ struct _GstHLSDemux
   GstUriDownloader *downloader;
   GstM3U8Client *client;        /* M3U8 client */
   GQueue *queue;                /* Queue storing the fetched fragments */
+  GstClockTime queued_duration; /* Duration of the fragments in the queue */
   gboolean need_cache;          /* Wheter we need to cache some fragments before starting to push data */
   gboolean end_of_playlist;
   gboolean do_typefind;         /* Whether we need to typefind the next buffer */
@@ -71,6 +73,8 @@ struct _GstHLSDemux
   guint fragments_cache;        /* number of fragments needed to be cached to start playing */
   gfloat bitrate_limit;         /* limit of the available bitrate to use */
   guint connection_speed;       /* Network connection speed in kbps (0 = unknown) */
+  guint parallel_downloads;     /* number of fragments downloaded at the same time */
+  guint max_buffered_fragments; /* number of fragments downloaded ahead */
 
   /* Streaming task */
   GstTask *stream_task;
@@ -84,6 +88,24 @@ struct _GstHLSDemux
   GTimeVal next_update;         /* Time of the next update */
   gboolean cancelled;
 
+  /* Fragment prefetching, protected by download_lock */
+  GMutex download_lock;
+  GCond download_cond;
+  GThreadPool *download_pool;
+  GQueue *downloads;            /* GstHLSDemuxDownload in playlist order */
+  guint n_downloading;          /* downloads running in the pool */
+  GQueue *idle_downloaders;     /* GstUriDownloader not in use */
+  GList *active_downloaders;    /* GstUriDownloader fetching a fragment */
+  gboolean download_flushing;   /* downloads are being cancelled and dropped */
+  gboolean download_failed;
+  GHashTable *keys;             /* AES-128 keys of the fragments by URI */
+
+  /* Bandwidth estimation, protected by download_lock */
+  gdouble bw_fast;              /* EWMA of the throughput in bps, short half-life */
+  gdouble bw_slow;              /* EWMA of the throughput in bps, long half-life */
+  gdouble bw_weight;            /* total seconds of download in the averages */
+  guint64 bw_bytes;             /* total bytes measured */
+
   /* Position in the stream */
   GstClockTime position_shift;
   gboolean need_segment;
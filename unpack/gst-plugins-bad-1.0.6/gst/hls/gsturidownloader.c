@@ -39,6 +39,7 @@ struct _GstUriDownloaderPrivate
   GstPad *pad;
   GTimeVal *timeout;
   GstFragment *download;
+  gboolean cancelled;           /* fetches fail until the next reset */
   GMutex lock;
   GCond cond;
 };
@@ -52,6 +53,7 @@ static gboolean gst_uri_downloader_sink_event (GstPad * pad, GstObject * parent,
     GstEvent * event);
 static GstBusSyncReply gst_uri_downloader_bus_handler (GstBus * bus,
     GstMessage * message, gpointer data);
+static void gst_uri_downloader_abort (GstUriDownloader * downloader);
 
 static GstStaticPadTemplate sinkpadtemplate = GST_STATIC_PAD_TEMPLATE ("sink",
     GST_PAD_SINK,
@@ -162,9 +164,14 @@ gst_uri_downloader_sink_event (GstPad * pad, GstObject * parent,
       GST_DEBUG_OBJECT (downloader, "Got EOS on the fetcher pad");
       if (downloader->priv->download != NULL) {
         /* signal we have fetched the URI */
-        downloader->priv->download->completed = TRUE;
-        downloader->priv->download->download_stop_time =
-            gst_util_get_timestamp ();
+        if (!gst_fragment_finish (downloader->priv->download)) {
+          GST_WARNING_OBJECT (downloader, "Could not decrypt the download");
+          g_object_unref (downloader->priv->download);
+          downloader->priv->download = NULL;
+        } else {
+          downloader->priv->download->download_stop_time =
+              gst_util_get_timestamp ();
+        }
         GST_OBJECT_UNLOCK (downloader);
         GST_DEBUG_OBJECT (downloader, "Signaling chain funtion");
         g_mutex_lock (&downloader->priv->lock);
@@ -205,7 +212,7 @@ gst_uri_downloader_bus_handler (GstBus * bus,
 
     /* remove the sync handler to avoid duplicated messages */
     gst_bus_set_sync_handler (downloader->priv->bus, NULL, NULL, NULL);
-    gst_uri_downloader_cancel (downloader);
+    gst_uri_downloader_abort (downloader);
   }
 
   gst_message_unref (message);
@@ -263,8 +270,9 @@ gst_uri_downloader_stop (GstUriDownloader * downloader)
       GST_CLOCK_TIME_NONE);
 }
 
-void
-gst_uri_downloader_cancel (GstUriDownloader * downloader)
+/* Stops the current download, if any, without failing the next ones */
+static void
+gst_uri_downloader_abort (GstUriDownloader * downloader)
 {
   GST_OBJECT_LOCK (downloader);
   if (downloader->priv->download != NULL) {
@@ -283,6 +291,27 @@ gst_uri_downloader_cancel (GstUriDownloader * downloader)
   }
 }
 
+/* Cancels the current download and makes the next fetches fail immediately
+ * until gst_uri_downloader_reset() is called, so that a fetch about to start
+ * in another thread is cancelled too */
+void
+gst_uri_downloader_cancel (GstUriDownloader * downloader)
+{
+  GST_OBJECT_LOCK (downloader);
+  downloader->priv->cancelled = TRUE;
+  GST_OBJECT_UNLOCK (downloader);
+
+  gst_uri_downloader_abort (downloader);
+}
+
+void
+gst_uri_downloader_reset (GstUriDownloader * downloader)
+{
+  GST_OBJECT_LOCK (downloader);
+  downloader->priv->cancelled = FALSE;
+  GST_OBJECT_UNLOCK (downloader);
+}
+
 static gboolean
 gst_uri_downloader_set_uri (GstUriDownloader * downloader, const gchar * uri)
 {
@@ -313,6 +342,15 @@ gst_uri_downloader_set_uri (GstUriDownloader * downloader, const gchar * uri)
 
 GstFragment *
 gst_uri_downloader_fetch_uri (GstUriDownloader * downloader, const gchar * uri)
+{
+  return gst_uri_downloader_fetch_uri_with_key (downloader, uri, NULL, NULL);
+}
+
+/* Fetches @uri decrypting it with the AES-128 @key and @iv as the data is
+ * received, or without decrypting it if @key is NULL */
+GstFragment *
+gst_uri_downloader_fetch_uri_with_key (GstUriDownloader * downloader,
+    const gchar * uri, const guint8 * key, const guint8 * iv)
 {
   GstStateChangeReturn ret;
   GstFragment *download = NULL;
@@ -323,12 +361,33 @@ gst_uri_downloader_fetch_uri (GstUriDownloader * downloader, const gchar * uri)
     goto quit;
   }
 
-  downloader->priv->download = gst_fragment_new ();
+  download = gst_fragment_new ();
+  if (key != NULL && !gst_fragment_set_decryption (download, key, iv)) {
+    g_object_unref (download);
+    download = NULL;
+    goto quit;
+  }
+
+  GST_OBJECT_LOCK (downloader);
+  if (downloader->priv->cancelled) {
+    GST_OBJECT_UNLOCK (downloader);
+    GST_DEBUG_OBJECT (downloader, "Download cancelled before starting");
+    g_object_unref (download);
+    download = NULL;
+    goto quit;
+  }
+  downloader->priv->download = download;
+  download = NULL;
+  GST_OBJECT_UNLOCK (downloader);
 
   ret = gst_element_set_state (downloader->priv->urisrc, GST_STATE_PLAYING);
   if (ret == GST_STATE_CHANGE_FAILURE) {
-    g_object_unref (downloader->priv->download);
-    downloader->priv->download = NULL;
+    GST_OBJECT_LOCK (downloader);
+    if (downloader->priv->download != NULL) {
+      g_object_unref (downloader->priv->download);
+      downloader->priv->download = NULL;
+    }
+    GST_OBJECT_UNLOCK (downloader);
     goto quit;
   }
 
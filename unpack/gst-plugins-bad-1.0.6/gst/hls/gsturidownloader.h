@@ -57,7 +57,9 @@ GType gst_uri_downloader_get_type (void);
 
 GstUriDownloader * gst_uri_downloader_new (void);
 GstFragment * gst_uri_downloader_fetch_uri (GstUriDownloader * downloader, const gchar * uri);
+GstFragment * gst_uri_downloader_fetch_uri_with_key (GstUriDownloader * downloader, const gchar * uri, const guint8 * key, const guint8 * iv);
 void gst_uri_downloader_cancel (GstUriDownloader *downloader);
+void gst_uri_downloader_reset (GstUriDownloader *downloader);
 void gst_uri_downloader_free (GstUriDownloader *downloader);
 
 G_END_DECLS
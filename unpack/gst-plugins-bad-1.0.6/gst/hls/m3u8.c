@@ -20,6 +20,7 @@
  */
 
 #include <stdlib.h>
+#include <string.h>
 #include <math.h>
 #include <errno.h>
 #include <glib.h>
@@ -44,6 +45,9 @@ gst_m3u8_new (void)
   GstM3U8 *m3u8;
 
   m3u8 = g_new0 (GstM3U8, 1);
+  m3u8->files =
+      g_ptr_array_new_with_free_func ((GDestroyNotify)
+      gst_m3u8_media_file_free);
 
   return m3u8;
 }
@@ -67,8 +71,7 @@ gst_m3u8_free (GstM3U8 * self)
   g_free (self->allowcache);
   g_free (self->codecs);
 
-  g_list_foreach (self->files, (GFunc) gst_m3u8_media_file_free, NULL);
-  g_list_free (self->files);
+  g_ptr_array_free (self->files, TRUE);
 
   g_free (self->last_data);
   g_list_foreach (self->lists, (GFunc) gst_m3u8_free, NULL);
@@ -99,6 +102,7 @@ gst_m3u8_media_file_free (GstM3U8MediaFile * self)
 
   g_free (self->title);
   g_free (self->uri);
+  g_free (self->key);
   g_free (self);
 }
 
@@ -166,16 +170,25 @@ static gboolean
 parse_attributes (gchar ** ptr, gchar ** a, gchar ** v)
 {
   gchar *end, *p;
+  gboolean quoted = FALSE;
 
   g_return_val_if_fail (ptr != NULL, FALSE);
   g_return_val_if_fail (*ptr != NULL, FALSE);
   g_return_val_if_fail (a != NULL, FALSE);
   g_return_val_if_fail (v != NULL, FALSE);
 
-  /* [attribute=value,]* */
+  /* [attribute=value,]*, quoted values can contain commas */
 
   *a = *ptr;
-  end = p = g_utf8_strchr (*ptr, -1, ',');
+  end = NULL;
+  for (p = *ptr; *p != '\0'; p = g_utf8_next_char (p)) {
+    if (*p == '"') {
+      quoted = !quoted;
+    } else if (*p == ',' && !quoted) {
+      end = p;
+      break;
+    }
+  }
   if (end) {
     do {
       end = g_utf8_next_char (end);
@@ -196,6 +209,54 @@ parse_attributes (gchar ** ptr, gchar ** a, gchar ** v)
   return TRUE;
 }
 
+/* parses a 128 bits hexadecimal-sequence like 0x0123456789abcdef... */
+static gboolean
+iv_from_string (const gchar * ptr, guint8 * iv)
+{
+  guint i;
+
+  if (!g_str_has_prefix (ptr, "0x") && !g_str_has_prefix (ptr, "0X"))
+    return FALSE;
+  ptr += 2;
+
+  for (i = 0; i < 16; i++) {
+    gint hi, lo;
+
+    hi = g_ascii_xdigit_value (ptr[2 * i]);
+    if (hi < 0)
+      return FALSE;
+    lo = g_ascii_xdigit_value (ptr[2 * i + 1]);
+    if (lo < 0)
+      return FALSE;
+    iv[i] = (hi << 4) | lo;
+  }
+
+  return TRUE;
+}
+
+/* makes @uri absolute using the URI of the playlist, returns a new string
+ * or NULL */
+static gchar *
+uri_join (const gchar * base, const gchar * uri)
+{
+  const gchar *slash;
+
+  if (gst_uri_is_valid (uri))
+    return g_strdup (uri);
+
+  if (!base) {
+    GST_WARNING ("uri not set, can't build a valid uri");
+    return NULL;
+  }
+  slash = g_utf8_strrchr (base, -1, '/');
+  if (!slash) {
+    GST_WARNING ("Can't build a valid uri");
+    return NULL;
+  }
+
+  return g_strdup_printf ("%.*s/%s", (gint) (slash - base), base, uri);
+}
+
 static gint
 _m3u8_compare_uri (GstM3U8 * a, gchar * uri)
 {
@@ -211,8 +272,34 @@ gst_m3u8_compare_playlist_by_bitrate (gconstpointer a, gconstpointer b)
   return ((GstM3U8 *) (a))->bandwidth - ((GstM3U8 *) (b))->bandwidth;
 }
 
+static GstM3U8MediaFile *
+gst_m3u8_get_last_file (GstM3U8 * self)
+{
+  if (self->files->len == 0)
+    return NULL;
+
+  return g_ptr_array_index (self->files, self->files->len - 1);
+}
+
+/* Checks that the URI line of a media file is the one we already have */
+static gboolean
+gst_m3u8_media_file_has_uri (GstM3U8MediaFile * file, const gchar * line)
+{
+  if (gst_uri_is_valid (line))
+    return g_str_equal (file->uri, line);
+
+  /* relative URIs were joined with the playlist URI */
+  return g_str_has_suffix (file->uri, line) &&
+      file->uri[strlen (file->uri) - strlen (line) - 1] == '/';
+}
+
 /*
  * @data: a m3u8 playlist text data, taking ownership
+ *
+ * Live playlists are refreshed with the same media files plus some new ones
+ * at the end, and the oldest ones removed. The media files are identified by
+ * their sequence number, only the ones after the last file we already have
+ * are created and the ones that are not in the playlist anymore are removed.
  */
 static gboolean
 gst_m3u8_update (GstM3U8 * self, gchar * data, gboolean * updated)
@@ -222,6 +309,11 @@ gst_m3u8_update (GstM3U8 * self, gchar * data, gboolean * updated)
   gchar *title, *end;
 //  gboolean discontinuity;
   GstM3U8 *list;
+  GstM3U8MediaFile *last;
+  gint first_sequence;
+  gchar *key = NULL;
+  guint8 iv[16];
+  gboolean have_iv = FALSE;
 
   g_return_val_if_fail (self != NULL, FALSE);
   g_return_val_if_fail (data != NULL, FALSE);
@@ -247,11 +339,11 @@ gst_m3u8_update (GstM3U8 * self, gchar * data, gboolean * updated)
   g_free (self->last_data);
   self->last_data = data;
 
-  if (self->files) {
-    g_list_foreach (self->files, (GFunc) gst_m3u8_media_file_free, NULL);
-    g_list_free (self->files);
-    self->files = NULL;
-  }
+  /* the files already known are kept, the sequence numbers start from 0
+   * unless there is a EXT-X-MEDIA-SEQUENCE tag */
+  last = gst_m3u8_get_last_file (self);
+  self->mediasequence = 0;
+  first_sequence = -1;
 
   list = NULL;
   duration = 0;
@@ -270,25 +362,56 @@ gst_m3u8_update (GstM3U8 * self, gchar * data, gboolean * updated)
         goto next_line;
       }
 
-      if (!gst_uri_is_valid (data)) {
-        gchar *slash;
-        if (!self->uri) {
-          GST_WARNING ("uri not set, can't build a valid uri");
-          goto next_line;
-        }
-        slash = g_utf8_strrchr (self->uri, -1, '/');
-        if (!slash) {
-          GST_WARNING ("Can't build a valid uri");
-          goto next_line;
+      if (list == NULL) {
+        gint sequence = self->mediasequence;
+
+        r = g_utf8_strchr (data, -1, '\r');
+        if (r)
+          *r = '\0';
+
+        if (first_sequence == -1) {
+          GstM3U8MediaFile *first;
+
+          first_sequence = sequence;
+          first = self->files->len ?
+              g_ptr_array_index (self->files, 0) : NULL;
+          /* the playlist restarted or none of our files are in it anymore */
+          if (last && (sequence < first->sequence
+                  || sequence > last->sequence + 1)) {
+            GST_DEBUG ("Media sequence %d doesn't follow %u-%u, reloading",
+                sequence, first->sequence, last->sequence);
+            g_ptr_array_set_size (self->files, 0);
+            last = NULL;
+          }
         }
 
-        *slash = '\0';
-        data = g_strdup_printf ("%s/%s", self->uri, data);
-        *slash = '/';
-      } else {
-        data = g_strdup (data);
+        /* we already have this one, only the first and last are compared
+         * to catch playlists that changed without a new sequence number */
+        if (last && sequence <= last->sequence) {
+          GstM3U8MediaFile *first = g_ptr_array_index (self->files, 0);
+          guint index = sequence - first->sequence;
+
+          if ((sequence != first_sequence && sequence != last->sequence)
+              || gst_m3u8_media_file_has_uri (g_ptr_array_index (self->files,
+                      index), data)) {
+            self->mediasequence++;
+            duration = 0;
+            g_free (title);
+            title = NULL;
+            goto next_line;
+          }
+
+          GST_WARNING ("Media file %d changed, dropping it and the next ones",
+              sequence);
+          g_ptr_array_set_size (self->files, index);
+          last = gst_m3u8_get_last_file (self);
+        }
       }
 
+      data = uri_join (self->uri, data);
+      if (data == NULL)
+        goto next_line;
+
       r = g_utf8_strchr (data, -1, '\r');
       if (r)
         *r = '\0';
@@ -305,13 +428,27 @@ gst_m3u8_update (GstM3U8 * self, gchar * data, gboolean * updated)
         }
         list = NULL;
       } else {
-        GstM3U8MediaFile *file;
+        GstM3U8MediaFile *file, *prev;
+
+        prev = gst_m3u8_get_last_file (self);
         file =
             gst_m3u8_media_file_new (data, title, duration,
             self->mediasequence++);
+        if (prev)
+          file->offset = prev->offset + prev->duration;
+        if (key) {
+          file->key = g_strdup (key);
+          if (have_iv) {
+            memcpy (file->iv, iv, sizeof (iv));
+          } else {
+            /* the default IV is the sequence number as a big-endian
+             * 128 bits integer */
+            GST_WRITE_UINT32_BE (file->iv + 12, file->sequence);
+          }
+        }
         duration = 0;
         title = NULL;
-        self->files = g_list_append (self->files, file);
+        g_ptr_array_add (self->files, file);
       }
 
     } else if (g_str_has_prefix (data, "#EXT-X-ENDLIST")) {
@@ -351,6 +488,45 @@ gst_m3u8_update (GstM3U8 * self, gchar * data, gboolean * updated)
           }
         }
       }
+    } else if (g_str_has_prefix (data, "#EXT-X-KEY:")) {
+      gchar *v, *a;
+      gboolean aes = FALSE;
+
+      /* the key applies to the following media files until the next one */
+      g_free (key);
+      key = NULL;
+      have_iv = FALSE;
+      data = data + 11;
+      while (data && parse_attributes (&data, &a, &v)) {
+        if (g_str_equal (a, "METHOD")) {
+          aes = g_str_equal (v, "AES-128");
+          /* the media files can't be played without decrypting them */
+          if (!aes && !g_str_equal (v, "NONE")) {
+            GST_ERROR ("Unsupported encryption method %s", v);
+            goto error;
+          }
+        } else if (g_str_equal (a, "URI")) {
+          gchar *quote;
+
+          if (*v == '"') {
+            v++;
+            quote = g_utf8_strchr (v, -1, '"');
+            if (quote)
+              *quote = '\0';
+          }
+          g_free (key);
+          key = uri_join (self->uri, v);
+        } else if (g_str_equal (a, "IV")) {
+          if (iv_from_string (v, iv))
+            have_iv = TRUE;
+          else
+            GST_WARNING ("Error while reading IV");
+        }
+      }
+      if (!aes) {
+        g_free (key);
+        key = NULL;
+      }
     } else if (g_str_has_prefix (data, "#EXT-X-TARGETDURATION:")) {
       if (int_from_string (data + 22, &data, &val))
         self->targetduration = val * GST_SECOND;
@@ -391,6 +567,19 @@ gst_m3u8_update (GstM3U8 * self, gchar * data, gboolean * updated)
     data = g_utf8_next_char (end);      /* skip \n */
   }
 
+  g_free (key);
+
+  /* remove the files that are not in the playlist anymore */
+  if (first_sequence == -1) {
+    g_ptr_array_set_size (self->files, 0);
+  } else if (self->files->len > 0) {
+    GstM3U8MediaFile *first = g_ptr_array_index (self->files, 0);
+
+    if (first_sequence > first->sequence)
+      g_ptr_array_remove_range (self->files, 0,
+          MIN (first_sequence - first->sequence, self->files->len));
+  }
+
   /* redorder playlists by bitrate */
   if (self->lists) {
     gchar *top_variant_uri = NULL;
@@ -409,6 +598,19 @@ gst_m3u8_update (GstM3U8 * self, gchar * data, gboolean * updated)
   }
 
   return TRUE;
+
+error:
+  {
+    g_free (key);
+    g_free (title);
+    if (list)
+      gst_m3u8_free (list);
+    /* parse it again, and fail again, if it's received again */
+    g_free (self->last_data);
+    self->last_data = NULL;
+    *updated = FALSE;
+    return FALSE;
+  }
 }
 
 GstM3U8Client *
@@ -481,9 +683,9 @@ gst_m3u8_client_update (GstM3U8Client * self, gchar * data)
     }
   }
 
-  if (m3u8->files && self->sequence == -1) {
+  if (m3u8->files->len > 0 && self->sequence == -1) {
     self->sequence =
-        GST_M3U8_MEDIA_FILE (g_list_first (m3u8->files)->data)->sequence;
+        GST_M3U8_MEDIA_FILE (g_ptr_array_index (m3u8->files, 0))->sequence;
     GST_DEBUG ("Setting first sequence at %d", self->sequence);
   }
 
@@ -493,40 +695,56 @@ out:
   return ret;
 }
 
-static gboolean
-_find_next (GstM3U8MediaFile * file, GstM3U8Client * client)
+/* Returns the index of the first file with a sequence number equal or above
+ * @sequence, or -1 if there is none */
+static gint
+gst_m3u8_find_next (GstM3U8 * m3u8, gint sequence)
 {
-  GST_DEBUG ("Found fragment %d", file->sequence);
-  if (file->sequence >= client->sequence)
-    return FALSE;
-  return TRUE;
+  GstM3U8MediaFile *first;
+  gint index;
+
+  if (m3u8->files->len == 0)
+    return -1;
+
+  /* the sequence numbers of the files are contiguous */
+  first = g_ptr_array_index (m3u8->files, 0);
+  index = MAX (sequence - (gint) first->sequence, 0);
+  if (index >= m3u8->files->len)
+    return -1;
+
+  return index;
 }
 
 void
 gst_m3u8_client_get_current_position (GstM3U8Client * client,
     GstClockTime * timestamp)
 {
-  GList *l;
-  GList *walk;
-
-  l = g_list_find_custom (client->current->files, client,
-      (GCompareFunc) _find_next);
+  GPtrArray *files = client->current->files;
+  GstM3U8MediaFile *first, *file;
+  gint index;
 
   *timestamp = 0;
-  for (walk = client->current->files; walk; walk = walk->next) {
-    if (walk == l)
-      break;
-    *timestamp += GST_M3U8_MEDIA_FILE (walk->data)->duration;
+  if (files->len == 0)
+    return;
+
+  first = g_ptr_array_index (files, 0);
+  index = gst_m3u8_find_next (client->current, client->sequence);
+  if (index == -1) {
+    file = g_ptr_array_index (files, files->len - 1);
+    *timestamp = file->offset + file->duration - first->offset;
+  } else {
+    file = g_ptr_array_index (files, index);
+    *timestamp = file->offset - first->offset;
   }
 }
 
 gboolean
 gst_m3u8_client_get_next_fragment (GstM3U8Client * client,
-    gboolean * discontinuity, const gchar ** uri, GstClockTime * duration,
-    GstClockTime * timestamp)
+    gboolean * discontinuity, gchar ** uri, GstClockTime * duration,
+    GstClockTime * timestamp, gchar ** key, guint8 * iv)
 {
-  GList *l;
   GstM3U8MediaFile *file;
+  gint index;
 
   g_return_val_if_fail (client != NULL, FALSE);
   g_return_val_if_fail (client->current != NULL, FALSE);
@@ -534,36 +752,36 @@ gst_m3u8_client_get_next_fragment (GstM3U8Client * client,
 
   GST_M3U8_CLIENT_LOCK (client);
   GST_DEBUG ("Looking for fragment %d", client->sequence);
-  l = g_list_find_custom (client->current->files, client,
-      (GCompareFunc) _find_next);
-  if (l == NULL) {
+  index = gst_m3u8_find_next (client->current, client->sequence);
+  if (index == -1) {
     GST_M3U8_CLIENT_UNLOCK (client);
     return FALSE;
   }
 
   gst_m3u8_client_get_current_position (client, timestamp);
 
-  file = GST_M3U8_MEDIA_FILE (l->data);
+  file = g_ptr_array_index (client->current->files, index);
+  GST_DEBUG ("Found fragment %d", file->sequence);
 
   *discontinuity = client->sequence != file->sequence;
   client->sequence = file->sequence + 1;
 
-  *uri = file->uri;
+  /* copied with the lock, the file can be removed by a playlist update */
+  *uri = g_strdup (file->uri);
   *duration = file->duration;
+  *key = g_strdup (file->key);
+  if (file->key)
+    memcpy (iv, file->iv, sizeof (file->iv));
 
   GST_M3U8_CLIENT_UNLOCK (client);
   return TRUE;
 }
 
-static void
-_sum_duration (GstM3U8MediaFile * self, GstClockTime * duration)
-{
-  *duration += self->duration;
-}
-
 GstClockTime
 gst_m3u8_client_get_duration (GstM3U8Client * client)
 {
+  GPtrArray *files;
+  GstM3U8MediaFile *first, *last;
   GstClockTime duration = 0;
 
   g_return_val_if_fail (client != NULL, GST_CLOCK_TIME_NONE);
@@ -575,7 +793,12 @@ gst_m3u8_client_get_duration (GstM3U8Client * client)
     return GST_CLOCK_TIME_NONE;
   }
 
-  g_list_foreach (client->current->files, (GFunc) _sum_duration, &duration);
+  files = client->current->files;
+  if (files->len > 0) {
+    first = g_ptr_array_index (files, 0);
+    last = g_ptr_array_index (files, files->len - 1);
+    duration = last->offset + last->duration - first->offset;
+  }
   GST_M3U8_CLIENT_UNLOCK (client);
   return duration;
 }
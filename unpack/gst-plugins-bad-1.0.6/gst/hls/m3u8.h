@@ -49,7 +49,7 @@ struct _GstM3U8
   gchar *codecs;
   gint width;
   gint height;
-  GList *files;
+  GPtrArray *files;             /* GstM3U8MediaFile with contiguous sequences */
 
   /*< private > */
   gchar *last_data;
@@ -65,6 +65,9 @@ struct _GstM3U8MediaFile
   GstClockTime duration;
   gchar *uri;
   guint sequence;               /* the sequence nb of this file */
+  GstClockTime offset;          /* sum of the durations of the previous files */
+  gchar *key;                   /* URI of the AES-128 key, NULL if not encrypted */
+  guint8 iv[16];                /* the AES-128 initialization vector */
 };
 
 struct _GstM3U8Client
@@ -82,8 +85,8 @@ void gst_m3u8_client_free (GstM3U8Client * client);
 gboolean gst_m3u8_client_update (GstM3U8Client * client, gchar * data);
 void gst_m3u8_client_set_current (GstM3U8Client * client, GstM3U8 * m3u8);
 gboolean gst_m3u8_client_get_next_fragment (GstM3U8Client * client,
-    gboolean * discontinuity, const gchar ** uri, GstClockTime * duration,
-    GstClockTime * timestamp);
+    gboolean * discontinuity, gchar ** uri, GstClockTime * duration,
+    GstClockTime * timestamp, gchar ** key, guint8 * iv);
 void gst_m3u8_client_get_current_position (GstM3U8Client * client,
     GstClockTime * timestamp);
 GstClockTime gst_m3u8_client_get_duration (GstM3U8Client * client);
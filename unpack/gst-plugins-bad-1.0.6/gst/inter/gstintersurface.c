@@ -62,3 +62,81 @@ gst_inter_surface_unref (GstInterSurface * surface)
 {
 
 }
+
+/* Adds a frame to the ring, replacing the oldest one. The lock is only held
+ * to swap the buffer pointers so that many readers do not slow down the
+ * writer. */
+void
+gst_inter_surface_push_video (GstInterSurface * surface, GstBuffer * buffer,
+    GstClockTime time)
+{
+  GstInterVideoSlot *slot;
+  GstBuffer *old;
+
+  g_mutex_lock (surface->mutex);
+  surface->video_seqnum++;
+  slot = &surface->video_slots[surface->video_seqnum %
+      GST_INTER_SURFACE_VIDEO_SLOTS];
+  old = slot->buffer;
+  slot->buffer = gst_buffer_ref (buffer);
+  slot->time = time;
+  slot->seqnum = surface->video_seqnum;
+  g_mutex_unlock (surface->mutex);
+
+  if (old)
+    gst_buffer_unref (old);
+}
+
+/* Returns a new reference to the most recent frame displayed at or before
+ * @time, or the oldest frame we have when they are all later. Without @time
+ * or frame times, the most recent frame is returned. Returns NULL when there
+ * are no frames. */
+GstBuffer *
+gst_inter_surface_get_video (GstInterSurface * surface, GstClockTime time,
+    guint64 * seqnum)
+{
+  GstInterVideoSlot *slot, *found = NULL;
+  GstBuffer *buffer = NULL;
+  guint64 n;
+
+  g_mutex_lock (surface->mutex);
+  for (n = surface->video_seqnum; n > 0 &&
+      n + GST_INTER_SURFACE_VIDEO_SLOTS > surface->video_seqnum; n--) {
+    slot = &surface->video_slots[n % GST_INTER_SURFACE_VIDEO_SLOTS];
+    if (slot->buffer == NULL || slot->seqnum != n)
+      break;
+
+    found = slot;
+    if (!GST_CLOCK_TIME_IS_VALID (time) ||
+        !GST_CLOCK_TIME_IS_VALID (slot->time) || slot->time <= time)
+      break;
+  }
+  if (found) {
+    buffer = gst_buffer_ref (found->buffer);
+    if (seqnum)
+      *seqnum = found->seqnum;
+  }
+  g_mutex_unlock (surface->mutex);
+
+  return buffer;
+}
+
+/* Removes all frames, the frame numbers keep increasing */
+void
+gst_inter_surface_clear_video (GstInterSurface * surface)
+{
+  GstBuffer *buffers[GST_INTER_SURFACE_VIDEO_SLOTS];
+  int i;
+
+  g_mutex_lock (surface->mutex);
+  for (i = 0; i < GST_INTER_SURFACE_VIDEO_SLOTS; i++) {
+    buffers[i] = surface->video_slots[i].buffer;
+    surface->video_slots[i].buffer = NULL;
+  }
+  g_mutex_unlock (surface->mutex);
+
+  for (i = 0; i < GST_INTER_SURFACE_VIDEO_SLOTS; i++) {
+    if (buffers[i])
+      gst_buffer_unref (buffers[i]);
+  }
+}
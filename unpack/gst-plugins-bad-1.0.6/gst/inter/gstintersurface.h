@@ -26,6 +26,18 @@
 G_BEGIN_DECLS
 
 typedef struct _GstInterSurface GstInterSurface;
+typedef struct _GstInterVideoSlot GstInterVideoSlot;
+
+/* number of video frames kept for the readers */
+#define GST_INTER_SURFACE_VIDEO_SLOTS 8
+
+struct _GstInterVideoSlot
+{
+  GstBuffer *buffer;
+  /* clock time at which the frame is displayed, or GST_CLOCK_TIME_NONE */
+  GstClockTime time;
+  guint64 seqnum;
+};
 
 struct _GstInterSurface
 {
@@ -39,13 +51,16 @@ struct _GstInterSurface
   int width;
   int height;
   int n_frames;
-  int video_buffer_count;
 
   /* audio */
   int sample_rate;
   int n_channels;
 
-  GstBuffer *video_buffer;
+  /* ring of the last frames, frame n is in slot n % GST_INTER_SURFACE_VIDEO_SLOTS
+   * and video_seqnum is the number of the last frame, starting from 1 */
+  GstInterVideoSlot video_slots[GST_INTER_SURFACE_VIDEO_SLOTS];
+  guint64 video_seqnum;
+
   GstBuffer *sub_buffer;
   GstAdapter *audio_adapter;
 };
@@ -54,6 +69,12 @@ struct _GstInterSurface
 GstInterSurface * gst_inter_surface_get (const char *name);
 void gst_inter_surface_unref (GstInterSurface *surface);
 
+void gst_inter_surface_push_video (GstInterSurface *surface, GstBuffer *buffer,
+    GstClockTime time);
+GstBuffer * gst_inter_surface_get_video (GstInterSurface *surface,
+    GstClockTime time, guint64 *seqnum);
+void gst_inter_surface_clear_video (GstInterSurface *surface);
+
 
 G_END_DECLS
 
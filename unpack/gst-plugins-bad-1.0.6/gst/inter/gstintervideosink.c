@@ -29,6 +29,10 @@
  * gst-launch -v videotestsrc ! intervideosink
  * ]|
  * 
+ * The last frames are kept for the intervideosrc elements reading from the
+ * same channel, which can be any number. Each of them outputs the frame
+ * that is displayed at the time of its output frame, without copying it.
+ *
  * The intervideosink element cannot be used effectively with gst-launch,
  * as it requires a second pipeline in the application to send video to.
  * See the gstintertest.c example in the gst-plugins-bad source code for
@@ -206,12 +210,7 @@ gst_inter_video_sink_stop (GstBaseSink * sink)
 {
   GstInterVideoSink *intervideosink = GST_INTER_VIDEO_SINK (sink);
 
-  g_mutex_lock (intervideosink->surface->mutex);
-  if (intervideosink->surface->video_buffer) {
-    gst_buffer_unref (intervideosink->surface->video_buffer);
-  }
-  intervideosink->surface->video_buffer = NULL;
-  g_mutex_unlock (intervideosink->surface->mutex);
+  gst_inter_surface_clear_video (intervideosink->surface);
 
   gst_inter_surface_unref (intervideosink->surface);
   intervideosink->surface = NULL;
@@ -223,14 +222,23 @@ static GstFlowReturn
 gst_inter_video_sink_render (GstBaseSink * sink, GstBuffer * buffer)
 {
   GstInterVideoSink *intervideosink = GST_INTER_VIDEO_SINK (sink);
-
-  g_mutex_lock (intervideosink->surface->mutex);
-  if (intervideosink->surface->video_buffer) {
-    gst_buffer_unref (intervideosink->surface->video_buffer);
+  GstClockTime time = GST_CLOCK_TIME_NONE;
+
+  /* the sources run in other pipelines, they select the frames with the
+   * clock time, which the pipelines have in common */
+  if (GST_BUFFER_TIMESTAMP_IS_VALID (buffer) &&
+      sink->segment.format == GST_FORMAT_TIME) {
+    time = gst_segment_to_running_time (&sink->segment, GST_FORMAT_TIME,
+        GST_BUFFER_TIMESTAMP (buffer));
+    if (GST_CLOCK_TIME_IS_VALID (time))
+      time += gst_element_get_base_time (GST_ELEMENT_CAST (sink)) +
+          gst_base_sink_get_latency (sink);
   }
-  intervideosink->surface->video_buffer = gst_buffer_ref (buffer);
-  intervideosink->surface->video_buffer_count = 0;
-  g_mutex_unlock (intervideosink->surface->mutex);
+
+  GST_LOG_OBJECT (intervideosink, "frame for time %" GST_TIME_FORMAT,
+      GST_TIME_ARGS (time));
+
+  gst_inter_surface_push_video (intervideosink->surface, buffer, time);
 
   return GST_FLOW_OK;
 }
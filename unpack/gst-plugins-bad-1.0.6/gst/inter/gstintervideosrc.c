@@ -23,6 +23,13 @@
  * in connection with a intervideosink element in a different pipeline,
  * similar to interaudiosink and interaudiosrc.
  *
+ * Each intervideosrc outputs the frame of the intervideosink that is displayed
+ * in the middle of its own output frame, using the clock time shared by the
+ * pipelines. Frames are duplicated or dropped to match its framerate, which
+ * is counted in the #GstInterVideoSrc:duplicate and #GstInterVideoSrc:drop
+ * properties. When no new frame arrives for 30 frames, black frames are
+ * output.
+ *
  * <refsect2>
  * <title>Example launch line</title>
  * |[
@@ -70,9 +77,14 @@ static GstCaps *gst_inter_video_src_fixate (GstBaseSrc * src, GstCaps * caps);
 enum
 {
   PROP_0,
-  PROP_CHANNEL
+  PROP_CHANNEL,
+  PROP_DROP,
+  PROP_DUPLICATE
 };
 
+/* output black after repeating the same frame for that many frames */
+#define MAX_REPEATS 30
+
 /* pad templates */
 
 static GstStaticPadTemplate gst_inter_video_src_src_template =
@@ -121,6 +133,15 @@ gst_inter_video_src_class_init (GstInterVideoSrcClass * klass)
           "Channel name to match inter src and sink elements",
           "default", G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  g_object_class_install_property (gobject_class, PROP_DROP,
+      g_param_spec_uint64 ("drop", "Drop",
+          "Number of frames of the sink that were not output", 0, G_MAXUINT64,
+          0, G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+
+  g_object_class_install_property (gobject_class, PROP_DUPLICATE,
+      g_param_spec_uint64 ("duplicate", "Duplicate",
+          "Number of frames of the sink that were output more than once", 0,
+          G_MAXUINT64, 0, G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
 }
 
 static void
@@ -159,6 +180,16 @@ gst_inter_video_src_get_property (GObject * object, guint property_id,
     case PROP_CHANNEL:
       g_value_set_string (value, intervideosrc->channel);
       break;
+    case PROP_DROP:
+      GST_OBJECT_LOCK (intervideosrc);
+      g_value_set_uint64 (value, intervideosrc->dropped);
+      GST_OBJECT_UNLOCK (intervideosrc);
+      break;
+    case PROP_DUPLICATE:
+      GST_OBJECT_LOCK (intervideosrc);
+      g_value_set_uint64 (value, intervideosrc->duplicated);
+      GST_OBJECT_UNLOCK (intervideosrc);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
       break;
@@ -200,6 +231,13 @@ gst_inter_video_src_start (GstBaseSrc * src)
   GST_DEBUG_OBJECT (intervideosrc, "start");
 
   intervideosrc->surface = gst_inter_surface_get (intervideosrc->channel);
+  intervideosrc->last_seqnum = 0;
+  intervideosrc->n_repeats = 0;
+
+  GST_OBJECT_LOCK (intervideosrc);
+  intervideosrc->dropped = 0;
+  intervideosrc->duplicated = 0;
+  GST_OBJECT_UNLOCK (intervideosrc);
 
   return TRUE;
 }
@@ -251,21 +289,49 @@ gst_inter_video_src_create (GstBaseSrc * src, guint64 offset, guint size,
 {
   GstInterVideoSrc *intervideosrc = GST_INTER_VIDEO_SRC (src);
   GstBuffer *buffer;
+  GstClockTime timestamp, duration, time;
+  guint64 seqnum = 0;
 
   GST_DEBUG_OBJECT (intervideosrc, "create");
 
-  buffer = NULL;
+  timestamp = gst_util_uint64_scale_int (GST_SECOND * intervideosrc->n_frames,
+      GST_VIDEO_INFO_FPS_D (&intervideosrc->info),
+      GST_VIDEO_INFO_FPS_N (&intervideosrc->info));
+  duration =
+      gst_util_uint64_scale_int (GST_SECOND * (intervideosrc->n_frames + 1),
+      GST_VIDEO_INFO_FPS_D (&intervideosrc->info),
+      GST_VIDEO_INFO_FPS_N (&intervideosrc->info)) - timestamp;
+
+  /* the frame of the sink displayed in the middle of our frame */
+  time = gst_element_get_base_time (GST_ELEMENT_CAST (src)) + timestamp +
+      duration / 2;
+
+  buffer = gst_inter_surface_get_video (intervideosrc->surface, time, &seqnum);
+
+  if (buffer) {
+    GST_OBJECT_LOCK (intervideosrc);
+    if (seqnum == intervideosrc->last_seqnum) {
+      intervideosrc->n_repeats++;
+      if (intervideosrc->n_repeats < MAX_REPEATS)
+        intervideosrc->duplicated++;
+    } else {
+      if (intervideosrc->last_seqnum > 0 &&
+          seqnum > intervideosrc->last_seqnum + 1)
+        intervideosrc->dropped += seqnum - intervideosrc->last_seqnum - 1;
+      intervideosrc->last_seqnum = seqnum;
+      intervideosrc->n_repeats = 0;
+    }
+    GST_OBJECT_UNLOCK (intervideosrc);
+
+    GST_LOG_OBJECT (intervideosrc, "frame %" G_GUINT64_FORMAT " for time %"
+        GST_TIME_FORMAT, seqnum, GST_TIME_ARGS (time));
 
-  g_mutex_lock (intervideosrc->surface->mutex);
-  if (intervideosrc->surface->video_buffer) {
-    buffer = gst_buffer_ref (intervideosrc->surface->video_buffer);
-    intervideosrc->surface->video_buffer_count++;
-    if (intervideosrc->surface->video_buffer_count >= 30) {
-      gst_buffer_unref (intervideosrc->surface->video_buffer);
-      intervideosrc->surface->video_buffer = NULL;
+    /* the sink stopped sending frames */
+    if (intervideosrc->n_repeats >= MAX_REPEATS) {
+      gst_buffer_unref (buffer);
+      buffer = NULL;
     }
   }
-  g_mutex_unlock (intervideosrc->surface->mutex);
 
   if (buffer == NULL) {
     GstMapInfo map;
@@ -286,17 +352,10 @@ gst_inter_video_src_create (GstBaseSrc * src, guint64 offset, guint size,
 
   buffer = gst_buffer_make_writable (buffer);
 
-  GST_BUFFER_TIMESTAMP (buffer) =
-      gst_util_uint64_scale_int (GST_SECOND * intervideosrc->n_frames,
-      GST_VIDEO_INFO_FPS_D (&intervideosrc->info),
-      GST_VIDEO_INFO_FPS_N (&intervideosrc->info));
+  GST_BUFFER_TIMESTAMP (buffer) = timestamp;
   GST_DEBUG_OBJECT (intervideosrc, "create ts %" GST_TIME_FORMAT,
       GST_TIME_ARGS (GST_BUFFER_TIMESTAMP (buffer)));
-  GST_BUFFER_DURATION (buffer) =
-      gst_util_uint64_scale_int (GST_SECOND * (intervideosrc->n_frames + 1),
-      GST_VIDEO_INFO_FPS_D (&intervideosrc->info),
-      GST_VIDEO_INFO_FPS_N (&intervideosrc->info)) -
-      GST_BUFFER_TIMESTAMP (buffer);
+  GST_BUFFER_DURATION (buffer) = duration;
   GST_BUFFER_OFFSET (buffer) = intervideosrc->n_frames;
   GST_BUFFER_OFFSET_END (buffer) = -1;
   GST_BUFFER_FLAG_UNSET (buffer, GST_BUFFER_FLAG_DISCONT);
@@ -45,6 +45,13 @@ struct _GstInterVideoSrc
 
   GstVideoInfo info;
   int n_frames;
+
+  /* the last frame we output and how many times in a row */
+  guint64 last_seqnum;
+  int n_repeats;
+
+  guint64 dropped;
+  guint64 duplicated;
 };
 
 struct _GstInterVideoSrcClass
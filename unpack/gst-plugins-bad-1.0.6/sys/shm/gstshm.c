@@ -26,9 +26,13 @@
 #include "gstshmsrc.h"
 #include "gstshmsink.h"
 
+#include "dataprotocol.h"
+
 static gboolean
 plugin_init (GstPlugin * plugin)
 {
+  gst_dp_init ();
+
   return gst_element_register (plugin, "shmsrc",
       GST_RANK_NONE, GST_TYPE_SHM_SRC) &&
       gst_element_register (plugin, "shmsink",
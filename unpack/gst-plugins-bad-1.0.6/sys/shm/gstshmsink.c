@@ -23,6 +23,15 @@
  *
  * Send data over shared memory to the matching source.
  *
+ * Upstream elements are offered an allocator that allocates their buffers
+ * from the shared memory area, so that the data they write is sent without
+ * a copy. For this, #GstShmSink:shm-size has to be large enough to hold a few
+ * buffers, otherwise the buffers are allocated in normal memory and copied.
+ *
+ * With #GstShmSink:forward-events, the caps and some of the serialized
+ * events are sent along with the data and shmsrc sets the same caps, pushes
+ * the events and goes EOS after the sink received EOS.
+ *
  * <refsect2>
  * <title>Example launch lines</title>
  * |[
@@ -57,7 +66,8 @@ enum
   PROP_PERMS,
   PROP_SHM_SIZE,
   PROP_WAIT_FOR_CONNECTION,
-  PROP_BUFFER_TIME
+  PROP_BUFFER_TIME,
+  PROP_FORWARD_EVENTS
 };
 
 struct GstShmClient
@@ -68,6 +78,7 @@ struct GstShmClient
 
 #define DEFAULT_SIZE ( 256 * 1024 )
 #define DEFAULT_WAIT_FOR_CONNECTION (TRUE)
+#define DEFAULT_FORWARD_EVENTS (FALSE)
 /* Default is user read/write, group read */
 #define DEFAULT_PERMS ( S_IRUSR | S_IWUSR | S_IRGRP )
 
@@ -94,6 +105,8 @@ static gboolean gst_shm_sink_stop (GstBaseSink * bsink);
 static GstFlowReturn gst_shm_sink_render (GstBaseSink * bsink, GstBuffer * buf);
 
 static gboolean gst_shm_sink_event (GstBaseSink * bsink, GstEvent * event);
+static gboolean gst_shm_sink_propose_allocation (GstBaseSink * bsink,
+    GstQuery * query);
 static gboolean gst_shm_sink_unlock (GstBaseSink * bsink);
 static gboolean gst_shm_sink_unlock_stop (GstBaseSink * bsink);
 
@@ -108,6 +121,8 @@ gst_shm_sink_init (GstShmSink * self)
   self->size = DEFAULT_SIZE;
   self->wait_for_connection = DEFAULT_WAIT_FOR_CONNECTION;
   self->perms = DEFAULT_PERMS;
+  self->forward_events = DEFAULT_FORWARD_EVENTS;
+  self->packetizer = gst_dp_packetizer_new (GST_DP_VERSION_1_0);
 }
 
 static void
@@ -129,6 +144,8 @@ gst_shm_sink_class_init (GstShmSinkClass * klass)
   gstbasesink_class->stop = GST_DEBUG_FUNCPTR (gst_shm_sink_stop);
   gstbasesink_class->render = GST_DEBUG_FUNCPTR (gst_shm_sink_render);
   gstbasesink_class->event = GST_DEBUG_FUNCPTR (gst_shm_sink_event);
+  gstbasesink_class->propose_allocation =
+      GST_DEBUG_FUNCPTR (gst_shm_sink_propose_allocation);
   gstbasesink_class->unlock = GST_DEBUG_FUNCPTR (gst_shm_sink_unlock);
   gstbasesink_class->unlock_stop = GST_DEBUG_FUNCPTR (gst_shm_sink_unlock_stop);
 
@@ -165,6 +182,12 @@ gst_shm_sink_class_init (GstShmSinkClass * klass)
           -1, G_MAXINT64, -1,
           G_PARAM_CONSTRUCT | G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  g_object_class_install_property (gobject_class, PROP_FORWARD_EVENTS,
+      g_param_spec_boolean ("forward-events",
+          "Forward caps and events",
+          "Send the caps, tags, EOS and custom downstream events to the clients",
+          DEFAULT_FORWARD_EVENTS, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   signals[SIGNAL_CLIENT_CONNECTED] = g_signal_new ("client-connected",
       GST_TYPE_SHM_SINK, G_SIGNAL_RUN_LAST, 0, NULL, NULL,
       g_cclosure_marshal_VOID__INT, G_TYPE_NONE, 1, G_TYPE_INT);
@@ -191,6 +214,7 @@ gst_shm_sink_finalize (GObject * object)
   GstShmSink *self = GST_SHM_SINK (object);
 
   g_cond_free (self->cond);
+  gst_dp_packetizer_free (self->packetizer);
 
   G_OBJECT_CLASS (parent_class)->finalize (object);
 }
@@ -247,6 +271,11 @@ gst_shm_sink_set_property (GObject * object, guint prop_id,
       GST_OBJECT_UNLOCK (object);
       g_cond_broadcast (self->cond);
       break;
+    case PROP_FORWARD_EVENTS:
+      GST_OBJECT_LOCK (object);
+      self->forward_events = g_value_get_boolean (value);
+      GST_OBJECT_UNLOCK (object);
+      break;
     default:
       break;
   }
@@ -276,6 +305,9 @@ gst_shm_sink_get_property (GObject * object, guint prop_id,
     case PROP_BUFFER_TIME:
       g_value_set_int64 (value, self->buffer_time);
       break;
+    case PROP_FORWARD_EVENTS:
+      g_value_set_boolean (value, self->forward_events);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -285,6 +317,219 @@ gst_shm_sink_get_property (GObject * object, guint prop_id,
 }
 
 
+/* Memory allocated from the shared memory area, the data upstream writes in
+ * it is sent to the clients without a copy */
+
+#define GST_TYPE_SHM_SINK_ALLOCATOR (gst_shm_sink_allocator_get_type ())
+
+typedef struct
+{
+  GstAllocator parent;
+
+  GstShmSink *sink;
+} GstShmSinkAllocator;
+
+typedef GstAllocatorClass GstShmSinkAllocatorClass;
+
+typedef struct
+{
+  GstMemory mem;
+
+  gchar *data;
+
+  /* only set on the memory that owns the block, not on shared memory */
+  GstShmSink *sink;
+  ShmBlock *block;
+} GstShmSinkMemory;
+
+GType gst_shm_sink_allocator_get_type (void);
+G_DEFINE_TYPE (GstShmSinkAllocator, gst_shm_sink_allocator,
+    GST_TYPE_ALLOCATOR);
+
+static GstMemory *
+gst_shm_sink_allocator_alloc (GstAllocator * allocator, gsize size,
+    GstAllocationParams * params)
+{
+  GstShmSinkAllocator *self = (GstShmSinkAllocator *) allocator;
+  GstShmSinkMemory *mymem;
+  GstShmSink *sink;
+  ShmBlock *block = NULL;
+  gsize maxsize = size + params->prefix + params->padding;
+  gsize align = params->align | gst_memory_alignment;
+  gchar *data;
+
+  GST_OBJECT_LOCK (self);
+  sink = self->sink ? gst_object_ref (self->sink) : NULL;
+  GST_OBJECT_UNLOCK (self);
+
+  if (sink) {
+    GST_OBJECT_LOCK (sink);
+    if (sink->pipe)
+      block = sp_writer_alloc_block (sink->pipe, maxsize + align);
+    GST_OBJECT_UNLOCK (sink);
+  }
+
+  if (block == NULL) {
+    GST_LOG_OBJECT (self, "Not enough shared memory for buffer of %"
+        G_GSIZE_FORMAT " bytes, allocating using standard allocator", size);
+    if (sink)
+      gst_object_unref (sink);
+    return gst_allocator_alloc (NULL, size, params);
+  }
+
+  /* the blocks are not aligned in the area */
+  data = sp_writer_block_get_buf (block);
+  data = (gchar *) (((guintptr) data + align) & ~(guintptr) align);
+
+  if (params->prefix && (params->flags & GST_MEMORY_FLAG_ZERO_PREFIXED))
+    memset (data, 0, params->prefix);
+  if (params->padding && (params->flags & GST_MEMORY_FLAG_ZERO_PADDED))
+    memset (data + params->prefix + size, 0, params->padding);
+
+  mymem = g_slice_new0 (GstShmSinkMemory);
+  gst_memory_init (GST_MEMORY_CAST (mymem), params->flags,
+      gst_object_ref (allocator), NULL, maxsize, align, params->prefix, size);
+  mymem->data = data;
+  mymem->sink = sink;
+  mymem->block = block;
+
+  GST_LOG_OBJECT (self,
+      "Allocated buffer of %" G_GSIZE_FORMAT " bytes from shared memory at %p",
+      size, data);
+
+  return GST_MEMORY_CAST (mymem);
+}
+
+static void
+gst_shm_sink_allocator_free (GstAllocator * allocator, GstMemory * mem)
+{
+  GstShmSinkMemory *mymem = (GstShmSinkMemory *) mem;
+
+  if (mymem->block) {
+    GST_OBJECT_LOCK (mymem->sink);
+    sp_writer_free_block (mymem->block);
+    GST_OBJECT_UNLOCK (mymem->sink);
+    gst_object_unref (mymem->sink);
+  }
+
+  g_slice_free (GstShmSinkMemory, mymem);
+  gst_object_unref (allocator);
+}
+
+static gpointer
+gst_shm_sink_memory_map (GstShmSinkMemory * mem, gsize maxsize,
+    GstMapFlags flags)
+{
+  /* a buffer pool upstream recycles buffers as soon as we are done with
+   * them, but the clients can still be reading the data. Wait until they
+   * released it before letting upstream write in it again. */
+  if ((flags & GST_MAP_WRITE) && mem->block) {
+    GstShmSink *sink = mem->sink;
+
+    GST_OBJECT_LOCK (sink);
+    while (sp_writer_block_is_pending (mem->block) && !sink->unlock)
+      g_cond_wait (sink->cond, GST_OBJECT_GET_LOCK (sink));
+    GST_OBJECT_UNLOCK (sink);
+  }
+
+  return mem->data;
+}
+
+static void
+gst_shm_sink_memory_unmap (GstShmSinkMemory * mem)
+{
+}
+
+static GstMemory *
+gst_shm_sink_memory_copy (GstShmSinkMemory * mem, gssize offset, gssize size)
+{
+  GstMemory *copy;
+  GstMapInfo map;
+
+  if (size == -1)
+    size = mem->mem.size > offset ? mem->mem.size - offset : 0;
+
+  /* copies don't take space in the shared memory area */
+  copy = gst_allocator_alloc (NULL, size, NULL);
+  if (!gst_memory_map (copy, &map, GST_MAP_WRITE)) {
+    gst_memory_unref (copy);
+    return NULL;
+  }
+  memcpy (map.data, mem->data + mem->mem.offset + offset, size);
+  gst_memory_unmap (copy, &map);
+
+  return copy;
+}
+
+static GstMemory *
+gst_shm_sink_memory_share (GstShmSinkMemory * mem, gssize offset, gssize size)
+{
+  GstShmSinkMemory *mysub;
+  GstMemory *parent;
+
+  /* find the real parent */
+  if ((parent = mem->mem.parent) == NULL)
+    parent = (GstMemory *) mem;
+
+  if (size == -1)
+    size = mem->mem.size - offset;
+
+  mysub = g_slice_new0 (GstShmSinkMemory);
+  gst_memory_init (GST_MEMORY_CAST (mysub),
+      GST_MINI_OBJECT_FLAGS (parent) | GST_MINI_OBJECT_FLAG_LOCK_READONLY,
+      gst_object_ref (mem->mem.allocator), parent, mem->mem.maxsize,
+      mem->mem.align, mem->mem.offset + offset, size);
+  mysub->data = mem->data;
+
+  return GST_MEMORY_CAST (mysub);
+}
+
+static void
+gst_shm_sink_allocator_class_init (GstShmSinkAllocatorClass * klass)
+{
+  klass->alloc = gst_shm_sink_allocator_alloc;
+  klass->free = gst_shm_sink_allocator_free;
+}
+
+static void
+gst_shm_sink_allocator_init (GstShmSinkAllocator * self)
+{
+  GstAllocator *allocator = GST_ALLOCATOR_CAST (self);
+
+  allocator->mem_type = "ShmSinkMemory";
+  allocator->mem_map = (GstMemoryMapFunction) gst_shm_sink_memory_map;
+  allocator->mem_unmap = (GstMemoryUnmapFunction) gst_shm_sink_memory_unmap;
+  allocator->mem_copy = (GstMemoryCopyFunction) gst_shm_sink_memory_copy;
+  allocator->mem_share = (GstMemoryShareFunction) gst_shm_sink_memory_share;
+}
+
+static GstAllocator *
+gst_shm_sink_allocator_new (GstShmSink * sink)
+{
+  GstShmSinkAllocator *self;
+
+  self = g_object_new (GST_TYPE_SHM_SINK_ALLOCATOR, NULL);
+  self->sink = gst_object_ref (sink);
+
+  return GST_ALLOCATOR_CAST (self);
+}
+
+/* upstream can keep the allocator after we stopped, from then on it
+ * allocates normal memory */
+static void
+gst_shm_sink_allocator_detach (GstAllocator * allocator)
+{
+  GstShmSinkAllocator *self = (GstShmSinkAllocator *) allocator;
+  GstShmSink *sink;
+
+  GST_OBJECT_LOCK (self);
+  sink = self->sink;
+  self->sink = NULL;
+  GST_OBJECT_UNLOCK (self);
+
+  if (sink)
+    gst_object_unref (sink);
+}
 
 static gboolean
 gst_shm_sink_start (GstBaseSink * bsink)
@@ -316,6 +561,8 @@ gst_shm_sink_start (GstBaseSink * bsink)
 
   GST_DEBUG ("Created socket at %s", self->socket_path);
 
+  self->allocator = gst_shm_sink_allocator_new (self);
+
   self->poll = gst_poll_new (TRUE);
   gst_poll_fd_init (&self->serverpollfd);
   self->serverpollfd.fd = sp_get_fd (self->pipe);
@@ -331,6 +578,9 @@ gst_shm_sink_start (GstBaseSink * bsink)
 
 thread_error:
 
+  gst_shm_sink_allocator_detach (self->allocator);
+  gst_object_unref (self->allocator);
+  self->allocator = NULL;
   sp_close (self->pipe);
   self->pipe = NULL;
   gst_poll_free (self->poll);
@@ -365,8 +615,22 @@ gst_shm_sink_stop (GstBaseSink * bsink)
   gst_poll_free (self->poll);
   self->poll = NULL;
 
+  if (self->allocator) {
+    gst_shm_sink_allocator_detach (self->allocator);
+    gst_object_unref (self->allocator);
+    self->allocator = NULL;
+  }
+
+  /* the memory still used upstream keeps the pipe alive */
+  GST_OBJECT_LOCK (self);
   sp_close (self->pipe);
   self->pipe = NULL;
+  gst_event_replace (&self->caps_event, NULL);
+  self->need_caps = FALSE;
+  GST_OBJECT_UNLOCK (self);
+
+  /* wake up upstream waiting for the clients to release a block */
+  g_cond_broadcast (self->cond);
 
   return TRUE;
 }
@@ -389,6 +653,68 @@ gst_shm_sink_can_render (GstShmSink * self, GstClockTime time)
   return TRUE;
 }
 
+/* Sends a serialized event or caps packet to the clients. Called with the
+ * object lock */
+static gboolean
+gst_shm_sink_send_packet (GstShmSink * self, const guint8 * header,
+    const guint8 * payload)
+{
+  ShmBlock *block;
+  gchar *shmbuf;
+  guint size;
+
+  if (!self->clients)
+    return TRUE;
+
+  size = GST_DP_HEADER_LENGTH + gst_dp_header_payload_length (header);
+  while ((block = sp_writer_alloc_block (self->pipe, size)) == NULL) {
+    g_cond_wait (self->cond, GST_OBJECT_GET_LOCK (self));
+    if (self->unlock)
+      return FALSE;
+  }
+
+  shmbuf = sp_writer_block_get_buf (block);
+  memcpy (shmbuf, header, GST_DP_HEADER_LENGTH);
+  if (payload)
+    memcpy (shmbuf + GST_DP_HEADER_LENGTH, payload,
+        size - GST_DP_HEADER_LENGTH);
+  sp_writer_send_buf (self->pipe, shmbuf, size, GST_CLOCK_TIME_NONE,
+      SHM_BUFFER_FLAG_EVENT);
+  sp_writer_free_block (block);
+
+  return TRUE;
+}
+
+/* Called with the object lock */
+static gboolean
+gst_shm_sink_send_event (GstShmSink * self, GstEvent * event)
+{
+  guint8 *header = NULL, *payload = NULL;
+  guint length;
+  gboolean ret;
+
+  if (GST_EVENT_TYPE (event) == GST_EVENT_CAPS) {
+    GstCaps *caps;
+
+    gst_event_parse_caps (event, &caps);
+    ret = self->packetizer->packet_from_caps (caps, GST_DP_HEADER_FLAG_NONE,
+        &length, &header, &payload);
+  } else {
+    ret = self->packetizer->packet_from_event (event, GST_DP_HEADER_FLAG_NONE,
+        &length, &header, &payload);
+  }
+
+  if (ret)
+    ret = gst_shm_sink_send_packet (self, header, payload);
+  else
+    GST_WARNING_OBJECT (self, "Could not serialize %" GST_PTR_FORMAT, event);
+
+  g_free (header);
+  g_free (payload);
+
+  return ret;
+}
+
 static GstFlowReturn
 gst_shm_sink_render (GstBaseSink * bsink, GstBuffer * buf)
 {
@@ -413,9 +739,20 @@ gst_shm_sink_render (GstBaseSink * bsink, GstBuffer * buf)
     }
   }
 
+  /* clients that connected since the last caps did not get them yet */
+  if (self->need_caps && self->forward_events && self->caps_event) {
+    if (!gst_shm_sink_send_event (self, self->caps_event)) {
+      GST_OBJECT_UNLOCK (self);
+      return GST_FLOW_FLUSHING;
+    }
+    self->need_caps = FALSE;
+  }
+
+  /* buffers from our allocator are already in the shared memory area and
+   * are sent as they are */
   gst_buffer_map (buf, &map, GST_MAP_READ);
   rv = sp_writer_send_buf (self->pipe, (char *) map.data, map.size,
-      GST_BUFFER_TIMESTAMP (buf));
+      GST_BUFFER_TIMESTAMP (buf), 0);
   gst_buffer_unmap (buf, &map);
 
   if (rv == -1) {
@@ -441,7 +778,7 @@ gst_shm_sink_render (GstBaseSink * bsink, GstBuffer * buf)
     shmbuf = sp_writer_block_get_buf (block);
     gst_buffer_extract (buf, 0, shmbuf, gst_buffer_get_size (buf));
     sp_writer_send_buf (self->pipe, shmbuf, gst_buffer_get_size (buf),
-        GST_BUFFER_TIMESTAMP (buf));
+        GST_BUFFER_TIMESTAMP (buf), 0);
     sp_writer_free_block (block);
   }
 
@@ -450,67 +787,6 @@ gst_shm_sink_render (GstBaseSink * bsink, GstBuffer * buf)
   return GST_FLOW_OK;
 }
 
-#if 0
-
-/* FIXME 0.11 implement some bufferpool support */
-
-static void
-gst_shm_sink_free_buffer (gpointer data)
-{
-  ShmPipe *pipe;
-  ShmBlock *block = data;
-  GstShmSink *self;
-
-  pipe = sp_writer_block_get_pipe (block);
-  self = sp_get_data (pipe);
-
-  GST_OBJECT_LOCK (self);
-  sp_writer_free_block (block);
-  GST_OBJECT_UNLOCK (self);
-  g_object_unref (self);
-}
-
-static GstFlowReturn
-gst_shm_sink_buffer_alloc (GstBaseSink * sink, guint64 offset, guint size,
-    GstCaps * caps, GstBuffer ** out_buf)
-{
-  GstShmSink *self = GST_SHM_SINK (sink);
-  GstBuffer *buffer;
-  ShmBlock *block = NULL;
-  gpointer buf = NULL;
-
-  GST_OBJECT_LOCK (self);
-  block = sp_writer_alloc_block (self->pipe, size);
-  if (block) {
-    buf = sp_writer_block_get_buf (block);
-    g_object_ref (self);
-  }
-  GST_OBJECT_UNLOCK (self);
-
-  if (block) {
-    buffer = gst_buffer_new ();
-    GST_BUFFER_DATA (buffer) = buf;
-    GST_BUFFER_MALLOCDATA (buffer) = (guint8 *) block;
-    GST_BUFFER_FREE_FUNC (buffer) =
-        GST_DEBUG_FUNCPTR (gst_shm_sink_free_buffer);
-    GST_BUFFER_SIZE (buffer) = size;
-    GST_LOG_OBJECT (self,
-        "Allocated buffer of %u bytes from shared memory at %p", size, buf);
-  } else {
-    buffer = gst_buffer_new_and_alloc (size);
-    GST_LOG_OBJECT (self, "Not enough shared memory for buffer of %u bytes, "
-        "allocating using standard allocator", size);
-  }
-
-  GST_BUFFER_OFFSET (buffer) = offset;
-  gst_buffer_set_caps (buffer, caps);
-
-  *out_buf = buffer;
-
-  return GST_FLOW_OK;
-}
-#endif
-
 static gpointer
 pollthread_func (gpointer data)
 {
@@ -561,7 +837,10 @@ pollthread_func (gpointer data)
       gclient->pollfd.fd = sp_writer_get_client_fd (client);
       gst_poll_add_fd (self->poll, &gclient->pollfd);
       gst_poll_fd_ctl_read (self->poll, &gclient->pollfd, TRUE);
+      GST_OBJECT_LOCK (self);
       self->clients = g_list_prepend (self->clients, gclient);
+      self->need_caps = TRUE;
+      GST_OBJECT_UNLOCK (self);
       g_signal_emit (self, signals[SIGNAL_CLIENT_CONNECTED], 0,
           gclient->pollfd.fd);
       /* we need to call gst_poll_wait before calling gst_poll_* status
@@ -621,11 +900,37 @@ pollthread_func (gpointer data)
   return NULL;
 }
 
+/* shmsrc creates its own segment and stream-start events */
+static gboolean
+gst_shm_sink_is_forwarded_event (GstEvent * event)
+{
+  switch (GST_EVENT_TYPE (event)) {
+    case GST_EVENT_CAPS:
+    case GST_EVENT_TAG:
+    case GST_EVENT_EOS:
+    case GST_EVENT_CUSTOM_DOWNSTREAM:
+      return TRUE;
+    default:
+      return FALSE;
+  }
+}
+
 static gboolean
 gst_shm_sink_event (GstBaseSink * bsink, GstEvent * event)
 {
   GstShmSink *self = GST_SHM_SINK (bsink);
 
+  GST_OBJECT_LOCK (self);
+  if (GST_EVENT_TYPE (event) == GST_EVENT_CAPS)
+    gst_event_replace (&self->caps_event, event);
+  if (self->forward_events && gst_shm_sink_is_forwarded_event (event)) {
+    GST_DEBUG_OBJECT (self, "Forwarding %" GST_PTR_FORMAT, event);
+    if (gst_shm_sink_send_event (self, event) &&
+        GST_EVENT_TYPE (event) == GST_EVENT_CAPS)
+      self->need_caps = FALSE;
+  }
+  GST_OBJECT_UNLOCK (self);
+
   switch (GST_EVENT_TYPE (event)) {
     case GST_EVENT_EOS:
       GST_OBJECT_LOCK (self);
@@ -638,6 +943,17 @@ gst_shm_sink_event (GstBaseSink * bsink, GstEvent * event)
       break;
   }
 
+  return GST_BASE_SINK_CLASS (parent_class)->event (bsink, event);
+}
+
+static gboolean
+gst_shm_sink_propose_allocation (GstBaseSink * bsink, GstQuery * query)
+{
+  GstShmSink *self = GST_SHM_SINK (bsink);
+
+  if (self->allocator)
+    gst_query_add_allocation_param (query, self->allocator, NULL);
+
   return TRUE;
 }
 
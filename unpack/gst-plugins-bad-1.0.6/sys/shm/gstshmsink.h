@@ -26,6 +26,7 @@
 #include <gst/base/gstbasesink.h>
 
 #include "shmpipe.h"
+#include "dataprotocol.h"
 
 G_BEGIN_DECLS
 #define GST_TYPE_SHM_SINK \
@@ -64,6 +65,13 @@ struct _GstShmSink
   GstClockTimeDiff buffer_time;
 
   GCond *cond;
+
+  GstAllocator *allocator;
+
+  gboolean forward_events;
+  GstDPPacketizer *packetizer;
+  GstEvent *caps_event;
+  gboolean need_caps;
 };
 
 struct _GstShmSinkClass
@@ -31,6 +31,9 @@
  * chroma-site=(string)mpeg2, width=(int)320, height=(int)240, framerate=(fraction)30/1" ! autovideosink
  * ]| Render video from shm buffers.
  * </refsect2>
+ *
+ * When the sink forwards caps and events, they are set and pushed by the
+ * source and it goes EOS when the sink received EOS.
  */
 
 #ifdef HAVE_CONFIG_H
@@ -38,6 +41,7 @@
 #endif
 
 #include "gstshmsrc.h"
+#include "dataprotocol.h"
 
 #include <gst/gst.h>
 
@@ -303,12 +307,71 @@ free_buffer (gpointer data)
   g_slice_free (struct GstShmBuffer, gsb);
 }
 
+/* Handles a caps or event packet sent by the sink */
+static GstFlowReturn
+gst_shm_src_handle_packet (GstShmSrc * self, const guint8 * data, gsize size)
+{
+  const guint8 *payload = NULL;
+  GstEvent *event;
+  GstCaps *caps;
+  gboolean res;
+
+  if (size < GST_DP_HEADER_LENGTH ||
+      size < GST_DP_HEADER_LENGTH + gst_dp_header_payload_length (data))
+    goto invalid;
+
+  if (gst_dp_header_payload_length (data) > 0)
+    payload = data + GST_DP_HEADER_LENGTH;
+
+  if (!gst_dp_validate_packet (GST_DP_HEADER_LENGTH, data, payload))
+    goto invalid;
+
+  switch (gst_dp_header_payload_type (data)) {
+    case GST_DP_PAYLOAD_NONE:
+    case GST_DP_PAYLOAD_BUFFER:
+      goto invalid;
+    case GST_DP_PAYLOAD_CAPS:
+      caps = gst_dp_caps_from_packet (GST_DP_HEADER_LENGTH, data, payload);
+      if (!caps)
+        goto invalid;
+
+      GST_DEBUG_OBJECT (self, "Received caps %" GST_PTR_FORMAT, caps);
+      res = gst_base_src_set_caps (GST_BASE_SRC (self), caps);
+      gst_caps_unref (caps);
+      if (!res)
+        return GST_FLOW_NOT_NEGOTIATED;
+      break;
+    default:
+      event = gst_dp_event_from_packet (GST_DP_HEADER_LENGTH, data, payload);
+      if (!event)
+        goto invalid;
+
+      GST_DEBUG_OBJECT (self, "Received %" GST_PTR_FORMAT, event);
+      if (GST_EVENT_TYPE (event) == GST_EVENT_EOS) {
+        gst_event_unref (event);
+        return GST_FLOW_EOS;
+      }
+      gst_pad_push_event (GST_BASE_SRC_PAD (self), event);
+      break;
+  }
+
+  return GST_FLOW_OK;
+
+invalid:
+  {
+    GST_WARNING_OBJECT (self, "Ignoring invalid event packet of %"
+        G_GSIZE_FORMAT " bytes", size);
+    return GST_FLOW_OK;
+  }
+}
+
 static GstFlowReturn
 gst_shm_src_create (GstPushSrc * psrc, GstBuffer ** outbuf)
 {
   GstShmSrc *self = GST_SHM_SRC (psrc);
   gchar *buf = NULL;
   int rv = 0;
+  unsigned int flags = 0;
   struct GstShmBuffer *gsb;
 
   do {
@@ -339,13 +402,27 @@ gst_shm_src_create (GstPushSrc * psrc, GstBuffer ** outbuf)
       buf = NULL;
       GST_LOG_OBJECT (self, "Reading from pipe");
       GST_OBJECT_LOCK (self);
-      rv = sp_client_recv (self->pipe->pipe, &buf);
+      rv = sp_client_recv (self->pipe->pipe, &buf, &flags);
       GST_OBJECT_UNLOCK (self);
       if (rv < 0) {
         GST_ELEMENT_ERROR (self, RESOURCE, READ, ("Failed to read from shmsrc"),
             ("Error reading control data: %d", rv));
         return GST_FLOW_ERROR;
       }
+
+      if (buf && (flags & SHM_BUFFER_FLAG_EVENT)) {
+        GstFlowReturn ret;
+
+        ret = gst_shm_src_handle_packet (self, (guint8 *) buf, rv);
+
+        GST_OBJECT_LOCK (self);
+        sp_client_recv_finish (self->pipe->pipe, buf);
+        GST_OBJECT_UNLOCK (self);
+
+        if (ret != GST_FLOW_OK)
+          return ret;
+        buf = NULL;
+      }
     }
   } while (buf == NULL);
 
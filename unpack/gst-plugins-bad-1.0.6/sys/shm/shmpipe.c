@@ -47,6 +47,10 @@
 #include <sys/mman.h>
 #include <assert.h>
 
+#ifdef __linux__
+#include <sys/syscall.h>
+#endif
+
 #include "shmalloc.h"
 
 /*
@@ -55,7 +59,8 @@
  * The defined types are:
  * type 1: new shm area
  * Area length
- * Size of path (followed by path)
+ * Size of path (followed by path), or 0 if the file descriptor of the
+ * area is passed along with the command
  *
  * type 2: Close shm area:
  * No payload
@@ -63,6 +68,7 @@
  * type 3: shm buffer
  * offset
  * bufsize
+ * flags
  *
  * type 4: ack buffer
  * offset
@@ -70,11 +76,23 @@
  * Type 4 goes from the client to the server
  * The rest are from the server to the client
  * The client should never write in the SHM
+ *
+ * The packets are struct CommandBuffer in the native layout and are not
+ * versioned, both ends must be built from the same shmpipe.c (the buffer
+ * flags changed the size of the struct), so shmsrc and shmsink of
+ * different releases can't talk to each other
  */
 
 
 #define LISTEN_BACKLOG 10
 
+#if defined(__linux__) && defined(__NR_memfd_create)
+#define SHM_PIPE_USE_MEMFD
+#ifndef MFD_CLOEXEC
+#define MFD_CLOEXEC 0x0001U
+#endif
+#endif
+
 enum
 {
   COMMAND_NEW_SHM_AREA = 1,
@@ -172,6 +190,7 @@ struct CommandBuffer
     {
       unsigned long offset;
       unsigned long size;
+      unsigned int flags;
     } buffer;
     struct
     {
@@ -180,7 +199,8 @@ struct CommandBuffer
   } payload;
 };
 
-static ShmArea *sp_open_shm (char *path, int id, mode_t perms, size_t size);
+static ShmArea *sp_open_shm (char *path, int fd, int id, mode_t perms,
+    size_t size);
 static void sp_close_shm (ShmArea * area);
 static int sp_shmbuf_dec (ShmPipe * self, ShmBuffer * buf,
     ShmBuffer * prev_buf, ShmClient * client);
@@ -238,7 +258,7 @@ sp_writer_create (const char *path, size_t size, mode_t perms)
   if (listen (self->main_socket, LISTEN_BACKLOG) < 0)
     RETURN_ERROR ("listen() failed (%d): %s\n", errno, strerror (errno));
 
-  self->shm_area = sp_open_shm (NULL, ++self->next_area_id, perms, size);
+  self->shm_area = sp_open_shm (NULL, -1, ++self->next_area_id, perms, size);
 
   self->perms = perms;
 
@@ -261,15 +281,19 @@ sp_writer_create (const char *path, size_t size, mode_t perms)
  * sp_open_shm:
  * @path: Path of the shm area for a reader,
  *  NULL if this is a writer (then it will allocate its own path)
+ * @fd: File descriptor of the shm area for a reader that received it from
+ *  the writer, -1 otherwise. The area takes ownership of it.
  *
- * Opens a ShmArea
+ * Opens a ShmArea. Writers use an anonymous memfd when the system supports
+ * it and a named POSIX shm object otherwise.
  */
 
 static ShmArea *
-sp_open_shm (char *path, int id, mode_t perms, size_t size)
+sp_open_shm (char *path, int fd, int id, mode_t perms, size_t size)
 {
   ShmArea *area = spalloc_new (ShmArea);
-  char tmppath[32];
+  char tmppath[32] = "memfd";
+  int writer = (path == NULL && fd < 0);
   int flags;
   int prot;
   int i = 0;
@@ -294,20 +318,32 @@ sp_open_shm (char *path, int id, mode_t perms, size_t size)
 
   if (path) {
     area->shm_fd = shm_open (path, flags, perms);
+  } else if (fd >= 0) {
+    area->shm_fd = fd;
   } else {
-    do {
+#ifdef SHM_PIPE_USE_MEMFD
+    /* fails with ENOSYS on kernels older than 3.17 */
+    area->shm_fd = syscall (__NR_memfd_create, "shmpipe", MFD_CLOEXEC);
+    if (area->shm_fd >= 0 && perms)
+      fchmod (area->shm_fd, perms);
+#endif
+    while (area->shm_fd < 0) {
       snprintf (tmppath, sizeof (tmppath), "/shmpipe.%5d.%5d", getpid (), i++);
       area->shm_fd = shm_open (tmppath, flags, perms);
-    } while (area->shm_fd < 0 && errno == EEXIST);
+      if (area->shm_fd >= 0) {
+        area->shm_area_name = strdup (tmppath);
+        break;
+      }
+      if (errno != EEXIST)
+        break;
+    }
   }
 
   if (area->shm_fd < 0)
     RETURN_ERROR ("shm_open failed on %s (%d): %s\n",
         path ? path : tmppath, errno, strerror (errno));
 
-  if (!path) {
-    area->shm_area_name = strdup (tmppath);
-
+  if (writer) {
     if (ftruncate (area->shm_fd, size))
       RETURN_ERROR ("Could not resize memory area to header size,"
           " ftruncate failed (%d): %s\n", errno, strerror (errno));
@@ -324,7 +360,7 @@ sp_open_shm (char *path, int id, mode_t perms, size_t size)
 
   area->id = id;
 
-  if (!path)
+  if (writer)
     area->allocspace = shm_alloc_space_new (area->shm_area_len);
 
   return area;
@@ -462,6 +498,65 @@ send_command (int fd, struct CommandBuffer *cb, unsigned short int type,
   return 1;
 }
 
+/* Sends a command with a file descriptor attached to it */
+static int
+send_command_with_fd (int fd, struct CommandBuffer *cb,
+    unsigned short int type, int area_id, int passed_fd)
+{
+  struct msghdr msg = { 0 };
+  struct iovec iov;
+  struct cmsghdr *cmsg;
+  char control[CMSG_SPACE (sizeof (int))];
+
+  cb->type = type;
+  cb->area_id = area_id;
+
+  iov.iov_base = cb;
+  iov.iov_len = sizeof (struct CommandBuffer);
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  msg.msg_control = control;
+  msg.msg_controllen = sizeof (control);
+
+  cmsg = CMSG_FIRSTHDR (&msg);
+  cmsg->cmsg_level = SOL_SOCKET;
+  cmsg->cmsg_type = SCM_RIGHTS;
+  cmsg->cmsg_len = CMSG_LEN (sizeof (int));
+  memcpy (CMSG_DATA (cmsg), &passed_fd, sizeof (int));
+
+  if (sendmsg (fd, &msg, MSG_NOSIGNAL) != sizeof (struct CommandBuffer))
+    return 0;
+
+  return 1;
+}
+
+/* Announces @area to the client at the other end of @fd, either by name or
+ * by passing its file descriptor */
+static int
+send_new_shm_area (int fd, ShmArea * area)
+{
+  struct CommandBuffer cb = { 0 };
+  int pathlen;
+
+  cb.payload.new_shm_area.size = area->shm_area_len;
+
+  if (!area->shm_area_name) {
+    cb.payload.new_shm_area.path_size = 0;
+    return send_command_with_fd (fd, &cb, COMMAND_NEW_SHM_AREA, area->id,
+        area->shm_fd);
+  }
+
+  pathlen = strlen (area->shm_area_name) + 1;
+  cb.payload.new_shm_area.path_size = pathlen;
+  if (!send_command (fd, &cb, COMMAND_NEW_SHM_AREA, area->id))
+    return 0;
+
+  if (send (fd, area->shm_area_name, pathlen, MSG_NOSIGNAL) != pathlen)
+    return 0;
+
+  return 1;
+}
+
 int
 sp_writer_resize (ShmPipe * self, size_t size)
 {
@@ -469,12 +564,11 @@ sp_writer_resize (ShmPipe * self, size_t size)
   ShmArea *old_current;
   ShmClient *client;
   int c = 0;
-  int pathlen;
 
   if (self->shm_area->shm_area_len == size)
     return 0;
 
-  newarea = sp_open_shm (NULL, ++self->next_area_id, self->perms, size);
+  newarea = sp_open_shm (NULL, -1, ++self->next_area_id, self->perms, size);
 
   if (!newarea)
     return -1;
@@ -483,8 +577,6 @@ sp_writer_resize (ShmPipe * self, size_t size)
   newarea->next = self->shm_area;
   self->shm_area = newarea;
 
-  pathlen = strlen (newarea->shm_area_name) + 1;
-
   for (client = self->clients; client; client = client->next) {
     struct CommandBuffer cb = { 0 };
 
@@ -492,13 +584,7 @@ sp_writer_resize (ShmPipe * self, size_t size)
             old_current->id))
       continue;
 
-    cb.payload.new_shm_area.size = newarea->shm_area_len;
-    cb.payload.new_shm_area.path_size = pathlen;
-    if (!send_command (client->fd, &cb, COMMAND_NEW_SHM_AREA, newarea->id))
-      continue;
-
-    if (send (client->fd, newarea->shm_area_name, pathlen, MSG_NOSIGNAL) !=
-        pathlen)
+    if (!send_new_shm_area (client->fd, newarea))
       continue;
     c++;
   }
@@ -541,6 +627,19 @@ sp_writer_block_get_pipe (ShmBlock * block)
   return block->pipe;
 }
 
+int
+sp_writer_block_is_pending (ShmBlock * block)
+{
+  ShmBuffer *buf;
+
+  for (buf = block->pipe->buffers; buf; buf = buf->next) {
+    if (buf->ablock == block->ablock)
+      return 1;
+  }
+
+  return 0;
+}
+
 void
 sp_writer_free_block (ShmBlock * block)
 {
@@ -553,7 +652,8 @@ sp_writer_free_block (ShmBlock * block)
 /* Returns the number of client this has successfully been sent to */
 
 int
-sp_writer_send_buf (ShmPipe * self, char *buf, size_t size, uint64_t tag)
+sp_writer_send_buf (ShmPipe * self, char *buf, size_t size, uint64_t tag,
+    unsigned int flags)
 {
   ShmArea *area = NULL;
   unsigned long offset = 0;
@@ -594,6 +694,7 @@ sp_writer_send_buf (ShmPipe * self, char *buf, size_t size, uint64_t tag)
     struct CommandBuffer cb = { 0 };
     cb.payload.buffer.offset = offset;
     cb.payload.buffer.size = bsize;
+    cb.payload.buffer.flags = flags;
     if (!send_command (client->fd, &cb, COMMAND_NEW_BUFFER, self->shm_area->id))
       continue;
     sb->clients[i++] = client->fd;
@@ -616,12 +717,41 @@ sp_writer_send_buf (ShmPipe * self, char *buf, size_t size, uint64_t tag)
   return c;
 }
 
+/* Receives a command, if @passed_fd is not NULL, it is set to the file
+ * descriptor that came with the command or -1 */
 static int
-recv_command (int fd, struct CommandBuffer *cb)
+recv_command (int fd, struct CommandBuffer *cb, int *passed_fd)
 {
+  struct msghdr msg = { 0 };
+  struct iovec iov;
+  struct cmsghdr *cmsg;
+  char control[CMSG_SPACE (sizeof (int))];
   int retval;
 
-  retval = recv (fd, cb, sizeof (struct CommandBuffer), MSG_DONTWAIT);
+  iov.iov_base = cb;
+  iov.iov_len = sizeof (struct CommandBuffer);
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  msg.msg_control = control;
+  msg.msg_controllen = sizeof (control);
+
+  retval = recvmsg (fd, &msg, MSG_DONTWAIT);
+
+  for (cmsg = CMSG_FIRSTHDR (&msg); cmsg; cmsg = CMSG_NXTHDR (&msg, cmsg)) {
+    if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS) {
+      int received_fd;
+
+      memcpy (&received_fd, CMSG_DATA (cmsg), sizeof (int));
+      if (passed_fd)
+        *passed_fd = received_fd;
+      else
+        close (received_fd);
+      passed_fd = NULL;
+    }
+  }
+  if (passed_fd)
+    *passed_fd = -1;
+
   if (retval == sizeof (struct CommandBuffer)) {
     return 1;
   } else {
@@ -630,22 +760,46 @@ recv_command (int fd, struct CommandBuffer *cb)
 }
 
 long int
-sp_client_recv (ShmPipe * self, char **buf)
+sp_client_recv (ShmPipe * self, char **buf, unsigned int *flags)
 {
   char *area_name = NULL;
   ShmArea *newarea;
   ShmArea *area;
   struct CommandBuffer cb;
+  int passed_fd = -1;
   int retval;
 
-  if (!recv_command (self->main_socket, &cb))
+  if (!recv_command (self->main_socket, &cb, &passed_fd)) {
+    if (passed_fd >= 0)
+      close (passed_fd);
     return -1;
+  }
+
+  if (passed_fd >= 0 && (cb.type != COMMAND_NEW_SHM_AREA ||
+          cb.payload.new_shm_area.path_size > 0)) {
+    close (passed_fd);
+    passed_fd = -1;
+  }
 
   switch (cb.type) {
     case COMMAND_NEW_SHM_AREA:
-      assert (cb.payload.new_shm_area.path_size > 0);
       assert (cb.payload.new_shm_area.size > 0);
 
+      if (cb.payload.new_shm_area.path_size == 0) {
+        /* the area was passed as a file descriptor */
+        if (passed_fd < 0)
+          return -3;
+
+        newarea = sp_open_shm (NULL, passed_fd, cb.area_id, 0,
+            cb.payload.new_shm_area.size);
+        if (!newarea)
+          return -4;
+
+        newarea->next = self->shm_area;
+        self->shm_area = newarea;
+        break;
+      }
+
       area_name = malloc (cb.payload.new_shm_area.path_size);
       retval = recv (self->main_socket, area_name,
           cb.payload.new_shm_area.path_size, 0);
@@ -654,7 +808,7 @@ sp_client_recv (ShmPipe * self, char **buf)
         return -3;
       }
 
-      newarea = sp_open_shm (area_name, cb.area_id, 0,
+      newarea = sp_open_shm (area_name, -1, cb.area_id, 0,
           cb.payload.new_shm_area.size);
       free (area_name);
       if (!newarea)
@@ -678,6 +832,8 @@ sp_client_recv (ShmPipe * self, char **buf)
       for (area = self->shm_area; area; area = area->next) {
         if (area->id == cb.area_id) {
           *buf = area->shm_area_buf + cb.payload.buffer.offset;
+          if (flags)
+            *flags = cb.payload.buffer.flags;
           sp_shm_area_inc (area);
           return cb.payload.buffer.size;
         }
@@ -697,7 +853,7 @@ sp_writer_recv (ShmPipe * self, ShmClient * client)
   ShmBuffer *buf = NULL, *prev_buf = NULL;
   struct CommandBuffer cb;
 
-  if (!recv_command (client->fd, &cb))
+  if (!recv_command (client->fd, &cb, NULL))
     return -1;
 
   switch (cb.type) {
@@ -781,8 +937,6 @@ sp_writer_accept_client (ShmPipe * self)
 {
   ShmClient *client = NULL;
   int fd;
-  struct CommandBuffer cb = { 0 };
-  int pathlen = strlen (self->shm_area->shm_area_name) + 1;
 
 
   fd = accept (self->main_socket, NULL, NULL);
@@ -792,19 +946,11 @@ sp_writer_accept_client (ShmPipe * self)
     return NULL;
   }
 
-  cb.payload.new_shm_area.size = self->shm_area->shm_area_len;
-  cb.payload.new_shm_area.path_size = pathlen;
-  if (!send_command (fd, &cb, COMMAND_NEW_SHM_AREA, self->shm_area->id)) {
+  if (!send_new_shm_area (fd, self->shm_area)) {
     fprintf (stderr, "Sending new shm area failed: %s", strerror (errno));
     goto error;
   }
 
-  if (send (fd, self->shm_area->shm_area_name, pathlen, MSG_NOSIGNAL) !=
-      pathlen) {
-    fprintf (stderr, "Sending new shm area path failed: %s", strerror (errno));
-    goto error;
-  }
-
   client = spalloc_new (ShmClient);
   client->fd = fd;
 
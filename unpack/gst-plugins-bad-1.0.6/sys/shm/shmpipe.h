@@ -42,7 +42,9 @@
  * (retrieved with sp_writer_block_get_buf(), then calls
  * sp_writer_send_buf() to send the buffer or a subsection to the
  * other side. When it is done with the block, it calls
- * sp_writer_free_block().  If alloc fails, then the server must wait
+ * sp_writer_free_block(). A block that was sent stays allocated until
+ * all clients released the buffer, sp_writer_block_is_pending() tells
+ * whether that is still the case before writing in it again.  If alloc fails, then the server must wait
  * for events on the client fd (the ones where sp_writer_recv() is
  * called), and then try to re-alloc.
  *
@@ -78,6 +80,9 @@ typedef struct _ShmPipe ShmPipe;
 typedef struct _ShmBlock ShmBlock;
 typedef struct _ShmBuffer ShmBuffer;
 
+/* The buffer carries a serialized event instead of data */
+#define SHM_BUFFER_FLAG_EVENT (1 << 0)
+
 ShmPipe *sp_writer_create (const char *path, size_t size, mode_t perms);
 const char *sp_writer_get_path (ShmPipe *pipe);
 void sp_close (ShmPipe * self);
@@ -92,7 +97,9 @@ int sp_writer_get_client_fd (ShmClient * client);
 
 ShmBlock *sp_writer_alloc_block (ShmPipe * self, size_t size);
 void sp_writer_free_block (ShmBlock *block);
-int sp_writer_send_buf (ShmPipe * self, char *buf, size_t size, uint64_t tag);
+int sp_writer_block_is_pending (ShmBlock *block);
+int sp_writer_send_buf (ShmPipe * self, char *buf, size_t size, uint64_t tag,
+    unsigned int flags);
 char *sp_writer_block_get_buf (ShmBlock *block);
 ShmPipe *sp_writer_block_get_pipe (ShmBlock *block);
 
@@ -103,7 +110,7 @@ int sp_writer_recv (ShmPipe * self, ShmClient * client);
 int sp_writer_pending_writes (ShmPipe * self);
 
 ShmPipe *sp_client_open (const char *path);
-long int sp_client_recv (ShmPipe * self, char **buf);
+long int sp_client_recv (ShmPipe * self, char **buf, unsigned int *flags);
 int sp_client_recv_finish (ShmPipe * self, char *buf);
 
 ShmBuffer *sp_writer_get_pending_buffers (ShmPipe * self);
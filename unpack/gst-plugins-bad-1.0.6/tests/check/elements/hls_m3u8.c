@@ -0,0 +1,325 @@
+/* GStreamer unit test for the m3u8 playlist parser of hlsdemux
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#include <string.h>
+
+#include <gst/check/gstcheck.h>
+
+#include "m3u8.h"
+
+GST_DEBUG_CATEGORY (fragmented_debug);
+
+/* a live playlist with n 10 seconds fragments, starting at sequence first */
+static gchar *
+make_live_playlist (guint first, guint n, const gchar * prefix)
+{
+  GString *str;
+  guint i;
+
+  str = g_string_new ("#EXTM3U\n#EXT-X-TARGETDURATION:10\n");
+  g_string_append_printf (str, "#EXT-X-MEDIA-SEQUENCE:%u\n", first);
+  for (i = first; i < first + n; i++)
+    g_string_append_printf (str, "#EXTINF:10,\n%s%u.ts\n", prefix, i);
+
+  return g_string_free (str, FALSE);
+}
+
+static GstM3U8MediaFile *
+get_file (GstM3U8Client * client, guint index)
+{
+  fail_unless (index < client->current->files->len);
+  return g_ptr_array_index (client->current->files, index);
+}
+
+static void
+check_files (GstM3U8Client * client, guint first, guint n,
+    const gchar * prefix)
+{
+  GstM3U8MediaFile *file, *start;
+  guint i;
+
+  fail_unless_equals_int (client->current->files->len, n);
+  start = get_file (client, 0);
+  for (i = 0; i < n; i++) {
+    gchar *uri;
+
+    file = get_file (client, i);
+    uri = g_strdup_printf ("http://localhost/live/%s%u.ts", prefix, first + i);
+    fail_unless_equals_int (file->sequence, first + i);
+    fail_unless_equals_string (file->uri, uri);
+    fail_unless_equals_uint64 (file->offset - start->offset,
+        i * 10 * GST_SECOND);
+    g_free (uri);
+  }
+}
+
+GST_START_TEST (test_live_refresh)
+{
+  GstM3U8Client *client;
+  GstM3U8MediaFile *kept;
+
+  client = gst_m3u8_client_new ("http://localhost/live/main.m3u8");
+  fail_unless (gst_m3u8_client_update (client,
+          make_live_playlist (0, 4, "seg")));
+  check_files (client, 0, 4, "seg");
+  kept = get_file (client, 2);
+
+  /* two new fragments at the end, one removed at the start */
+  fail_unless (gst_m3u8_client_update (client,
+          make_live_playlist (1, 5, "seg")));
+  check_files (client, 1, 5, "seg");
+  fail_unless (get_file (client, 1) == kept);
+
+  /* the window slides past all the previous fragments but one */
+  fail_unless (gst_m3u8_client_update (client,
+          make_live_playlist (5, 3, "seg")));
+  check_files (client, 5, 3, "seg");
+
+  gst_m3u8_client_free (client);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_live_reload)
+{
+  GstM3U8Client *client;
+
+  client = gst_m3u8_client_new ("http://localhost/live/main.m3u8");
+  fail_unless (gst_m3u8_client_update (client,
+          make_live_playlist (10, 3, "seg")));
+  check_files (client, 10, 3, "seg");
+
+  /* the sequence numbers went back, the stream restarted */
+  fail_unless (gst_m3u8_client_update (client,
+          make_live_playlist (0, 3, "seg")));
+  check_files (client, 0, 3, "seg");
+
+  /* we missed some refreshes, none of our fragments are in the playlist */
+  fail_unless (gst_m3u8_client_update (client,
+          make_live_playlist (20, 3, "seg")));
+  check_files (client, 20, 3, "seg");
+
+  /* same sequence numbers but the fragments are different */
+  fail_unless (gst_m3u8_client_update (client,
+          make_live_playlist (20, 4, "other")));
+  check_files (client, 20, 4, "other");
+
+  gst_m3u8_client_free (client);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_next_fragment)
+{
+  GstM3U8Client *client;
+  gboolean discont;
+  gchar *uri, *key;
+  guint8 iv[16];
+  GstClockTime duration, timestamp;
+
+  client = gst_m3u8_client_new ("http://localhost/live/main.m3u8");
+  fail_unless (gst_m3u8_client_update (client,
+          make_live_playlist (100, 3, "seg")));
+
+  fail_unless (gst_m3u8_client_get_next_fragment (client, &discont, &uri,
+          &duration, &timestamp, &key, iv));
+  fail_unless_equals_string (uri, "http://localhost/live/seg100.ts");
+  fail_unless_equals_uint64 (duration, 10 * GST_SECOND);
+  fail_unless_equals_uint64 (timestamp, 0);
+  fail_if (discont);
+  fail_unless (key == NULL);
+  g_free (uri);
+
+  fail_unless (gst_m3u8_client_get_next_fragment (client, &discont, &uri,
+          &duration, &timestamp, &key, iv));
+  fail_unless_equals_string (uri, "http://localhost/live/seg101.ts");
+  fail_unless_equals_uint64 (timestamp, 10 * GST_SECOND);
+  g_free (uri);
+
+  /* the next fragment is found by its sequence after the window moved */
+  fail_unless (gst_m3u8_client_update (client,
+          make_live_playlist (101, 4, "seg")));
+  fail_unless (gst_m3u8_client_get_next_fragment (client, &discont, &uri,
+          &duration, &timestamp, &key, iv));
+  fail_unless_equals_string (uri, "http://localhost/live/seg102.ts");
+  fail_unless_equals_uint64 (timestamp, 10 * GST_SECOND);
+  fail_if (discont);
+  g_free (uri);
+
+  /* fragments that left the playlist are skipped */
+  fail_unless (gst_m3u8_client_update (client,
+          make_live_playlist (110, 2, "seg")));
+  fail_unless (gst_m3u8_client_get_next_fragment (client, &discont, &uri,
+          &duration, &timestamp, &key, iv));
+  fail_unless_equals_string (uri, "http://localhost/live/seg110.ts");
+  fail_unless (discont);
+  g_free (uri);
+
+  fail_unless (gst_m3u8_client_get_next_fragment (client, &discont, &uri,
+          &duration, &timestamp, &key, iv));
+  g_free (uri);
+  fail_if (gst_m3u8_client_get_next_fragment (client, &discont, &uri,
+          &duration, &timestamp, &key, iv));
+
+  gst_m3u8_client_free (client);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_vod_duration)
+{
+  GstM3U8Client *client;
+  gchar *playlist;
+
+  client = gst_m3u8_client_new ("http://localhost/live/main.m3u8");
+  playlist = make_live_playlist (0, 6, "seg");
+  fail_unless (gst_m3u8_client_update (client,
+          g_strconcat (playlist, "#EXT-X-ENDLIST\n", NULL)));
+  g_free (playlist);
+
+  fail_unless_equals_uint64 (gst_m3u8_client_get_duration (client),
+      60 * GST_SECOND);
+
+  gst_m3u8_client_free (client);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_keys)
+{
+  static const guint8 explicit_iv[16] = { 0x00, 0x11, 0x22, 0x33, 0x44, 0x55,
+    0x66, 0x77, 0x88, 0x99, 0xaa, 0xbb, 0xcc, 0xdd, 0xee, 0xff
+  };
+  static const guint8 sequence_iv[16] = { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 12
+  };
+  GstM3U8Client *client;
+
+  client = gst_m3u8_client_new ("http://localhost/live/main.m3u8");
+  fail_unless (gst_m3u8_client_update (client, g_strdup ("#EXTM3U\n"
+              "#EXT-X-TARGETDURATION:10\n"
+              "#EXT-X-MEDIA-SEQUENCE:10\n"
+              "#EXTINF:10,\nseg10.ts\n"
+              "#EXT-X-KEY:METHOD=AES-128,URI=\"key1.bin\",IV=0x00112233445566778899aabbccddeeff\n"
+              "#EXTINF:10,\nseg11.ts\n"
+              "#EXT-X-KEY:METHOD=AES-128,URI=\"https://keys.example.com/k2\"\n"
+              "#EXTINF:10,\nseg12.ts\n"
+              "#EXT-X-KEY:METHOD=NONE\n" "#EXTINF:10,\nseg13.ts\n")));
+
+  fail_unless (get_file (client, 0)->key == NULL);
+  fail_unless_equals_string (get_file (client, 1)->key,
+      "http://localhost/live/key1.bin");
+  fail_unless (memcmp (get_file (client, 1)->iv, explicit_iv, 16) == 0);
+  fail_unless_equals_string (get_file (client, 2)->key,
+      "https://keys.example.com/k2");
+  /* without IV attribute the IV is the sequence number */
+  fail_unless (memcmp (get_file (client, 2)->iv, sequence_iv, 16) == 0);
+  fail_unless (get_file (client, 3)->key == NULL);
+
+  gst_m3u8_client_free (client);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_key_next_fragment)
+{
+  gboolean discont;
+  gchar *uri, *key;
+  guint8 iv[16] = { 0, };
+  GstClockTime duration, timestamp;
+  GstM3U8Client *client;
+
+  client = gst_m3u8_client_new ("http://localhost/live/main.m3u8");
+  fail_unless (gst_m3u8_client_update (client, g_strdup ("#EXTM3U\n"
+              "#EXT-X-TARGETDURATION:10\n"
+              "#EXT-X-KEY:METHOD=AES-128,URI=\"k.bin\",IV=0x00000000000000000000000000000007\n"
+              "#EXTINF:10,\nseg0.ts\n")));
+
+  /* the returned key and IV are copies that stay valid after updates */
+  fail_unless (gst_m3u8_client_get_next_fragment (client, &discont, &uri,
+          &duration, &timestamp, &key, iv));
+  fail_unless (gst_m3u8_client_update (client, g_strdup ("#EXTM3U\n"
+              "#EXT-X-TARGETDURATION:10\n"
+              "#EXT-X-MEDIA-SEQUENCE:5\n" "#EXTINF:10,\nseg5.ts\n")));
+  fail_unless_equals_string (uri, "http://localhost/live/seg0.ts");
+  fail_unless_equals_string (key, "http://localhost/live/k.bin");
+  fail_unless_equals_int (iv[15], 7);
+  g_free (uri);
+  g_free (key);
+
+  gst_m3u8_client_free (client);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_key_quoted_comma)
+{
+  GstM3U8Client *client;
+
+  client = gst_m3u8_client_new ("http://localhost/live/main.m3u8");
+  fail_unless (gst_m3u8_client_update (client, g_strdup ("#EXTM3U\n"
+              "#EXT-X-TARGETDURATION:10\n"
+              "#EXT-X-KEY:METHOD=AES-128,URI=\"key?a=1,b=2\",IV=0x00112233445566778899aabbccddeeff\n"
+              "#EXTINF:10,\nseg0.ts\n")));
+
+  fail_unless_equals_string (get_file (client, 0)->key,
+      "http://localhost/live/key?a=1,b=2");
+  fail_unless_equals_int (get_file (client, 0)->iv[15], 0xff);
+
+  gst_m3u8_client_free (client);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_key_unsupported_method)
+{
+  GstM3U8Client *client;
+
+  client = gst_m3u8_client_new ("http://localhost/live/main.m3u8");
+  fail_if (gst_m3u8_client_update (client, g_strdup ("#EXTM3U\n"
+              "#EXT-X-TARGETDURATION:10\n"
+              "#EXT-X-KEY:METHOD=SAMPLE-AES,URI=\"k.bin\"\n"
+              "#EXTINF:10,\nseg0.ts\n")));
+
+  gst_m3u8_client_free (client);
+}
+
+GST_END_TEST;
+
+static Suite *
+hls_m3u8_suite (void)
+{
+  Suite *s = suite_create ("hls_m3u8");
+  TCase *tc_chain = tcase_create ("general");
+
+  GST_DEBUG_CATEGORY_INIT (fragmented_debug, "fragmented", 0, "m3u8 test");
+
+  suite_add_tcase (s, tc_chain);
+  tcase_add_test (tc_chain, test_live_refresh);
+  tcase_add_test (tc_chain, test_live_reload);
+  tcase_add_test (tc_chain, test_next_fragment);
+  tcase_add_test (tc_chain, test_vod_duration);
+  tcase_add_test (tc_chain, test_keys);
+  tcase_add_test (tc_chain, test_key_next_fragment);
+  tcase_add_test (tc_chain, test_key_quoted_comma);
+  tcase_add_test (tc_chain, test_key_unsupported_method);
+
+  return s;
+}
+
+GST_CHECK_MAIN (hls_m3u8);
@@ -0,0 +1,614 @@
+/* GStreamer unit test for hlsdemux
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include "config.h"
+#endif
+
+#include <stdio.h>
+#include <string.h>
+
+#include <gst/check/gstcheck.h>
+#include <gst/base/gstbasesrc.h>
+
+#ifdef HAVE_NETTLE
+#include <nettle/aes.h>
+#include <nettle/cbc.h>
+#endif
+
+/* A source for hlstest:// URIs that stands in for an HTTP server. Playlists
+ * are served from a table, every URI ending in .ts is an MPEG-TS fragment of
+ * fragment_size bytes. Each request waits for the latency, and fragments are
+ * then paced to take fragment_time to download, like a connection to a
+ * distant CDN. The pacing is against the start of the fragment, so a loaded
+ * machine can only make downloads slower, never faster, and the measured
+ * bandwidth has a fixed upper bound. Fragments named encN-S.ts are encrypted
+ * with the key served as kN.key */
+
+static GHashTable *playlists;
+static gsize fragment_size;
+static gulong fragment_time;
+static gulong latency;
+/* plain contents of every fragment */
+static guint8 *expected;
+
+/* fragment requests running at the same time */
+static gint active_fragments;
+static gint max_active_fragments;
+static gint key_requests;
+
+typedef struct
+{
+  GstBaseSrc parent;
+
+  gchar *uri;
+  guint8 *data;                 /* served data, NULL for plain fragments */
+  gsize size;
+  gint64 start_time;            /* monotonic time the request started */
+} TestSrc;
+
+typedef struct
+{
+  GstBaseSrcClass parent_class;
+} TestSrcClass;
+
+static GstStaticPadTemplate test_src_template = GST_STATIC_PAD_TEMPLATE ("src",
+    GST_PAD_SRC, GST_PAD_ALWAYS, GST_STATIC_CAPS_ANY);
+
+static GType test_src_get_type (void);
+static void test_src_uri_handler_init (gpointer g_iface, gpointer iface_data);
+
+G_DEFINE_TYPE_WITH_CODE (TestSrc, test_src, GST_TYPE_BASE_SRC,
+    G_IMPLEMENT_INTERFACE (GST_TYPE_URI_HANDLER, test_src_uri_handler_init));
+
+static gboolean
+test_src_is_fragment (TestSrc * src)
+{
+  return g_str_has_suffix (src->uri, ".ts");
+}
+
+static void
+fill_fragment (guint8 * data, gsize size)
+{
+  gsize i;
+
+  memset (data, 0xff, size);
+  for (i = 0; i < size; i += 188)
+    data[i] = 0x47;
+}
+
+#ifdef HAVE_NETTLE
+static void
+make_key (guint index, guint8 * key)
+{
+  memset (key, 0x11 * index, 16);
+}
+
+/* the fragments of the first key have an explicit IV in the playlist, the
+ * others use their sequence number */
+static void
+make_iv (guint index, guint sequence, guint8 * iv)
+{
+  guint i;
+
+  memset (iv, 0, 16);
+  if (index == 1) {
+    for (i = 0; i < 16; i++)
+      iv[i] = i;
+  } else {
+    GST_WRITE_UINT32_BE (iv + 12, sequence);
+  }
+}
+
+static guint8 *
+encrypt_fragment (const gchar * path, gsize * size)
+{
+  struct CBC_CTX (struct aes_ctx, AES_BLOCK_SIZE) aes;
+  guint index, sequence, pad;
+  guint8 key[16], iv[16], *data;
+
+  fail_unless (sscanf (path, "enc%u-%u.ts", &index, &sequence) == 2);
+  make_key (index, key);
+  make_iv (index, sequence, iv);
+
+  /* PKCS7 padding */
+  pad = AES_BLOCK_SIZE - fragment_size % AES_BLOCK_SIZE;
+  *size = fragment_size + pad;
+  data = g_malloc (*size);
+  fill_fragment (data, fragment_size);
+  memset (data + fragment_size, pad, pad);
+
+  aes_set_encrypt_key (&aes.ctx, 16, key);
+  CBC_SET_IV (&aes, iv);
+  CBC_ENCRYPT (&aes, aes_encrypt, *size, data, data);
+
+  return data;
+}
+#endif
+
+static gboolean
+test_src_start (GstBaseSrc * basesrc)
+{
+  TestSrc *src = (TestSrc *) basesrc;
+  const gchar *path = strrchr (src->uri, '/') + 1;
+
+  if (test_src_is_fragment (src)) {
+    gint active = g_atomic_int_add (&active_fragments, 1) + 1;
+
+    /* only updated from the streaming threads of the fragments */
+    if (active > g_atomic_int_get (&max_active_fragments))
+      g_atomic_int_set (&max_active_fragments, active);
+
+    src->size = fragment_size;
+#ifdef HAVE_NETTLE
+    if (g_str_has_prefix (path, "enc"))
+      src->data = encrypt_fragment (path, &src->size);
+#endif
+  } else if (g_str_has_suffix (path, ".key")) {
+#ifdef HAVE_NETTLE
+    guint index;
+
+    fail_unless (sscanf (path, "k%u.key", &index) == 1);
+    g_atomic_int_add (&key_requests, 1);
+    src->data = g_malloc (16);
+    make_key (index, src->data);
+    src->size = 16;
+#endif
+  } else {
+    const gchar *playlist = g_hash_table_lookup (playlists, path);
+
+    if (playlist == NULL) {
+      GST_ELEMENT_ERROR (src, RESOURCE, NOT_FOUND, (NULL), ("%s", src->uri));
+      return FALSE;
+    }
+    src->size = strlen (playlist);
+    src->data = (guint8 *) g_strdup (playlist);
+  }
+
+  src->start_time = g_get_monotonic_time ();
+  if (latency > 0)
+    g_usleep (latency);
+
+  return TRUE;
+}
+
+static gboolean
+test_src_stop (GstBaseSrc * basesrc)
+{
+  TestSrc *src = (TestSrc *) basesrc;
+
+  if (test_src_is_fragment (src))
+    g_atomic_int_add (&active_fragments, -1);
+
+  g_free (src->data);
+  src->data = NULL;
+
+  return TRUE;
+}
+
+static GstFlowReturn
+test_src_create (GstBaseSrc * basesrc, guint64 offset, guint length,
+    GstBuffer ** buffer)
+{
+  TestSrc *src = (TestSrc *) basesrc;
+  GstMapInfo map;
+  gint64 deadline, now;
+
+  if (offset >= src->size)
+    return GST_FLOW_EOS;
+
+  /* whole TS packets */
+  length = MIN (188 * 22, src->size - offset);
+
+  /* each part is delivered at its share of the fragment time */
+  if (fragment_time > 0 && test_src_is_fragment (src)) {
+    deadline = src->start_time + latency +
+        gst_util_uint64_scale (fragment_time, offset + length, src->size);
+    now = g_get_monotonic_time ();
+    if (deadline > now)
+      g_usleep (deadline - now);
+  }
+
+  *buffer = gst_buffer_new_allocate (NULL, length, NULL);
+  gst_buffer_map (*buffer, &map, GST_MAP_WRITE);
+  if (src->data)
+    memcpy (map.data, src->data + offset, length);
+  else
+    fill_fragment (map.data, length);
+  gst_buffer_unmap (*buffer, &map);
+  GST_BUFFER_OFFSET (*buffer) = offset;
+
+  return GST_FLOW_OK;
+}
+
+static void
+test_src_finalize (GObject * object)
+{
+  TestSrc *src = (TestSrc *) object;
+
+  g_free (src->uri);
+  g_free (src->data);
+
+  G_OBJECT_CLASS (test_src_parent_class)->finalize (object);
+}
+
+static void
+test_src_class_init (TestSrcClass * klass)
+{
+  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+  GstElementClass *element_class = GST_ELEMENT_CLASS (klass);
+  GstBaseSrcClass *basesrc_class = GST_BASE_SRC_CLASS (klass);
+
+  gobject_class->finalize = test_src_finalize;
+
+  gst_element_class_add_pad_template (element_class,
+      gst_static_pad_template_get (&test_src_template));
+  gst_element_class_set_static_metadata (element_class, "HLS test source",
+      "Source", "Serves scripted playlists and fragments", "GStreamer");
+
+  basesrc_class->start = test_src_start;
+  basesrc_class->stop = test_src_stop;
+  basesrc_class->create = test_src_create;
+}
+
+static void
+test_src_init (TestSrc * src)
+{
+}
+
+static GstURIType
+test_src_uri_get_type (GType type)
+{
+  return GST_URI_SRC;
+}
+
+static const gchar *const *
+test_src_uri_get_protocols (GType type)
+{
+  static const gchar *protocols[] = { "hlstest", NULL };
+
+  return protocols;
+}
+
+static gchar *
+test_src_uri_get_uri (GstURIHandler * handler)
+{
+  return g_strdup (((TestSrc *) handler)->uri);
+}
+
+static gboolean
+test_src_uri_set_uri (GstURIHandler * handler, const gchar * uri,
+    GError ** error)
+{
+  TestSrc *src = (TestSrc *) handler;
+
+  g_free (src->uri);
+  src->uri = g_strdup (uri);
+
+  return TRUE;
+}
+
+static void
+test_src_uri_handler_init (gpointer g_iface, gpointer iface_data)
+{
+  GstURIHandlerInterface *iface = (GstURIHandlerInterface *) g_iface;
+
+  iface->get_type = test_src_uri_get_type;
+  iface->get_protocols = test_src_uri_get_protocols;
+  iface->get_uri = test_src_uri_get_uri;
+  iface->set_uri = test_src_uri_set_uri;
+}
+
+static gchar *
+make_media_playlist (const gchar * name, guint n_fragments)
+{
+  GString *s;
+  guint i;
+
+  s = g_string_new ("#EXTM3U\n#EXT-X-TARGETDURATION:1\n"
+      "#EXT-X-MEDIA-SEQUENCE:0\n");
+  for (i = 0; i < n_fragments; i++)
+    g_string_append_printf (s, "#EXTINF:1,\n%s-%u.ts\n", name, i);
+  g_string_append (s, "#EXT-X-ENDLIST\n");
+
+  return g_string_free (s, FALSE);
+}
+
+static void
+setup_server (gsize size, gulong fragment_usec, gulong latency_usec)
+{
+  static gboolean registered = FALSE;
+
+  if (!registered) {
+    fail_unless (gst_element_register (NULL, "hlstestsrc", GST_RANK_PRIMARY,
+            test_src_get_type ()));
+    registered = TRUE;
+  }
+
+  playlists = g_hash_table_new_full (g_str_hash, g_str_equal, NULL, g_free);
+  fragment_size = size;
+  expected = g_malloc (size);
+  fill_fragment (expected, size);
+  fragment_time = fragment_usec;
+  latency = latency_usec;
+  active_fragments = 0;
+  max_active_fragments = 0;
+  key_requests = 0;
+}
+
+static void
+teardown_server (void)
+{
+  g_hash_table_destroy (playlists);
+  playlists = NULL;
+  g_free (expected);
+  expected = NULL;
+}
+
+typedef struct
+{
+  guint buffers;
+  gsize bytes;
+  GstClockTime last_pts;
+  gint switches;
+  gint bitrate;
+} RunStats;
+
+static void
+handoff (GstElement * sink, GstBuffer * buffer, GstPad * pad,
+    RunStats * stats)
+{
+  /* fragments are pushed in playlist order */
+  if (stats->buffers > 0)
+    fail_unless (GST_BUFFER_PTS (buffer) > stats->last_pts);
+  stats->last_pts = GST_BUFFER_PTS (buffer);
+  stats->buffers++;
+  stats->bytes += gst_buffer_get_size (buffer);
+
+  /* the fragments were received intact */
+  fail_unless (gst_buffer_get_size (buffer) == fragment_size);
+  fail_unless (gst_buffer_memcmp (buffer, 0, expected, fragment_size) == 0);
+}
+
+static void
+run_pipeline (const gchar * demux_props, RunStats * stats)
+{
+  GstElement *pipeline, *sink;
+  GstBus *bus;
+  gchar *desc;
+  gboolean done = FALSE;
+
+  desc = g_strdup_printf ("hlstest://test/main.m3u8 ! "
+      "hlsdemux %s ! fakesink name=sink sync=false signal-handoffs=true",
+      demux_props);
+  pipeline = gst_parse_launch (desc, NULL);
+  g_free (desc);
+  fail_unless (pipeline != NULL);
+
+  sink = gst_bin_get_by_name (GST_BIN (pipeline), "sink");
+  g_signal_connect (sink, "handoff", G_CALLBACK (handoff), stats);
+  gst_object_unref (sink);
+
+  bus = gst_element_get_bus (pipeline);
+  fail_unless (gst_element_set_state (pipeline, GST_STATE_PLAYING) !=
+      GST_STATE_CHANGE_FAILURE);
+
+  while (!done) {
+    GstMessage *msg;
+
+    msg = gst_bus_timed_pop (bus, 10 * GST_SECOND);
+    fail_unless (msg != NULL, "timeout");
+
+    switch (GST_MESSAGE_TYPE (msg)) {
+      case GST_MESSAGE_EOS:
+        done = TRUE;
+        break;
+      case GST_MESSAGE_ERROR:
+        fail ("error: %" GST_PTR_FORMAT, msg);
+        break;
+      case GST_MESSAGE_ELEMENT:{
+        const GstStructure *s = gst_message_get_structure (msg);
+
+        if (gst_structure_has_name (s, "playlist")) {
+          gst_structure_get_int (s, "bitrate", &stats->bitrate);
+          stats->switches++;
+        }
+        break;
+      }
+      default:
+        break;
+    }
+    gst_message_unref (msg);
+  }
+
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+  gst_object_unref (bus);
+  gst_object_unref (pipeline);
+}
+
+GST_START_TEST (test_parallel_prefetch)
+{
+  RunStats stats = { 0, };
+
+  /* 32 kB fragments in 125ms per connection and 50ms per request */
+  setup_server (188 * 175, 125000, 50000);
+  g_hash_table_insert (playlists, "main.m3u8", make_media_playlist ("main",
+          8));
+
+  run_pipeline ("parallel-downloads=4 max-buffered-fragments=8", &stats);
+
+  fail_unless_equals_int (stats.buffers, 8);
+  /* the fragments were requested before the previous ones were done */
+  fail_unless (max_active_fragments > 1);
+  fail_unless (max_active_fragments <= 4);
+
+  teardown_server ();
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_single_download)
+{
+  RunStats stats = { 0, };
+
+  setup_server (188 * 175, 30000, 0);
+  g_hash_table_insert (playlists, "main.m3u8", make_media_playlist ("main",
+          6));
+
+  run_pipeline ("parallel-downloads=1", &stats);
+
+  fail_unless_equals_int (stats.buffers, 6);
+  fail_unless_equals_int (max_active_fragments, 1);
+
+  teardown_server ();
+}
+
+GST_END_TEST;
+
+static void
+add_variant_playlists (const gchar * first, const gchar * second)
+{
+  g_hash_table_insert (playlists, "main.m3u8",
+      g_strdup_printf ("#EXTM3U\n"
+          "#EXT-X-STREAM-INF:PROGRAM-ID=1,BANDWIDTH=%s\n%s.m3u8\n"
+          "#EXT-X-STREAM-INF:PROGRAM-ID=1,BANDWIDTH=%s\n%s.m3u8\n",
+          strcmp (first, "low") ? "2000000" : "200000", first,
+          strcmp (second, "low") ? "2000000" : "200000", second));
+  g_hash_table_insert (playlists, "low.m3u8", make_media_playlist ("low", 8));
+  g_hash_table_insert (playlists, "high.m3u8", make_media_playlist ("high",
+          8));
+}
+
+GST_START_TEST (test_switch_up)
+{
+  RunStats stats = { 0, };
+
+  /* Each fragment is enough to estimate the bandwidth, at most 12 Mbit/s
+   * when a 600 kbit fragment takes 50ms. The first estimate is made while
+   * caching, where going up is allowed, and a loaded machine would need to
+   * make the downloads almost 5 times slower to stay below the 2 Mbit/s variant */
+  setup_server (188 * 400, 50000, 0);
+  add_variant_playlists ("low", "high");
+
+  run_pipeline ("parallel-downloads=1", &stats);
+
+  fail_unless_equals_int (stats.buffers, 8);
+  /* one switch up and no switching back and forth */
+  fail_unless_equals_int (stats.switches, 1);
+  fail_unless_equals_int (stats.bitrate, 2000000);
+
+  teardown_server ();
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_switch_down)
+{
+  RunStats stats = { 0, };
+
+  /* 2 downloads of 600 kbit in 800ms are at most 1.5 Mbit/s, too slow for
+   * 2 Mbit/s whatever the load on the machine. There is no lower variant to
+   * switch to after the first switch */
+  setup_server (188 * 400, 800000, 0);
+  add_variant_playlists ("high", "low");
+
+  run_pipeline ("parallel-downloads=2", &stats);
+
+  fail_unless_equals_int (stats.buffers, 8);
+  fail_unless_equals_int (stats.switches, 1);
+  fail_unless_equals_int (stats.bitrate, 200000);
+
+  teardown_server ();
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_stay_low)
+{
+  RunStats stats = { 0, };
+
+  /* the same upper bound as test_switch_down */
+  setup_server (188 * 400, 800000, 0);
+  add_variant_playlists ("low", "high");
+
+  run_pipeline ("parallel-downloads=2", &stats);
+
+  fail_unless_equals_int (stats.buffers, 8);
+  fail_unless_equals_int (stats.switches, 0);
+
+  teardown_server ();
+}
+
+GST_END_TEST;
+
+#ifdef HAVE_NETTLE
+GST_START_TEST (test_encrypted)
+{
+  RunStats stats = { 0, };
+  GString *s;
+  guint i;
+
+  /* the fragments don't end on a block boundary, nor do the buffers */
+  setup_server (188 * 175, 30000, 0);
+
+  s = g_string_new ("#EXTM3U\n#EXT-X-TARGETDURATION:1\n"
+      "#EXT-X-MEDIA-SEQUENCE:0\n#EXT-X-KEY:METHOD=AES-128,URI=\"k1.key\","
+      "IV=0x000102030405060708090a0b0c0d0e0f\n");
+  for (i = 0; i < 4; i++)
+    g_string_append_printf (s, "#EXTINF:1,\nenc1-%u.ts\n", i);
+  g_string_append (s, "#EXT-X-KEY:METHOD=AES-128,URI=\"k2.key\"\n");
+  for (; i < 8; i++)
+    g_string_append_printf (s, "#EXTINF:1,\nenc2-%u.ts\n", i);
+  g_string_append (s, "#EXT-X-ENDLIST\n");
+  g_hash_table_insert (playlists, "main.m3u8", g_string_free (s, FALSE));
+
+  run_pipeline ("parallel-downloads=1", &stats);
+
+  fail_unless_equals_int (stats.buffers, 8);
+  fail_unless_equals_int (stats.bytes, 8 * fragment_size);
+  /* each key was fetched once */
+  fail_unless_equals_int (key_requests, 2);
+
+  teardown_server ();
+}
+
+GST_END_TEST;
+#endif
+
+static Suite *
+hlsdemux_suite (void)
+{
+  Suite *s = suite_create ("hlsdemux");
+  TCase *tc_chain = tcase_create ("general");
+
+  suite_add_tcase (s, tc_chain);
+  tcase_set_timeout (tc_chain, 60);
+
+  tcase_add_test (tc_chain, test_parallel_prefetch);
+  tcase_add_test (tc_chain, test_single_download);
+  tcase_add_test (tc_chain, test_switch_up);
+  tcase_add_test (tc_chain, test_switch_down);
+  tcase_add_test (tc_chain, test_stay_low);
+#ifdef HAVE_NETTLE
+  tcase_add_test (tc_chain, test_encrypted);
+#endif
+
+  return s;
+}
+
+GST_CHECK_MAIN (hlsdemux);
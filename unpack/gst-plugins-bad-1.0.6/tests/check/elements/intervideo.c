@@ -0,0 +1,142 @@
+/* GStreamer unit test for the video frame ring of the inter elements
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#include <gst/check/gstcheck.h>
+
+#include "gstintersurface.h"
+
+/* pushes n frames, frame i is displayed at i * 10ms */
+static void
+push_frames (GstInterSurface * surface, guint first, guint n)
+{
+  guint i;
+
+  for (i = first; i < first + n; i++) {
+    GstBuffer *buffer = gst_buffer_new ();
+
+    GST_BUFFER_OFFSET (buffer) = i;
+    gst_inter_surface_push_video (surface, buffer, i * 10 * GST_MSECOND);
+    gst_buffer_unref (buffer);
+  }
+}
+
+static void
+check_frame (GstInterSurface * surface, GstClockTime time, guint offset)
+{
+  GstBuffer *buffer;
+  guint64 seqnum = 0;
+
+  buffer = gst_inter_surface_get_video (surface, time, &seqnum);
+  fail_unless (buffer != NULL);
+  fail_unless_equals_uint64 (GST_BUFFER_OFFSET (buffer), offset);
+  /* the frame numbers start from 1 */
+  fail_unless_equals_uint64 (seqnum, offset + 1);
+  gst_buffer_unref (buffer);
+}
+
+GST_START_TEST (test_select_by_time)
+{
+  GstInterSurface *surface;
+
+  surface = gst_inter_surface_get ("test_select_by_time");
+  fail_unless (gst_inter_surface_get_video (surface, 0, NULL) == NULL);
+
+  push_frames (surface, 0, 4);
+  check_frame (surface, 0, 0);
+  check_frame (surface, 15 * GST_MSECOND, 1);
+  check_frame (surface, 20 * GST_MSECOND, 2);
+  check_frame (surface, GST_SECOND, 3);
+  check_frame (surface, GST_CLOCK_TIME_NONE, 3);
+
+  gst_inter_surface_clear_video (surface);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_ring)
+{
+  GstInterSurface *surface;
+  GstBuffer *buffer;
+
+  surface = gst_inter_surface_get ("test_ring");
+
+  /* only the last frames are kept, earlier times get the oldest one */
+  push_frames (surface, 0, GST_INTER_SURFACE_VIDEO_SLOTS + 3);
+  check_frame (surface, 0, 3);
+  check_frame (surface, 45 * GST_MSECOND, 4);
+  check_frame (surface, GST_CLOCK_TIME_NONE,
+      GST_INTER_SURFACE_VIDEO_SLOTS + 2);
+
+  /* the frame numbers continue after clearing */
+  gst_inter_surface_clear_video (surface);
+  fail_unless (gst_inter_surface_get_video (surface, GST_CLOCK_TIME_NONE,
+          NULL) == NULL);
+  buffer = gst_buffer_new ();
+  GST_BUFFER_OFFSET (buffer) = GST_INTER_SURFACE_VIDEO_SLOTS + 3;
+  gst_inter_surface_push_video (surface, buffer, GST_CLOCK_TIME_NONE);
+  gst_buffer_unref (buffer);
+
+  /* a frame without time matches any time */
+  check_frame (surface, 0, GST_INTER_SURFACE_VIDEO_SLOTS + 3);
+
+  gst_inter_surface_clear_video (surface);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_shared_frames)
+{
+  GstInterSurface *surface;
+  GstBuffer *buffer, *a, *b;
+
+  surface = gst_inter_surface_get ("test_shared_frames");
+
+  buffer = gst_buffer_new ();
+  gst_inter_surface_push_video (surface, buffer, 0);
+
+  /* all readers get the same buffer, without a copy */
+  a = gst_inter_surface_get_video (surface, 0, NULL);
+  b = gst_inter_surface_get_video (surface, 0, NULL);
+  fail_unless (a == buffer);
+  fail_unless (b == buffer);
+  ASSERT_MINI_OBJECT_REFCOUNT (buffer, "buffer", 4);
+  gst_buffer_unref (a);
+  gst_buffer_unref (b);
+
+  gst_inter_surface_clear_video (surface);
+  ASSERT_MINI_OBJECT_REFCOUNT (buffer, "buffer", 1);
+  gst_buffer_unref (buffer);
+}
+
+GST_END_TEST;
+
+static Suite *
+intervideo_suite (void)
+{
+  Suite *s = suite_create ("intervideo");
+  TCase *tc_chain = tcase_create ("general");
+
+  suite_add_tcase (s, tc_chain);
+  tcase_add_test (tc_chain, test_select_by_time);
+  tcase_add_test (tc_chain, test_ring);
+  tcase_add_test (tc_chain, test_shared_frames);
+
+  return s;
+}
+
+GST_CHECK_MAIN (intervideo);
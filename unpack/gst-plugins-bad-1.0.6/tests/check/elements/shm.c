@@ -0,0 +1,323 @@
+/* GStreamer unit test for shmsink and shmsrc
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#include <string.h>
+#include <unistd.h>
+
+#include <gst/check/gstcheck.h>
+
+/* The buffers pushed in shmsink come out of shmsrc in the same process. On
+ * Linux the client gets the shared memory area as a memfd passed over the
+ * control socket, elsewhere it opens the named segment */
+
+#define BUFFER_SIZE 4096
+#define NUM_BUFFERS 4
+
+static GstPad *mysrcpad, *mysinkpad;
+
+static GstStaticPadTemplate sinktemplate = GST_STATIC_PAD_TEMPLATE ("sink",
+    GST_PAD_SINK,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS_ANY);
+static GstStaticPadTemplate srctemplate = GST_STATIC_PAD_TEMPLATE ("src",
+    GST_PAD_SRC,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS_ANY);
+
+/* what came out of shmsrc besides the buffers, protected by check_mutex */
+static gboolean have_eos;
+static GstStructure *custom;
+
+static gboolean
+test_sink_event (GstPad * pad, GstObject * parent, GstEvent * event)
+{
+  switch (GST_EVENT_TYPE (event)) {
+    case GST_EVENT_EOS:
+      g_mutex_lock (&check_mutex);
+      have_eos = TRUE;
+      g_cond_signal (&check_cond);
+      g_mutex_unlock (&check_mutex);
+      break;
+    case GST_EVENT_CUSTOM_DOWNSTREAM:
+      g_mutex_lock (&check_mutex);
+      if (custom)
+        gst_structure_free (custom);
+      custom = gst_structure_copy (gst_event_get_structure (event));
+      g_mutex_unlock (&check_mutex);
+      break;
+    default:
+      break;
+  }
+
+  /* accept everything, the caps stay on the pad */
+  gst_event_unref (event);
+  return TRUE;
+}
+
+static void
+setup_shm (gboolean forward_events, GstElement ** sink, GstElement ** src)
+{
+  gchar *path;
+
+  have_eos = FALSE;
+  custom = NULL;
+
+  /* the sink creates the socket and the shared memory area when started */
+  *sink = gst_check_setup_element ("shmsink");
+  path = g_strdup_printf ("%s/shm-test-%d", g_get_tmp_dir (), getpid ());
+  g_object_set (*sink, "socket-path", path, "shm-size", 16 * BUFFER_SIZE,
+      "wait-for-connection", TRUE, "forward-events", forward_events,
+      "sync", FALSE, "async", FALSE, NULL);
+  g_free (path);
+  mysrcpad = gst_check_setup_src_pad (*sink, &srctemplate);
+  gst_pad_set_active (mysrcpad, TRUE);
+  fail_unless (gst_element_set_state (*sink, GST_STATE_PLAYING) ==
+      GST_STATE_CHANGE_SUCCESS);
+
+  /* the sink made the path unique */
+  g_object_get (*sink, "socket-path", &path, NULL);
+  *src = gst_check_setup_element ("shmsrc");
+  g_object_set (*src, "socket-path", path, NULL);
+  g_free (path);
+  mysinkpad = gst_check_setup_sink_pad (*src, &sinktemplate);
+  gst_pad_set_event_function (mysinkpad, test_sink_event);
+  gst_pad_set_active (mysinkpad, TRUE);
+  fail_unless (gst_element_set_state (*src, GST_STATE_PLAYING) !=
+      GST_STATE_CHANGE_FAILURE);
+}
+
+static void
+cleanup_shm (GstElement * sink, GstElement * src)
+{
+  gst_check_drop_buffers ();
+
+  /* the source first, it releases the blocks the sink waits for */
+  fail_unless (gst_element_set_state (src, GST_STATE_NULL) ==
+      GST_STATE_CHANGE_SUCCESS);
+  gst_pad_set_active (mysinkpad, FALSE);
+  gst_check_teardown_sink_pad (src);
+  gst_check_teardown_element (src);
+
+  fail_unless (gst_element_set_state (sink, GST_STATE_NULL) ==
+      GST_STATE_CHANGE_SUCCESS);
+  gst_pad_set_active (mysrcpad, FALSE);
+  gst_check_teardown_src_pad (sink);
+  gst_check_teardown_element (sink);
+
+  if (custom)
+    gst_structure_free (custom);
+  custom = NULL;
+}
+
+static GstCaps *
+push_stream_start (void)
+{
+  GstSegment segment;
+  GstCaps *caps;
+
+  caps = gst_caps_new_simple ("application/x-test",
+      "rate", G_TYPE_INT, 1234, "name", G_TYPE_STRING, "shm", NULL);
+  gst_pad_push_event (mysrcpad, gst_event_new_stream_start ("test"));
+  fail_unless (gst_pad_set_caps (mysrcpad, caps));
+  gst_segment_init (&segment, GST_FORMAT_TIME);
+  gst_pad_push_event (mysrcpad, gst_event_new_segment (&segment));
+
+  return caps;
+}
+
+/* fills the buffer @index of the stream, writing it through @allocator */
+static GstBuffer *
+create_buffer (GstAllocator * allocator, guint index)
+{
+  GstBuffer *buffer;
+  GstMapInfo map;
+  guint i;
+
+  buffer = gst_buffer_new_allocate (allocator, BUFFER_SIZE, NULL);
+  fail_unless (buffer != NULL);
+  gst_buffer_map (buffer, &map, GST_MAP_WRITE);
+  for (i = 0; i < BUFFER_SIZE; i++)
+    map.data[i] = (index * 31 + i) & 0xff;
+  gst_buffer_unmap (buffer, &map);
+  GST_BUFFER_TIMESTAMP (buffer) = index * GST_SECOND;
+
+  return buffer;
+}
+
+static void
+check_buffers (guint n_buffers)
+{
+  GstBuffer *expected;
+  GList *node;
+  guint i;
+
+  g_mutex_lock (&check_mutex);
+  while (g_list_length (buffers) < n_buffers)
+    g_cond_wait (&check_cond, &check_mutex);
+  g_mutex_unlock (&check_mutex);
+
+  fail_unless_equals_int (g_list_length (buffers), n_buffers);
+  for (node = buffers, i = 0; node; node = node->next, i++) {
+    GstMapInfo map;
+
+    expected = create_buffer (NULL, i);
+    gst_buffer_map (expected, &map, GST_MAP_READ);
+    gst_check_buffer_data (node->data, map.data, map.size);
+    gst_buffer_unmap (expected, &map);
+    gst_buffer_unref (expected);
+  }
+
+  /* release the blocks so that the sink doesn't wait for them at EOS */
+  gst_check_drop_buffers ();
+}
+
+static void
+wait_for_eos (void)
+{
+  g_mutex_lock (&check_mutex);
+  while (!have_eos)
+    g_cond_wait (&check_cond, &check_mutex);
+  g_mutex_unlock (&check_mutex);
+}
+
+GST_START_TEST (test_shm_forward_events)
+{
+  GstElement *sink, *src;
+  GstCaps *caps, *received;
+  GstStructure *s;
+  gint value;
+  guint i;
+
+  setup_shm (TRUE, &sink, &src);
+  caps = push_stream_start ();
+
+  /* buffers in normal memory are copied into the area */
+  for (i = 0; i < NUM_BUFFERS; i++)
+    fail_unless (gst_pad_push (mysrcpad, create_buffer (NULL,
+                i)) == GST_FLOW_OK);
+  check_buffers (NUM_BUFFERS);
+
+  /* the caps were sent ahead of the first buffer */
+  received = gst_pad_get_current_caps (mysinkpad);
+  fail_unless (received != NULL);
+  fail_unless (gst_caps_is_equal (received, caps));
+  gst_caps_unref (received);
+
+  s = gst_structure_new ("test-event", "value", G_TYPE_INT, 42, NULL);
+  fail_unless (gst_pad_push_event (mysrcpad,
+          gst_event_new_custom (GST_EVENT_CUSTOM_DOWNSTREAM, s)));
+  fail_unless (gst_pad_push_event (mysrcpad, gst_event_new_eos ()));
+  wait_for_eos ();
+
+  /* the custom event came out before the EOS */
+  g_mutex_lock (&check_mutex);
+  fail_unless (custom != NULL);
+  fail_unless (gst_structure_has_name (custom, "test-event"));
+  fail_unless (gst_structure_get_int (custom, "value", &value));
+  fail_unless_equals_int (value, 42);
+  g_mutex_unlock (&check_mutex);
+
+  gst_caps_unref (caps);
+  cleanup_shm (sink, src);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_shm_allocator)
+{
+  GstElement *sink, *src;
+  GstAllocator *allocator = NULL;
+  GstAllocationParams params;
+  GstBuffer *buffer;
+  GstQuery *query;
+  GstCaps *caps;
+  guint i;
+
+  setup_shm (TRUE, &sink, &src);
+  caps = push_stream_start ();
+
+  query = gst_query_new_allocation (caps, TRUE);
+  fail_unless (gst_pad_peer_query (mysrcpad, query));
+  fail_unless (gst_query_get_n_allocation_params (query) > 0);
+  gst_query_parse_nth_allocation_param (query, 0, &allocator, &params);
+  gst_query_unref (query);
+  fail_unless (allocator != NULL);
+
+  /* the data is written in the shared memory area and sent as it is, the
+   * last buffer is in normal memory and copied */
+  for (i = 0; i < NUM_BUFFERS; i++) {
+    if (i < NUM_BUFFERS - 1) {
+      buffer = create_buffer (allocator, i);
+      fail_unless (gst_memory_is_type (gst_buffer_peek_memory (buffer, 0),
+              "ShmSinkMemory"));
+    } else {
+      buffer = create_buffer (NULL, i);
+    }
+    fail_unless (gst_pad_push (mysrcpad, buffer) == GST_FLOW_OK);
+  }
+  check_buffers (NUM_BUFFERS);
+
+  fail_unless (gst_pad_push_event (mysrcpad, gst_event_new_eos ()));
+  wait_for_eos ();
+
+  gst_object_unref (allocator);
+  gst_caps_unref (caps);
+  cleanup_shm (sink, src);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_shm_no_forward)
+{
+  GstElement *sink, *src;
+  GstCaps *caps, *received;
+  guint i;
+
+  setup_shm (FALSE, &sink, &src);
+  caps = push_stream_start ();
+
+  for (i = 0; i < NUM_BUFFERS; i++)
+    fail_unless (gst_pad_push (mysrcpad, create_buffer (NULL,
+                i)) == GST_FLOW_OK);
+  check_buffers (NUM_BUFFERS);
+
+  /* only the data was sent */
+  received = gst_pad_get_current_caps (mysinkpad);
+  fail_unless (received == NULL);
+
+  gst_caps_unref (caps);
+  cleanup_shm (sink, src);
+}
+
+GST_END_TEST;
+
+static Suite *
+shm_suite (void)
+{
+  Suite *s = suite_create ("shm");
+  TCase *tc_chain = tcase_create ("general");
+
+  suite_add_tcase (s, tc_chain);
+  tcase_add_test (tc_chain, test_shm_forward_events);
+  tcase_add_test (tc_chain, test_shm_allocator);
+  tcase_add_test (tc_chain, test_shm_no_forward);
+
+  return s;
+}
+
+GST_CHECK_MAIN (shm);
@@ -0,0 +1,109 @@
+/* GStreamer unit test for the shm control protocol
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#include <string.h>
+#include <unistd.h>
+
+#include <gst/check/gstcheck.h>
+
+#include "shmpipe.h"
+
+static ShmPipe *writer, *reader;
+static ShmClient *client;
+
+static void
+setup_pipe (void)
+{
+  gchar *path;
+  gchar *buf;
+
+  path = g_strdup_printf ("%s/shmpipe-test-%d", g_get_tmp_dir (), getpid ());
+  writer = sp_writer_create (path, 4096, 0600);
+  g_free (path);
+  fail_unless (writer != NULL);
+
+  reader = sp_client_open (sp_writer_get_path (writer));
+  fail_unless (reader != NULL);
+  client = sp_writer_accept_client (writer);
+  fail_unless (client != NULL);
+
+  /* the first command received is the shm area */
+  fail_unless_equals_int (sp_client_recv (reader, &buf, NULL), 0);
+}
+
+static void
+teardown_pipe (void)
+{
+  sp_writer_close_client (writer, client);
+  sp_close (reader);
+  sp_close (writer);
+}
+
+/* sends @size bytes with @flags and checks what the client receives */
+static void
+send_and_check (ShmBlock * block, gsize size, guint flags)
+{
+  gchar *buf, *rbuf = NULL;
+  guint rflags = 0xdeadbeef;
+
+  buf = sp_writer_block_get_buf (block);
+  memset (buf, flags & 0xff, size);
+  fail_unless_equals_int (sp_writer_send_buf (writer, buf, size, 0, flags), 1);
+
+  fail_unless_equals_int (sp_client_recv (reader, &rbuf, &rflags), size);
+  fail_unless_equals_int (rflags, flags);
+  fail_unless (memcmp (rbuf, buf, size) == 0);
+
+  fail_unless (sp_client_recv_finish (reader, rbuf));
+  fail_unless_equals_int (sp_writer_recv (writer, client), 0);
+  fail_if (sp_writer_block_is_pending (block));
+}
+
+GST_START_TEST (test_buffer_flags)
+{
+  ShmBlock *block;
+
+  setup_pipe ();
+  block = sp_writer_alloc_block (writer, 256);
+  fail_unless (block != NULL);
+
+  /* data buffers have no flags, the flags of events are received as is */
+  send_and_check (block, 256, 0);
+  send_and_check (block, 100, SHM_BUFFER_FLAG_EVENT);
+  send_and_check (block, 1, 0);
+  fail_unless (sp_writer_get_pending_buffers (writer) == NULL);
+
+  sp_writer_free_block (block);
+  teardown_pipe ();
+}
+
+GST_END_TEST;
+
+static Suite *
+shmpipe_suite (void)
+{
+  Suite *s = suite_create ("shmpipe");
+  TCase *tc_chain = tcase_create ("general");
+
+  suite_add_tcase (s, tc_chain);
+  tcase_add_test (tc_chain, test_buffer_flags);
+
+  return s;
+}
+
+GST_CHECK_MAIN (shmpipe);
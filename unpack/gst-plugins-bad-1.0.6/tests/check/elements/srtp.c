@@ -0,0 +1,447 @@
+/* GStreamer unit test for the srtpenc and srtpdec elements
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#include <string.h>
+
+#include <gst/check/gstcheck.h>
+
+#define KEY_LEN 30
+#define PAYLOAD_LEN 160
+#define SSRC 0x12345678
+
+static GstStaticPadTemplate sinktemplate = GST_STATIC_PAD_TEMPLATE ("sink",
+    GST_PAD_SINK,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS_ANY);
+
+static GstStaticPadTemplate srctemplate = GST_STATIC_PAD_TEMPLATE ("src",
+    GST_PAD_SRC,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS_ANY);
+
+static GstBuffer *
+make_key (guint8 first)
+{
+  guint8 *data;
+  guint i;
+
+  data = g_malloc (KEY_LEN);
+  for (i = 0; i < KEY_LEN; i++)
+    data[i] = first + i;
+
+  return gst_buffer_new_wrapped (data, KEY_LEN);
+}
+
+static GstBuffer *
+make_rtp (guint16 seq, guint32 ssrc)
+{
+  guint8 *data;
+  guint i;
+
+  data = g_malloc (12 + PAYLOAD_LEN);
+  data[0] = 0x80;
+  data[1] = 96;
+  GST_WRITE_UINT16_BE (data + 2, seq);
+  GST_WRITE_UINT32_BE (data + 4, seq * 160);
+  GST_WRITE_UINT32_BE (data + 8, ssrc);
+  for (i = 0; i < PAYLOAD_LEN; i++)
+    data[12 + i] = (seq + i) & 0xff;
+
+  return gst_buffer_new_wrapped (data, 12 + PAYLOAD_LEN);
+}
+
+/* a receiver report followed by an SDES packet with a CNAME */
+static GstBuffer *
+make_rtcp (guint32 ssrc)
+{
+  static const guint8 sdes[] = { 0x81, 202, 0x00, 0x03, 0, 0, 0, 0,
+    1, 4, 't', 'e', 's', 't', 0, 0
+  };
+  guint8 *data;
+
+  data = g_malloc (8 + sizeof (sdes));
+  data[0] = 0x80;
+  data[1] = 201;
+  GST_WRITE_UINT16_BE (data + 2, 1);
+  GST_WRITE_UINT32_BE (data + 4, ssrc);
+  memcpy (data + 8, sdes, sizeof (sdes));
+  GST_WRITE_UINT32_BE (data + 12, ssrc);
+
+  return gst_buffer_new_wrapped (data, 8 + sizeof (sdes));
+}
+
+static gboolean
+buffer_equal (GstBuffer * a, GstBuffer * b)
+{
+  GstMapInfo map;
+  gboolean res;
+
+  gst_buffer_map (b, &map, GST_MAP_READ);
+  res = gst_buffer_get_size (a) == map.size &&
+      gst_buffer_memcmp (a, 0, map.data, map.size) == 0;
+  gst_buffer_unmap (b, &map);
+
+  return res;
+}
+
+typedef struct
+{
+  guint64 auth_failures;
+  guint64 replayed;
+} Stats;
+
+/* push @input through a new element @name with @key and return the output,
+ * the statistics of srtpdec are stored in @stats when it is not %NULL */
+static GList *
+run_element (const gchar * name, GstBuffer * key, const gchar * auth,
+    GList * input, Stats * stats)
+{
+  GstElement *elem;
+  GstPad *srcpad, *sinkpad;
+  GstSegment segment;
+  GList *walk, *output;
+
+  elem = gst_check_setup_element (name);
+  if (key)
+    g_object_set (elem, "key", key, NULL);
+  if (auth)
+    gst_util_set_object_arg (G_OBJECT (elem), "rtp-auth", auth);
+
+  srcpad = gst_check_setup_src_pad (elem, &srctemplate);
+  sinkpad = gst_check_setup_sink_pad (elem, &sinktemplate);
+  gst_pad_set_active (srcpad, TRUE);
+  gst_pad_set_active (sinkpad, TRUE);
+  fail_unless_equals_int (gst_element_set_state (elem, GST_STATE_PLAYING),
+      GST_STATE_CHANGE_SUCCESS);
+
+  fail_unless (gst_pad_push_event (srcpad,
+          gst_event_new_stream_start ("srtp")));
+  gst_segment_init (&segment, GST_FORMAT_TIME);
+  fail_unless (gst_pad_push_event (srcpad, gst_event_new_segment (&segment)));
+
+  for (walk = input; walk; walk = walk->next)
+    fail_unless_equals_int (gst_pad_push (srcpad, walk->data), GST_FLOW_OK);
+  g_list_free (input);
+
+  output = buffers;
+  buffers = NULL;
+
+  if (stats)
+    g_object_get (elem, "auth-failures", &stats->auth_failures,
+        "replayed", &stats->replayed, NULL);
+
+  gst_element_set_state (elem, GST_STATE_NULL);
+  gst_pad_set_active (srcpad, FALSE);
+  gst_pad_set_active (sinkpad, FALSE);
+  gst_check_teardown_src_pad (elem);
+  gst_check_teardown_sink_pad (elem);
+  gst_check_teardown_element (elem);
+
+  return output;
+}
+
+static void
+free_buffers (GList * list)
+{
+  g_list_foreach (list, (GFunc) gst_mini_object_unref, NULL);
+  g_list_free (list);
+}
+
+static GList *
+make_rtp_list (guint16 first, guint n, guint32 ssrc)
+{
+  GList *list = NULL;
+  guint i;
+
+  for (i = 0; i < n; i++)
+    list = g_list_append (list, make_rtp (first + i, ssrc));
+
+  return list;
+}
+
+static void
+check_rtp_list (GList * list, guint16 first, guint n, guint32 ssrc)
+{
+  guint i;
+
+  fail_unless_equals_int (g_list_length (list), n);
+  for (i = 0; i < n; i++, list = list->next) {
+    GstBuffer *expected = make_rtp (first + i, ssrc);
+
+    fail_unless (buffer_equal (list->data, expected));
+    gst_buffer_unref (expected);
+  }
+}
+
+static void
+run_roundtrip (const gchar * auth, guint tag_len)
+{
+  GstBuffer *key = make_key (0);
+  GList *protected, *walk, *output;
+  guint16 seq = 1000;
+
+  protected = run_element ("srtpenc", key, auth,
+      make_rtp_list (seq, 20, SSRC), NULL);
+  fail_unless_equals_int (g_list_length (protected), 20);
+
+  for (walk = protected; walk; walk = walk->next, seq++) {
+    GstBuffer *plain = make_rtp (seq, SSRC);
+    GstMapInfo map;
+
+    fail_unless_equals_int (gst_buffer_get_size (walk->data),
+        12 + PAYLOAD_LEN + tag_len);
+    /* the header stays in the clear, the payload does not */
+    gst_buffer_map (plain, &map, GST_MAP_READ);
+    fail_unless (gst_buffer_memcmp (walk->data, 0, map.data, 12) == 0);
+    fail_if (gst_buffer_memcmp (walk->data, 12, map.data + 12,
+            PAYLOAD_LEN) == 0);
+    gst_buffer_unmap (plain, &map);
+    gst_buffer_unref (plain);
+  }
+
+  output = run_element ("srtpdec", key, auth, protected, NULL);
+  check_rtp_list (output, 1000, 20, SSRC);
+  free_buffers (output);
+
+  gst_buffer_unref (key);
+}
+
+GST_START_TEST (test_rtp_roundtrip)
+{
+  run_roundtrip (NULL, 10);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_rtp_roundtrip_32)
+{
+  run_roundtrip ("hmac-sha1-32", 4);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_rtcp_roundtrip)
+{
+  GstBuffer *key = make_key (0);
+  GstBuffer *expected;
+  GList *protected, *output = NULL;
+  GstMapInfo map;
+
+  protected = run_element ("srtpenc", key, NULL,
+      g_list_append (NULL, make_rtcp (SSRC)), NULL);
+  fail_unless_equals_int (g_list_length (protected), 1);
+
+  /* SRTCP index with the E flag and an 80 bits tag */
+  gst_buffer_map (protected->data, &map, GST_MAP_READ);
+  fail_unless_equals_int (map.size, 24 + 4 + 10);
+  fail_unless_equals_int (map.data[1], 201);
+  fail_unless_equals_int (GST_READ_UINT32_BE (map.data + 24), 0x80000000);
+  gst_buffer_unmap (protected->data, &map);
+
+  output = run_element ("srtpdec", key, NULL, protected, NULL);
+  fail_unless_equals_int (g_list_length (output), 1);
+  expected = make_rtcp (SSRC);
+  fail_unless (buffer_equal (output->data, expected));
+  gst_buffer_unref (expected);
+  free_buffers (output);
+
+  gst_buffer_unref (key);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_rollover)
+{
+  GstBuffer *key = make_key (0);
+  GList *protected, *output;
+
+  /* the rollover counter of both sides goes to 1 after seq 65535 */
+  protected = run_element ("srtpenc", key, NULL,
+      make_rtp_list (65530, 12, SSRC), NULL);
+  output = run_element ("srtpdec", key, NULL, protected, NULL);
+  check_rtp_list (output, 65530, 12, SSRC);
+  free_buffers (output);
+
+  gst_buffer_unref (key);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_auth_failure)
+{
+  GstBuffer *key = make_key (0);
+  GstBuffer *other_key = make_key (1);
+  GList *protected, *output;
+  GstMapInfo map;
+  Stats stats;
+
+  protected = run_element ("srtpenc", key, NULL,
+      make_rtp_list (0, 5, SSRC), NULL);
+
+  /* flip one bit in the payload of the third packet */
+  protected->next->next->data =
+      gst_buffer_make_writable (protected->next->next->data);
+  gst_buffer_map (protected->next->next->data, &map, GST_MAP_READWRITE);
+  map.data[20] ^= 0x01;
+  gst_buffer_unmap (protected->next->next->data, &map);
+
+  output = run_element ("srtpdec", key, NULL, protected, &stats);
+  fail_unless_equals_int (g_list_length (output), 4);
+  fail_unless_equals_uint64 (stats.auth_failures, 1);
+  fail_unless_equals_uint64 (stats.replayed, 0);
+  free_buffers (output);
+
+  /* a different key does not authenticate anything */
+  protected = run_element ("srtpenc", key, NULL,
+      make_rtp_list (0, 5, SSRC), NULL);
+  output = run_element ("srtpdec", other_key, NULL, protected, &stats);
+  fail_unless (output == NULL);
+  fail_unless_equals_uint64 (stats.auth_failures, 5);
+
+  gst_buffer_unref (key);
+  gst_buffer_unref (other_key);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_replay)
+{
+  GstBuffer *key = make_key (0);
+  GList *protected, *old, *input, *output;
+  Stats stats;
+
+  old = run_element ("srtpenc", key, NULL, make_rtp_list (0, 1, SSRC), NULL);
+  gst_buffer_unref (key);
+
+  /* same key and SSRC in a new context, as an attacker would record it */
+  key = make_key (0);
+  protected = run_element ("srtpenc", key, NULL,
+      make_rtp_list (0, 100, SSRC), NULL);
+
+  /* packet 50 twice, then the old packet 0 outside of the window */
+  input = g_list_append (protected,
+      gst_buffer_copy (g_list_nth_data (protected, 50)));
+  input = g_list_concat (input, old);
+
+  output = run_element ("srtpdec", key, NULL, input, &stats);
+  check_rtp_list (output, 0, 100, SSRC);
+  fail_unless_equals_uint64 (stats.replayed, 2);
+  fail_unless_equals_uint64 (stats.auth_failures, 0);
+  free_buffers (output);
+
+  gst_buffer_unref (key);
+}
+
+GST_END_TEST;
+
+static GstBuffer *
+request_key (GstElement * element, guint ssrc, gpointer user_data)
+{
+  /* one key per SSRC, nothing for the others */
+  if (ssrc == SSRC)
+    return make_key (0);
+  if (ssrc == SSRC + 1)
+    return make_key (100);
+  return NULL;
+}
+
+GST_START_TEST (test_key_per_ssrc)
+{
+  GstElement *enc, *dec;
+  GstPad *srcpad, *sinkpad;
+  GstSegment segment;
+  GstBuffer *expected;
+  guint64 auth_failures;
+  guint i;
+
+  enc = gst_check_setup_element ("srtpenc");
+  dec = gst_check_setup_element ("srtpdec");
+  g_signal_connect (enc, "request-key", (GCallback) request_key, NULL);
+  g_signal_connect (dec, "request-key", (GCallback) request_key, NULL);
+
+  srcpad = gst_check_setup_src_pad (enc, &srctemplate);
+  sinkpad = gst_check_setup_sink_pad (dec, &sinktemplate);
+  {
+    GstPad *encsrc = gst_element_get_static_pad (enc, "src");
+    GstPad *decsink = gst_element_get_static_pad (dec, "sink");
+
+    fail_unless_equals_int (gst_pad_link (encsrc, decsink), GST_PAD_LINK_OK);
+    gst_object_unref (encsrc);
+    gst_object_unref (decsink);
+  }
+  gst_pad_set_active (srcpad, TRUE);
+  gst_pad_set_active (sinkpad, TRUE);
+  gst_element_set_state (enc, GST_STATE_PLAYING);
+  gst_element_set_state (dec, GST_STATE_PLAYING);
+
+  fail_unless (gst_pad_push_event (srcpad,
+          gst_event_new_stream_start ("srtp")));
+  gst_segment_init (&segment, GST_FORMAT_TIME);
+  fail_unless (gst_pad_push_event (srcpad, gst_event_new_segment (&segment)));
+
+  /* interleave two SSRCs with their own key */
+  for (i = 0; i < 10; i++) {
+    fail_unless_equals_int (gst_pad_push (srcpad, make_rtp (i, SSRC)),
+        GST_FLOW_OK);
+    fail_unless_equals_int (gst_pad_push (srcpad, make_rtp (i, SSRC + 1)),
+        GST_FLOW_OK);
+  }
+  fail_unless_equals_int (g_list_length (buffers), 20);
+  for (i = 0; i < 20; i++) {
+    expected = make_rtp (i / 2, i % 2 ? SSRC + 1 : SSRC);
+    fail_unless (buffer_equal (g_list_nth_data (buffers, i), expected));
+    gst_buffer_unref (expected);
+  }
+  g_object_get (dec, "auth-failures", &auth_failures, NULL);
+  fail_unless_equals_uint64 (auth_failures, 0);
+
+  /* no key for this SSRC, the encoder errors out */
+  fail_unless_equals_int (gst_pad_push (srcpad, make_rtp (0, SSRC + 2)),
+      GST_FLOW_ERROR);
+
+  gst_element_set_state (enc, GST_STATE_NULL);
+  gst_element_set_state (dec, GST_STATE_NULL);
+  gst_pad_set_active (srcpad, FALSE);
+  gst_pad_set_active (sinkpad, FALSE);
+  gst_check_teardown_src_pad (enc);
+  gst_check_teardown_sink_pad (dec);
+  gst_check_teardown_element (enc);
+  gst_check_teardown_element (dec);
+}
+
+GST_END_TEST;
+
+static Suite *
+srtp_suite (void)
+{
+  Suite *s = suite_create ("srtp");
+  TCase *tc_chain = tcase_create ("general");
+
+  suite_add_tcase (s, tc_chain);
+  tcase_add_test (tc_chain, test_rtp_roundtrip);
+  tcase_add_test (tc_chain, test_rtp_roundtrip_32);
+  tcase_add_test (tc_chain, test_rtcp_roundtrip);
+  tcase_add_test (tc_chain, test_rollover);
+  tcase_add_test (tc_chain, test_auth_failure);
+  tcase_add_test (tc_chain, test_replay);
+  tcase_add_test (tc_chain, test_key_per_ssrc);
+
+  return s;
+}
+
+GST_CHECK_MAIN (srtp);
@@ -0,0 +1,172 @@
+/* GStreamer unit test for the SRTP crypto of the srtp plugin, with the test
+ * vectors of RFC 3711 appendix B
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#include <string.h>
+
+#include <gst/check/gstcheck.h>
+
+#include "gstsrtp.h"
+
+static GstBuffer *
+make_master_key (const guint8 * key, const guint8 * salt)
+{
+  guint8 *data;
+
+  data = g_malloc (GST_SRTP_KEY_LEN);
+  memcpy (data, key, GST_SRTP_MASTER_KEY_LEN);
+  memcpy (data + GST_SRTP_MASTER_KEY_LEN, salt, GST_SRTP_MASTER_SALT_LEN);
+
+  return gst_buffer_new_wrapped (data, GST_SRTP_KEY_LEN);
+}
+
+/* B.2 AES-CM test vectors, the keystream is the encryption of a payload
+ * of zeroes with SSRC 0 and index 0 */
+GST_START_TEST (test_aes_cm_keystream)
+{
+  static const guint8 session_key[16] = {
+    0x2b, 0x7e, 0x15, 0x16, 0x28, 0xae, 0xd2, 0xa6,
+    0xab, 0xf7, 0x15, 0x88, 0x09, 0xcf, 0x4f, 0x3c
+  };
+  static const guint8 session_salt[14] = {
+    0xf0, 0xf1, 0xf2, 0xf3, 0xf4, 0xf5, 0xf6, 0xf7,
+    0xf8, 0xf9, 0xfa, 0xfb, 0xfc, 0xfd
+  };
+  static const struct
+  {
+    guint counter;
+    guint8 keystream[16];
+  } blocks[] = {
+    { 0x0000, { 0xe0, 0x3e, 0xad, 0x09, 0x35, 0xc9, 0x5e, 0x80,
+            0xe1, 0x66, 0xb1, 0x6d, 0xd9, 0x2b, 0x4e, 0xb4 } },
+    { 0x0001, { 0xd2, 0x35, 0x13, 0x16, 0x2b, 0x02, 0xd0, 0xf7,
+            0x2a, 0x43, 0xa2, 0xfe, 0x4a, 0x5f, 0x97, 0xab } },
+    { 0x0002, { 0x41, 0xe9, 0x5b, 0x3b, 0xb0, 0xa2, 0xe8, 0xdd,
+            0x47, 0x79, 0x01, 0xe4, 0xfc, 0xa8, 0x94, 0xc0 } },
+    { 0xfeff, { 0xec, 0x8c, 0xdf, 0x73, 0x98, 0x60, 0x7c, 0xb0,
+            0xf2, 0xd2, 0x16, 0x75, 0xea, 0x9e, 0xa1, 0xe4 } },
+    { 0xff00, { 0x36, 0x2b, 0x7c, 0x3c, 0x67, 0x73, 0x51, 0x63,
+            0x18, 0xa0, 0x77, 0xd7, 0xfc, 0x50, 0x73, 0xae } },
+    { 0xff01, { 0x6a, 0x2c, 0xc3, 0x78, 0x78, 0x89, 0x37, 0x4f,
+            0xbe, 0xb4, 0xc8, 0x1b, 0x17, 0xba, 0x6c, 0x44 } }
+  };
+  GstSrtpStream *stream;
+  GstBuffer *key;
+  guint8 tag[10];
+  guint8 *data;
+  gsize size;
+  guint i;
+
+  key = make_master_key (session_key, session_salt);
+  stream = gst_srtp_stream_new (0, key);
+  gst_buffer_unref (key);
+  fail_unless (stream != NULL);
+
+  /* use the session keys of the test vectors instead of derived ones */
+  aes_set_encrypt_key (&stream->rtp.aes, sizeof (session_key), session_key);
+  memcpy (stream->rtp.salt, session_salt, sizeof (session_salt));
+
+  /* an RTP header with sequence number 0 and SSRC 0, followed by enough
+   * zeroes for the last counter of the vectors */
+  size = 12 + (0xff01 + 1) * 16;
+  data = g_malloc0 (size);
+  data[0] = 0x80;
+  fail_unless_equals_int (gst_srtp_protect_rtp (stream, data, size, tag,
+          sizeof (tag)), GST_SRTP_OK);
+
+  for (i = 0; i < G_N_ELEMENTS (blocks); i++)
+    fail_unless (memcmp (data + 12 + blocks[i].counter * 16,
+            blocks[i].keystream, 16) == 0, "wrong keystream for counter %04x",
+        blocks[i].counter);
+
+  g_free (data);
+  gst_srtp_stream_free (stream);
+}
+
+GST_END_TEST;
+
+/* B.3 key derivation test vectors, with packet index 0 */
+GST_START_TEST (test_key_derivation)
+{
+  static const guint8 master_key[16] = {
+    0xe1, 0xf9, 0x7a, 0x0d, 0x3e, 0x01, 0x8b, 0xe0,
+    0xd6, 0x4f, 0xa3, 0x2c, 0x06, 0xde, 0x41, 0x39
+  };
+  static const guint8 master_salt[14] = {
+    0x0e, 0xc6, 0x75, 0xad, 0x49, 0x8a, 0xfe, 0xeb,
+    0xb6, 0x96, 0x0b, 0x3a, 0xab, 0xe6
+  };
+  static const guint8 cipher_key[16] = {
+    0xc6, 0x1e, 0x7a, 0x93, 0x74, 0x4f, 0x39, 0xee,
+    0x10, 0x73, 0x4a, 0xfe, 0x3f, 0xf7, 0xa0, 0x87
+  };
+  static const guint8 cipher_salt[14] = {
+    0x30, 0xcb, 0xbc, 0x08, 0x86, 0x3d, 0x8c, 0x85,
+    0xd4, 0x9d, 0xb3, 0x4a, 0x9a, 0xe1
+  };
+  static const guint8 auth_key[20] = {
+    0xce, 0xbe, 0x32, 0x1f, 0x6f, 0xf7, 0x71, 0x6b, 0x6f, 0xd4,
+    0xab, 0x49, 0xaf, 0x25, 0x6a, 0x15, 0x6d, 0x38, 0xba, 0xa4
+  };
+  static const guint8 block[16] = "SRTP test block";
+  struct aes_ctx aes;
+  struct hmac_sha1_ctx hmac;
+  GstSrtpStream *stream;
+  GstBuffer *key;
+  guint8 expected[20], out[20];
+
+  key = make_master_key (master_key, master_salt);
+  stream = gst_srtp_stream_new (0, key);
+  gst_buffer_unref (key);
+  fail_unless (stream != NULL);
+
+  fail_unless (memcmp (stream->rtp.salt, cipher_salt, 14) == 0);
+
+  /* the keys are only available as nettle contexts, compare them with
+   * contexts set up with the expected keys */
+  aes_set_encrypt_key (&aes, sizeof (cipher_key), cipher_key);
+  aes_encrypt (&aes, 16, expected, block);
+  aes_encrypt (&stream->rtp.aes, 16, out, block);
+  fail_unless (memcmp (out, expected, 16) == 0);
+
+  hmac_sha1_set_key (&hmac, sizeof (auth_key), auth_key);
+  hmac_sha1_update (&hmac, sizeof (block), block);
+  hmac_sha1_digest (&hmac, sizeof (expected), expected);
+  hmac_sha1_update (&stream->rtp.hmac, sizeof (block), block);
+  hmac_sha1_digest (&stream->rtp.hmac, sizeof (out), out);
+  fail_unless (memcmp (out, expected, 20) == 0);
+
+  gst_srtp_stream_free (stream);
+}
+
+GST_END_TEST;
+
+static Suite *
+srtp_crypto_suite (void)
+{
+  Suite *s = suite_create ("srtp_crypto");
+  TCase *tc_chain = tcase_create ("general");
+
+  suite_add_tcase (s, tc_chain);
+  tcase_add_test (tc_chain, test_aes_cm_keystream);
+  tcase_add_test (tc_chain, test_key_derivation);
+
+  return s;
+}
+
+GST_CHECK_MAIN (srtp_crypto);
@@ -0,0 +1,102 @@
+/* GStreamer
+ *
+ * m3u8-refresh-bench.c: measure the cost of live HLS playlist refreshes
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/* Parses live playlists of 100, 1000 and 10000 entries, then refreshes them
+ * with the window moved by one fragment each time, like a client polling a
+ * live stream, and reports the time of the initial load and of a refresh.
+ *
+ * Usage: m3u8-refresh-bench [num-refreshes]
+ */
+
+#include <stdlib.h>
+#include <gst/gst.h>
+
+#include "m3u8.h"
+
+GST_DEBUG_CATEGORY (fragmented_debug);
+
+static gchar *
+make_playlist (guint first, guint n)
+{
+  GString *str;
+  guint i;
+
+  str = g_string_new ("#EXTM3U\n#EXT-X-TARGETDURATION:10\n");
+  g_string_append_printf (str, "#EXT-X-MEDIA-SEQUENCE:%u\n", first);
+  for (i = first; i < first + n; i++)
+    g_string_append_printf (str, "#EXTINF:10.000,\nfragment-%08u.ts\n", i);
+
+  return g_string_free (str, FALSE);
+}
+
+static void
+run_bench (guint n_entries, guint n_refreshes)
+{
+  GstM3U8Client *client;
+  gchar **playlists;
+  GTimer *timer;
+  gdouble load, refresh;
+  guint i;
+
+  /* generate all the playlists first, only the parsing is measured */
+  playlists = g_new (gchar *, n_refreshes + 1);
+  for (i = 0; i <= n_refreshes; i++)
+    playlists[i] = make_playlist (i, n_entries);
+
+  client = gst_m3u8_client_new ("http://localhost/live/playlist.m3u8");
+
+  timer = g_timer_new ();
+  gst_m3u8_client_update (client, playlists[0]);
+  load = g_timer_elapsed (timer, NULL);
+
+  g_timer_start (timer);
+  for (i = 1; i <= n_refreshes; i++) {
+    if (!gst_m3u8_client_update (client, playlists[i]))
+      g_error ("refresh %u failed", i);
+  }
+  refresh = g_timer_elapsed (timer, NULL) / n_refreshes;
+
+  g_print ("%6u entries: load %8.1f us, refresh %8.1f us\n", n_entries,
+      load * 1e6, refresh * 1e6);
+
+  g_timer_destroy (timer);
+  gst_m3u8_client_free (client);
+  /* the client took ownership of the playlist data */
+  g_free (playlists);
+}
+
+int
+main (int argc, char *argv[])
+{
+  guint n_refreshes = 200;
+
+  gst_init (&argc, &argv);
+  GST_DEBUG_CATEGORY_INIT (fragmented_debug, "fragmented", 0,
+      "m3u8 refresh bench");
+
+  if (argc > 1)
+    n_refreshes = atoi (argv[1]);
+
+  run_bench (100, n_refreshes);
+  run_bench (1000, n_refreshes);
+  run_bench (10000, n_refreshes);
+
+  return 0;
+}
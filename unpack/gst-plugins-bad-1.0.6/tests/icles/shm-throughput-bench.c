@@ -0,0 +1,221 @@
+/* GStreamer
+ *
+ * shm-throughput-bench.c: measure the throughput of shmsink and shmsrc
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/* Sends raw 1080p I420 frames from this process to a forked reader process
+ * running shmsrc ! fakesink. The frames are written once in memory allocated
+ * by the allocator shmsink proposes, and once in normal memory that shmsink
+ * has to copy into the shared memory area. The caps and EOS reach the reader
+ * through the forward-events property. Reports the frame rate and bandwidth
+ * on both sides.
+ *
+ * Usage: shm-throughput-bench [num-frames]
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <gst/gst.h>
+
+#define WIDTH 1920
+#define HEIGHT 1080
+#define FRAME_SIZE (WIDTH * HEIGHT * 3 / 2)
+
+static guint num_frames = 600;
+
+static guint64 received_frames;
+static guint64 received_bytes;
+static GstClockTime first_time = GST_CLOCK_TIME_NONE;
+
+static void
+handoff (GstElement * sink, GstBuffer * buffer, GstPad * pad,
+    gpointer user_data)
+{
+  if (received_frames++ == 0)
+    first_time = gst_util_get_timestamp ();
+  received_bytes += gst_buffer_get_size (buffer);
+}
+
+static void
+run_reader (const gchar * path)
+{
+  GstElement *pipeline, *sink;
+  GstMessage *msg;
+  GstClockTime elapsed;
+  GstCaps *caps;
+  GstPad *pad;
+  gchar *desc, *str;
+
+  /* wait for the writer to create the socket */
+  while (!g_file_test (path, G_FILE_TEST_EXISTS))
+    g_usleep (1000);
+
+  desc = g_strdup_printf ("shmsrc socket-path=%s ! fakesink name=sink "
+      "sync=false signal-handoffs=true", path);
+  pipeline = gst_parse_launch (desc, NULL);
+  g_free (desc);
+  if (pipeline == NULL)
+    g_error ("could not create the reader pipeline");
+
+  sink = gst_bin_get_by_name (GST_BIN (pipeline), "sink");
+  g_signal_connect (sink, "handoff", G_CALLBACK (handoff), NULL);
+
+  gst_element_set_state (pipeline, GST_STATE_PLAYING);
+  msg = gst_bus_timed_pop_filtered (GST_ELEMENT_BUS (pipeline),
+      GST_CLOCK_TIME_NONE, GST_MESSAGE_EOS | GST_MESSAGE_ERROR);
+  elapsed = gst_util_get_timestamp () - first_time;
+  if (GST_MESSAGE_TYPE (msg) == GST_MESSAGE_ERROR)
+    g_printerr ("reader: got an error before the end of the stream\n");
+  gst_message_unref (msg);
+
+  pad = gst_element_get_static_pad (sink, "sink");
+  caps = gst_pad_get_current_caps (pad);
+  str = caps ? gst_caps_to_string (caps) : g_strdup ("none");
+  g_print ("  reader: %" G_GUINT64_FORMAT " frames, %.1f frames/s, "
+      "%.0f MB/s, caps %s\n", received_frames,
+      received_frames * (gdouble) GST_SECOND / MAX (elapsed, 1),
+      received_bytes * (gdouble) GST_SECOND / MAX (elapsed, 1) / 1e6, str);
+  g_free (str);
+  if (caps)
+    gst_caps_unref (caps);
+  gst_object_unref (pad);
+
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+  gst_object_unref (sink);
+  gst_object_unref (pipeline);
+}
+
+static void
+run_writer (const gchar * path, gboolean zero_copy)
+{
+  GstElement *sink;
+  GstPad *srcpad, *sinkpad;
+  GstAllocator *allocator = NULL;
+  GstAllocationParams params;
+  GstSegment segment;
+  GstCaps *caps;
+  GstQuery *query;
+  GstClockTime start, elapsed;
+  guint i;
+
+  sink = gst_element_factory_make ("shmsink", NULL);
+  if (sink == NULL)
+    g_error ("shmsink is not available");
+  g_object_set (sink, "socket-path", path, "shm-size", FRAME_SIZE * 8,
+      "forward-events", TRUE, "sync", FALSE, NULL);
+
+  srcpad = gst_pad_new ("src", GST_PAD_SRC);
+  sinkpad = gst_element_get_static_pad (sink, "sink");
+  gst_pad_set_active (srcpad, TRUE);
+  gst_pad_link (srcpad, sinkpad);
+  gst_object_unref (sinkpad);
+
+  gst_element_set_state (sink, GST_STATE_PLAYING);
+
+  caps = gst_caps_new_simple ("video/x-raw", "format", G_TYPE_STRING, "I420",
+      "width", G_TYPE_INT, WIDTH, "height", G_TYPE_INT, HEIGHT,
+      "framerate", GST_TYPE_FRACTION, 60, 1, NULL);
+  gst_pad_push_event (srcpad,
+      gst_event_new_stream_start ("shm-throughput-bench"));
+  gst_pad_push_event (srcpad, gst_event_new_caps (caps));
+  gst_segment_init (&segment, GST_FORMAT_TIME);
+  gst_pad_push_event (srcpad, gst_event_new_segment (&segment));
+
+  gst_allocation_params_init (&params);
+  if (zero_copy) {
+    query = gst_query_new_allocation (caps, TRUE);
+    if (gst_pad_peer_query (srcpad, query) &&
+        gst_query_get_n_allocation_params (query) > 0)
+      gst_query_parse_nth_allocation_param (query, 0, &allocator, &params);
+    gst_query_unref (query);
+    if (allocator == NULL)
+      g_printerr ("shmsink did not propose an allocator\n");
+  }
+  gst_caps_unref (caps);
+
+  start = gst_util_get_timestamp ();
+  for (i = 0; i < num_frames; i++) {
+    GstBuffer *buf;
+    GstMapInfo map;
+
+    /* write the whole frame like a producer would */
+    buf = gst_buffer_new_allocate (allocator, FRAME_SIZE, &params);
+    gst_buffer_map (buf, &map, GST_MAP_WRITE);
+    memset (map.data, i & 0xff, map.size);
+    gst_buffer_unmap (buf, &map);
+
+    GST_BUFFER_TIMESTAMP (buf) = gst_util_uint64_scale (i, GST_SECOND, 60);
+    GST_BUFFER_DURATION (buf) = GST_SECOND / 60;
+    if (gst_pad_push (srcpad, buf) != GST_FLOW_OK)
+      g_error ("pushing frame %u failed", i);
+  }
+  gst_pad_push_event (srcpad, gst_event_new_eos ());
+  elapsed = gst_util_get_timestamp () - start;
+
+  g_print ("  writer: %u frames, %.1f frames/s\n", num_frames,
+      num_frames * (gdouble) GST_SECOND / MAX (elapsed, 1));
+
+  if (allocator)
+    gst_object_unref (allocator);
+  gst_element_set_state (sink, GST_STATE_NULL);
+  gst_object_unref (srcpad);
+  gst_object_unref (sink);
+}
+
+static void
+run_bench (gboolean zero_copy)
+{
+  gchar *path;
+  pid_t pid;
+
+  path = g_strdup_printf ("%s/shm-throughput-bench.%d", g_get_tmp_dir (),
+      (gint) getpid ());
+
+  g_print ("%s:\n", zero_copy ? "shared memory allocator" : "copy");
+
+  pid = fork ();
+  if (pid < 0)
+    g_error ("fork failed");
+
+  if (pid == 0) {
+    run_reader (path);
+    _exit (0);
+  }
+
+  run_writer (path, zero_copy);
+  waitpid (pid, NULL, 0);
+
+  g_free (path);
+}
+
+int
+main (int argc, char *argv[])
+{
+  gst_init (&argc, &argv);
+
+  if (argc > 1)
+    num_frames = atoi (argv[1]);
+
+  run_bench (TRUE);
+  run_bench (FALSE);
+
+  return 0;
+}
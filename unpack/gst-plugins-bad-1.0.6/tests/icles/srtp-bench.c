@@ -0,0 +1,208 @@
+/* GStreamer
+ *
+ * srtp-bench.c: measure the packet rate of srtpenc and srtpdec
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/* Pushes RTP packets into srtpenc, alone and followed by srtpdec. The packets
+ * are pushed one by one as writable buffers that are encrypted in place, one
+ * by one while the bench keeps a reference so that the element has to copy
+ * them, and in buffer lists. Only the time spent in the elements is counted,
+ * the packets are made in batches before. Reports packets/s and Mbit/s.
+ *
+ * Usage: srtp-bench [num-packets] [payload-size]
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <gst/gst.h>
+
+#define BATCH 64
+
+static guint num_packets = 200000;
+static guint payload_size = 1200;
+
+static guint64 received;
+
+static GstFlowReturn
+chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
+{
+  received++;
+  gst_buffer_unref (buffer);
+  return GST_FLOW_OK;
+}
+
+static GstFlowReturn
+chain_list (GstPad * pad, GstObject * parent, GstBufferList * list)
+{
+  received += gst_buffer_list_length (list);
+  gst_buffer_list_unref (list);
+  return GST_FLOW_OK;
+}
+
+static GstBuffer *
+make_packet (guint16 seq)
+{
+  GstBuffer *buf;
+  GstMapInfo map;
+
+  buf = gst_buffer_new_allocate (NULL, 12 + payload_size, NULL);
+  gst_buffer_map (buf, &map, GST_MAP_WRITE);
+  memset (map.data + 12, seq & 0xff, payload_size);
+  map.data[0] = 0x80;
+  map.data[1] = 96;
+  GST_WRITE_UINT16_BE (map.data + 2, seq);
+  GST_WRITE_UINT32_BE (map.data + 4, seq * 90);
+  GST_WRITE_UINT32_BE (map.data + 8, 0x12345678);
+  gst_buffer_unmap (buf, &map);
+
+  return buf;
+}
+
+static GstElement *
+make_element (const gchar * name, GstBuffer * key)
+{
+  GstElement *element;
+
+  element = gst_element_factory_make (name, NULL);
+  if (element == NULL)
+    g_error ("%s is not available", name);
+  gst_object_ref_sink (element);
+  g_object_set (element, "key", key, NULL);
+
+  return element;
+}
+
+static void
+run_bench (const gchar * desc, GstBuffer * key, gboolean decode,
+    gboolean shared, gboolean use_lists)
+{
+  GstElement *enc, *dec = NULL;
+  GstPad *srcpad, *sinkpad, *pad;
+  GstSegment segment;
+  GstClockTime start, elapsed = 0;
+  guint i, j;
+
+  enc = make_element ("srtpenc", key);
+  srcpad = gst_pad_new ("src", GST_PAD_SRC);
+  sinkpad = gst_pad_new ("sink", GST_PAD_SINK);
+  gst_pad_set_chain_function (sinkpad, chain);
+  gst_pad_set_chain_list_function (sinkpad, chain_list);
+
+  pad = gst_element_get_static_pad (enc, "sink");
+  gst_pad_link (srcpad, pad);
+  gst_object_unref (pad);
+
+  pad = gst_element_get_static_pad (enc, "src");
+  if (decode) {
+    GstPad *decpad;
+
+    dec = make_element ("srtpdec", key);
+    decpad = gst_element_get_static_pad (dec, "sink");
+    gst_pad_link (pad, decpad);
+    gst_object_unref (decpad);
+    gst_object_unref (pad);
+    pad = gst_element_get_static_pad (dec, "src");
+  }
+  gst_pad_link (pad, sinkpad);
+  gst_object_unref (pad);
+
+  gst_pad_set_active (srcpad, TRUE);
+  gst_pad_set_active (sinkpad, TRUE);
+  gst_element_set_state (enc, GST_STATE_PLAYING);
+  if (dec)
+    gst_element_set_state (dec, GST_STATE_PLAYING);
+
+  gst_pad_push_event (srcpad, gst_event_new_stream_start ("srtp-bench"));
+  gst_segment_init (&segment, GST_FORMAT_TIME);
+  gst_pad_push_event (srcpad, gst_event_new_segment (&segment));
+
+  received = 0;
+  for (i = 0; i < num_packets; i += BATCH) {
+    GstBuffer *batch[BATCH];
+    GstBufferList *list = NULL;
+    guint n = MIN (BATCH, num_packets - i);
+
+    for (j = 0; j < n; j++)
+      batch[j] = make_packet (i + j);
+
+    if (use_lists) {
+      list = gst_buffer_list_new_sized (n);
+      for (j = 0; j < n; j++)
+        gst_buffer_list_add (list, batch[j]);
+    }
+
+    start = gst_util_get_timestamp ();
+    if (use_lists) {
+      gst_pad_push_list (srcpad, list);
+    } else {
+      for (j = 0; j < n; j++)
+        gst_pad_push (srcpad, shared ? gst_buffer_ref (batch[j]) : batch[j]);
+    }
+    elapsed += gst_util_get_timestamp () - start;
+
+    if (shared)
+      for (j = 0; j < n; j++)
+        gst_buffer_unref (batch[j]);
+  }
+
+  g_print ("%-28s %" G_GUINT64_FORMAT " packets, %.0f packets/s, "
+      "%.1f Mbit/s\n", desc, received,
+      received * (gdouble) GST_SECOND / MAX (elapsed, 1),
+      received * payload_size * 8 * (gdouble) GST_SECOND / MAX (elapsed,
+          1) / 1e6);
+
+  gst_element_set_state (enc, GST_STATE_NULL);
+  gst_object_unref (enc);
+  if (dec) {
+    gst_element_set_state (dec, GST_STATE_NULL);
+    gst_object_unref (dec);
+  }
+  gst_object_unref (srcpad);
+  gst_object_unref (sinkpad);
+}
+
+int
+main (int argc, char *argv[])
+{
+  GstBuffer *key;
+  guint8 *data;
+  guint i;
+
+  gst_init (&argc, &argv);
+
+  if (argc > 1)
+    num_packets = atoi (argv[1]);
+  if (argc > 2)
+    payload_size = atoi (argv[2]);
+
+  data = g_malloc (30);
+  for (i = 0; i < 30; i++)
+    data[i] = g_random_int_range (0, 256);
+  key = gst_buffer_new_wrapped (data, 30);
+
+  g_print ("%u packets with %u bytes of payload\n", num_packets, payload_size);
+  run_bench ("encrypt in place:", key, FALSE, FALSE, FALSE);
+  run_bench ("encrypt shared buffers:", key, FALSE, TRUE, FALSE);
+  run_bench ("encrypt buffer lists:", key, FALSE, FALSE, TRUE);
+  run_bench ("encrypt and decrypt:", key, TRUE, FALSE, FALSE);
+  run_bench ("encrypt and decrypt lists:", key, TRUE, FALSE, TRUE);
+
+  gst_buffer_unref (key);
+
+  return 0;
+}
@@ -730,6 +730,80 @@ gst_rtp_base_payload_is_filled (GstRTPBasePayload * payload,
   return FALSE;
 }
 
+/**
+ * gst_rtp_base_payload_packet_append:
+ * @payload: a #GstRTPBasePayload
+ * @packet: (transfer full): a #GstBuffer
+ * @buffer: a #GstBuffer with payload data
+ * @offset: the offset of the payload data in @buffer
+ * @size: the size of the payload data in @buffer or -1 for all data after
+ *     @offset
+ *
+ * Add @size bytes of @buffer starting at @offset to the end of @packet
+ * without copying them.
+ *
+ * Returns: (transfer full): the new packet.
+ */
+GstBuffer *
+gst_rtp_base_payload_packet_append (GstRTPBasePayload * payload,
+    GstBuffer * packet, GstBuffer * buffer, gsize offset, gssize size)
+{
+  g_return_val_if_fail (GST_IS_RTP_BASE_PAYLOAD (payload), NULL);
+  g_return_val_if_fail (GST_IS_BUFFER (packet), NULL);
+  g_return_val_if_fail (GST_IS_BUFFER (buffer), NULL);
+
+  GST_LOG_OBJECT (payload, "adding %" G_GSSIZE_FORMAT " bytes at offset %"
+      G_GSIZE_FORMAT, size, offset);
+
+  return gst_buffer_append_region (packet, gst_buffer_ref (buffer), offset,
+      size);
+}
+
+/**
+ * gst_rtp_base_payload_packet_new:
+ * @payload: a #GstRTPBasePayload
+ * @header: (allow-none): payload specific header
+ * @header_len: the length of @header
+ * @buffer: (allow-none): a #GstBuffer with payload data
+ * @offset: the offset of the payload data in @buffer
+ * @size: the size of the payload data in @buffer or -1 for all data after
+ *     @offset
+ *
+ * Make a new RTP packet with the RTP header and @header_len bytes of @header
+ * in one small memory block, followed by @size bytes of @buffer starting at
+ * @offset. The payload data is not copied, the packet shares the memory of
+ * @buffer. The timestamps of @buffer are set on the packet.
+ *
+ * Subclasses usually collect the packets made from one input buffer in a
+ * #GstBufferList and push them with gst_rtp_base_payload_push_list().
+ *
+ * Returns: (transfer full): a new RTP packet.
+ */
+GstBuffer *
+gst_rtp_base_payload_packet_new (GstRTPBasePayload * payload,
+    const guint8 * header, guint header_len, GstBuffer * buffer,
+    gsize offset, gssize size)
+{
+  GstBuffer *packet;
+
+  g_return_val_if_fail (GST_IS_RTP_BASE_PAYLOAD (payload), NULL);
+  g_return_val_if_fail (header != NULL || header_len == 0, NULL);
+
+  packet = gst_rtp_buffer_new_allocate (header_len, 0, 0);
+  if (header_len > 0)
+    gst_buffer_fill (packet, gst_rtp_buffer_calc_header_len (0), header,
+        header_len);
+
+  if (buffer) {
+    GST_BUFFER_PTS (packet) = GST_BUFFER_PTS (buffer);
+    GST_BUFFER_DTS (packet) = GST_BUFFER_DTS (buffer);
+
+    packet = gst_rtp_base_payload_packet_append (payload, packet, buffer,
+        offset, size);
+  }
+  return packet;
+}
+
 typedef struct
 {
   GstRTPBasePayload *payload;
@@ -159,6 +159,14 @@ gboolean        gst_rtp_base_payload_set_outcaps        (GstRTPBasePayload *payl
 gboolean        gst_rtp_base_payload_is_filled          (GstRTPBasePayload *payload,
                                                          guint size, GstClockTime duration);
 
+GstBuffer *     gst_rtp_base_payload_packet_new         (GstRTPBasePayload *payload,
+                                                         const guint8 *header, guint header_len,
+                                                         GstBuffer *buffer, gsize offset,
+                                                         gssize size);
+GstBuffer *     gst_rtp_base_payload_packet_append      (GstRTPBasePayload *payload,
+                                                         GstBuffer *packet, GstBuffer *buffer,
+                                                         gsize offset, gssize size);
+
 GstFlowReturn   gst_rtp_base_payload_push               (GstRTPBasePayload *payload,
                                                          GstBuffer *buffer);
 
@@ -126,6 +126,15 @@ struct _GstRTSPConnection
   gchar *initial_buffer;
   gsize initial_buffer_offset;
 
+  /* bytes received from read_socket but not consumed yet, the memory is
+   * shared with the buffers of gst_rtsp_connection_receive_data() */
+  GstMemory *recv_mem;
+  GstMapInfo recv_map;
+  guint8 *recv_buf;
+  guint recv_size;
+  guint recv_start;
+  guint recv_end;
+
   /* Session state */
   gint cseq;                    /* sequence number */
   gchar session_id[512];        /* session id */
@@ -916,11 +925,68 @@ write_bytes (GSocket * socket, const guint8 * buffer, guint * idx, guint size,
   return GST_RTSP_OK;
 }
 
+/* size of the receive buffer, large enough to hold a complete request of a
+ * typical client so that it can be parsed with one receive call */
+#define RECV_BUFFER_SIZE 4096
+
+/* size of the receive buffer for interleaved data, it holds the largest
+ * possible frame and lets us receive many smaller ones at once */
+#define RECV_DATA_BUFFER_SIZE (128 * 1024)
+
+#define RECV_BUFFER_AVAIL(conn) ((conn)->recv_end - (conn)->recv_start)
+
+static void
+recv_buffer_free (GstRTSPConnection * conn)
+{
+  if (conn->recv_mem) {
+    gst_memory_unmap (conn->recv_mem, &conn->recv_map);
+    gst_memory_unref (conn->recv_mem);
+    conn->recv_mem = NULL;
+  }
+  conn->recv_buf = NULL;
+  conn->recv_size = 0;
+  conn->recv_start = conn->recv_end = 0;
+}
+
+/* makes sure the receive buffer can hold @size bytes, moving the bytes that
+ * were not consumed yet to its start. The buffer is replaced when it is too
+ * small or when received data in it is still used by buffers */
+static void
+recv_buffer_prepare (GstRTSPConnection * conn, guint size)
+{
+  guint avail = RECV_BUFFER_AVAIL (conn);
+  GstMemory *mem;
+  GstMapInfo map;
+
+  if (conn->recv_mem && conn->recv_size >= size &&
+      GST_MINI_OBJECT_REFCOUNT_VALUE (conn->recv_mem) == 1) {
+    if (conn->recv_start > 0) {
+      memmove (conn->recv_buf, &conn->recv_buf[conn->recv_start], avail);
+      conn->recv_start = 0;
+      conn->recv_end = avail;
+    }
+    return;
+  }
+
+  mem = gst_allocator_alloc (NULL, size, NULL);
+  gst_memory_map (mem, &map, GST_MAP_READWRITE);
+  if (avail > 0)
+    memcpy (map.data, &conn->recv_buf[conn->recv_start], avail);
+
+  recv_buffer_free (conn);
+  conn->recv_mem = mem;
+  conn->recv_map = map;
+  conn->recv_buf = map.data;
+  conn->recv_size = size;
+  conn->recv_end = avail;
+}
+
 static gint
 fill_raw_bytes (GstRTSPConnection * conn, guint8 * buffer, guint size,
     GError ** err)
 {
   gint out = 0;
+  guint avail;
 
   if (G_UNLIKELY (conn->initial_buffer != NULL)) {
     gsize left = strlen (&conn->initial_buffer[conn->initial_buffer_offset]);
@@ -936,11 +1002,41 @@ fill_raw_bytes (GstRTSPConnection * conn, guint8 * buffer, guint size,
       conn->initial_buffer_offset += out;
   }
 
+  /* serve what we have left from the previous receive, the caller will call
+   * us again when it needs more */
+  avail = RECV_BUFFER_AVAIL (conn);
+  if (avail > 0 && size > (guint) out) {
+    guint len = MIN (avail, size - out);
+
+    memcpy (&buffer[out], &conn->recv_buf[conn->recv_start], len);
+    conn->recv_start += len;
+    return out + len;
+  }
+
   if (G_LIKELY (size > (guint) out)) {
     gssize r;
 
-    r = g_socket_receive (conn->read_socket, (gchar *) & buffer[out],
-        size - out, conn->cancellable, err);
+    if (size - out >= RECV_BUFFER_SIZE) {
+      /* large reads, like message bodies and interleaved data, go straight
+       * into the destination */
+      r = g_socket_receive (conn->read_socket, (gchar *) & buffer[out],
+          size - out, conn->cancellable, err);
+    } else {
+      /* small reads would cost a syscall per line or even per character,
+       * receive as much as is available into the receive buffer instead */
+      recv_buffer_prepare (conn, RECV_BUFFER_SIZE);
+
+      r = g_socket_receive (conn->read_socket, (gchar *) conn->recv_buf,
+          conn->recv_size, conn->cancellable, err);
+      if (r > 0) {
+        guint len = MIN ((guint) r, size - out);
+
+        memcpy (&buffer[out], conn->recv_buf, len);
+        conn->recv_start = len;
+        conn->recv_end = r;
+        r = len;
+      }
+    }
     if (r <= 0) {
       if (out == 0)
         out = r;
@@ -1056,6 +1152,31 @@ read_line (GstRTSPConnection * conn, guint8 * buffer, guint * idx, guint size)
       /* the last call to read_line() left us with a character to start with */
       c = (guint8) conn->read_ahead;
       conn->read_ahead = 0;
+    } else if (conn->ctxp == NULL && RECV_BUFFER_AVAIL (conn) > 0) {
+      guint8 *data = &conn->recv_buf[conn->recv_start];
+      guint avail = RECV_BUFFER_AVAIL (conn);
+      guint8 *end;
+      guint len;
+
+      /* copy everything up to the next line ending directly from the receive
+       * buffer instead of going through fill_bytes() for each character */
+      end = memchr (data, '\n', avail);
+      if (end)
+        avail = end - data;
+      end = memchr (data, '\r', avail);
+      if (end)
+        avail = end - data;
+
+      len = MIN (avail, size - 1 - *idx);
+      memcpy (&buffer[*idx], data, len);
+      *idx += len;
+      conn->recv_start += avail;
+
+      /* no line ending in the buffer yet, get more data */
+      if (RECV_BUFFER_AVAIL (conn) == 0)
+        continue;
+
+      c = conn->recv_buf[conn->recv_start++];
     } else {
       /* read the next character */
       r = fill_bytes (conn, &c, 1, &err);
@@ -2137,6 +2258,129 @@ cleanup:
   }
 }
 
+/**
+ * gst_rtsp_connection_receive_data:
+ * @conn: a #GstRTSPConnection
+ * @channel: (out): location for the channel of the data
+ * @buffer: (out) (transfer full): location for the data
+ * @timeout: a timeout value or #NULL
+ *
+ * Attempt to read the next interleaved data message from the connected
+ * @conn, blocking up to the specified @timeout. Unlike
+ * gst_rtsp_connection_receive(), the data is not copied into a message: the
+ * memory of @buffer is the memory the data was received in, and many
+ * messages are received at once when they are available.
+ *
+ * When the next message on @conn is not a data message, or when @conn is
+ * tunneled, @buffer is set to #NULL and the message should be read with
+ * gst_rtsp_connection_receive().
+ *
+ * This function can be cancelled with gst_rtsp_connection_flush().
+ *
+ * Returns: #GST_RTSP_OK on success.
+ */
+GstRTSPResult
+gst_rtsp_connection_receive_data (GstRTSPConnection * conn, guint8 * channel,
+    GstBuffer ** buffer, GTimeVal * timeout)
+{
+  GstClockTime to;
+  GError *err = NULL;
+
+  g_return_val_if_fail (conn != NULL, GST_RTSP_EINVAL);
+  g_return_val_if_fail (channel != NULL, GST_RTSP_EINVAL);
+  g_return_val_if_fail (buffer != NULL, GST_RTSP_EINVAL);
+  g_return_val_if_fail (conn->read_socket != NULL, GST_RTSP_EINVAL);
+
+  *buffer = NULL;
+
+  /* base64 decoding and partially parsed lines go through the builder */
+  if (conn->ctxp != NULL || conn->initial_buffer != NULL ||
+      conn->read_ahead != 0)
+    return GST_RTSP_OK;
+
+  /* configure timeout if any */
+  to = timeout ? GST_TIMEVAL_TO_TIME (*timeout) : GST_CLOCK_TIME_NONE;
+
+  while (TRUE) {
+    guint avail = RECV_BUFFER_AVAIL (conn);
+    guint8 *data = &conn->recv_buf[conn->recv_start];
+    guint size = 0;
+    gssize r;
+
+    if (avail > 0 && data[0] != '$')
+      return GST_RTSP_OK;
+
+    if (avail >= 4) {
+      size = GST_READ_UINT16_BE (&data[2]);
+      if (avail >= 4 + size) {
+        /* a complete frame, share it with the buffer */
+        *channel = data[1];
+        *buffer = gst_buffer_new ();
+        gst_buffer_append_memory (*buffer,
+            gst_memory_share (conn->recv_mem, conn->recv_start + 4, size));
+        conn->recv_start += 4 + size;
+        return GST_RTSP_OK;
+      }
+    }
+
+    /* make room for the rest of the frame */
+    if (conn->recv_mem == NULL || conn->recv_start + 4 + size > conn->recv_size)
+      recv_buffer_prepare (conn, RECV_DATA_BUFFER_SIZE);
+
+    r = g_socket_receive (conn->read_socket,
+        (gchar *) & conn->recv_buf[conn->recv_end],
+        conn->recv_size - conn->recv_end, conn->cancellable, &err);
+    if (G_UNLIKELY (r == 0))
+      goto eof;
+    if (G_LIKELY (r > 0)) {
+      conn->recv_end += r;
+      continue;
+    }
+
+    if (!g_error_matches (err, G_IO_ERROR, G_IO_ERROR_WOULD_BLOCK)) {
+      g_clear_error (&err);
+      goto read_error;
+    }
+    g_clear_error (&err);
+
+    g_socket_set_timeout (conn->read_socket,
+        (to + GST_SECOND - 1) / GST_SECOND);
+    if (!g_socket_condition_wait (conn->read_socket,
+            G_IO_IN | G_IO_PRI | G_IO_ERR | G_IO_HUP, conn->cancellable,
+            &err)) {
+      g_socket_set_timeout (conn->read_socket, 0);
+      if (g_error_matches (err, G_IO_ERROR, G_IO_ERROR_CANCELLED)) {
+        g_clear_error (&err);
+        goto stopped;
+      } else if (g_error_matches (err, G_IO_ERROR, G_IO_ERROR_TIMED_OUT)) {
+        g_clear_error (&err);
+        goto select_timeout;
+      }
+      g_clear_error (&err);
+      goto read_error;
+    }
+    g_socket_set_timeout (conn->read_socket, 0);
+  }
+
+  /* ERRORS */
+select_timeout:
+  {
+    return GST_RTSP_ETIMEOUT;
+  }
+stopped:
+  {
+    return GST_RTSP_EINTR;
+  }
+eof:
+  {
+    return GST_RTSP_EEOF;
+  }
+read_error:
+  {
+    return GST_RTSP_ESYS;
+  }
+}
+
 /**
  * gst_rtsp_connection_close:
  * @conn: a #GstRTSPConnection
@@ -2171,6 +2415,8 @@ gst_rtsp_connection_close (GstRTSPConnection * conn)
   conn->initial_buffer = NULL;
   conn->initial_buffer_offset = 0;
 
+  conn->recv_start = conn->recv_end = 0;
+
   conn->write_socket = NULL;
   conn->read_socket = NULL;
   conn->tunneled = FALSE;
@@ -2211,6 +2457,7 @@ gst_rtsp_connection_free (GstRTSPConnection * conn)
   g_timer_destroy (conn->timer);
   gst_rtsp_url_free (conn->url);
   g_free (conn->proxy_host);
+  recv_buffer_free (conn);
   g_free (conn);
 
   return res;
@@ -2273,8 +2520,10 @@ gst_rtsp_connection_poll (GstRTSPConnection * conn, GstRTSPEvent events,
   g_source_attach (ws, ctx);
   g_source_unref (ws);
 
-  /* Returns after handling all pending events */
-  g_main_context_iteration (ctx, TRUE);
+  /* Returns after handling all pending events, don't block when we still have
+   * received data to read */
+  g_main_context_iteration (ctx, !((events & GST_RTSP_EV_READ) &&
+          RECV_BUFFER_AVAIL (conn) > 0));
 
   g_main_context_unref (ctx);
 
@@ -2287,7 +2536,8 @@ gst_rtsp_connection_poll (GstRTSPConnection * conn, GstRTSPEvent events,
 
   *revents = 0;
   if (events & GST_RTSP_EV_READ) {
-    if ((condition & G_IO_IN) || (condition & G_IO_PRI))
+    if ((condition & G_IO_IN) || (condition & G_IO_PRI) ||
+        RECV_BUFFER_AVAIL (conn) > 0)
       *revents |= GST_RTSP_EV_READ;
   }
   if (events & GST_RTSP_EV_WRITE) {
@@ -2832,6 +3082,17 @@ gst_rtsp_connection_do_tunnel (GstRTSPConnection * conn,
     conn->initial_buffer = conn2->initial_buffer;
     conn2->initial_buffer = NULL;
     conn->initial_buffer_offset = conn2->initial_buffer_offset;
+
+    /* and the bytes we already received from it */
+    recv_buffer_free (conn);
+    conn->recv_mem = conn2->recv_mem;
+    conn->recv_map = conn2->recv_map;
+    conn->recv_buf = conn2->recv_buf;
+    conn->recv_size = conn2->recv_size;
+    conn->recv_start = conn2->recv_start;
+    conn->recv_end = conn2->recv_end;
+    conn2->recv_mem = NULL;
+    recv_buffer_free (conn2);
   }
 
   /* we need base64 decoding for the readfd */
@@ -2844,6 +3105,28 @@ gst_rtsp_connection_do_tunnel (GstRTSPConnection * conn,
   return GST_RTSP_OK;
 }
 
+/* a thread of a #GstRTSPWatchPool */
+typedef struct
+{
+  gint refcount;
+
+  GMainContext *context;
+  GMainLoop *loop;
+  GThread *thread;
+} GstRTSPWatchPoolContext;
+
+/**
+ * GstRTSPWatchPool:
+ *
+ * Opaque pool of threads, each running a #GMainContext, that share the
+ * #GstRTSPWatch objects attached to the pool.
+ */
+struct _GstRTSPWatchPool
+{
+  guint n_contexts;
+  GstRTSPWatchPoolContext **contexts;
+};
+
 #define READ_ERR    (G_IO_HUP | G_IO_ERR | G_IO_NVAL)
 #define READ_COND   (G_IO_IN | READ_ERR)
 #define WRITE_ERR   (G_IO_HUP | G_IO_ERR | G_IO_NVAL)
@@ -2882,6 +3165,9 @@ struct _GstRTSPWatch
 
   gpointer user_data;
   GDestroyNotify notify;
+
+  /* the pool thread we are attached to */
+  GstRTSPWatchPoolContext *pool_ctx;
 };
 
 static gboolean
@@ -2892,6 +3178,10 @@ gst_rtsp_source_prepare (GSource * source, gint * timeout)
   if (watch->conn->initial_buffer != NULL)
     return TRUE;
 
+  /* parse the next message from what we already received */
+  if (RECV_BUFFER_AVAIL (watch->conn) > 0 && watch->readfd.events != 0)
+    return TRUE;
+
   *timeout = (watch->conn->timeout * 1000);
 
   return FALSE;
@@ -2920,7 +3210,8 @@ gst_rtsp_source_dispatch (GSource * source, GSourceFunc callback G_GNUC_UNUSED,
   gboolean keep_running = TRUE;
 
   /* first read as much as we can */
-  if (watch->readfd.revents & READ_COND || watch->conn->initial_buffer != NULL) {
+  if (watch->readfd.revents & READ_COND || watch->conn->initial_buffer != NULL
+      || (RECV_BUFFER_AVAIL (watch->conn) > 0 && watch->readfd.events != 0)) {
     do {
       if (watch->readfd.revents & READ_ERR)
         goto read_error;
@@ -3114,6 +3405,13 @@ error:
   }
 }
 
+static void
+watch_pool_context_unref (GstRTSPWatchPoolContext * pctx)
+{
+  if (g_atomic_int_dec_and_test (&pctx->refcount))
+    g_slice_free (GstRTSPWatchPoolContext, pctx);
+}
+
 static void
 gst_rtsp_rec_free (gpointer data)
 {
@@ -3138,6 +3436,9 @@ gst_rtsp_source_finalize (GSource * source)
 
   g_mutex_clear (&watch->mutex);
 
+  if (watch->pool_ctx)
+    watch_pool_context_unref (watch->pool_ctx);
+
   if (watch->notify)
     watch->notify (watch->user_data);
 }
@@ -3378,3 +3679,147 @@ gst_rtsp_watch_send_message (GstRTSPWatch * watch, GstRTSPMessage * message,
   return gst_rtsp_watch_write_data (watch,
       (guint8 *) g_string_free (str, FALSE), size, id);
 }
+
+static gpointer
+watch_pool_thread (gpointer data)
+{
+  GstRTSPWatchPoolContext *pctx = data;
+
+  g_main_context_push_thread_default (pctx->context);
+  g_main_loop_run (pctx->loop);
+  g_main_context_pop_thread_default (pctx->context);
+
+  return NULL;
+}
+
+static gboolean
+watch_pool_quit (GMainLoop * loop)
+{
+  g_main_loop_quit (loop);
+  return FALSE;
+}
+
+/**
+ * gst_rtsp_watch_pool_new:
+ * @n_threads: the number of threads
+ *
+ * Create a pool of @n_threads threads that each run their own #GMainContext.
+ * Watches attached to the pool with gst_rtsp_watch_pool_attach() are spread
+ * over the threads so that the messages of different connections are parsed
+ * and dispatched in parallel. The callbacks of one watch are always called
+ * from the same thread.
+ *
+ * Returns: (transfer full): a new #GstRTSPWatchPool. Free with
+ * gst_rtsp_watch_pool_free() after usage.
+ */
+GstRTSPWatchPool *
+gst_rtsp_watch_pool_new (guint n_threads)
+{
+  GstRTSPWatchPool *pool;
+  guint i;
+
+  g_return_val_if_fail (n_threads > 0, NULL);
+
+  pool = g_new0 (GstRTSPWatchPool, 1);
+  pool->n_contexts = n_threads;
+  pool->contexts = g_new0 (GstRTSPWatchPoolContext *, n_threads);
+
+  for (i = 0; i < n_threads; i++) {
+    GstRTSPWatchPoolContext *pctx;
+    gchar *name;
+
+    pctx = g_slice_new0 (GstRTSPWatchPoolContext);
+    /* the pool holds one ref, each attached watch another */
+    pctx->refcount = 1;
+    pctx->context = g_main_context_new ();
+    pctx->loop = g_main_loop_new (pctx->context, FALSE);
+
+    name = g_strdup_printf ("rtsp-watch-%u", i);
+    pctx->thread = g_thread_new (name, watch_pool_thread, pctx);
+    g_free (name);
+
+    pool->contexts[i] = pctx;
+  }
+  return pool;
+}
+
+/**
+ * gst_rtsp_watch_pool_attach:
+ * @pool: a #GstRTSPWatchPool
+ * @watch: a #GstRTSPWatch
+ *
+ * Attach @watch to the thread of @pool with the least watches. The watch
+ * is removed from the pool again when it is destroyed, after the callbacks
+ * returned %FALSE or with g_source_destroy().
+ *
+ * Since the callbacks of @watch are called from a thread of @pool, the
+ * connection of @watch should only be used from within the callbacks or with
+ * the thread-safe gst_rtsp_watch_write_data() and
+ * gst_rtsp_watch_send_message().
+ *
+ * Returns: the ID (greater than 0) for the watch within the #GMainContext of
+ * its thread.
+ */
+guint
+gst_rtsp_watch_pool_attach (GstRTSPWatchPool * pool, GstRTSPWatch * watch)
+{
+  GstRTSPWatchPoolContext *pctx;
+  guint i;
+
+  g_return_val_if_fail (pool != NULL, 0);
+  g_return_val_if_fail (watch != NULL, 0);
+  g_return_val_if_fail (watch->pool_ctx == NULL, 0);
+
+  /* the refcount of a context is the number of watches in it, pick the
+   * least loaded one */
+  pctx = pool->contexts[0];
+  for (i = 1; i < pool->n_contexts; i++) {
+    if (g_atomic_int_get (&pool->contexts[i]->refcount) <
+        g_atomic_int_get (&pctx->refcount))
+      pctx = pool->contexts[i];
+  }
+  g_atomic_int_inc (&pctx->refcount);
+  watch->pool_ctx = pctx;
+
+  return g_source_attach ((GSource *) watch, pctx->context);
+}
+
+/**
+ * gst_rtsp_watch_pool_free:
+ * @pool: a #GstRTSPWatchPool
+ *
+ * Stop the threads of @pool and free it. Watches that are still attached to
+ * the pool are destroyed.
+ */
+void
+gst_rtsp_watch_pool_free (GstRTSPWatchPool * pool)
+{
+  guint i;
+
+  g_return_if_fail (pool != NULL);
+
+  for (i = 0; i < pool->n_contexts; i++) {
+    GstRTSPWatchPoolContext *pctx = pool->contexts[i];
+    GSource *source;
+
+    /* quit from within the loop, g_main_loop_quit() is lost when the thread
+     * did not start running the loop yet */
+    source = g_idle_source_new ();
+    g_source_set_priority (source, G_PRIORITY_HIGH);
+    g_source_set_callback (source, (GSourceFunc) watch_pool_quit, pctx->loop,
+        NULL);
+    g_source_attach (source, pctx->context);
+    g_source_unref (source);
+
+    g_thread_join (pctx->thread);
+    g_main_loop_unref (pctx->loop);
+    /* this destroys the remaining watches, they release their ref on the
+     * context when they are finalized */
+    g_main_context_unref (pctx->context);
+    pctx->loop = NULL;
+    pctx->context = NULL;
+    watch_pool_context_unref (pctx);
+  }
+  g_free (pool->contexts);
+  g_free (pool);
+}
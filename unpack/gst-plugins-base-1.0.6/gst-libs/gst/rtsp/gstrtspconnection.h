@@ -84,6 +84,8 @@ GstRTSPResult      gst_rtsp_connection_send           (GstRTSPConnection *conn,
                                                        GTimeVal *timeout);
 GstRTSPResult      gst_rtsp_connection_receive        (GstRTSPConnection *conn, GstRTSPMessage *message,
                                                        GTimeVal *timeout);
+GstRTSPResult      gst_rtsp_connection_receive_data   (GstRTSPConnection *conn, guint8 *channel,
+                                                       GstBuffer **buffer, GTimeVal *timeout);
 
 /* status management */
 GstRTSPResult      gst_rtsp_connection_poll           (GstRTSPConnection *conn, GstRTSPEvent events,
@@ -194,6 +196,14 @@ GstRTSPResult      gst_rtsp_watch_send_message       (GstRTSPWatch *watch,
                                                       GstRTSPMessage *message,
                                                       guint *id);
 
+typedef struct _GstRTSPWatchPool GstRTSPWatchPool;
+
+GstRTSPWatchPool * gst_rtsp_watch_pool_new           (guint n_threads);
+void               gst_rtsp_watch_pool_free          (GstRTSPWatchPool *pool);
+
+guint              gst_rtsp_watch_pool_attach        (GstRTSPWatchPool *pool,
+                                                      GstRTSPWatch *watch);
+
 G_END_DECLS
 
 #endif /* __GST_RTSP_CONNECTION_H__ */
@@ -95,6 +95,22 @@
  *     </itemizedlist>
  *   </listitem>
  *   <listitem>
+ *     <itemizedlist><title>Frame threading</title>
+ *     <listitem><para>
+ *   A subclass that implements @decode_frame can split decoding in a serial
+ *   and a parallel part. @handle_frame still gets the frames in decoding order
+ *   in the streaming thread, parses their headers, allocates the output buffer
+ *   and passes the frame to gst_video_decoder_dispatch_frame() together with
+ *   the frames it predicts from. After gst_video_decoder_set_frame_threads(),
+ *   @decode_frame is then called from several threads at once, for every
+ *   frame as soon as its references are decoded, and the decoded frames are
+ *   pushed in the order they were dispatched. Before a flush, a seek or
+ *   @stop the base class waits for the frames that are being decoded and
+ *   drops the others, so @reset and @stop can free the decoder state safely.
+ *     </para></listitem>
+ *     </itemizedlist>
+ *   </listitem>
+ *   <listitem>
  *     <itemizedlist><title>End Of Stream</title>
  *     <listitem><para>
  *   At end-of-stream, the subclass @parse function may be called some final times with the 
@@ -300,6 +316,9 @@
 #include <gst/video/gstvideopool.h>
 #include <gst/video/gstvideometa.h>
 #include <string.h>
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
 
 GST_DEBUG_CATEGORY (videodecoder_debug);
 #define GST_CAT_DEFAULT videodecoder_debug
@@ -308,6 +327,27 @@ GST_DEBUG_CATEGORY (videodecoder_debug);
     (G_TYPE_INSTANCE_GET_PRIVATE ((obj), GST_TYPE_VIDEO_DECODER, \
         GstVideoDecoderPrivate))
 
+#define GST_VIDEO_DECODER_MAX_FRAME_THREADS 64
+
+typedef enum
+{
+  FRAME_JOB_QUEUED,
+  FRAME_JOB_DECODING,
+  FRAME_JOB_DONE
+} GstVideoDecoderFrameJobState;
+
+/* a frame passed to gst_video_decoder_dispatch_frame() */
+typedef struct
+{
+  GstVideoCodecFrame *frame;
+  /* system frame numbers of the frames it is predicted from */
+  guint32 *references;
+  guint n_references;
+
+  GstVideoDecoderFrameJobState state;
+  GstFlowReturn ret;
+} GstVideoDecoderFrameJob;
+
 struct _GstVideoDecoderPrivate
 {
   /* FIXME introduce a context ? */
@@ -402,6 +442,16 @@ struct _GstVideoDecoderPrivate
 
   GstTagList *tags;
   gboolean tags_changed;
+
+  /* frame threading */
+  guint n_frame_threads;        /* OBJECT_LOCK */
+  GThread **frame_workers;      /* STREAM_LOCK */
+  guint n_frame_workers;
+  GMutex frame_lock;
+  GCond frame_cond;
+  gboolean frame_workers_shutdown;
+  /* dispatched frames in decoding order, protected with frame_lock */
+  GQueue frame_jobs;
 };
 
 static GstElementClass *parent_class = NULL;
@@ -443,6 +493,11 @@ static GstFlowReturn gst_video_decoder_flush_parse (GstVideoDecoder * dec,
 
 static void gst_video_decoder_clear_queues (GstVideoDecoder * dec);
 
+static GstFlowReturn gst_video_decoder_output_frame_jobs (GstVideoDecoder *
+    decoder, guint max_queued);
+static void gst_video_decoder_discard_frame_jobs (GstVideoDecoder * decoder);
+static void gst_video_decoder_stop_frame_workers (GstVideoDecoder * decoder);
+
 static gboolean gst_video_decoder_sink_event_default (GstVideoDecoder * decoder,
     GstEvent * event);
 static gboolean gst_video_decoder_src_event_default (GstVideoDecoder * decoder,
@@ -553,6 +608,11 @@ gst_video_decoder_init (GstVideoDecoder * decoder, GstVideoDecoderClass * klass)
   decoder->priv->output_adapter = gst_adapter_new ();
   decoder->priv->packetized = TRUE;
 
+  decoder->priv->n_frame_threads = 1;
+  g_mutex_init (&decoder->priv->frame_lock);
+  g_cond_init (&decoder->priv->frame_cond);
+  g_queue_init (&decoder->priv->frame_jobs);
+
   gst_video_decoder_reset (decoder, TRUE);
 }
 
@@ -802,6 +862,9 @@ gst_video_decoder_finalize (GObject * object)
 
   g_rec_mutex_clear (&decoder->stream_lock);
 
+  g_mutex_clear (&decoder->priv->frame_lock);
+  g_cond_clear (&decoder->priv->frame_cond);
+
   if (decoder->priv->input_adapter) {
     g_object_unref (decoder->priv->input_adapter);
     decoder->priv->input_adapter = NULL;
@@ -841,6 +904,12 @@ gst_video_decoder_flush (GstVideoDecoder * dec, gboolean hard)
 
   GST_LOG_OBJECT (dec, "flush hard %d", hard);
 
+  /* dispatched frames may still use the state the subclass resets */
+  if (hard)
+    gst_video_decoder_discard_frame_jobs (dec);
+  else
+    ret = gst_video_decoder_output_frame_jobs (dec, 0);
+
   /* Inform subclass */
   if (klass->reset)
     klass->reset (dec, hard);
@@ -902,7 +971,7 @@ gst_video_decoder_drain_out (GstVideoDecoder * dec, gboolean at_eos)
 {
   GstVideoDecoderClass *decoder_class = GST_VIDEO_DECODER_GET_CLASS (dec);
   GstVideoDecoderPrivate *priv = dec->priv;
-  GstFlowReturn ret = GST_FLOW_OK;
+  GstFlowReturn ret = GST_FLOW_OK, res;
 
   GST_VIDEO_DECODER_STREAM_LOCK (dec);
 
@@ -923,6 +992,11 @@ gst_video_decoder_drain_out (GstVideoDecoder * dec, gboolean at_eos)
     ret = gst_video_decoder_flush_parse (dec, TRUE);
   }
 
+  /* push the frames that are still being decoded */
+  res = gst_video_decoder_output_frame_jobs (dec, 0);
+  if (ret == GST_FLOW_OK)
+    ret = res;
+
   if (at_eos) {
     if (decoder_class->finish)
       ret = decoder_class->finish (dec);
@@ -2000,6 +2074,12 @@ gst_video_decoder_change_state (GstElement * element, GstStateChange transition)
 
   switch (transition) {
     case GST_STATE_CHANGE_PAUSED_TO_READY:
+      /* no frame may be decoded anymore once the subclass stopped */
+      GST_VIDEO_DECODER_STREAM_LOCK (decoder);
+      gst_video_decoder_discard_frame_jobs (decoder);
+      gst_video_decoder_stop_frame_workers (decoder);
+      GST_VIDEO_DECODER_STREAM_UNLOCK (decoder);
+
       if (decoder_class->stop && !decoder_class->stop (decoder))
         goto stop_failed;
 
@@ -2417,6 +2497,308 @@ done:
   return ret;
 }
 
+/* with frame_lock */
+static gboolean
+gst_video_decoder_frame_job_is_ready (GstVideoDecoder * decoder,
+    GstVideoDecoderFrameJob * job)
+{
+  GList *l;
+  guint i;
+
+  /* references were dispatched before the frame, frames that are not queued
+   * anymore have been pushed already */
+  for (i = 0; i < job->n_references; i++) {
+    for (l = decoder->priv->frame_jobs.head; l->data != job; l = l->next) {
+      GstVideoDecoderFrameJob *ref = l->data;
+
+      if (ref->frame->system_frame_number == job->references[i] &&
+          ref->state != FRAME_JOB_DONE)
+        return FALSE;
+    }
+  }
+  return TRUE;
+}
+
+/* with frame_lock, the oldest queued frame that can be decoded */
+static GstVideoDecoderFrameJob *
+gst_video_decoder_next_frame_job (GstVideoDecoder * decoder)
+{
+  GList *l;
+
+  for (l = decoder->priv->frame_jobs.head; l; l = l->next) {
+    GstVideoDecoderFrameJob *job = l->data;
+
+    if (job->state == FRAME_JOB_QUEUED &&
+        gst_video_decoder_frame_job_is_ready (decoder, job))
+      return job;
+  }
+  return NULL;
+}
+
+static gpointer
+gst_video_decoder_frame_worker (GstVideoDecoder * decoder)
+{
+  GstVideoDecoderPrivate *priv = decoder->priv;
+  GstVideoDecoderClass *decoder_class = GST_VIDEO_DECODER_GET_CLASS (decoder);
+  GstVideoDecoderFrameJob *job;
+  GstFlowReturn ret;
+
+  g_mutex_lock (&priv->frame_lock);
+  while (!priv->frame_workers_shutdown) {
+    job = gst_video_decoder_next_frame_job (decoder);
+    if (job == NULL) {
+      g_cond_wait (&priv->frame_cond, &priv->frame_lock);
+      continue;
+    }
+    job->state = FRAME_JOB_DECODING;
+    g_mutex_unlock (&priv->frame_lock);
+
+    GST_LOG_OBJECT (decoder, "decoding frame %p (sfn:%d)", job->frame,
+        job->frame->system_frame_number);
+    ret = decoder_class->decode_frame (decoder, job->frame);
+
+    g_mutex_lock (&priv->frame_lock);
+    job->ret = ret;
+    job->state = FRAME_JOB_DONE;
+    /* wakes up the frames predicted from this one and the streaming thread */
+    g_cond_broadcast (&priv->frame_cond);
+  }
+  g_mutex_unlock (&priv->frame_lock);
+
+  return NULL;
+}
+
+/* with STREAM_LOCK and no dispatched frames */
+static void
+gst_video_decoder_start_frame_workers (GstVideoDecoder * decoder,
+    guint n_workers)
+{
+  GstVideoDecoderPrivate *priv = decoder->priv;
+  guint i;
+
+  GST_DEBUG_OBJECT (decoder, "starting %u decoding threads", n_workers);
+
+  priv->frame_workers_shutdown = FALSE;
+  priv->n_frame_workers = n_workers;
+  priv->frame_workers = g_new (GThread *, n_workers);
+  for (i = 0; i < n_workers; i++)
+    priv->frame_workers[i] = g_thread_new ("videodecoder",
+        (GThreadFunc) gst_video_decoder_frame_worker, decoder);
+}
+
+/* with STREAM_LOCK and no dispatched frames */
+static void
+gst_video_decoder_stop_frame_workers (GstVideoDecoder * decoder)
+{
+  GstVideoDecoderPrivate *priv = decoder->priv;
+  guint i;
+
+  if (priv->n_frame_workers == 0)
+    return;
+
+  GST_DEBUG_OBJECT (decoder, "stopping %u decoding threads",
+      priv->n_frame_workers);
+
+  g_mutex_lock (&priv->frame_lock);
+  priv->frame_workers_shutdown = TRUE;
+  g_cond_broadcast (&priv->frame_cond);
+  g_mutex_unlock (&priv->frame_lock);
+
+  for (i = 0; i < priv->n_frame_workers; i++)
+    g_thread_join (priv->frame_workers[i]);
+  g_free (priv->frame_workers);
+  priv->frame_workers = NULL;
+  priv->n_frame_workers = 0;
+}
+
+static void
+gst_video_decoder_frame_job_free (GstVideoDecoderFrameJob * job)
+{
+  g_free (job->references);
+  g_slice_free (GstVideoDecoderFrameJob, job);
+}
+
+/* With stream lock, pushes the decoded frames at the head of the queue in
+ * the order they were dispatched and waits for frames until at most
+ * @max_queued are left */
+static GstFlowReturn
+gst_video_decoder_output_frame_jobs (GstVideoDecoder * decoder,
+    guint max_queued)
+{
+  GstVideoDecoderPrivate *priv = decoder->priv;
+  GstVideoDecoderFrameJob *job;
+  GstFlowReturn ret = GST_FLOW_OK, res;
+
+  g_mutex_lock (&priv->frame_lock);
+  while ((job = g_queue_peek_head (&priv->frame_jobs))) {
+    if (job->state != FRAME_JOB_DONE) {
+      if (priv->frame_jobs.length <= max_queued)
+        break;
+      g_cond_wait (&priv->frame_cond, &priv->frame_lock);
+      continue;
+    }
+    g_queue_pop_head (&priv->frame_jobs);
+    g_mutex_unlock (&priv->frame_lock);
+
+    if (job->ret == GST_FLOW_OK) {
+      res = gst_video_decoder_finish_frame (decoder, job->frame);
+    } else {
+      GST_DEBUG_OBJECT (decoder, "frame %p not decoded: %s", job->frame,
+          gst_flow_get_name (job->ret));
+      gst_video_decoder_drop_frame (decoder, job->frame);
+      res = job->ret;
+    }
+    gst_video_decoder_frame_job_free (job);
+    if (ret == GST_FLOW_OK)
+      ret = res;
+
+    g_mutex_lock (&priv->frame_lock);
+  }
+  g_mutex_unlock (&priv->frame_lock);
+
+  return ret;
+}
+
+/* With stream lock, releases all dispatched frames without pushing them,
+ * after the frames that are being decoded are done */
+static void
+gst_video_decoder_discard_frame_jobs (GstVideoDecoder * decoder)
+{
+  GstVideoDecoderPrivate *priv = decoder->priv;
+  GstVideoDecoderFrameJob *job;
+  GQueue jobs;
+  GList *l;
+
+  g_mutex_lock (&priv->frame_lock);
+  for (l = priv->frame_jobs.head; l; l = l->next) {
+    job = l->data;
+    if (job->state == FRAME_JOB_QUEUED) {
+      job->state = FRAME_JOB_DONE;
+      job->ret = GST_FLOW_FLUSHING;
+    }
+  }
+  l = priv->frame_jobs.head;
+  while (l) {
+    job = l->data;
+    if (job->state != FRAME_JOB_DONE) {
+      g_cond_wait (&priv->frame_cond, &priv->frame_lock);
+      l = priv->frame_jobs.head;
+      continue;
+    }
+    l = l->next;
+  }
+  jobs = priv->frame_jobs;
+  g_queue_init (&priv->frame_jobs);
+  g_mutex_unlock (&priv->frame_lock);
+
+  if (jobs.length)
+    GST_DEBUG_OBJECT (decoder, "discarding %u dispatched frames", jobs.length);
+
+  while ((job = g_queue_pop_head (&jobs))) {
+    gst_video_decoder_release_frame (decoder, job->frame);
+    gst_video_decoder_frame_job_free (job);
+  }
+}
+
+/**
+ * gst_video_decoder_dispatch_frame:
+ * @decoder: a #GstVideoDecoder
+ * @frame: (transfer full): a #GstVideoCodecFrame to decode
+ * @references: (array length=n_references) (allow-none): the frames @frame is
+ *     predicted from
+ * @n_references: the number of frames in @references
+ *
+ * Passes @frame to #GstVideoDecoderClass.decode_frame() and finishes it with
+ * the result, like gst_video_decoder_finish_frame() or, if decoding failed,
+ * gst_video_decoder_drop_frame(). The output buffer of @frame must have been
+ * allocated already.
+ *
+ * With more than one frame thread, see gst_video_decoder_set_frame_threads(),
+ * this only queues @frame. It is decoded by one of the frame threads as soon
+ * as the frames in @references are decoded, and pushed after all frames that
+ * were dispatched before it. All @references must have been dispatched
+ * before @frame, or be finished already. Frames may still be pushed while
+ * this function waits for a free frame thread, and the subclass must not
+ * finish frames itself while dispatched frames are pending.
+ *
+ * Returns: a #GstFlowReturn resulting from decoding @frame or from pushing
+ * earlier dispatched frames downstream
+ */
+GstFlowReturn
+gst_video_decoder_dispatch_frame (GstVideoDecoder * decoder,
+    GstVideoCodecFrame * frame, GstVideoCodecFrame ** references,
+    guint n_references)
+{
+  GstVideoDecoderPrivate *priv = decoder->priv;
+  GstVideoDecoderClass *decoder_class;
+  GstVideoDecoderFrameJob *job;
+  GstFlowReturn ret = GST_FLOW_OK, res;
+  guint n_threads, i;
+
+  decoder_class = GST_VIDEO_DECODER_GET_CLASS (decoder);
+
+  g_return_val_if_fail (decoder_class->decode_frame != NULL, GST_FLOW_ERROR);
+  g_return_val_if_fail (n_references == 0 || references != NULL,
+      GST_FLOW_ERROR);
+
+  GST_VIDEO_DECODER_STREAM_LOCK (decoder);
+
+  GST_OBJECT_LOCK (decoder);
+  n_threads = priv->n_frame_threads;
+  GST_OBJECT_UNLOCK (decoder);
+
+  /* one thread means decoding in the streaming thread */
+  if (n_threads < 2)
+    n_threads = 0;
+  if (G_UNLIKELY (n_threads != priv->n_frame_workers)) {
+    ret = gst_video_decoder_output_frame_jobs (decoder, 0);
+    gst_video_decoder_stop_frame_workers (decoder);
+    if (n_threads > 0)
+      gst_video_decoder_start_frame_workers (decoder, n_threads);
+  }
+
+  if (priv->n_frame_workers == 0) {
+    res = decoder_class->decode_frame (decoder, frame);
+    if (res == GST_FLOW_OK) {
+      res = gst_video_decoder_finish_frame (decoder, frame);
+    } else {
+      GST_DEBUG_OBJECT (decoder, "frame %p not decoded: %s", frame,
+          gst_flow_get_name (res));
+      gst_video_decoder_drop_frame (decoder, frame);
+    }
+    if (ret == GST_FLOW_OK)
+      ret = res;
+    goto done;
+  }
+
+  GST_LOG_OBJECT (decoder, "dispatching frame %p (sfn:%d) with %u references",
+      frame, frame->system_frame_number, n_references);
+
+  job = g_slice_new0 (GstVideoDecoderFrameJob);
+  job->frame = frame;
+  job->references = g_new (guint32, n_references);
+  for (i = 0; i < n_references; i++)
+    job->references[i] = references[i]->system_frame_number;
+  job->n_references = n_references;
+  job->state = FRAME_JOB_QUEUED;
+
+  g_mutex_lock (&priv->frame_lock);
+  g_queue_push_tail (&priv->frame_jobs, job);
+  g_cond_broadcast (&priv->frame_cond);
+  g_mutex_unlock (&priv->frame_lock);
+
+  /* keep all threads busy with the next frame */
+  res = gst_video_decoder_output_frame_jobs (decoder,
+      priv->n_frame_workers - 1);
+  if (ret == GST_FLOW_OK)
+    ret = res;
+
+done:
+  GST_VIDEO_DECODER_STREAM_UNLOCK (decoder);
+
+  return ret;
+}
+
 
 /* With stream lock, takes the frame reference */
 static GstFlowReturn
@@ -3342,6 +3724,59 @@ gst_video_decoder_get_latency (GstVideoDecoder * decoder,
   GST_OBJECT_UNLOCK (decoder);
 }
 
+/**
+ * gst_video_decoder_set_frame_threads:
+ * @decoder: a #GstVideoDecoder
+ * @n_threads: the number of frames to decode in parallel, or 0 for one per CPU
+ *
+ * Sets how many frames passed to gst_video_decoder_dispatch_frame() are
+ * decoded at the same time, each by its own thread. The default is 1, which
+ * decodes every frame in the streaming thread. With more threads, a
+ * dispatched frame is pushed up to @n_threads - 1 frames later, which the
+ * subclass should add to the latency it reports with
+ * gst_video_decoder_set_latency(). The new value applies from the next
+ * dispatched frame on.
+ */
+void
+gst_video_decoder_set_frame_threads (GstVideoDecoder * decoder,
+    guint n_threads)
+{
+  if (n_threads == 0) {
+#if GLIB_CHECK_VERSION(2,36,0)
+    n_threads = g_get_num_processors ();
+#elif defined (_SC_NPROCESSORS_ONLN)
+    n_threads = MAX (1, sysconf (_SC_NPROCESSORS_ONLN));
+#else
+    n_threads = 1;
+#endif
+  }
+  n_threads = MIN (n_threads, GST_VIDEO_DECODER_MAX_FRAME_THREADS);
+
+  GST_DEBUG_OBJECT (decoder, "decoding %u frames in parallel", n_threads);
+
+  GST_OBJECT_LOCK (decoder);
+  decoder->priv->n_frame_threads = n_threads;
+  GST_OBJECT_UNLOCK (decoder);
+}
+
+/**
+ * gst_video_decoder_get_frame_threads:
+ * @decoder: a #GstVideoDecoder
+ *
+ * Returns: the number of frames that are decoded at the same time.
+ */
+guint
+gst_video_decoder_get_frame_threads (GstVideoDecoder * decoder)
+{
+  guint n_threads;
+
+  GST_OBJECT_LOCK (decoder);
+  n_threads = decoder->priv->n_frame_threads;
+  GST_OBJECT_UNLOCK (decoder);
+
+  return n_threads;
+}
+
 /**
  * gst_video_decoder_merge_tags:
  * @decoder: a #GstVideoDecoder
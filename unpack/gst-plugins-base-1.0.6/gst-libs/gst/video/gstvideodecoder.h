@@ -241,6 +241,12 @@ struct _GstVideoDecoder
  *                      Propose buffer allocation parameters for upstream elements.
  *                      Subclasses should chain up to the parent implementation to
  *                      invoke the default handler.
+ * @decode_frame:   Optional.
+ *                  Decodes a frame that was passed to
+ *                  gst_video_decoder_dispatch_frame(). With frame threading
+ *                  this is called from one of the decoding threads, without
+ *                  the stream lock and in parallel with other frames, so it
+ *                  must not call back into the base class.
  *
  * Subclasses can override any of the available virtual methods or not, as
  * needed. At minimum @handle_frame needs to be overridden, and @set_format
@@ -289,8 +295,11 @@ struct _GstVideoDecoderClass
 
   gboolean      (*propose_allocation) (GstVideoDecoder *decoder, GstQuery * query);
 
+  GstFlowReturn (*decode_frame)   (GstVideoDecoder *decoder,
+				   GstVideoCodecFrame *frame);
+
   /*< private >*/
-  void         *padding[GST_PADDING_LARGE];
+  void         *padding[GST_PADDING_LARGE-1];
 };
 
 GType    gst_video_decoder_get_type (void);
@@ -323,6 +332,11 @@ void     gst_video_decoder_get_allocator (GstVideoDecoder *decoder,
                                           GstAllocationParams *params);
 GstBufferPool *gst_video_decoder_get_buffer_pool (GstVideoDecoder *decoder);
 
+void     gst_video_decoder_set_frame_threads (GstVideoDecoder *decoder,
+					      guint n_threads);
+
+guint    gst_video_decoder_get_frame_threads (GstVideoDecoder *decoder);
+
 /* Object methods */
 
 GstVideoCodecFrame *gst_video_decoder_get_frame        (GstVideoDecoder *decoder,
@@ -361,6 +375,11 @@ GstFlowReturn    gst_video_decoder_finish_frame (GstVideoDecoder *decoder,
 GstFlowReturn    gst_video_decoder_drop_frame (GstVideoDecoder *dec,
 					       GstVideoCodecFrame *frame);
 
+GstFlowReturn    gst_video_decoder_dispatch_frame (GstVideoDecoder *decoder,
+						   GstVideoCodecFrame *frame,
+						   GstVideoCodecFrame **references,
+						   guint n_references);
+
 void             gst_video_decoder_merge_tags (GstVideoDecoder *dec,
                                                const GstTagList *tags,
                                                GstTagMergeMode mode);
@@ -361,6 +361,54 @@ gst_video_crop_meta_get_info (void)
   return video_crop_meta_info;
 }
 
+static gboolean
+gst_video_scene_meta_transform (GstBuffer * dest, GstMeta * meta,
+    GstBuffer * buffer, GQuark type, gpointer data)
+{
+  GstVideoSceneMeta *dmeta, *smeta;
+
+  /* the metrics don't depend on the frame size, so scaling keeps them */
+  if (GST_META_TRANSFORM_IS_COPY (type) ||
+      GST_VIDEO_META_TRANSFORM_IS_SCALE (type)) {
+    smeta = (GstVideoSceneMeta *) meta;
+    dmeta = gst_buffer_add_video_scene_meta (dest);
+
+    GST_DEBUG ("copy scene metadata");
+    dmeta->difference = smeta->difference;
+    dmeta->histogram_distance = smeta->histogram_distance;
+    dmeta->scene_change = smeta->scene_change;
+  }
+  return TRUE;
+}
+
+GType
+gst_video_scene_meta_api_get_type (void)
+{
+  static volatile GType type = 0;
+  static const gchar *tags[] = { NULL };
+
+  if (g_once_init_enter (&type)) {
+    GType _type = gst_meta_api_type_register ("GstVideoSceneMetaAPI", tags);
+    g_once_init_leave (&type, _type);
+  }
+  return type;
+}
+
+const GstMetaInfo *
+gst_video_scene_meta_get_info (void)
+{
+  static const GstMetaInfo *video_scene_meta_info = NULL;
+
+  if (g_once_init_enter (&video_scene_meta_info)) {
+    const GstMetaInfo *meta =
+        gst_meta_register (GST_VIDEO_SCENE_META_API_TYPE, "GstVideoSceneMeta",
+        sizeof (GstVideoSceneMeta), (GstMetaInitFunction) NULL,
+        (GstMetaFreeFunction) NULL, gst_video_scene_meta_transform);
+    g_once_init_leave (&video_scene_meta_info, meta);
+  }
+  return video_scene_meta_info;
+}
+
 /**
  * gst_video_meta_transform_scale_get_quark:
  *
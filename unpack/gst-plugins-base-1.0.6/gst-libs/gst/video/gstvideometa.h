@@ -34,6 +34,10 @@ typedef struct _GstVideoMeta GstVideoMeta;
 #define GST_VIDEO_CROP_META_INFO  (gst_video_crop_meta_get_info())
 typedef struct _GstVideoCropMeta GstVideoCropMeta;
 
+#define GST_VIDEO_SCENE_META_API_TYPE  (gst_video_scene_meta_api_get_type())
+#define GST_VIDEO_SCENE_META_INFO  (gst_video_scene_meta_get_info())
+typedef struct _GstVideoSceneMeta GstVideoSceneMeta;
+
 /**
  * GstVideoMeta:
  * @meta: parent #GstMeta
@@ -115,6 +119,34 @@ const GstMetaInfo * gst_video_crop_meta_get_info (void);
 #define gst_buffer_get_video_crop_meta(b) ((GstVideoCropMeta*)gst_buffer_get_meta((b),GST_VIDEO_CROP_META_API_TYPE))
 #define gst_buffer_add_video_crop_meta(b) ((GstVideoCropMeta*)gst_buffer_add_meta((b),GST_VIDEO_CROP_META_INFO, NULL))
 
+/**
+ * GstVideoSceneMeta:
+ * @meta: parent #GstMeta
+ * @difference: the mean absolute difference of the downsampled luma with
+ *     the previous output frame, from 0.0 to 255.0
+ * @histogram_distance: the distance between the histograms of the average
+ *     luma of the cells of a 32x32 grid over this and the previous output
+ *     frame, from 0.0 (same) to 1.0 (disjoint)
+ * @scene_change: %TRUE when the frame starts a new scene
+ *
+ * Extra buffer metadata describing how much a frame differs from the frame
+ * output before it by the element that added the metadata, which is not
+ * necessarily the previous frame of the input stream.
+ */
+struct _GstVideoSceneMeta {
+  GstMeta       meta;
+
+  gdouble       difference;
+  gdouble       histogram_distance;
+  gboolean      scene_change;
+};
+
+GType gst_video_scene_meta_api_get_type (void);
+const GstMetaInfo * gst_video_scene_meta_get_info (void);
+
+#define gst_buffer_get_video_scene_meta(b) ((GstVideoSceneMeta*)gst_buffer_get_meta((b),GST_VIDEO_SCENE_META_API_TYPE))
+#define gst_buffer_add_video_scene_meta(b) ((GstVideoSceneMeta*)gst_buffer_add_meta((b),GST_VIDEO_SCENE_META_INFO, NULL))
+
 /* video metadata transforms */
 
 GQuark gst_video_meta_transform_scale_get_quark (void);
@@ -17,9 +17,24 @@
  * Boston, MA 02111-1307, USA.
  */
 
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
 #include "gst/video/gstvideometa.h"
 #include "gst/video/gstvideopool.h"
 
+#include <string.h>
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+#ifdef HAVE_SYS_MMAN_H
+#include <sys/mman.h>
+#endif
+#ifdef HAVE_SYS_RESOURCE_H
+#include <sys/resource.h>
+#endif
+
 /**
  * gst_buffer_pool_config_set_video_alignment:
  * @config: a #GstStructure
@@ -74,6 +89,504 @@ gst_buffer_pool_config_get_video_alignment (GstStructure * config,
       "stride-align3", G_TYPE_UINT, &align->stride_align[3], NULL);
 }
 
+/* video memory cache
+ *
+ * Video frames are large and come and go in bursts: every caps change
+ * destroys the buffer pools along the pipeline together with their memory,
+ * and creates new pools that allocate and page fault all of it again. The
+ * memory of the video buffer pools therefore comes from blocks of a few
+ * size classes that are kept in a process-wide cache when their memory is
+ * freed, and recycled by the next pool that asks for a block of the same
+ * class. New blocks are mapped directly, on huge pages if they are large
+ * enough, and prefaulted, so that the faults happen when a pool is
+ * activated and not while the frame is written.
+ *
+ * Keeping unused frames around costs memory that small devices don't have,
+ * so the cache keeps nothing until the application gives it a size with
+ * gst_video_memory_cache_set_max_size().
+ */
+#define DEFAULT_CACHE_MAX_SIZE 0
+#define HUGE_PAGE_SIZE (2 * 1024 * 1024)
+
+typedef struct
+{
+  guint8 *data;
+  /* the size class */
+  gsize size;
+  /* the mapping, which can be larger with hugetlb pages */
+  gsize map_size;
+  gboolean huge_pages;
+} GstVideoMemoryBlock;
+
+/* unused blocks, least recently used first */
+static GMutex cache_lock;
+static GQueue cache_blocks = G_QUEUE_INIT;
+static gsize cache_size;
+static gsize cache_max_size = DEFAULT_CACHE_MAX_SIZE;
+static GstVideoMemoryCacheStats cache_stats;
+static gboolean hugetlb_unavailable;
+
+static gsize
+video_memory_page_size (void)
+{
+  static volatile gsize page_size = 0;
+
+  if (g_once_init_enter (&page_size)) {
+    gsize size = 4096;
+
+#if defined (HAVE_UNISTD_H) && defined (_SC_PAGESIZE)
+    size = sysconf (_SC_PAGESIZE);
+#endif
+    g_once_init_leave (&page_size, size);
+  }
+  return page_size;
+}
+
+/* rounds up to a multiple of a quarter of the largest power of two below
+ * @size, so that similar frame sizes share a class and at most 25% is
+ * wasted */
+static gsize
+video_memory_size_class (gsize size)
+{
+  gsize granule = video_memory_page_size ();
+  guint bits = g_bit_storage (size);
+
+  if (bits > 3 && ((gsize) 1 << (bits - 3)) > granule)
+    granule = (gsize) 1 << (bits - 3);
+
+  return (size + granule - 1) & ~(granule - 1);
+}
+
+static guint64
+video_memory_get_page_faults (void)
+{
+#if defined (HAVE_SYS_RESOURCE_H) && defined (RUSAGE_THREAD)
+  struct rusage usage;
+
+  if (getrusage (RUSAGE_THREAD, &usage) == 0)
+    return usage.ru_minflt;
+#endif
+  return 0;
+}
+
+static void
+video_memory_block_free (GstVideoMemoryBlock * block)
+{
+#ifdef HAVE_SYS_MMAN_H
+  munmap (block->data, block->map_size);
+#else
+  g_free (block->data);
+#endif
+  g_slice_free (GstVideoMemoryBlock, block);
+}
+
+static GstVideoMemoryBlock *
+video_memory_block_new (gsize size)
+{
+  GstVideoMemoryBlock *block;
+  gsize page_size = video_memory_page_size ();
+  gsize i;
+
+  block = g_slice_new0 (GstVideoMemoryBlock);
+  block->size = size;
+  block->map_size = size;
+
+#ifdef HAVE_SYS_MMAN_H
+  if (size >= HUGE_PAGE_SIZE) {
+    gpointer map;
+    gsize map_size, head;
+
+#ifdef MAP_HUGETLB
+    /* only works when the system reserved hugetlb pages, don't try again
+     * after it failed once */
+    if (!g_atomic_int_get (&hugetlb_unavailable)) {
+      map_size = GST_ROUND_UP_N (size, HUGE_PAGE_SIZE);
+      map = mmap (NULL, map_size, PROT_READ | PROT_WRITE,
+          MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+      if (map != MAP_FAILED) {
+        block->data = map;
+        block->map_size = map_size;
+        block->huge_pages = TRUE;
+      } else {
+        GST_DEBUG ("no hugetlb pages, using transparent huge pages");
+        g_atomic_int_set (&hugetlb_unavailable, TRUE);
+      }
+    }
+#endif
+
+    if (block->data == NULL) {
+      /* map a huge page more and cut it down to a huge page boundary, where
+       * transparent huge pages can back it */
+      map_size = size + HUGE_PAGE_SIZE;
+      map = mmap (NULL, map_size, PROT_READ | PROT_WRITE,
+          MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+      if (map == MAP_FAILED)
+        goto no_memory;
+
+      block->data = (guint8 *) GST_ROUND_UP_N ((guintptr) map, HUGE_PAGE_SIZE);
+      head = block->data - (guint8 *) map;
+      if (head)
+        munmap (map, head);
+      munmap (block->data + size, map_size - head - size);
+#ifdef MADV_HUGEPAGE
+      if (madvise (block->data, size, MADV_HUGEPAGE) == 0)
+        block->huge_pages = TRUE;
+#endif
+    }
+  } else {
+    gpointer map = mmap (NULL, size, PROT_READ | PROT_WRITE,
+        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+    if (map == MAP_FAILED)
+      goto no_memory;
+    block->data = map;
+  }
+#else
+  block->data = g_try_malloc (size);
+  if (block->data == NULL)
+    goto no_memory;
+#endif
+
+  /* prefault */
+  for (i = 0; i < block->map_size; i += page_size)
+    ((volatile guint8 *) block->data)[i] = 0;
+
+  return block;
+
+  /* ERRORS */
+no_memory:
+  {
+    GST_WARNING ("failed to allocate %" G_GSIZE_FORMAT " bytes", size);
+    g_slice_free (GstVideoMemoryBlock, block);
+    return NULL;
+  }
+}
+
+/* a block of @size, which is a size class */
+static GstVideoMemoryBlock *
+video_memory_cache_acquire (gsize size)
+{
+  GstVideoMemoryBlock *block = NULL;
+  GstClockTime start, elapsed;
+  guint64 page_faults = 0;
+  gboolean hit = FALSE;
+  GList *l;
+
+  start = gst_util_get_timestamp ();
+
+  g_mutex_lock (&cache_lock);
+  for (l = cache_blocks.tail; l; l = l->prev) {
+    if (((GstVideoMemoryBlock *) l->data)->size == size) {
+      block = l->data;
+      g_queue_delete_link (&cache_blocks, l);
+      cache_size -= size;
+      hit = TRUE;
+      break;
+    }
+  }
+  g_mutex_unlock (&cache_lock);
+
+  if (block == NULL) {
+    page_faults = video_memory_get_page_faults ();
+    block = video_memory_block_new (size);
+    page_faults = video_memory_get_page_faults () - page_faults;
+    if (block == NULL)
+      return NULL;
+  }
+
+  elapsed = gst_util_get_timestamp () - start;
+
+  GST_LOG ("block %p of %" G_GSIZE_FORMAT " bytes, %s, %" G_GUINT64_FORMAT
+      " page faults, %" GST_TIME_FORMAT, block, size,
+      hit ? "cached" : "new", page_faults, GST_TIME_ARGS (elapsed));
+
+  g_mutex_lock (&cache_lock);
+  cache_stats.allocs++;
+  if (hit)
+    cache_stats.hits++;
+  else if (block->huge_pages)
+    cache_stats.huge_page_allocs++;
+  cache_stats.page_faults += page_faults;
+  cache_stats.alloc_time += elapsed;
+  cache_stats.max_alloc_time = MAX (cache_stats.max_alloc_time, elapsed);
+  g_mutex_unlock (&cache_lock);
+
+  return block;
+}
+
+/* with cache_lock, returns the blocks to free */
+static GList *
+video_memory_cache_evict (gsize max_size)
+{
+  GList *evicted = NULL;
+
+  while (cache_size > max_size) {
+    GstVideoMemoryBlock *block = g_queue_pop_head (&cache_blocks);
+
+    cache_size -= block->size;
+    evicted = g_list_prepend (evicted, block);
+  }
+  return evicted;
+}
+
+static void
+video_memory_cache_release (GstVideoMemoryBlock * block)
+{
+  GList *evicted;
+
+  g_mutex_lock (&cache_lock);
+  g_queue_push_tail (&cache_blocks, block);
+  cache_size += block->size;
+  evicted = video_memory_cache_evict (cache_max_size);
+  g_mutex_unlock (&cache_lock);
+
+  g_list_free_full (evicted, (GDestroyNotify) video_memory_block_free);
+}
+
+typedef struct
+{
+  GstMemory mem;
+
+  GstVideoMemoryBlock *block;
+  guint8 *data;
+} GstVideoCacheMemory;
+
+typedef struct
+{
+  GstAllocator parent;
+} GstVideoCacheAllocator;
+
+typedef struct
+{
+  GstAllocatorClass parent_class;
+} GstVideoCacheAllocatorClass;
+
+static GType gst_video_cache_allocator_get_type (void);
+G_DEFINE_TYPE (GstVideoCacheAllocator, gst_video_cache_allocator,
+    GST_TYPE_ALLOCATOR);
+
+static GstMemory *
+gst_video_cache_allocator_alloc (GstAllocator * allocator, gsize size,
+    GstAllocationParams * params)
+{
+  GstVideoCacheMemory *mem;
+  GstVideoMemoryBlock *block;
+  gsize maxsize, align, aoffset, padding;
+  guint8 *data;
+
+  align = params->align | gst_memory_alignment;
+  maxsize = size + params->prefix + params->padding;
+
+  block = video_memory_cache_acquire (video_memory_size_class (maxsize +
+          align));
+  if (block == NULL)
+    return NULL;
+
+  data = block->data;
+  if ((aoffset = ((guintptr) data & align)))
+    aoffset = (align + 1) - aoffset;
+  data += aoffset;
+  maxsize = block->size - aoffset;
+
+  /* recycled blocks are not cleared, like memory from the default
+   * allocator, only what the flags ask for */
+  if (params->prefix && (params->flags & GST_MEMORY_FLAG_ZERO_PREFIXED))
+    memset (data, 0, params->prefix);
+  padding = maxsize - (params->prefix + size);
+  if (padding && (params->flags & GST_MEMORY_FLAG_ZERO_PADDED))
+    memset (data + params->prefix + size, 0, padding);
+
+  mem = g_slice_new (GstVideoCacheMemory);
+  gst_memory_init (GST_MEMORY_CAST (mem), params->flags, allocator, NULL,
+      maxsize, align, params->prefix, size);
+  mem->block = block;
+  mem->data = data;
+
+  return GST_MEMORY_CAST (mem);
+}
+
+static void
+gst_video_cache_allocator_free (GstAllocator * allocator, GstMemory * memory)
+{
+  GstVideoCacheMemory *mem = (GstVideoCacheMemory *) memory;
+
+  /* shared memory keeps its parent, which owns the block, alive */
+  if (memory->parent == NULL)
+    video_memory_cache_release (mem->block);
+
+  g_slice_free (GstVideoCacheMemory, mem);
+}
+
+static gpointer
+gst_video_cache_mem_map (GstVideoCacheMemory * mem, gsize maxsize,
+    GstMapFlags flags)
+{
+  return mem->data;
+}
+
+static gboolean
+gst_video_cache_mem_unmap (GstVideoCacheMemory * mem)
+{
+  return TRUE;
+}
+
+static GstVideoCacheMemory *
+gst_video_cache_mem_share (GstVideoCacheMemory * mem, gssize offset,
+    gsize size)
+{
+  GstVideoCacheMemory *sub;
+  GstMemory *parent;
+
+  /* find the real parent */
+  if ((parent = mem->mem.parent) == NULL)
+    parent = (GstMemory *) mem;
+
+  if (size == -1)
+    size = mem->mem.size - offset;
+
+  /* the shared memory is always readonly */
+  sub = g_slice_new (GstVideoCacheMemory);
+  gst_memory_init (GST_MEMORY_CAST (sub), GST_MINI_OBJECT_FLAGS (parent) |
+      GST_MINI_OBJECT_FLAG_LOCK_READONLY, mem->mem.allocator, parent,
+      mem->mem.maxsize, mem->mem.align, mem->mem.offset + offset, size);
+  sub->block = mem->block;
+  sub->data = mem->data;
+
+  return sub;
+}
+
+static gboolean
+gst_video_cache_mem_is_span (GstVideoCacheMemory * mem1,
+    GstVideoCacheMemory * mem2, gsize * offset)
+{
+  if (offset) {
+    GstVideoCacheMemory *parent;
+
+    parent = (GstVideoCacheMemory *) mem1->mem.parent;
+
+    *offset = mem1->mem.offset - parent->mem.offset;
+  }
+
+  /* and memory is contiguous */
+  return mem1->data + mem1->mem.offset + mem1->mem.size ==
+      mem2->data + mem2->mem.offset;
+}
+
+static void
+gst_video_cache_allocator_class_init (GstVideoCacheAllocatorClass * klass)
+{
+  GstAllocatorClass *allocator_class = (GstAllocatorClass *) klass;
+
+  allocator_class->alloc = gst_video_cache_allocator_alloc;
+  allocator_class->free = gst_video_cache_allocator_free;
+}
+
+static void
+gst_video_cache_allocator_init (GstVideoCacheAllocator * allocator)
+{
+  GstAllocator *alloc = GST_ALLOCATOR_CAST (allocator);
+
+  alloc->mem_type = GST_VIDEO_MEMORY_CACHE_NAME;
+  alloc->mem_map = (GstMemoryMapFunction) gst_video_cache_mem_map;
+  alloc->mem_unmap = (GstMemoryUnmapFunction) gst_video_cache_mem_unmap;
+  alloc->mem_share = (GstMemoryShareFunction) gst_video_cache_mem_share;
+  alloc->mem_is_span = (GstMemoryIsSpanFunction) gst_video_cache_mem_is_span;
+}
+
+static GstAllocator *
+gst_video_cache_allocator_get (void)
+{
+  static volatile gsize allocator = 0;
+
+  if (g_once_init_enter (&allocator)) {
+    GstAllocator *alloc;
+
+    alloc = g_object_new (gst_video_cache_allocator_get_type (), NULL);
+    gst_allocator_register (GST_VIDEO_MEMORY_CACHE_NAME, gst_object_ref (alloc));
+    g_once_init_leave (&allocator, (gsize) alloc);
+  }
+  return (GstAllocator *) allocator;
+}
+
+/**
+ * gst_video_memory_cache_get_stats:
+ * @stats: (out caller-allocates): a #GstVideoMemoryCacheStats
+ *
+ * Fills @stats with the counters of the video memory cache that the
+ * memory of #GstVideoBufferPool comes from, when no other allocator is
+ * configured.
+ */
+void
+gst_video_memory_cache_get_stats (GstVideoMemoryCacheStats * stats)
+{
+  g_return_if_fail (stats != NULL);
+
+  g_mutex_lock (&cache_lock);
+  *stats = cache_stats;
+  stats->cached_size = cache_size;
+  g_mutex_unlock (&cache_lock);
+}
+
+/**
+ * gst_video_memory_cache_set_max_size:
+ * @max_size: the maximum size in bytes
+ *
+ * Sets how many bytes of unused video memory the cache keeps for the next
+ * pools, at most. Older blocks are freed first. With 0, memory is freed as
+ * soon as it is not used anymore. The default is 0, the cache is only used
+ * when the application sets a size.
+ *
+ * Recycled memory is not cleared, like memory from the default allocator.
+ * It can still contain frames of other pipelines of the process.
+ */
+void
+gst_video_memory_cache_set_max_size (gsize max_size)
+{
+  GList *evicted;
+
+  g_mutex_lock (&cache_lock);
+  cache_max_size = max_size;
+  evicted = video_memory_cache_evict (max_size);
+  g_mutex_unlock (&cache_lock);
+
+  g_list_free_full (evicted, (GDestroyNotify) video_memory_block_free);
+}
+
+/**
+ * gst_video_memory_cache_get_max_size:
+ *
+ * Returns: how many bytes of unused video memory the cache keeps at most.
+ */
+gsize
+gst_video_memory_cache_get_max_size (void)
+{
+  gsize max_size;
+
+  g_mutex_lock (&cache_lock);
+  max_size = cache_max_size;
+  g_mutex_unlock (&cache_lock);
+
+  return max_size;
+}
+
+/**
+ * gst_video_memory_cache_trim:
+ *
+ * Frees all unused memory in the video memory cache, for example after
+ * the pipelines were stopped.
+ */
+void
+gst_video_memory_cache_trim (void)
+{
+  GList *evicted;
+
+  g_mutex_lock (&cache_lock);
+  evicted = video_memory_cache_evict (0);
+  g_mutex_unlock (&cache_lock);
+
+  g_list_free_full (evicted, (GDestroyNotify) video_memory_block_free);
+}
+
 /* bufferpool */
 struct _GstVideoBufferPoolPrivate
 {
@@ -84,6 +597,8 @@ struct _GstVideoBufferPoolPrivate
   gboolean need_alignment;
   GstAllocator *allocator;
   GstAllocationParams params;
+  /* allocate from the video memory cache */
+  gboolean use_cache;
 };
 
 static void gst_video_buffer_pool_finalize (GObject * object);
@@ -141,6 +656,8 @@ video_buffer_pool_set_config (GstBufferPool * pool, GstStructure * config)
     gst_object_unref (priv->allocator);
   if ((priv->allocator = allocator))
     gst_object_ref (allocator);
+  priv->use_cache = allocator == NULL ||
+      g_strcmp0 (allocator->mem_type, GST_ALLOCATOR_SYSMEM) == 0;
 
   /* enable metadata based on config of the pool */
   priv->add_videometa =
@@ -191,8 +708,9 @@ video_buffer_pool_alloc (GstBufferPool * pool, GstBuffer ** buffer,
 
   GST_DEBUG_OBJECT (pool, "alloc %" G_GSIZE_FORMAT, info->size);
 
-  *buffer =
-      gst_buffer_new_allocate (priv->allocator, info->size, &priv->params);
+  *buffer = gst_buffer_new_allocate (priv->use_cache ?
+      gst_video_cache_allocator_get () : priv->allocator, info->size,
+      &priv->params);
   if (*buffer == NULL)
     goto no_memory;
 
@@ -75,6 +75,52 @@ GType             gst_video_buffer_pool_get_type      (void);
 
 GstBufferPool *   gst_video_buffer_pool_new           (void);
 
+/* video memory cache */
+
+/**
+ * GST_VIDEO_MEMORY_CACHE_NAME:
+ *
+ * The name of the allocator that gives out the memory of the video memory
+ * cache, see gst_allocator_find().
+ */
+#define GST_VIDEO_MEMORY_CACHE_NAME "VideoMemoryCache"
+
+typedef struct _GstVideoMemoryCacheStats GstVideoMemoryCacheStats;
+
+/**
+ * GstVideoMemoryCacheStats:
+ * @allocs: the number of memory blocks given out
+ * @hits: how many of @allocs were recycled from the cache
+ * @huge_page_allocs: the number of new blocks backed by huge pages
+ * @page_faults: the minor page faults taken to create and prefault new blocks
+ * @alloc_time: the total time spent giving out blocks
+ * @max_alloc_time: the longest time spent giving out one block
+ * @cached_size: the size in bytes of the unused blocks in the cache
+ *
+ * Counters of the video memory cache since the process started.
+ */
+struct _GstVideoMemoryCacheStats
+{
+  guint64      allocs;
+  guint64      hits;
+  guint64      huge_page_allocs;
+  guint64      page_faults;
+  GstClockTime alloc_time;
+  GstClockTime max_alloc_time;
+  gsize        cached_size;
+
+  /*< private >*/
+  gpointer _gst_reserved[GST_PADDING];
+};
+
+void              gst_video_memory_cache_get_stats    (GstVideoMemoryCacheStats *stats);
+
+void              gst_video_memory_cache_set_max_size (gsize max_size);
+
+gsize             gst_video_memory_cache_get_max_size (void);
+
+void              gst_video_memory_cache_trim         (void);
+
 G_END_DECLS
 
 #endif /* __GST_VIDEO_POOL_H__ */
@@ -0,0 +1,737 @@
+/* GStreamer
+ *
+ * video-converter.c: convert and scale video frames in one pass
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/**
+ * SECTION:gstvideoconverter
+ * @short_description: Convert and scale video frames in one pass
+ *
+ * A #GstVideoConverter converts video frames to another format, colorimetry
+ * and size. It works on one output line at a time: the few source lines that
+ * are needed for it are unpacked and scaled horizontally, merged vertically,
+ * converted to the output colorimetry and packed into the output frame.
+ * Source lines are kept for as long as they are needed for the next output
+ * lines, so each source line is unpacked at most once and no intermediate
+ * frame is ever written to memory.
+ *
+ * Converting a frame to the same format and size is a plain copy, use
+ * gst_video_frame_copy() for that.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "video-converter.h"
+
+#include <string.h>
+#include <math.h>
+
+#ifndef GST_DISABLE_GST_DEBUG
+
+#define GST_CAT_DEFAULT ensure_debug_category()
+
+static GstDebugCategory *
+ensure_debug_category (void)
+{
+  static gsize cat_gonce = 0;
+
+  if (g_once_init_enter (&cat_gonce)) {
+    gsize cat_done;
+
+    cat_done = (gsize) _gst_debug_category_new ("video-converter", 0,
+        "video converter");
+
+    g_once_init_leave (&cat_gonce, cat_done);
+  }
+
+  return (GstDebugCategory *) cat_gonce;
+}
+
+#else
+
+#define ensure_debug_category() /* NOOP */
+
+#endif /* GST_DISABLE_GST_DEBUG */
+
+/* precision of the 4-tap filter coefficients */
+#define SHIFT 10
+
+/* the unpack and pack functions can touch a few pixels past the width */
+#define LINE_PADDING 8
+
+#define TO_16(x) (((x)<<8) | (x))
+
+struct _GstVideoConverter
+{
+  GstVideoInfo in_info;
+  GstVideoInfo out_info;
+  GstVideoResampleMethod method;
+
+  gint in_width;
+  gint in_height;
+  gint out_width;
+  gint out_height;
+
+  gint in_bits;
+  gint out_bits;
+  /* the lines are processed with 16 bits per component */
+  gboolean bits16;
+
+  /* colorimetry conversion, NULL when the colorimetry is kept */
+  void (*matrix) (GstVideoConverter * convert, gpointer pixels);
+  gint cmatrix[3][4];
+
+  /* scaling, in 16.16 fixed point source pixels */
+  gint x_increment;
+  gint x_start;
+  gint y_increment;
+  gint y_start;
+  gint16 taps[256][4];
+
+  void (*hresample) (GstVideoConverter * convert, gpointer dest,
+      gconstpointer src);
+  void (*vmerge) (GstVideoConverter * convert, gpointer dest,
+      gpointer lines[4], gint frac);
+
+  /* one unpacked source line */
+  gpointer unpack_line;
+  /* the last 4 source lines that were scaled horizontally, indexed by the
+   * source line modulo 4 */
+  gpointer lines[4];
+  gint line_nr[4];
+  /* the output line being built */
+  gpointer out_line;
+};
+
+static gdouble
+sinc (gdouble x)
+{
+  if (x == 0)
+    return 1;
+  return sin (G_PI * x) / (G_PI * x);
+}
+
+static void
+init_taps (GstVideoConverter * convert)
+{
+  gint i;
+  gdouble a, b, c, d, sum;
+
+  for (i = 0; i < 256; i++) {
+    a = sinc (-1 - i / 256.0);
+    b = sinc (0 - i / 256.0);
+    c = sinc (1 - i / 256.0);
+    d = sinc (2 - i / 256.0);
+    sum = a + b + c + d;
+
+    convert->taps[i][0] = rint ((1 << SHIFT) * (a / sum));
+    convert->taps[i][1] = rint ((1 << SHIFT) * (b / sum));
+    convert->taps[i][2] = rint ((1 << SHIFT) * (c / sum));
+    convert->taps[i][3] = rint ((1 << SHIFT) * (d / sum));
+  }
+}
+
+/* scaling kernels on lines of 4 components per pixel, the same for 8 and
+ * 16 bits per component */
+#define DEFINE_RESAMPLE(type,bits,maxval)                                     \
+static void                                                                   \
+hresample_nearest_##bits (GstVideoConverter * convert, gpointer dest,         \
+    gconstpointer src)                                                        \
+{                                                                             \
+  type *d = dest;                                                             \
+  const type *s = src;                                                        \
+  gint i, j, acc = convert->x_start;                                          \
+                                                                              \
+  for (i = 0; i < convert->out_width; i++) {                                  \
+    j = CLAMP ((acc + 0x8000) >> 16, 0, convert->in_width - 1);               \
+    d[i * 4 + 0] = s[j * 4 + 0];                                              \
+    d[i * 4 + 1] = s[j * 4 + 1];                                              \
+    d[i * 4 + 2] = s[j * 4 + 2];                                              \
+    d[i * 4 + 3] = s[j * 4 + 3];                                              \
+    acc += convert->x_increment;                                              \
+  }                                                                           \
+}                                                                             \
+                                                                              \
+static void                                                                   \
+hresample_linear_##bits (GstVideoConverter * convert, gpointer dest,          \
+    gconstpointer src)                                                        \
+{                                                                             \
+  type *d = dest;                                                             \
+  const type *s = src;                                                        \
+  gint i, k, j0, j1, x, acc = convert->x_start;                               \
+  gint last = convert->in_width - 1;                                          \
+                                                                              \
+  for (i = 0; i < convert->out_width; i++) {                                  \
+    j0 = acc >> 16;                                                           \
+    x = (acc >> 8) & 0xff;                                                    \
+    j1 = CLAMP (j0 + 1, 0, last);                                             \
+    j0 = CLAMP (j0, 0, last);                                                 \
+    for (k = 0; k < 4; k++)                                                   \
+      d[i * 4 + k] = (s[j0 * 4 + k] * (256 - x) + s[j1 * 4 + k] * x +         \
+          128) >> 8;                                                          \
+    acc += convert->x_increment;                                              \
+  }                                                                           \
+}                                                                             \
+                                                                              \
+static void                                                                   \
+hresample_4tap_##bits (GstVideoConverter * convert, gpointer dest,            \
+    gconstpointer src)                                                        \
+{                                                                             \
+  type *d = dest;                                                             \
+  const type *s = src;                                                        \
+  gint i, k, j, v, acc = convert->x_start;                                    \
+  gint last = convert->in_width - 1;                                          \
+  gint j0, j1, j2, j3;                                                        \
+  const gint16 *t;                                                            \
+                                                                              \
+  for (i = 0; i < convert->out_width; i++) {                                  \
+    j = acc >> 16;                                                            \
+    t = convert->taps[(acc >> 8) & 0xff];                                     \
+    j0 = CLAMP (j - 1, 0, last);                                              \
+    j1 = CLAMP (j, 0, last);                                                  \
+    j2 = CLAMP (j + 1, 0, last);                                              \
+    j3 = CLAMP (j + 2, 0, last);                                              \
+    for (k = 0; k < 4; k++) {                                                 \
+      v = t[0] * s[j0 * 4 + k] + t[1] * s[j1 * 4 + k] +                       \
+          t[2] * s[j2 * 4 + k] + t[3] * s[j3 * 4 + k];                        \
+      v = (v + (1 << (SHIFT - 1))) >> SHIFT;                                  \
+      d[i * 4 + k] = CLAMP (v, 0, maxval);                                    \
+    }                                                                         \
+    acc += convert->x_increment;                                              \
+  }                                                                           \
+}                                                                             \
+                                                                              \
+static void                                                                   \
+vmerge_nearest_##bits (GstVideoConverter * convert, gpointer dest,            \
+    gpointer lines[4], gint frac)                                             \
+{                                                                             \
+  memcpy (dest, lines[0], convert->out_width * 4 * sizeof (type));            \
+}                                                                             \
+                                                                              \
+static void                                                                   \
+vmerge_linear_##bits (GstVideoConverter * convert, gpointer dest,             \
+    gpointer lines[4], gint frac)                                             \
+{                                                                             \
+  type *d = dest;                                                             \
+  const type *s0 = lines[0], *s1 = lines[1];                                  \
+  gint i, x = (frac >> 8) & 0xff;                                             \
+                                                                              \
+  for (i = 0; i < convert->out_width * 4; i++)                                \
+    d[i] = (s0[i] * (256 - x) + s1[i] * x + 128) >> 8;                        \
+}                                                                             \
+                                                                              \
+static void                                                                   \
+vmerge_4tap_##bits (GstVideoConverter * convert, gpointer dest,               \
+    gpointer lines[4], gint frac)                                             \
+{                                                                             \
+  type *d = dest;                                                             \
+  const type *s0 = lines[0], *s1 = lines[1], *s2 = lines[2], *s3 = lines[3];  \
+  const gint16 *t = convert->taps[(frac >> 8) & 0xff];                        \
+  gint i, v;                                                                  \
+                                                                              \
+  for (i = 0; i < convert->out_width * 4; i++) {                              \
+    v = t[0] * s0[i] + t[1] * s1[i] + t[2] * s2[i] + t[3] * s3[i];            \
+    v = (v + (1 << (SHIFT - 1))) >> SHIFT;                                    \
+    d[i] = CLAMP (v, 0, maxval);                                              \
+  }                                                                           \
+}
+
+DEFINE_RESAMPLE (guint8, 8, 255)
+DEFINE_RESAMPLE (guint16, 16, 65535)
+
+static void
+matrix_8 (GstVideoConverter * convert, gpointer pixels)
+{
+  guint8 *p = pixels;
+  gint i, r, g, b, y, u, v;
+
+  for (i = 0; i < convert->out_width; i++) {
+    r = p[i * 4 + 1];
+    g = p[i * 4 + 2];
+    b = p[i * 4 + 3];
+
+    y = (convert->cmatrix[0][0] * r + convert->cmatrix[0][1] * g +
+        convert->cmatrix[0][2] * b + convert->cmatrix[0][3]) >> 8;
+    u = (convert->cmatrix[1][0] * r + convert->cmatrix[1][1] * g +
+        convert->cmatrix[1][2] * b + convert->cmatrix[1][3]) >> 8;
+    v = (convert->cmatrix[2][0] * r + convert->cmatrix[2][1] * g +
+        convert->cmatrix[2][2] * b + convert->cmatrix[2][3]) >> 8;
+
+    p[i * 4 + 1] = CLAMP (y, 0, 255);
+    p[i * 4 + 2] = CLAMP (u, 0, 255);
+    p[i * 4 + 3] = CLAMP (v, 0, 255);
+  }
+}
+
+static void
+matrix_16 (GstVideoConverter * convert, gpointer pixels)
+{
+  guint16 *p = pixels;
+  gint i, r, g, b, y, u, v;
+
+  for (i = 0; i < convert->out_width; i++) {
+    r = p[i * 4 + 1];
+    g = p[i * 4 + 2];
+    b = p[i * 4 + 3];
+
+    y = (convert->cmatrix[0][0] * r + convert->cmatrix[0][1] * g +
+        convert->cmatrix[0][2] * b + convert->cmatrix[0][3]) >> 8;
+    u = (convert->cmatrix[1][0] * r + convert->cmatrix[1][1] * g +
+        convert->cmatrix[1][2] * b + convert->cmatrix[1][3]) >> 8;
+    v = (convert->cmatrix[2][0] * r + convert->cmatrix[2][1] * g +
+        convert->cmatrix[2][2] * b + convert->cmatrix[2][3]) >> 8;
+
+    p[i * 4 + 1] = CLAMP (y, 0, 65535);
+    p[i * 4 + 2] = CLAMP (u, 0, 65535);
+    p[i * 4 + 3] = CLAMP (v, 0, 65535);
+  }
+}
+
+typedef struct
+{
+  gdouble m[4][4];
+} MatrixData;
+
+static void
+color_matrix_set_identity (MatrixData * m)
+{
+  gint i, j;
+
+  for (i = 0; i < 4; i++)
+    for (j = 0; j < 4; j++)
+      m->m[i][j] = (i == j);
+}
+
+/* dst = a * b, dst may be a or b */
+static void
+color_matrix_multiply (MatrixData * dst, MatrixData * a, MatrixData * b)
+{
+  MatrixData tmp;
+  gint i, j, k;
+
+  for (i = 0; i < 4; i++) {
+    for (j = 0; j < 4; j++) {
+      gdouble x = 0;
+      for (k = 0; k < 4; k++)
+        x += a->m[i][k] * b->m[k][j];
+      tmp.m[i][j] = x;
+    }
+  }
+  *dst = tmp;
+}
+
+static void
+color_matrix_offset_components (MatrixData * m, gdouble a1, gdouble a2,
+    gdouble a3)
+{
+  MatrixData a;
+
+  color_matrix_set_identity (&a);
+  a.m[0][3] = a1;
+  a.m[1][3] = a2;
+  a.m[2][3] = a3;
+  color_matrix_multiply (m, &a, m);
+}
+
+static void
+color_matrix_scale_components (MatrixData * m, gdouble a1, gdouble a2,
+    gdouble a3)
+{
+  MatrixData a;
+
+  color_matrix_set_identity (&a);
+  a.m[0][0] = a1;
+  a.m[1][1] = a2;
+  a.m[2][2] = a3;
+  color_matrix_multiply (m, &a, m);
+}
+
+static void
+color_matrix_YCbCr_to_RGB (MatrixData * m, gdouble Kr, gdouble Kb)
+{
+  gdouble Kg = 1.0 - Kr - Kb;
+  MatrixData k = {
+    {
+          {1., 0., 2 * (1 - Kr), 0.},
+          {1., -2 * Kb * (1 - Kb) / Kg, -2 * Kr * (1 - Kr) / Kg, 0.},
+          {1., 2 * (1 - Kb), 0., 0.},
+          {0., 0., 0., 1.},
+        }
+  };
+
+  color_matrix_multiply (m, &k, m);
+}
+
+static void
+color_matrix_RGB_to_YCbCr (MatrixData * m, gdouble Kr, gdouble Kb)
+{
+  gdouble Kg = 1.0 - Kr - Kb;
+  gdouble x, y;
+  MatrixData k;
+
+  x = 1 / (2 * (1 - Kb));
+  y = 1 / (2 * (1 - Kr));
+
+  color_matrix_set_identity (&k);
+  k.m[0][0] = Kr;
+  k.m[0][1] = Kg;
+  k.m[0][2] = Kb;
+  k.m[1][0] = -x * Kr;
+  k.m[1][1] = -x * Kg;
+  k.m[1][2] = x * (1 - Kb);
+  k.m[2][0] = y * (1 - Kr);
+  k.m[2][1] = -y * Kg;
+  k.m[2][2] = -y * Kb;
+
+  color_matrix_multiply (m, &k, m);
+}
+
+static gboolean
+get_Kr_Kb (GstVideoColorMatrix matrix, gdouble * Kr, gdouble * Kb)
+{
+  switch (matrix) {
+    case GST_VIDEO_COLOR_MATRIX_FCC:
+      *Kr = 0.30;
+      *Kb = 0.11;
+      return TRUE;
+    case GST_VIDEO_COLOR_MATRIX_BT709:
+      *Kr = 0.2126;
+      *Kb = 0.0722;
+      return TRUE;
+    case GST_VIDEO_COLOR_MATRIX_BT601:
+      *Kr = 0.2990;
+      *Kb = 0.1140;
+      return TRUE;
+    case GST_VIDEO_COLOR_MATRIX_SMPTE240M:
+      *Kr = 0.212;
+      *Kb = 0.087;
+      return TRUE;
+    default:
+      return FALSE;
+  }
+}
+
+/* same matrix as the videoconvert element computes */
+static void
+compute_matrix (GstVideoConverter * convert)
+{
+  GstVideoInfo *in_info = &convert->in_info;
+  GstVideoInfo *out_info = &convert->out_info;
+  const GstVideoFormatInfo *suinfo, *duinfo;
+  gint offset[4], scale[4];
+  gdouble Kr = 0, Kb = 0;
+  MatrixData dst;
+  gint i, j;
+
+  if (in_info->colorimetry.range == out_info->colorimetry.range &&
+      in_info->colorimetry.matrix == out_info->colorimetry.matrix) {
+    GST_DEBUG ("using identity color transform");
+    convert->matrix = NULL;
+    return;
+  }
+
+  suinfo = gst_video_format_get_info (in_info->finfo->unpack_format);
+  duinfo = gst_video_format_get_info (out_info->finfo->unpack_format);
+
+  if (convert->bits16) {
+    suinfo = gst_video_format_get_info (GST_VIDEO_FORMAT_INFO_IS_RGB (suinfo) ?
+        GST_VIDEO_FORMAT_ARGB64 : GST_VIDEO_FORMAT_AYUV64);
+    duinfo = gst_video_format_get_info (GST_VIDEO_FORMAT_INFO_IS_RGB (duinfo) ?
+        GST_VIDEO_FORMAT_ARGB64 : GST_VIDEO_FORMAT_AYUV64);
+  }
+
+  color_matrix_set_identity (&dst);
+
+  /* bring the components to [0..1.0] and to R'G'B' */
+  gst_video_color_range_offsets (in_info->colorimetry.range, suinfo, offset,
+      scale);
+  color_matrix_offset_components (&dst, -offset[0], -offset[1], -offset[2]);
+  color_matrix_scale_components (&dst, 1 / ((gdouble) scale[0]),
+      1 / ((gdouble) scale[1]), 1 / ((gdouble) scale[2]));
+  if (get_Kr_Kb (in_info->colorimetry.matrix, &Kr, &Kb))
+    color_matrix_YCbCr_to_RGB (&dst, Kr, Kb);
+
+  /* and to the output matrix and range */
+  if (get_Kr_Kb (out_info->colorimetry.matrix, &Kr, &Kb))
+    color_matrix_RGB_to_YCbCr (&dst, Kr, Kb);
+  gst_video_color_range_offsets (out_info->colorimetry.range, duinfo, offset,
+      scale);
+  color_matrix_scale_components (&dst, scale[0], scale[1], scale[2]);
+  color_matrix_offset_components (&dst, offset[0], offset[1], offset[2]);
+
+  /* 8-bit matrix coefficients */
+  color_matrix_scale_components (&dst, 256.0, 256.0, 256.0);
+
+  for (i = 0; i < 3; i++)
+    for (j = 0; j < 4; j++)
+      convert->cmatrix[i][j] = rint (dst.m[i][j]);
+
+  convert->matrix = convert->bits16 ? matrix_16 : matrix_8;
+}
+
+/* source position of the first output pixel and the distance between two
+ * output pixels, aligning the centers of the first and last pixels */
+static void
+compute_scale (gint in_size, gint out_size, gint * start, gint * increment)
+{
+  *increment = ((gint64) in_size << 16) / out_size;
+  *start = (*increment >> 1) - (1 << 15);
+}
+
+/**
+ * gst_video_converter_new:
+ * @in_info: a #GstVideoInfo of the source frames
+ * @out_info: a #GstVideoInfo of the destination frames
+ * @method: the #GstVideoResampleMethod to scale with
+ *
+ * Create a converter from frames described by @in_info to frames described
+ * by @out_info. Format, colorimetry and size can all be different.
+ *
+ * Returns: a new #GstVideoConverter or %NULL when one of the formats can't
+ * be unpacked or packed. Free with gst_video_converter_free().
+ */
+GstVideoConverter *
+gst_video_converter_new (GstVideoInfo * in_info, GstVideoInfo * out_info,
+    GstVideoResampleMethod method)
+{
+  GstVideoConverter *convert;
+  const GstVideoFormatInfo *suinfo, *duinfo;
+  gint i, pixel_size;
+
+  g_return_val_if_fail (in_info != NULL, NULL);
+  g_return_val_if_fail (out_info != NULL, NULL);
+  g_return_val_if_fail (in_info->width > 0 && in_info->height > 0, NULL);
+  g_return_val_if_fail (out_info->width > 0 && out_info->height > 0, NULL);
+
+  if (in_info->finfo->unpack_func == NULL)
+    goto no_unpack_func;
+  if (out_info->finfo->pack_func == NULL)
+    goto no_pack_func;
+
+  convert = g_slice_new0 (GstVideoConverter);
+  convert->in_info = *in_info;
+  convert->out_info = *out_info;
+  convert->method = method;
+
+  convert->in_width = GST_VIDEO_INFO_WIDTH (in_info);
+  convert->in_height = GST_VIDEO_INFO_HEIGHT (in_info);
+  convert->out_width = GST_VIDEO_INFO_WIDTH (out_info);
+  convert->out_height = GST_VIDEO_INFO_HEIGHT (out_info);
+
+  suinfo = gst_video_format_get_info (in_info->finfo->unpack_format);
+  duinfo = gst_video_format_get_info (out_info->finfo->unpack_format);
+  convert->in_bits = GST_VIDEO_FORMAT_INFO_DEPTH (suinfo, 0);
+  convert->out_bits = GST_VIDEO_FORMAT_INFO_DEPTH (duinfo, 0);
+  convert->bits16 = convert->in_bits == 16 || convert->out_bits == 16;
+
+  compute_matrix (convert);
+
+  compute_scale (convert->in_width, convert->out_width, &convert->x_start,
+      &convert->x_increment);
+  compute_scale (convert->in_height, convert->out_height, &convert->y_start,
+      &convert->y_increment);
+
+  switch (method) {
+    case GST_VIDEO_RESAMPLE_NEAREST:
+      convert->hresample =
+          convert->bits16 ? hresample_nearest_16 : hresample_nearest_8;
+      convert->vmerge = convert->bits16 ? vmerge_nearest_16 : vmerge_nearest_8;
+      break;
+    case GST_VIDEO_RESAMPLE_LINEAR:
+      convert->hresample =
+          convert->bits16 ? hresample_linear_16 : hresample_linear_8;
+      convert->vmerge = convert->bits16 ? vmerge_linear_16 : vmerge_linear_8;
+      break;
+    case GST_VIDEO_RESAMPLE_4TAP:
+    default:
+      init_taps (convert);
+      convert->hresample = convert->bits16 ? hresample_4tap_16 : hresample_4tap_8;
+      convert->vmerge = convert->bits16 ? vmerge_4tap_16 : vmerge_4tap_8;
+      break;
+  }
+
+  pixel_size = convert->bits16 ? 8 : 4;
+  convert->unpack_line =
+      g_malloc (pixel_size * (convert->in_width + LINE_PADDING));
+  for (i = 0; i < 4; i++) {
+    convert->lines[i] =
+        g_malloc (pixel_size * (convert->out_width + LINE_PADDING));
+    convert->line_nr[i] = -1;
+  }
+  convert->out_line = g_malloc (pixel_size * (convert->out_width +
+          LINE_PADDING));
+
+  GST_DEBUG ("%s %dx%d -> %s %dx%d, %d bits, method %d",
+      GST_VIDEO_INFO_NAME (in_info), convert->in_width, convert->in_height,
+      GST_VIDEO_INFO_NAME (out_info), convert->out_width, convert->out_height,
+      convert->bits16 ? 16 : 8, method);
+
+  return convert;
+
+  /* ERRORS */
+no_unpack_func:
+  {
+    GST_ERROR ("no unpack_func for format %s",
+        gst_video_format_to_string (GST_VIDEO_INFO_FORMAT (in_info)));
+    return NULL;
+  }
+no_pack_func:
+  {
+    GST_ERROR ("no pack_func for format %s",
+        gst_video_format_to_string (GST_VIDEO_INFO_FORMAT (out_info)));
+    return NULL;
+  }
+}
+
+/**
+ * gst_video_converter_free:
+ * @convert: a #GstVideoConverter
+ *
+ * Free @convert.
+ */
+void
+gst_video_converter_free (GstVideoConverter * convert)
+{
+  gint i;
+
+  g_return_if_fail (convert != NULL);
+
+  g_free (convert->unpack_line);
+  for (i = 0; i < 4; i++)
+    g_free (convert->lines[i]);
+  g_free (convert->out_line);
+
+  g_slice_free (GstVideoConverter, convert);
+}
+
+/* get source line @nr, unpacked and scaled horizontally */
+static gpointer
+get_line (GstVideoConverter * convert, const GstVideoFrame * src, gint nr)
+{
+  gint slot;
+  gpointer line;
+
+  nr = CLAMP (nr, 0, convert->in_height - 1);
+  slot = nr & 3;
+  line = convert->lines[slot];
+
+  if (convert->line_nr[slot] == nr)
+    return line;
+
+  src->info.finfo->unpack_func (src->info.finfo, GST_VIDEO_PACK_FLAG_NONE,
+      convert->unpack_line, src->data, src->info.stride, 0, nr,
+      convert->in_width);
+
+  if (convert->bits16 && convert->in_bits != 16) {
+    guint8 *line8 = convert->unpack_line;
+    guint16 *line16 = convert->unpack_line;
+    gint i;
+
+    /* expand to 16 bits in place, back to front */
+    for (i = convert->in_width * 4 - 1; i >= 0; i--)
+      line16[i] = TO_16 (line8[i]);
+  }
+  convert->hresample (convert, line, convert->unpack_line);
+  convert->line_nr[slot] = nr;
+
+  return line;
+}
+
+/**
+ * gst_video_converter_frame:
+ * @convert: a #GstVideoConverter
+ * @src: the source #GstVideoFrame
+ * @dest: the destination #GstVideoFrame
+ *
+ * Convert and scale @src into @dest. The frames must match the
+ * #GstVideoInfo given when @convert was made.
+ */
+void
+gst_video_converter_frame (GstVideoConverter * convert,
+    const GstVideoFrame * src, GstVideoFrame * dest)
+{
+  gint i, j, acc;
+  gpointer lines[4];
+
+  g_return_if_fail (convert != NULL);
+  g_return_if_fail (src != NULL);
+  g_return_if_fail (dest != NULL);
+
+  for (i = 0; i < 4; i++)
+    convert->line_nr[i] = -1;
+
+  acc = convert->y_start;
+  for (i = 0; i < convert->out_height; i++) {
+    switch (convert->method) {
+      case GST_VIDEO_RESAMPLE_NEAREST:
+        lines[0] = get_line (convert, src, (acc + 0x8000) >> 16);
+        break;
+      case GST_VIDEO_RESAMPLE_LINEAR:
+        j = acc >> 16;
+        lines[0] = get_line (convert, src, j);
+        lines[1] = get_line (convert, src, j + 1);
+        break;
+      case GST_VIDEO_RESAMPLE_4TAP:
+      default:
+        j = acc >> 16;
+        lines[0] = get_line (convert, src, j - 1);
+        lines[1] = get_line (convert, src, j);
+        lines[2] = get_line (convert, src, j + 1);
+        lines[3] = get_line (convert, src, j + 2);
+        break;
+    }
+    convert->vmerge (convert, convert->out_line, lines, acc);
+
+    if (convert->matrix)
+      convert->matrix (convert, convert->out_line);
+
+    if (convert->bits16 && convert->out_bits != 16) {
+      guint16 *line16 = convert->out_line;
+      guint8 *line8 = convert->out_line;
+
+      /* shrink in place, front to back */
+      for (j = 0; j < convert->out_width * 4; j++)
+        line8[j] = line16[j] >> 8;
+    }
+
+    dest->info.finfo->pack_func (dest->info.finfo, GST_VIDEO_PACK_FLAG_NONE,
+        convert->out_line, 0, dest->data, dest->info.stride,
+        dest->info.chroma_site, i, convert->out_width);
+
+    acc += convert->y_increment;
+  }
+
+  if (GST_VIDEO_FRAME_FORMAT (dest) == GST_VIDEO_FORMAT_RGB8P) {
+    /* same poor man's palette as videoconvert */
+    static const guint8 pal_value[6] = { 0x00, 0x33, 0x66, 0x99, 0xcc, 0xff };
+    guint32 *palette = GST_VIDEO_FRAME_PLANE_DATA (dest, 1);
+    gint r, g, b;
+
+    i = 0;
+    for (r = 0; r < 6; r++)
+      for (g = 0; g < 6; g++)
+        for (b = 0; b < 6; b++)
+          palette[i++] = (0xffU << 24) | (pal_value[r] << 16) |
+              (pal_value[g] << 8) | pal_value[b];
+    palette[i++] = 0;
+    while (i < 256)
+      palette[i++] = 0xff000000;
+  }
+}
@@ -0,0 +1,62 @@
+/* GStreamer
+ *
+ * video-converter.h: convert and scale video frames in one pass
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#ifndef __GST_VIDEO_CONVERTER_H__
+#define __GST_VIDEO_CONVERTER_H__
+
+#include <gst/video/video.h>
+
+G_BEGIN_DECLS
+
+/**
+ * GstVideoResampleMethod:
+ * @GST_VIDEO_RESAMPLE_NEAREST: use the nearest source pixel
+ * @GST_VIDEO_RESAMPLE_LINEAR: interpolate between the 2 nearest source
+ *   pixels in each direction
+ * @GST_VIDEO_RESAMPLE_4TAP: use a 4-tap sinc filter in each direction
+ *
+ * The filter used to scale the image.
+ */
+typedef enum {
+  GST_VIDEO_RESAMPLE_NEAREST,
+  GST_VIDEO_RESAMPLE_LINEAR,
+  GST_VIDEO_RESAMPLE_4TAP
+} GstVideoResampleMethod;
+
+/**
+ * GstVideoConverter:
+ *
+ * Opaque structure holding the state to convert and scale frames from one
+ * #GstVideoInfo to another.
+ */
+typedef struct _GstVideoConverter GstVideoConverter;
+
+GstVideoConverter *  gst_video_converter_new    (GstVideoInfo * in_info,
+                                                 GstVideoInfo * out_info,
+                                                 GstVideoResampleMethod method);
+void                 gst_video_converter_free   (GstVideoConverter * convert);
+
+void                 gst_video_converter_frame  (GstVideoConverter * convert,
+                                                 const GstVideoFrame * src,
+                                                 GstVideoFrame * dest);
+
+G_END_DECLS
+
+#endif /* __GST_VIDEO_CONVERTER_H__ */
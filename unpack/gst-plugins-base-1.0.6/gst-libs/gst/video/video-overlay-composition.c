@@ -139,13 +139,26 @@ struct _GstVideoOverlayRectangle
   /* store initial per-pixel alpha values: */
   guint8 *initial_alpha;
 
-  /* FIXME: we may also need a (private) way to cache converted/scaled
-   * pixel blobs */
+  /* converted/scaled variants of the pixels, most recently used first, and
+   * the size of the pixels of the unpinned ones, protected by the lock */
   GMutex lock;
 
   GList *scaled_rectangles;
+  gsize scaled_size;
+
+  /* for a variant: its pixels were returned by one of the
+   * gst_video_overlay_rectangle_get_pixels_*() functions, which don't
+   * return a reference, so it is kept until the rectangle it belongs to is
+   * freed. Protected by the lock of that rectangle */
+  gboolean pinned;
 };
 
+/* the unpinned converted/scaled variants kept per rectangle. The least
+ * recently used are dropped beyond these, but the most recent one is always
+ * kept */
+#define MAX_SCALED_RECTANGLES 8
+#define MAX_SCALED_SIZE (16 * 1024 * 1024)
+
 #define GST_RECTANGLE_LOCK(rect)   g_mutex_lock(&rect->lock)
 #define GST_RECTANGLE_UNLOCK(rect) g_mutex_unlock(&rect->lock)
 
@@ -422,12 +435,9 @@ gst_video_overlay_composition_get_rectangle (GstVideoOverlayComposition * comp,
   return comp->rectangles[n];
 }
 
-static gboolean
-gst_video_overlay_rectangle_needs_scaling (GstVideoOverlayRectangle * r)
-{
-  return (GST_VIDEO_INFO_WIDTH (&r->info) != r->render_width ||
-      GST_VIDEO_INFO_HEIGHT (&r->info) != r->render_height);
-}
+static GstVideoOverlayRectangle *gst_video_overlay_rectangle_get_scaled
+    (GstVideoOverlayRectangle * rectangle, GstVideoOverlayFormatFlags flags,
+    gboolean unscaled, GstVideoFormat wanted_format);
 
 /**
  * gst_video_overlay_composition_blend:
@@ -442,11 +452,8 @@ gboolean
 gst_video_overlay_composition_blend (GstVideoOverlayComposition * comp,
     GstVideoFrame * video_buf)
 {
-  GstVideoInfo scaled_info;
-  GstVideoInfo *vinfo;
   GstVideoFrame rectangle_frame;
   GstVideoFormat fmt;
-  GstBuffer *pixels = NULL;
   gboolean ret = TRUE;
   guint n, num;
   int w, h;
@@ -463,8 +470,7 @@ gst_video_overlay_composition_blend (GstVideoOverlayComposition * comp,
       "(%ux%u, format %u)", comp, num, video_buf, w, h, fmt);
 
   for (n = 0; n < num; ++n) {
-    GstVideoOverlayRectangle *rect;
-    gboolean needs_scaling;
+    GstVideoOverlayRectangle *rect, *scaled_rect;
 
     rect = comp->rectangles[n];
 
@@ -472,17 +478,14 @@ gst_video_overlay_composition_blend (GstVideoOverlayComposition * comp,
         GST_VIDEO_INFO_WIDTH (&rect->info), GST_VIDEO_INFO_HEIGHT (&rect->info),
         GST_VIDEO_INFO_FORMAT (&rect->info));
 
-    needs_scaling = gst_video_overlay_rectangle_needs_scaling (rect);
-    if (needs_scaling) {
-      gst_video_blend_scale_linear_RGBA (&rect->info, rect->pixels,
-          rect->render_height, rect->render_width, &scaled_info, &pixels);
-      vinfo = &scaled_info;
-    } else {
-      pixels = gst_buffer_ref (rect->pixels);
-      vinfo = &rect->info;
-    }
+    /* the scaled pixels are cached in the rectangle, so a static overlay
+     * is only scaled once. gst_video_blend() applies the global alpha */
+    scaled_rect = gst_video_overlay_rectangle_get_scaled (rect,
+        rect->flags | GST_VIDEO_OVERLAY_FORMAT_FLAG_GLOBAL_ALPHA, FALSE,
+        GST_VIDEO_INFO_FORMAT (&rect->info));
 
-    gst_video_frame_map (&rectangle_frame, vinfo, pixels, GST_MAP_READ);
+    gst_video_frame_map (&rectangle_frame, &scaled_rect->info,
+        scaled_rect->pixels, GST_MAP_READ);
 
     ret = gst_video_blend (video_buf, &rectangle_frame, rect->x, rect->y,
         rect->global_alpha);
@@ -491,8 +494,7 @@ gst_video_overlay_composition_blend (GstVideoOverlayComposition * comp,
       GST_WARNING ("Could not blend overlay rectangle onto video buffer");
     }
 
-    /* FIXME: should cache scaled pixels in the rectangle struct */
-    gst_buffer_unref (pixels);
+    gst_video_overlay_rectangle_unref (scaled_rect);
   }
 
   return ret;
@@ -605,14 +607,8 @@ gst_video_overlay_rectangle_free (GstMiniObject * mini_obj)
 
   gst_buffer_replace (&rect->pixels, NULL);
 
-  while (rect->scaled_rectangles != NULL) {
-    GstVideoOverlayRectangle *scaled_rect = rect->scaled_rectangles->data;
-
-    gst_video_overlay_rectangle_unref (scaled_rect);
-
-    rect->scaled_rectangles =
-        g_list_delete_link (rect->scaled_rectangles, rect->scaled_rectangles);
-  }
+  g_list_free_full (rect->scaled_rectangles,
+      (GDestroyNotify) gst_video_overlay_rectangle_unref);
 
   g_free (rect->initial_alpha);
   g_mutex_clear (&rect->lock);
@@ -1101,9 +1097,102 @@ gst_video_overlay_rectangle_convert (GstVideoInfo * src, GstBuffer * src_buffer,
   gst_video_frame_unmap (&dest_frame);
 }
 
-static GstBuffer *
-gst_video_overlay_rectangle_get_pixels_raw_internal (GstVideoOverlayRectangle *
-    rectangle, GstVideoOverlayFormatFlags flags, gboolean unscaled,
+/* returns a new reference to the cached variant of @rectangle with the
+ * given size, format and alpha type, and makes it the most recently used one.
+ * Call with the rectangle lock */
+static GstVideoOverlayRectangle *
+gst_video_overlay_rectangle_cache_lookup (GstVideoOverlayRectangle * rectangle,
+    guint width, guint height, GstVideoFormat format,
+    GstVideoOverlayFormatFlags flags)
+{
+  GList *l;
+
+  for (l = rectangle->scaled_rectangles; l != NULL; l = l->next) {
+    GstVideoOverlayRectangle *r = l->data;
+
+    if (GST_VIDEO_INFO_WIDTH (&r->info) == width &&
+        GST_VIDEO_INFO_HEIGHT (&r->info) == height &&
+        GST_VIDEO_INFO_FORMAT (&r->info) == format &&
+        gst_video_overlay_rectangle_is_same_alpha_type (r->flags, flags)) {
+      rectangle->scaled_rectangles =
+          g_list_remove_link (rectangle->scaled_rectangles, l);
+      rectangle->scaled_rectangles =
+          g_list_concat (l, rectangle->scaled_rectangles);
+      return gst_video_overlay_rectangle_ref (r);
+    }
+  }
+  return NULL;
+}
+
+/* adds @r as the most recently used variant of @rectangle and drops the least
+ * recently used unpinned ones beyond the limits. Takes ownership of @r. Call
+ * with the rectangle lock */
+static void
+gst_video_overlay_rectangle_cache_add (GstVideoOverlayRectangle * rectangle,
+    GstVideoOverlayRectangle * r)
+{
+  GList *l, *prev;
+  guint n = 0;
+
+  rectangle->scaled_rectangles = g_list_prepend (rectangle->scaled_rectangles,
+      r);
+  rectangle->scaled_size += gst_buffer_get_size (r->pixels);
+
+  for (l = rectangle->scaled_rectangles; l != NULL; l = l->next) {
+    if (!((GstVideoOverlayRectangle *) l->data)->pinned)
+      n++;
+  }
+
+  l = g_list_last (rectangle->scaled_rectangles);
+  while (l != rectangle->scaled_rectangles && (n > MAX_SCALED_RECTANGLES ||
+          rectangle->scaled_size > MAX_SCALED_SIZE)) {
+    GstVideoOverlayRectangle *old = l->data;
+
+    prev = l->prev;
+    if (!old->pinned) {
+      GST_LOG ("rectangle %p: dropping cached %ux%u format %u", rectangle,
+          GST_VIDEO_INFO_WIDTH (&old->info),
+          GST_VIDEO_INFO_HEIGHT (&old->info),
+          GST_VIDEO_INFO_FORMAT (&old->info));
+
+      rectangle->scaled_size -= gst_buffer_get_size (old->pixels);
+      rectangle->scaled_rectangles =
+          g_list_delete_link (rectangle->scaled_rectangles, l);
+      gst_video_overlay_rectangle_unref (old);
+      n--;
+    }
+    l = prev;
+  }
+}
+
+/* keeps the variant @r of @rectangle until @rectangle is freed, also when it
+ * was dropped from the cache since it was looked up. Takes ownership of @r.
+ * Call with the rectangle lock */
+static void
+gst_video_overlay_rectangle_cache_pin (GstVideoOverlayRectangle * rectangle,
+    GstVideoOverlayRectangle * r)
+{
+  if (g_list_find (rectangle->scaled_rectangles, r) == NULL) {
+    r->pinned = TRUE;
+    rectangle->scaled_rectangles =
+        g_list_prepend (rectangle->scaled_rectangles, r);
+    return;
+  }
+
+  if (!r->pinned) {
+    r->pinned = TRUE;
+    rectangle->scaled_size -= gst_buffer_get_size (r->pixels);
+  }
+  /* the cache holds another reference */
+  gst_video_overlay_rectangle_unref (r);
+}
+
+/* returns a new reference to a rectangle with the pixels of @rectangle in
+ * @wanted_format and the alpha type of @flags, scaled to the render size
+ * unless @unscaled */
+static GstVideoOverlayRectangle *
+gst_video_overlay_rectangle_get_scaled (GstVideoOverlayRectangle * rectangle,
+    GstVideoOverlayFormatFlags flags, gboolean unscaled,
     GstVideoFormat wanted_format)
 {
   GstVideoOverlayFormatFlags new_flags;
@@ -1111,7 +1200,6 @@ gst_video_overlay_rectangle_get_pixels_raw_internal (GstVideoOverlayRectangle *
   GstVideoInfo info;
   GstVideoFrame frame;
   GstBuffer *buf;
-  GList *l;
   guint width, height;
   guint wanted_width;
   guint wanted_height;
@@ -1145,51 +1233,31 @@ gst_video_overlay_rectangle_get_pixels_raw_internal (GstVideoOverlayRectangle *
     if ((!apply_global_alpha
             || rectangle->applied_global_alpha == rectangle->global_alpha)
         && (!revert_global_alpha || rectangle->applied_global_alpha == 1.0)) {
-      return rectangle->pixels;
+      return gst_video_overlay_rectangle_ref (rectangle);
     } else {
       /* only apply/revert global-alpha */
-      scaled_rect = rectangle;
+      scaled_rect = gst_video_overlay_rectangle_ref (rectangle);
       goto done;
     }
   }
 
   /* see if we've got one cached already */
   GST_RECTANGLE_LOCK (rectangle);
-  for (l = rectangle->scaled_rectangles; l != NULL; l = l->next) {
-    GstVideoOverlayRectangle *r = l->data;
-
-    if (GST_VIDEO_INFO_WIDTH (&r->info) == wanted_width &&
-        GST_VIDEO_INFO_HEIGHT (&r->info) == wanted_height &&
-        GST_VIDEO_INFO_FORMAT (&r->info) == wanted_format &&
-        gst_video_overlay_rectangle_is_same_alpha_type (r->flags, flags)) {
-      /* we'll keep these rectangles around until finalize, so it's ok not
-       * to take our own ref here */
-      scaled_rect = r;
-      break;
-    }
-  }
+  scaled_rect = gst_video_overlay_rectangle_cache_lookup (rectangle,
+      wanted_width, wanted_height, wanted_format, flags);
   GST_RECTANGLE_UNLOCK (rectangle);
 
   if (scaled_rect != NULL)
     goto done;
 
-  /* maybe have one in the right format though */
+  /* maybe have one in the right format and the original size though */
   if (format != wanted_format) {
     GST_RECTANGLE_LOCK (rectangle);
-    for (l = rectangle->scaled_rectangles; l != NULL; l = l->next) {
-      GstVideoOverlayRectangle *r = l->data;
-
-      if (GST_VIDEO_INFO_FORMAT (&r->info) == wanted_format &&
-          gst_video_overlay_rectangle_is_same_alpha_type (r->flags, flags)) {
-        /* we'll keep these rectangles around until finalize, so it's ok not
-         * to take our own ref here */
-        conv_rect = r;
-        break;
-      }
-    }
+    conv_rect = gst_video_overlay_rectangle_cache_lookup (rectangle,
+        width, height, wanted_format, rectangle->flags);
     GST_RECTANGLE_UNLOCK (rectangle);
   } else {
-    conv_rect = rectangle;
+    conv_rect = gst_video_overlay_rectangle_ref (rectangle);
   }
 
   if (conv_rect == NULL) {
@@ -1202,13 +1270,13 @@ gst_video_overlay_rectangle_get_pixels_raw_internal (GstVideoOverlayRectangle *
     conv_rect = gst_video_overlay_rectangle_new_raw (buf,
         0, 0, width, height, rectangle->flags);
     if (rectangle->global_alpha != 1.0)
-      gst_video_overlay_rectangle_set_global_alpha (scaled_rect,
+      gst_video_overlay_rectangle_set_global_alpha (conv_rect,
           rectangle->global_alpha);
     gst_buffer_unref (buf);
     /* keep this converted one around as well in any case */
     GST_RECTANGLE_LOCK (rectangle);
-    rectangle->scaled_rectangles =
-        g_list_prepend (rectangle->scaled_rectangles, conv_rect);
+    gst_video_overlay_rectangle_cache_add (rectangle,
+        gst_video_overlay_rectangle_ref (conv_rect));
     GST_RECTANGLE_UNLOCK (rectangle);
   }
 
@@ -1258,10 +1326,11 @@ gst_video_overlay_rectangle_get_pixels_raw_internal (GstVideoOverlayRectangle *
     gst_video_overlay_rectangle_set_global_alpha (scaled_rect,
         conv_rect->global_alpha);
   gst_buffer_unref (buf);
+  gst_video_overlay_rectangle_unref (conv_rect);
 
   GST_RECTANGLE_LOCK (rectangle);
-  rectangle->scaled_rectangles =
-      g_list_prepend (rectangle->scaled_rectangles, scaled_rect);
+  gst_video_overlay_rectangle_cache_add (rectangle,
+      gst_video_overlay_rectangle_ref (scaled_rect));
   GST_RECTANGLE_UNLOCK (rectangle);
 
 done:
@@ -1278,9 +1347,34 @@ done:
   }
   GST_RECTANGLE_UNLOCK (rectangle);
 
-  return scaled_rect->pixels;
+  return scaled_rect;
 }
 
+static GstBuffer *
+gst_video_overlay_rectangle_get_pixels_raw_internal (GstVideoOverlayRectangle *
+    rectangle, GstVideoOverlayFormatFlags flags, gboolean unscaled,
+    GstVideoFormat wanted_format)
+{
+  GstVideoOverlayRectangle *scaled_rect;
+  GstBuffer *pixels;
+
+  scaled_rect = gst_video_overlay_rectangle_get_scaled (rectangle, flags,
+      unscaled, wanted_format);
+  if (scaled_rect == NULL)
+    return NULL;
+
+  /* we don't return a reference, @rectangle keeps the pixels around */
+  pixels = scaled_rect->pixels;
+  if (scaled_rect == rectangle) {
+    gst_video_overlay_rectangle_unref (scaled_rect);
+  } else {
+    GST_RECTANGLE_LOCK (rectangle);
+    gst_video_overlay_rectangle_cache_pin (rectangle, scaled_rect);
+    GST_RECTANGLE_UNLOCK (rectangle);
+  }
+
+  return pixels;
+}
 
 /**
  * gst_video_overlay_rectangle_get_pixels_raw:
@@ -31,6 +31,10 @@
  * gst-launch -v videotestsrc ! video/x-raw,format=\(string\)YUY2 ! videoconvert ! ximagesink
  * ]|
  * </refsect2>
+ *
+ * With #GstVideoConvert:n-threads larger than 1, every frame is split in
+ * horizontal bands that are converted in parallel by a set of worker threads
+ * that live as long as the negotiated format.
  */
 
 #ifdef HAVE_CONFIG_H
@@ -38,12 +42,16 @@
 #endif
 
 #include "gstvideoconvert.h"
+#include "gstvideoconvertscale.h"
 
 #include <gst/video/video.h>
 #include <gst/video/gstvideometa.h>
 #include <gst/video/gstvideopool.h>
 
 #include <string.h>
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
 
 GST_DEBUG_CATEGORY (videoconvert_debug);
 #define GST_CAT_DEFAULT videoconvert_debug
@@ -56,10 +64,14 @@ static GQuark _colorspace_quark;
 #define gst_video_convert_parent_class parent_class
 G_DEFINE_TYPE (GstVideoConvert, gst_video_convert, GST_TYPE_VIDEO_FILTER);
 
+#define DEFAULT_PROP_DITHER      DITHER_NONE
+#define DEFAULT_PROP_N_THREADS   1
+
 enum
 {
   PROP_0,
-  PROP_DITHER
+  PROP_DITHER,
+  PROP_N_THREADS
 };
 
 #define CSP_VIDEO_CAPS GST_VIDEO_CAPS_MAKE (GST_VIDEO_FORMATS_ALL)
@@ -211,6 +223,29 @@ gst_video_convert_transform_meta (GstBaseTransform * trans, GstBuffer * outbuf,
   return ret;
 }
 
+/* the number of threads to use for the next converter */
+static guint
+gst_video_convert_get_n_threads (GstVideoConvert * space)
+{
+  guint n_threads;
+
+  GST_OBJECT_LOCK (space);
+  n_threads = space->n_threads;
+  space->n_threads_changed = FALSE;
+  GST_OBJECT_UNLOCK (space);
+
+  if (n_threads == 0) {
+#if GLIB_CHECK_VERSION(2,36,0)
+    n_threads = g_get_num_processors ();
+#elif defined (_SC_NPROCESSORS_ONLN)
+    n_threads = MAX (1, sysconf (_SC_NPROCESSORS_ONLN));
+#else
+    n_threads = 1;
+#endif
+  }
+  return n_threads;
+}
+
 static gboolean
 gst_video_convert_set_info (GstVideoFilter * filter,
     GstCaps * incaps, GstVideoInfo * in_info, GstCaps * outcaps,
@@ -222,6 +257,7 @@ gst_video_convert_set_info (GstVideoFilter * filter,
 
   if (space->convert) {
     videoconvert_convert_free (space->convert);
+    space->convert = NULL;
   }
 
   /* these must match */
@@ -237,7 +273,8 @@ gst_video_convert_set_info (GstVideoFilter * filter,
   if (in_info->interlace_mode != out_info->interlace_mode)
     goto format_mismatch;
 
-  space->convert = videoconvert_convert_new (in_info, out_info);
+  space->convert = videoconvert_convert_new (in_info, out_info,
+      gst_video_convert_get_n_threads (space));
   if (space->convert == NULL)
     goto no_convert;
 
@@ -312,13 +349,27 @@ gst_video_convert_class_init (GstVideoConvertClass * klass)
 
   g_object_class_install_property (gobject_class, PROP_DITHER,
       g_param_spec_enum ("dither", "Dither", "Apply dithering while converting",
-          dither_method_get_type (), DITHER_NONE,
+          dither_method_get_type (), DEFAULT_PROP_DITHER,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  /**
+   * GstVideoConvert:n-threads
+   *
+   * The number of threads that convert a frame, each one a horizontal band
+   * of it. 0 uses one thread per CPU. Changing the value takes effect on
+   * the next frame.
+   */
+  g_object_class_install_property (gobject_class, PROP_N_THREADS,
+      g_param_spec_uint ("n-threads", "Threads",
+          "Number of threads to convert a frame with (0 = one per CPU)",
+          0, VIDEO_CONVERT_MAX_THREADS, DEFAULT_PROP_N_THREADS,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 }
 
 static void
 gst_video_convert_init (GstVideoConvert * space)
 {
+  space->dither = DEFAULT_PROP_DITHER;
+  space->n_threads = DEFAULT_PROP_N_THREADS;
 }
 
 void
@@ -333,6 +384,12 @@ gst_video_convert_set_property (GObject * object, guint property_id,
     case PROP_DITHER:
       csp->dither = g_value_get_enum (value);
       break;
+    case PROP_N_THREADS:
+      GST_OBJECT_LOCK (csp);
+      csp->n_threads = g_value_get_uint (value);
+      csp->n_threads_changed = TRUE;
+      GST_OBJECT_UNLOCK (csp);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
       break;
@@ -351,6 +408,11 @@ gst_video_convert_get_property (GObject * object, guint property_id,
     case PROP_DITHER:
       g_value_set_enum (value, csp->dither);
       break;
+    case PROP_N_THREADS:
+      GST_OBJECT_LOCK (csp);
+      g_value_set_uint (value, csp->n_threads);
+      GST_OBJECT_UNLOCK (csp);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
       break;
@@ -362,6 +424,7 @@ gst_video_convert_transform_frame (GstVideoFilter * filter,
     GstVideoFrame * in_frame, GstVideoFrame * out_frame)
 {
   GstVideoConvert *space;
+  gboolean n_threads_changed;
 
   space = GST_VIDEO_CONVERT_CAST (filter);
 
@@ -370,11 +433,35 @@ gst_video_convert_transform_frame (GstVideoFilter * filter,
       GST_VIDEO_INFO_NAME (&filter->in_info),
       GST_VIDEO_INFO_NAME (&filter->out_info));
 
+  GST_OBJECT_LOCK (space);
+  n_threads_changed = space->n_threads_changed;
+  GST_OBJECT_UNLOCK (space);
+
+  if (G_UNLIKELY (n_threads_changed)) {
+    VideoConvert *convert;
+
+    convert = videoconvert_convert_new (&filter->in_info, &filter->out_info,
+        gst_video_convert_get_n_threads (space));
+    if (convert == NULL)
+      goto no_convert;
+
+    videoconvert_convert_free (space->convert);
+    space->convert = convert;
+  }
+
   videoconvert_convert_set_dither (space->convert, space->dither);
 
   videoconvert_convert_convert (space->convert, out_frame, in_frame);
 
   return GST_FLOW_OK;
+
+  /* ERRORS */
+no_convert:
+  {
+    GST_ELEMENT_ERROR (space, CORE, NEGOTIATION, (NULL),
+        ("could not create converter"));
+    return GST_FLOW_ERROR;
+  }
 }
 
 static gboolean
@@ -385,8 +472,12 @@ plugin_init (GstPlugin * plugin)
 
   _colorspace_quark = g_quark_from_static_string ("colorspace");
 
-  return gst_element_register (plugin, "videoconvert",
-      GST_RANK_NONE, GST_TYPE_VIDEO_CONVERT);
+  if (!gst_element_register (plugin, "videoconvert",
+          GST_RANK_NONE, GST_TYPE_VIDEO_CONVERT))
+    return FALSE;
+
+  return gst_element_register (plugin, "videoconvertscale",
+      GST_RANK_NONE, GST_TYPE_VIDEO_CONVERT_SCALE);
 }
 
 GST_PLUGIN_DEFINE (GST_VERSION_MAJOR,
@@ -49,6 +49,10 @@ struct _GstVideoConvert {
 
   VideoConvert *convert;
   gboolean dither;
+
+  /* protected by the object lock */
+  guint n_threads;
+  gboolean n_threads_changed;
 };
 
 struct _GstVideoConvertClass
@@ -0,0 +1,480 @@
+/* GStreamer
+ *
+ * gstvideoconvertscale.c: convert and scale video in one pass
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/**
+ * SECTION:element-videoconvertscale
+ * @see_also: videoconvert, videoscale
+ *
+ * Converts the format and the size of video frames in a single pass with a
+ * #GstVideoConverter. Each output line is made from source lines that are
+ * unpacked and horizontally scaled once, vertically merged and converted
+ * while still in cache, so that no intermediate frame is written to memory
+ * as with videoconvert ! videoscale.
+ *
+ * The display aspect ratio of the input is kept when the output size is
+ * not fully given by downstream. No borders are added.
+ *
+ * <refsect2>
+ * <title>Example launch line</title>
+ * |[
+ * gst-launch -v videotestsrc ! video/x-raw,format=\(string\)YUY2 ! videoconvertscale ! video/x-raw,format=\(string\)BGRx,width=320,height=240 ! ximagesink
+ * ]|
+ * </refsect2>
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include "config.h"
+#endif
+
+#include "gstvideoconvertscale.h"
+
+#include <string.h>
+
+GST_DEBUG_CATEGORY_STATIC (video_convert_scale_debug);
+#define GST_CAT_DEFAULT video_convert_scale_debug
+
+#define DEFAULT_PROP_METHOD      GST_VIDEO_RESAMPLE_LINEAR
+
+enum
+{
+  PROP_0,
+  PROP_METHOD
+};
+
+#define CONVERT_SCALE_VIDEO_CAPS GST_VIDEO_CAPS_MAKE (GST_VIDEO_FORMATS_ALL)
+
+static GstStaticPadTemplate gst_video_convert_scale_src_template =
+GST_STATIC_PAD_TEMPLATE ("src",
+    GST_PAD_SRC,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS (CONVERT_SCALE_VIDEO_CAPS)
+    );
+
+static GstStaticPadTemplate gst_video_convert_scale_sink_template =
+GST_STATIC_PAD_TEMPLATE ("sink",
+    GST_PAD_SINK,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS (CONVERT_SCALE_VIDEO_CAPS)
+    );
+
+static void gst_video_convert_scale_set_property (GObject * object,
+    guint property_id, const GValue * value, GParamSpec * pspec);
+static void gst_video_convert_scale_get_property (GObject * object,
+    guint property_id, GValue * value, GParamSpec * pspec);
+static void gst_video_convert_scale_finalize (GObject * object);
+
+static GstCaps *gst_video_convert_scale_transform_caps (GstBaseTransform *
+    trans, GstPadDirection direction, GstCaps * caps, GstCaps * filter);
+static GstCaps *gst_video_convert_scale_fixate_caps (GstBaseTransform * trans,
+    GstPadDirection direction, GstCaps * caps, GstCaps * othercaps);
+static gboolean gst_video_convert_scale_src_event (GstBaseTransform * trans,
+    GstEvent * event);
+
+static gboolean gst_video_convert_scale_set_info (GstVideoFilter * filter,
+    GstCaps * incaps, GstVideoInfo * in_info, GstCaps * outcaps,
+    GstVideoInfo * out_info);
+static GstFlowReturn gst_video_convert_scale_transform_frame (GstVideoFilter *
+    filter, GstVideoFrame * in_frame, GstVideoFrame * out_frame);
+
+#define gst_video_convert_scale_parent_class parent_class
+G_DEFINE_TYPE (GstVideoConvertScale, gst_video_convert_scale,
+    GST_TYPE_VIDEO_FILTER);
+
+static void
+gst_video_convert_scale_class_init (GstVideoConvertScaleClass * klass)
+{
+  GObjectClass *gobject_class = (GObjectClass *) klass;
+  GstElementClass *gstelement_class = (GstElementClass *) klass;
+  GstBaseTransformClass *gstbasetransform_class =
+      (GstBaseTransformClass *) klass;
+  GstVideoFilterClass *gstvideofilter_class = (GstVideoFilterClass *) klass;
+
+  GST_DEBUG_CATEGORY_INIT (video_convert_scale_debug, "videoconvertscale", 0,
+      "Colorspace converter and scaler");
+
+  gobject_class->set_property = gst_video_convert_scale_set_property;
+  gobject_class->get_property = gst_video_convert_scale_get_property;
+  gobject_class->finalize = gst_video_convert_scale_finalize;
+
+  g_object_class_install_property (gobject_class, PROP_METHOD,
+      g_param_spec_enum ("method", "Method", "Resampling method",
+          GST_TYPE_VIDEO_RESAMPLE_METHOD, DEFAULT_PROP_METHOD,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  gst_element_class_add_pad_template (gstelement_class,
+      gst_static_pad_template_get (&gst_video_convert_scale_src_template));
+  gst_element_class_add_pad_template (gstelement_class,
+      gst_static_pad_template_get (&gst_video_convert_scale_sink_template));
+
+  gst_element_class_set_static_metadata (gstelement_class,
+      "Colorspace converter and scaler", "Filter/Converter/Video/Scaler",
+      "Converts video from one colorspace and size to another in one pass",
+      "GStreamer maintainers <gstreamer-devel@lists.sourceforge.net>");
+
+  gstbasetransform_class->transform_caps =
+      GST_DEBUG_FUNCPTR (gst_video_convert_scale_transform_caps);
+  gstbasetransform_class->fixate_caps =
+      GST_DEBUG_FUNCPTR (gst_video_convert_scale_fixate_caps);
+  gstbasetransform_class->src_event =
+      GST_DEBUG_FUNCPTR (gst_video_convert_scale_src_event);
+
+  gstbasetransform_class->passthrough_on_same_caps = TRUE;
+
+  gstvideofilter_class->set_info =
+      GST_DEBUG_FUNCPTR (gst_video_convert_scale_set_info);
+  gstvideofilter_class->transform_frame =
+      GST_DEBUG_FUNCPTR (gst_video_convert_scale_transform_frame);
+}
+
+static void
+gst_video_convert_scale_init (GstVideoConvertScale * cs)
+{
+  cs->method = DEFAULT_PROP_METHOD;
+}
+
+static void
+gst_video_convert_scale_finalize (GObject * object)
+{
+  GstVideoConvertScale *cs = GST_VIDEO_CONVERT_SCALE (object);
+
+  if (cs->convert)
+    gst_video_converter_free (cs->convert);
+
+  G_OBJECT_CLASS (parent_class)->finalize (object);
+}
+
+static void
+gst_video_convert_scale_set_property (GObject * object, guint property_id,
+    const GValue * value, GParamSpec * pspec)
+{
+  GstVideoConvertScale *cs = GST_VIDEO_CONVERT_SCALE (object);
+
+  switch (property_id) {
+    case PROP_METHOD:
+      GST_OBJECT_LOCK (cs);
+      cs->method = g_value_get_enum (value);
+      GST_OBJECT_UNLOCK (cs);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+      break;
+  }
+}
+
+static void
+gst_video_convert_scale_get_property (GObject * object, guint property_id,
+    GValue * value, GParamSpec * pspec)
+{
+  GstVideoConvertScale *cs = GST_VIDEO_CONVERT_SCALE (object);
+
+  switch (property_id) {
+    case PROP_METHOD:
+      GST_OBJECT_LOCK (cs);
+      g_value_set_enum (value, cs->method);
+      GST_OBJECT_UNLOCK (cs);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+      break;
+  }
+}
+
+/* Any format and any size can be made from the caps, which is the union of
+ * what videoconvert and videoscale accept. The unchanged caps come first so
+ * that passthrough is preferred. */
+static GstCaps *
+gst_video_convert_scale_transform_caps (GstBaseTransform * trans,
+    GstPadDirection direction, GstCaps * caps, GstCaps * filter)
+{
+  GstCaps *ret;
+  GstStructure *structure;
+  gint i, n;
+
+  ret = gst_caps_copy (caps);
+
+  n = gst_caps_get_size (caps);
+  for (i = 0; i < n; i++) {
+    structure = gst_structure_copy (gst_caps_get_structure (caps, i));
+
+    gst_structure_remove_fields (structure, "format",
+        "colorimetry", "chroma-site", NULL);
+    gst_structure_set (structure,
+        "width", GST_TYPE_INT_RANGE, 1, G_MAXINT,
+        "height", GST_TYPE_INT_RANGE, 1, G_MAXINT, NULL);
+
+    /* if pixel aspect ratio, make a range of it */
+    if (gst_structure_has_field (structure, "pixel-aspect-ratio")) {
+      gst_structure_set (structure, "pixel-aspect-ratio",
+          GST_TYPE_FRACTION_RANGE, 1, G_MAXINT, G_MAXINT, 1, NULL);
+    }
+    gst_caps_append_structure (ret, structure);
+  }
+  ret = gst_caps_simplify (ret);
+
+  if (filter) {
+    GstCaps *intersection;
+
+    intersection =
+        gst_caps_intersect_full (filter, ret, GST_CAPS_INTERSECT_FIRST);
+    gst_caps_unref (ret);
+    ret = intersection;
+  }
+
+  GST_DEBUG_OBJECT (trans, "transformed %" GST_PTR_FORMAT " into %"
+      GST_PTR_FORMAT, caps, ret);
+
+  return ret;
+}
+
+/* fixates @field of @outs to the value it has in @ins, if it can */
+static void
+fixate_to_input (GstStructure * outs, const GstStructure * ins,
+    const gchar * field)
+{
+  const GValue *to;
+  const gchar *value;
+
+  to = gst_structure_get_value (outs, field);
+  if (to == NULL || gst_value_is_fixed (to))
+    return;
+
+  if ((value = gst_structure_get_string (ins, field)))
+    gst_structure_fixate_field_string (outs, field, value);
+}
+
+/* picks the size and pixel-aspect-ratio of @outs so that the display aspect
+ * ratio of @ins is kept, like videoscale does without borders */
+static void
+fixate_size (GstBaseTransform * trans, const GstStructure * ins,
+    GstStructure * outs)
+{
+  const GValue *to_par;
+  gint from_w, from_h, from_par_n = 1, from_par_d = 1;
+  gint to_par_n = 1, to_par_d = 1;
+  gint from_dar_n, from_dar_d;
+  gint w = 0, h = 0;
+
+  if (!gst_structure_get_int (ins, "width", &from_w) ||
+      !gst_structure_get_int (ins, "height", &from_h))
+    return;
+  gst_structure_get_fraction (ins, "pixel-aspect-ratio", &from_par_n,
+      &from_par_d);
+
+  if (!gst_util_fraction_multiply (from_w, from_h, from_par_n, from_par_d,
+          &from_dar_n, &from_dar_d))
+    goto overflow;
+
+  /* keep the input pixel-aspect-ratio when we can */
+  to_par = gst_structure_get_value (outs, "pixel-aspect-ratio");
+  if (to_par) {
+    if (!gst_value_is_fixed (to_par))
+      gst_structure_fixate_field_nearest_fraction (outs, "pixel-aspect-ratio",
+          from_par_n, from_par_d);
+    gst_structure_get_fraction (outs, "pixel-aspect-ratio", &to_par_n,
+        &to_par_d);
+  }
+
+  gst_structure_get_int (outs, "width", &w);
+  gst_structure_get_int (outs, "height", &h);
+
+  if (w && h)
+    return;
+
+  if (!w && !h) {
+    /* try to keep the input height and scale the width */
+    gst_structure_fixate_field_nearest_int (outs, "height", from_h);
+    gst_structure_get_int (outs, "height", &h);
+  }
+
+  if (h) {
+    gint num, den;
+
+    if (!gst_util_fraction_multiply (h, 1, from_dar_n, from_dar_d, &num, &den)
+        || !gst_util_fraction_multiply (num, den, to_par_d, to_par_n, &num,
+            &den))
+      goto overflow;
+    gst_structure_fixate_field_nearest_int (outs, "width",
+        MAX (1, gst_util_uint64_scale_int (1, num, den)));
+  } else {
+    gint num, den;
+
+    if (!gst_util_fraction_multiply (w, 1, from_dar_d, from_dar_n, &num, &den)
+        || !gst_util_fraction_multiply (num, den, to_par_n, to_par_d, &num,
+            &den))
+      goto overflow;
+    gst_structure_fixate_field_nearest_int (outs, "height",
+        MAX (1, gst_util_uint64_scale_int (1, num, den)));
+  }
+  return;
+
+  /* ERRORS */
+overflow:
+  {
+    GST_ELEMENT_ERROR (trans, CORE, NEGOTIATION, (NULL),
+        ("Error calculating the output scaled size - integer overflow"));
+    return;
+  }
+}
+
+static GstCaps *
+gst_video_convert_scale_fixate_caps (GstBaseTransform * trans,
+    GstPadDirection direction, GstCaps * caps, GstCaps * othercaps)
+{
+  GstStructure *ins, *outs;
+
+  othercaps = gst_caps_truncate (othercaps);
+  othercaps = gst_caps_make_writable (othercaps);
+
+  GST_DEBUG_OBJECT (trans, "trying to fixate othercaps %" GST_PTR_FORMAT
+      " based on caps %" GST_PTR_FORMAT, othercaps, caps);
+
+  ins = gst_caps_get_structure (caps, 0);
+  outs = gst_caps_get_structure (othercaps, 0);
+
+  fixate_size (trans, ins, outs);
+
+  /* prefer not to convert what doesn't need converting */
+  fixate_to_input (outs, ins, "format");
+  fixate_to_input (outs, ins, "colorimetry");
+  fixate_to_input (outs, ins, "chroma-site");
+
+  othercaps = gst_caps_fixate (othercaps);
+
+  GST_DEBUG_OBJECT (trans, "fixated othercaps to %" GST_PTR_FORMAT, othercaps);
+
+  return othercaps;
+}
+
+static gboolean
+gst_video_convert_scale_src_event (GstBaseTransform * trans, GstEvent * event)
+{
+  GstVideoFilter *filter = GST_VIDEO_FILTER_CAST (trans);
+  GstStructure *structure;
+  gdouble a;
+
+  switch (GST_EVENT_TYPE (event)) {
+    case GST_EVENT_NAVIGATION:
+      if (filter->in_info.width != filter->out_info.width ||
+          filter->in_info.height != filter->out_info.height) {
+        event =
+            GST_EVENT (gst_mini_object_make_writable (GST_MINI_OBJECT (event)));
+
+        structure = (GstStructure *) gst_event_get_structure (event);
+        if (gst_structure_get_double (structure, "pointer_x", &a)) {
+          gst_structure_set (structure, "pointer_x", G_TYPE_DOUBLE,
+              a * filter->in_info.width / filter->out_info.width, NULL);
+        }
+        if (gst_structure_get_double (structure, "pointer_y", &a)) {
+          gst_structure_set (structure, "pointer_y", G_TYPE_DOUBLE,
+              a * filter->in_info.height / filter->out_info.height, NULL);
+        }
+      }
+      break;
+    default:
+      break;
+  }
+
+  return GST_BASE_TRANSFORM_CLASS (parent_class)->src_event (trans, event);
+}
+
+static gboolean
+gst_video_convert_scale_set_info (GstVideoFilter * filter,
+    GstCaps * incaps, GstVideoInfo * in_info, GstCaps * outcaps,
+    GstVideoInfo * out_info)
+{
+  GstVideoConvertScale *cs = GST_VIDEO_CONVERT_SCALE_CAST (filter);
+
+  if (cs->convert) {
+    gst_video_converter_free (cs->convert);
+    cs->convert = NULL;
+  }
+
+  /* these must match */
+  if (in_info->fps_n != out_info->fps_n || in_info->fps_d != out_info->fps_d)
+    goto format_mismatch;
+
+  /* if present, these must match too */
+  if (in_info->interlace_mode != out_info->interlace_mode)
+    goto format_mismatch;
+
+  GST_OBJECT_LOCK (cs);
+  cs->convert_method = cs->method;
+  GST_OBJECT_UNLOCK (cs);
+
+  cs->convert = gst_video_converter_new (in_info, out_info,
+      cs->convert_method);
+  if (cs->convert == NULL)
+    goto no_convert;
+
+  GST_DEBUG_OBJECT (cs, "from %s %dx%d to %s %dx%d",
+      GST_VIDEO_INFO_NAME (in_info), in_info->width, in_info->height,
+      GST_VIDEO_INFO_NAME (out_info), out_info->width, out_info->height);
+
+  return TRUE;
+
+  /* ERRORS */
+format_mismatch:
+  {
+    GST_ERROR_OBJECT (cs, "input and output formats do not match");
+    return FALSE;
+  }
+no_convert:
+  {
+    GST_ERROR_OBJECT (cs, "could not create converter");
+    return FALSE;
+  }
+}
+
+static GstFlowReturn
+gst_video_convert_scale_transform_frame (GstVideoFilter * filter,
+    GstVideoFrame * in_frame, GstVideoFrame * out_frame)
+{
+  GstVideoConvertScale *cs = GST_VIDEO_CONVERT_SCALE_CAST (filter);
+  GstVideoResampleMethod method;
+
+  GST_OBJECT_LOCK (cs);
+  method = cs->method;
+  GST_OBJECT_UNLOCK (cs);
+
+  if (G_UNLIKELY (method != cs->convert_method)) {
+    GstVideoConverter *convert;
+
+    convert = gst_video_converter_new (&filter->in_info, &filter->out_info,
+        method);
+    if (convert == NULL)
+      goto no_convert;
+
+    gst_video_converter_free (cs->convert);
+    cs->convert = convert;
+    cs->convert_method = method;
+  }
+
+  gst_video_converter_frame (cs->convert, in_frame, out_frame);
+
+  return GST_FLOW_OK;
+
+  /* ERRORS */
+no_convert:
+  {
+    GST_ELEMENT_ERROR (cs, CORE, NEGOTIATION, (NULL),
+        ("could not create converter"));
+    return GST_FLOW_ERROR;
+  }
+}
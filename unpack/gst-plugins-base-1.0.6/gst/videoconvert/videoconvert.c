@@ -32,7 +32,7 @@
 
 
 static void videoconvert_convert_generic (VideoConvert * convert,
-    GstVideoFrame * dest, const GstVideoFrame * src);
+    GstVideoFrame * dest, const GstVideoFrame * src, VideoConvertBand * band);
 static void videoconvert_convert_matrix (VideoConvert * convert,
     guint8 * pixels);
 static void videoconvert_convert_matrix16 (VideoConvert * convert,
@@ -40,16 +40,18 @@ static void videoconvert_convert_matrix16 (VideoConvert * convert,
 static gboolean videoconvert_convert_lookup_fastpath (VideoConvert * convert);
 static gboolean videoconvert_convert_compute_matrix (VideoConvert * convert);
 static void videoconvert_dither_verterr (VideoConvert * convert,
-    guint16 * pixels, int j);
+    VideoConvertBand * band, guint16 * pixels, int j);
 static void videoconvert_dither_halftone (VideoConvert * convert,
-    guint16 * pixels, int j);
+    VideoConvertBand * band, guint16 * pixels, int j);
+static gpointer videoconvert_band_thread (VideoConvertBand * band);
 
 
 VideoConvert *
-videoconvert_convert_new (GstVideoInfo * in_info, GstVideoInfo * out_info)
+videoconvert_convert_new (GstVideoInfo * in_info, GstVideoInfo * out_info,
+    guint n_threads)
 {
   VideoConvert *convert;
-  int i, width;
+  int i, width, height, band_height;
 
   convert = g_malloc0 (sizeof (VideoConvert));
 
@@ -67,10 +69,39 @@ videoconvert_convert_new (GstVideoInfo * in_info, GstVideoInfo * out_info)
   convert->height = GST_VIDEO_INFO_HEIGHT (in_info);
 
   width = convert->width;
+  height = convert->height;
 
-  convert->tmpline = g_malloc (sizeof (guint8) * (width + 8) * 4);
-  convert->tmpline16 = g_malloc (sizeof (guint16) * (width + 8) * 4);
-  convert->errline = g_malloc0 (sizeof (guint16) * width * 4);
+  /* split the frame in bands of a multiple of 4 lines so that no band starts
+   * in the middle of a subsampled chroma line, and don't make more bands than
+   * there are lines */
+  n_threads = CLAMP (n_threads, 1, VIDEO_CONVERT_MAX_THREADS);
+  band_height = GST_ROUND_UP_4 ((height + n_threads - 1) / n_threads);
+  n_threads = MAX (1, (height + band_height - 1) / band_height);
+
+  GST_DEBUG ("using %u threads with bands of %d lines", n_threads,
+      band_height);
+
+  g_mutex_init (&convert->lock);
+  g_cond_init (&convert->cond);
+  g_cond_init (&convert->done_cond);
+
+  convert->n_threads = n_threads;
+  convert->bands = g_new0 (VideoConvertBand, n_threads);
+  for (i = 0; i < n_threads; i++) {
+    VideoConvertBand *band = &convert->bands[i];
+
+    band->convert = convert;
+    band->y = i * band_height;
+    band->height = MIN (band_height, height - band->y);
+    band->tmpline = g_malloc (sizeof (guint8) * (width + 8) * 4);
+    band->tmpline16 = g_malloc (sizeof (guint16) * (width + 8) * 4);
+    band->errline = g_malloc0 (sizeof (guint16) * width * 4);
+
+    /* the first band is converted by the calling thread */
+    if (i > 0)
+      band->thread = g_thread_new ("videoconvert",
+          (GThreadFunc) videoconvert_band_thread, band);
+  }
 
   if (GST_VIDEO_INFO_FORMAT (out_info) == GST_VIDEO_FORMAT_RGB8P) {
     /* build poor man's palette, taken from ffmpegcolorspace */
@@ -106,10 +137,30 @@ no_convert:
 void
 videoconvert_convert_free (VideoConvert * convert)
 {
+  guint i;
+
+  if (convert->bands) {
+    g_mutex_lock (&convert->lock);
+    convert->shutdown = TRUE;
+    g_cond_broadcast (&convert->cond);
+    g_mutex_unlock (&convert->lock);
+
+    for (i = 0; i < convert->n_threads; i++) {
+      VideoConvertBand *band = &convert->bands[i];
+
+      if (band->thread)
+        g_thread_join (band->thread);
+      g_free (band->tmpline);
+      g_free (band->tmpline16);
+      g_free (band->errline);
+    }
+    g_free (convert->bands);
+
+    g_mutex_clear (&convert->lock);
+    g_cond_clear (&convert->cond);
+    g_cond_clear (&convert->done_cond);
+  }
   g_free (convert->palette);
-  g_free (convert->tmpline);
-  g_free (convert->tmpline16);
-  g_free (convert->errline);
 
   g_free (convert);
 }
@@ -131,11 +182,69 @@ videoconvert_convert_set_dither (VideoConvert * convert, int type)
   }
 }
 
+static void
+videoconvert_convert_band (VideoConvert * convert, GstVideoFrame * dest,
+    const GstVideoFrame * src, VideoConvertBand * band)
+{
+  if (band->height > 0)
+    convert->convert (convert, dest, src, band);
+}
+
+static gpointer
+videoconvert_band_thread (VideoConvertBand * band)
+{
+  VideoConvert *convert = band->convert;
+  guint cookie = 0;
+
+  g_mutex_lock (&convert->lock);
+  while (TRUE) {
+    while (!convert->shutdown && convert->cookie == cookie)
+      g_cond_wait (&convert->cond, &convert->lock);
+    if (convert->shutdown)
+      break;
+    cookie = convert->cookie;
+    g_mutex_unlock (&convert->lock);
+
+    videoconvert_convert_band (convert, convert->dest, convert->src, band);
+
+    g_mutex_lock (&convert->lock);
+    if (--convert->pending == 0)
+      g_cond_signal (&convert->done_cond);
+  }
+  g_mutex_unlock (&convert->lock);
+
+  return NULL;
+}
+
 void
 videoconvert_convert_convert (VideoConvert * convert,
     GstVideoFrame * dest, const GstVideoFrame * src)
 {
-  convert->convert (convert, dest, src);
+  if (convert->n_threads > 1) {
+    /* wake up the workers for the other bands */
+    g_mutex_lock (&convert->lock);
+    convert->dest = dest;
+    convert->src = src;
+    convert->pending = convert->n_threads - 1;
+    convert->cookie++;
+    g_cond_broadcast (&convert->cond);
+    g_mutex_unlock (&convert->lock);
+  }
+
+  videoconvert_convert_band (convert, dest, src, &convert->bands[0]);
+
+  if (convert->n_threads > 1) {
+    g_mutex_lock (&convert->lock);
+    while (convert->pending > 0)
+      g_cond_wait (&convert->done_cond, &convert->lock);
+    convert->dest = NULL;
+    convert->src = NULL;
+    g_mutex_unlock (&convert->lock);
+  }
+
+  if (GST_VIDEO_FRAME_FORMAT (dest) == GST_VIDEO_FORMAT_RGB8P) {
+    memcpy (GST_VIDEO_FRAME_PLANE_DATA (dest, 1), convert->palette, 256 * 4);
+  }
 }
 
 static void
@@ -345,11 +454,12 @@ no_pack_func:
 }
 
 static void
-videoconvert_dither_verterr (VideoConvert * convert, guint16 * pixels, int j)
+videoconvert_dither_verterr (VideoConvert * convert, VideoConvertBand * band,
+    guint16 * pixels, int j)
 {
   int i;
-  guint16 *tmpline = convert->tmpline16;
-  guint16 *errline = convert->errline;
+  guint16 *tmpline = pixels;
+  guint16 *errline = band->errline;
   unsigned int mask = 0xff;
 
   for (i = 0; i < 4 * convert->width; i++) {
@@ -362,10 +472,11 @@ videoconvert_dither_verterr (VideoConvert * convert, guint16 * pixels, int j)
 }
 
 static void
-videoconvert_dither_halftone (VideoConvert * convert, guint16 * pixels, int j)
+videoconvert_dither_halftone (VideoConvert * convert, VideoConvertBand * band,
+    guint16 * pixels, int j)
 {
   int i;
-  guint16 *tmpline = convert->tmpline16;
+  guint16 *tmpline = pixels;
   static guint16 halftone[8][8] = {
     {0, 128, 32, 160, 8, 136, 40, 168},
     {192, 64, 224, 96, 200, 72, 232, 104},
@@ -397,52 +508,55 @@ videoconvert_dither_halftone (VideoConvert * convert, guint16 * pixels, int j)
 
 static void
 videoconvert_convert_generic (VideoConvert * convert, GstVideoFrame * dest,
-    const GstVideoFrame * src)
+    const GstVideoFrame * src, VideoConvertBand * band)
 {
   int i, j;
-  gint width, height;
+  gint width, y, height;
   guint in_bits, out_bits;
+  guint8 *tmpline;
+  guint16 *tmpline16;
 
-  height = convert->height;
+  y = band->y;
+  height = band->height;
   width = convert->width;
 
   in_bits = convert->in_bits;
   out_bits = convert->out_bits;
 
-  for (j = 0; j < height; j++) {
+  tmpline = band->tmpline;
+  tmpline16 = band->tmpline16;
+
+  for (j = y; j < y + height; j++) {
     if (in_bits == 16) {
-      UNPACK_FRAME (src, convert->tmpline16, j, width);
+      UNPACK_FRAME (src, tmpline16, j, width);
     } else {
-      UNPACK_FRAME (src, convert->tmpline, j, width);
+      UNPACK_FRAME (src, tmpline, j, width);
 
       if (out_bits == 16)
         for (i = 0; i < width * 4; i++)
-          convert->tmpline16[i] = TO_16 (convert->tmpline[i]);
+          tmpline16[i] = TO_16 (tmpline[i]);
     }
 
     if (out_bits == 16 || in_bits == 16) {
       if (convert->matrix16)
-        convert->matrix16 (convert, convert->tmpline16);
+        convert->matrix16 (convert, tmpline16);
       if (convert->dither16)
-        convert->dither16 (convert, convert->tmpline16, j);
+        convert->dither16 (convert, band, tmpline16, j);
     } else {
       if (convert->matrix)
-        convert->matrix (convert, convert->tmpline);
+        convert->matrix (convert, tmpline);
     }
 
     if (out_bits == 16) {
-      PACK_FRAME (dest, convert->tmpline16, j, width);
+      PACK_FRAME (dest, tmpline16, j, width);
     } else {
       if (in_bits == 16)
         for (i = 0; i < width * 4; i++)
-          convert->tmpline[i] = convert->tmpline16[i] >> 8;
+          tmpline[i] = tmpline16[i] >> 8;
 
-      PACK_FRAME (dest, convert->tmpline, j, width);
+      PACK_FRAME (dest, tmpline, j, width);
     }
   }
-  if (GST_VIDEO_FRAME_FORMAT (dest) == GST_VIDEO_FORMAT_RGB8P) {
-    memcpy (GST_VIDEO_FRAME_PLANE_DATA (dest, 1), convert->palette, 256 * 4);
-  }
 }
 
 #define FRAME_GET_PLANE_STRIDE(frame, plane) \
@@ -474,13 +588,14 @@ videoconvert_convert_generic (VideoConvert * convert, GstVideoFrame * dest,
 
 static void
 convert_I420_YUY2 (VideoConvert * convert, GstVideoFrame * dest,
-    const GstVideoFrame * src)
+    const GstVideoFrame * src, VideoConvertBand * band)
 {
   int i;
   gint width = convert->width;
-  gint height = convert->height;
+  gint y = band->y;
+  gint height = band->height;
 
-  for (i = 0; i < GST_ROUND_DOWN_2 (height); i += 2) {
+  for (i = y; i < y + GST_ROUND_DOWN_2 (height); i += 2) {
     video_convert_orc_convert_I420_YUY2 (FRAME_GET_LINE (dest, i),
         FRAME_GET_LINE (dest, i + 1),
         FRAME_GET_Y_LINE (src, i),
@@ -491,20 +606,21 @@ convert_I420_YUY2 (VideoConvert * convert, GstVideoFrame * dest,
 
   /* now handle last line */
   if (height & 1) {
-    UNPACK_FRAME (src, convert->tmpline, height - 1, width);
-    PACK_FRAME (dest, convert->tmpline, height - 1, width);
+    UNPACK_FRAME (src, band->tmpline, y + height - 1, width);
+    PACK_FRAME (dest, band->tmpline, y + height - 1, width);
   }
 }
 
 static void
 convert_I420_UYVY (VideoConvert * convert, GstVideoFrame * dest,
-    const GstVideoFrame * src)
+    const GstVideoFrame * src, VideoConvertBand * band)
 {
   int i;
   gint width = convert->width;
-  gint height = convert->height;
+  gint y = band->y;
+  gint height = band->height;
 
-  for (i = 0; i < GST_ROUND_DOWN_2 (height); i += 2) {
+  for (i = y; i < y + GST_ROUND_DOWN_2 (height); i += 2) {
     video_convert_orc_convert_I420_UYVY (FRAME_GET_LINE (dest, i),
         FRAME_GET_LINE (dest, i + 1),
         FRAME_GET_Y_LINE (src, i),
@@ -515,20 +631,21 @@ convert_I420_UYVY (VideoConvert * convert, GstVideoFrame * dest,
 
   /* now handle last line */
   if (height & 1) {
-    UNPACK_FRAME (src, convert->tmpline, height - 1, width);
-    PACK_FRAME (dest, convert->tmpline, height - 1, width);
+    UNPACK_FRAME (src, band->tmpline, y + height - 1, width);
+    PACK_FRAME (dest, band->tmpline, y + height - 1, width);
   }
 }
 
 static void
 convert_I420_AYUV (VideoConvert * convert, GstVideoFrame * dest,
-    const GstVideoFrame * src)
+    const GstVideoFrame * src, VideoConvertBand * band)
 {
   int i;
   gint width = convert->width;
-  gint height = convert->height;
+  gint y = band->y;
+  gint height = band->height;
 
-  for (i = 0; i < GST_ROUND_DOWN_2 (height); i += 2) {
+  for (i = y; i < y + GST_ROUND_DOWN_2 (height); i += 2) {
     video_convert_orc_convert_I420_AYUV (FRAME_GET_LINE (dest, i),
         FRAME_GET_LINE (dest, i + 1),
         FRAME_GET_Y_LINE (src, i),
@@ -538,74 +655,77 @@ convert_I420_AYUV (VideoConvert * convert, GstVideoFrame * dest,
 
   /* now handle last line */
   if (height & 1) {
-    UNPACK_FRAME (src, convert->tmpline, height - 1, width);
-    PACK_FRAME (dest, convert->tmpline, height - 1, width);
+    UNPACK_FRAME (src, band->tmpline, y + height - 1, width);
+    PACK_FRAME (dest, band->tmpline, y + height - 1, width);
   }
 }
 
 static void
 convert_I420_Y42B (VideoConvert * convert, GstVideoFrame * dest,
-    const GstVideoFrame * src)
+    const GstVideoFrame * src, VideoConvertBand * band)
 {
   gint width = convert->width;
-  gint height = convert->height;
+  gint y = band->y;
+  gint height = band->height;
 
-  video_convert_orc_memcpy_2d (FRAME_GET_Y_LINE (dest, 0),
-      FRAME_GET_Y_STRIDE (dest), FRAME_GET_Y_LINE (src, 0),
+  video_convert_orc_memcpy_2d (FRAME_GET_Y_LINE (dest, y),
+      FRAME_GET_Y_STRIDE (dest), FRAME_GET_Y_LINE (src, y),
       FRAME_GET_Y_STRIDE (src), width, height);
 
-  video_convert_orc_planar_chroma_420_422 (FRAME_GET_U_LINE (dest, 0),
-      2 * FRAME_GET_U_STRIDE (dest), FRAME_GET_U_LINE (dest, 1),
-      2 * FRAME_GET_U_STRIDE (dest), FRAME_GET_U_LINE (src, 0),
+  video_convert_orc_planar_chroma_420_422 (FRAME_GET_U_LINE (dest, y),
+      2 * FRAME_GET_U_STRIDE (dest), FRAME_GET_U_LINE (dest, y + 1),
+      2 * FRAME_GET_U_STRIDE (dest), FRAME_GET_U_LINE (src, y / 2),
       FRAME_GET_U_STRIDE (src), (width + 1) / 2, height / 2);
 
-  video_convert_orc_planar_chroma_420_422 (FRAME_GET_V_LINE (dest, 0),
-      2 * FRAME_GET_V_STRIDE (dest), FRAME_GET_V_LINE (dest, 1),
-      2 * FRAME_GET_V_STRIDE (dest), FRAME_GET_V_LINE (src, 0),
+  video_convert_orc_planar_chroma_420_422 (FRAME_GET_V_LINE (dest, y),
+      2 * FRAME_GET_V_STRIDE (dest), FRAME_GET_V_LINE (dest, y + 1),
+      2 * FRAME_GET_V_STRIDE (dest), FRAME_GET_V_LINE (src, y / 2),
       FRAME_GET_V_STRIDE (src), (width + 1) / 2, height / 2);
 }
 
 static void
 convert_I420_Y444 (VideoConvert * convert, GstVideoFrame * dest,
-    const GstVideoFrame * src)
+    const GstVideoFrame * src, VideoConvertBand * band)
 {
   gint width = convert->width;
-  gint height = convert->height;
+  gint y = band->y;
+  gint height = band->height;
 
-  video_convert_orc_memcpy_2d (FRAME_GET_Y_LINE (dest, 0),
-      FRAME_GET_Y_STRIDE (dest), FRAME_GET_Y_LINE (src, 0),
+  video_convert_orc_memcpy_2d (FRAME_GET_Y_LINE (dest, y),
+      FRAME_GET_Y_STRIDE (dest), FRAME_GET_Y_LINE (src, y),
       FRAME_GET_Y_STRIDE (src), width, height);
 
-  video_convert_orc_planar_chroma_420_444 (FRAME_GET_U_LINE (dest, 0),
-      2 * FRAME_GET_U_STRIDE (dest), FRAME_GET_U_LINE (dest, 1),
-      2 * FRAME_GET_U_STRIDE (dest), FRAME_GET_U_LINE (src, 0),
+  video_convert_orc_planar_chroma_420_444 (FRAME_GET_U_LINE (dest, y),
+      2 * FRAME_GET_U_STRIDE (dest), FRAME_GET_U_LINE (dest, y + 1),
+      2 * FRAME_GET_U_STRIDE (dest), FRAME_GET_U_LINE (src, y / 2),
       FRAME_GET_U_STRIDE (src), (width + 1) / 2, height / 2);
 
-  video_convert_orc_planar_chroma_420_444 (FRAME_GET_V_LINE (dest, 0),
-      2 * FRAME_GET_V_STRIDE (dest), FRAME_GET_V_LINE (dest, 1),
-      2 * FRAME_GET_V_STRIDE (dest), FRAME_GET_V_LINE (src, 0),
+  video_convert_orc_planar_chroma_420_444 (FRAME_GET_V_LINE (dest, y),
+      2 * FRAME_GET_V_STRIDE (dest), FRAME_GET_V_LINE (dest, y + 1),
+      2 * FRAME_GET_V_STRIDE (dest), FRAME_GET_V_LINE (src, y / 2),
       FRAME_GET_V_STRIDE (src), (width + 1) / 2, height / 2);
 
   /* now handle last line */
   if (height & 1) {
-    UNPACK_FRAME (src, convert->tmpline, height - 1, width);
-    PACK_FRAME (dest, convert->tmpline, height - 1, width);
+    UNPACK_FRAME (src, band->tmpline, y + height - 1, width);
+    PACK_FRAME (dest, band->tmpline, y + height - 1, width);
   }
 }
 
 static void
 convert_YUY2_I420 (VideoConvert * convert, GstVideoFrame * dest,
-    const GstVideoFrame * src)
+    const GstVideoFrame * src, VideoConvertBand * band)
 {
   int i, h;
   gint width = convert->width;
-  gint height = convert->height;
+  gint y = band->y;
+  gint height = band->height;
 
-  h = height;
+  h = GST_ROUND_DOWN_2 (height);
   if (width & 1)
     h--;
 
-  for (i = 0; i < h; i += 2) {
+  for (i = y; i < y + h; i += 2) {
     video_convert_orc_convert_YUY2_I420 (FRAME_GET_Y_LINE (dest, i),
         FRAME_GET_Y_LINE (dest, i + 1),
         FRAME_GET_U_LINE (dest, i >> 1),
@@ -615,68 +735,72 @@ convert_YUY2_I420 (VideoConvert * convert, GstVideoFrame * dest,
 
   /* now handle last line */
   if (height & 1) {
-    UNPACK_FRAME (src, convert->tmpline, height - 1, width);
-    PACK_FRAME (dest, convert->tmpline, height - 1, width);
+    UNPACK_FRAME (src, band->tmpline, y + height - 1, width);
+    PACK_FRAME (dest, band->tmpline, y + height - 1, width);
   }
 }
 
 static void
 convert_YUY2_AYUV (VideoConvert * convert, GstVideoFrame * dest,
-    const GstVideoFrame * src)
+    const GstVideoFrame * src, VideoConvertBand * band)
 {
   gint width = convert->width;
-  gint height = convert->height;
+  gint y = band->y;
+  gint height = band->height;
 
-  video_convert_orc_convert_YUY2_AYUV (FRAME_GET_LINE (dest, 0),
-      FRAME_GET_STRIDE (dest), FRAME_GET_LINE (src, 0),
+  video_convert_orc_convert_YUY2_AYUV (FRAME_GET_LINE (dest, y),
+      FRAME_GET_STRIDE (dest), FRAME_GET_LINE (src, y),
       FRAME_GET_STRIDE (src), (width + 1) / 2,
       height & 1 ? height - 1 : height);
 
   /* now handle last line */
   if (height & 1) {
-    UNPACK_FRAME (src, convert->tmpline, height - 1, width);
-    PACK_FRAME (dest, convert->tmpline, height - 1, width);
+    UNPACK_FRAME (src, band->tmpline, y + height - 1, width);
+    PACK_FRAME (dest, band->tmpline, y + height - 1, width);
   }
 }
 
 static void
 convert_YUY2_Y42B (VideoConvert * convert, GstVideoFrame * dest,
-    const GstVideoFrame * src)
+    const GstVideoFrame * src, VideoConvertBand * band)
 {
   gint width = convert->width;
-  gint height = convert->height;
+  gint y = band->y;
+  gint height = band->height;
 
-  video_convert_orc_convert_YUY2_Y42B (FRAME_GET_Y_LINE (dest, 0),
-      FRAME_GET_Y_STRIDE (dest), FRAME_GET_U_LINE (dest, 0),
-      FRAME_GET_U_STRIDE (dest), FRAME_GET_V_LINE (dest, 0),
-      FRAME_GET_V_STRIDE (dest), FRAME_GET_LINE (src, 0),
+  video_convert_orc_convert_YUY2_Y42B (FRAME_GET_Y_LINE (dest, y),
+      FRAME_GET_Y_STRIDE (dest), FRAME_GET_U_LINE (dest, y),
+      FRAME_GET_U_STRIDE (dest), FRAME_GET_V_LINE (dest, y),
+      FRAME_GET_V_STRIDE (dest), FRAME_GET_LINE (src, y),
       FRAME_GET_STRIDE (src), (width + 1) / 2, height);
 }
 
 static void
 convert_YUY2_Y444 (VideoConvert * convert, GstVideoFrame * dest,
-    const GstVideoFrame * src)
+    const GstVideoFrame * src, VideoConvertBand * band)
 {
   gint width = convert->width;
-  gint height = convert->height;
+  gint y = band->y;
+  gint height = band->height;
 
-  video_convert_orc_convert_YUY2_Y444 (FRAME_GET_COMP_LINE (dest, 0, 0),
-      FRAME_GET_COMP_STRIDE (dest, 0), FRAME_GET_COMP_LINE (dest, 1, 0),
-      FRAME_GET_COMP_STRIDE (dest, 1), FRAME_GET_COMP_LINE (dest, 2, 0),
-      FRAME_GET_COMP_STRIDE (dest, 2), FRAME_GET_LINE (src, 0),
+  video_convert_orc_convert_YUY2_Y444 (FRAME_GET_COMP_LINE (dest, 0, y),
+      FRAME_GET_COMP_STRIDE (dest, 0), FRAME_GET_COMP_LINE (dest, 1, y),
+      FRAME_GET_COMP_STRIDE (dest, 1), FRAME_GET_COMP_LINE (dest, 2, y),
+      FRAME_GET_COMP_STRIDE (dest, 2), FRAME_GET_LINE (src, y),
       FRAME_GET_STRIDE (src), (width + 1) / 2, height);
 }
 
 
 static void
 convert_UYVY_I420 (VideoConvert * convert, GstVideoFrame * dest,
-    const GstVideoFrame * src)
+    const GstVideoFrame * src, VideoConvertBand * band)
 {
   int i;
   gint width = convert->width;
-  gint height = convert->height;
+  gint y = band->y;
+  gint height = band->height;
 
-  for (i = 0; i < GST_ROUND_DOWN_2 (height); i += 2) {
+  for (i = y; i < y + GST_ROUND_DOWN_2 (height); i += 2) {
     video_convert_orc_convert_UYVY_I420 (FRAME_GET_COMP_LINE (dest, 0, i),
         FRAME_GET_COMP_LINE (dest, 0, i + 1),
         FRAME_GET_COMP_LINE (dest, 1, i >> 1),
@@ -686,385 +810,409 @@ convert_UYVY_I420 (VideoConvert * convert, GstVideoFrame * dest,
 
   /* now handle last line */
   if (height & 1) {
-    UNPACK_FRAME (src, convert->tmpline, height - 1, width);
-    PACK_FRAME (dest, convert->tmpline, height - 1, width);
+    UNPACK_FRAME (src, band->tmpline, y + height - 1, width);
+    PACK_FRAME (dest, band->tmpline, y + height - 1, width);
   }
 }
 
 static void
 convert_UYVY_AYUV (VideoConvert * convert, GstVideoFrame * dest,
-    const GstVideoFrame * src)
+    const GstVideoFrame * src, VideoConvertBand * band)
 {
   gint width = convert->width;
-  gint height = convert->height;
+  gint y = band->y;
+  gint height = band->height;
 
-  video_convert_orc_convert_UYVY_AYUV (FRAME_GET_LINE (dest, 0),
-      FRAME_GET_STRIDE (dest), FRAME_GET_LINE (src, 0),
+  video_convert_orc_convert_UYVY_AYUV (FRAME_GET_LINE (dest, y),
+      FRAME_GET_STRIDE (dest), FRAME_GET_LINE (src, y),
       FRAME_GET_STRIDE (src), (width + 1) / 2,
       height & 1 ? height - 1 : height);
 
   /* now handle last line */
   if (height & 1) {
-    UNPACK_FRAME (src, convert->tmpline, height - 1, width);
-    PACK_FRAME (dest, convert->tmpline, height - 1, width);
+    UNPACK_FRAME (src, band->tmpline, y + height - 1, width);
+    PACK_FRAME (dest, band->tmpline, y + height - 1, width);
   }
 }
 
 static void
 convert_UYVY_YUY2 (VideoConvert * convert, GstVideoFrame * dest,
-    const GstVideoFrame * src)
+    const GstVideoFrame * src, VideoConvertBand * band)
 {
   gint width = convert->width;
-  gint height = convert->height;
+  gint y = band->y;
+  gint height = band->height;
 
-  video_convert_orc_convert_UYVY_YUY2 (FRAME_GET_LINE (dest, 0),
-      FRAME_GET_STRIDE (dest), FRAME_GET_LINE (src, 0),
+  video_convert_orc_convert_UYVY_YUY2 (FRAME_GET_LINE (dest, y),
+      FRAME_GET_STRIDE (dest), FRAME_GET_LINE (src, y),
       FRAME_GET_STRIDE (src), (width + 1) / 2, height);
 }
 
 static void
 convert_UYVY_Y42B (VideoConvert * convert, GstVideoFrame * dest,
-    const GstVideoFrame * src)
+    const GstVideoFrame * src, VideoConvertBand * band)
 {
   gint width = convert->width;
-  gint height = convert->height;
+  gint y = band->y;
+  gint height = band->height;
 
-  video_convert_orc_convert_UYVY_Y42B (FRAME_GET_Y_LINE (dest, 0),
-      FRAME_GET_Y_STRIDE (dest), FRAME_GET_U_LINE (dest, 0),
-      FRAME_GET_U_STRIDE (dest), FRAME_GET_V_LINE (dest, 0),
-      FRAME_GET_V_STRIDE (dest), FRAME_GET_LINE (src, 0),
+  video_convert_orc_convert_UYVY_Y42B (FRAME_GET_Y_LINE (dest, y),
+      FRAME_GET_Y_STRIDE (dest), FRAME_GET_U_LINE (dest, y),
+      FRAME_GET_U_STRIDE (dest), FRAME_GET_V_LINE (dest, y),
+      FRAME_GET_V_STRIDE (dest), FRAME_GET_LINE (src, y),
       FRAME_GET_STRIDE (src), (width + 1) / 2, height);
 }
 
 static void
 convert_UYVY_Y444 (VideoConvert * convert, GstVideoFrame * dest,
-    const GstVideoFrame * src)
+    const GstVideoFrame * src, VideoConvertBand * band)
 {
   gint width = convert->width;
-  gint height = convert->height;
+  gint y = band->y;
+  gint height = band->height;
 
-  video_convert_orc_convert_UYVY_Y444 (FRAME_GET_Y_LINE (dest, 0),
-      FRAME_GET_Y_STRIDE (dest), FRAME_GET_U_LINE (dest, 0),
-      FRAME_GET_U_STRIDE (dest), FRAME_GET_V_LINE (dest, 0),
-      FRAME_GET_V_STRIDE (dest), FRAME_GET_LINE (src, 0),
+  video_convert_orc_convert_UYVY_Y444 (FRAME_GET_Y_LINE (dest, y),
+      FRAME_GET_Y_STRIDE (dest), FRAME_GET_U_LINE (dest, y),
+      FRAME_GET_U_STRIDE (dest), FRAME_GET_V_LINE (dest, y),
+      FRAME_GET_V_STRIDE (dest), FRAME_GET_LINE (src, y),
       FRAME_GET_STRIDE (src), (width + 1) / 2, height);
 }
 
 static void
 convert_AYUV_I420 (VideoConvert * convert, GstVideoFrame * dest,
-    const GstVideoFrame * src)
+    const GstVideoFrame * src, VideoConvertBand * band)
 {
   gint width = convert->width;
-  gint height = convert->height;
-
-  video_convert_orc_convert_AYUV_I420 (FRAME_GET_Y_LINE (dest, 0),
-      2 * FRAME_GET_Y_STRIDE (dest), FRAME_GET_Y_LINE (dest, 1),
-      2 * FRAME_GET_Y_STRIDE (dest), FRAME_GET_U_LINE (dest, 0),
-      FRAME_GET_U_STRIDE (dest), FRAME_GET_V_LINE (dest, 0),
-      FRAME_GET_V_STRIDE (dest), FRAME_GET_LINE (src, 0),
-      2 * FRAME_GET_STRIDE (src), FRAME_GET_LINE (src, 1),
+  gint y = band->y;
+  gint height = band->height;
+
+  video_convert_orc_convert_AYUV_I420 (FRAME_GET_Y_LINE (dest, y),
+      2 * FRAME_GET_Y_STRIDE (dest), FRAME_GET_Y_LINE (dest, y + 1),
+      2 * FRAME_GET_Y_STRIDE (dest), FRAME_GET_U_LINE (dest, y / 2),
+      FRAME_GET_U_STRIDE (dest), FRAME_GET_V_LINE (dest, y / 2),
+      FRAME_GET_V_STRIDE (dest), FRAME_GET_LINE (src, y),
+      2 * FRAME_GET_STRIDE (src), FRAME_GET_LINE (src, y + 1),
       2 * FRAME_GET_STRIDE (src), width / 2, height / 2);
 }
 
 static void
 convert_AYUV_YUY2 (VideoConvert * convert, GstVideoFrame * dest,
-    const GstVideoFrame * src)
+    const GstVideoFrame * src, VideoConvertBand * band)
 {
   gint width = convert->width;
-  gint height = convert->height;
+  gint y = band->y;
+  gint height = band->height;
 
-  video_convert_orc_convert_AYUV_YUY2 (FRAME_GET_LINE (dest, 0),
-      FRAME_GET_STRIDE (dest), FRAME_GET_LINE (src, 0),
+  video_convert_orc_convert_AYUV_YUY2 (FRAME_GET_LINE (dest, y),
+      FRAME_GET_STRIDE (dest), FRAME_GET_LINE (src, y),
       FRAME_GET_STRIDE (src), width / 2, height);
 }
 
 static void
 convert_AYUV_UYVY (VideoConvert * convert, GstVideoFrame * dest,
-    const GstVideoFrame * src)
+    const GstVideoFrame * src, VideoConvertBand * band)
 {
   gint width = convert->width;
-  gint height = convert->height;
+  gint y = band->y;
+  gint height = band->height;
 
-  video_convert_orc_convert_AYUV_UYVY (FRAME_GET_LINE (dest, 0),
-      FRAME_GET_STRIDE (dest), FRAME_GET_LINE (src, 0),
+  video_convert_orc_convert_AYUV_UYVY (FRAME_GET_LINE (dest, y),
+      FRAME_GET_STRIDE (dest), FRAME_GET_LINE (src, y),
       FRAME_GET_STRIDE (src), width / 2, height);
 }
 
 static void
 convert_AYUV_Y42B (VideoConvert * convert, GstVideoFrame * dest,
-    const GstVideoFrame * src)
+    const GstVideoFrame * src, VideoConvertBand * band)
 {
   gint width = convert->width;
-  gint height = convert->height;
+  gint y = band->y;
+  gint height = band->height;
 
-  video_convert_orc_convert_AYUV_Y42B (FRAME_GET_Y_LINE (dest, 0),
-      FRAME_GET_Y_STRIDE (dest), FRAME_GET_U_LINE (dest, 0),
-      FRAME_GET_U_STRIDE (dest), FRAME_GET_V_LINE (dest, 0),
-      FRAME_GET_V_STRIDE (dest), FRAME_GET_LINE (src, 0),
+  video_convert_orc_convert_AYUV_Y42B (FRAME_GET_Y_LINE (dest, y),
+      FRAME_GET_Y_STRIDE (dest), FRAME_GET_U_LINE (dest, y),
+      FRAME_GET_U_STRIDE (dest), FRAME_GET_V_LINE (dest, y),
+      FRAME_GET_V_STRIDE (dest), FRAME_GET_LINE (src, y),
       FRAME_GET_STRIDE (src), (width + 1) / 2,
       height & 1 ? height - 1 : height);
 
   /* now handle last line */
   if (height & 1) {
-    UNPACK_FRAME (src, convert->tmpline, height - 1, width);
-    PACK_FRAME (dest, convert->tmpline, height - 1, width);
+    UNPACK_FRAME (src, band->tmpline, y + height - 1, width);
+    PACK_FRAME (dest, band->tmpline, y + height - 1, width);
   }
 }
 
 static void
 convert_AYUV_Y444 (VideoConvert * convert, GstVideoFrame * dest,
-    const GstVideoFrame * src)
+    const GstVideoFrame * src, VideoConvertBand * band)
 {
   gint width = convert->width;
-  gint height = convert->height;
+  gint y = band->y;
+  gint height = band->height;
 
-  video_convert_orc_convert_AYUV_Y444 (FRAME_GET_Y_LINE (dest, 0),
-      FRAME_GET_Y_STRIDE (dest), FRAME_GET_U_LINE (dest, 0),
-      FRAME_GET_U_STRIDE (dest), FRAME_GET_V_LINE (dest, 0),
-      FRAME_GET_V_STRIDE (dest), FRAME_GET_LINE (src, 0),
+  video_convert_orc_convert_AYUV_Y444 (FRAME_GET_Y_LINE (dest, y),
+      FRAME_GET_Y_STRIDE (dest), FRAME_GET_U_LINE (dest, y),
+      FRAME_GET_U_STRIDE (dest), FRAME_GET_V_LINE (dest, y),
+      FRAME_GET_V_STRIDE (dest), FRAME_GET_LINE (src, y),
       FRAME_GET_STRIDE (src), width, height);
 }
 
 static void
 convert_Y42B_I420 (VideoConvert * convert, GstVideoFrame * dest,
-    const GstVideoFrame * src)
+    const GstVideoFrame * src, VideoConvertBand * band)
 {
   gint width = convert->width;
-  gint height = convert->height;
+  gint y = band->y;
+  gint height = band->height;
 
-  video_convert_orc_memcpy_2d (FRAME_GET_Y_LINE (dest, 0),
-      FRAME_GET_Y_STRIDE (dest), FRAME_GET_Y_LINE (src, 0),
+  video_convert_orc_memcpy_2d (FRAME_GET_Y_LINE (dest, y),
+      FRAME_GET_Y_STRIDE (dest), FRAME_GET_Y_LINE (src, y),
       FRAME_GET_Y_STRIDE (src), width, height);
 
-  video_convert_orc_planar_chroma_422_420 (FRAME_GET_U_LINE (dest, 0),
-      FRAME_GET_U_STRIDE (dest), FRAME_GET_U_LINE (src, 0),
-      2 * FRAME_GET_U_STRIDE (src), FRAME_GET_U_LINE (src, 1),
+  video_convert_orc_planar_chroma_422_420 (FRAME_GET_U_LINE (dest, y / 2),
+      FRAME_GET_U_STRIDE (dest), FRAME_GET_U_LINE (src, y),
+      2 * FRAME_GET_U_STRIDE (src), FRAME_GET_U_LINE (src, y + 1),
       2 * FRAME_GET_U_STRIDE (src), (width + 1) / 2, height / 2);
 
-  video_convert_orc_planar_chroma_422_420 (FRAME_GET_V_LINE (dest, 0),
-      FRAME_GET_V_STRIDE (dest), FRAME_GET_V_LINE (src, 0),
-      2 * FRAME_GET_V_STRIDE (src), FRAME_GET_V_LINE (src, 1),
+  video_convert_orc_planar_chroma_422_420 (FRAME_GET_V_LINE (dest, y / 2),
+      FRAME_GET_V_STRIDE (dest), FRAME_GET_V_LINE (src, y),
+      2 * FRAME_GET_V_STRIDE (src), FRAME_GET_V_LINE (src, y + 1),
       2 * FRAME_GET_V_STRIDE (src), (width + 1) / 2, height / 2);
 
   /* now handle last line */
   if (height & 1) {
-    UNPACK_FRAME (src, convert->tmpline, height - 1, width);
-    PACK_FRAME (dest, convert->tmpline, height - 1, width);
+    UNPACK_FRAME (src, band->tmpline, y + height - 1, width);
+    PACK_FRAME (dest, band->tmpline, y + height - 1, width);
   }
 }
 
 static void
 convert_Y42B_Y444 (VideoConvert * convert, GstVideoFrame * dest,
-    const GstVideoFrame * src)
+    const GstVideoFrame * src, VideoConvertBand * band)
 {
   gint width = convert->width;
-  gint height = convert->height;
+  gint y = band->y;
+  gint height = band->height;
 
-  video_convert_orc_memcpy_2d (FRAME_GET_Y_LINE (dest, 0),
-      FRAME_GET_Y_STRIDE (dest), FRAME_GET_Y_LINE (src, 0),
+  video_convert_orc_memcpy_2d (FRAME_GET_Y_LINE (dest, y),
+      FRAME_GET_Y_STRIDE (dest), FRAME_GET_Y_LINE (src, y),
       FRAME_GET_Y_STRIDE (src), width, height);
 
-  video_convert_orc_planar_chroma_422_444 (FRAME_GET_U_LINE (dest, 0),
-      FRAME_GET_U_STRIDE (dest), FRAME_GET_U_LINE (src, 0),
+  video_convert_orc_planar_chroma_422_444 (FRAME_GET_U_LINE (dest, y),
+      FRAME_GET_U_STRIDE (dest), FRAME_GET_U_LINE (src, y),
       FRAME_GET_U_STRIDE (src), (width + 1) / 2, height);
 
-  video_convert_orc_planar_chroma_422_444 (FRAME_GET_V_LINE (dest, 0),
-      FRAME_GET_V_STRIDE (dest), FRAME_GET_V_LINE (src, 0),
+  video_convert_orc_planar_chroma_422_444 (FRAME_GET_V_LINE (dest, y),
+      FRAME_GET_V_STRIDE (dest), FRAME_GET_V_LINE (src, y),
       FRAME_GET_V_STRIDE (src), (width + 1) / 2, height);
 }
 
 static void
 convert_Y42B_YUY2 (VideoConvert * convert, GstVideoFrame * dest,
-    const GstVideoFrame * src)
+    const GstVideoFrame * src, VideoConvertBand * band)
 {
   gint width = convert->width;
-  gint height = convert->height;
+  gint y = band->y;
+  gint height = band->height;
 
-  video_convert_orc_convert_Y42B_YUY2 (FRAME_GET_LINE (dest, 0),
-      FRAME_GET_STRIDE (dest), FRAME_GET_Y_LINE (src, 0),
-      FRAME_GET_Y_STRIDE (src), FRAME_GET_U_LINE (src, 0),
-      FRAME_GET_U_STRIDE (src), FRAME_GET_V_LINE (src, 0),
+  video_convert_orc_convert_Y42B_YUY2 (FRAME_GET_LINE (dest, y),
+      FRAME_GET_STRIDE (dest), FRAME_GET_Y_LINE (src, y),
+      FRAME_GET_Y_STRIDE (src), FRAME_GET_U_LINE (src, y),
+      FRAME_GET_U_STRIDE (src), FRAME_GET_V_LINE (src, y),
       FRAME_GET_V_STRIDE (src), (width + 1) / 2, height);
 }
 
 static void
 convert_Y42B_UYVY (VideoConvert * convert, GstVideoFrame * dest,
-    const GstVideoFrame * src)
+    const GstVideoFrame * src, VideoConvertBand * band)
 {
   gint width = convert->width;
-  gint height = convert->height;
+  gint y = band->y;
+  gint height = band->height;
 
-  video_convert_orc_convert_Y42B_UYVY (FRAME_GET_LINE (dest, 0),
-      FRAME_GET_STRIDE (dest), FRAME_GET_Y_LINE (src, 0),
-      FRAME_GET_Y_STRIDE (src), FRAME_GET_U_LINE (src, 0),
-      FRAME_GET_U_STRIDE (src), FRAME_GET_V_LINE (src, 0),
+  video_convert_orc_convert_Y42B_UYVY (FRAME_GET_LINE (dest, y),
+      FRAME_GET_STRIDE (dest), FRAME_GET_Y_LINE (src, y),
+      FRAME_GET_Y_STRIDE (src), FRAME_GET_U_LINE (src, y),
+      FRAME_GET_U_STRIDE (src), FRAME_GET_V_LINE (src, y),
       FRAME_GET_V_STRIDE (src), (width + 1) / 2, height);
 }
 
 static void
 convert_Y42B_AYUV (VideoConvert * convert, GstVideoFrame * dest,
-    const GstVideoFrame * src)
+    const GstVideoFrame * src, VideoConvertBand * band)
 {
   gint width = convert->width;
-  gint height = convert->height;
+  gint y = band->y;
+  gint height = band->height;
 
-  video_convert_orc_convert_Y42B_AYUV (FRAME_GET_LINE (dest, 0),
-      FRAME_GET_STRIDE (dest), FRAME_GET_Y_LINE (src, 0),
-      FRAME_GET_Y_STRIDE (src), FRAME_GET_U_LINE (src, 0),
-      FRAME_GET_U_STRIDE (src), FRAME_GET_V_LINE (src, 0),
+  video_convert_orc_convert_Y42B_AYUV (FRAME_GET_LINE (dest, y),
+      FRAME_GET_STRIDE (dest), FRAME_GET_Y_LINE (src, y),
+      FRAME_GET_Y_STRIDE (src), FRAME_GET_U_LINE (src, y),
+      FRAME_GET_U_STRIDE (src), FRAME_GET_V_LINE (src, y),
       FRAME_GET_V_STRIDE (src), (width) / 2, height);
 }
 
 static void
 convert_Y444_I420 (VideoConvert * convert, GstVideoFrame * dest,
-    const GstVideoFrame * src)
+    const GstVideoFrame * src, VideoConvertBand * band)
 {
   gint width = convert->width;
-  gint height = convert->height;
+  gint y = band->y;
+  gint height = band->height;
 
-  video_convert_orc_memcpy_2d (FRAME_GET_Y_LINE (dest, 0),
-      FRAME_GET_Y_STRIDE (dest), FRAME_GET_Y_LINE (src, 0),
+  video_convert_orc_memcpy_2d (FRAME_GET_Y_LINE (dest, y),
+      FRAME_GET_Y_STRIDE (dest), FRAME_GET_Y_LINE (src, y),
       FRAME_GET_Y_STRIDE (src), width, height);
 
-  video_convert_orc_planar_chroma_444_420 (FRAME_GET_U_LINE (dest, 0),
-      FRAME_GET_U_STRIDE (dest), FRAME_GET_U_LINE (src, 0),
-      2 * FRAME_GET_U_STRIDE (src), FRAME_GET_U_LINE (src, 1),
+  video_convert_orc_planar_chroma_444_420 (FRAME_GET_U_LINE (dest, y / 2),
+      FRAME_GET_U_STRIDE (dest), FRAME_GET_U_LINE (src, y),
+      2 * FRAME_GET_U_STRIDE (src), FRAME_GET_U_LINE (src, y + 1),
       2 * FRAME_GET_U_STRIDE (src), (width + 1) / 2, height / 2);
 
-  video_convert_orc_planar_chroma_444_420 (FRAME_GET_V_LINE (dest, 0),
-      FRAME_GET_V_STRIDE (dest), FRAME_GET_V_LINE (src, 0),
-      2 * FRAME_GET_V_STRIDE (src), FRAME_GET_V_LINE (src, 1),
+  video_convert_orc_planar_chroma_444_420 (FRAME_GET_V_LINE (dest, y / 2),
+      FRAME_GET_V_STRIDE (dest), FRAME_GET_V_LINE (src, y),
+      2 * FRAME_GET_V_STRIDE (src), FRAME_GET_V_LINE (src, y + 1),
       2 * FRAME_GET_V_STRIDE (src), (width + 1) / 2, height / 2);
 
   /* now handle last line */
   if (height & 1) {
-    UNPACK_FRAME (src, convert->tmpline, height - 1, width);
-    PACK_FRAME (dest, convert->tmpline, height - 1, width);
+    UNPACK_FRAME (src, band->tmpline, y + height - 1, width);
+    PACK_FRAME (dest, band->tmpline, y + height - 1, width);
   }
 }
 
 static void
 convert_Y444_Y42B (VideoConvert * convert, GstVideoFrame * dest,
-    const GstVideoFrame * src)
+    const GstVideoFrame * src, VideoConvertBand * band)
 {
   gint width = convert->width;
-  gint height = convert->height;
+  gint y = band->y;
+  gint height = band->height;
 
-  video_convert_orc_memcpy_2d (FRAME_GET_Y_LINE (dest, 0),
-      FRAME_GET_Y_STRIDE (dest), FRAME_GET_Y_LINE (src, 0),
+  video_convert_orc_memcpy_2d (FRAME_GET_Y_LINE (dest, y),
+      FRAME_GET_Y_STRIDE (dest), FRAME_GET_Y_LINE (src, y),
       FRAME_GET_Y_STRIDE (src), width, height);
 
-  video_convert_orc_planar_chroma_444_422 (FRAME_GET_U_LINE (dest, 0),
-      FRAME_GET_U_STRIDE (dest), FRAME_GET_U_LINE (src, 0),
+  video_convert_orc_planar_chroma_444_422 (FRAME_GET_U_LINE (dest, y),
+      FRAME_GET_U_STRIDE (dest), FRAME_GET_U_LINE (src, y),
       FRAME_GET_U_STRIDE (src), (width + 1) / 2, height);
 
-  video_convert_orc_planar_chroma_444_422 (FRAME_GET_V_LINE (dest, 0),
-      FRAME_GET_V_STRIDE (dest), FRAME_GET_V_LINE (src, 0),
+  video_convert_orc_planar_chroma_444_422 (FRAME_GET_V_LINE (dest, y),
+      FRAME_GET_V_STRIDE (dest), FRAME_GET_V_LINE (src, y),
       FRAME_GET_V_STRIDE (src), (width + 1) / 2, height);
 }
 
 static void
 convert_Y444_YUY2 (VideoConvert * convert, GstVideoFrame * dest,
-    const GstVideoFrame * src)
+    const GstVideoFrame * src, VideoConvertBand * band)
 {
   gint width = convert->width;
-  gint height = convert->height;
+  gint y = band->y;
+  gint height = band->height;
 
-  video_convert_orc_convert_Y444_YUY2 (FRAME_GET_LINE (dest, 0),
-      FRAME_GET_STRIDE (dest), FRAME_GET_Y_LINE (src, 0),
-      FRAME_GET_Y_STRIDE (src), FRAME_GET_U_LINE (src, 0),
-      FRAME_GET_U_STRIDE (src), FRAME_GET_V_LINE (src, 0),
+  video_convert_orc_convert_Y444_YUY2 (FRAME_GET_LINE (dest, y),
+      FRAME_GET_STRIDE (dest), FRAME_GET_Y_LINE (src, y),
+      FRAME_GET_Y_STRIDE (src), FRAME_GET_U_LINE (src, y),
+      FRAME_GET_U_STRIDE (src), FRAME_GET_V_LINE (src, y),
       FRAME_GET_V_STRIDE (src), (width + 1) / 2, height);
 }
 
 static void
 convert_Y444_UYVY (VideoConvert * convert, GstVideoFrame * dest,
-    const GstVideoFrame * src)
+    const GstVideoFrame * src, VideoConvertBand * band)
 {
   gint width = convert->width;
-  gint height = convert->height;
+  gint y = band->y;
+  gint height = band->height;
 
-  video_convert_orc_convert_Y444_UYVY (FRAME_GET_LINE (dest, 0),
-      FRAME_GET_STRIDE (dest), FRAME_GET_Y_LINE (src, 0),
-      FRAME_GET_Y_STRIDE (src), FRAME_GET_U_LINE (src, 0),
-      FRAME_GET_U_STRIDE (src), FRAME_GET_V_LINE (src, 0),
+  video_convert_orc_convert_Y444_UYVY (FRAME_GET_LINE (dest, y),
+      FRAME_GET_STRIDE (dest), FRAME_GET_Y_LINE (src, y),
+      FRAME_GET_Y_STRIDE (src), FRAME_GET_U_LINE (src, y),
+      FRAME_GET_U_STRIDE (src), FRAME_GET_V_LINE (src, y),
       FRAME_GET_V_STRIDE (src), (width + 1) / 2, height);
 }
 
 static void
 convert_Y444_AYUV (VideoConvert * convert, GstVideoFrame * dest,
-    const GstVideoFrame * src)
+    const GstVideoFrame * src, VideoConvertBand * band)
 {
   gint width = convert->width;
-  gint height = convert->height;
+  gint y = band->y;
+  gint height = band->height;
 
-  video_convert_orc_convert_Y444_AYUV (FRAME_GET_LINE (dest, 0),
-      FRAME_GET_STRIDE (dest), FRAME_GET_Y_LINE (src, 0),
-      FRAME_GET_Y_STRIDE (src), FRAME_GET_U_LINE (src, 0),
-      FRAME_GET_U_STRIDE (src), FRAME_GET_V_LINE (src, 0),
+  video_convert_orc_convert_Y444_AYUV (FRAME_GET_LINE (dest, y),
+      FRAME_GET_STRIDE (dest), FRAME_GET_Y_LINE (src, y),
+      FRAME_GET_Y_STRIDE (src), FRAME_GET_U_LINE (src, y),
+      FRAME_GET_U_STRIDE (src), FRAME_GET_V_LINE (src, y),
       FRAME_GET_V_STRIDE (src), width, height);
 }
 
 #if G_BYTE_ORDER == G_LITTLE_ENDIAN
 static void
 convert_AYUV_ARGB (VideoConvert * convert, GstVideoFrame * dest,
-    const GstVideoFrame * src)
+    const GstVideoFrame * src, VideoConvertBand * band)
 {
   gint width = convert->width;
-  gint height = convert->height;
+  gint y = band->y;
+  gint height = band->height;
 
-  video_convert_orc_convert_AYUV_ARGB (FRAME_GET_LINE (dest, 0),
-      FRAME_GET_STRIDE (dest), FRAME_GET_LINE (src, 0),
+  video_convert_orc_convert_AYUV_ARGB (FRAME_GET_LINE (dest, y),
+      FRAME_GET_STRIDE (dest), FRAME_GET_LINE (src, y),
       FRAME_GET_STRIDE (src), width, height);
 }
 
 static void
 convert_AYUV_BGRA (VideoConvert * convert, GstVideoFrame * dest,
-    const GstVideoFrame * src)
+    const GstVideoFrame * src, VideoConvertBand * band)
 {
   gint width = convert->width;
-  gint height = convert->height;
+  gint y = band->y;
+  gint height = band->height;
 
-  video_convert_orc_convert_AYUV_BGRA (FRAME_GET_LINE (dest, 0),
-      FRAME_GET_STRIDE (dest), FRAME_GET_LINE (src, 0),
+  video_convert_orc_convert_AYUV_BGRA (FRAME_GET_LINE (dest, y),
+      FRAME_GET_STRIDE (dest), FRAME_GET_LINE (src, y),
       FRAME_GET_STRIDE (src), width, height);
 }
 
 static void
 convert_AYUV_ABGR (VideoConvert * convert, GstVideoFrame * dest,
-    const GstVideoFrame * src)
+    const GstVideoFrame * src, VideoConvertBand * band)
 {
   gint width = convert->width;
-  gint height = convert->height;
+  gint y = band->y;
+  gint height = band->height;
 
-  video_convert_orc_convert_AYUV_ABGR (FRAME_GET_LINE (dest, 0),
-      FRAME_GET_STRIDE (dest), FRAME_GET_LINE (src, 0),
+  video_convert_orc_convert_AYUV_ABGR (FRAME_GET_LINE (dest, y),
+      FRAME_GET_STRIDE (dest), FRAME_GET_LINE (src, y),
       FRAME_GET_STRIDE (src), width, height);
 }
 
 static void
 convert_AYUV_RGBA (VideoConvert * convert, GstVideoFrame * dest,
-    const GstVideoFrame * src)
+    const GstVideoFrame * src, VideoConvertBand * band)
 {
   gint width = convert->width;
-  gint height = convert->height;
+  gint y = band->y;
+  gint height = band->height;
 
-  video_convert_orc_convert_AYUV_RGBA (FRAME_GET_LINE (dest, 0),
-      FRAME_GET_STRIDE (dest), FRAME_GET_LINE (src, 0),
+  video_convert_orc_convert_AYUV_RGBA (FRAME_GET_LINE (dest, y),
+      FRAME_GET_STRIDE (dest), FRAME_GET_LINE (src, y),
       FRAME_GET_STRIDE (src), width, height);
 }
 
 static void
 convert_I420_BGRA (VideoConvert * convert, GstVideoFrame * dest,
-    const GstVideoFrame * src)
+    const GstVideoFrame * src, VideoConvertBand * band)
 {
   int i;
   int quality = 0;
   gint width = convert->width;
-  gint height = convert->height;
+  gint y = band->y;
+  gint height = band->height;
 
   if (quality > 3) {
-    for (i = 0; i < height; i++) {
+    for (i = y; i < y + height; i++) {
       if (i & 1) {
         video_convert_orc_convert_I420_BGRA_avg (FRAME_GET_LINE (dest, i),
             FRAME_GET_Y_LINE (src, i),
@@ -1080,7 +1228,7 @@ convert_I420_BGRA (VideoConvert * convert, GstVideoFrame * dest,
       }
     }
   } else {
-    for (i = 0; i < height; i++) {
+    for (i = y; i < y + height; i++) {
       video_convert_orc_convert_I420_BGRA (FRAME_GET_LINE (dest, i),
           FRAME_GET_Y_LINE (src, i),
           FRAME_GET_U_LINE (src, i >> 1),
@@ -1102,7 +1250,7 @@ typedef struct
   GstVideoColorMatrix out_matrix;
   gboolean keeps_color_matrix;
   void (*convert) (VideoConvert * convert, GstVideoFrame * dest,
-      const GstVideoFrame * src);
+      const GstVideoFrame * src, VideoConvertBand * band);
 } VideoTransform;
 static const VideoTransform transforms[] = {
   {GST_VIDEO_FORMAT_I420, GST_VIDEO_COLOR_MATRIX_UNKNOWN, GST_VIDEO_FORMAT_YUY2,
@@ -26,6 +26,9 @@
 G_BEGIN_DECLS
 
 typedef struct _VideoConvert VideoConvert;
+typedef struct _VideoConvertBand VideoConvertBand;
+
+#define VIDEO_CONVERT_MAX_THREADS 64
 
 typedef enum {
   DITHER_NONE,
@@ -33,6 +36,21 @@ typedef enum {
   DITHER_HALFTONE
 } ColorSpaceDitherMethod;
 
+/* a horizontal band of the frame, converted by its own thread with its own
+ * scratch lines */
+struct _VideoConvertBand {
+  VideoConvert *convert;
+
+  gint y;
+  gint height;
+
+  guint8 *tmpline;
+  guint16 *tmpline16;
+  guint16 *errline;
+
+  GThread *thread;
+};
+
 struct _VideoConvert {
   GstVideoInfo in_info;
   GstVideoInfo out_info;
@@ -48,18 +66,29 @@ struct _VideoConvert {
 
   ColorSpaceDitherMethod dither;
 
-  guint8 *tmpline;
-  guint16 *tmpline16;
-  guint16 *errline;
-
-  void (*convert) (VideoConvert *convert, GstVideoFrame *dest, const GstVideoFrame *src);
+  guint n_threads;
+  VideoConvertBand *bands;
+
+  /* protected by lock */
+  GMutex lock;
+  GCond cond;
+  GCond done_cond;
+  GstVideoFrame *dest;
+  const GstVideoFrame *src;
+  guint cookie;
+  guint pending;
+  gboolean shutdown;
+
+  void (*convert) (VideoConvert *convert, GstVideoFrame *dest, const GstVideoFrame *src,
+                   VideoConvertBand *band);
   void (*matrix) (VideoConvert *convert, guint8 * pixels);
   void (*matrix16) (VideoConvert *convert, guint16 * pixels);
-  void (*dither16) (VideoConvert *convert, guint16 * pixels, int j);
+  void (*dither16) (VideoConvert *convert, VideoConvertBand *band, guint16 * pixels, int j);
 };
 
 VideoConvert *   videoconvert_convert_new            (GstVideoInfo *in_info,
-                                                      GstVideoInfo *out_info);
+                                                      GstVideoInfo *out_info,
+                                                      guint n_threads);
 void             videoconvert_convert_free           (VideoConvert * convert);
 
 void             videoconvert_convert_set_dither     (VideoConvert * convert, int type);
@@ -52,6 +52,16 @@
  * Note that property notification will happen from the streaming thread, so
  * applications should be prepared for this.
  *
+ * When frames are dropped and #GstVideoRate:smart-drop is enabled, each
+ * output frame is the input frame that differs most from the previous output
+ * frame among the input frames received since then, instead of the input
+ * frame nearest in time. Frames are compared on a downsampled copy of their
+ * luma, and a frame that starts a new scene (see
+ * #GstVideoRate:scene-threshold) is always preferred. The output frames then
+ * carry a #GstVideoSceneMeta with their difference to the previous output
+ * frame, which encoders can use to spend fewer bits on nearly identical
+ * frames.
+ *
  * <refsect2>
  * <title>Example pipelines</title>
  * |[
@@ -62,6 +72,9 @@
  * gst-launch -v v4l2src ! videorate ! video/x-raw,framerate=25/2 ! theoraenc ! oggmux ! filesink location=recording.ogg
  * ]| Capture video from a V4L device, and adjust the stream to 12.5 fps before
  * encoding to Ogg/Theora.
+ * |[
+ * gst-launch -v filesrc location=videotestsrc.ogg ! oggdemux ! theoradec ! videorate smart-drop=true ! video/x-raw,framerate=5/1 ! jpegenc ! multifilesink location=thumb%05d.jpg
+ * ]| Make 5 thumbnails per second, keeping the most distinct frames.
  * </refsect2>
  *
  * Last reviewed on 2006-09-02 (0.10.11)
@@ -71,7 +84,11 @@
 #include "config.h"
 #endif
 
+#include <string.h>
+
 #include "gstvideorate.h"
+#include "gstvideorateorc.h"
+#include <gst/video/gstvideometa.h>
 
 GST_DEBUG_CATEGORY_STATIC (video_rate_debug);
 #define GST_CAT_DEFAULT video_rate_debug
@@ -89,6 +106,13 @@ enum
 #define DEFAULT_DROP_ONLY       FALSE
 #define DEFAULT_AVERAGE_PERIOD  0
 #define DEFAULT_MAX_RATE        G_MAXINT
+#define DEFAULT_SMART_DROP      FALSE
+#define DEFAULT_SIMILARITY_THRESHOLD 2.0
+#define DEFAULT_SCENE_THRESHOLD 0.4
+
+/* rows of a cell that are summed for the luma signature */
+#define MAX_CELL_ROWS 8
+#define HISTOGRAM_BINS 32
 
 enum
 {
@@ -102,7 +126,10 @@ enum
   PROP_SKIP_TO_FIRST,
   PROP_DROP_ONLY,
   PROP_AVERAGE_PERIOD,
-  PROP_MAX_RATE
+  PROP_MAX_RATE,
+  PROP_SMART_DROP,
+  PROP_SIMILARITY_THRESHOLD,
+  PROP_SCENE_THRESHOLD
 };
 
 static GstStaticPadTemplate gst_video_rate_src_template =
@@ -249,6 +276,44 @@ gst_video_rate_class_init (GstVideoRateClass * klass)
           1, G_MAXINT, DEFAULT_MAX_RATE,
           G_PARAM_READWRITE | G_PARAM_CONSTRUCT | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstVideoRate:smart-drop:
+   *
+   * When dropping frames, output the input frame that differs most from the
+   * previous output frame instead of the one nearest in time. Only raw
+   * video with 8 bits per component is analysed.
+   */
+  g_object_class_install_property (object_class, PROP_SMART_DROP,
+      g_param_spec_boolean ("smart-drop", "Smart drop",
+          "Keep the most distinct frames when dropping frames",
+          DEFAULT_SMART_DROP, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstVideoRate:similarity-threshold:
+   *
+   * The mean luma difference, from 0 to 255, by which a frame must differ
+   * more from the previous output frame than the frame nearest in time to be
+   * output instead of it in smart-drop mode.
+   */
+  g_object_class_install_property (object_class, PROP_SIMILARITY_THRESHOLD,
+      g_param_spec_double ("similarity-threshold", "Similarity threshold",
+          "Extra mean luma difference needed to prefer a frame over the "
+          "nearest one in smart-drop mode", 0.0, 255.0,
+          DEFAULT_SIMILARITY_THRESHOLD,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstVideoRate:scene-threshold:
+   *
+   * The distance between the luma histograms of a frame and the previous
+   * output frame, from 0 to 1, above which the frame starts a new scene.
+   */
+  g_object_class_install_property (object_class, PROP_SCENE_THRESHOLD,
+      g_param_spec_double ("scene-threshold", "Scene threshold",
+          "Luma histogram distance above which a frame starts a new scene",
+          0.0, 1.0, DEFAULT_SCENE_THRESHOLD,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   gst_element_class_set_static_metadata (element_class,
       "Video rate adjuster", "Filter/Effect/Video",
       "Drops/duplicates/adjusts timestamps on video frames to make a perfect stream",
@@ -473,6 +538,55 @@ gst_video_rate_fixate_caps (GstBaseTransform * trans,
   return othercaps;
 }
 
+/* prepare computing the luma signatures of the input frames. This needs raw
+ * video with 8 bit luma samples, or 8 bit green samples for RGB. */
+static void
+gst_video_rate_setup_analysis (GstVideoRate * videorate, GstCaps * caps)
+{
+  const GstVideoFormatInfo *finfo;
+  GstStructure *structure;
+  gint comp, width, height;
+
+  videorate->analyse = FALSE;
+  videorate->have_last_signature = FALSE;
+  g_free (videorate->accum);
+  videorate->accum = NULL;
+
+  structure = gst_caps_get_structure (caps, 0);
+  if (!gst_structure_has_name (structure, "video/x-raw") ||
+      !gst_video_info_from_caps (&videorate->info, caps))
+    goto not_analysable;
+
+  finfo = videorate->info.finfo;
+  comp = GST_VIDEO_FORMAT_INFO_IS_RGB (finfo) ? 1 : 0;
+  if (GST_VIDEO_FORMAT_INFO_DEPTH (finfo, comp) != 8 ||
+      GST_VIDEO_FORMAT_INFO_PSTRIDE (finfo, comp) == 0 ||
+      GST_VIDEO_FORMAT_INFO_HAS_PALETTE (finfo))
+    goto not_analysable;
+
+  width = GST_VIDEO_INFO_COMP_WIDTH (&videorate->info, comp);
+  height = GST_VIDEO_INFO_COMP_HEIGHT (&videorate->info, comp);
+  if (width <= 0 || height <= 0)
+    goto not_analysable;
+
+  videorate->luma_comp = comp;
+  videorate->cells_x = MIN (width, GST_VIDEO_RATE_GRID_SIZE);
+  videorate->cells_y = MIN (height, GST_VIDEO_RATE_GRID_SIZE);
+  videorate->accum = g_new (guint16, width);
+  videorate->analyse = TRUE;
+
+  GST_DEBUG_OBJECT (videorate, "comparing frames on a %dx%d grid of %s",
+      videorate->cells_x, videorate->cells_y, comp ? "green" : "luma");
+  return;
+
+not_analysable:
+  {
+    GST_DEBUG_OBJECT (videorate, "can't compare frames of %" GST_PTR_FORMAT,
+        caps);
+    return;
+  }
+}
+
 static gboolean
 gst_video_rate_setcaps (GstBaseTransform * trans, GstCaps * in_caps,
     GstCaps * out_caps)
@@ -495,6 +609,8 @@ gst_video_rate_setcaps (GstBaseTransform * trans, GstCaps * in_caps,
   videorate->from_rate_numerator = rate_numerator;
   videorate->from_rate_denominator = rate_denominator;
 
+  gst_video_rate_setup_analysis (videorate, in_caps);
+
   structure = gst_caps_get_structure (out_caps, 0);
   if (!gst_structure_get_fraction (structure, "framerate",
           &rate_numerator, &rate_denominator))
@@ -552,6 +668,7 @@ gst_video_rate_reset (GstVideoRate * videorate)
   videorate->last_ts = GST_CLOCK_TIME_NONE;
   videorate->discont = TRUE;
   videorate->average = 0;
+  videorate->have_last_signature = FALSE;
   gst_video_rate_swap_prev (videorate, NULL, 0);
 
   gst_segment_init (&videorate->segment, GST_FORMAT_TIME);
@@ -567,6 +684,9 @@ gst_video_rate_init (GstVideoRate * videorate)
   videorate->average_period = DEFAULT_AVERAGE_PERIOD;
   videorate->average_period_set = DEFAULT_AVERAGE_PERIOD;
   videorate->max_rate = DEFAULT_MAX_RATE;
+  videorate->smart_drop = DEFAULT_SMART_DROP;
+  videorate->similarity_threshold = DEFAULT_SIMILARITY_THRESHOLD;
+  videorate->scene_threshold = DEFAULT_SCENE_THRESHOLD;
 
   videorate->from_rate_numerator = 0;
   videorate->from_rate_denominator = 0;
@@ -576,6 +696,168 @@ gst_video_rate_init (GstVideoRate * videorate)
   gst_base_transform_set_gap_aware (GST_BASE_TRANSFORM (videorate), TRUE);
 }
 
+static void
+gst_video_rate_candidate_clear (GstVideoRateCandidate * cand)
+{
+  if (cand->buffer)
+    gst_buffer_unref (cand->buffer);
+  cand->buffer = NULL;
+  cand->valid = FALSE;
+}
+
+static void
+gst_video_rate_candidate_set (GstVideoRateCandidate * cand,
+    const GstVideoRateCandidate * from, GstBuffer * buffer)
+{
+  gst_buffer_replace (&cand->buffer, buffer);
+  memcpy (cand->signature, from->signature, sizeof (cand->signature));
+  cand->difference = from->difference;
+  cand->histogram_distance = from->histogram_distance;
+  cand->valid = TRUE;
+}
+
+/* Compute the luma signature of @buffer: the average luma of every cell of
+ * the grid. Only up to MAX_CELL_ROWS rows of each cell are summed, which keeps
+ * the sums in 16 bits and the cost low for big frames. */
+static gboolean
+gst_video_rate_compute_signature (GstVideoRate * videorate, GstBuffer * buffer,
+    guint8 * signature)
+{
+  GstVideoFrame frame;
+  guint16 *accum = videorate->accum;
+  const guint8 *data;
+  gint comp = videorate->luma_comp;
+  gint width, height, stride, pstride;
+  gint cx, cy, x, y;
+
+  if (!gst_video_frame_map (&frame, &videorate->info, buffer, GST_MAP_READ))
+    goto map_failed;
+
+  width = GST_VIDEO_FRAME_COMP_WIDTH (&frame, comp);
+  height = GST_VIDEO_FRAME_COMP_HEIGHT (&frame, comp);
+  data = GST_VIDEO_FRAME_COMP_DATA (&frame, comp);
+  stride = GST_VIDEO_FRAME_COMP_STRIDE (&frame, comp);
+  pstride = GST_VIDEO_FRAME_COMP_PSTRIDE (&frame, comp);
+
+  for (cy = 0; cy < videorate->cells_y; cy++) {
+    gint y0 = cy * height / videorate->cells_y;
+    gint y1 = (cy + 1) * height / videorate->cells_y;
+    gint step = (y1 - y0 + MAX_CELL_ROWS - 1) / MAX_CELL_ROWS;
+    gint rows = 0;
+
+    memset (accum, 0, width * sizeof (guint16));
+    for (y = y0; y < y1; y += step) {
+      const guint8 *line = data + y * stride;
+
+      if (pstride == 1) {
+        video_rate_orc_accumulate_u8 (accum, line, width);
+      } else {
+        for (x = 0; x < width; x++)
+          accum[x] += line[x * pstride];
+      }
+      rows++;
+    }
+
+    for (cx = 0; cx < videorate->cells_x; cx++) {
+      gint x0 = cx * width / videorate->cells_x;
+      gint x1 = (cx + 1) * width / videorate->cells_x;
+      guint32 sum;
+
+      video_rate_orc_sum_u16 (&sum, accum + x0, x1 - x0);
+      signature[cy * videorate->cells_x + cx] = sum / ((x1 - x0) * rows);
+    }
+  }
+  gst_video_frame_unmap (&frame);
+
+  return TRUE;
+
+  /* ERRORS */
+map_failed:
+  {
+    GST_DEBUG_OBJECT (videorate, "failed to map buffer %p", buffer);
+    return FALSE;
+  }
+}
+
+/* compare the signature of @cand with the one of the last output frame */
+static void
+gst_video_rate_compare_signature (GstVideoRate * videorate,
+    GstVideoRateCandidate * cand)
+{
+  gint hist[HISTOGRAM_BINS] = { 0, };
+  guint n_cells = videorate->cells_x * videorate->cells_y;
+  guint32 sad;
+  guint i, distance;
+
+  if (!videorate->have_last_signature) {
+    cand->difference = 0.0;
+    cand->histogram_distance = 0.0;
+    return;
+  }
+
+  video_rate_orc_sad_u8 (&sad, cand->signature, videorate->last_signature,
+      n_cells);
+
+  /* the histograms are over the cells, the number of cells in bins that
+   * differ is twice the number of cells that moved to another bin */
+  for (i = 0; i < n_cells; i++) {
+    hist[cand->signature[i] * HISTOGRAM_BINS / 256]++;
+    hist[videorate->last_signature[i] * HISTOGRAM_BINS / 256]--;
+  }
+  distance = 0;
+  for (i = 0; i < HISTOGRAM_BINS; i++)
+    distance += ABS (hist[i]);
+
+  cand->difference = sad / (gdouble) n_cells;
+  cand->histogram_distance = distance / (2.0 * n_cells);
+}
+
+/* @buffer was stored as prevbuf, analyse it and keep it if it's a better
+ * candidate for the next output frame */
+static void
+gst_video_rate_add_candidate (GstVideoRate * videorate, GstBuffer * buffer)
+{
+  GstVideoRateCandidate *prev = &videorate->prev;
+
+  if (!videorate->analyse ||
+      !gst_video_rate_compute_signature (videorate, buffer, prev->signature))
+    return;
+
+  gst_video_rate_compare_signature (videorate, prev);
+  prev->valid = TRUE;
+
+  GST_LOG_OBJECT (videorate, "buffer %p difference %f histogram distance %f",
+      buffer, prev->difference, prev->histogram_distance);
+
+  if (!videorate->scene.valid && videorate->have_last_signature &&
+      prev->histogram_distance > videorate->scene_threshold)
+    gst_video_rate_candidate_set (&videorate->scene, prev, buffer);
+
+  if (!videorate->best.valid || prev->difference > videorate->best.difference)
+    gst_video_rate_candidate_set (&videorate->best, prev, buffer);
+}
+
+/* Pick the candidate to output for a new output frame. A scene change wins,
+ * else the most different frame if it's clearly more different than the
+ * nearest one, prevbuf. Returns NULL when prevbuf could not be analysed. */
+static GstVideoRateCandidate *
+gst_video_rate_select_candidate (GstVideoRate * videorate)
+{
+  GstVideoRateCandidate *prev = &videorate->prev;
+
+  if (!prev->valid)
+    return NULL;
+
+  if (videorate->scene.valid)
+    return &videorate->scene;
+
+  if (videorate->best.valid && videorate->best.difference >
+      prev->difference + videorate->similarity_threshold)
+    return &videorate->best;
+
+  return prev;
+}
+
 /* flush the oldest buffer */
 static GstFlowReturn
 gst_video_rate_flush_prev (GstVideoRate * videorate, gboolean duplicate)
@@ -583,12 +865,50 @@ gst_video_rate_flush_prev (GstVideoRate * videorate, gboolean duplicate)
   GstFlowReturn res;
   GstBuffer *outbuf;
   GstClockTime push_ts;
+  GstVideoRateCandidate *cand = NULL;
+  GstBuffer *buffer;
 
   if (!videorate->prevbuf)
     goto eos_before_buffers;
 
+  buffer = videorate->prevbuf;
+  if (videorate->smart_drop && !duplicate) {
+    cand = gst_video_rate_select_candidate (videorate);
+    if (cand && cand->buffer)
+      buffer = cand->buffer;
+  } else if (videorate->smart_drop && videorate->prev.valid) {
+    /* a duplicate of prevbuf still differs from the previous output frame
+     * when that was another candidate */
+    cand = &videorate->prev;
+    gst_video_rate_compare_signature (videorate, cand);
+  }
+
   /* make sure we can write to the metadata */
-  outbuf = gst_buffer_make_writable (gst_buffer_ref (videorate->prevbuf));
+  outbuf = gst_buffer_make_writable (gst_buffer_ref (buffer));
+
+  if (cand) {
+    GstVideoSceneMeta *meta;
+
+    if (!(meta = gst_buffer_get_video_scene_meta (outbuf)))
+      meta = gst_buffer_add_video_scene_meta (outbuf);
+    meta->difference = cand->difference;
+    meta->histogram_distance = cand->histogram_distance;
+    meta->scene_change = videorate->have_last_signature &&
+        cand->histogram_distance > videorate->scene_threshold;
+
+    GST_LOG_OBJECT (videorate, "selected buffer %p, prevbuf %p, difference %f"
+        "%s", buffer, videorate->prevbuf, cand->difference,
+        meta->scene_change ? ", scene change" : "");
+
+    memcpy (videorate->last_signature, cand->signature,
+        sizeof (videorate->last_signature));
+    videorate->have_last_signature = TRUE;
+
+    /* prevbuf can still be output for the next output frame */
+    gst_video_rate_candidate_clear (&videorate->best);
+    gst_video_rate_candidate_clear (&videorate->scene);
+    gst_video_rate_compare_signature (videorate, &videorate->prev);
+  }
 
   GST_BUFFER_OFFSET (outbuf) = videorate->out;
   GST_BUFFER_OFFSET_END (outbuf) = videorate->out + 1;
@@ -650,6 +970,12 @@ gst_video_rate_swap_prev (GstVideoRate * videorate, GstBuffer * buffer,
     gst_buffer_unref (videorate->prevbuf);
   videorate->prevbuf = buffer != NULL ? gst_buffer_ref (buffer) : NULL;
   videorate->prev_ts = time;
+
+  videorate->prev.valid = FALSE;
+  if (buffer == NULL) {
+    gst_video_rate_candidate_clear (&videorate->best);
+    gst_video_rate_candidate_clear (&videorate->scene);
+  }
 }
 
 static void
@@ -991,6 +1317,8 @@ gst_video_rate_transform_ip (GstBaseTransform * trans, GstBuffer * buffer)
   /* we need to have two buffers to compare */
   if (videorate->prevbuf == NULL) {
     gst_video_rate_swap_prev (videorate, buffer, intime);
+    if (videorate->smart_drop)
+      gst_video_rate_add_candidate (videorate, buffer);
     videorate->in++;
     if (!GST_CLOCK_TIME_IS_VALID (videorate->next_ts)) {
       /* new buffer, we expect to output a buffer that matches the first
@@ -1096,6 +1424,8 @@ gst_video_rate_transform_ip (GstBaseTransform * trans, GstBuffer * buffer)
 
     /* swap in new one when it's the best */
     gst_video_rate_swap_prev (videorate, buffer, intime);
+    if (videorate->smart_drop)
+      gst_video_rate_add_candidate (videorate, buffer);
   }
 done:
   return res;
@@ -1127,7 +1457,12 @@ gst_video_rate_start (GstBaseTransform * trans)
 static gboolean
 gst_video_rate_stop (GstBaseTransform * trans)
 {
-  gst_video_rate_reset (GST_VIDEO_RATE (trans));
+  GstVideoRate *videorate = GST_VIDEO_RATE (trans);
+
+  gst_video_rate_reset (videorate);
+  videorate->analyse = FALSE;
+  g_free (videorate->accum);
+  videorate->accum = NULL;
   return TRUE;
 }
 
@@ -1159,6 +1494,15 @@ gst_video_rate_set_property (GObject * object,
       g_atomic_int_set (&videorate->max_rate, g_value_get_int (value));
       goto reconfigure;
       break;
+    case PROP_SMART_DROP:
+      videorate->smart_drop = g_value_get_boolean (value);
+      break;
+    case PROP_SIMILARITY_THRESHOLD:
+      videorate->similarity_threshold = g_value_get_double (value);
+      break;
+    case PROP_SCENE_THRESHOLD:
+      videorate->scene_threshold = g_value_get_double (value);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -1209,6 +1553,15 @@ gst_video_rate_get_property (GObject * object,
     case PROP_MAX_RATE:
       g_value_set_int (value, g_atomic_int_get (&videorate->max_rate));
       break;
+    case PROP_SMART_DROP:
+      g_value_set_boolean (value, videorate->smart_drop);
+      break;
+    case PROP_SIMILARITY_THRESHOLD:
+      g_value_set_double (value, videorate->similarity_threshold);
+      break;
+    case PROP_SCENE_THRESHOLD:
+      g_value_set_double (value, videorate->scene_threshold);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
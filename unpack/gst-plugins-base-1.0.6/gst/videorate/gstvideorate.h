@@ -22,6 +22,7 @@
 
 #include <gst/gst.h>
 #include <gst/base/gstbasetransform.h>
+#include <gst/video/video.h>
 
 G_BEGIN_DECLS
 
@@ -39,6 +40,22 @@ G_BEGIN_DECLS
 typedef struct _GstVideoRate GstVideoRate;
 typedef struct _GstVideoRateClass GstVideoRateClass;
 
+/* the luma signature of a frame is the average of each cell of a grid of at
+ * most GST_VIDEO_RATE_GRID_SIZE x GST_VIDEO_RATE_GRID_SIZE cells */
+#define GST_VIDEO_RATE_GRID_SIZE   32
+#define GST_VIDEO_RATE_MAX_CELLS   (GST_VIDEO_RATE_GRID_SIZE * GST_VIDEO_RATE_GRID_SIZE)
+
+/* a frame that can be output for the current output frame in smart-drop
+ * mode, compared with the last output frame */
+typedef struct
+{
+  gboolean valid;
+  GstBuffer *buffer;
+  guint8 signature[GST_VIDEO_RATE_MAX_CELLS];
+  gdouble difference;
+  gdouble histogram_distance;
+} GstVideoRateCandidate;
+
 /**
  * GstVideoRate:
  *
@@ -66,6 +83,18 @@ struct _GstVideoRate
   GstClockTimeDiff wanted_diff; /* target average diff */
   GstClockTimeDiff average;     /* moving average period */
 
+  /* smart dropping */
+  GstVideoInfo info;
+  gboolean analyse;             /* input format can be analysed */
+  gint luma_comp;
+  gint cells_x, cells_y;
+  guint16 *accum;               /* sum of the sampled rows of a cell row */
+  GstVideoRateCandidate prev;   /* prevbuf */
+  GstVideoRateCandidate best;   /* most different since the last output */
+  GstVideoRateCandidate scene;  /* first scene change since the last output */
+  guint8 last_signature[GST_VIDEO_RATE_MAX_CELLS];
+  gboolean have_last_signature;
+
   /* segment handling */
   GstSegment segment;
 
@@ -76,6 +105,9 @@ struct _GstVideoRate
   gboolean skip_to_first;
   gboolean drop_only;
   guint64 average_period_set;
+  gboolean smart_drop;
+  gdouble similarity_threshold;
+  gdouble scene_threshold;
 
   volatile int max_rate;
 };
@@ -245,14 +245,12 @@ gst_video_scale_class_init (GstVideoScaleClass * klass)
           DEFAULT_PROP_DITHER,
           G_PARAM_CONSTRUCT | G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
-#if 0
-  /* I am hiding submethod for now, since it's poorly named, poorly
-   * documented, and will probably just get people into trouble. */
   g_object_class_install_property (gobject_class, PROP_SUBMETHOD,
-      g_param_spec_int ("submethod", "submethod",
-          "submethod", 0, 3, DEFAULT_PROP_SUBMETHOD,
+      g_param_spec_int ("submethod", "Submethod",
+          "Arithmetic of the Lanczos method: 0 = 16 bit integer (fastest), "
+          "1 = 32 bit integer, 2 = float, 3 = double (most precise)", 0, 3,
+          DEFAULT_PROP_SUBMETHOD,
           G_PARAM_CONSTRUCT | G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
-#endif
 
   g_object_class_install_property (gobject_class, PROP_ENVELOPE,
       g_param_spec_double ("envelope", "Envelope",
@@ -115,6 +115,30 @@ void video_scale_orc_merge_bicubic_u8 (guint8 * ORC_RESTRICT d1,
     const guint8 * ORC_RESTRICT s1, const guint8 * ORC_RESTRICT s2,
     const guint8 * ORC_RESTRICT s3, const guint8 * ORC_RESTRICT s4, int p1,
     int p2, int p3, int p4, int n);
+void video_scale_orc_resample_vert_2tap_s16 (gint32 * ORC_RESTRICT d1,
+    const gint16 * ORC_RESTRICT s1, const gint16 * ORC_RESTRICT s2, int p1,
+    int p2, int n);
+void video_scale_orc_resample_vert_accum_2tap_s16 (gint32 * ORC_RESTRICT d1,
+    const gint16 * ORC_RESTRICT s1, const gint16 * ORC_RESTRICT s2, int p1,
+    int p2, int n);
+void video_scale_orc_resample_vert_accum_4tap_s16 (gint32 * ORC_RESTRICT d1,
+    const gint16 * ORC_RESTRICT s1, const gint16 * ORC_RESTRICT s2,
+    const gint16 * ORC_RESTRICT s3, const gint16 * ORC_RESTRICT s4, int p1,
+    int p2, int p3, int p4, int n);
+void video_scale_orc_resample_vert_pack_s32_u8 (guint8 * ORC_RESTRICT d1,
+    const gint32 * ORC_RESTRICT s1, int n);
+void video_scale_orc_resample_vert_2tap_s32 (gint32 * ORC_RESTRICT d1,
+    const gint32 * ORC_RESTRICT s1, const gint32 * ORC_RESTRICT s2, int p1,
+    int p2, int n);
+void video_scale_orc_resample_vert_accum_2tap_s32 (gint32 * ORC_RESTRICT d1,
+    const gint32 * ORC_RESTRICT s1, const gint32 * ORC_RESTRICT s2, int p1,
+    int p2, int n);
+void video_scale_orc_resample_vert_accum_4tap_s32 (gint32 * ORC_RESTRICT d1,
+    const gint32 * ORC_RESTRICT s1, const gint32 * ORC_RESTRICT s2,
+    const gint32 * ORC_RESTRICT s3, const gint32 * ORC_RESTRICT s4, int p1,
+    int p2, int p3, int p4, int n);
+void video_scale_orc_resample_vert_pack_s32_u8_22 (guint8 * ORC_RESTRICT d1,
+    const gint32 * ORC_RESTRICT s1, int n);
 
 
 /* begin Orc C target preamble */
@@ -2332,3 +2356,1341 @@ video_scale_orc_merge_bicubic_u8 (guint8 * ORC_RESTRICT d1,
   func (ex);
 }
 #endif
+
+
+/* video_scale_orc_resample_vert_2tap_s16 */
+#ifdef DISABLE_ORC
+void
+video_scale_orc_resample_vert_2tap_s16 (gint32 * ORC_RESTRICT d1,
+    const gint16 * ORC_RESTRICT s1, const gint16 * ORC_RESTRICT s2, int p1,
+    int p2, int n)
+{
+  int i;
+  orc_union32 *ORC_RESTRICT ptr0;
+  const orc_union16 *ORC_RESTRICT ptr4;
+  const orc_union16 *ORC_RESTRICT ptr5;
+  orc_union16 var33;
+  orc_union16 var34;
+  orc_union16 var35;
+  orc_union16 var36;
+  orc_union32 var37;
+  orc_union32 var38;
+  orc_union32 var39;
+
+  ptr0 = (orc_union32 *) d1;
+  ptr4 = (orc_union16 *) s1;
+  ptr5 = (orc_union16 *) s2;
+
+  /* 1: loadpw */
+  var34.i = p1;
+  /* 4: loadpw */
+  var36.i = p2;
+
+  for (i = 0; i < n; i++) {
+    /* 0: loadw */
+    var33 = ptr4[i];
+    /* 2: mulswl */
+    var38.i = var33.i * var34.i;
+    /* 3: loadw */
+    var35 = ptr5[i];
+    /* 5: mulswl */
+    var39.i = var35.i * var36.i;
+    /* 6: addl */
+    var37.i = var38.i + var39.i;
+    /* 7: storel */
+    ptr0[i] = var37;
+  }
+
+}
+
+#else
+static void
+_backup_video_scale_orc_resample_vert_2tap_s16 (OrcExecutor * ORC_RESTRICT ex)
+{
+  int i;
+  int n = ex->n;
+  orc_union32 *ORC_RESTRICT ptr0;
+  const orc_union16 *ORC_RESTRICT ptr4;
+  const orc_union16 *ORC_RESTRICT ptr5;
+  orc_union16 var33;
+  orc_union16 var34;
+  orc_union16 var35;
+  orc_union16 var36;
+  orc_union32 var37;
+  orc_union32 var38;
+  orc_union32 var39;
+
+  ptr0 = (orc_union32 *) ex->arrays[0];
+  ptr4 = (orc_union16 *) ex->arrays[4];
+  ptr5 = (orc_union16 *) ex->arrays[5];
+
+  /* 1: loadpw */
+  var34.i = ex->params[24];
+  /* 4: loadpw */
+  var36.i = ex->params[25];
+
+  for (i = 0; i < n; i++) {
+    /* 0: loadw */
+    var33 = ptr4[i];
+    /* 2: mulswl */
+    var38.i = var33.i * var34.i;
+    /* 3: loadw */
+    var35 = ptr5[i];
+    /* 5: mulswl */
+    var39.i = var35.i * var36.i;
+    /* 6: addl */
+    var37.i = var38.i + var39.i;
+    /* 7: storel */
+    ptr0[i] = var37;
+  }
+
+}
+
+void
+video_scale_orc_resample_vert_2tap_s16 (gint32 * ORC_RESTRICT d1,
+    const gint16 * ORC_RESTRICT s1, const gint16 * ORC_RESTRICT s2, int p1,
+    int p2, int n)
+{
+  OrcExecutor _ex, *ex = &_ex;
+  static volatile int p_inited = 0;
+  static OrcCode *c = 0;
+  void (*func) (OrcExecutor *);
+
+  if (!p_inited) {
+    orc_once_mutex_lock ();
+    if (!p_inited) {
+      OrcProgram *p;
+
+      p = orc_program_new ();
+      orc_program_set_name (p, "video_scale_orc_resample_vert_2tap_s16");
+      orc_program_set_backup_function (p,
+          _backup_video_scale_orc_resample_vert_2tap_s16);
+      orc_program_add_destination (p, 4, "d1");
+      orc_program_add_source (p, 2, "s1");
+      orc_program_add_source (p, 2, "s2");
+      orc_program_add_parameter (p, 2, "p1");
+      orc_program_add_parameter (p, 2, "p2");
+      orc_program_add_temporary (p, 4, "t1");
+      orc_program_add_temporary (p, 4, "t2");
+
+      orc_program_append_2 (p, "mulswl", 0, ORC_VAR_T1, ORC_VAR_S1, ORC_VAR_P1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "mulswl", 0, ORC_VAR_T2, ORC_VAR_S2, ORC_VAR_P2,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "addl", 0, ORC_VAR_D1, ORC_VAR_T1, ORC_VAR_T2,
+          ORC_VAR_D1);
+
+      orc_program_compile (p);
+      c = orc_program_take_code (p);
+      orc_program_free (p);
+    }
+    p_inited = TRUE;
+    orc_once_mutex_unlock ();
+  }
+  ex->arrays[ORC_VAR_A2] = c;
+  ex->program = 0;
+
+  ex->n = n;
+  ex->arrays[ORC_VAR_D1] = d1;
+  ex->arrays[ORC_VAR_S1] = (void *) s1;
+  ex->arrays[ORC_VAR_S2] = (void *) s2;
+  ex->params[ORC_VAR_P1] = p1;
+  ex->params[ORC_VAR_P2] = p2;
+
+  func = c->exec;
+  func (ex);
+}
+#endif
+
+
+/* video_scale_orc_resample_vert_accum_2tap_s16 */
+#ifdef DISABLE_ORC
+void
+video_scale_orc_resample_vert_accum_2tap_s16 (gint32 * ORC_RESTRICT d1,
+    const gint16 * ORC_RESTRICT s1, const gint16 * ORC_RESTRICT s2, int p1,
+    int p2, int n)
+{
+  int i;
+  orc_union32 *ORC_RESTRICT ptr0;
+  const orc_union16 *ORC_RESTRICT ptr4;
+  const orc_union16 *ORC_RESTRICT ptr5;
+  orc_union16 var33;
+  orc_union16 var34;
+  orc_union16 var35;
+  orc_union16 var36;
+  orc_union32 var37;
+  orc_union32 var38;
+  orc_union32 var39;
+  orc_union32 var40;
+  orc_union32 var41;
+
+  ptr0 = (orc_union32 *) d1;
+  ptr4 = (orc_union16 *) s1;
+  ptr5 = (orc_union16 *) s2;
+
+  /* 1: loadpw */
+  var34.i = p1;
+  /* 4: loadpw */
+  var36.i = p2;
+
+  for (i = 0; i < n; i++) {
+    /* 0: loadw */
+    var33 = ptr4[i];
+    /* 2: mulswl */
+    var39.i = var33.i * var34.i;
+    /* 3: loadw */
+    var35 = ptr5[i];
+    /* 5: mulswl */
+    var40.i = var35.i * var36.i;
+    /* 6: addl */
+    var41.i = var39.i + var40.i;
+    /* 7: loadl */
+    var37 = ptr0[i];
+    /* 8: addl */
+    var38.i = var41.i + var37.i;
+    /* 9: storel */
+    ptr0[i] = var38;
+  }
+
+}
+
+#else
+static void
+_backup_video_scale_orc_resample_vert_accum_2tap_s16 (OrcExecutor * ORC_RESTRICT ex)
+{
+  int i;
+  int n = ex->n;
+  orc_union32 *ORC_RESTRICT ptr0;
+  const orc_union16 *ORC_RESTRICT ptr4;
+  const orc_union16 *ORC_RESTRICT ptr5;
+  orc_union16 var33;
+  orc_union16 var34;
+  orc_union16 var35;
+  orc_union16 var36;
+  orc_union32 var37;
+  orc_union32 var38;
+  orc_union32 var39;
+  orc_union32 var40;
+  orc_union32 var41;
+
+  ptr0 = (orc_union32 *) ex->arrays[0];
+  ptr4 = (orc_union16 *) ex->arrays[4];
+  ptr5 = (orc_union16 *) ex->arrays[5];
+
+  /* 1: loadpw */
+  var34.i = ex->params[24];
+  /* 4: loadpw */
+  var36.i = ex->params[25];
+
+  for (i = 0; i < n; i++) {
+    /* 0: loadw */
+    var33 = ptr4[i];
+    /* 2: mulswl */
+    var39.i = var33.i * var34.i;
+    /* 3: loadw */
+    var35 = ptr5[i];
+    /* 5: mulswl */
+    var40.i = var35.i * var36.i;
+    /* 6: addl */
+    var41.i = var39.i + var40.i;
+    /* 7: loadl */
+    var37 = ptr0[i];
+    /* 8: addl */
+    var38.i = var41.i + var37.i;
+    /* 9: storel */
+    ptr0[i] = var38;
+  }
+
+}
+
+void
+video_scale_orc_resample_vert_accum_2tap_s16 (gint32 * ORC_RESTRICT d1,
+    const gint16 * ORC_RESTRICT s1, const gint16 * ORC_RESTRICT s2, int p1,
+    int p2, int n)
+{
+  OrcExecutor _ex, *ex = &_ex;
+  static volatile int p_inited = 0;
+  static OrcCode *c = 0;
+  void (*func) (OrcExecutor *);
+
+  if (!p_inited) {
+    orc_once_mutex_lock ();
+    if (!p_inited) {
+      OrcProgram *p;
+
+      p = orc_program_new ();
+      orc_program_set_name (p, "video_scale_orc_resample_vert_accum_2tap_s16");
+      orc_program_set_backup_function (p,
+          _backup_video_scale_orc_resample_vert_accum_2tap_s16);
+      orc_program_add_destination (p, 4, "d1");
+      orc_program_add_source (p, 2, "s1");
+      orc_program_add_source (p, 2, "s2");
+      orc_program_add_parameter (p, 2, "p1");
+      orc_program_add_parameter (p, 2, "p2");
+      orc_program_add_temporary (p, 4, "t1");
+      orc_program_add_temporary (p, 4, "t2");
+
+      orc_program_append_2 (p, "mulswl", 0, ORC_VAR_T1, ORC_VAR_S1, ORC_VAR_P1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "mulswl", 0, ORC_VAR_T2, ORC_VAR_S2, ORC_VAR_P2,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "addl", 0, ORC_VAR_T1, ORC_VAR_T1, ORC_VAR_T2,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "addl", 0, ORC_VAR_D1, ORC_VAR_D1, ORC_VAR_T1,
+          ORC_VAR_D1);
+
+      orc_program_compile (p);
+      c = orc_program_take_code (p);
+      orc_program_free (p);
+    }
+    p_inited = TRUE;
+    orc_once_mutex_unlock ();
+  }
+  ex->arrays[ORC_VAR_A2] = c;
+  ex->program = 0;
+
+  ex->n = n;
+  ex->arrays[ORC_VAR_D1] = d1;
+  ex->arrays[ORC_VAR_S1] = (void *) s1;
+  ex->arrays[ORC_VAR_S2] = (void *) s2;
+  ex->params[ORC_VAR_P1] = p1;
+  ex->params[ORC_VAR_P2] = p2;
+
+  func = c->exec;
+  func (ex);
+}
+#endif
+
+
+/* video_scale_orc_resample_vert_accum_4tap_s16 */
+#ifdef DISABLE_ORC
+void
+video_scale_orc_resample_vert_accum_4tap_s16 (gint32 * ORC_RESTRICT d1,
+    const gint16 * ORC_RESTRICT s1, const gint16 * ORC_RESTRICT s2,
+    const gint16 * ORC_RESTRICT s3, const gint16 * ORC_RESTRICT s4, int p1,
+    int p2, int p3, int p4, int n)
+{
+  int i;
+  orc_union32 *ORC_RESTRICT ptr0;
+  const orc_union16 *ORC_RESTRICT ptr4;
+  const orc_union16 *ORC_RESTRICT ptr5;
+  const orc_union16 *ORC_RESTRICT ptr6;
+  const orc_union16 *ORC_RESTRICT ptr7;
+  orc_union16 var33;
+  orc_union16 var34;
+  orc_union16 var35;
+  orc_union16 var36;
+  orc_union16 var37;
+  orc_union16 var38;
+  orc_union16 var39;
+  orc_union16 var40;
+  orc_union32 var41;
+  orc_union32 var42;
+  orc_union32 var43;
+  orc_union32 var44;
+  orc_union32 var45;
+  orc_union32 var46;
+  orc_union32 var47;
+  orc_union32 var48;
+  orc_union32 var49;
+
+  ptr0 = (orc_union32 *) d1;
+  ptr4 = (orc_union16 *) s1;
+  ptr5 = (orc_union16 *) s2;
+  ptr6 = (orc_union16 *) s3;
+  ptr7 = (orc_union16 *) s4;
+
+  /* 1: loadpw */
+  var34.i = p1;
+  /* 4: loadpw */
+  var36.i = p2;
+  /* 8: loadpw */
+  var38.i = p3;
+  /* 12: loadpw */
+  var40.i = p4;
+
+  for (i = 0; i < n; i++) {
+    /* 0: loadw */
+    var33 = ptr4[i];
+    /* 2: mulswl */
+    var43.i = var33.i * var34.i;
+    /* 3: loadw */
+    var35 = ptr5[i];
+    /* 5: mulswl */
+    var44.i = var35.i * var36.i;
+    /* 6: addl */
+    var47.i = var43.i + var44.i;
+    /* 7: loadw */
+    var37 = ptr6[i];
+    /* 9: mulswl */
+    var45.i = var37.i * var38.i;
+    /* 10: addl */
+    var48.i = var47.i + var45.i;
+    /* 11: loadw */
+    var39 = ptr7[i];
+    /* 13: mulswl */
+    var46.i = var39.i * var40.i;
+    /* 14: addl */
+    var49.i = var48.i + var46.i;
+    /* 15: loadl */
+    var41 = ptr0[i];
+    /* 16: addl */
+    var42.i = var49.i + var41.i;
+    /* 17: storel */
+    ptr0[i] = var42;
+  }
+
+}
+
+#else
+static void
+_backup_video_scale_orc_resample_vert_accum_4tap_s16 (OrcExecutor * ORC_RESTRICT ex)
+{
+  int i;
+  int n = ex->n;
+  orc_union32 *ORC_RESTRICT ptr0;
+  const orc_union16 *ORC_RESTRICT ptr4;
+  const orc_union16 *ORC_RESTRICT ptr5;
+  const orc_union16 *ORC_RESTRICT ptr6;
+  const orc_union16 *ORC_RESTRICT ptr7;
+  orc_union16 var33;
+  orc_union16 var34;
+  orc_union16 var35;
+  orc_union16 var36;
+  orc_union16 var37;
+  orc_union16 var38;
+  orc_union16 var39;
+  orc_union16 var40;
+  orc_union32 var41;
+  orc_union32 var42;
+  orc_union32 var43;
+  orc_union32 var44;
+  orc_union32 var45;
+  orc_union32 var46;
+  orc_union32 var47;
+  orc_union32 var48;
+  orc_union32 var49;
+
+  ptr0 = (orc_union32 *) ex->arrays[0];
+  ptr4 = (orc_union16 *) ex->arrays[4];
+  ptr5 = (orc_union16 *) ex->arrays[5];
+  ptr6 = (orc_union16 *) ex->arrays[6];
+  ptr7 = (orc_union16 *) ex->arrays[7];
+
+  /* 1: loadpw */
+  var34.i = ex->params[24];
+  /* 4: loadpw */
+  var36.i = ex->params[25];
+  /* 8: loadpw */
+  var38.i = ex->params[26];
+  /* 12: loadpw */
+  var40.i = ex->params[27];
+
+  for (i = 0; i < n; i++) {
+    /* 0: loadw */
+    var33 = ptr4[i];
+    /* 2: mulswl */
+    var43.i = var33.i * var34.i;
+    /* 3: loadw */
+    var35 = ptr5[i];
+    /* 5: mulswl */
+    var44.i = var35.i * var36.i;
+    /* 6: addl */
+    var47.i = var43.i + var44.i;
+    /* 7: loadw */
+    var37 = ptr6[i];
+    /* 9: mulswl */
+    var45.i = var37.i * var38.i;
+    /* 10: addl */
+    var48.i = var47.i + var45.i;
+    /* 11: loadw */
+    var39 = ptr7[i];
+    /* 13: mulswl */
+    var46.i = var39.i * var40.i;
+    /* 14: addl */
+    var49.i = var48.i + var46.i;
+    /* 15: loadl */
+    var41 = ptr0[i];
+    /* 16: addl */
+    var42.i = var49.i + var41.i;
+    /* 17: storel */
+    ptr0[i] = var42;
+  }
+
+}
+
+void
+video_scale_orc_resample_vert_accum_4tap_s16 (gint32 * ORC_RESTRICT d1,
+    const gint16 * ORC_RESTRICT s1, const gint16 * ORC_RESTRICT s2,
+    const gint16 * ORC_RESTRICT s3, const gint16 * ORC_RESTRICT s4, int p1,
+    int p2, int p3, int p4, int n)
+{
+  OrcExecutor _ex, *ex = &_ex;
+  static volatile int p_inited = 0;
+  static OrcCode *c = 0;
+  void (*func) (OrcExecutor *);
+
+  if (!p_inited) {
+    orc_once_mutex_lock ();
+    if (!p_inited) {
+      OrcProgram *p;
+
+      p = orc_program_new ();
+      orc_program_set_name (p, "video_scale_orc_resample_vert_accum_4tap_s16");
+      orc_program_set_backup_function (p,
+          _backup_video_scale_orc_resample_vert_accum_4tap_s16);
+      orc_program_add_destination (p, 4, "d1");
+      orc_program_add_source (p, 2, "s1");
+      orc_program_add_source (p, 2, "s2");
+      orc_program_add_source (p, 2, "s3");
+      orc_program_add_source (p, 2, "s4");
+      orc_program_add_parameter (p, 2, "p1");
+      orc_program_add_parameter (p, 2, "p2");
+      orc_program_add_parameter (p, 2, "p3");
+      orc_program_add_parameter (p, 2, "p4");
+      orc_program_add_temporary (p, 4, "t1");
+      orc_program_add_temporary (p, 4, "t2");
+
+      orc_program_append_2 (p, "mulswl", 0, ORC_VAR_T1, ORC_VAR_S1, ORC_VAR_P1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "mulswl", 0, ORC_VAR_T2, ORC_VAR_S2, ORC_VAR_P2,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "addl", 0, ORC_VAR_T1, ORC_VAR_T1, ORC_VAR_T2,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "mulswl", 0, ORC_VAR_T2, ORC_VAR_S3, ORC_VAR_P3,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "addl", 0, ORC_VAR_T1, ORC_VAR_T1, ORC_VAR_T2,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "mulswl", 0, ORC_VAR_T2, ORC_VAR_S4, ORC_VAR_P4,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "addl", 0, ORC_VAR_T1, ORC_VAR_T1, ORC_VAR_T2,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "addl", 0, ORC_VAR_D1, ORC_VAR_D1, ORC_VAR_T1,
+          ORC_VAR_D1);
+
+      orc_program_compile (p);
+      c = orc_program_take_code (p);
+      orc_program_free (p);
+    }
+    p_inited = TRUE;
+    orc_once_mutex_unlock ();
+  }
+  ex->arrays[ORC_VAR_A2] = c;
+  ex->program = 0;
+
+  ex->n = n;
+  ex->arrays[ORC_VAR_D1] = d1;
+  ex->arrays[ORC_VAR_S1] = (void *) s1;
+  ex->arrays[ORC_VAR_S2] = (void *) s2;
+  ex->arrays[ORC_VAR_S3] = (void *) s3;
+  ex->arrays[ORC_VAR_S4] = (void *) s4;
+  ex->params[ORC_VAR_P1] = p1;
+  ex->params[ORC_VAR_P2] = p2;
+  ex->params[ORC_VAR_P3] = p3;
+  ex->params[ORC_VAR_P4] = p4;
+
+  func = c->exec;
+  func (ex);
+}
+#endif
+
+
+/* video_scale_orc_resample_vert_pack_s32_u8 */
+#ifdef DISABLE_ORC
+void
+video_scale_orc_resample_vert_pack_s32_u8 (guint8 * ORC_RESTRICT d1,
+    const gint32 * ORC_RESTRICT s1, int n)
+{
+  int i;
+  orc_int8 *ORC_RESTRICT ptr0;
+  const orc_union32 *ORC_RESTRICT ptr4;
+  orc_union32 var33;
+  orc_union32 var34;
+  orc_int8 var35;
+  orc_union32 var36;
+  orc_union32 var37;
+  orc_union16 var38;
+
+  ptr0 = (orc_int8 *) d1;
+  ptr4 = (orc_union32 *) s1;
+
+  /* 1: loadpl */
+  var34.i = (int) 0x00002000;   /* 8192 or 4.04739e-320f */
+
+  for (i = 0; i < n; i++) {
+    /* 0: loadl */
+    var33 = ptr4[i];
+    /* 2: addl */
+    var36.i = var33.i + var34.i;
+    /* 3: shrsl */
+    var37.i = var36.i >> 14;
+    /* 4: convssslw */
+    var38.i = ORC_CLAMP_SW (var37.i);
+    /* 5: convsuswb */
+    var35 = ORC_CLAMP_UB (var38.i);
+    /* 6: storeb */
+    ptr0[i] = var35;
+  }
+
+}
+
+#else
+static void
+_backup_video_scale_orc_resample_vert_pack_s32_u8 (OrcExecutor * ORC_RESTRICT
+    ex)
+{
+  int i;
+  int n = ex->n;
+  orc_int8 *ORC_RESTRICT ptr0;
+  const orc_union32 *ORC_RESTRICT ptr4;
+  orc_union32 var33;
+  orc_union32 var34;
+  orc_int8 var35;
+  orc_union32 var36;
+  orc_union32 var37;
+  orc_union16 var38;
+
+  ptr0 = (orc_int8 *) ex->arrays[0];
+  ptr4 = (orc_union32 *) ex->arrays[4];
+
+  /* 1: loadpl */
+  var34.i = (int) 0x00002000;   /* 8192 or 4.04739e-320f */
+
+  for (i = 0; i < n; i++) {
+    /* 0: loadl */
+    var33 = ptr4[i];
+    /* 2: addl */
+    var36.i = var33.i + var34.i;
+    /* 3: shrsl */
+    var37.i = var36.i >> 14;
+    /* 4: convssslw */
+    var38.i = ORC_CLAMP_SW (var37.i);
+    /* 5: convsuswb */
+    var35 = ORC_CLAMP_UB (var38.i);
+    /* 6: storeb */
+    ptr0[i] = var35;
+  }
+
+}
+
+void
+video_scale_orc_resample_vert_pack_s32_u8 (guint8 * ORC_RESTRICT d1,
+    const gint32 * ORC_RESTRICT s1, int n)
+{
+  OrcExecutor _ex, *ex = &_ex;
+  static volatile int p_inited = 0;
+  static OrcCode *c = 0;
+  void (*func) (OrcExecutor *);
+
+  if (!p_inited) {
+    orc_once_mutex_lock ();
+    if (!p_inited) {
+      OrcProgram *p;
+
+      p = orc_program_new ();
+      orc_program_set_name (p, "video_scale_orc_resample_vert_pack_s32_u8");
+      orc_program_set_backup_function (p,
+          _backup_video_scale_orc_resample_vert_pack_s32_u8);
+      orc_program_add_destination (p, 1, "d1");
+      orc_program_add_source (p, 4, "s1");
+      orc_program_add_constant (p, 4, 0x00002000, "c1");
+      orc_program_add_constant (p, 4, 0x0000000e, "c2");
+      orc_program_add_temporary (p, 4, "t1");
+      orc_program_add_temporary (p, 2, "t2");
+
+      orc_program_append_2 (p, "addl", 0, ORC_VAR_T1, ORC_VAR_S1, ORC_VAR_C1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "shrsl", 0, ORC_VAR_T1, ORC_VAR_T1, ORC_VAR_C2,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "convssslw", 0, ORC_VAR_T2, ORC_VAR_T1,
+          ORC_VAR_D1, ORC_VAR_D1);
+      orc_program_append_2 (p, "convsuswb", 0, ORC_VAR_D1, ORC_VAR_T2,
+          ORC_VAR_D1, ORC_VAR_D1);
+
+      orc_program_compile (p);
+      c = orc_program_take_code (p);
+      orc_program_free (p);
+    }
+    p_inited = TRUE;
+    orc_once_mutex_unlock ();
+  }
+  ex->arrays[ORC_VAR_A2] = c;
+  ex->program = 0;
+
+  ex->n = n;
+  ex->arrays[ORC_VAR_D1] = d1;
+  ex->arrays[ORC_VAR_S1] = (void *) s1;
+
+  func = c->exec;
+  func (ex);
+}
+#endif
+
+
+/* video_scale_orc_resample_vert_2tap_s32 */
+#ifdef DISABLE_ORC
+void
+video_scale_orc_resample_vert_2tap_s32 (gint32 * ORC_RESTRICT d1,
+    const gint32 * ORC_RESTRICT s1, const gint32 * ORC_RESTRICT s2, int p1,
+    int p2, int n)
+{
+  int i;
+  orc_union32 *ORC_RESTRICT ptr0;
+  const orc_union32 *ORC_RESTRICT ptr4;
+  const orc_union32 *ORC_RESTRICT ptr5;
+  orc_union32 var33;
+  orc_union32 var34;
+  orc_union32 var35;
+  orc_union32 var36;
+  orc_union32 var37;
+  orc_union32 var38;
+  orc_union32 var39;
+
+  ptr0 = (orc_union32 *) d1;
+  ptr4 = (orc_union32 *) s1;
+  ptr5 = (orc_union32 *) s2;
+
+  /* 1: loadpl */
+  var34.i = p1;
+  /* 4: loadpl */
+  var36.i = p2;
+
+  for (i = 0; i < n; i++) {
+    /* 0: loadl */
+    var33 = ptr4[i];
+    /* 2: mulll */
+    var38.i = (var33.i * var34.i) & 0xffffffff;
+    /* 3: loadl */
+    var35 = ptr5[i];
+    /* 5: mulll */
+    var39.i = (var35.i * var36.i) & 0xffffffff;
+    /* 6: addl */
+    var37.i = var38.i + var39.i;
+    /* 7: storel */
+    ptr0[i] = var37;
+  }
+
+}
+
+#else
+static void
+_backup_video_scale_orc_resample_vert_2tap_s32 (OrcExecutor * ORC_RESTRICT ex)
+{
+  int i;
+  int n = ex->n;
+  orc_union32 *ORC_RESTRICT ptr0;
+  const orc_union32 *ORC_RESTRICT ptr4;
+  const orc_union32 *ORC_RESTRICT ptr5;
+  orc_union32 var33;
+  orc_union32 var34;
+  orc_union32 var35;
+  orc_union32 var36;
+  orc_union32 var37;
+  orc_union32 var38;
+  orc_union32 var39;
+
+  ptr0 = (orc_union32 *) ex->arrays[0];
+  ptr4 = (orc_union32 *) ex->arrays[4];
+  ptr5 = (orc_union32 *) ex->arrays[5];
+
+  /* 1: loadpl */
+  var34.i = ex->params[24];
+  /* 4: loadpl */
+  var36.i = ex->params[25];
+
+  for (i = 0; i < n; i++) {
+    /* 0: loadl */
+    var33 = ptr4[i];
+    /* 2: mulll */
+    var38.i = (var33.i * var34.i) & 0xffffffff;
+    /* 3: loadl */
+    var35 = ptr5[i];
+    /* 5: mulll */
+    var39.i = (var35.i * var36.i) & 0xffffffff;
+    /* 6: addl */
+    var37.i = var38.i + var39.i;
+    /* 7: storel */
+    ptr0[i] = var37;
+  }
+
+}
+
+void
+video_scale_orc_resample_vert_2tap_s32 (gint32 * ORC_RESTRICT d1,
+    const gint32 * ORC_RESTRICT s1, const gint32 * ORC_RESTRICT s2, int p1,
+    int p2, int n)
+{
+  OrcExecutor _ex, *ex = &_ex;
+  static volatile int p_inited = 0;
+  static OrcCode *c = 0;
+  void (*func) (OrcExecutor *);
+
+  if (!p_inited) {
+    orc_once_mutex_lock ();
+    if (!p_inited) {
+      OrcProgram *p;
+
+      p = orc_program_new ();
+      orc_program_set_name (p, "video_scale_orc_resample_vert_2tap_s32");
+      orc_program_set_backup_function (p,
+          _backup_video_scale_orc_resample_vert_2tap_s32);
+      orc_program_add_destination (p, 4, "d1");
+      orc_program_add_source (p, 4, "s1");
+      orc_program_add_source (p, 4, "s2");
+      orc_program_add_parameter (p, 4, "p1");
+      orc_program_add_parameter (p, 4, "p2");
+      orc_program_add_temporary (p, 4, "t1");
+      orc_program_add_temporary (p, 4, "t2");
+
+      orc_program_append_2 (p, "mulll", 0, ORC_VAR_T1, ORC_VAR_S1, ORC_VAR_P1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "mulll", 0, ORC_VAR_T2, ORC_VAR_S2, ORC_VAR_P2,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "addl", 0, ORC_VAR_D1, ORC_VAR_T1, ORC_VAR_T2,
+          ORC_VAR_D1);
+
+      orc_program_compile (p);
+      c = orc_program_take_code (p);
+      orc_program_free (p);
+    }
+    p_inited = TRUE;
+    orc_once_mutex_unlock ();
+  }
+  ex->arrays[ORC_VAR_A2] = c;
+  ex->program = 0;
+
+  ex->n = n;
+  ex->arrays[ORC_VAR_D1] = d1;
+  ex->arrays[ORC_VAR_S1] = (void *) s1;
+  ex->arrays[ORC_VAR_S2] = (void *) s2;
+  ex->params[ORC_VAR_P1] = p1;
+  ex->params[ORC_VAR_P2] = p2;
+
+  func = c->exec;
+  func (ex);
+}
+#endif
+
+
+/* video_scale_orc_resample_vert_accum_2tap_s32 */
+#ifdef DISABLE_ORC
+void
+video_scale_orc_resample_vert_accum_2tap_s32 (gint32 * ORC_RESTRICT d1,
+    const gint32 * ORC_RESTRICT s1, const gint32 * ORC_RESTRICT s2, int p1,
+    int p2, int n)
+{
+  int i;
+  orc_union32 *ORC_RESTRICT ptr0;
+  const orc_union32 *ORC_RESTRICT ptr4;
+  const orc_union32 *ORC_RESTRICT ptr5;
+  orc_union32 var33;
+  orc_union32 var34;
+  orc_union32 var35;
+  orc_union32 var36;
+  orc_union32 var37;
+  orc_union32 var38;
+  orc_union32 var39;
+  orc_union32 var40;
+  orc_union32 var41;
+
+  ptr0 = (orc_union32 *) d1;
+  ptr4 = (orc_union32 *) s1;
+  ptr5 = (orc_union32 *) s2;
+
+  /* 1: loadpl */
+  var34.i = p1;
+  /* 4: loadpl */
+  var36.i = p2;
+
+  for (i = 0; i < n; i++) {
+    /* 0: loadl */
+    var33 = ptr4[i];
+    /* 2: mulll */
+    var39.i = (var33.i * var34.i) & 0xffffffff;
+    /* 3: loadl */
+    var35 = ptr5[i];
+    /* 5: mulll */
+    var40.i = (var35.i * var36.i) & 0xffffffff;
+    /* 6: addl */
+    var41.i = var39.i + var40.i;
+    /* 7: loadl */
+    var37 = ptr0[i];
+    /* 8: addl */
+    var38.i = var41.i + var37.i;
+    /* 9: storel */
+    ptr0[i] = var38;
+  }
+
+}
+
+#else
+static void
+_backup_video_scale_orc_resample_vert_accum_2tap_s32 (OrcExecutor * ORC_RESTRICT ex)
+{
+  int i;
+  int n = ex->n;
+  orc_union32 *ORC_RESTRICT ptr0;
+  const orc_union32 *ORC_RESTRICT ptr4;
+  const orc_union32 *ORC_RESTRICT ptr5;
+  orc_union32 var33;
+  orc_union32 var34;
+  orc_union32 var35;
+  orc_union32 var36;
+  orc_union32 var37;
+  orc_union32 var38;
+  orc_union32 var39;
+  orc_union32 var40;
+  orc_union32 var41;
+
+  ptr0 = (orc_union32 *) ex->arrays[0];
+  ptr4 = (orc_union32 *) ex->arrays[4];
+  ptr5 = (orc_union32 *) ex->arrays[5];
+
+  /* 1: loadpl */
+  var34.i = ex->params[24];
+  /* 4: loadpl */
+  var36.i = ex->params[25];
+
+  for (i = 0; i < n; i++) {
+    /* 0: loadl */
+    var33 = ptr4[i];
+    /* 2: mulll */
+    var39.i = (var33.i * var34.i) & 0xffffffff;
+    /* 3: loadl */
+    var35 = ptr5[i];
+    /* 5: mulll */
+    var40.i = (var35.i * var36.i) & 0xffffffff;
+    /* 6: addl */
+    var41.i = var39.i + var40.i;
+    /* 7: loadl */
+    var37 = ptr0[i];
+    /* 8: addl */
+    var38.i = var41.i + var37.i;
+    /* 9: storel */
+    ptr0[i] = var38;
+  }
+
+}
+
+void
+video_scale_orc_resample_vert_accum_2tap_s32 (gint32 * ORC_RESTRICT d1,
+    const gint32 * ORC_RESTRICT s1, const gint32 * ORC_RESTRICT s2, int p1,
+    int p2, int n)
+{
+  OrcExecutor _ex, *ex = &_ex;
+  static volatile int p_inited = 0;
+  static OrcCode *c = 0;
+  void (*func) (OrcExecutor *);
+
+  if (!p_inited) {
+    orc_once_mutex_lock ();
+    if (!p_inited) {
+      OrcProgram *p;
+
+      p = orc_program_new ();
+      orc_program_set_name (p, "video_scale_orc_resample_vert_accum_2tap_s32");
+      orc_program_set_backup_function (p,
+          _backup_video_scale_orc_resample_vert_accum_2tap_s32);
+      orc_program_add_destination (p, 4, "d1");
+      orc_program_add_source (p, 4, "s1");
+      orc_program_add_source (p, 4, "s2");
+      orc_program_add_parameter (p, 4, "p1");
+      orc_program_add_parameter (p, 4, "p2");
+      orc_program_add_temporary (p, 4, "t1");
+      orc_program_add_temporary (p, 4, "t2");
+
+      orc_program_append_2 (p, "mulll", 0, ORC_VAR_T1, ORC_VAR_S1, ORC_VAR_P1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "mulll", 0, ORC_VAR_T2, ORC_VAR_S2, ORC_VAR_P2,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "addl", 0, ORC_VAR_T1, ORC_VAR_T1, ORC_VAR_T2,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "addl", 0, ORC_VAR_D1, ORC_VAR_D1, ORC_VAR_T1,
+          ORC_VAR_D1);
+
+      orc_program_compile (p);
+      c = orc_program_take_code (p);
+      orc_program_free (p);
+    }
+    p_inited = TRUE;
+    orc_once_mutex_unlock ();
+  }
+  ex->arrays[ORC_VAR_A2] = c;
+  ex->program = 0;
+
+  ex->n = n;
+  ex->arrays[ORC_VAR_D1] = d1;
+  ex->arrays[ORC_VAR_S1] = (void *) s1;
+  ex->arrays[ORC_VAR_S2] = (void *) s2;
+  ex->params[ORC_VAR_P1] = p1;
+  ex->params[ORC_VAR_P2] = p2;
+
+  func = c->exec;
+  func (ex);
+}
+#endif
+
+
+/* video_scale_orc_resample_vert_accum_4tap_s32 */
+#ifdef DISABLE_ORC
+void
+video_scale_orc_resample_vert_accum_4tap_s32 (gint32 * ORC_RESTRICT d1,
+    const gint32 * ORC_RESTRICT s1, const gint32 * ORC_RESTRICT s2,
+    const gint32 * ORC_RESTRICT s3, const gint32 * ORC_RESTRICT s4, int p1,
+    int p2, int p3, int p4, int n)
+{
+  int i;
+  orc_union32 *ORC_RESTRICT ptr0;
+  const orc_union32 *ORC_RESTRICT ptr4;
+  const orc_union32 *ORC_RESTRICT ptr5;
+  const orc_union32 *ORC_RESTRICT ptr6;
+  const orc_union32 *ORC_RESTRICT ptr7;
+  orc_union32 var33;
+  orc_union32 var34;
+  orc_union32 var35;
+  orc_union32 var36;
+  orc_union32 var37;
+  orc_union32 var38;
+  orc_union32 var39;
+  orc_union32 var40;
+  orc_union32 var41;
+  orc_union32 var42;
+  orc_union32 var43;
+  orc_union32 var44;
+  orc_union32 var45;
+  orc_union32 var46;
+  orc_union32 var47;
+  orc_union32 var48;
+  orc_union32 var49;
+
+  ptr0 = (orc_union32 *) d1;
+  ptr4 = (orc_union32 *) s1;
+  ptr5 = (orc_union32 *) s2;
+  ptr6 = (orc_union32 *) s3;
+  ptr7 = (orc_union32 *) s4;
+
+  /* 1: loadpl */
+  var34.i = p1;
+  /* 4: loadpl */
+  var36.i = p2;
+  /* 8: loadpl */
+  var38.i = p3;
+  /* 12: loadpl */
+  var40.i = p4;
+
+  for (i = 0; i < n; i++) {
+    /* 0: loadl */
+    var33 = ptr4[i];
+    /* 2: mulll */
+    var43.i = (var33.i * var34.i) & 0xffffffff;
+    /* 3: loadl */
+    var35 = ptr5[i];
+    /* 5: mulll */
+    var44.i = (var35.i * var36.i) & 0xffffffff;
+    /* 6: addl */
+    var47.i = var43.i + var44.i;
+    /* 7: loadl */
+    var37 = ptr6[i];
+    /* 9: mulll */
+    var45.i = (var37.i * var38.i) & 0xffffffff;
+    /* 10: addl */
+    var48.i = var47.i + var45.i;
+    /* 11: loadl */
+    var39 = ptr7[i];
+    /* 13: mulll */
+    var46.i = (var39.i * var40.i) & 0xffffffff;
+    /* 14: addl */
+    var49.i = var48.i + var46.i;
+    /* 15: loadl */
+    var41 = ptr0[i];
+    /* 16: addl */
+    var42.i = var49.i + var41.i;
+    /* 17: storel */
+    ptr0[i] = var42;
+  }
+
+}
+
+#else
+static void
+_backup_video_scale_orc_resample_vert_accum_4tap_s32 (OrcExecutor * ORC_RESTRICT ex)
+{
+  int i;
+  int n = ex->n;
+  orc_union32 *ORC_RESTRICT ptr0;
+  const orc_union32 *ORC_RESTRICT ptr4;
+  const orc_union32 *ORC_RESTRICT ptr5;
+  const orc_union32 *ORC_RESTRICT ptr6;
+  const orc_union32 *ORC_RESTRICT ptr7;
+  orc_union32 var33;
+  orc_union32 var34;
+  orc_union32 var35;
+  orc_union32 var36;
+  orc_union32 var37;
+  orc_union32 var38;
+  orc_union32 var39;
+  orc_union32 var40;
+  orc_union32 var41;
+  orc_union32 var42;
+  orc_union32 var43;
+  orc_union32 var44;
+  orc_union32 var45;
+  orc_union32 var46;
+  orc_union32 var47;
+  orc_union32 var48;
+  orc_union32 var49;
+
+  ptr0 = (orc_union32 *) ex->arrays[0];
+  ptr4 = (orc_union32 *) ex->arrays[4];
+  ptr5 = (orc_union32 *) ex->arrays[5];
+  ptr6 = (orc_union32 *) ex->arrays[6];
+  ptr7 = (orc_union32 *) ex->arrays[7];
+
+  /* 1: loadpl */
+  var34.i = ex->params[24];
+  /* 4: loadpl */
+  var36.i = ex->params[25];
+  /* 8: loadpl */
+  var38.i = ex->params[26];
+  /* 12: loadpl */
+  var40.i = ex->params[27];
+
+  for (i = 0; i < n; i++) {
+    /* 0: loadl */
+    var33 = ptr4[i];
+    /* 2: mulll */
+    var43.i = (var33.i * var34.i) & 0xffffffff;
+    /* 3: loadl */
+    var35 = ptr5[i];
+    /* 5: mulll */
+    var44.i = (var35.i * var36.i) & 0xffffffff;
+    /* 6: addl */
+    var47.i = var43.i + var44.i;
+    /* 7: loadl */
+    var37 = ptr6[i];
+    /* 9: mulll */
+    var45.i = (var37.i * var38.i) & 0xffffffff;
+    /* 10: addl */
+    var48.i = var47.i + var45.i;
+    /* 11: loadl */
+    var39 = ptr7[i];
+    /* 13: mulll */
+    var46.i = (var39.i * var40.i) & 0xffffffff;
+    /* 14: addl */
+    var49.i = var48.i + var46.i;
+    /* 15: loadl */
+    var41 = ptr0[i];
+    /* 16: addl */
+    var42.i = var49.i + var41.i;
+    /* 17: storel */
+    ptr0[i] = var42;
+  }
+
+}
+
+void
+video_scale_orc_resample_vert_accum_4tap_s32 (gint32 * ORC_RESTRICT d1,
+    const gint32 * ORC_RESTRICT s1, const gint32 * ORC_RESTRICT s2,
+    const gint32 * ORC_RESTRICT s3, const gint32 * ORC_RESTRICT s4, int p1,
+    int p2, int p3, int p4, int n)
+{
+  OrcExecutor _ex, *ex = &_ex;
+  static volatile int p_inited = 0;
+  static OrcCode *c = 0;
+  void (*func) (OrcExecutor *);
+
+  if (!p_inited) {
+    orc_once_mutex_lock ();
+    if (!p_inited) {
+      OrcProgram *p;
+
+      p = orc_program_new ();
+      orc_program_set_name (p, "video_scale_orc_resample_vert_accum_4tap_s32");
+      orc_program_set_backup_function (p,
+          _backup_video_scale_orc_resample_vert_accum_4tap_s32);
+      orc_program_add_destination (p, 4, "d1");
+      orc_program_add_source (p, 4, "s1");
+      orc_program_add_source (p, 4, "s2");
+      orc_program_add_source (p, 4, "s3");
+      orc_program_add_source (p, 4, "s4");
+      orc_program_add_parameter (p, 4, "p1");
+      orc_program_add_parameter (p, 4, "p2");
+      orc_program_add_parameter (p, 4, "p3");
+      orc_program_add_parameter (p, 4, "p4");
+      orc_program_add_temporary (p, 4, "t1");
+      orc_program_add_temporary (p, 4, "t2");
+
+      orc_program_append_2 (p, "mulll", 0, ORC_VAR_T1, ORC_VAR_S1, ORC_VAR_P1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "mulll", 0, ORC_VAR_T2, ORC_VAR_S2, ORC_VAR_P2,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "addl", 0, ORC_VAR_T1, ORC_VAR_T1, ORC_VAR_T2,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "mulll", 0, ORC_VAR_T2, ORC_VAR_S3, ORC_VAR_P3,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "addl", 0, ORC_VAR_T1, ORC_VAR_T1, ORC_VAR_T2,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "mulll", 0, ORC_VAR_T2, ORC_VAR_S4, ORC_VAR_P4,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "addl", 0, ORC_VAR_T1, ORC_VAR_T1, ORC_VAR_T2,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "addl", 0, ORC_VAR_D1, ORC_VAR_D1, ORC_VAR_T1,
+          ORC_VAR_D1);
+
+      orc_program_compile (p);
+      c = orc_program_take_code (p);
+      orc_program_free (p);
+    }
+    p_inited = TRUE;
+    orc_once_mutex_unlock ();
+  }
+  ex->arrays[ORC_VAR_A2] = c;
+  ex->program = 0;
+
+  ex->n = n;
+  ex->arrays[ORC_VAR_D1] = d1;
+  ex->arrays[ORC_VAR_S1] = (void *) s1;
+  ex->arrays[ORC_VAR_S2] = (void *) s2;
+  ex->arrays[ORC_VAR_S3] = (void *) s3;
+  ex->arrays[ORC_VAR_S4] = (void *) s4;
+  ex->params[ORC_VAR_P1] = p1;
+  ex->params[ORC_VAR_P2] = p2;
+  ex->params[ORC_VAR_P3] = p3;
+  ex->params[ORC_VAR_P4] = p4;
+
+  func = c->exec;
+  func (ex);
+}
+#endif
+
+
+/* video_scale_orc_resample_vert_pack_s32_u8_22 */
+#ifdef DISABLE_ORC
+void
+video_scale_orc_resample_vert_pack_s32_u8_22 (guint8 * ORC_RESTRICT d1,
+    const gint32 * ORC_RESTRICT s1, int n)
+{
+  int i;
+  orc_int8 *ORC_RESTRICT ptr0;
+  const orc_union32 *ORC_RESTRICT ptr4;
+  orc_union32 var33;
+  orc_union32 var34;
+  orc_int8 var35;
+  orc_union32 var36;
+  orc_union32 var37;
+  orc_union16 var38;
+
+  ptr0 = (orc_int8 *) d1;
+  ptr4 = (orc_union32 *) s1;
+
+  /* 1: loadpl */
+  var34.i = (int) 0x00200000;   /* 2097152 or 1.03613e-317f */
+
+  for (i = 0; i < n; i++) {
+    /* 0: loadl */
+    var33 = ptr4[i];
+    /* 2: addl */
+    var36.i = var33.i + var34.i;
+    /* 3: shrsl */
+    var37.i = var36.i >> 22;
+    /* 4: convssslw */
+    var38.i = ORC_CLAMP_SW (var37.i);
+    /* 5: convsuswb */
+    var35 = ORC_CLAMP_UB (var38.i);
+    /* 6: storeb */
+    ptr0[i] = var35;
+  }
+
+}
+
+#else
+static void
+_backup_video_scale_orc_resample_vert_pack_s32_u8_22 (OrcExecutor * ORC_RESTRICT
+    ex)
+{
+  int i;
+  int n = ex->n;
+  orc_int8 *ORC_RESTRICT ptr0;
+  const orc_union32 *ORC_RESTRICT ptr4;
+  orc_union32 var33;
+  orc_union32 var34;
+  orc_int8 var35;
+  orc_union32 var36;
+  orc_union32 var37;
+  orc_union16 var38;
+
+  ptr0 = (orc_int8 *) ex->arrays[0];
+  ptr4 = (orc_union32 *) ex->arrays[4];
+
+  /* 1: loadpl */
+  var34.i = (int) 0x00200000;   /* 2097152 or 1.03613e-317f */
+
+  for (i = 0; i < n; i++) {
+    /* 0: loadl */
+    var33 = ptr4[i];
+    /* 2: addl */
+    var36.i = var33.i + var34.i;
+    /* 3: shrsl */
+    var37.i = var36.i >> 22;
+    /* 4: convssslw */
+    var38.i = ORC_CLAMP_SW (var37.i);
+    /* 5: convsuswb */
+    var35 = ORC_CLAMP_UB (var38.i);
+    /* 6: storeb */
+    ptr0[i] = var35;
+  }
+
+}
+
+void
+video_scale_orc_resample_vert_pack_s32_u8_22 (guint8 * ORC_RESTRICT d1,
+    const gint32 * ORC_RESTRICT s1, int n)
+{
+  OrcExecutor _ex, *ex = &_ex;
+  static volatile int p_inited = 0;
+  static OrcCode *c = 0;
+  void (*func) (OrcExecutor *);
+
+  if (!p_inited) {
+    orc_once_mutex_lock ();
+    if (!p_inited) {
+      OrcProgram *p;
+
+      p = orc_program_new ();
+      orc_program_set_name (p, "video_scale_orc_resample_vert_pack_s32_u8_22");
+      orc_program_set_backup_function (p,
+          _backup_video_scale_orc_resample_vert_pack_s32_u8_22);
+      orc_program_add_destination (p, 1, "d1");
+      orc_program_add_source (p, 4, "s1");
+      orc_program_add_constant (p, 4, 0x00200000, "c1");
+      orc_program_add_constant (p, 4, 0x00000016, "c2");
+      orc_program_add_temporary (p, 4, "t1");
+      orc_program_add_temporary (p, 2, "t2");
+
+      orc_program_append_2 (p, "addl", 0, ORC_VAR_T1, ORC_VAR_S1, ORC_VAR_C1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "shrsl", 0, ORC_VAR_T1, ORC_VAR_T1, ORC_VAR_C2,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "convssslw", 0, ORC_VAR_T2, ORC_VAR_T1,
+          ORC_VAR_D1, ORC_VAR_D1);
+      orc_program_append_2 (p, "convsuswb", 0, ORC_VAR_D1, ORC_VAR_T2,
+          ORC_VAR_D1, ORC_VAR_D1);
+
+      orc_program_compile (p);
+      c = orc_program_take_code (p);
+      orc_program_free (p);
+    }
+    p_inited = TRUE;
+    orc_once_mutex_unlock ();
+  }
+  ex->arrays[ORC_VAR_A2] = c;
+  ex->program = 0;
+
+  ex->n = n;
+  ex->arrays[ORC_VAR_D1] = d1;
+  ex->arrays[ORC_VAR_S1] = (void *) s1;
+
+  func = c->exec;
+  func (ex);
+}
+#endif
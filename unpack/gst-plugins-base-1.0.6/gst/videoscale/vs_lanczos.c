@@ -159,6 +159,9 @@ struct _Scale1D
   int n_taps;
   gint32 *offsets;
   void *taps;
+
+  /* the TapsCacheEntry the taps belong to */
+  void *entry;
 };
 
 typedef struct _Scale Scale;
@@ -171,6 +174,7 @@ struct _Scale
   gboolean dither;
 
   void *tmpdata;
+  gint32 *accdata;
 
   HorizResampleFunc horiz_resample_func;
 
@@ -541,6 +545,150 @@ scale1d_calculate_taps_int16 (Scale1D * scale, int src_size, int dest_size,
 }
 
 
+/*
+ * Calculating a set of taps is costly: sinc and envelope in double
+ * precision for every tap and, for the int16 taps, a search for the
+ * rounding bias of every destination element.  The taps only depend on
+ * the geometry and on the filter parameters, so they are kept in a small
+ * cache shared by all scalers instead of being recalculated for every
+ * plane of every frame.
+ */
+typedef enum
+{
+  TAPS_DOUBLE,
+  TAPS_FLOAT,
+  TAPS_INT32,
+  TAPS_INT16
+} TapsType;
+
+#define TAPS_CACHE_SIZE 16
+
+typedef struct _TapsCacheEntry TapsCacheEntry;
+struct _TapsCacheEntry
+{
+  TapsType type;
+  int src_size;
+  int dest_size;
+  int n_taps;
+  double a;
+  double sharpness;
+  double sharpen;
+  int shift;
+
+  /* protected by the cache lock */
+  int refcount;
+  gboolean cached;
+
+  Scale1D scale1d;
+};
+
+G_LOCK_DEFINE_STATIC (taps_cache);
+static GQueue taps_cache = G_QUEUE_INIT;
+
+static void
+taps_cache_entry_free (TapsCacheEntry * entry)
+{
+  scale1d_cleanup (&entry->scale1d);
+  g_slice_free (TapsCacheEntry, entry);
+}
+
+/*
+ * Fills @scale with the taps for the given geometry and filter from the
+ * cache, calculating them on a miss.  Release with scale1d_release_taps().
+ */
+static void
+scale1d_get_taps (Scale1D * scale, TapsType type, int src_size,
+    int dest_size, int n_taps, double a, double sharpness, double sharpen,
+    int shift)
+{
+  TapsCacheEntry *entry = NULL, *evict = NULL;
+  GList *l;
+
+  G_LOCK (taps_cache);
+  for (l = taps_cache.head; l; l = l->next) {
+    TapsCacheEntry *e = l->data;
+
+    if (e->type == type && e->src_size == src_size &&
+        e->dest_size == dest_size && e->n_taps == n_taps && e->a == a &&
+        e->sharpness == sharpness && e->sharpen == sharpen &&
+        e->shift == shift) {
+      entry = e;
+      entry->refcount++;
+      /* most recently used first, we evict from the tail */
+      g_queue_unlink (&taps_cache, l);
+      g_queue_push_head_link (&taps_cache, l);
+      break;
+    }
+  }
+  G_UNLOCK (taps_cache);
+
+  if (entry == NULL) {
+    entry = g_slice_new0 (TapsCacheEntry);
+    entry->type = type;
+    entry->src_size = src_size;
+    entry->dest_size = dest_size;
+    entry->n_taps = n_taps;
+    entry->a = a;
+    entry->sharpness = sharpness;
+    entry->sharpen = sharpen;
+    entry->shift = shift;
+    entry->refcount = 1;
+
+    switch (type) {
+      case TAPS_DOUBLE:
+        scale1d_calculate_taps (&entry->scale1d, src_size, dest_size,
+            n_taps, a, sharpness, sharpen);
+        break;
+      case TAPS_FLOAT:
+        scale1d_calculate_taps_float (&entry->scale1d, src_size, dest_size,
+            n_taps, a, sharpness, sharpen);
+        break;
+      case TAPS_INT32:
+        scale1d_calculate_taps_int32 (&entry->scale1d, src_size, dest_size,
+            n_taps, a, sharpness, sharpen, shift);
+        break;
+      case TAPS_INT16:
+        scale1d_calculate_taps_int16 (&entry->scale1d, src_size, dest_size,
+            n_taps, a, sharpness, sharpen, shift);
+        break;
+    }
+
+    G_LOCK (taps_cache);
+    entry->cached = TRUE;
+    g_queue_push_head (&taps_cache, entry);
+    if (taps_cache.length > TAPS_CACHE_SIZE) {
+      evict = g_queue_pop_tail (&taps_cache);
+      evict->cached = FALSE;
+      /* still in use, the last user frees it */
+      if (evict->refcount > 0)
+        evict = NULL;
+    }
+    G_UNLOCK (taps_cache);
+
+    if (evict)
+      taps_cache_entry_free (evict);
+  }
+
+  *scale = entry->scale1d;
+  scale->entry = entry;
+}
+
+static void
+scale1d_release_taps (Scale1D * scale)
+{
+  TapsCacheEntry *entry = scale->entry;
+  gboolean do_free;
+
+  G_LOCK (taps_cache);
+  entry->refcount--;
+  do_free = (entry->refcount == 0 && !entry->cached);
+  G_UNLOCK (taps_cache);
+
+  if (do_free)
+    taps_cache_entry_free (entry);
+}
+
+
 void
 vs_image_scale_lanczos_Y (const VSImage * dest, const VSImage * src,
     uint8_t * tmpbuf, double sharpness, gboolean dither, int submethod,
@@ -776,26 +924,6 @@ RESAMPLE_HORIZ_AYUV (resample_horiz_int16_int16_ayuv_taps4_shift0, gint16, gint1
     guint8, 4, 0)
 /* *INDENT-ON* */
 
-#define RESAMPLE_VERT(function, tap_type, src_type, _n_taps, _shift) \
-static void \
-function (guint8 *dest, \
-    const tap_type *taps, const src_type *src, int stride, int n_taps, \
-    int shift, int n) \
-{ \
-  int i; \
-  int l; \
-  gint32 sum_y; \
-  gint32 offset = (1<<_shift) >> 1; \
-  for (i = 0; i < n; i++) { \
-    sum_y = 0; \
-    for (l = 0; l < n_taps; l++) { \
-      const src_type *line = PTR_OFFSET(src, stride * l); \
-      sum_y += line[i] * taps[l]; \
-    } \
-    dest[i] = CLAMP ((sum_y + offset) >> _shift, 0, 255); \
-  } \
-}
-
 #define RESAMPLE_VERT_DITHER(function, tap_type, src_type, _n_taps, _shift) \
 static void \
 function (guint8 *dest, \
@@ -820,10 +948,8 @@ function (guint8 *dest, \
 }
 
 /* *INDENT-OFF* */
-RESAMPLE_VERT (resample_vert_int32_generic, gint32, gint32, n_taps, shift)
 RESAMPLE_VERT_DITHER (resample_vert_dither_int32_generic, gint32, gint32,
     n_taps, shift)
-RESAMPLE_VERT (resample_vert_int16_generic, gint16, gint16, n_taps, shift);
 RESAMPLE_VERT_DITHER (resample_vert_dither_int16_generic, gint16, gint16,
     n_taps, shift)
 /* *INDENT-ON* */
@@ -890,6 +1016,35 @@ RESAMPLE_VERT_FLOAT_DITHER (resample_vert_dither_float_generic, guint8, 255, flo
 #define S16_MIDSHIFT 0
 #define S16_POSTSHIFT (S16_SHIFT1+S16_SHIFT2-S16_MIDSHIFT)
 
+/*
+ * Vertical pass on the int16 lines with Orc, the taps are applied to
+ * 2 or 4 lines at a time and summed in @acc, which is rounded and packed
+ * at the end.  The number of vertical taps is always even.
+ */
+static void
+resample_vert_int16_orc (guint8 * dest, const gint16 * taps,
+    const gint16 * src, int stride, int n_taps, gint32 * acc, int n)
+{
+  int l;
+
+#define VERT_LINE(l) ((const gint16 *) PTR_OFFSET (src, stride * (l)))
+  video_scale_orc_resample_vert_2tap_s16 (acc, VERT_LINE (0), VERT_LINE (1),
+      taps[0], taps[1], n);
+  for (l = 2; l + 4 <= n_taps; l += 4) {
+    video_scale_orc_resample_vert_accum_4tap_s16 (acc, VERT_LINE (l),
+        VERT_LINE (l + 1), VERT_LINE (l + 2), VERT_LINE (l + 3), taps[l],
+        taps[l + 1], taps[l + 2], taps[l + 3], n);
+  }
+  if (l < n_taps) {
+    video_scale_orc_resample_vert_accum_2tap_s16 (acc, VERT_LINE (l),
+        VERT_LINE (l + 1), taps[l], taps[l + 1], n);
+  }
+#undef VERT_LINE
+
+  /* rounds and shifts by S16_POSTSHIFT */
+  video_scale_orc_resample_vert_pack_s32_u8 (dest, acc, n);
+}
+
 static void
 vs_scale_lanczos_Y_int16 (Scale * scale)
 {
@@ -921,10 +1076,10 @@ vs_scale_lanczos_Y_int16 (Scale * scale)
           sizeof (gint16) * scale->dest->width, scale->y_scale1d.n_taps,
           S16_POSTSHIFT, scale->dest->width);
     } else {
-      resample_vert_int16_generic (destline,
+      resample_vert_int16_orc (destline,
           taps, TMP_LINE_S16 (scale->y_scale1d.offsets[j]),
           sizeof (gint16) * scale->dest->width, scale->y_scale1d.n_taps,
-          S16_POSTSHIFT, scale->dest->width);
+          scale->accdata, scale->dest->width);
     }
   }
 }
@@ -943,11 +1098,11 @@ vs_image_scale_lanczos_Y_int16 (const VSImage * dest, const VSImage * src,
 
   n_taps = scale1d_get_n_taps (src->width, dest->width, a, sharpness);
   n_taps = ROUND_UP_4 (n_taps);
-  scale1d_calculate_taps_int16 (&scale->x_scale1d,
+  scale1d_get_taps (&scale->x_scale1d, TAPS_INT16,
       src->width, dest->width, n_taps, a, sharpness, sharpen, S16_SHIFT1);
 
   n_taps = scale1d_get_n_taps (src->height, dest->height, a, sharpness);
-  scale1d_calculate_taps_int16 (&scale->y_scale1d,
+  scale1d_get_taps (&scale->y_scale1d, TAPS_INT16,
       src->height, dest->height, n_taps, a, sharpness, sharpen, S16_SHIFT2);
 
   scale->dither = dither;
@@ -977,12 +1132,14 @@ vs_image_scale_lanczos_Y_int16 (const VSImage * dest, const VSImage * src,
 
   scale->tmpdata =
       g_malloc (sizeof (gint16) * scale->dest->width * scale->src->height);
+  scale->accdata = g_malloc (sizeof (gint32) * scale->dest->width);
 
   vs_scale_lanczos_Y_int16 (scale);
 
-  scale1d_cleanup (&scale->x_scale1d);
-  scale1d_cleanup (&scale->y_scale1d);
+  scale1d_release_taps (&scale->x_scale1d);
+  scale1d_release_taps (&scale->y_scale1d);
   g_free (scale->tmpdata);
+  g_free (scale->accdata);
 }
 
 
@@ -991,6 +1148,34 @@ vs_image_scale_lanczos_Y_int16 (const VSImage * dest, const VSImage * src,
 #define S32_MIDSHIFT 0
 #define S32_POSTSHIFT (S32_SHIFT1+S32_SHIFT2-S32_MIDSHIFT)
 
+/*
+ * Vertical pass on the int32 lines with Orc, like resample_vert_int16_orc().
+ * The sums wrap in 32 bits like they did in C, so the output is unchanged.
+ */
+static void
+resample_vert_int32_orc (guint8 * dest, const gint32 * taps,
+    const gint32 * src, int stride, int n_taps, gint32 * acc, int n)
+{
+  int l;
+
+#define VERT_LINE(l) ((const gint32 *) PTR_OFFSET (src, stride * (l)))
+  video_scale_orc_resample_vert_2tap_s32 (acc, VERT_LINE (0), VERT_LINE (1),
+      taps[0], taps[1], n);
+  for (l = 2; l + 4 <= n_taps; l += 4) {
+    video_scale_orc_resample_vert_accum_4tap_s32 (acc, VERT_LINE (l),
+        VERT_LINE (l + 1), VERT_LINE (l + 2), VERT_LINE (l + 3), taps[l],
+        taps[l + 1], taps[l + 2], taps[l + 3], n);
+  }
+  if (l < n_taps) {
+    video_scale_orc_resample_vert_accum_2tap_s32 (acc, VERT_LINE (l),
+        VERT_LINE (l + 1), taps[l], taps[l + 1], n);
+  }
+#undef VERT_LINE
+
+  /* rounds and shifts by S32_POSTSHIFT */
+  video_scale_orc_resample_vert_pack_s32_u8_22 (dest, acc, n);
+}
+
 static void
 vs_scale_lanczos_Y_int32 (Scale * scale)
 {
@@ -1022,10 +1207,10 @@ vs_scale_lanczos_Y_int32 (Scale * scale)
           sizeof (gint32) * scale->dest->width,
           scale->y_scale1d.n_taps, S32_POSTSHIFT, scale->dest->width);
     } else {
-      resample_vert_int32_generic (destline,
+      resample_vert_int32_orc (destline,
           taps, TMP_LINE_S32 (scale->y_scale1d.offsets[j]),
-          sizeof (gint32) * scale->dest->width,
-          scale->y_scale1d.n_taps, S32_POSTSHIFT, scale->dest->width);
+          sizeof (gint32) * scale->dest->width, scale->y_scale1d.n_taps,
+          scale->accdata, scale->dest->width);
     }
   }
 }
@@ -1044,11 +1229,11 @@ vs_image_scale_lanczos_Y_int32 (const VSImage * dest, const VSImage * src,
 
   n_taps = scale1d_get_n_taps (src->width, dest->width, a, sharpness);
   n_taps = ROUND_UP_4 (n_taps);
-  scale1d_calculate_taps_int32 (&scale->x_scale1d,
+  scale1d_get_taps (&scale->x_scale1d, TAPS_INT32,
       src->width, dest->width, n_taps, a, sharpness, sharpen, S32_SHIFT1);
 
   n_taps = scale1d_get_n_taps (src->height, dest->height, a, sharpness);
-  scale1d_calculate_taps_int32 (&scale->y_scale1d,
+  scale1d_get_taps (&scale->y_scale1d, TAPS_INT32,
       src->height, dest->height, n_taps, a, sharpness, sharpen, S32_SHIFT2);
 
   scale->dither = dither;
@@ -1078,12 +1263,14 @@ vs_image_scale_lanczos_Y_int32 (const VSImage * dest, const VSImage * src,
 
   scale->tmpdata =
       g_malloc (sizeof (int32_t) * scale->dest->width * scale->src->height);
+  scale->accdata = g_malloc (sizeof (gint32) * scale->dest->width);
 
   vs_scale_lanczos_Y_int32 (scale);
 
-  scale1d_cleanup (&scale->x_scale1d);
-  scale1d_cleanup (&scale->y_scale1d);
+  scale1d_release_taps (&scale->x_scale1d);
+  scale1d_release_taps (&scale->y_scale1d);
   g_free (scale->tmpdata);
+  g_free (scale->accdata);
 }
 
 static void
@@ -1138,12 +1325,12 @@ vs_image_scale_lanczos_Y_double (const VSImage * dest, const VSImage * src,
   scale->src = src;
 
   n_taps = scale1d_get_n_taps (src->width, dest->width, a, sharpness);
-  scale1d_calculate_taps (&scale->x_scale1d,
-      src->width, dest->width, n_taps, a, sharpness, sharpen);
+  scale1d_get_taps (&scale->x_scale1d, TAPS_DOUBLE,
+      src->width, dest->width, n_taps, a, sharpness, sharpen, 0);
 
   n_taps = scale1d_get_n_taps (src->height, dest->height, a, sharpness);
-  scale1d_calculate_taps (&scale->y_scale1d,
-      src->height, dest->height, n_taps, a, sharpness, sharpen);
+  scale1d_get_taps (&scale->y_scale1d, TAPS_DOUBLE,
+      src->height, dest->height, n_taps, a, sharpness, sharpen, 0);
 
   scale->dither = dither;
 
@@ -1155,8 +1342,8 @@ vs_image_scale_lanczos_Y_double (const VSImage * dest, const VSImage * src,
 
   vs_scale_lanczos_Y_double (scale);
 
-  scale1d_cleanup (&scale->x_scale1d);
-  scale1d_cleanup (&scale->y_scale1d);
+  scale1d_release_taps (&scale->x_scale1d);
+  scale1d_release_taps (&scale->y_scale1d);
   g_free (scale->tmpdata);
 }
 
@@ -1212,12 +1399,12 @@ vs_image_scale_lanczos_Y_float (const VSImage * dest, const VSImage * src,
   scale->src = src;
 
   n_taps = scale1d_get_n_taps (src->width, dest->width, a, sharpness);
-  scale1d_calculate_taps_float (&scale->x_scale1d,
-      src->width, dest->width, n_taps, a, sharpness, sharpen);
+  scale1d_get_taps (&scale->x_scale1d, TAPS_FLOAT,
+      src->width, dest->width, n_taps, a, sharpness, sharpen, 0);
 
   n_taps = scale1d_get_n_taps (src->height, dest->height, a, sharpness);
-  scale1d_calculate_taps_float (&scale->y_scale1d,
-      src->height, dest->height, n_taps, a, sharpness, sharpen);
+  scale1d_get_taps (&scale->y_scale1d, TAPS_FLOAT,
+      src->height, dest->height, n_taps, a, sharpness, sharpen, 0);
 
   scale->dither = dither;
 
@@ -1229,8 +1416,8 @@ vs_image_scale_lanczos_Y_float (const VSImage * dest, const VSImage * src,
 
   vs_scale_lanczos_Y_float (scale);
 
-  scale1d_cleanup (&scale->x_scale1d);
-  scale1d_cleanup (&scale->y_scale1d);
+  scale1d_release_taps (&scale->x_scale1d);
+  scale1d_release_taps (&scale->y_scale1d);
   g_free (scale->tmpdata);
 }
 
@@ -1269,10 +1456,10 @@ vs_scale_lanczos_AYUV_int16 (Scale * scale)
           sizeof (gint16) * 4 * scale->dest->width,
           scale->y_scale1d.n_taps, S16_POSTSHIFT, scale->dest->width * 4);
     } else {
-      resample_vert_int16_generic (destline,
+      resample_vert_int16_orc (destline,
           taps, TMP_LINE_S16_AYUV (scale->y_scale1d.offsets[j]),
           sizeof (gint16) * 4 * scale->dest->width,
-          scale->y_scale1d.n_taps, S16_POSTSHIFT, scale->dest->width * 4);
+          scale->y_scale1d.n_taps, scale->accdata, scale->dest->width * 4);
     }
   }
 }
@@ -1291,11 +1478,11 @@ vs_image_scale_lanczos_AYUV_int16 (const VSImage * dest, const VSImage * src,
 
   n_taps = scale1d_get_n_taps (src->width, dest->width, a, sharpness);
   n_taps = ROUND_UP_4 (n_taps);
-  scale1d_calculate_taps_int16 (&scale->x_scale1d,
+  scale1d_get_taps (&scale->x_scale1d, TAPS_INT16,
       src->width, dest->width, n_taps, a, sharpness, sharpen, S16_SHIFT1);
 
   n_taps = scale1d_get_n_taps (src->height, dest->height, a, sharpness);
-  scale1d_calculate_taps_int16 (&scale->y_scale1d,
+  scale1d_get_taps (&scale->y_scale1d, TAPS_INT16,
       src->height, dest->height, n_taps, a, sharpness, sharpen, S16_SHIFT2);
 
   scale->dither = dither;
@@ -1325,12 +1512,14 @@ vs_image_scale_lanczos_AYUV_int16 (const VSImage * dest, const VSImage * src,
 
   scale->tmpdata =
       g_malloc (sizeof (gint16) * scale->dest->width * scale->src->height * 4);
+  scale->accdata = g_malloc (sizeof (gint32) * scale->dest->width * 4);
 
   vs_scale_lanczos_AYUV_int16 (scale);
 
-  scale1d_cleanup (&scale->x_scale1d);
-  scale1d_cleanup (&scale->y_scale1d);
+  scale1d_release_taps (&scale->x_scale1d);
+  scale1d_release_taps (&scale->y_scale1d);
   g_free (scale->tmpdata);
+  g_free (scale->accdata);
 }
 
 
@@ -1365,10 +1554,10 @@ vs_scale_lanczos_AYUV_int32 (Scale * scale)
           sizeof (gint32) * 4 * scale->dest->width, scale->y_scale1d.n_taps,
           S32_POSTSHIFT, scale->dest->width * 4);
     } else {
-      resample_vert_int32_generic (destline,
+      resample_vert_int32_orc (destline,
           taps, TMP_LINE_S32_AYUV (scale->y_scale1d.offsets[j]),
           sizeof (gint32) * 4 * scale->dest->width, scale->y_scale1d.n_taps,
-          S32_POSTSHIFT, scale->dest->width * 4);
+          scale->accdata, scale->dest->width * 4);
     }
   }
 }
@@ -1387,11 +1576,11 @@ vs_image_scale_lanczos_AYUV_int32 (const VSImage * dest, const VSImage * src,
 
   n_taps = scale1d_get_n_taps (src->width, dest->width, a, sharpness);
   n_taps = ROUND_UP_4 (n_taps);
-  scale1d_calculate_taps_int32 (&scale->x_scale1d,
+  scale1d_get_taps (&scale->x_scale1d, TAPS_INT32,
       src->width, dest->width, n_taps, a, sharpness, sharpen, S32_SHIFT1);
 
   n_taps = scale1d_get_n_taps (src->height, dest->height, a, sharpness);
-  scale1d_calculate_taps_int32 (&scale->y_scale1d,
+  scale1d_get_taps (&scale->y_scale1d, TAPS_INT32,
       src->height, dest->height, n_taps, a, sharpness, sharpen, S32_SHIFT2);
 
   scale->dither = dither;
@@ -1421,12 +1610,14 @@ vs_image_scale_lanczos_AYUV_int32 (const VSImage * dest, const VSImage * src,
 
   scale->tmpdata =
       g_malloc (sizeof (int32_t) * scale->dest->width * scale->src->height * 4);
+  scale->accdata = g_malloc (sizeof (gint32) * scale->dest->width * 4);
 
   vs_scale_lanczos_AYUV_int32 (scale);
 
-  scale1d_cleanup (&scale->x_scale1d);
-  scale1d_cleanup (&scale->y_scale1d);
+  scale1d_release_taps (&scale->x_scale1d);
+  scale1d_release_taps (&scale->y_scale1d);
   g_free (scale->tmpdata);
+  g_free (scale->accdata);
 }
 
 static void
@@ -1481,12 +1672,12 @@ vs_image_scale_lanczos_AYUV_double (const VSImage * dest, const VSImage * src,
   scale->src = src;
 
   n_taps = scale1d_get_n_taps (src->width, dest->width, a, sharpness);
-  scale1d_calculate_taps (&scale->x_scale1d,
-      src->width, dest->width, n_taps, a, sharpness, sharpen);
+  scale1d_get_taps (&scale->x_scale1d, TAPS_DOUBLE,
+      src->width, dest->width, n_taps, a, sharpness, sharpen, 0);
 
   n_taps = scale1d_get_n_taps (src->height, dest->height, a, sharpness);
-  scale1d_calculate_taps (&scale->y_scale1d,
-      src->height, dest->height, n_taps, a, sharpness, sharpen);
+  scale1d_get_taps (&scale->y_scale1d, TAPS_DOUBLE,
+      src->height, dest->height, n_taps, a, sharpness, sharpen, 0);
 
   scale->dither = dither;
 
@@ -1498,8 +1689,8 @@ vs_image_scale_lanczos_AYUV_double (const VSImage * dest, const VSImage * src,
 
   vs_scale_lanczos_AYUV_double (scale);
 
-  scale1d_cleanup (&scale->x_scale1d);
-  scale1d_cleanup (&scale->y_scale1d);
+  scale1d_release_taps (&scale->x_scale1d);
+  scale1d_release_taps (&scale->y_scale1d);
   g_free (scale->tmpdata);
 }
 
@@ -1555,12 +1746,12 @@ vs_image_scale_lanczos_AYUV_float (const VSImage * dest, const VSImage * src,
   scale->src = src;
 
   n_taps = scale1d_get_n_taps (src->width, dest->width, a, sharpness);
-  scale1d_calculate_taps_float (&scale->x_scale1d,
-      src->width, dest->width, n_taps, a, sharpness, sharpen);
+  scale1d_get_taps (&scale->x_scale1d, TAPS_FLOAT,
+      src->width, dest->width, n_taps, a, sharpness, sharpen, 0);
 
   n_taps = scale1d_get_n_taps (src->height, dest->height, a, sharpness);
-  scale1d_calculate_taps_float (&scale->y_scale1d,
-      src->height, dest->height, n_taps, a, sharpness, sharpen);
+  scale1d_get_taps (&scale->y_scale1d, TAPS_FLOAT,
+      src->height, dest->height, n_taps, a, sharpness, sharpen, 0);
 
   scale->dither = dither;
 
@@ -1572,8 +1763,8 @@ vs_image_scale_lanczos_AYUV_float (const VSImage * dest, const VSImage * src,
 
   vs_scale_lanczos_AYUV_float (scale);
 
-  scale1d_cleanup (&scale->x_scale1d);
-  scale1d_cleanup (&scale->y_scale1d);
+  scale1d_release_taps (&scale->x_scale1d);
+  scale1d_release_taps (&scale->y_scale1d);
   g_free (scale->tmpdata);
 }
 
@@ -1629,12 +1820,12 @@ vs_image_scale_lanczos_AYUV64_double (const VSImage * dest, const VSImage * src,
   scale->src = src;
 
   n_taps = scale1d_get_n_taps (src->width, dest->width, a, sharpness);
-  scale1d_calculate_taps (&scale->x_scale1d,
-      src->width, dest->width, n_taps, a, sharpness, sharpen);
+  scale1d_get_taps (&scale->x_scale1d, TAPS_DOUBLE,
+      src->width, dest->width, n_taps, a, sharpness, sharpen, 0);
 
   n_taps = scale1d_get_n_taps (src->height, dest->height, a, sharpness);
-  scale1d_calculate_taps (&scale->y_scale1d,
-      src->height, dest->height, n_taps, a, sharpness, sharpen);
+  scale1d_get_taps (&scale->y_scale1d, TAPS_DOUBLE,
+      src->height, dest->height, n_taps, a, sharpness, sharpen, 0);
 
   scale->dither = dither;
 
@@ -1646,7 +1837,7 @@ vs_image_scale_lanczos_AYUV64_double (const VSImage * dest, const VSImage * src,
 
   vs_scale_lanczos_AYUV64_double (scale);
 
-  scale1d_cleanup (&scale->x_scale1d);
-  scale1d_cleanup (&scale->y_scale1d);
+  scale1d_release_taps (&scale->x_scale1d);
+  scale1d_release_taps (&scale->y_scale1d);
   g_free (scale->tmpdata);
 }
@@ -115,6 +115,95 @@ GST_START_TEST (test_template_formats)
 
 GST_END_TEST;
 
+static void
+handoff_cb (GstElement * sink, GstBuffer * buffer, GstPad * pad,
+    GstBuffer ** out)
+{
+  gst_buffer_replace (out, buffer);
+}
+
+/* converts one frame of the circular test pattern with the given number of
+ * threads */
+static GstBuffer *
+convert_frame (const gchar * in_format, const gchar * out_format,
+    guint n_threads)
+{
+  GstElement *pipeline, *sink;
+  GstBuffer *buffer = NULL;
+  GstMessage *msg;
+  GstBus *bus;
+  gchar *desc;
+
+  desc = g_strdup_printf ("videotestsrc num-buffers=1 pattern=circular ! "
+      "video/x-raw,format=%s,width=319,height=241 ! "
+      "videoconvert n-threads=%u ! video/x-raw,format=%s ! "
+      "fakesink name=sink signal-handoffs=true", in_format, n_threads,
+      out_format);
+  pipeline = gst_parse_launch (desc, NULL);
+  fail_unless (pipeline != NULL);
+  g_free (desc);
+
+  sink = gst_bin_get_by_name (GST_BIN (pipeline), "sink");
+  g_signal_connect (sink, "handoff", G_CALLBACK (handoff_cb), &buffer);
+  gst_object_unref (sink);
+
+  fail_unless (gst_element_set_state (pipeline, GST_STATE_PLAYING) !=
+      GST_STATE_CHANGE_FAILURE);
+
+  bus = gst_element_get_bus (pipeline);
+  msg = gst_bus_timed_pop_filtered (bus, GST_CLOCK_TIME_NONE,
+      GST_MESSAGE_EOS | GST_MESSAGE_ERROR);
+  fail_unless_equals_int (GST_MESSAGE_TYPE (msg), GST_MESSAGE_EOS);
+  gst_message_unref (msg);
+  gst_object_unref (bus);
+
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+  gst_object_unref (pipeline);
+
+  fail_unless (buffer != NULL);
+
+  return buffer;
+}
+
+GST_START_TEST (test_threads)
+{
+  static const gchar *formats[][2] = {
+    {"I420", "YUY2"}, {"I420", "Y444"}, {"YUY2", "I420"}, {"AYUV", "I420"},
+    {"Y42B", "I420"}, {"I420", "BGRA"}, {"I420", "RGB"}, {"ARGB64", "I420"},
+    {"YUV9", "YUY2"}
+  };
+  guint i, n_threads;
+
+  for (i = 0; i < G_N_ELEMENTS (formats); i++) {
+    GstBuffer *ref;
+    GstMapInfo ref_map;
+
+    ref = convert_frame (formats[i][0], formats[i][1], 1);
+    gst_buffer_map (ref, &ref_map, GST_MAP_READ);
+
+    for (n_threads = 2; n_threads <= 8; n_threads += 3) {
+      GstBuffer *buffer;
+      GstMapInfo map;
+
+      GST_DEBUG ("%s -> %s with %u threads", formats[i][0], formats[i][1],
+          n_threads);
+
+      buffer = convert_frame (formats[i][0], formats[i][1], n_threads);
+      gst_buffer_map (buffer, &map, GST_MAP_READ);
+      fail_unless_equals_int (map.size, ref_map.size);
+      fail_unless (memcmp (map.data, ref_map.data, map.size) == 0,
+          "%s -> %s differs with %u threads", formats[i][0], formats[i][1],
+          n_threads);
+      gst_buffer_unmap (buffer, &map);
+      gst_buffer_unref (buffer);
+    }
+    gst_buffer_unmap (ref, &ref_map);
+    gst_buffer_unref (ref);
+  }
+}
+
+GST_END_TEST;
+
 static Suite *
 videoconvert_suite (void)
 {
@@ -124,6 +213,7 @@ videoconvert_suite (void)
   suite_add_tcase (s, tc_chain);
 
   tcase_add_test (tc_chain, test_template_formats);
+  tcase_add_test (tc_chain, test_threads);
 
   return s;
 }
@@ -23,6 +23,7 @@
 #include <unistd.h>
 
 #include <gst/check/gstcheck.h>
+#include <gst/video/gstvideometa.h>
 
 /* For ease of programming we use globals to keep refs for our floating
  * src and sink pads we create; otherwise we always have to do get_pad,
@@ -60,6 +61,13 @@ static GstPad *mysrcpad, *mysinkpad;
     "framerate = (fraction) 999/7 , "	\
     "format = (string) I420"
 
+#define VIDEO_CAPS_SMALL_60FPS_STRING   \
+    "video/x-raw, "                 \
+    "width = (int) 64, "                \
+    "height = (int) 48, "               \
+    "framerate = (fraction) 60/1 , "    \
+    "format = (string) I420"
+
 static GstStaticPadTemplate sinktemplate = GST_STATIC_PAD_TEMPLATE ("sink",
     GST_PAD_SINK,
     GST_PAD_ALWAYS,
@@ -71,6 +79,12 @@ GST_STATIC_PAD_TEMPLATE ("sink",
     GST_PAD_ALWAYS,
     GST_STATIC_CAPS (VIDEO_CAPS_STRING)
     );
+static GstStaticPadTemplate fps15sinktemplate =
+GST_STATIC_PAD_TEMPLATE ("sink",
+    GST_PAD_SINK,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS ("video/x-raw, framerate = (fraction) 15/1")
+    );
 static GstStaticPadTemplate srctemplate = GST_STATIC_PAD_TEMPLATE ("src",
     GST_PAD_SRC,
     GST_PAD_ALWAYS,
@@ -1042,6 +1056,162 @@ GST_START_TEST (test_caps_negotiation)
 
 GST_END_TEST;
 
+/* the luma of frames at 60 frames/s, output at 15 frames/s */
+static const guint8 smart_drop_lumas[] = {
+  /* output at 0 */
+  16,
+  /* output at 1/15 s, with a scene cut at the second frame */
+  20, 120, 124, 128,
+  /* output at 2/15 s, the second frame differs most from the last output */
+  121, 126, 122, 121,
+  /* triggers the output at 2/15 s */
+  121
+};
+
+GST_START_TEST (test_smart_drop)
+{
+  static const guint8 nearest[] = { 16, 128, 121 };
+  static const guint8 distinct[] = { 16, 120, 126 };
+  gboolean smart_drop = (__i__ == 1);
+  GstElement *videorate;
+  GstBuffer *buf;
+  GstVideoSceneMeta *meta;
+  GstSegment segment;
+  GstCaps *caps;
+  GList *l;
+  guint i;
+
+  videorate = setup_videorate_full (&srctemplate, &fps15sinktemplate);
+  g_object_set (videorate, "smart-drop", smart_drop, NULL);
+  fail_unless (gst_element_set_state (videorate,
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_SUCCESS,
+      "could not set to playing");
+
+  gst_segment_init (&segment, GST_FORMAT_TIME);
+  fail_unless (gst_pad_push_event (mysrcpad, gst_event_new_segment (&segment)));
+  caps = gst_caps_from_string (VIDEO_CAPS_SMALL_60FPS_STRING);
+  gst_pad_set_caps (mysrcpad, caps);
+  gst_caps_unref (caps);
+
+  for (i = 0; i < G_N_ELEMENTS (smart_drop_lumas); i++) {
+    buf = gst_buffer_new_and_alloc (64 * 48 * 3 / 2);
+    gst_buffer_memset (buf, 0, smart_drop_lumas[i], 64 * 48);
+    gst_buffer_memset (buf, 64 * 48, 128, 64 * 48 / 2);
+    GST_BUFFER_TIMESTAMP (buf) = gst_util_uint64_scale (i, GST_SECOND, 60);
+    fail_unless (gst_pad_push (mysrcpad, buf) == GST_FLOW_OK);
+  }
+
+  /* the same frames are dropped, only which input frame is used differs */
+  assert_videorate_stats (videorate, "pushed", 10, 3, 6, 0);
+  fail_unless_equals_int (g_list_length (buffers), 3);
+
+  for (l = buffers, i = 0; l; l = l->next, i++) {
+    buf = l->data;
+    fail_unless_equals_uint64 (GST_BUFFER_TIMESTAMP (buf),
+        gst_util_uint64_scale (i, GST_SECOND, 15));
+    fail_unless_equals_int (buffer_get_byte (buf, 0),
+        smart_drop ? distinct[i] : nearest[i]);
+
+    meta = gst_buffer_get_video_scene_meta (buf);
+    if (!smart_drop) {
+      fail_unless (meta == NULL);
+      continue;
+    }
+
+    fail_unless (meta != NULL);
+    switch (i) {
+      case 0:
+        fail_unless (meta->difference == 0.0);
+        fail_unless (!meta->scene_change);
+        break;
+      case 1:
+        fail_unless (meta->difference == 104.0);
+        fail_unless (meta->histogram_distance == 1.0);
+        fail_unless (meta->scene_change);
+        break;
+      case 2:
+        fail_unless (meta->difference == 6.0);
+        fail_unless (meta->histogram_distance == 0.0);
+        fail_unless (!meta->scene_change);
+        break;
+    }
+  }
+
+  cleanup_videorate (videorate);
+}
+
+GST_END_TEST;
+
+/* the luma of frames at 60 frames/s, output at 15 frames/s, with a gap
+ * before the last frame */
+static const guint8 smart_drop_dup_lumas[] = {
+  /* output at 0 */
+  16,
+  /* output at 1/15 s, the first frame differs most from the last output,
+   * the last one is duplicated for 2/15 s */
+  22, 17, 18, 17,
+  /* at 3/15 s, triggers the output at 1/15 s and 2/15 s */
+  17
+};
+
+GST_START_TEST (test_smart_drop_duplicate)
+{
+  static const guint8 expected[] = { 16, 22, 17 };
+  static const gdouble differences[] = { 0.0, 6.0, 5.0 };
+  GstElement *videorate;
+  GstBuffer *buf;
+  GstVideoSceneMeta *meta;
+  GstSegment segment;
+  GstCaps *caps;
+  GList *l;
+  guint i, ts;
+
+  videorate = setup_videorate_full (&srctemplate, &fps15sinktemplate);
+  g_object_set (videorate, "smart-drop", TRUE, NULL);
+  fail_unless (gst_element_set_state (videorate,
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_SUCCESS,
+      "could not set to playing");
+
+  gst_segment_init (&segment, GST_FORMAT_TIME);
+  fail_unless (gst_pad_push_event (mysrcpad, gst_event_new_segment (&segment)));
+  caps = gst_caps_from_string (VIDEO_CAPS_SMALL_60FPS_STRING);
+  gst_pad_set_caps (mysrcpad, caps);
+  gst_caps_unref (caps);
+
+  for (i = 0; i < G_N_ELEMENTS (smart_drop_dup_lumas); i++) {
+    buf = gst_buffer_new_and_alloc (64 * 48 * 3 / 2);
+    gst_buffer_memset (buf, 0, smart_drop_dup_lumas[i], 64 * 48);
+    gst_buffer_memset (buf, 64 * 48, 128, 64 * 48 / 2);
+    ts = (i == G_N_ELEMENTS (smart_drop_dup_lumas) - 1) ? 12 : i;
+    GST_BUFFER_TIMESTAMP (buf) = gst_util_uint64_scale (ts, GST_SECOND, 60);
+    fail_unless (gst_pad_push (mysrcpad, buf) == GST_FLOW_OK);
+  }
+
+  assert_videorate_stats (videorate, "pushed", 6, 3, 3, 1);
+  fail_unless_equals_int (g_list_length (buffers), 3);
+
+  /* the duplicate is compared with the frame output before it, not with
+   * itself */
+  for (l = buffers, i = 0; l; l = l->next, i++) {
+    buf = l->data;
+    fail_unless_equals_int (buffer_get_byte (buf, 0), expected[i]);
+    fail_unless_equals_int (GST_BUFFER_FLAG_IS_SET (buf,
+            GST_BUFFER_FLAG_GAP), i == 2);
+
+    meta = gst_buffer_get_video_scene_meta (buf);
+    fail_unless (meta != NULL);
+    fail_unless (meta->difference == differences[i],
+        "frame %u: difference %f, expected %f", i, meta->difference,
+        differences[i]);
+    fail_unless (meta->histogram_distance == 0.0);
+    fail_unless (!meta->scene_change);
+  }
+
+  cleanup_videorate (videorate);
+}
+
+GST_END_TEST;
+
 static Suite *
 videorate_suite (void)
 {
@@ -1060,6 +1230,8 @@ videorate_suite (void)
   tcase_add_test (tc_chain, test_selected_caps);
   tcase_add_loop_test (tc_chain, test_caps_negotiation,
       0, G_N_ELEMENTS (caps_negotiation_tests));
+  tcase_add_loop_test (tc_chain, test_smart_drop, 0, 2);
+  tcase_add_test (tc_chain, test_smart_drop_duplicate);
 
   return s;
 }
@@ -963,6 +963,209 @@ GST_START_TEST (test_basetransform_negotiation)
 
 GST_END_TEST;
 
+static void
+on_sink_handoff_flat (GstElement * element, GstBuffer * buffer, GstPad * pad,
+    gpointer user_data)
+{
+  GstVideoInfo info;
+  GstVideoFrame frame;
+  GstCaps *caps;
+  guint8 *data;
+  gint x, y, pstride;
+
+  caps = gst_pad_get_current_caps (pad);
+  fail_unless (gst_video_info_from_caps (&info, caps));
+  gst_caps_unref (caps);
+
+  fail_unless (gst_video_frame_map (&frame, &info, buffer, GST_MAP_READ));
+  pstride = GST_VIDEO_FRAME_COMP_PSTRIDE (&frame, 0);
+  for (y = 0; y < GST_VIDEO_FRAME_HEIGHT (&frame); y++) {
+    data = GST_VIDEO_FRAME_COMP_DATA (&frame, 0);
+    data += y * GST_VIDEO_FRAME_COMP_STRIDE (&frame, 0);
+    for (x = 0; x < GST_VIDEO_FRAME_WIDTH (&frame); x++) {
+      /* white is luma 235, allow for the rounding of the integer taps */
+      fail_unless (data[x * pstride] >= 233 && data[x * pstride] <= 237,
+          "luma %d at %d,%d", data[x * pstride], x, y);
+    }
+  }
+  gst_video_frame_unmap (&frame);
+
+  (*(guint *) user_data)++;
+}
+
+/* a flat picture stays flat through the lanczos taps, for the planar and
+ * the packed paths, on the first frame that calculates the taps and on the
+ * next ones that take them from the cache */
+GST_START_TEST (test_lanczos_flat)
+{
+  static const gchar *formats[] = { "I420", "AYUV" };
+  GstElement *pipeline, *sink;
+  GstMessage *msg;
+  gchar *desc;
+  guint i, n_buffers;
+
+  for (i = 0; i < G_N_ELEMENTS (formats); i++) {
+    desc = g_strdup_printf ("videotestsrc pattern=white num-buffers=3 ! "
+        "video/x-raw,format=%s,width=173,height=97 ! "
+        "videoscale method=lanczos ! video/x-raw,width=64,height=240 ! "
+        "fakesink name=sink signal-handoffs=true", formats[i]);
+    pipeline = gst_parse_launch (desc, NULL);
+    fail_unless (pipeline != NULL);
+    g_free (desc);
+
+    n_buffers = 0;
+    sink = gst_bin_get_by_name (GST_BIN (pipeline), "sink");
+    g_signal_connect (sink, "handoff", G_CALLBACK (on_sink_handoff_flat),
+        &n_buffers);
+    gst_object_unref (sink);
+
+    fail_unless (gst_element_set_state (pipeline,
+            GST_STATE_PLAYING) != GST_STATE_CHANGE_FAILURE);
+    msg = gst_bus_timed_pop_filtered (GST_ELEMENT_BUS (pipeline), -1,
+        GST_MESSAGE_EOS | GST_MESSAGE_ERROR);
+    fail_unless_equals_int (GST_MESSAGE_TYPE (msg), GST_MESSAGE_EOS);
+    gst_message_unref (msg);
+
+    fail_unless_equals_int (n_buffers, 3);
+
+    gst_element_set_state (pipeline, GST_STATE_NULL);
+    gst_object_unref (pipeline);
+  }
+}
+
+GST_END_TEST;
+
+static void
+on_sink_handoff_collect (GstElement * element, GstBuffer * buffer,
+    GstPad * pad, gpointer user_data)
+{
+  GList **buffers = user_data;
+
+  *buffers = g_list_append (*buffers, gst_buffer_ref (buffer));
+}
+
+static GList *
+run_lanczos (GstVideoFormat format, const gchar * pattern, gint submethod,
+    gint width, gint height, gint dest_height)
+{
+  GstElement *pipeline, *sink;
+  GstMessage *msg;
+  GList *buffers = NULL;
+  gchar *desc;
+
+  desc = g_strdup_printf ("videotestsrc pattern=%s num-buffers=2 ! "
+      "video/x-raw,format=%s,width=%d,height=%d ! "
+      "videoscale method=lanczos submethod=%d ! "
+      "video/x-raw,width=%d,height=%d ! "
+      "fakesink name=sink signal-handoffs=true", pattern,
+      gst_video_format_to_string (format), width, height, submethod, width,
+      dest_height);
+  pipeline = gst_parse_launch (desc, NULL);
+  fail_unless (pipeline != NULL);
+  g_free (desc);
+
+  sink = gst_bin_get_by_name (GST_BIN (pipeline), "sink");
+  g_signal_connect (sink, "handoff", G_CALLBACK (on_sink_handoff_collect),
+      &buffers);
+  gst_object_unref (sink);
+
+  fail_unless (gst_element_set_state (pipeline,
+          GST_STATE_PLAYING) != GST_STATE_CHANGE_FAILURE);
+  msg = gst_bus_timed_pop_filtered (GST_ELEMENT_BUS (pipeline), -1,
+      GST_MESSAGE_EOS | GST_MESSAGE_ERROR);
+  fail_unless_equals_int (GST_MESSAGE_TYPE (msg), GST_MESSAGE_EOS);
+  gst_message_unref (msg);
+
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+  gst_object_unref (pipeline);
+
+  fail_unless_equals_int (g_list_length (buffers), 2);
+
+  return buffers;
+}
+
+/* the 16 and 32 bit integer taps (submethods 0 and 1, 1 is the default)
+ * run the vertical pass with Orc, compare them to the double precision C
+ * path (submethod 3) on patterns with edges.  Only the height changes so
+ * that the horizontal pass is an identity and all the filtering happens in
+ * the vertical pass.  The 7 bit taps are off by at most a few levels, a
+ * wrong tap or line in the kernels is off by a lot more. */
+GST_START_TEST (test_lanczos_orc)
+{
+  gint submethod = __i__;
+  static const GstVideoFormat formats[] = {
+    GST_VIDEO_FORMAT_I420, GST_VIDEO_FORMAT_AYUV
+  };
+  static const gchar *patterns[] = { "checkers-8", "zone-plate" };
+  static const gint dest_heights[] = { 240, 41 };
+  guint f, p, d;
+
+  for (f = 0; f < G_N_ELEMENTS (formats); f++) {
+    for (p = 0; p < G_N_ELEMENTS (patterns); p++) {
+      for (d = 0; d < G_N_ELEMENTS (dest_heights); d++) {
+        GList *orc, *ref, *l1, *l2;
+        GstVideoInfo info;
+
+        orc = run_lanczos (formats[f], patterns[p], submethod, 173, 97,
+            dest_heights[d]);
+        ref = run_lanczos (formats[f], patterns[p], 3, 173, 97,
+            dest_heights[d]);
+        gst_video_info_set_format (&info, formats[f], 173, dest_heights[d]);
+
+        for (l1 = orc, l2 = ref; l1 && l2; l1 = l1->next, l2 = l2->next) {
+          GstVideoFrame frame1, frame2;
+          gdouble sse = 0, mse;
+          guint n = 0;
+          gint c, x, y, diff, max_diff = 0;
+
+          fail_unless (gst_video_frame_map (&frame1, &info, l1->data,
+                  GST_MAP_READ));
+          fail_unless (gst_video_frame_map (&frame2, &info, l2->data,
+                  GST_MAP_READ));
+
+          for (c = 0; c < GST_VIDEO_FRAME_N_COMPONENTS (&frame1); c++) {
+            for (y = 0; y < GST_VIDEO_FRAME_COMP_HEIGHT (&frame1, c); y++) {
+              guint8 *data1, *data2;
+              gint pstride = GST_VIDEO_FRAME_COMP_PSTRIDE (&frame1, c);
+
+              data1 = GST_VIDEO_FRAME_COMP_DATA (&frame1, c);
+              data1 += y * GST_VIDEO_FRAME_COMP_STRIDE (&frame1, c);
+              data2 = GST_VIDEO_FRAME_COMP_DATA (&frame2, c);
+              data2 += y * GST_VIDEO_FRAME_COMP_STRIDE (&frame2, c);
+
+              for (x = 0; x < GST_VIDEO_FRAME_COMP_WIDTH (&frame1, c); x++) {
+                diff = data1[x * pstride] - data2[x * pstride];
+                max_diff = MAX (max_diff, ABS (diff));
+                sse += diff * diff;
+                n++;
+              }
+            }
+          }
+          gst_video_frame_unmap (&frame1);
+          gst_video_frame_unmap (&frame2);
+
+          /* 6.5 is a PSNR of 40 dB */
+          mse = sse / n;
+          GST_DEBUG ("submethod %d, %s %s 173x%d: max diff %d, MSE %.3f",
+              submethod, gst_video_format_to_string (formats[f]),
+              patterns[p], dest_heights[d], max_diff, mse);
+          fail_unless (max_diff <= 4, "submethod %d, %s %s 173x%d: "
+              "max diff %d", submethod, gst_video_format_to_string (formats[f]),
+              patterns[p], dest_heights[d], max_diff);
+          fail_unless (mse <= 6.5, "submethod %d, %s %s 173x%d: MSE %.3f",
+              submethod, gst_video_format_to_string (formats[f]),
+              patterns[p], dest_heights[d], mse);
+        }
+
+        g_list_free_full (orc, (GDestroyNotify) gst_buffer_unref);
+        g_list_free_full (ref, (GDestroyNotify) gst_buffer_unref);
+      }
+    }
+  }
+}
+
+GST_END_TEST;
+
 static Suite *
 videoscale_suite (void)
 {
@@ -1029,6 +1232,8 @@ videoscale_suite (void)
   tcase_add_test (tc_chain, test_reverse_negotiation);
 #endif
   tcase_add_test (tc_chain, test_basetransform_negotiation);
+  tcase_add_test (tc_chain, test_lanczos_flat);
+  tcase_add_loop_test (tc_chain, test_lanczos_orc, 0, 2);
 
   return s;
 }
@@ -25,7 +25,9 @@
 #include <gst/check/gstcheck.h>
 
 #include <gst/rtsp/gstrtspurl.h>
+#include <gst/rtsp/gstrtspconnection.h>
 #include <string.h>
+#include <sys/socket.h>
 
 GST_START_TEST (test_rtsp_url_basic)
 {
@@ -120,6 +122,325 @@ GST_START_TEST (test_rtsp_url_components_3)
 
 GST_END_TEST;
 
+static const gchar *setup_request =
+    "SETUP rtsp://example.com/test/stream=0 RTSP/1.0\r\n"
+    "CSeq: 3\r\n"
+    "Transport: RTP/AVP/TCP;unicast;interleaved=0-1\r\n"
+    "Content-Length: 4\r\n" "\r\n" "abcd";
+
+static const gchar *play_request =
+    "PLAY rtsp://example.com/test RTSP/1.0\r\n"
+    "CSeq: 4\r\n" "Session: 12345678\r\n" "\r\n";
+
+/* a connected pair of sockets, the first one wrapped in a connection */
+static GstRTSPConnection *
+create_connection (GSocket ** peer)
+{
+  GstRTSPConnection *conn;
+  GSocket *socket;
+  GError *err = NULL;
+  int fds[2];
+
+  fail_unless (socketpair (AF_UNIX, SOCK_STREAM, 0, fds) == 0);
+
+  socket = g_socket_new_from_fd (fds[0], &err);
+  fail_unless (socket != NULL);
+  *peer = g_socket_new_from_fd (fds[1], &err);
+  fail_unless (*peer != NULL);
+
+  fail_unless (gst_rtsp_connection_create_from_socket (socket, "127.0.0.1", 0,
+          NULL, &conn) == GST_RTSP_OK);
+  g_object_unref (socket);
+
+  return conn;
+}
+
+static void
+send_data (GSocket * socket, const gchar * data, gsize size)
+{
+  fail_unless (g_socket_send (socket, data, size, NULL, NULL) == size);
+}
+
+typedef struct
+{
+  GMutex lock;
+  GCond cond;
+  guint n_messages;
+  GstRTSPMethod methods[4];
+  gchar *bodies[4];
+} ReceivedMessages;
+
+static GstRTSPResult
+message_received (GstRTSPWatch * watch, GstRTSPMessage * message,
+    gpointer user_data)
+{
+  ReceivedMessages *received = user_data;
+  guint8 *data;
+  guint size;
+
+  gst_rtsp_message_get_body (message, &data, &size);
+
+  g_mutex_lock (&received->lock);
+  if (received->n_messages < G_N_ELEMENTS (received->methods)) {
+    received->methods[received->n_messages] =
+        message->type_data.request.method;
+    received->bodies[received->n_messages] = g_strndup ((gchar *) data, size);
+  }
+  received->n_messages++;
+  g_cond_signal (&received->cond);
+  g_mutex_unlock (&received->lock);
+
+  return GST_RTSP_OK;
+}
+
+static void
+received_messages_clear (ReceivedMessages * received)
+{
+  guint i;
+
+  for (i = 0; i < G_N_ELEMENTS (received->bodies); i++)
+    g_free (received->bodies[i]);
+}
+
+GST_START_TEST (test_rtsp_connection_receive)
+{
+  GstRTSPConnection *conn;
+  GstRTSPMessage *msg;
+  GSocket *peer;
+  GString *str;
+  gchar *value;
+  guint8 *data;
+  guint size;
+
+  conn = create_connection (&peer);
+
+  /* two requests in one write, the second is parsed from what was received
+   * along with the first one */
+  str = g_string_new (setup_request);
+  g_string_append (str, play_request);
+  send_data (peer, str->str, str->len);
+  g_string_free (str, TRUE);
+
+  gst_rtsp_message_new (&msg);
+  fail_unless (gst_rtsp_connection_receive (conn, msg, NULL) == GST_RTSP_OK);
+  fail_unless_equals_int (msg->type_data.request.method, GST_RTSP_SETUP);
+  fail_unless_equals_string (msg->type_data.request.uri,
+      "rtsp://example.com/test/stream=0");
+  fail_unless (gst_rtsp_message_get_header (msg, GST_RTSP_HDR_TRANSPORT,
+          &value, 0) == GST_RTSP_OK);
+  fail_unless_equals_string (value,
+      "RTP/AVP/TCP;unicast;interleaved=0-1");
+  gst_rtsp_message_get_body (msg, &data, &size);
+  fail_unless_equals_int (size, 4);
+  fail_unless (memcmp (data, "abcd", 4) == 0);
+  gst_rtsp_message_unset (msg);
+
+  fail_unless (gst_rtsp_connection_receive (conn, msg, NULL) == GST_RTSP_OK);
+  fail_unless_equals_int (msg->type_data.request.method, GST_RTSP_PLAY);
+  fail_unless (gst_rtsp_message_get_header (msg, GST_RTSP_HDR_SESSION,
+          &value, 0) == GST_RTSP_OK);
+  fail_unless_equals_string (value, "12345678");
+  gst_rtsp_message_unset (msg);
+
+  /* interleaved data */
+  send_data (peer, "$\001\000\003xyz", 7);
+  fail_unless (gst_rtsp_connection_receive (conn, msg, NULL) == GST_RTSP_OK);
+  fail_unless_equals_int (msg->type, GST_RTSP_MESSAGE_DATA);
+  fail_unless_equals_int (msg->type_data.data.channel, 1);
+  gst_rtsp_message_get_body (msg, &data, &size);
+  fail_unless_equals_int (size, 3);
+  fail_unless (memcmp (data, "xyz", 3) == 0);
+  gst_rtsp_message_free (msg);
+
+  g_object_unref (peer);
+  gst_rtsp_connection_free (conn);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_rtsp_connection_receive_data)
+{
+  GstRTSPConnection *conn;
+  GstRTSPMessage *msg;
+  GstBuffer *buf1, *buf2, *buf;
+  GSocket *peer;
+  GString *str;
+  GTimeVal timeout = { 0, 100000 };
+  guint8 channel;
+
+  conn = create_connection (&peer);
+
+  /* two data messages followed by a request in one write */
+  str = g_string_new_len ("$\000\000\003abc$\001\000\004defg", 15);
+  g_string_append (str, play_request);
+  send_data (peer, str->str, str->len);
+  g_string_free (str, TRUE);
+
+  fail_unless (gst_rtsp_connection_receive_data (conn, &channel, &buf1,
+          NULL) == GST_RTSP_OK);
+  fail_unless (buf1 != NULL);
+  fail_unless_equals_int (channel, 0);
+  fail_unless_equals_int (gst_buffer_get_size (buf1), 3);
+  fail_unless (gst_buffer_memcmp (buf1, 0, "abc", 3) == 0);
+
+  fail_unless (gst_rtsp_connection_receive_data (conn, &channel, &buf2,
+          NULL) == GST_RTSP_OK);
+  fail_unless (buf2 != NULL);
+  fail_unless_equals_int (channel, 1);
+  fail_unless_equals_int (gst_buffer_get_size (buf2), 4);
+  fail_unless (gst_buffer_memcmp (buf2, 0, "defg", 4) == 0);
+
+  /* both were received in the same memory and were not copied */
+  fail_unless (gst_buffer_peek_memory (buf1, 0)->parent != NULL);
+  fail_unless (gst_buffer_peek_memory (buf1, 0)->parent ==
+      gst_buffer_peek_memory (buf2, 0)->parent);
+
+  /* the request is left for gst_rtsp_connection_receive() */
+  fail_unless (gst_rtsp_connection_receive_data (conn, &channel, &buf,
+          NULL) == GST_RTSP_OK);
+  fail_unless (buf == NULL);
+  gst_rtsp_message_new (&msg);
+  fail_unless (gst_rtsp_connection_receive (conn, msg, NULL) == GST_RTSP_OK);
+  fail_unless_equals_int (msg->type_data.request.method, GST_RTSP_PLAY);
+  gst_rtsp_message_free (msg);
+
+  /* a data message split over two writes, the first part is kept while
+   * waiting for the rest */
+  send_data (peer, "$\002\000\005he", 6);
+  fail_unless (gst_rtsp_connection_receive_data (conn, &channel, &buf,
+          &timeout) == GST_RTSP_ETIMEOUT);
+  fail_unless (buf == NULL);
+  send_data (peer, "llo", 3);
+  fail_unless (gst_rtsp_connection_receive_data (conn, &channel, &buf,
+          NULL) == GST_RTSP_OK);
+  fail_unless (buf != NULL);
+  fail_unless_equals_int (channel, 2);
+  fail_unless_equals_int (gst_buffer_get_size (buf), 5);
+  fail_unless (gst_buffer_memcmp (buf, 0, "hello", 5) == 0);
+
+  /* the received data stays valid after the connection is gone */
+  g_object_unref (peer);
+  gst_rtsp_connection_free (conn);
+
+  fail_unless (gst_buffer_memcmp (buf1, 0, "abc", 3) == 0);
+  fail_unless (gst_buffer_memcmp (buf2, 0, "defg", 4) == 0);
+  gst_buffer_unref (buf1);
+  gst_buffer_unref (buf2);
+  gst_buffer_unref (buf);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_rtsp_watch_partial)
+{
+  GstRTSPWatchFuncs funcs = { NULL, };
+  ReceivedMessages received = { {0,}, };
+  GstRTSPConnection *conn;
+  GstRTSPWatch *watch;
+  GMainContext *context;
+  GSocket *peer;
+  gsize len, i;
+
+  funcs.message_received = message_received;
+  g_mutex_init (&received.lock);
+  g_cond_init (&received.cond);
+
+  conn = create_connection (&peer);
+  context = g_main_context_new ();
+  watch = gst_rtsp_watch_new (conn, &funcs, &received, NULL);
+  gst_rtsp_watch_attach (watch, context);
+
+  /* deliver the requests in small chunks, splitting the lines and line
+   * endings at every possible place */
+  len = strlen (setup_request);
+  for (i = 0; i < len; i += 3) {
+    send_data (peer, setup_request + i, MIN (3, len - i));
+    while (g_main_context_iteration (context, FALSE));
+  }
+  fail_unless_equals_int (received.n_messages, 1);
+  fail_unless_equals_int (received.methods[0], GST_RTSP_SETUP);
+  fail_unless_equals_string (received.bodies[0], "abcd");
+
+  len = strlen (play_request);
+  for (i = 0; i < len; i++) {
+    send_data (peer, play_request + i, 1);
+    while (g_main_context_iteration (context, FALSE));
+  }
+  fail_unless_equals_int (received.n_messages, 2);
+  fail_unless_equals_int (received.methods[1], GST_RTSP_PLAY);
+
+  g_source_destroy ((GSource *) watch);
+  gst_rtsp_watch_unref (watch);
+  g_main_context_unref (context);
+  received_messages_clear (&received);
+  g_cond_clear (&received.cond);
+  g_mutex_clear (&received.lock);
+  g_object_unref (peer);
+  gst_rtsp_connection_free (conn);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_rtsp_watch_pool)
+{
+  GstRTSPWatchFuncs funcs = { NULL, };
+  ReceivedMessages received = { {0,}, };
+  GstRTSPConnection *conns[4];
+  GstRTSPWatchPool *pool;
+  GSocket *peers[4];
+  guint i;
+
+  funcs.message_received = message_received;
+  g_mutex_init (&received.lock);
+  g_cond_init (&received.cond);
+
+  pool = gst_rtsp_watch_pool_new (2);
+  for (i = 0; i < G_N_ELEMENTS (conns); i++) {
+    GstRTSPWatch *watch;
+
+    conns[i] = create_connection (&peers[i]);
+    watch = gst_rtsp_watch_new (conns[i], &funcs, &received, NULL);
+    fail_unless (gst_rtsp_watch_pool_attach (pool, watch) > 0);
+    gst_rtsp_watch_unref (watch);
+  }
+
+  for (i = 0; i < G_N_ELEMENTS (conns); i++)
+    send_data (peers[i], play_request, strlen (play_request));
+
+  g_mutex_lock (&received.lock);
+  while (received.n_messages < G_N_ELEMENTS (conns))
+    g_cond_wait (&received.cond, &received.lock);
+  g_mutex_unlock (&received.lock);
+
+  for (i = 0; i < G_N_ELEMENTS (conns); i++)
+    fail_unless_equals_int (received.methods[i], GST_RTSP_PLAY);
+
+  /* destroys the watches */
+  gst_rtsp_watch_pool_free (pool);
+
+  for (i = 0; i < G_N_ELEMENTS (conns); i++) {
+    g_object_unref (peers[i]);
+    gst_rtsp_connection_free (conns[i]);
+  }
+  received_messages_clear (&received);
+  g_cond_clear (&received.cond);
+  g_mutex_clear (&received.lock);
+}
+
+GST_END_TEST;
+
+/* freeing a pool right away must not wait for threads that did not start
+ * their loop yet */
+GST_START_TEST (test_rtsp_watch_pool_free_early)
+{
+  guint i;
+
+  for (i = 0; i < 100; i++)
+    gst_rtsp_watch_pool_free (gst_rtsp_watch_pool_new (4));
+}
+
+GST_END_TEST;
+
 static Suite *
 rtsp_suite (void)
 {
@@ -131,6 +452,11 @@ rtsp_suite (void)
   tcase_add_test (tc_chain, test_rtsp_url_components_1);
   tcase_add_test (tc_chain, test_rtsp_url_components_2);
   tcase_add_test (tc_chain, test_rtsp_url_components_3);
+  tcase_add_test (tc_chain, test_rtsp_connection_receive);
+  tcase_add_test (tc_chain, test_rtsp_connection_receive_data);
+  tcase_add_test (tc_chain, test_rtsp_watch_partial);
+  tcase_add_test (tc_chain, test_rtsp_watch_pool);
+  tcase_add_test (tc_chain, test_rtsp_watch_pool_free_early);
 
   return s;
 }
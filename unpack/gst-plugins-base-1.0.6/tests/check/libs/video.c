@@ -36,6 +36,8 @@
 #include <gst/video/video.h>
 #include <gst/video/gstvideometa.h>
 #include <gst/video/video-overlay-composition.h>
+#include <gst/video/video-converter.h>
+#include <gst/video/gstvideopool.h>
 #include <string.h>
 
 /* These are from the current/old videotestsrc; we check our new public API
@@ -866,6 +868,185 @@ GST_START_TEST (test_video_size_from_caps)
 
 GST_END_TEST;
 
+GST_START_TEST (test_video_converter)
+{
+  GstVideoInfo ayuv, i420, big;
+  GstVideoConverter *convert;
+  GstVideoFrame src, dest;
+  GstBuffer *sbuf, *dbuf;
+  guint8 *s, *d;
+  gint x, y;
+
+  gst_video_info_init (&ayuv);
+  gst_video_info_set_format (&ayuv, GST_VIDEO_FORMAT_AYUV, 37, 23);
+  gst_video_info_init (&i420);
+  gst_video_info_set_format (&i420, GST_VIDEO_FORMAT_I420, 37, 23);
+  gst_video_info_init (&big);
+  gst_video_info_set_format (&big, GST_VIDEO_FORMAT_AYUV, 80, 61);
+
+  sbuf = gst_buffer_new_and_alloc (ayuv.size);
+  fail_unless (gst_video_frame_map (&src, &ayuv, sbuf, GST_MAP_WRITE));
+  for (y = 0; y < 23; y++) {
+    s = GST_VIDEO_FRAME_PLANE_DATA (&src, 0);
+    s += y * GST_VIDEO_FRAME_PLANE_STRIDE (&src, 0);
+    for (x = 0; x < 37; x++) {
+      s[4 * x + 0] = 0xff;
+      s[4 * x + 1] = 16 + (x * 7 + y * 13) % 220;
+      s[4 * x + 2] = 128;
+      s[4 * x + 3] = 128;
+    }
+  }
+  gst_video_frame_unmap (&src);
+
+  /* same size, nearest: the luma comes out unchanged */
+  convert = gst_video_converter_new (&ayuv, &i420, GST_VIDEO_RESAMPLE_NEAREST);
+  fail_unless (convert != NULL);
+  dbuf = gst_buffer_new_and_alloc (i420.size);
+  fail_unless (gst_video_frame_map (&src, &ayuv, sbuf, GST_MAP_READ));
+  fail_unless (gst_video_frame_map (&dest, &i420, dbuf, GST_MAP_WRITE));
+  gst_video_converter_frame (convert, &src, &dest);
+  for (y = 0; y < 23; y++) {
+    s = GST_VIDEO_FRAME_PLANE_DATA (&src, 0);
+    s += y * GST_VIDEO_FRAME_PLANE_STRIDE (&src, 0);
+    d = GST_VIDEO_FRAME_COMP_DATA (&dest, 0);
+    d += y * GST_VIDEO_FRAME_COMP_STRIDE (&dest, 0);
+    for (x = 0; x < 37; x++)
+      fail_unless_equals_int (d[x], s[4 * x + 1]);
+  }
+  for (y = 0; y < 12; y++) {
+    d = GST_VIDEO_FRAME_COMP_DATA (&dest, 1);
+    d += y * GST_VIDEO_FRAME_COMP_STRIDE (&dest, 1);
+    for (x = 0; x < 19; x++)
+      fail_unless_equals_int (d[x], 128);
+  }
+  gst_video_frame_unmap (&dest);
+  gst_video_frame_unmap (&src);
+  gst_buffer_unref (dbuf);
+  gst_video_converter_free (convert);
+
+  /* a solid color stays solid when scaled up */
+  fail_unless (gst_video_frame_map (&src, &ayuv, sbuf, GST_MAP_WRITE));
+  s = GST_VIDEO_FRAME_PLANE_DATA (&src, 0);
+  for (y = 0; y < 23; y++)
+    for (x = 0; x < 37; x++) {
+      d = s + y * GST_VIDEO_FRAME_PLANE_STRIDE (&src, 0) + 4 * x;
+      d[0] = 0xff;
+      d[1] = 81;
+      d[2] = 90;
+      d[3] = 240;
+    }
+  gst_video_frame_unmap (&src);
+
+  convert = gst_video_converter_new (&ayuv, &big, GST_VIDEO_RESAMPLE_LINEAR);
+  fail_unless (convert != NULL);
+  dbuf = gst_buffer_new_and_alloc (big.size);
+  fail_unless (gst_video_frame_map (&src, &ayuv, sbuf, GST_MAP_READ));
+  fail_unless (gst_video_frame_map (&dest, &big, dbuf, GST_MAP_WRITE));
+  gst_video_converter_frame (convert, &src, &dest);
+  for (y = 0; y < 61; y++) {
+    d = GST_VIDEO_FRAME_PLANE_DATA (&dest, 0);
+    d += y * GST_VIDEO_FRAME_PLANE_STRIDE (&dest, 0);
+    for (x = 0; x < 80; x++) {
+      fail_unless_equals_int (d[4 * x + 0], 0xff);
+      fail_unless_equals_int (d[4 * x + 1], 81);
+      fail_unless_equals_int (d[4 * x + 2], 90);
+      fail_unless_equals_int (d[4 * x + 3], 240);
+    }
+  }
+  gst_video_frame_unmap (&dest);
+  gst_video_frame_unmap (&src);
+  gst_buffer_unref (dbuf);
+  gst_video_converter_free (convert);
+
+  gst_buffer_unref (sbuf);
+}
+
+GST_END_TEST;
+
+/* source position of output pixel @i when scaling @in_size to @out_size,
+ * with the centers of the first and last pixels aligned */
+static gdouble
+scaled_position (gint i, gint in_size, gint out_size)
+{
+  gdouble pos = (i + 0.5) * in_size / out_size - 0.5;
+
+  return CLAMP (pos, 0, in_size - 1);
+}
+
+static void
+check_linear_scale (gint out_width, gint out_height)
+{
+  GstVideoInfo in_info, out_info;
+  GstVideoConverter *convert;
+  GstVideoFrame src, dest;
+  GstBuffer *sbuf, *dbuf;
+  guint8 *p;
+  gint x, y;
+
+  gst_video_info_init (&in_info);
+  gst_video_info_set_format (&in_info, GST_VIDEO_FORMAT_AYUV, 37, 23);
+  gst_video_info_init (&out_info);
+  gst_video_info_set_format (&out_info, GST_VIDEO_FORMAT_AYUV, out_width,
+      out_height);
+
+  /* ramps in both directions, bilinear interpolation reproduces them */
+  sbuf = gst_buffer_new_and_alloc (in_info.size);
+  fail_unless (gst_video_frame_map (&src, &in_info, sbuf, GST_MAP_WRITE));
+  for (y = 0; y < 23; y++) {
+    p = GST_VIDEO_FRAME_PLANE_DATA (&src, 0);
+    p += y * GST_VIDEO_FRAME_PLANE_STRIDE (&src, 0);
+    for (x = 0; x < 37; x++) {
+      p[4 * x + 0] = 0xff;
+      p[4 * x + 1] = 16 + 4 * x + 3 * y;
+      p[4 * x + 2] = 100 + 2 * x;
+      p[4 * x + 3] = 200 - 3 * y;
+    }
+  }
+  gst_video_frame_unmap (&src);
+
+  convert = gst_video_converter_new (&in_info, &out_info,
+      GST_VIDEO_RESAMPLE_LINEAR);
+  fail_unless (convert != NULL);
+  dbuf = gst_buffer_new_and_alloc (out_info.size);
+  fail_unless (gst_video_frame_map (&src, &in_info, sbuf, GST_MAP_READ));
+  fail_unless (gst_video_frame_map (&dest, &out_info, dbuf, GST_MAP_WRITE));
+  gst_video_converter_frame (convert, &src, &dest);
+
+  for (y = 0; y < out_height; y++) {
+    gdouble sy = scaled_position (y, 23, out_height);
+
+    p = GST_VIDEO_FRAME_PLANE_DATA (&dest, 0);
+    p += y * GST_VIDEO_FRAME_PLANE_STRIDE (&dest, 0);
+    for (x = 0; x < out_width; x++) {
+      gdouble sx = scaled_position (x, 37, out_width);
+
+      /* the weights have 8 bits and each pass rounds */
+      fail_unless_equals_int (p[4 * x + 0], 0xff);
+      fail_unless (ABS (p[4 * x + 1] - (16 + 4 * sx + 3 * sy)) <= 1.0,
+          "Y at %d,%d is %d, expected %f", x, y, p[4 * x + 1],
+          16 + 4 * sx + 3 * sy);
+      fail_unless (ABS (p[4 * x + 2] - (100 + 2 * sx)) <= 1.0,
+          "U at %d,%d is %d, expected %f", x, y, p[4 * x + 2], 100 + 2 * sx);
+      fail_unless (ABS (p[4 * x + 3] - (200 - 3 * sy)) <= 1.0,
+          "V at %d,%d is %d, expected %f", x, y, p[4 * x + 3], 200 - 3 * sy);
+    }
+  }
+  gst_video_frame_unmap (&dest);
+  gst_video_frame_unmap (&src);
+  gst_buffer_unref (dbuf);
+  gst_buffer_unref (sbuf);
+  gst_video_converter_free (convert);
+}
+
+GST_START_TEST (test_video_converter_linear)
+{
+  check_linear_scale (80, 61);
+  check_linear_scale (20, 13);
+  check_linear_scale (37, 50);
+}
+
+GST_END_TEST;
+
 GST_START_TEST (test_overlay_composition)
 {
   GstVideoOverlayComposition *comp1, *comp2;
@@ -1582,6 +1763,193 @@ GST_START_TEST (test_overlay_composition_global_alpha)
 
 GST_END_TEST;
 
+static GstBuffer *
+blend_composition (GstVideoOverlayComposition * comp, GstVideoInfo * info)
+{
+  GstVideoFrame frame;
+  GstBuffer *buf;
+
+  buf = gst_buffer_new_and_alloc (GST_VIDEO_INFO_SIZE (info));
+  gst_buffer_memset (buf, 0, 0x10, GST_VIDEO_INFO_SIZE (info));
+  fail_unless (gst_video_frame_map (&frame, info, buf, GST_MAP_READWRITE));
+  fail_unless (gst_video_overlay_composition_blend (comp, &frame));
+  gst_video_frame_unmap (&frame);
+
+  return buf;
+}
+
+static void
+pixels_freed (gpointer data, GstMiniObject * obj)
+{
+  *(gboolean *) data = TRUE;
+}
+
+GST_START_TEST (test_overlay_composition_cache)
+{
+  GstVideoOverlayComposition *comp;
+  GstVideoOverlayRectangle *rect1;
+  GstBuffer *pix1, *pix2, *pix3, *video1, *video2;
+  GstVideoInfo info;
+  GstMapInfo map;
+  gboolean freed = FALSE;
+  guint i;
+
+  pix1 = gst_buffer_new_and_alloc (200 * sizeof (guint32) * 50);
+  gst_buffer_memset (pix1, 0, 0x80, gst_buffer_get_size (pix1));
+
+  gst_buffer_add_video_meta (pix1, GST_VIDEO_FRAME_FLAG_NONE,
+      GST_VIDEO_OVERLAY_COMPOSITION_FORMAT_RGB, 200, 50);
+  rect1 = gst_video_overlay_rectangle_new_raw (pix1,
+      20, 10, 300, 75, GST_VIDEO_OVERLAY_FORMAT_FLAG_NONE);
+  gst_buffer_unref (pix1);
+
+  /* blending scales the pixels once and then uses the cached ones */
+  gst_video_info_init (&info);
+  gst_video_info_set_format (&info, GST_VIDEO_FORMAT_I420, 640, 480);
+  comp = gst_video_overlay_composition_new (rect1);
+
+  video1 = blend_composition (comp, &info);
+  pix2 = gst_video_overlay_rectangle_get_pixels_raw (rect1,
+      GST_VIDEO_OVERLAY_FORMAT_FLAG_NONE);
+  video2 = blend_composition (comp, &info);
+  pix3 = gst_video_overlay_rectangle_get_pixels_raw (rect1,
+      GST_VIDEO_OVERLAY_FORMAT_FLAG_NONE);
+  fail_unless (pix2 == pix3);
+
+  gst_buffer_map (video1, &map, GST_MAP_READ);
+  fail_unless (gst_buffer_memcmp (video2, 0, map.data, map.size) == 0);
+  gst_buffer_unmap (video1, &map);
+  gst_buffer_unref (video1);
+  gst_buffer_unref (video2);
+
+  /* the returned pixels are not a reference, they stay until the rectangle
+   * is freed however many other sizes are blended and returned after them,
+   * also beyond the memory limit */
+  gst_mini_object_weak_ref (GST_MINI_OBJECT (pix2), pixels_freed, &freed);
+  for (i = 1; i <= 8; i++) {
+    gst_video_overlay_rectangle_set_render_rectangle (rect1, 20, 10, 200 + i,
+        50);
+    video1 = blend_composition (comp, &info);
+    gst_buffer_unref (video1);
+    pix3 = gst_video_overlay_rectangle_get_pixels_raw (rect1,
+        GST_VIDEO_OVERLAY_FORMAT_FLAG_NONE);
+  }
+  gst_video_overlay_rectangle_set_render_rectangle (rect1, 0, 0, 2100, 2100);
+  video1 = blend_composition (comp, &info);
+  gst_buffer_unref (video1);
+  gst_video_overlay_rectangle_get_pixels_raw (rect1,
+      GST_VIDEO_OVERLAY_FORMAT_FLAG_NONE);
+  fail_if (freed);
+
+  gst_video_overlay_rectangle_set_render_rectangle (rect1, 20, 10, 208, 50);
+  fail_unless (gst_video_overlay_rectangle_get_pixels_raw (rect1,
+          GST_VIDEO_OVERLAY_FORMAT_FLAG_NONE) == pix3);
+  gst_video_overlay_rectangle_set_render_rectangle (rect1, 20, 10, 300, 75);
+  fail_unless (gst_video_overlay_rectangle_get_pixels_raw (rect1,
+          GST_VIDEO_OVERLAY_FORMAT_FLAG_NONE) == pix2);
+
+  gst_video_overlay_composition_unref (comp);
+  gst_video_overlay_rectangle_unref (rect1);
+  fail_unless (freed);
+}
+
+GST_END_TEST;
+
+static GstBufferPool *
+make_video_pool (gint width, gint height, guint n_buffers)
+{
+  GstBufferPool *pool;
+  GstStructure *config;
+  GstVideoInfo info;
+  GstCaps *caps;
+
+  gst_video_info_init (&info);
+  gst_video_info_set_format (&info, GST_VIDEO_FORMAT_I420, width, height);
+  caps = gst_video_info_to_caps (&info);
+
+  pool = gst_video_buffer_pool_new ();
+  config = gst_buffer_pool_get_config (pool);
+  gst_buffer_pool_config_set_params (config, caps, info.size, n_buffers, 0);
+  fail_unless (gst_buffer_pool_set_config (pool, config));
+  fail_unless (gst_buffer_pool_set_active (pool, TRUE));
+  gst_caps_unref (caps);
+
+  return pool;
+}
+
+static void
+free_video_pool (GstBufferPool * pool)
+{
+  fail_unless (gst_buffer_pool_set_active (pool, FALSE));
+  gst_object_unref (pool);
+}
+
+GST_START_TEST (test_video_memory_cache)
+{
+  GstVideoMemoryCacheStats before, after;
+  GstBufferPool *pool;
+  GstBuffer *buffer;
+  GstMapInfo map;
+
+  /* the cache keeps nothing unless asked to */
+  fail_unless_equals_int (gst_video_memory_cache_get_max_size (), 0);
+  gst_video_memory_cache_get_stats (&before);
+  fail_unless_equals_int (before.cached_size, 0);
+  pool = make_video_pool (320, 240, 2);
+  free_video_pool (pool);
+  gst_video_memory_cache_get_stats (&after);
+  fail_unless_equals_int (after.cached_size, 0);
+
+  gst_video_memory_cache_set_max_size (64 * 1024 * 1024);
+  gst_video_memory_cache_get_stats (&before);
+
+  /* activating the pool allocates and prefaults its minimum buffers */
+  pool = make_video_pool (1280, 720, 4);
+  gst_video_memory_cache_get_stats (&after);
+  fail_unless_equals_int (after.allocs - before.allocs, 4);
+  fail_unless_equals_int (after.hits - before.hits, 0);
+
+  fail_unless (gst_buffer_pool_acquire_buffer (pool, &buffer,
+          NULL) == GST_FLOW_OK);
+  fail_unless (gst_buffer_map (buffer, &map, GST_MAP_WRITE));
+  fail_unless_equals_int (map.size, 1280 * 720 * 3 / 2);
+  fail_unless ((((guintptr) map.data) & gst_memory_alignment) == 0);
+  memset (map.data, 0x80, map.size);
+  gst_buffer_unmap (buffer, &map);
+  gst_buffer_unref (buffer);
+
+  /* the memory of a freed pool stays in the cache */
+  free_video_pool (pool);
+  gst_video_memory_cache_get_stats (&before);
+  fail_unless (before.cached_size >= 4 * 1280 * 720 * 3 / 2);
+
+  /* and the next pool with the same geometry recycles it */
+  pool = make_video_pool (1280, 720, 4);
+  gst_video_memory_cache_get_stats (&after);
+  fail_unless_equals_int (after.allocs - before.allocs, 4);
+  fail_unless_equals_int (after.hits - before.hits, 4);
+  fail_unless_equals_uint64 (after.page_faults, before.page_faults);
+  fail_unless_equals_int (after.cached_size, 0);
+  free_video_pool (pool);
+
+  /* another size class gets new memory */
+  gst_video_memory_cache_get_stats (&before);
+  pool = make_video_pool (320, 240, 2);
+  gst_video_memory_cache_get_stats (&after);
+  fail_unless_equals_int (after.allocs - before.allocs, 2);
+  fail_unless_equals_int (after.hits - before.hits, 0);
+  free_video_pool (pool);
+
+  /* disabling the cache again frees what it kept */
+  gst_video_memory_cache_get_stats (&after);
+  fail_unless (after.cached_size > 0);
+  gst_video_memory_cache_set_max_size (0);
+  gst_video_memory_cache_get_stats (&after);
+  fail_unless_equals_int (after.cached_size, 0);
+}
+
+GST_END_TEST;
+
 static Suite *
 video_suite (void)
 {
@@ -1598,9 +1966,13 @@ video_suite (void)
   tcase_add_test (tc_chain, test_convert_frame);
   tcase_add_test (tc_chain, test_convert_frame_async);
   tcase_add_test (tc_chain, test_video_size_from_caps);
+  tcase_add_test (tc_chain, test_video_converter);
+  tcase_add_test (tc_chain, test_video_converter_linear);
   tcase_add_test (tc_chain, test_overlay_composition);
   tcase_add_test (tc_chain, test_overlay_composition_premultiplied_alpha);
   tcase_add_test (tc_chain, test_overlay_composition_global_alpha);
+  tcase_add_test (tc_chain, test_overlay_composition_cache);
+  tcase_add_test (tc_chain, test_video_memory_cache);
 
   return s;
 }
@@ -0,0 +1,381 @@
+/* GStreamer
+ *
+ * videodecoder.c: unit tests for frame threading in GstVideoDecoder
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <gst/check/gstcheck.h>
+#include <gst/video/video.h>
+#include <gst/video/gstvideodecoder.h>
+#include <string.h>
+
+/* A slow decoder: every input buffer holds a frame number, decoding a frame
+ * takes DECODE_TIME and writes the frame number, a decoded mark and whether
+ * its reference was decoded before it into the first bytes of a GRAY8
+ * frame. Frames are predicted from the last keyframe, one in every gop_size
+ * frames. */
+
+#define DECODE_TIME (5 * G_USEC_PER_SEC / 1000)
+#define FRAME_DURATION (GST_SECOND / 30)
+
+static GstPad *mysrcpad, *mysinkpad;
+static GstElement *dec;
+
+static guint gop_size;
+
+static GstStaticPadTemplate sinktemplate = GST_STATIC_PAD_TEMPLATE ("sink",
+    GST_PAD_SINK,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS ("video/x-raw")
+    );
+
+static GstStaticPadTemplate srctemplate = GST_STATIC_PAD_TEMPLATE ("src",
+    GST_PAD_SRC,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS ("video/x-test-slow")
+    );
+
+static GstStaticPadTemplate decoder_sinktemplate =
+GST_STATIC_PAD_TEMPLATE ("sink",
+    GST_PAD_SINK,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS ("video/x-test-slow")
+    );
+
+static GstStaticPadTemplate decoder_srctemplate =
+GST_STATIC_PAD_TEMPLATE ("src",
+    GST_PAD_SRC,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS ("video/x-raw")
+    );
+
+#define GST_TYPE_VIDEO_DECODER_TESTER gst_video_decoder_tester_get_type ()
+static GType gst_video_decoder_tester_get_type (void);
+
+typedef struct _GstVideoDecoderTester GstVideoDecoderTester;
+typedef struct _GstVideoDecoderTesterClass GstVideoDecoderTesterClass;
+
+struct _GstVideoDecoderTester
+{
+  GstVideoDecoder parent;
+
+  GstVideoCodecFrame *keyframe;
+};
+
+struct _GstVideoDecoderTesterClass
+{
+  GstVideoDecoderClass parent_class;
+};
+
+G_DEFINE_TYPE (GstVideoDecoderTester, gst_video_decoder_tester,
+    GST_TYPE_VIDEO_DECODER);
+
+static gboolean
+gst_video_decoder_tester_stop (GstVideoDecoder * dec)
+{
+  GstVideoDecoderTester *tester = (GstVideoDecoderTester *) dec;
+
+  if (tester->keyframe)
+    gst_video_codec_frame_unref (tester->keyframe);
+  tester->keyframe = NULL;
+
+  return TRUE;
+}
+
+static gboolean
+gst_video_decoder_tester_reset (GstVideoDecoder * dec, gboolean hard)
+{
+  if (hard)
+    gst_video_decoder_tester_stop (dec);
+
+  return TRUE;
+}
+
+static gboolean
+gst_video_decoder_tester_set_format (GstVideoDecoder * dec,
+    GstVideoCodecState * state)
+{
+  GstVideoCodecState *res = gst_video_decoder_set_output_state (dec,
+      GST_VIDEO_FORMAT_GRAY8, 16, 16, NULL);
+
+  gst_video_codec_state_unref (res);
+  return TRUE;
+}
+
+static GstFlowReturn
+gst_video_decoder_tester_handle_frame (GstVideoDecoder * dec,
+    GstVideoCodecFrame * frame)
+{
+  GstVideoDecoderTester *tester = (GstVideoDecoderTester *) dec;
+  GstVideoCodecFrame *reference;
+  GstMapInfo map;
+  guint32 num;
+  GstFlowReturn ret;
+
+  gst_buffer_extract (frame->input_buffer, 0, &num, sizeof (num));
+
+  ret = gst_video_decoder_allocate_output_frame (dec, frame);
+  if (ret != GST_FLOW_OK) {
+    gst_video_decoder_drop_frame (dec, frame);
+    return ret;
+  }
+  gst_buffer_map (frame->output_buffer, &map, GST_MAP_WRITE);
+  memset (map.data, 0, map.size);
+  gst_buffer_unmap (frame->output_buffer, &map);
+
+  if (num % gop_size == 0 || tester->keyframe == NULL) {
+    if (tester->keyframe)
+      gst_video_codec_frame_unref (tester->keyframe);
+    tester->keyframe = gst_video_codec_frame_ref (frame);
+    return gst_video_decoder_dispatch_frame (dec, frame, NULL, 0);
+  }
+
+  /* decode_frame runs while the next keyframe may replace this one */
+  reference = gst_video_codec_frame_ref (tester->keyframe);
+  gst_video_codec_frame_set_user_data (frame, reference,
+      (GDestroyNotify) gst_video_codec_frame_unref);
+  return gst_video_decoder_dispatch_frame (dec, frame, &reference, 1);
+}
+
+static GstFlowReturn
+gst_video_decoder_tester_decode_frame (GstVideoDecoder * dec,
+    GstVideoCodecFrame * frame)
+{
+  GstVideoCodecFrame *reference;
+  GstMapInfo map;
+  guint32 num;
+  guint8 ref_decoded = 1;
+
+  gst_buffer_extract (frame->input_buffer, 0, &num, sizeof (num));
+
+  reference = gst_video_codec_frame_get_user_data (frame);
+  if (reference)
+    gst_buffer_extract (reference->output_buffer, 1, &ref_decoded, 1);
+
+  g_usleep (DECODE_TIME);
+
+  gst_buffer_map (frame->output_buffer, &map, GST_MAP_WRITE);
+  map.data[0] = num & 0xff;
+  map.data[1] = 1;
+  map.data[2] = ref_decoded;
+  gst_buffer_unmap (frame->output_buffer, &map);
+
+  return GST_FLOW_OK;
+}
+
+static void
+gst_video_decoder_tester_class_init (GstVideoDecoderTesterClass * klass)
+{
+  GstElementClass *element_class = GST_ELEMENT_CLASS (klass);
+  GstVideoDecoderClass *decoder_class = GST_VIDEO_DECODER_CLASS (klass);
+
+  gst_element_class_add_pad_template (element_class,
+      gst_static_pad_template_get (&decoder_srctemplate));
+  gst_element_class_add_pad_template (element_class,
+      gst_static_pad_template_get (&decoder_sinktemplate));
+
+  gst_element_class_set_static_metadata (element_class,
+      "VideoDecoderTester", "Decoder/Video", "Slow test decoder",
+      "GStreamer");
+
+  decoder_class->stop = gst_video_decoder_tester_stop;
+  decoder_class->reset = gst_video_decoder_tester_reset;
+  decoder_class->set_format = gst_video_decoder_tester_set_format;
+  decoder_class->handle_frame = gst_video_decoder_tester_handle_frame;
+  decoder_class->decode_frame = gst_video_decoder_tester_decode_frame;
+}
+
+static void
+gst_video_decoder_tester_init (GstVideoDecoderTester * tester)
+{
+}
+
+static void
+setup_videodecodertester (guint n_threads, guint gop)
+{
+  gop_size = gop;
+
+  dec = g_object_new (GST_TYPE_VIDEO_DECODER_TESTER, NULL);
+  gst_video_decoder_set_frame_threads (GST_VIDEO_DECODER (dec), n_threads);
+
+  mysrcpad = gst_check_setup_src_pad (dec, &srctemplate);
+  mysinkpad = gst_check_setup_sink_pad (dec, &sinktemplate);
+  gst_pad_set_active (mysrcpad, TRUE);
+  gst_pad_set_active (mysinkpad, TRUE);
+
+  fail_unless (gst_element_set_state (dec, GST_STATE_PLAYING) ==
+      GST_STATE_CHANGE_SUCCESS);
+}
+
+static void
+cleanup_videodecodertester (void)
+{
+  fail_unless (gst_element_set_state (dec, GST_STATE_NULL) ==
+      GST_STATE_CHANGE_SUCCESS);
+  gst_pad_set_active (mysrcpad, FALSE);
+  gst_pad_set_active (mysinkpad, FALSE);
+  gst_check_teardown_src_pad (dec);
+  gst_check_teardown_sink_pad (dec);
+  gst_check_teardown_element (dec);
+
+  gst_check_drop_buffers ();
+}
+
+static void
+send_start_events (void)
+{
+  GstSegment segment;
+  GstCaps *caps;
+
+  fail_unless (gst_pad_push_event (mysrcpad,
+          gst_event_new_stream_start ("videodecoder")));
+  caps = gst_caps_new_empty_simple ("video/x-test-slow");
+  fail_unless (gst_pad_push_event (mysrcpad, gst_event_new_caps (caps)));
+  gst_caps_unref (caps);
+  gst_segment_init (&segment, GST_FORMAT_TIME);
+  fail_unless (gst_pad_push_event (mysrcpad, gst_event_new_segment (&segment)));
+}
+
+static void
+push_frames (guint first, guint n_frames)
+{
+  guint32 i;
+
+  for (i = first; i < first + n_frames; i++) {
+    GstBuffer *buffer = gst_buffer_new_allocate (NULL, sizeof (i), NULL);
+
+    gst_buffer_fill (buffer, 0, &i, sizeof (i));
+    GST_BUFFER_PTS (buffer) = i * FRAME_DURATION;
+    GST_BUFFER_DURATION (buffer) = FRAME_DURATION;
+    if (i % gop_size)
+      GST_BUFFER_FLAG_SET (buffer, GST_BUFFER_FLAG_DELTA_UNIT);
+    fail_unless (gst_pad_push (mysrcpad, buffer) == GST_FLOW_OK);
+  }
+}
+
+/* checks that @list holds the decoded frames from @first on in order */
+static void
+check_frames (GList * list, guint first, guint n_frames)
+{
+  guint i;
+
+  fail_unless_equals_int (g_list_length (list), n_frames);
+  for (i = first; list; list = list->next, i++) {
+    GstBuffer *buffer = list->data;
+    GstMapInfo map;
+
+    fail_unless_equals_uint64 (GST_BUFFER_PTS (buffer), i * FRAME_DURATION);
+    gst_buffer_map (buffer, &map, GST_MAP_READ);
+    fail_unless_equals_int (map.data[0], i & 0xff);
+    fail_unless_equals_int (map.data[1], 1);
+    fail_unless_equals_int (map.data[2], 1);
+    gst_buffer_unmap (buffer, &map);
+  }
+}
+
+static GstClockTime
+decode_frames (guint n_threads, guint gop, guint n_frames)
+{
+  GstClockTime start, elapsed;
+
+  setup_videodecodertester (n_threads, gop);
+  send_start_events ();
+
+  start = gst_util_get_timestamp ();
+  push_frames (0, n_frames);
+  fail_unless (gst_pad_push_event (mysrcpad, gst_event_new_eos ()));
+  elapsed = gst_util_get_timestamp () - start;
+
+  check_frames (buffers, 0, n_frames);
+  cleanup_videodecodertester ();
+
+  return elapsed;
+}
+
+GST_START_TEST (test_frame_threads_order)
+{
+  static const guint threads[] = { 1, 2, 4, 7 };
+  static const guint gops[] = { 1, 5, 1000 };
+  guint i, j;
+
+  for (i = 0; i < G_N_ELEMENTS (threads); i++) {
+    for (j = 0; j < G_N_ELEMENTS (gops); j++) {
+      GST_DEBUG ("%u threads, gop %u", threads[i], gops[j]);
+      decode_frames (threads[i], gops[j], 40);
+    }
+  }
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_frame_threads_scaling)
+{
+  GstClockTime serial, threaded;
+
+  /* only keyframes, so all frames can be decoded at the same time */
+  serial = decode_frames (1, 1, 64);
+  threaded = decode_frames (4, 1, 64);
+
+  GST_INFO ("1 thread %" GST_TIME_FORMAT ", 4 threads %" GST_TIME_FORMAT,
+      GST_TIME_ARGS (serial), GST_TIME_ARGS (threaded));
+  /* 4 times faster in theory, leave room for busy machines */
+  fail_unless (threaded < serial / 2);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_frame_threads_flush)
+{
+  setup_videodecodertester (4, 8);
+  send_start_events ();
+
+  push_frames (0, 20);
+
+  /* frames from before the flush are dropped, not pushed after it */
+  fail_unless (gst_pad_push_event (mysrcpad, gst_event_new_flush_start ()));
+  fail_unless (gst_pad_push_event (mysrcpad, gst_event_new_flush_stop (TRUE)));
+  gst_check_drop_buffers ();
+  send_start_events ();
+
+  push_frames (40, 16);
+  fail_unless (gst_pad_push_event (mysrcpad, gst_event_new_eos ()));
+
+  check_frames (buffers, 40, 16);
+  cleanup_videodecodertester ();
+}
+
+GST_END_TEST;
+
+static Suite *
+videodecoder_suite (void)
+{
+  Suite *s = suite_create ("videodecoder");
+  TCase *tc_chain = tcase_create ("general");
+
+  suite_add_tcase (s, tc_chain);
+  tcase_add_test (tc_chain, test_frame_threads_order);
+  tcase_add_test (tc_chain, test_frame_threads_scaling);
+  tcase_add_test (tc_chain, test_frame_threads_flush);
+
+  return s;
+}
+
+GST_CHECK_MAIN (videodecoder);
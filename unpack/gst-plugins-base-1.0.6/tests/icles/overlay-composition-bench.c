@@ -0,0 +1,129 @@
+/* GStreamer
+ *
+ * overlay-composition-bench.c: measure blending a static overlay onto
+ * 1080p video
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/* Blends a subtitle-like ARGB overlay, rendered larger than its pixels, onto
+ * 1920x1080 frames for one minute of 60 frames/s video. The overlay is
+ * either reused for every frame, so the scaled pixels come from the cache of
+ * the rectangle, or copied for every frame, which scales it every time like
+ * a rectangle without cache.
+ *
+ * Usage: overlay-composition-bench [num-frames]
+ */
+
+#include <stdlib.h>
+#include <gst/gst.h>
+#include <gst/video/video.h>
+#include <gst/video/video-overlay-composition.h>
+
+static guint num_frames = 3600;
+
+static const gchar *formats[] = { "I420", "BGRx", "AYUV" };
+
+static GstVideoOverlayRectangle *
+make_rectangle (void)
+{
+  GstBuffer *pixels;
+  GstMapInfo map;
+  gsize i;
+
+  pixels = gst_buffer_new_and_alloc (960 * 90 * 4);
+  gst_buffer_map (pixels, &map, GST_MAP_WRITE);
+  for (i = 0; i < map.size; i++)
+    map.data[i] = (i & 3) == 3 ? ((i >> 6) & 1 ? 0xff : 0x00) : i * 13;
+  gst_buffer_unmap (pixels, &map);
+  gst_buffer_add_video_meta (pixels, GST_VIDEO_FRAME_FLAG_NONE,
+      GST_VIDEO_OVERLAY_COMPOSITION_FORMAT_RGB, 960, 90);
+
+  return gst_video_overlay_rectangle_new_raw (pixels, 240, 900, 1440, 135,
+      GST_VIDEO_OVERLAY_FORMAT_FLAG_NONE);
+}
+
+/* returns the average time per frame in ms */
+static gdouble
+run_bench (const gchar * format, gboolean cached)
+{
+  GstVideoOverlayRectangle *rect;
+  GstVideoOverlayComposition *comp;
+  GstVideoFrame frame;
+  GstVideoInfo info;
+  GstBuffer *buffer, *pixels;
+  GstClockTime start, elapsed;
+  guint i;
+
+  gst_video_info_init (&info);
+  gst_video_info_set_format (&info, gst_video_format_from_string (format),
+      1920, 1080);
+  buffer = gst_buffer_new_and_alloc (GST_VIDEO_INFO_SIZE (&info));
+  gst_buffer_memset (buffer, 0, 0x80, GST_VIDEO_INFO_SIZE (&info));
+
+  rect = make_rectangle ();
+  pixels = gst_video_overlay_rectangle_get_pixels_unscaled_argb (rect,
+      GST_VIDEO_OVERLAY_FORMAT_FLAG_NONE);
+  comp = gst_video_overlay_composition_new (rect);
+
+  gst_video_frame_map (&frame, &info, buffer, GST_MAP_READWRITE);
+
+  start = gst_util_get_timestamp ();
+  for (i = 0; i < num_frames; i++) {
+    if (cached) {
+      gst_video_overlay_composition_blend (comp, &frame);
+    } else {
+      GstVideoOverlayComposition *copy;
+      GstVideoOverlayRectangle *r;
+
+      r = gst_video_overlay_rectangle_new_raw (pixels, 240, 900, 1440, 135,
+          GST_VIDEO_OVERLAY_FORMAT_FLAG_NONE);
+      copy = gst_video_overlay_composition_new (r);
+      gst_video_overlay_composition_blend (copy, &frame);
+      gst_video_overlay_composition_unref (copy);
+      gst_video_overlay_rectangle_unref (r);
+    }
+  }
+  elapsed = gst_util_get_timestamp () - start;
+
+  gst_video_frame_unmap (&frame);
+  gst_video_overlay_composition_unref (comp);
+  gst_video_overlay_rectangle_unref (rect);
+  gst_buffer_unref (buffer);
+
+  return elapsed / (gdouble) GST_MSECOND / MAX (num_frames, 1);
+}
+
+int
+main (int argc, char *argv[])
+{
+  guint i;
+
+  gst_init (&argc, &argv);
+
+  if (argc > 1)
+    num_frames = atoi (argv[1]);
+
+  g_print ("%u frames of 1920x1080 with a 960x90 overlay rendered at "
+      "1440x135, ms/frame (16.7 ms at 60 frames/s)\n", num_frames);
+  g_print ("%-8s %12s %12s\n", "", "scale", "cached");
+
+  for (i = 0; i < G_N_ELEMENTS (formats); i++)
+    g_print ("%-8s %12.3f %12.3f\n", formats[i],
+        run_bench (formats[i], FALSE), run_bench (formats[i], TRUE));
+
+  return 0;
+}
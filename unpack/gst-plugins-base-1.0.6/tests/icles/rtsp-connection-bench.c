@@ -0,0 +1,310 @@
+/* GStreamer
+ *
+ * rtsp-connection-bench.c: measure the message rate of GstRTSPConnection
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/* Runs a minimal RTSP server on a GstRTSPWatchPool that answers every request
+ * and a number of client threads that each do DESCRIBE/SETUP/PLAY sequences
+ * over a loopback TCP connection, then measures how fast RTP packets in
+ * interleaved data messages can be received on one connection.
+ *
+ * Usage: rtsp-connection-bench [server-threads] [clients] [sequences]
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <gio/gio.h>
+#include <gst/gst.h>
+#include <gst/rtsp/gstrtspconnection.h>
+
+#define RTP_PACKET_SIZE 1400
+#define NUM_RTP_PACKETS 200000
+
+static guint num_sequences = 10000;
+static GSocketAddress *server_address;
+
+static GstRTSPResult
+message_received (GstRTSPWatch * watch, GstRTSPMessage * message,
+    gpointer user_data)
+{
+  GstRTSPMessage response = { 0 };
+  gchar *cseq;
+
+  gst_rtsp_message_init_response (&response, GST_RTSP_STS_OK, NULL, message);
+  if (gst_rtsp_message_get_header (message, GST_RTSP_HDR_CSEQ, &cseq,
+          0) == GST_RTSP_OK)
+    gst_rtsp_message_add_header (&response, GST_RTSP_HDR_CSEQ, cseq);
+
+  switch (message->type_data.request.method) {
+    case GST_RTSP_DESCRIBE:
+    {
+      static const gchar sdp[] =
+          "v=0\r\no=- 0 0 IN IP4 127.0.0.1\r\ns=bench\r\nt=0 0\r\n"
+          "m=video 0 RTP/AVP 96\r\na=rtpmap:96 H264/90000\r\n"
+          "a=control:stream=0\r\n";
+
+      gst_rtsp_message_add_header (&response, GST_RTSP_HDR_CONTENT_TYPE,
+          "application/sdp");
+      gst_rtsp_message_set_body (&response, (guint8 *) sdp, strlen (sdp));
+      break;
+    }
+    case GST_RTSP_SETUP:
+      gst_rtsp_message_add_header (&response, GST_RTSP_HDR_TRANSPORT,
+          "RTP/AVP/TCP;unicast;interleaved=0-1");
+      gst_rtsp_message_add_header (&response, GST_RTSP_HDR_SESSION,
+          "12345678");
+      break;
+    case GST_RTSP_PLAY:
+      gst_rtsp_message_add_header (&response, GST_RTSP_HDR_SESSION,
+          "12345678");
+      break;
+    default:
+      break;
+  }
+  gst_rtsp_watch_send_message (watch, &response, NULL);
+  gst_rtsp_message_unset (&response);
+
+  return GST_RTSP_OK;
+}
+
+static GstRTSPWatchFuncs server_funcs = {
+  message_received,
+};
+
+static gboolean
+new_client (GSocket * socket, GIOCondition condition, gpointer user_data)
+{
+  GstRTSPWatchPool *pool = user_data;
+  GstRTSPConnection *conn;
+  GstRTSPWatch *watch;
+
+  if (gst_rtsp_connection_accept (socket, &conn, NULL) != GST_RTSP_OK)
+    return TRUE;
+
+  /* the connection is freed when the watch is destroyed */
+  watch = gst_rtsp_watch_new (conn, &server_funcs, conn,
+      (GDestroyNotify) gst_rtsp_connection_free);
+  gst_rtsp_watch_pool_attach (pool, watch);
+  gst_rtsp_watch_unref (watch);
+
+  return TRUE;
+}
+
+static GstRTSPConnection *
+connect_client (void)
+{
+  GstRTSPConnection *conn;
+  GSocket *socket;
+
+  socket = g_socket_new (G_SOCKET_FAMILY_IPV4, G_SOCKET_TYPE_STREAM,
+      G_SOCKET_PROTOCOL_TCP, NULL);
+  if (!g_socket_connect (socket, server_address, NULL, NULL))
+    g_error ("could not connect to the server");
+
+  gst_rtsp_connection_create_from_socket (socket, "127.0.0.1", 0, NULL, &conn);
+  g_object_unref (socket);
+
+  return conn;
+}
+
+static void
+do_request (GstRTSPConnection * conn, GstRTSPMethod method, const gchar * uri)
+{
+  GstRTSPMessage request = { 0 }, response = { 0 };
+
+  gst_rtsp_message_init_request (&request, method, uri);
+  if (method != GST_RTSP_DESCRIBE)
+    gst_rtsp_message_add_header (&request, GST_RTSP_HDR_SESSION, "12345678");
+  if (method == GST_RTSP_SETUP)
+    gst_rtsp_message_add_header (&request, GST_RTSP_HDR_TRANSPORT,
+        "RTP/AVP/TCP;unicast;interleaved=0-1");
+
+  if (gst_rtsp_connection_send (conn, &request, NULL) != GST_RTSP_OK ||
+      gst_rtsp_connection_receive (conn, &response, NULL) != GST_RTSP_OK)
+    g_error ("request failed");
+
+  gst_rtsp_message_unset (&request);
+  gst_rtsp_message_unset (&response);
+}
+
+static gpointer
+client_thread (gpointer data)
+{
+  GstRTSPConnection *conn;
+  guint i;
+
+  conn = connect_client ();
+  for (i = 0; i < num_sequences; i++) {
+    do_request (conn, GST_RTSP_DESCRIBE, "rtsp://127.0.0.1/bench");
+    do_request (conn, GST_RTSP_SETUP, "rtsp://127.0.0.1/bench/stream=0");
+    do_request (conn, GST_RTSP_PLAY, "rtsp://127.0.0.1/bench");
+  }
+  gst_rtsp_connection_free (conn);
+
+  return NULL;
+}
+
+static void
+bench_requests (guint n_clients)
+{
+  GThread **threads;
+  GTimer *timer;
+  gdouble elapsed;
+  guint i;
+
+  threads = g_new (GThread *, n_clients);
+
+  timer = g_timer_new ();
+  for (i = 0; i < n_clients; i++)
+    threads[i] = g_thread_new ("client", client_thread, NULL);
+  for (i = 0; i < n_clients; i++)
+    g_thread_join (threads[i]);
+  elapsed = g_timer_elapsed (timer, NULL);
+
+  g_print ("DESCRIBE/SETUP/PLAY: %u clients, %u requests: %.0f requests/s\n",
+      n_clients, n_clients * num_sequences * 3,
+      n_clients * num_sequences * 3 / elapsed);
+
+  g_timer_destroy (timer);
+  g_free (threads);
+}
+
+static gpointer
+data_sender_thread (gpointer data)
+{
+  GstRTSPConnection *conn = data;
+  GstRTSPMessage message = { 0 };
+  guint8 *packet;
+  guint i;
+
+  packet = g_malloc0 (RTP_PACKET_SIZE);
+  packet[0] = 0x80;
+  packet[1] = 96;
+
+  gst_rtsp_message_init_data (&message, 0);
+  gst_rtsp_message_take_body (&message, packet, RTP_PACKET_SIZE);
+  for (i = 0; i < NUM_RTP_PACKETS; i++) {
+    if (gst_rtsp_connection_send (conn, &message, NULL) != GST_RTSP_OK)
+      g_error ("could not send data");
+  }
+  gst_rtsp_message_unset (&message);
+
+  return NULL;
+}
+
+static void
+bench_interleaved (GSocketListener * listener)
+{
+  GstRTSPConnection *client, *server;
+  GstRTSPMessage message = { 0 };
+  GSocket *socket;
+  GThread *sender;
+  GTimer *timer;
+  gdouble elapsed;
+  guint i;
+
+  client = connect_client ();
+  socket = g_socket_listener_accept_socket (listener, NULL, NULL, NULL);
+  gst_rtsp_connection_create_from_socket (socket, "127.0.0.1", 0, NULL,
+      &server);
+  g_object_unref (socket);
+
+  timer = g_timer_new ();
+  sender = g_thread_new ("sender", data_sender_thread, server);
+  for (i = 0; i < NUM_RTP_PACKETS; i++) {
+    if (gst_rtsp_connection_receive (client, &message, NULL) != GST_RTSP_OK ||
+        message.type != GST_RTSP_MESSAGE_DATA)
+      g_error ("could not receive data");
+    gst_rtsp_message_unset (&message);
+  }
+  elapsed = g_timer_elapsed (timer, NULL);
+  g_thread_join (sender);
+
+  g_print ("interleaved RTP: %u packets of %u bytes: %.0f packets/s, "
+      "%.1f Mbit/s\n", NUM_RTP_PACKETS, RTP_PACKET_SIZE,
+      NUM_RTP_PACKETS / elapsed,
+      NUM_RTP_PACKETS * (RTP_PACKET_SIZE + 4) * 8 / elapsed / 1000000);
+
+  g_timer_destroy (timer);
+  gst_rtsp_connection_free (client);
+  gst_rtsp_connection_free (server);
+}
+
+int
+main (int argc, char *argv[])
+{
+  GstRTSPWatchPool *pool;
+  GSocketListener *data_listener;
+  GMainContext *context;
+  GInetAddress *loopback;
+  GSocketAddress *address;
+  GSocket *socket;
+  GSource *source;
+  guint n_threads = 4, n_clients = 16;
+
+  gst_init (&argc, &argv);
+
+  if (argc > 1)
+    n_threads = atoi (argv[1]);
+  if (argc > 2)
+    n_clients = atoi (argv[2]);
+  if (argc > 3)
+    num_sequences = atoi (argv[3]);
+
+  loopback = g_inet_address_new_loopback (G_SOCKET_FAMILY_IPV4);
+  address = g_inet_socket_address_new (loopback, 0);
+  g_object_unref (loopback);
+
+  /* the request server, new connections are accepted in their own thread
+   * and handed to the pool */
+  socket = g_socket_new (G_SOCKET_FAMILY_IPV4, G_SOCKET_TYPE_STREAM,
+      G_SOCKET_PROTOCOL_TCP, NULL);
+  if (!g_socket_bind (socket, address, TRUE, NULL) ||
+      !g_socket_listen (socket, NULL))
+    g_error ("could not listen on the loopback address");
+  server_address = g_socket_get_local_address (socket, NULL);
+
+  pool = gst_rtsp_watch_pool_new (n_threads);
+  context = g_main_context_new ();
+  source = g_socket_create_source (socket, G_IO_IN, NULL);
+  g_source_set_callback (source, (GSourceFunc) new_client, pool, NULL);
+  g_source_attach (source, context);
+
+  g_thread_new ("accept", (GThreadFunc) g_main_loop_run,
+      g_main_loop_new (context, FALSE));
+
+  g_print ("%u server threads\n", n_threads);
+  bench_requests (n_clients);
+
+  /* interleaved data goes over a plain connection pair */
+  g_source_destroy (source);
+  g_source_unref (source);
+  g_object_unref (server_address);
+  data_listener = g_socket_listener_new ();
+  g_socket_listener_add_address (data_listener, address, G_SOCKET_TYPE_STREAM,
+      G_SOCKET_PROTOCOL_TCP, NULL, &server_address, NULL);
+  bench_interleaved (data_listener);
+
+  g_object_unref (data_listener);
+  g_object_unref (socket);
+  g_object_unref (server_address);
+  g_object_unref (address);
+  gst_rtsp_watch_pool_free (pool);
+
+  return 0;
+}
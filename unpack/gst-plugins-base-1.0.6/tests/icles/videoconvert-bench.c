@@ -0,0 +1,193 @@
+/* GStreamer
+ *
+ * videoconvert-bench.c: measure the frame rate of videoconvert with a
+ * growing number of threads
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/* Pushes the same frame into videoconvert for a set of format pairs, both
+ * fastpaths and the generic path, with n-threads going from 1 to 16, and
+ * reports frames/s.
+ *
+ * Usage: videoconvert-bench [num-frames] [width] [height]
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <gst/gst.h>
+#include <gst/video/video.h>
+
+static guint num_frames = 200;
+static gint width = 1920;
+static gint height = 1080;
+
+static const gchar *formats[][2] = {
+  {"I420", "YUY2"},
+  {"YUY2", "I420"},
+  {"AYUV", "I420"},
+  {"I420", "BGRA"},
+  {"I420", "BGRx"},
+  {"NV12", "I420"},
+  {"v210", "I420"},
+  {"ARGB64", "AYUV"}
+};
+
+static guint received;
+static GstCaps *sink_caps;
+
+static GstFlowReturn
+chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
+{
+  received++;
+  gst_buffer_unref (buffer);
+  return GST_FLOW_OK;
+}
+
+static gboolean
+query (GstPad * pad, GstObject * parent, GstQuery * query)
+{
+  switch (GST_QUERY_TYPE (query)) {
+    case GST_QUERY_CAPS:
+      gst_query_set_caps_result (query, sink_caps);
+      return TRUE;
+    case GST_QUERY_ACCEPT_CAPS:
+      gst_query_set_accept_caps_result (query, TRUE);
+      return TRUE;
+    default:
+      return gst_pad_query_default (pad, parent, query);
+  }
+}
+
+static GstCaps *
+make_caps (const gchar * format)
+{
+  return gst_caps_new_simple ("video/x-raw",
+      "format", G_TYPE_STRING, format,
+      "width", G_TYPE_INT, width, "height", G_TYPE_INT, height,
+      "framerate", GST_TYPE_FRACTION, 30, 1, NULL);
+}
+
+static gdouble
+run_bench (const gchar * in_format, const gchar * out_format, guint n_threads)
+{
+  GstElement *convert;
+  GstPad *srcpad, *sinkpad, *pad;
+  GstCaps *caps;
+  GstVideoInfo info;
+  GstBuffer *frame;
+  GstMapInfo map;
+  GstSegment segment;
+  GstClockTime start, elapsed;
+  guint i;
+
+  convert = gst_element_factory_make ("videoconvert", NULL);
+  if (convert == NULL)
+    g_error ("videoconvert is not available");
+  gst_object_ref_sink (convert);
+  g_object_set (convert, "n-threads", n_threads, NULL);
+
+  srcpad = gst_pad_new ("src", GST_PAD_SRC);
+  sinkpad = gst_pad_new ("sink", GST_PAD_SINK);
+  gst_pad_set_chain_function (sinkpad, chain);
+  gst_pad_set_query_function (sinkpad, query);
+
+  pad = gst_element_get_static_pad (convert, "sink");
+  gst_pad_link (srcpad, pad);
+  gst_object_unref (pad);
+  pad = gst_element_get_static_pad (convert, "src");
+  gst_pad_link (pad, sinkpad);
+  gst_object_unref (pad);
+
+  gst_pad_set_active (srcpad, TRUE);
+  gst_pad_set_active (sinkpad, TRUE);
+  gst_element_set_state (convert, GST_STATE_PLAYING);
+
+  sink_caps = make_caps (out_format);
+  caps = make_caps (in_format);
+  gst_video_info_from_caps (&info, caps);
+
+  gst_pad_push_event (srcpad,
+      gst_event_new_stream_start ("videoconvert-bench"));
+  gst_pad_push_event (srcpad, gst_event_new_caps (caps));
+  gst_segment_init (&segment, GST_FORMAT_TIME);
+  gst_pad_push_event (srcpad, gst_event_new_segment (&segment));
+  gst_caps_unref (caps);
+
+  frame = gst_buffer_new_allocate (NULL, info.size, NULL);
+  gst_buffer_map (frame, &map, GST_MAP_WRITE);
+  for (i = 0; i < map.size; i++)
+    map.data[i] = (i * 7) ^ (i >> 11);
+  gst_buffer_unmap (frame, &map);
+
+  /* the first frame sets up the converter and its threads */
+  gst_pad_push (srcpad, gst_buffer_ref (frame));
+
+  received = 0;
+  start = gst_util_get_timestamp ();
+  for (i = 0; i < num_frames; i++)
+    gst_pad_push (srcpad, gst_buffer_ref (frame));
+  elapsed = gst_util_get_timestamp () - start;
+
+  if (received != num_frames)
+    g_printerr ("%s -> %s: only %u of %u frames converted\n", in_format,
+        out_format, received, num_frames);
+
+  gst_buffer_unref (frame);
+  gst_caps_unref (sink_caps);
+  gst_element_set_state (convert, GST_STATE_NULL);
+  gst_object_unref (convert);
+  gst_object_unref (srcpad);
+  gst_object_unref (sinkpad);
+
+  return received * (gdouble) GST_SECOND / MAX (elapsed, 1);
+}
+
+int
+main (int argc, char *argv[])
+{
+  static const guint threads[] = { 1, 2, 4, 8, 16 };
+  guint i, j;
+
+  gst_init (&argc, &argv);
+
+  if (argc > 1)
+    num_frames = atoi (argv[1]);
+  if (argc > 2)
+    width = atoi (argv[2]);
+  if (argc > 3)
+    height = atoi (argv[3]);
+
+  g_print ("%u frames of %dx%d, frames/s\n", num_frames, width, height);
+  g_print ("%-18s", "");
+  for (j = 0; j < G_N_ELEMENTS (threads); j++)
+    g_print ("%8u", threads[j]);
+  g_print ("\n");
+
+  for (i = 0; i < G_N_ELEMENTS (formats); i++) {
+    gchar *pair;
+
+    pair = g_strdup_printf ("%s -> %s:", formats[i][0], formats[i][1]);
+    g_print ("%-18s", pair);
+    g_free (pair);
+
+    for (j = 0; j < G_N_ELEMENTS (threads); j++)
+      g_print ("%8.1f", run_bench (formats[i][0], formats[i][1], threads[j]));
+    g_print ("\n");
+  }
+
+  return 0;
+}
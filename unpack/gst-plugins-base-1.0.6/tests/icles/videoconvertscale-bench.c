@@ -0,0 +1,213 @@
+/* GStreamer
+ *
+ * videoconvertscale-bench.c: compare videoconvert ! videoscale with the
+ * single pass videoconvertscale
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/* Pushes the same frame into "videoconvert ! videoscale" and into
+ * videoconvertscale for a set of format and size pairs and reports frames/s
+ * and an estimate of the memory traffic: every pass reads its input frame
+ * and writes its output frame, so the chain of two elements also writes and
+ * reads back the intermediate frame.
+ *
+ * Usage: videoconvertscale-bench [num-frames]
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <gst/gst.h>
+#include <gst/video/video.h>
+
+static guint num_frames = 100;
+
+typedef struct
+{
+  const gchar *in_format;
+  gint in_width, in_height;
+  const gchar *out_format;
+  gint out_width, out_height;
+} BenchCase;
+
+static const BenchCase cases[] = {
+  {"I420", 1920, 1080, "BGRx", 1280, 720},
+  {"I420", 1280, 720, "BGRx", 1920, 1080},
+  {"YUY2", 1920, 1080, "I420", 640, 360},
+  {"NV12", 1920, 1080, "AYUV", 1280, 720},
+  {"BGRx", 1280, 720, "I420", 1920, 1080}
+};
+
+static guint received;
+static GstCaps *sink_caps;
+
+static GstFlowReturn
+chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
+{
+  received++;
+  gst_buffer_unref (buffer);
+  return GST_FLOW_OK;
+}
+
+static gboolean
+query (GstPad * pad, GstObject * parent, GstQuery * query)
+{
+  switch (GST_QUERY_TYPE (query)) {
+    case GST_QUERY_CAPS:
+      gst_query_set_caps_result (query, sink_caps);
+      return TRUE;
+    case GST_QUERY_ACCEPT_CAPS:
+      gst_query_set_accept_caps_result (query, TRUE);
+      return TRUE;
+    default:
+      return gst_pad_query_default (pad, parent, query);
+  }
+}
+
+static GstCaps *
+make_caps (const gchar * format, gint width, gint height)
+{
+  return gst_caps_new_simple ("video/x-raw",
+      "format", G_TYPE_STRING, format,
+      "width", G_TYPE_INT, width, "height", G_TYPE_INT, height,
+      "pixel-aspect-ratio", GST_TYPE_FRACTION, 1, 1,
+      "framerate", GST_TYPE_FRACTION, 30, 1, NULL);
+}
+
+static gsize
+frame_size (const gchar * format, gint width, gint height)
+{
+  GstVideoInfo info;
+
+  gst_video_info_init (&info);
+  gst_video_info_set_format (&info, gst_video_format_from_string (format),
+      width, height);
+  return info.size;
+}
+
+static gdouble
+run_bench (const gchar * desc, const BenchCase * c)
+{
+  GstElement *bin;
+  GstPad *srcpad, *sinkpad, *pad;
+  GstCaps *caps;
+  GstVideoInfo info;
+  GstBuffer *frame;
+  GstMapInfo map;
+  GstSegment segment;
+  GstClockTime start, elapsed;
+  GError *error = NULL;
+  guint i;
+
+  bin = gst_parse_bin_from_description (desc, TRUE, &error);
+  if (bin == NULL)
+    g_error ("could not make %s: %s", desc, error->message);
+  gst_object_ref_sink (bin);
+
+  srcpad = gst_pad_new ("src", GST_PAD_SRC);
+  sinkpad = gst_pad_new ("sink", GST_PAD_SINK);
+  gst_pad_set_chain_function (sinkpad, chain);
+  gst_pad_set_query_function (sinkpad, query);
+
+  pad = gst_element_get_static_pad (bin, "sink");
+  gst_pad_link (srcpad, pad);
+  gst_object_unref (pad);
+  pad = gst_element_get_static_pad (bin, "src");
+  gst_pad_link (pad, sinkpad);
+  gst_object_unref (pad);
+
+  gst_pad_set_active (srcpad, TRUE);
+  gst_pad_set_active (sinkpad, TRUE);
+  gst_element_set_state (bin, GST_STATE_PLAYING);
+
+  sink_caps = make_caps (c->out_format, c->out_width, c->out_height);
+  caps = make_caps (c->in_format, c->in_width, c->in_height);
+  gst_video_info_from_caps (&info, caps);
+
+  gst_pad_push_event (srcpad,
+      gst_event_new_stream_start ("videoconvertscale-bench"));
+  gst_pad_push_event (srcpad, gst_event_new_caps (caps));
+  gst_segment_init (&segment, GST_FORMAT_TIME);
+  gst_pad_push_event (srcpad, gst_event_new_segment (&segment));
+  gst_caps_unref (caps);
+
+  frame = gst_buffer_new_allocate (NULL, info.size, NULL);
+  gst_buffer_map (frame, &map, GST_MAP_WRITE);
+  for (i = 0; i < map.size; i++)
+    map.data[i] = (i * 7) ^ (i >> 11);
+  gst_buffer_unmap (frame, &map);
+
+  /* the first frame negotiates and sets up the converters */
+  gst_pad_push (srcpad, gst_buffer_ref (frame));
+
+  received = 0;
+  start = gst_util_get_timestamp ();
+  for (i = 0; i < num_frames; i++)
+    gst_pad_push (srcpad, gst_buffer_ref (frame));
+  elapsed = gst_util_get_timestamp () - start;
+
+  if (received != num_frames)
+    g_printerr ("%s: only %u of %u frames\n", desc, received, num_frames);
+
+  gst_buffer_unref (frame);
+  gst_caps_unref (sink_caps);
+  gst_element_set_state (bin, GST_STATE_NULL);
+  gst_object_unref (bin);
+  gst_object_unref (srcpad);
+  gst_object_unref (sinkpad);
+
+  return received * (gdouble) GST_SECOND / MAX (elapsed, 1);
+}
+
+int
+main (int argc, char *argv[])
+{
+  guint i;
+
+  gst_init (&argc, &argv);
+
+  if (argc > 1)
+    num_frames = atoi (argv[1]);
+
+  g_print ("%u frames, frames/s and estimated MB/s of memory traffic\n",
+      num_frames);
+  g_print ("%-38s %20s %20s\n", "", "convert ! scale", "convertscale");
+
+  for (i = 0; i < G_N_ELEMENTS (cases); i++) {
+    const BenchCase *c = &cases[i];
+    gsize in_size, out_size, tmp_size;
+    gdouble two, one;
+    gchar *pair;
+
+    in_size = frame_size (c->in_format, c->in_width, c->in_height);
+    out_size = frame_size (c->out_format, c->out_width, c->out_height);
+    /* videoconvert goes first and keeps the input size */
+    tmp_size = frame_size (c->out_format, c->in_width, c->in_height);
+
+    two = run_bench ("videoconvert ! videoscale", c);
+    one = run_bench ("videoconvertscale", c);
+
+    pair = g_strdup_printf ("%s %dx%d -> %s %dx%d:", c->in_format,
+        c->in_width, c->in_height, c->out_format, c->out_width,
+        c->out_height);
+    g_print ("%-38s %8.1f %11.1f %8.1f %11.1f\n", pair,
+        two, two * (in_size + 2 * tmp_size + out_size) / 1e6,
+        one, one * (in_size + out_size) / 1e6);
+    g_free (pair);
+  }
+
+  return 0;
+}
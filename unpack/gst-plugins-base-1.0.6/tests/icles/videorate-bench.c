@@ -0,0 +1,125 @@
+/* GStreamer
+ *
+ * videorate-bench.c: measure the cost of smart dropping in videorate
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/* Downsamples 60 frames/s video to 15 frames/s, as for a preview stream, with
+ * and without smart-drop. The difference between both runs is the cost of
+ * the frame analysis, which is reported per input frame. The number of output
+ * frames that start a new scene shows the analysis is really done.
+ *
+ * Usage: videorate-bench [num-frames]
+ */
+
+#include <stdlib.h>
+#include <gst/gst.h>
+#include <gst/video/gstvideometa.h>
+
+static guint num_frames = 1200;
+
+/* 16:9 frames of these widths */
+static const gint widths[] = { 640, 1280, 1920 };
+
+static void
+handoff_cb (GstElement * sink, GstBuffer * buffer, GstPad * pad,
+    guint * scene_changes)
+{
+  GstVideoSceneMeta *meta = gst_buffer_get_video_scene_meta (buffer);
+
+  if (meta && meta->scene_change)
+    (*scene_changes)++;
+}
+
+/* returns the average time per input frame in ms */
+static gdouble
+run_bench (gint width, gint height, gboolean smart_drop, guint * scene_changes)
+{
+  GstElement *pipeline, *sink;
+  GstBus *bus;
+  GstMessage *msg;
+  GstClockTime start, elapsed;
+  GError *error = NULL;
+  gchar *desc;
+
+  desc = g_strdup_printf ("videotestsrc pattern=ball num-buffers=%u ! "
+      "video/x-raw,format=I420,width=%d,height=%d,framerate=60/1 ! "
+      "videorate smart-drop=%d ! video/x-raw,framerate=15/1 ! "
+      "fakesink name=sink sync=false signal-handoffs=true", num_frames,
+      width, height, smart_drop);
+  pipeline = gst_parse_launch (desc, &error);
+  g_free (desc);
+  if (pipeline == NULL) {
+    g_printerr ("failed to create pipeline: %s\n", error->message);
+    exit (1);
+  }
+
+  *scene_changes = 0;
+  sink = gst_bin_get_by_name (GST_BIN (pipeline), "sink");
+  g_signal_connect (sink, "handoff", G_CALLBACK (handoff_cb), scene_changes);
+  gst_object_unref (sink);
+
+  bus = gst_element_get_bus (pipeline);
+  start = gst_util_get_timestamp ();
+  gst_element_set_state (pipeline, GST_STATE_PLAYING);
+  msg = gst_bus_timed_pop_filtered (bus, GST_CLOCK_TIME_NONE,
+      GST_MESSAGE_EOS | GST_MESSAGE_ERROR);
+  elapsed = gst_util_get_timestamp () - start;
+
+  if (GST_MESSAGE_TYPE (msg) == GST_MESSAGE_ERROR) {
+    gst_message_parse_error (msg, &error, NULL);
+    g_printerr ("error: %s\n", error->message);
+    exit (1);
+  }
+  gst_message_unref (msg);
+  gst_object_unref (bus);
+
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+  gst_object_unref (pipeline);
+
+  return elapsed / (gdouble) GST_MSECOND / MAX (num_frames, 1);
+}
+
+int
+main (int argc, char *argv[])
+{
+  guint i, scenes_off, scenes_on;
+  gdouble off, on;
+
+  gst_init (&argc, &argv);
+
+  if (argc > 1)
+    num_frames = atoi (argv[1]);
+
+  g_print ("%u frames of I420 at 60 frames/s to 15 frames/s, "
+      "ms per input frame\n", num_frames);
+  g_print ("%-10s %10s %10s %14s %8s\n", "", "nearest", "smart",
+      "analysis (us)", "scenes");
+
+  for (i = 0; i < G_N_ELEMENTS (widths); i++) {
+    gint width = widths[i], height = widths[i] * 9 / 16;
+    gchar *size = g_strdup_printf ("%dx%d", width, height);
+
+    off = run_bench (width, height, FALSE, &scenes_off);
+    on = run_bench (width, height, TRUE, &scenes_on);
+    g_print ("%-10s %10.3f %10.3f %14.1f %8u\n", size, off, on,
+        (on - off) * 1000.0, scenes_on);
+    g_free (size);
+  }
+
+  return 0;
+}
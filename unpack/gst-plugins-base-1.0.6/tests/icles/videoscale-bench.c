@@ -0,0 +1,286 @@
+/* GStreamer
+ *
+ * videoscale-bench.c: compare the quality and the speed of the videoscale
+ * methods
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/* For every method and a set of formats and sizes, pushes the same frame
+ * into videoscale and reports frames/s and the time of the first frame,
+ * which includes the setup of the filter. The quality is measured as the
+ * PSNR of the luma after scaling to the output size and back with the same
+ * method, against the original frame.
+ *
+ * Usage: videoscale-bench [num-frames]
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <gst/gst.h>
+#include <gst/video/video.h>
+
+static guint num_frames = 50;
+
+typedef struct
+{
+  const gchar *format;
+  gint in_width, in_height;
+  gint out_width, out_height;
+} BenchCase;
+
+static const BenchCase cases[] = {
+  {"I420", 1920, 1080, 1280, 720},
+  {"I420", 1920, 1080, 640, 360},
+  {"I420", 1280, 720, 1920, 1080},
+  {"AYUV", 1920, 1080, 1280, 720},
+  {"AYUV", 720, 576, 1280, 720}
+};
+
+/* lanczos defaults to the 32 bit integer taps, submethod 0 is the 16 bit
+ * path with the Orc vertical pass */
+static const gchar *methods[] = { "method=nearest-neighbour",
+  "method=bilinear", "method=4-tap", "method=lanczos",
+  "method=lanczos submethod=0"
+};
+
+static guint received;
+static GstCaps *sink_caps;
+static GstBuffer *last;
+
+static GstFlowReturn
+chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
+{
+  received++;
+  gst_buffer_replace (&last, buffer);
+  gst_buffer_unref (buffer);
+  return GST_FLOW_OK;
+}
+
+static gboolean
+query (GstPad * pad, GstObject * parent, GstQuery * query)
+{
+  switch (GST_QUERY_TYPE (query)) {
+    case GST_QUERY_CAPS:
+      gst_query_set_caps_result (query, sink_caps);
+      return TRUE;
+    case GST_QUERY_ACCEPT_CAPS:
+      gst_query_set_accept_caps_result (query, TRUE);
+      return TRUE;
+    default:
+      return gst_pad_query_default (pad, parent, query);
+  }
+}
+
+static GstCaps *
+make_caps (const gchar * format, gint width, gint height)
+{
+  return gst_caps_new_simple ("video/x-raw",
+      "format", G_TYPE_STRING, format,
+      "width", G_TYPE_INT, width, "height", G_TYPE_INT, height,
+      "pixel-aspect-ratio", GST_TYPE_FRACTION, 1, 1,
+      "framerate", GST_TYPE_FRACTION, 30, 1, NULL);
+}
+
+/* smooth gradients with some fine detail, like a natural picture */
+static GstBuffer *
+make_frame (GstVideoInfo * info)
+{
+  GstVideoFrame frame;
+  GstBuffer *buffer;
+  gint x, y, c;
+
+  buffer = gst_buffer_new_allocate (NULL, info->size, NULL);
+  gst_video_frame_map (&frame, info, buffer, GST_MAP_WRITE);
+  for (c = 0; c < GST_VIDEO_FRAME_N_COMPONENTS (&frame); c++) {
+    gint w = GST_VIDEO_FRAME_COMP_WIDTH (&frame, c);
+    gint h = GST_VIDEO_FRAME_COMP_HEIGHT (&frame, c);
+    gint pstride = GST_VIDEO_FRAME_COMP_PSTRIDE (&frame, c);
+
+    for (y = 0; y < h; y++) {
+      guint8 *data = GST_VIDEO_FRAME_COMP_DATA (&frame, c);
+
+      data += y * GST_VIDEO_FRAME_COMP_STRIDE (&frame, c);
+      for (x = 0; x < w; x++) {
+        gdouble v;
+
+        if (GST_VIDEO_FORMAT_INFO_IS_YUV (info->finfo) && c > 0
+            && c < 3)
+          v = 128 + 40 * sin (x * 0.01 * c) * cos (y * 0.013);
+        else if (c == 3)
+          v = 255;
+        else
+          v = 128 + 70 * sin (x * 0.011) * cos (y * 0.017) +
+              30 * sin ((x + 2 * y) * 0.35) * sin (y * 0.004);
+        data[x * pstride] = CLAMP (v, 0, 255);
+      }
+    }
+  }
+  gst_video_frame_unmap (&frame);
+
+  return buffer;
+}
+
+static gdouble
+luma_psnr (GstVideoInfo * info, GstBuffer * a, GstBuffer * b)
+{
+  GstVideoFrame fa, fb;
+  gdouble sse = 0;
+  gint x, y, w, h, pstride;
+
+  gst_video_frame_map (&fa, info, a, GST_MAP_READ);
+  gst_video_frame_map (&fb, info, b, GST_MAP_READ);
+  w = GST_VIDEO_FRAME_COMP_WIDTH (&fa, 0);
+  h = GST_VIDEO_FRAME_COMP_HEIGHT (&fa, 0);
+  pstride = GST_VIDEO_FRAME_COMP_PSTRIDE (&fa, 0);
+  for (y = 0; y < h; y++) {
+    const guint8 *da, *db;
+
+    da = (guint8 *) GST_VIDEO_FRAME_COMP_DATA (&fa, 0) +
+        y * GST_VIDEO_FRAME_COMP_STRIDE (&fa, 0);
+    db = (guint8 *) GST_VIDEO_FRAME_COMP_DATA (&fb, 0) +
+        y * GST_VIDEO_FRAME_COMP_STRIDE (&fb, 0);
+    for (x = 0; x < w; x++) {
+      gint d = da[x * pstride] - db[x * pstride];
+
+      sse += d * d;
+    }
+  }
+  gst_video_frame_unmap (&fa);
+  gst_video_frame_unmap (&fb);
+
+  if (sse == 0)
+    return 99.0;
+  return 10 * log10 (255.0 * 255.0 * w * h / sse);
+}
+
+/* pushes @frames frames through @desc, returns frames/s and the time of the
+ * first frame in @first */
+static gdouble
+run_bin (const gchar * desc, GstCaps * in_caps, GstCaps * out_caps,
+    GstBuffer * frame, guint frames, GstClockTime * first)
+{
+  GstElement *bin;
+  GstPad *srcpad, *sinkpad, *pad;
+  GstSegment segment;
+  GstClockTime start, elapsed;
+  GError *error = NULL;
+  guint i;
+
+  bin = gst_parse_bin_from_description (desc, TRUE, &error);
+  if (bin == NULL)
+    g_error ("could not make %s: %s", desc, error->message);
+  gst_object_ref_sink (bin);
+
+  srcpad = gst_pad_new ("src", GST_PAD_SRC);
+  sinkpad = gst_pad_new ("sink", GST_PAD_SINK);
+  gst_pad_set_chain_function (sinkpad, chain);
+  gst_pad_set_query_function (sinkpad, query);
+
+  pad = gst_element_get_static_pad (bin, "sink");
+  gst_pad_link (srcpad, pad);
+  gst_object_unref (pad);
+  pad = gst_element_get_static_pad (bin, "src");
+  gst_pad_link (pad, sinkpad);
+  gst_object_unref (pad);
+
+  gst_pad_set_active (srcpad, TRUE);
+  gst_pad_set_active (sinkpad, TRUE);
+  gst_element_set_state (bin, GST_STATE_PLAYING);
+
+  sink_caps = out_caps;
+  gst_pad_push_event (srcpad, gst_event_new_stream_start ("videoscale-bench"));
+  gst_pad_push_event (srcpad, gst_event_new_caps (in_caps));
+  gst_segment_init (&segment, GST_FORMAT_TIME);
+  gst_pad_push_event (srcpad, gst_event_new_segment (&segment));
+
+  start = gst_util_get_timestamp ();
+  gst_pad_push (srcpad, gst_buffer_ref (frame));
+  *first = gst_util_get_timestamp () - start;
+
+  received = 0;
+  start = gst_util_get_timestamp ();
+  for (i = 0; i < frames; i++)
+    gst_pad_push (srcpad, gst_buffer_ref (frame));
+  elapsed = gst_util_get_timestamp () - start;
+
+  if (received != frames)
+    g_printerr ("%s: only %u of %u frames\n", desc, received, frames);
+
+  gst_element_set_state (bin, GST_STATE_NULL);
+  gst_object_unref (bin);
+  gst_object_unref (srcpad);
+  gst_object_unref (sinkpad);
+
+  return received * (gdouble) GST_SECOND / MAX (elapsed, 1);
+}
+
+int
+main (int argc, char *argv[])
+{
+  guint i, j;
+
+  gst_init (&argc, &argv);
+
+  if (argc > 1)
+    num_frames = atoi (argv[1]);
+
+  g_print ("%u frames, luma PSNR of a round trip, frames/s and first frame\n",
+      num_frames);
+
+  for (i = 0; i < G_N_ELEMENTS (cases); i++) {
+    const BenchCase *c = &cases[i];
+    GstCaps *in_caps, *out_caps;
+    GstVideoInfo info;
+    GstBuffer *frame;
+
+    in_caps = make_caps (c->format, c->in_width, c->in_height);
+    out_caps = make_caps (c->format, c->out_width, c->out_height);
+    gst_video_info_from_caps (&info, in_caps);
+    frame = make_frame (&info);
+
+    g_print ("%s %dx%d -> %dx%d\n", c->format, c->in_width, c->in_height,
+        c->out_width, c->out_height);
+
+    for (j = 0; j < G_N_ELEMENTS (methods); j++) {
+      GstClockTime first, unused;
+      gdouble fps, psnr;
+      gchar *desc;
+
+      desc = g_strdup_printf ("videoscale %s", methods[j]);
+      fps = run_bin (desc, in_caps, out_caps, frame, num_frames, &first);
+      g_free (desc);
+
+      desc = g_strdup_printf ("videoscale %s ! "
+          "video/x-raw,width=%d,height=%d ! videoscale %s",
+          methods[j], c->out_width, c->out_height, methods[j]);
+      run_bin (desc, in_caps, in_caps, frame, 0, &unused);
+      g_free (desc);
+      psnr = last ? luma_psnr (&info, frame, last) : 0.0;
+      gst_buffer_replace (&last, NULL);
+
+      g_print ("  %-28s %6.2f dB %8.1f frames/s %8.2f ms\n", methods[j],
+          psnr, fps, first / (gdouble) GST_MSECOND);
+    }
+
+    gst_buffer_unref (frame);
+    gst_caps_unref (in_caps);
+    gst_caps_unref (out_caps);
+  }
+
+  return 0;
+}
@@ -0,0 +1,198 @@
+/* GStreamer
+ *
+ * gst-worker-pool-private.h: threads that run a job together with the
+ * streaming thread
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#ifndef __GST_WORKER_POOL_PRIVATE_H__
+#define __GST_WORKER_POOL_PRIVATE_H__
+
+#include <glib.h>
+#include <string.h>
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+
+G_BEGIN_DECLS
+
+/* A set of persistent threads that run the same function with the calling
+ * thread, for elements that split a frame into parts the threads pick up
+ * in any order. Only the streaming thread uses the pool, the
+ * functions are not thread-safe against each other. */
+
+typedef void (*GstWorkerPoolFunc) (gpointer data);
+
+typedef struct
+{
+  const gchar *name;
+
+  /* the threads besides the calling one */
+  GThread **threads;
+  guint n_threads;
+
+  GMutex lock;
+  GCond cond;
+  GCond done_cond;
+  GstWorkerPoolFunc func;
+  gpointer data;
+  guint cookie;
+  guint pending;
+  gboolean shutdown;
+} GstWorkerPool;
+
+static inline gpointer
+gst_worker_pool_thread (GstWorkerPool * pool)
+{
+  guint cookie = 0;
+
+  g_mutex_lock (&pool->lock);
+  while (TRUE) {
+    while (!pool->shutdown && pool->cookie == cookie)
+      g_cond_wait (&pool->cond, &pool->lock);
+    if (pool->shutdown)
+      break;
+    cookie = pool->cookie;
+    g_mutex_unlock (&pool->lock);
+
+    pool->func (pool->data);
+
+    g_mutex_lock (&pool->lock);
+    if (--pool->pending == 0)
+      g_cond_signal (&pool->done_cond);
+  }
+  g_mutex_unlock (&pool->lock);
+
+  return NULL;
+}
+
+/* @name is the name of the threads, it has to stay valid */
+static inline void
+gst_worker_pool_init (GstWorkerPool * pool, const gchar * name)
+{
+  memset (pool, 0, sizeof (GstWorkerPool));
+  pool->name = name;
+  g_mutex_init (&pool->lock);
+  g_cond_init (&pool->cond);
+  g_cond_init (&pool->done_cond);
+}
+
+static inline void
+gst_worker_pool_stop (GstWorkerPool * pool)
+{
+  guint i;
+
+  if (pool->threads == NULL)
+    return;
+
+  g_mutex_lock (&pool->lock);
+  pool->shutdown = TRUE;
+  g_cond_broadcast (&pool->cond);
+  g_mutex_unlock (&pool->lock);
+
+  for (i = 0; i < pool->n_threads; i++)
+    g_thread_join (pool->threads[i]);
+  g_free (pool->threads);
+  pool->threads = NULL;
+  pool->n_threads = 0;
+  pool->shutdown = FALSE;
+}
+
+static inline void
+gst_worker_pool_clear (GstWorkerPool * pool)
+{
+  gst_worker_pool_stop (pool);
+  g_mutex_clear (&pool->lock);
+  g_cond_clear (&pool->cond);
+  g_cond_clear (&pool->done_cond);
+}
+
+/* the number of threads the pool runs a job with, including the calling
+ * thread */
+static inline guint
+gst_worker_pool_get_n_threads (GstWorkerPool * pool)
+{
+  return pool->n_threads + 1;
+}
+
+/* starts or stops threads so that @n_threads threads, including the calling
+ * thread, run the next jobs */
+static inline void
+gst_worker_pool_set_n_threads (GstWorkerPool * pool, guint n_threads)
+{
+  guint i;
+
+  n_threads = MAX (n_threads, 1);
+  if (n_threads == pool->n_threads + 1)
+    return;
+
+  gst_worker_pool_stop (pool);
+  if (n_threads < 2)
+    return;
+
+  pool->cookie = 0;
+  pool->n_threads = n_threads - 1;
+  pool->threads = g_new (GThread *, pool->n_threads);
+  for (i = 0; i < pool->n_threads; i++)
+    pool->threads[i] = g_thread_new (pool->name,
+        (GThreadFunc) gst_worker_pool_thread, pool);
+}
+
+/* calls @func with @data in all threads of the pool and in the calling
+ * thread, and returns when all calls returned */
+static inline void
+gst_worker_pool_run (GstWorkerPool * pool, GstWorkerPoolFunc func,
+    gpointer data)
+{
+  if (pool->n_threads > 0) {
+    g_mutex_lock (&pool->lock);
+    pool->func = func;
+    pool->data = data;
+    pool->pending = pool->n_threads;
+    pool->cookie++;
+    g_cond_broadcast (&pool->cond);
+    g_mutex_unlock (&pool->lock);
+  }
+
+  func (data);
+
+  if (pool->n_threads > 0) {
+    g_mutex_lock (&pool->lock);
+    while (pool->pending > 0)
+      g_cond_wait (&pool->done_cond, &pool->lock);
+    pool->func = NULL;
+    pool->data = NULL;
+    g_mutex_unlock (&pool->lock);
+  }
+}
+
+/* the number of threads for a "n-threads" property value of 0 */
+static inline guint
+gst_worker_pool_get_n_cpus (void)
+{
+#if GLIB_CHECK_VERSION(2,36,0)
+  return g_get_num_processors ();
+#elif defined (_SC_NPROCESSORS_ONLN)
+  return MAX (1, sysconf (_SC_NPROCESSORS_ONLN));
+#else
+  return 1;
+#endif
+}
+
+G_END_DECLS
+
+#endif /* __GST_WORKER_POOL_PRIVATE_H__ */
@@ -46,6 +46,7 @@
 
 #include "gstdeinterlace.h"
 #include "tvtime/plugins.h"
+#include "yadif.h"
 
 #include <string.h>
 
@@ -65,6 +66,7 @@ GST_DEBUG_CATEGORY_STATIC (deinterlace_debug);
 #define DEFAULT_LOCKING         GST_DEINTERLACE_LOCKING_NONE
 #define DEFAULT_IGNORE_OBSCURE  TRUE
 #define DEFAULT_DROP_ORPHANS    TRUE
+#define DEFAULT_N_THREADS       1
 
 enum
 {
@@ -76,6 +78,7 @@ enum
   PROP_LOCKING,
   PROP_IGNORE_OBSCURE,
   PROP_DROP_ORPHANS,
+  PROP_N_THREADS,
   PROP_LAST
 };
 
@@ -164,6 +167,8 @@ static const GEnumValue methods_types[] = {
       "weavetff"},
   {GST_DEINTERLACE_WEAVE_BFF, "Progressive: Bottom Field First (Do Not Use)",
       "weavebff"},
+  {GST_DEINTERLACE_YADIF, "Motion Adaptive: Edge Directed Interpolation",
+      "yadif"},
   {0, NULL, NULL},
 };
 
@@ -365,12 +370,50 @@ static const struct
   gst_deinterlace_method_scaler_bob_get_type}, {
   gst_deinterlace_method_weave_get_type}, {
   gst_deinterlace_method_weave_tff_get_type}, {
-  gst_deinterlace_method_weave_bff_get_type}
+  gst_deinterlace_method_weave_bff_get_type}, {
+  gst_deinterlace_method_yadif_get_type}
 };
 
+/* the number of threads to deinterlace the next frame with */
+static guint
+gst_deinterlace_get_n_threads (GstDeinterlace * self)
+{
+  guint n_threads;
+
+  GST_OBJECT_LOCK (self);
+  n_threads = self->n_threads;
+  self->n_threads_changed = FALSE;
+  GST_OBJECT_UNLOCK (self);
+
+  if (n_threads == 0)
+    n_threads = gst_worker_pool_get_n_cpus ();
+  return CLAMP (n_threads, 1, GST_DEINTERLACE_MAX_THREADS);
+}
+
+static void
+gst_deinterlace_update_n_threads (GstDeinterlace * self)
+{
+  gboolean changed;
+
+  GST_OBJECT_LOCK (self);
+  changed = self->n_threads_changed;
+  GST_OBJECT_UNLOCK (self);
+
+  if (G_UNLIKELY (changed)) {
+    guint n_threads = gst_deinterlace_get_n_threads (self);
+
+    GST_DEBUG_OBJECT (self, "deinterlacing with %u threads", n_threads);
+    gst_deinterlace_method_set_n_threads (self->method, n_threads);
+  }
+}
+
+/* only called from the streaming thread, or when not streaming. The
+ * method is replaced with the object lock so that queries don't see a
+ * method that is being freed */
 static void
 gst_deinterlace_set_method (GstDeinterlace * self, GstDeinterlaceMethods method)
 {
+  GstDeinterlaceMethod *old_method, *new_method;
   GType method_type;
   gint width, height;
   GstVideoFormat format;
@@ -391,9 +434,13 @@ gst_deinterlace_set_method (GstDeinterlace * self, GstDeinterlaceMethods method)
 #if 0
     gst_child_proxy_child_removed (GST_OBJECT (self),
         GST_OBJECT (self->method));
-    gst_object_unparent (GST_OBJECT (self->method));
-    self->method = NULL;
 #endif
+    GST_OBJECT_LOCK (self);
+    old_method = self->method;
+    self->method = NULL;
+    GST_OBJECT_UNLOCK (self);
+    /* also stops the threads of the method */
+    gst_object_unparent (GST_OBJECT (old_method));
   }
 
   method_type =
@@ -423,16 +470,22 @@ gst_deinterlace_set_method (GstDeinterlace * self, GstDeinterlaceMethods method)
     g_assert (method_type != G_TYPE_INVALID);
   }
 
-  self->method = g_object_new (method_type, "name", "method", NULL);
-  self->method_id = method;
+  new_method = g_object_new (method_type, "name", "method", NULL);
+  gst_object_set_parent (GST_OBJECT (new_method), GST_OBJECT (self));
 
-  gst_object_set_parent (GST_OBJECT (self->method), GST_OBJECT (self));
+  GST_OBJECT_LOCK (self);
+  self->method = new_method;
+  self->method_id = method;
+  GST_OBJECT_UNLOCK (self);
 #if 0
   gst_child_proxy_child_added (GST_OBJECT (self), GST_OBJECT (self->method));
 #endif
 
-  if (self->method)
+  if (self->method) {
     gst_deinterlace_method_setup (self->method, &self->vinfo);
+    gst_deinterlace_method_set_n_threads (self->method,
+        gst_deinterlace_get_n_threads (self));
+  }
 }
 
 static gboolean
@@ -588,6 +641,13 @@ gst_deinterlace_class_init (GstDeinterlaceClass * klass)
    * Progressive: Bottom Field First.  Bad quality, do not use.
    * </para>
    * </listitem>
+   * <listitem>
+   * <para>
+   * yadif
+   * Motion Adaptive: Edge Directed Interpolation.  Interpolates moving
+   * areas along edges and keeps the full resolution of static areas.
+   * </para>
+   * </listitem>
    * </itemizedlist>
    */
   g_object_class_install_property (gobject_class, PROP_METHOD,
@@ -672,6 +732,20 @@ gst_deinterlace_class_init (GstDeinterlaceClass * klass)
           "active locking mode.", DEFAULT_DROP_ORPHANS,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstDeinterlace:n-threads
+   *
+   * The number of threads that deinterlace a frame, including the streaming
+   * thread. Every thread does a band of the lines of the output frame. Only
+   * the methods that work line by line (all but tomsmocomp and greedyh) use
+   * more than one thread. 0 uses one thread per CPU.
+   */
+  g_object_class_install_property (gobject_class, PROP_N_THREADS,
+      g_param_spec_uint ("n-threads", "Threads",
+          "Number of threads to deinterlace with (0 = one per CPU)", 0,
+          GST_DEINTERLACE_MAX_THREADS, DEFAULT_N_THREADS,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   element_class->change_state =
       GST_DEBUG_FUNCPTR (gst_deinterlace_change_state);
 }
@@ -728,6 +802,7 @@ gst_deinterlace_init (GstDeinterlace * self)
 
   self->mode = DEFAULT_MODE;
   self->user_set_method_id = DEFAULT_METHOD;
+  self->n_threads = DEFAULT_N_THREADS;
   gst_video_info_init (&self->vinfo);
   gst_deinterlace_set_method (self, self->user_set_method_id);
   self->fields = DEFAULT_FIELDS;
@@ -879,10 +954,22 @@ gst_deinterlace_set_property (GObject * object, guint prop_id,
       GST_OBJECT_UNLOCK (self);
       break;
     }
-    case PROP_METHOD:
-      self->user_set_method_id = g_value_get_enum (value);
-      gst_deinterlace_set_method (self, self->user_set_method_id);
+    case PROP_METHOD:{
+      gint new_method;
+      gboolean streaming;
+
+      GST_OBJECT_LOCK (self);
+      new_method = g_value_get_enum (value);
+      self->user_set_method_id = new_method;
+      /* the streaming thread may be deinterlacing with the current method,
+       * it switches to the new one itself before the next frame */
+      streaming = gst_pad_has_current_caps (self->srcpad);
+      GST_OBJECT_UNLOCK (self);
+
+      if (!streaming)
+        gst_deinterlace_set_method (self, new_method);
       break;
+    }
     case PROP_FIELDS:{
       gint new_fields;
 
@@ -910,6 +997,12 @@ gst_deinterlace_set_property (GObject * object, guint prop_id,
     case PROP_DROP_ORPHANS:
       self->drop_orphans = g_value_get_boolean (value);
       break;
+    case PROP_N_THREADS:
+      GST_OBJECT_LOCK (self);
+      self->n_threads = g_value_get_uint (value);
+      self->n_threads_changed = TRUE;
+      GST_OBJECT_UNLOCK (self);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (self, prop_id, pspec);
   }
@@ -929,7 +1022,9 @@ gst_deinterlace_get_property (GObject * object, guint prop_id,
       g_value_set_enum (value, self->mode);
       break;
     case PROP_METHOD:
+      GST_OBJECT_LOCK (self);
       g_value_set_enum (value, self->user_set_method_id);
+      GST_OBJECT_UNLOCK (self);
       break;
     case PROP_FIELDS:
       g_value_set_enum (value, self->fields);
@@ -946,6 +1041,11 @@ gst_deinterlace_get_property (GObject * object, guint prop_id,
     case PROP_DROP_ORPHANS:
       g_value_set_boolean (value, self->drop_orphans);
       break;
+    case PROP_N_THREADS:
+      GST_OBJECT_LOCK (self);
+      g_value_set_uint (value, self->n_threads);
+      GST_OBJECT_UNLOCK (self);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (self, prop_id, pspec);
   }
@@ -1496,6 +1596,7 @@ gst_deinterlace_output_frame (GstDeinterlace * self, gboolean flushing)
   gboolean flush_one;           /* used for flushing one field when in high latency mode and not locked */
   TelecinePattern pattern;
   guint8 phase, count;
+  GstDeinterlaceMethods method;
   const GstDeinterlaceLocking locking = self->locking;
 
 restart:
@@ -1682,7 +1783,10 @@ restart:
      * method. At this point the fields to be processed are either definitely
      * interlaced or we do not yet know that we have a telecine pattern lock
      * and so the best we can do is to deinterlace the fields. */
-    gst_deinterlace_set_method (self, self->user_set_method_id);
+    GST_OBJECT_LOCK (self);
+    method = self->user_set_method_id;
+    GST_OBJECT_UNLOCK (self);
+    gst_deinterlace_set_method (self, method);
     fields_required = gst_deinterlace_method_get_fields_required (self->method);
     if (flushing && self->history_count < fields_required) {
       /* note: we already checked for flushing with history count == 1 above
@@ -1787,6 +1891,7 @@ restart:
           gst_video_frame_new_and_map (&self->vinfo, outbuf, GST_MAP_WRITE);
 
       /* do magic calculus */
+      gst_deinterlace_update_n_threads (self);
       gst_deinterlace_method_deinterlace_frame (self->method,
           self->field_history, self->history_count, outframe,
           self->cur_field_idx);
@@ -1912,6 +2017,7 @@ restart:
           gst_video_frame_new_and_map (&self->vinfo, outbuf, GST_MAP_WRITE);
 
       /* do magic calculus */
+      gst_deinterlace_update_n_threads (self);
       gst_deinterlace_method_deinterlace_frame (self->method,
           self->field_history, self->history_count, outframe,
           self->cur_field_idx);
@@ -2710,12 +2816,14 @@ gst_deinterlace_src_query (GstPad * pad, GstObject * parent, GstQuery * query)
             gint fields_required = 0;
             gint method_latency = 0;
 
+            GST_OBJECT_LOCK (self);
             if (self->method) {
               fields_required =
                   gst_deinterlace_method_get_fields_required (self->method);
               method_latency =
                   gst_deinterlace_method_get_latency (self->method);
             }
+            GST_OBJECT_UNLOCK (self);
 
             gst_query_parse_latency (query, &live, &min, &max);
 
@@ -56,7 +56,8 @@ typedef enum
   GST_DEINTERLACE_SCALER_BOB,
   GST_DEINTERLACE_WEAVE,
   GST_DEINTERLACE_WEAVE_TFF,
-  GST_DEINTERLACE_WEAVE_BFF
+  GST_DEINTERLACE_WEAVE_BFF,
+  GST_DEINTERLACE_YADIF
 } GstDeinterlaceMethods;
 
 typedef enum
@@ -87,6 +88,8 @@ typedef enum
   GST_DEINTERLACE_LOCKING_PASSIVE,
 } GstDeinterlaceLocking;
 
+#define GST_DEINTERLACE_MAX_THREADS 64
+
 #define GST_DEINTERLACE_MAX_FIELD_HISTORY 10
 #define GST_DEINTERLACE_MAX_BUFFER_STATE_HISTORY 50
 /* check max field history is large enough */
@@ -189,6 +192,9 @@ struct _GstDeinterlace
 
   gboolean need_more;
   gboolean have_eos;
+
+  guint n_threads;
+  gboolean n_threads_changed;
 };
 
 struct _GstDeinterlaceClass
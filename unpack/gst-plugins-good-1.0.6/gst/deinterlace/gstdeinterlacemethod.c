@@ -197,6 +197,7 @@ static void
 gst_deinterlace_method_init (GstDeinterlaceMethod * self)
 {
   self->vinfo = NULL;
+  self->n_threads = 1;
 }
 
 void
@@ -225,6 +226,15 @@ gst_deinterlace_method_get_latency (GstDeinterlaceMethod * self)
   return klass->latency;
 }
 
+/* only called from the streaming thread, the method starts or stops its
+ * threads on the next frame */
+void
+gst_deinterlace_method_set_n_threads (GstDeinterlaceMethod * self,
+    guint n_threads)
+{
+  self->n_threads = MAX (n_threads, 1);
+}
+
 G_DEFINE_ABSTRACT_TYPE (GstDeinterlaceSimpleMethod,
     gst_deinterlace_simple_method, GST_TYPE_DEINTERLACE_METHOD);
 
@@ -297,69 +307,53 @@ gst_deinterlace_simple_method_supported (GstDeinterlaceMethodClass * mklass,
   }
 }
 
-static void
-    gst_deinterlace_simple_method_interpolate_scanline_packed
-    (GstDeinterlaceSimpleMethod * self, guint8 * out,
-    const GstDeinterlaceScanlineData * scanlines)
-{
-  memcpy (out, scanlines->m1, self->parent.row_stride[0]);
-}
-
-static void
-gst_deinterlace_simple_method_copy_scanline_packed (GstDeinterlaceSimpleMethod *
-    self, guint8 * out, const GstDeinterlaceScanlineData * scanlines)
+typedef struct
 {
-  memcpy (out, scanlines->m0, self->parent.row_stride[0]);
-}
-
-static void
-gst_deinterlace_simple_method_deinterlace_frame_packed (GstDeinterlaceMethod *
-    method, const GstDeinterlaceField * history, guint history_count,
-    GstVideoFrame * outframe, gint cur_field_idx)
-{
-  GstDeinterlaceSimpleMethod *self = GST_DEINTERLACE_SIMPLE_METHOD (method);
-  GstDeinterlaceMethodClass *dm_class = GST_DEINTERLACE_METHOD_GET_CLASS (self);
-  GstDeinterlaceScanlineData scanlines;
   guint8 *dest;
   const guint8 *field0, *field1, *field2, *fieldp;
-  guint cur_field_flags = history[cur_field_idx].flags;
-  gint i;
-  gint frame_height = GST_VIDEO_INFO_HEIGHT (self->parent.vinfo);
-  gint stride = self->parent.row_stride[0];
-
-  g_assert (self->interpolate_scanline_packed != NULL);
-  g_assert (self->copy_scanline_packed != NULL);
-
-  if (cur_field_idx > 0) {
-    fieldp = GST_VIDEO_FRAME_COMP_DATA (history[cur_field_idx - 1].frame, 0);
-  } else {
-    fieldp = NULL;
-  }
-
-  dest = GST_VIDEO_FRAME_COMP_DATA (outframe, 0);
-
-  field0 = GST_VIDEO_FRAME_COMP_DATA (history[cur_field_idx].frame, 0);
-
-  g_assert (dm_class->fields_required <= 4);
+  gint plane;
+  GstDeinterlaceSimpleMethodFunction copy_scanline;
+  GstDeinterlaceSimpleMethodFunction interpolate_scanline;
+} GstDeinterlaceSimpleMethodPlane;
 
-  if (cur_field_idx + 1 < history_count) {
-    field1 = GST_VIDEO_FRAME_COMP_DATA (history[cur_field_idx + 1].frame, 0);
-  } else {
-    field1 = NULL;
-  }
+/* the lines of every plane are split into one band per thread, the bands
+ * are picked up by the threads in any order */
+typedef struct
+{
+  GstDeinterlaceSimpleMethod *self;
 
-  if (cur_field_idx + 2 < history_count) {
-    field2 = GST_VIDEO_FRAME_COMP_DATA (history[cur_field_idx + 2].frame, 0);
-  } else {
-    field2 = NULL;
-  }
+  GstDeinterlaceSimpleMethodPlane planes[3];
+  gint n_planes;
+  guint cur_field_flags;
+  gint n_bands;
+  gint n_items;
+  gint next_item;
+} GstDeinterlaceSimpleMethodJob;
 
 #define CLAMP_LOW(i) (((i)<0) ? (i+2) : (i))
 #define CLAMP_HI(i) (((i)>=(frame_height)) ? (i-2) : (i))
 #define LINE(x,i) ((x) + CLAMP_HI(CLAMP_LOW(i)) * (stride))
 #define LINE2(x,i) ((x) ? LINE(x,i) : NULL)
 
-  for (i = 0; i < frame_height; i++) {
+/* deinterlaces the lines @start to @end of a plane, every line only depends
+ * on the input fields so bands of lines can be done in parallel */
+static void
+gst_deinterlace_simple_method_deinterlace_lines (GstDeinterlaceSimpleMethod *
+    self, const GstDeinterlaceSimpleMethodPlane * p, guint cur_field_flags,
+    gint start, gint end)
+{
+  GstDeinterlaceScanlineData scanlines;
+  const guint8 *field0 = p->field0, *field1 = p->field1;
+  const guint8 *field2 = p->field2, *fieldp = p->fieldp;
+  guint8 *dest = p->dest;
+  gint i;
+  gint frame_height = self->parent.height[p->plane];
+  gint stride = self->parent.row_stride[p->plane];
+
+  g_assert (p->interpolate_scanline != NULL);
+  g_assert (p->copy_scanline != NULL);
+
+  for (i = start; i < end; i++) {
     memset (&scanlines, 0, sizeof (scanlines));
     scanlines.bottom_field = (cur_field_flags == PICTURE_INTERLACED_BOTTOM);
 
@@ -379,7 +373,7 @@ gst_deinterlace_simple_method_deinterlace_frame_packed (GstDeinterlaceMethod *
       scanlines.m2 = LINE2 (field2, i);
       scanlines.bb2 = LINE2 (field2, (i + 2 < frame_height ? i + 2 : i));
 
-      self->copy_scanline_packed (self, LINE (dest, i), &scanlines);
+      p->copy_scanline (self, LINE (dest, i), &scanlines);
     } else {
       /* interpolating */
       scanlines.ttp = LINE2 (fieldp, (i - 2 >= 0) ? i - 2 : i);
@@ -396,11 +390,107 @@ gst_deinterlace_simple_method_deinterlace_frame_packed (GstDeinterlaceMethod *
       scanlines.t2 = LINE2 (field2, i - 1);
       scanlines.b2 = LINE2 (field2, i + 1);
 
-      self->interpolate_scanline_packed (self, LINE (dest, i), &scanlines);
+      p->interpolate_scanline (self, LINE (dest, i), &scanlines);
     }
   }
 }
 
+static void
+gst_deinterlace_simple_method_run_bands (GstDeinterlaceSimpleMethodJob * job)
+{
+  GstDeinterlaceSimpleMethod *self = job->self;
+  const GstDeinterlaceSimpleMethodPlane *p;
+  gint item, band, height;
+
+  while ((item = g_atomic_int_add (&job->next_item, 1)) < job->n_items) {
+    p = &job->planes[item / job->n_bands];
+    band = item % job->n_bands;
+    height = self->parent.height[p->plane];
+
+    gst_deinterlace_simple_method_deinterlace_lines (self, p,
+        job->cur_field_flags, height * band / job->n_bands,
+        height * (band + 1) / job->n_bands);
+  }
+}
+
+static void
+gst_deinterlace_simple_method_run_job (GstDeinterlaceSimpleMethod * self,
+    GstDeinterlaceSimpleMethodJob * job)
+{
+  gst_worker_pool_set_n_threads (&self->workers, self->parent.n_threads);
+
+  job->self = self;
+  job->n_bands = gst_worker_pool_get_n_threads (&self->workers);
+  job->n_items = job->n_planes * job->n_bands;
+  job->next_item = 0;
+
+  gst_worker_pool_run (&self->workers,
+      (GstWorkerPoolFunc) gst_deinterlace_simple_method_run_bands, job);
+}
+
+static void
+    gst_deinterlace_simple_method_interpolate_scanline_packed
+    (GstDeinterlaceSimpleMethod * self, guint8 * out,
+    const GstDeinterlaceScanlineData * scanlines)
+{
+  memcpy (out, scanlines->m1, self->parent.row_stride[0]);
+}
+
+static void
+gst_deinterlace_simple_method_copy_scanline_packed (GstDeinterlaceSimpleMethod *
+    self, guint8 * out, const GstDeinterlaceScanlineData * scanlines)
+{
+  memcpy (out, scanlines->m0, self->parent.row_stride[0]);
+}
+
+static void
+gst_deinterlace_simple_method_deinterlace_frame_packed (GstDeinterlaceMethod *
+    method, const GstDeinterlaceField * history, guint history_count,
+    GstVideoFrame * outframe, gint cur_field_idx)
+{
+  GstDeinterlaceSimpleMethod *self = GST_DEINTERLACE_SIMPLE_METHOD (method);
+  GstDeinterlaceMethodClass *dm_class = GST_DEINTERLACE_METHOD_GET_CLASS (self);
+  GstDeinterlaceSimpleMethodJob job;
+  GstDeinterlaceSimpleMethodPlane *p = &job.planes[0];
+
+  g_assert (self->interpolate_scanline_packed != NULL);
+  g_assert (self->copy_scanline_packed != NULL);
+
+  if (cur_field_idx > 0) {
+    p->fieldp = GST_VIDEO_FRAME_COMP_DATA (history[cur_field_idx - 1].frame, 0);
+  } else {
+    p->fieldp = NULL;
+  }
+
+  p->dest = GST_VIDEO_FRAME_COMP_DATA (outframe, 0);
+
+  p->field0 = GST_VIDEO_FRAME_COMP_DATA (history[cur_field_idx].frame, 0);
+
+  g_assert (dm_class->fields_required <= 4);
+
+  if (cur_field_idx + 1 < history_count) {
+    p->field1 =
+        GST_VIDEO_FRAME_COMP_DATA (history[cur_field_idx + 1].frame, 0);
+  } else {
+    p->field1 = NULL;
+  }
+
+  if (cur_field_idx + 2 < history_count) {
+    p->field2 =
+        GST_VIDEO_FRAME_COMP_DATA (history[cur_field_idx + 2].frame, 0);
+  } else {
+    p->field2 = NULL;
+  }
+
+  p->plane = 0;
+  p->copy_scanline = self->copy_scanline_packed;
+  p->interpolate_scanline = self->interpolate_scanline_packed;
+
+  job.n_planes = 1;
+  job.cur_field_flags = history[cur_field_idx].flags;
+  gst_deinterlace_simple_method_run_job (self, &job);
+}
+
 static void
     gst_deinterlace_simple_method_interpolate_scanline_planar_y
     (GstDeinterlaceSimpleMethod * self, guint8 * out,
@@ -446,64 +536,6 @@ gst_deinterlace_simple_method_copy_scanline_planar_v (GstDeinterlaceSimpleMethod
   memcpy (out, scanlines->m0, self->parent.row_stride[2]);
 }
 
-static void
-    gst_deinterlace_simple_method_deinterlace_frame_planar_plane
-    (GstDeinterlaceSimpleMethod * self, guint8 * dest, const guint8 * field0,
-    const guint8 * field1, const guint8 * field2, const guint8 * fieldp,
-    guint cur_field_flags,
-    gint plane, GstDeinterlaceSimpleMethodFunction copy_scanline,
-    GstDeinterlaceSimpleMethodFunction interpolate_scanline)
-{
-  GstDeinterlaceScanlineData scanlines;
-  gint i;
-  gint frame_height = self->parent.height[plane];
-  gint stride = self->parent.row_stride[plane];
-
-  g_assert (interpolate_scanline != NULL);
-  g_assert (copy_scanline != NULL);
-
-  for (i = 0; i < frame_height; i++) {
-    memset (&scanlines, 0, sizeof (scanlines));
-    scanlines.bottom_field = (cur_field_flags == PICTURE_INTERLACED_BOTTOM);
-
-    if (!((i & 1) ^ scanlines.bottom_field)) {
-      /* copying */
-      scanlines.tp = LINE2 (fieldp, i - 1);
-      scanlines.bp = LINE2 (fieldp, i + 1);
-
-      scanlines.tt0 = LINE2 (field0, (i - 2 >= 0) ? i - 2 : i);
-      scanlines.m0 = LINE2 (field0, i);
-      scanlines.bb0 = LINE2 (field0, (i + 2 < frame_height ? i + 2 : i));
-
-      scanlines.t1 = LINE2 (field1, i - 1);
-      scanlines.b1 = LINE2 (field1, i + 1);
-
-      scanlines.tt2 = LINE2 (field2, (i - 2 >= 0) ? i - 2 : i);
-      scanlines.m2 = LINE2 (field2, i);
-      scanlines.bb2 = LINE2 (field2, (i + 2 < frame_height ? i + 2 : i));
-
-      copy_scanline (self, LINE (dest, i), &scanlines);
-    } else {
-      /* interpolating */
-      scanlines.ttp = LINE2 (fieldp, (i - 2 >= 0) ? i - 2 : i);
-      scanlines.mp = LINE2 (fieldp, i);
-      scanlines.bbp = LINE2 (fieldp, (i + 2 < frame_height ? i + 2 : i));
-
-      scanlines.t0 = LINE2 (field0, i - 1);
-      scanlines.b0 = LINE2 (field0, i + 1);
-
-      scanlines.tt1 = LINE2 (field1, (i - 2 >= 0) ? i - 2 : i);
-      scanlines.m1 = LINE2 (field1, i);
-      scanlines.bb1 = LINE2 (field1, (i + 2 < frame_height ? i + 2 : i));
-
-      scanlines.t2 = LINE2 (field2, i - 1);
-      scanlines.b2 = LINE2 (field2, i + 1);
-
-      interpolate_scanline (self, LINE (dest, i), &scanlines);
-    }
-  }
-}
-
 static void
 gst_deinterlace_simple_method_deinterlace_frame_planar (GstDeinterlaceMethod *
     method, const GstDeinterlaceField * history, guint history_count,
@@ -511,12 +543,9 @@ gst_deinterlace_simple_method_deinterlace_frame_planar (GstDeinterlaceMethod *
 {
   GstDeinterlaceSimpleMethod *self = GST_DEINTERLACE_SIMPLE_METHOD (method);
   GstDeinterlaceMethodClass *dm_class = GST_DEINTERLACE_METHOD_GET_CLASS (self);
-  guint8 *out;
-  const guint8 *field0, *field1, *field2, *fieldp;
-  guint cur_field_flags = history[cur_field_idx].flags;
+  GstDeinterlaceSimpleMethodJob job;
+  GstDeinterlaceSimpleMethodPlane *p;
   gint i;
-  GstDeinterlaceSimpleMethodFunction copy_scanline;
-  GstDeinterlaceSimpleMethodFunction interpolate_scanline;
 
   g_assert (self->interpolate_scanline_planar[0] != NULL);
   g_assert (self->interpolate_scanline_planar[1] != NULL);
@@ -526,34 +555,40 @@ gst_deinterlace_simple_method_deinterlace_frame_planar (GstDeinterlaceMethod *
   g_assert (self->copy_scanline_planar[2] != NULL);
 
   for (i = 0; i < 3; i++) {
-    copy_scanline = self->copy_scanline_planar[i];
-    interpolate_scanline = self->interpolate_scanline_planar[i];
+    p = &job.planes[i];
 
-    out = GST_VIDEO_FRAME_PLANE_DATA (outframe, i);
+    p->copy_scanline = self->copy_scanline_planar[i];
+    p->interpolate_scanline = self->interpolate_scanline_planar[i];
+    p->plane = i;
 
-    fieldp = NULL;
+    p->dest = GST_VIDEO_FRAME_PLANE_DATA (outframe, i);
+
+    p->fieldp = NULL;
     if (cur_field_idx > 0) {
-      fieldp = GST_VIDEO_FRAME_PLANE_DATA (history[cur_field_idx - 1].frame, i);
+      p->fieldp =
+          GST_VIDEO_FRAME_PLANE_DATA (history[cur_field_idx - 1].frame, i);
     }
 
-    field0 = GST_VIDEO_FRAME_PLANE_DATA (history[cur_field_idx].frame, i);
+    p->field0 = GST_VIDEO_FRAME_PLANE_DATA (history[cur_field_idx].frame, i);
 
     g_assert (dm_class->fields_required <= 4);
 
-    field1 = NULL;
+    p->field1 = NULL;
     if (cur_field_idx + 1 < history_count) {
-      field1 = GST_VIDEO_FRAME_PLANE_DATA (history[cur_field_idx + 1].frame, i);
+      p->field1 =
+          GST_VIDEO_FRAME_PLANE_DATA (history[cur_field_idx + 1].frame, i);
     }
 
-    field2 = NULL;
+    p->field2 = NULL;
     if (cur_field_idx + 2 < history_count) {
-      field2 = GST_VIDEO_FRAME_PLANE_DATA (history[cur_field_idx + 2].frame, i);
+      p->field2 =
+          GST_VIDEO_FRAME_PLANE_DATA (history[cur_field_idx + 2].frame, i);
     }
-
-    gst_deinterlace_simple_method_deinterlace_frame_planar_plane (self, out,
-        field0, field1, field2, fieldp, cur_field_flags, i, copy_scanline,
-        interpolate_scanline);
   }
+
+  job.n_planes = 3;
+  job.cur_field_flags = history[cur_field_idx].flags;
+  gst_deinterlace_simple_method_run_job (self, &job);
 }
 
 static void
@@ -563,40 +598,48 @@ gst_deinterlace_simple_method_deinterlace_frame_nv12 (GstDeinterlaceMethod *
 {
   GstDeinterlaceSimpleMethod *self = GST_DEINTERLACE_SIMPLE_METHOD (method);
   GstDeinterlaceMethodClass *dm_class = GST_DEINTERLACE_METHOD_GET_CLASS (self);
-  guint8 *out;
-  const guint8 *field0, *field1, *field2, *fieldp;
-  guint cur_field_flags = history[cur_field_idx].flags;
+  GstDeinterlaceSimpleMethodJob job;
+  GstDeinterlaceSimpleMethodPlane *p;
   gint i;
 
   g_assert (self->interpolate_scanline_packed != NULL);
   g_assert (self->copy_scanline_packed != NULL);
 
   for (i = 0; i < 2; i++) {
-    out = GST_VIDEO_FRAME_PLANE_DATA (outframe, i);
+    p = &job.planes[i];
+
+    p->copy_scanline = self->copy_scanline_packed;
+    p->interpolate_scanline = self->interpolate_scanline_packed;
+    p->plane = i;
 
-    fieldp = NULL;
+    p->dest = GST_VIDEO_FRAME_PLANE_DATA (outframe, i);
+
+    p->fieldp = NULL;
     if (cur_field_idx > 0) {
-      fieldp = GST_VIDEO_FRAME_PLANE_DATA (history[cur_field_idx - 1].frame, i);
+      p->fieldp =
+          GST_VIDEO_FRAME_PLANE_DATA (history[cur_field_idx - 1].frame, i);
     }
 
-    field0 = GST_VIDEO_FRAME_PLANE_DATA (history[cur_field_idx].frame, i);
+    p->field0 = GST_VIDEO_FRAME_PLANE_DATA (history[cur_field_idx].frame, i);
 
     g_assert (dm_class->fields_required <= 4);
 
-    field1 = NULL;
+    p->field1 = NULL;
     if (cur_field_idx + 1 < history_count) {
-      field1 = GST_VIDEO_FRAME_PLANE_DATA (history[cur_field_idx + 1].frame, i);
+      p->field1 =
+          GST_VIDEO_FRAME_PLANE_DATA (history[cur_field_idx + 1].frame, i);
     }
 
-    field2 = NULL;
+    p->field2 = NULL;
     if (cur_field_idx + 2 < history_count) {
-      field2 = GST_VIDEO_FRAME_PLANE_DATA (history[cur_field_idx + 2].frame, i);
+      p->field2 =
+          GST_VIDEO_FRAME_PLANE_DATA (history[cur_field_idx + 2].frame, i);
     }
-
-    gst_deinterlace_simple_method_deinterlace_frame_planar_plane (self, out,
-        field0, field1, field2, fieldp, cur_field_flags, i,
-        self->copy_scanline_packed, self->interpolate_scanline_packed);
   }
+
+  job.n_planes = 2;
+  job.cur_field_flags = history[cur_field_idx].flags;
+  gst_deinterlace_simple_method_run_job (self, &job);
 }
 
 static void
@@ -696,12 +739,26 @@ gst_deinterlace_simple_method_setup (GstDeinterlaceMethod * method,
   }
 }
 
+static void
+gst_deinterlace_simple_method_finalize (GObject * object)
+{
+  GstDeinterlaceSimpleMethod *self = GST_DEINTERLACE_SIMPLE_METHOD (object);
+
+  gst_worker_pool_clear (&self->workers);
+
+  G_OBJECT_CLASS (gst_deinterlace_simple_method_parent_class)->finalize
+      (object);
+}
+
 static void
 gst_deinterlace_simple_method_class_init (GstDeinterlaceSimpleMethodClass
     * klass)
 {
+  GObjectClass *gobject_class = (GObjectClass *) klass;
   GstDeinterlaceMethodClass *dm_class = (GstDeinterlaceMethodClass *) klass;
 
+  gobject_class->finalize = gst_deinterlace_simple_method_finalize;
+
   dm_class->deinterlace_frame_ayuv =
       gst_deinterlace_simple_method_deinterlace_frame_packed;
   dm_class->deinterlace_frame_yuy2 =
@@ -802,4 +859,5 @@ gst_deinterlace_simple_method_class_init (GstDeinterlaceSimpleMethodClass
 static void
 gst_deinterlace_simple_method_init (GstDeinterlaceSimpleMethod * self)
 {
+  gst_worker_pool_init (&self->workers, "deinterlace");
 }
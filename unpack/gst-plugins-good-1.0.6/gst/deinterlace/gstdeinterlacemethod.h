@@ -24,6 +24,8 @@
 #include <gst/gst.h>
 #include <gst/video/video.h>
 
+#include "gst/gst-worker-pool-private.h"
+
 #if defined(HAVE_GCC_ASM) && defined(HAVE_ORC)
 #if defined(HAVE_CPU_I386) || defined(HAVE_CPU_X86_64)
 #define BUILD_X86_ASM
@@ -75,6 +77,10 @@ struct _GstDeinterlaceMethod {
   gint row_stride[4];
   gint pixel_stride[4];
 
+  /* number of threads to deinterlace a frame with, including the
+   * streaming thread */
+  guint n_threads;
+
   GstDeinterlaceMethodDeinterlaceFunction deinterlace_frame;
 };
 
@@ -117,6 +123,7 @@ void gst_deinterlace_method_deinterlace_frame (GstDeinterlaceMethod * self, cons
     int cur_field_idx);
 gint gst_deinterlace_method_get_fields_required (GstDeinterlaceMethod * self);
 gint gst_deinterlace_method_get_latency (GstDeinterlaceMethod * self);
+void gst_deinterlace_method_set_n_threads (GstDeinterlaceMethod * self, guint n_threads);
 
 #define GST_TYPE_DEINTERLACE_SIMPLE_METHOD		(gst_deinterlace_simple_method_get_type ())
 #define GST_IS_DEINTERLACE_SIMPLE_METHOD(obj)		(G_TYPE_CHECK_INSTANCE_TYPE ((obj), GST_TYPE_DEINTERLACE_SIMPLE_METHOD))
@@ -176,6 +183,9 @@ struct _GstDeinterlaceSimpleMethod {
 
   GstDeinterlaceSimpleMethodFunction interpolate_scanline_planar[3];
   GstDeinterlaceSimpleMethodFunction copy_scanline_planar[3];
+
+  /* threads deinterlacing bands of lines with the streaming thread */
+  GstWorkerPool workers;
 };
 
 struct _GstDeinterlaceSimpleMethodClass {
@@ -0,0 +1,422 @@
+/* GStreamer
+ *
+ * yadif.c: motion adaptive deinterlacing method with edge directed
+ * interpolation
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/* The missing lines are predicted spatially along the direction of the
+ * best matching edge between the lines above and below, and the prediction
+ * is then clamped to the range allowed by the temporal neighbours: the
+ * same line in the previous and next field and the lines around it in the
+ * field before the previous one. Static areas get the full vertical
+ * resolution of the previous and next fields, moving areas the edge
+ * directed interpolation of the current field.
+ *
+ * Compared to the original yadif filter, the next field of the same parity
+ * is not used so that the method keeps the latency of greedyh. The lines
+ * are filtered with SSE2 or NEON when the compiler targets them and in C
+ * otherwise, and give the same result in all cases.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include "gstdeinterlacemethod.h"
+#include "yadif.h"
+
+#if defined (__SSE2__)
+#include <emmintrin.h>
+#elif defined (__ARM_NEON__) || defined (__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+typedef GstDeinterlaceSimpleMethod GstDeinterlaceMethodYadif;
+typedef GstDeinterlaceSimpleMethodClass GstDeinterlaceMethodYadifClass;
+
+/* the lines around a missing line, see gstdeinterlacemethod.h */
+typedef struct
+{
+  /* current field, above and below */
+  const guint8 *t, *b;
+  /* previous and next field, same line and two lines above and below */
+  const guint8 *prev, *next;
+  const guint8 *prev_tt, *prev_bb, *next_tt, *next_bb;
+  /* the field before the previous one, above and below */
+  const guint8 *prev2_t, *prev2_b;
+} YadifLines;
+
+static inline gint
+yadif_score (const YadifLines * l, gint x, gint j, gint step)
+{
+  return ABS (l->t[x + (j - 1) * step] - l->b[x - (j + 1) * step]) +
+      ABS (l->t[x + j * step] - l->b[x - j * step]) +
+      ABS (l->t[x + (j + 1) * step] - l->b[x - (j - 1) * step]);
+}
+
+static inline guint8
+yadif_pixel (const YadifLines * l, gint x, gint step, gboolean edges)
+{
+  gint c = l->t[x], e = l->b[x];
+  gint d = (l->prev[x] + l->next[x]) >> 1;
+  gint td0 = ABS (l->prev[x] - l->next[x]);
+  gint td1 = (ABS (l->prev2_t[x] - c) + ABS (l->prev2_b[x] - e)) >> 1;
+  gint diff = MAX (td0 >> 1, td1);
+  gint pred = (c + e) >> 1;
+  gint b, f, max, min;
+
+  /* follow the edge to the left or the right as long as it gets better */
+  if (edges) {
+    gint score, s;
+
+    score = ABS (l->t[x - step] - l->b[x - step]) + ABS (c - e) +
+        ABS (l->t[x + step] - l->b[x + step]) - 1;
+
+    s = yadif_score (l, x, -1, step);
+    if (s < score) {
+      score = s;
+      pred = (l->t[x - step] + l->b[x + step]) >> 1;
+      s = yadif_score (l, x, -2, step);
+      if (s < score) {
+        score = s;
+        pred = (l->t[x - 2 * step] + l->b[x + 2 * step]) >> 1;
+      }
+    }
+    s = yadif_score (l, x, 1, step);
+    if (s < score) {
+      score = s;
+      pred = (l->t[x + step] + l->b[x - step]) >> 1;
+      s = yadif_score (l, x, 2, step);
+      if (s < score) {
+        score = s;
+        pred = (l->t[x + 2 * step] + l->b[x - 2 * step]) >> 1;
+      }
+    }
+  }
+
+  /* don't let the prediction go beyond what the temporal neighbours and
+   * the vertical neighbours in the other fields allow */
+  b = (l->prev_tt[x] + l->next_tt[x]) >> 1;
+  f = (l->prev_bb[x] + l->next_bb[x]) >> 1;
+  max = MAX (MAX (d - e, d - c), MIN (b - c, f - e));
+  min = MIN (MIN (d - e, d - c), MAX (b - c, f - e));
+  diff = MAX (MAX (diff, min), -max);
+
+  return CLAMP (pred, d - diff, d + diff);
+}
+
+#if defined (__SSE2__)
+#define LOAD(p,o) \
+    _mm_unpacklo_epi8 (_mm_loadl_epi64 ((const __m128i *) ((p) + x + (o))), \
+        zero)
+
+static inline __m128i
+yadif_absdiff_sse2 (__m128i a, __m128i b)
+{
+  return _mm_sub_epi16 (_mm_max_epi16 (a, b), _mm_min_epi16 (a, b));
+}
+
+static inline __m128i
+yadif_select_sse2 (__m128i mask, __m128i a, __m128i b)
+{
+  return _mm_or_si128 (_mm_and_si128 (mask, a), _mm_andnot_si128 (mask, b));
+}
+
+/* 8 pixels at a time in 16 bits, the same arithmetic as yadif_pixel() */
+static gint
+yadif_filter_line_simd (guint8 * dst, const YadifLines * l, gint x, gint end)
+{
+  const __m128i zero = _mm_setzero_si128 ();
+  const __m128i one = _mm_set1_epi16 (1);
+
+  for (; x + 8 <= end; x += 8) {
+    __m128i c = LOAD (l->t, 0), e = LOAD (l->b, 0);
+    __m128i p = LOAD (l->prev, 0), n = LOAD (l->next, 0);
+    __m128i d, diff, pred, score, s, mask, b, f, max, min;
+    gint j, dir;
+
+    d = _mm_srli_epi16 (_mm_add_epi16 (p, n), 1);
+    diff = _mm_max_epi16 (_mm_srli_epi16 (yadif_absdiff_sse2 (p, n), 1),
+        _mm_srli_epi16 (_mm_add_epi16 (yadif_absdiff_sse2 (LOAD (l->prev2_t,
+                        0), c), yadif_absdiff_sse2 (LOAD (l->prev2_b, 0), e)),
+            1));
+    pred = _mm_srli_epi16 (_mm_add_epi16 (c, e), 1);
+
+    score = _mm_sub_epi16 (_mm_add_epi16 (_mm_add_epi16 (yadif_absdiff_sse2
+                (LOAD (l->t, -1), LOAD (l->b, -1)), yadif_absdiff_sse2 (c,
+                    e)), yadif_absdiff_sse2 (LOAD (l->t, 1), LOAD (l->b, 1))),
+        one);
+
+    for (dir = -1; dir <= 1; dir += 2) {
+      mask = _mm_cmpeq_epi16 (zero, zero);
+      for (j = dir; j == dir || j == 2 * dir; j += dir) {
+        s = _mm_add_epi16 (_mm_add_epi16 (yadif_absdiff_sse2 (LOAD (l->t,
+                        j - 1), LOAD (l->b, -j - 1)),
+                yadif_absdiff_sse2 (LOAD (l->t, j), LOAD (l->b, -j))),
+            yadif_absdiff_sse2 (LOAD (l->t, j + 1), LOAD (l->b, -j + 1)));
+        mask = _mm_and_si128 (mask, _mm_cmplt_epi16 (s, score));
+        score = yadif_select_sse2 (mask, s, score);
+        pred = yadif_select_sse2 (mask,
+            _mm_srli_epi16 (_mm_add_epi16 (LOAD (l->t, j), LOAD (l->b, -j)),
+                1), pred);
+      }
+    }
+
+    b = _mm_srli_epi16 (_mm_add_epi16 (LOAD (l->prev_tt, 0),
+            LOAD (l->next_tt, 0)), 1);
+    f = _mm_srli_epi16 (_mm_add_epi16 (LOAD (l->prev_bb, 0),
+            LOAD (l->next_bb, 0)), 1);
+    max = _mm_max_epi16 (_mm_max_epi16 (_mm_sub_epi16 (d, e),
+            _mm_sub_epi16 (d, c)), _mm_min_epi16 (_mm_sub_epi16 (b, c),
+            _mm_sub_epi16 (f, e)));
+    min = _mm_min_epi16 (_mm_min_epi16 (_mm_sub_epi16 (d, e),
+            _mm_sub_epi16 (d, c)), _mm_max_epi16 (_mm_sub_epi16 (b, c),
+            _mm_sub_epi16 (f, e)));
+    diff = _mm_max_epi16 (_mm_max_epi16 (diff, min), _mm_sub_epi16 (zero,
+            max));
+
+    pred = _mm_min_epi16 (_mm_max_epi16 (pred, _mm_sub_epi16 (d, diff)),
+        _mm_add_epi16 (d, diff));
+    _mm_storel_epi64 ((__m128i *) (dst + x), _mm_packus_epi16 (pred, pred));
+  }
+
+  return x;
+}
+
+#undef LOAD
+#define HAVE_YADIF_SIMD
+#elif defined (__ARM_NEON__) || defined (__ARM_NEON)
+#define LOAD(p,o) \
+    vreinterpretq_s16_u16 (vmovl_u8 (vld1_u8 ((p) + x + (o))))
+
+/* 8 pixels at a time in 16 bits, the same arithmetic as yadif_pixel() */
+static gint
+yadif_filter_line_simd (guint8 * dst, const YadifLines * l, gint x, gint end)
+{
+  const int16x8_t one = vdupq_n_s16 (1);
+
+  for (; x + 8 <= end; x += 8) {
+    int16x8_t c = LOAD (l->t, 0), e = LOAD (l->b, 0);
+    int16x8_t p = LOAD (l->prev, 0), n = LOAD (l->next, 0);
+    int16x8_t d, diff, pred, score, s, b, f, max, min;
+    uint16x8_t mask;
+    gint j, dir;
+
+    d = vshrq_n_s16 (vaddq_s16 (p, n), 1);
+    diff = vmaxq_s16 (vshrq_n_s16 (vabdq_s16 (p, n), 1),
+        vshrq_n_s16 (vaddq_s16 (vabdq_s16 (LOAD (l->prev2_t, 0), c),
+                vabdq_s16 (LOAD (l->prev2_b, 0), e)), 1));
+    pred = vshrq_n_s16 (vaddq_s16 (c, e), 1);
+
+    score = vsubq_s16 (vaddq_s16 (vaddq_s16 (vabdq_s16 (LOAD (l->t, -1),
+                    LOAD (l->b, -1)), vabdq_s16 (c, e)),
+            vabdq_s16 (LOAD (l->t, 1), LOAD (l->b, 1))), one);
+
+    for (dir = -1; dir <= 1; dir += 2) {
+      mask = vdupq_n_u16 (0xffff);
+      for (j = dir; j == dir || j == 2 * dir; j += dir) {
+        s = vaddq_s16 (vaddq_s16 (vabdq_s16 (LOAD (l->t, j - 1),
+                    LOAD (l->b, -j - 1)), vabdq_s16 (LOAD (l->t, j),
+                    LOAD (l->b, -j))), vabdq_s16 (LOAD (l->t, j + 1),
+                LOAD (l->b, -j + 1)));
+        mask = vandq_u16 (mask, vcltq_s16 (s, score));
+        score = vbslq_s16 (mask, s, score);
+        pred = vbslq_s16 (mask, vshrq_n_s16 (vaddq_s16 (LOAD (l->t, j),
+                    LOAD (l->b, -j)), 1), pred);
+      }
+    }
+
+    b = vshrq_n_s16 (vaddq_s16 (LOAD (l->prev_tt, 0), LOAD (l->next_tt, 0)),
+        1);
+    f = vshrq_n_s16 (vaddq_s16 (LOAD (l->prev_bb, 0), LOAD (l->next_bb, 0)),
+        1);
+    max = vmaxq_s16 (vmaxq_s16 (vsubq_s16 (d, e), vsubq_s16 (d, c)),
+        vminq_s16 (vsubq_s16 (b, c), vsubq_s16 (f, e)));
+    min = vminq_s16 (vminq_s16 (vsubq_s16 (d, e), vsubq_s16 (d, c)),
+        vmaxq_s16 (vsubq_s16 (b, c), vsubq_s16 (f, e)));
+    diff = vmaxq_s16 (vmaxq_s16 (diff, min), vnegq_s16 (max));
+
+    pred = vminq_s16 (vmaxq_s16 (pred, vsubq_s16 (d, diff)),
+        vaddq_s16 (d, diff));
+    vst1_u8 (dst + x, vqmovun_s16 (pred));
+  }
+
+  return x;
+}
+
+#undef LOAD
+#define HAVE_YADIF_SIMD
+#endif
+
+/* the edge search looks 3 pixels to the left and the right, the pixels at
+ * the borders only get the temporal check */
+static void
+yadif_filter_line (guint8 * dst, const YadifLines * l, gint size, gint step)
+{
+  gint x, border = MIN (3 * step, size);
+
+  for (x = 0; x < border; x++)
+    dst[x] = yadif_pixel (l, x, step, FALSE);
+#ifdef HAVE_YADIF_SIMD
+  if (step == 1)
+    x = yadif_filter_line_simd (dst, l, x, size - border);
+#endif
+  for (; x < size - border; x++)
+    dst[x] = yadif_pixel (l, x, step, TRUE);
+  for (; x < size; x++)
+    dst[x] = yadif_pixel (l, x, step, FALSE);
+}
+
+/* @step is the distance in bytes to the same component of the next pixel */
+static void
+deinterlace_scanline_yadif (GstDeinterlaceSimpleMethod * self, guint8 * out,
+    const GstDeinterlaceScanlineData * scanlines, gint size, gint step)
+{
+  YadifLines l;
+  gint x;
+
+  l.t = scanlines->t0;
+  l.b = scanlines->b0;
+
+  /* at the start and when flushing there is only one of the previous and
+   * next field, without any other field there's only the current one */
+  if (scanlines->m1 == NULL && scanlines->mp == NULL) {
+    for (x = 0; x < size; x++)
+      out[x] = (l.t[x] + l.b[x]) >> 1;
+    return;
+  }
+
+  if (scanlines->m1) {
+    l.prev = scanlines->m1;
+    l.prev_tt = scanlines->tt1;
+    l.prev_bb = scanlines->bb1;
+  } else {
+    l.prev = scanlines->mp;
+    l.prev_tt = scanlines->ttp;
+    l.prev_bb = scanlines->bbp;
+  }
+
+  if (scanlines->mp) {
+    l.next = scanlines->mp;
+    l.next_tt = scanlines->ttp;
+    l.next_bb = scanlines->bbp;
+  } else {
+    l.next = l.prev;
+    l.next_tt = l.prev_tt;
+    l.next_bb = l.prev_bb;
+  }
+
+  /* without the field before the previous one the current field is used,
+   * which doesn't add any motion */
+  l.prev2_t = scanlines->t2 ? scanlines->t2 : l.t;
+  l.prev2_b = scanlines->b2 ? scanlines->b2 : l.b;
+
+  yadif_filter_line (out, &l, size, step);
+}
+
+static void
+deinterlace_scanline_yadif_packed_4 (GstDeinterlaceSimpleMethod * self,
+    guint8 * out, const GstDeinterlaceScanlineData * scanlines)
+{
+  deinterlace_scanline_yadif (self, out, scanlines,
+      self->parent.row_stride[0], 4);
+}
+
+static void
+deinterlace_scanline_yadif_packed_3 (GstDeinterlaceSimpleMethod * self,
+    guint8 * out, const GstDeinterlaceScanlineData * scanlines)
+{
+  deinterlace_scanline_yadif (self, out, scanlines,
+      self->parent.row_stride[0], 3);
+}
+
+static void
+deinterlace_scanline_yadif_nv12 (GstDeinterlaceSimpleMethod * self,
+    guint8 * out, const GstDeinterlaceScanlineData * scanlines)
+{
+  /* the same function does the luma and the chroma plane, step over a
+   * whole chroma sample in both */
+  deinterlace_scanline_yadif (self, out, scanlines,
+      self->parent.row_stride[0], 2);
+}
+
+static void
+deinterlace_scanline_yadif_planar_y (GstDeinterlaceSimpleMethod * self,
+    guint8 * out, const GstDeinterlaceScanlineData * scanlines)
+{
+  deinterlace_scanline_yadif (self, out, scanlines,
+      self->parent.row_stride[0], 1);
+}
+
+static void
+deinterlace_scanline_yadif_planar_u (GstDeinterlaceSimpleMethod * self,
+    guint8 * out, const GstDeinterlaceScanlineData * scanlines)
+{
+  deinterlace_scanline_yadif (self, out, scanlines,
+      self->parent.row_stride[1], 1);
+}
+
+static void
+deinterlace_scanline_yadif_planar_v (GstDeinterlaceSimpleMethod * self,
+    guint8 * out, const GstDeinterlaceScanlineData * scanlines)
+{
+  deinterlace_scanline_yadif (self, out, scanlines,
+      self->parent.row_stride[2], 1);
+}
+
+G_DEFINE_TYPE (GstDeinterlaceMethodYadif, gst_deinterlace_method_yadif,
+    GST_TYPE_DEINTERLACE_SIMPLE_METHOD);
+
+static void
+gst_deinterlace_method_yadif_class_init (GstDeinterlaceMethodYadifClass *
+    klass)
+{
+  GstDeinterlaceMethodClass *dim_class = (GstDeinterlaceMethodClass *) klass;
+  GstDeinterlaceSimpleMethodClass *dism_class =
+      (GstDeinterlaceSimpleMethodClass *) klass;
+
+  dim_class->fields_required = 4;
+  dim_class->name = "Motion Adaptive: Edge Directed Interpolation";
+  dim_class->nick = "yadif";
+  dim_class->latency = 1;
+
+  /* macro-pixels of YUY2 and friends are 4 bytes */
+  dism_class->interpolate_scanline_yuy2 = deinterlace_scanline_yadif_packed_4;
+  dism_class->interpolate_scanline_yvyu = deinterlace_scanline_yadif_packed_4;
+  dism_class->interpolate_scanline_uyvy = deinterlace_scanline_yadif_packed_4;
+  dism_class->interpolate_scanline_ayuv = deinterlace_scanline_yadif_packed_4;
+  dism_class->interpolate_scanline_argb = deinterlace_scanline_yadif_packed_4;
+  dism_class->interpolate_scanline_abgr = deinterlace_scanline_yadif_packed_4;
+  dism_class->interpolate_scanline_rgba = deinterlace_scanline_yadif_packed_4;
+  dism_class->interpolate_scanline_bgra = deinterlace_scanline_yadif_packed_4;
+  dism_class->interpolate_scanline_rgb = deinterlace_scanline_yadif_packed_3;
+  dism_class->interpolate_scanline_bgr = deinterlace_scanline_yadif_packed_3;
+  dism_class->interpolate_scanline_nv12 = deinterlace_scanline_yadif_nv12;
+  dism_class->interpolate_scanline_nv21 = deinterlace_scanline_yadif_nv12;
+  dism_class->interpolate_scanline_planar_y =
+      deinterlace_scanline_yadif_planar_y;
+  dism_class->interpolate_scanline_planar_u =
+      deinterlace_scanline_yadif_planar_u;
+  dism_class->interpolate_scanline_planar_v =
+      deinterlace_scanline_yadif_planar_v;
+}
+
+static void
+gst_deinterlace_method_yadif_init (GstDeinterlaceMethodYadif * self)
+{
+}
@@ -0,0 +1,29 @@
+/* GStreamer
+ *
+ * yadif.h: motion adaptive deinterlacing method with edge directed
+ * interpolation
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#ifndef __GST_DEINTERLACE_YADIF_H__
+#define __GST_DEINTERLACE_YADIF_H__
+
+#define GST_TYPE_DEINTERLACE_YADIF (gst_deinterlace_method_yadif_get_type ())
+
+GType gst_deinterlace_method_yadif_get_type (void);
+
+#endif /* __GST_DEINTERLACE_YADIF_H__ */
@@ -630,17 +630,54 @@ incomplete_caps:
   }
 }
 
+/* take all buffers from @adapter and combine their memory into one buffer,
+ * unlike gst_adapter_take_buffer() this does not copy the data */
+static GstBuffer *
+gst_rtp_h264_depay_take_all (GstAdapter * adapter)
+{
+  GList *list, *walk;
+  GstBuffer *outbuf = NULL;
+
+  list = gst_adapter_take_list (adapter, gst_adapter_available (adapter));
+  for (walk = list; walk; walk = g_list_next (walk)) {
+    if (outbuf)
+      outbuf = gst_buffer_append (outbuf, walk->data);
+    else
+      outbuf = walk->data;
+  }
+  g_list_free (list);
+
+  return outbuf;
+}
+
+/* make a buffer with @prefix followed by @size bytes of the payload of @rtp
+ * starting at @offset. The payload is not copied, the buffer refers to the
+ * memory of the RTP packet. */
+static GstBuffer *
+gst_rtp_h264_depay_wrap_payload (GstRTPBuffer * rtp, const guint8 * prefix,
+    guint prefix_size, guint offset, guint size)
+{
+  GstBuffer *outbuf, *payload;
+
+  payload = gst_rtp_buffer_get_payload_subbuffer (rtp, offset, size);
+  if (prefix_size == 0)
+    return payload;
+
+  outbuf = gst_buffer_new_allocate (NULL, prefix_size, NULL);
+  gst_buffer_fill (outbuf, 0, prefix, prefix_size);
+
+  return gst_buffer_append (outbuf, payload);
+}
+
 static GstBuffer *
 gst_rtp_h264_complete_au (GstRtpH264Depay * rtph264depay,
     GstClockTime * out_timestamp, gboolean * out_keyframe)
 {
-  guint outsize;
   GstBuffer *outbuf;
 
   /* we had a picture in the adapter and we completed it */
   GST_DEBUG_OBJECT (rtph264depay, "taking completed AU");
-  outsize = gst_adapter_available (rtph264depay->picture_adapter);
-  outbuf = gst_adapter_take_buffer (rtph264depay->picture_adapter, outsize);
+  outbuf = gst_rtp_h264_depay_take_all (rtph264depay->picture_adapter);
 
   *out_timestamp = rtph264depay->last_ts;
   *out_keyframe = rtph264depay->last_keyframe;
@@ -661,16 +698,17 @@ gst_rtp_h264_depay_handle_nal (GstRtpH264Depay * rtph264depay, GstBuffer * nal,
 {
   GstRTPBaseDepayload *depayload = GST_RTP_BASE_DEPAYLOAD (rtph264depay);
   gint nal_type;
-  GstMapInfo map;
+  guint8 header[6] = { 0, };
   GstBuffer *outbuf = NULL;
   GstClockTime out_timestamp;
   gboolean keyframe, out_keyframe;
 
-  gst_buffer_map (nal, &map, GST_MAP_READ);
-  if (G_UNLIKELY (map.size < 5))
+  /* only look at the headers, mapping the complete NAL would merge the
+   * memory of the packets it was made from */
+  if (G_UNLIKELY (gst_buffer_extract (nal, 0, header, sizeof (header)) < 5))
     goto short_nal;
 
-  nal_type = map.data[4] & 0x1f;
+  nal_type = header[4] & 0x1f;
   GST_DEBUG_OBJECT (rtph264depay, "handle NAL type %d", nal_type);
 
   keyframe = NAL_TYPE_IS_KEY (nal_type);
@@ -683,7 +721,6 @@ gst_rtp_h264_depay_handle_nal (GstRtpH264Depay * rtph264depay, GstBuffer * nal,
       gst_rtp_h264_add_sps_pps (rtph264depay,
           gst_buffer_copy_region (nal, GST_BUFFER_COPY_ALL,
               4, gst_buffer_get_size (nal) - 4));
-      gst_buffer_unmap (nal, &map);
       gst_buffer_unref (nal);
       return NULL;
     } else if (rtph264depay->sps->len == 0 || rtph264depay->pps->len == 0) {
@@ -694,7 +731,6 @@ gst_rtp_h264_depay_handle_nal (GstRtpH264Depay * rtph264depay, GstBuffer * nal,
           gst_event_new_custom (GST_EVENT_CUSTOM_UPSTREAM,
               gst_structure_new ("GstForceKeyUnit",
                   "all-headers", G_TYPE_BOOLEAN, TRUE, NULL)));
-      gst_buffer_unmap (nal, &map);
       gst_buffer_unref (nal);
       return NULL;
     }
@@ -717,7 +753,7 @@ gst_rtp_h264_depay_handle_nal (GstRtpH264Depay * rtph264depay, GstBuffer * nal,
     if (nal_type == 1 || nal_type == 2 || nal_type == 5) {
       /* we have a picture start */
       start = TRUE;
-      if (map.data[5] & 0x80) {
+      if (header[5] & 0x80) {
         /* first_mb_in_slice == 0 completes a picture */
         complete = TRUE;
       }
@@ -732,8 +768,6 @@ gst_rtp_h264_depay_handle_nal (GstRtpH264Depay * rtph264depay, GstBuffer * nal,
           &out_keyframe);
 
     /* add to adapter */
-    gst_buffer_unmap (nal, &map);
-
     GST_DEBUG_OBJECT (depayload, "adding NAL to picture adapter");
     gst_adapter_push (rtph264depay->picture_adapter, nal);
     rtph264depay->last_ts = in_timestamp;
@@ -747,7 +781,6 @@ gst_rtp_h264_depay_handle_nal (GstRtpH264Depay * rtph264depay, GstBuffer * nal,
     /* no merge, output is input nal */
     GST_DEBUG_OBJECT (depayload, "using NAL as output");
     outbuf = nal;
-    gst_buffer_unmap (nal, &map);
   }
 
   if (outbuf) {
@@ -774,7 +807,6 @@ gst_rtp_h264_depay_handle_nal (GstRtpH264Depay * rtph264depay, GstBuffer * nal,
 short_nal:
   {
     GST_WARNING_OBJECT (depayload, "dropping short NAL");
-    gst_buffer_unmap (nal, &map);
     gst_buffer_unref (nal);
     return NULL;
   }
@@ -785,25 +817,25 @@ gst_rtp_h264_push_fragmentation_unit (GstRtpH264Depay * rtph264depay,
     gboolean send)
 {
   guint outsize;
-  GstMapInfo map;
+  guint8 prefix[4];
   GstBuffer *outbuf;
 
-  outsize = gst_adapter_available (rtph264depay->adapter);
-  outbuf = gst_adapter_take_buffer (rtph264depay->adapter, outsize);
+  outbuf = gst_rtp_h264_depay_take_all (rtph264depay->adapter);
+  outsize = gst_buffer_get_size (outbuf);
 
-  gst_buffer_map (outbuf, &map, GST_MAP_WRITE);
   GST_DEBUG_OBJECT (rtph264depay, "output %d bytes", outsize);
 
+  /* only the prefix memory is written, the fragments are not touched */
   if (rtph264depay->byte_stream) {
-    memcpy (map.data, sync_bytes, sizeof (sync_bytes));
+    memcpy (prefix, sync_bytes, sizeof (sync_bytes));
   } else {
     outsize -= 4;
-    map.data[0] = (outsize >> 24);
-    map.data[1] = (outsize >> 16);
-    map.data[2] = (outsize >> 8);
-    map.data[3] = (outsize);
+    prefix[0] = (outsize >> 24);
+    prefix[1] = (outsize >> 16);
+    prefix[2] = (outsize >> 8);
+    prefix[3] = (outsize);
   }
-  gst_buffer_unmap (outbuf, &map);
+  gst_buffer_fill (outbuf, 0, prefix, sizeof (prefix));
 
   rtph264depay->current_fu_type = 0;
 
@@ -836,10 +868,10 @@ gst_rtp_h264_depay_process (GstRTPBaseDepayload * depayload, GstBuffer * buf)
 
   {
     gint payload_len;
-    guint8 *payload;
+    guint8 *payload, *payload_start;
     guint header_len;
     guint8 nal_ref_idc;
-    GstMapInfo map;
+    guint8 prefix[5];
     guint outsize, nalu_size;
     GstClockTime timestamp;
     gboolean marker;
@@ -849,7 +881,7 @@ gst_rtp_h264_depay_process (GstRTPBaseDepayload * depayload, GstBuffer * buf)
     gst_rtp_buffer_map (buf, GST_MAP_READ, &rtp);
 
     payload_len = gst_rtp_buffer_get_payload_len (&rtp);
-    payload = gst_rtp_buffer_get_payload (&rtp);
+    payload_start = payload = gst_rtp_buffer_get_payload (&rtp);
     marker = gst_rtp_buffer_get_marker (&rtp);
 
     GST_DEBUG_OBJECT (rtph264depay, "receiving %d bytes", payload_len);
@@ -915,33 +947,29 @@ gst_rtp_h264_depay_process (GstRTPBaseDepayload * depayload, GstBuffer * buf)
           if (nalu_size > (payload_len - 2))
             nalu_size = payload_len - 2;
 
-          outsize = nalu_size + sizeof (sync_bytes);
-          outbuf = gst_buffer_new_and_alloc (outsize);
-
-          gst_buffer_map (outbuf, &map, GST_MAP_WRITE);
           if (rtph264depay->byte_stream) {
-            memcpy (map.data, sync_bytes, sizeof (sync_bytes));
+            memcpy (prefix, sync_bytes, sizeof (sync_bytes));
           } else {
-            map.data[0] = map.data[1] = 0;
-            map.data[2] = payload[0];
-            map.data[3] = payload[1];
+            prefix[0] = prefix[1] = 0;
+            prefix[2] = payload[0];
+            prefix[3] = payload[1];
           }
 
           /* strip NALU size */
           payload += 2;
           payload_len -= 2;
 
-          memcpy (map.data + sizeof (sync_bytes), payload, nalu_size);
-          gst_buffer_unmap (outbuf, &map);
-
+          outbuf = gst_rtp_h264_depay_wrap_payload (&rtp, prefix,
+              sizeof (sync_bytes), payload - payload_start, nalu_size);
           gst_adapter_push (rtph264depay->adapter, outbuf);
 
           payload += nalu_size;
           payload_len -= nalu_size;
         }
 
-        outsize = gst_adapter_available (rtph264depay->adapter);
-        outbuf = gst_adapter_take_buffer (rtph264depay->adapter, outsize);
+        outbuf = gst_rtp_h264_depay_take_all (rtph264depay->adapter);
+        if (outbuf == NULL)
+          goto empty_packet;
 
         outbuf = gst_rtp_h264_depay_handle_nal (rtph264depay, outbuf, timestamp,
             marker);
@@ -997,21 +1025,18 @@ gst_rtp_h264_depay_process (GstRTPBaseDepayload * depayload, GstBuffer * buf)
           /* reconstruct NAL header */
           nal_header = (payload[0] & 0xe0) | (payload[1] & 0x1f);
 
-          /* strip type header, keep FU header, we'll reuse it to reconstruct
-           * the NAL header. */
-          payload += 1;
-          payload_len -= 1;
-
-          nalu_size = payload_len;
-          outsize = nalu_size + sizeof (sync_bytes);
-          outbuf = gst_buffer_new_and_alloc (outsize);
+          /* strip FU indicator and FU header, the reconstructed NAL header
+           * goes in the prefix after the room for the sync bytes or length,
+           * which are filled in when the NAL is complete. */
+          payload += 2;
+          payload_len -= 2;
 
-          gst_buffer_map (outbuf, &map, GST_MAP_WRITE);
-          memcpy (map.data + sizeof (sync_bytes), payload, nalu_size);
-          map.data[sizeof (sync_bytes)] = nal_header;
-          gst_buffer_unmap (outbuf, &map);
+          prefix[sizeof (sync_bytes)] = nal_header;
+          outbuf = gst_rtp_h264_depay_wrap_payload (&rtp, prefix,
+              sizeof (sync_bytes) + 1, payload - payload_start, payload_len);
 
-          GST_DEBUG_OBJECT (rtph264depay, "queueing %d bytes", outsize);
+          GST_DEBUG_OBJECT (rtph264depay, "queueing %d bytes",
+              payload_len + 5);
 
           /* and assemble in the adapter */
           gst_adapter_push (rtph264depay->adapter, outbuf);
@@ -1021,8 +1046,8 @@ gst_rtp_h264_depay_process (GstRTPBaseDepayload * depayload, GstBuffer * buf)
           payload_len -= 2;
 
           outsize = payload_len;
-          outbuf = gst_buffer_new_and_alloc (outsize);
-          gst_buffer_fill (outbuf, 0, payload, outsize);
+          outbuf = gst_rtp_h264_depay_wrap_payload (&rtp, NULL, 0,
+              payload - payload_start, outsize);
 
           GST_DEBUG_OBJECT (rtph264depay, "queueing %d bytes", outsize);
 
@@ -1045,19 +1070,15 @@ gst_rtp_h264_depay_process (GstRTPBaseDepayload * depayload, GstBuffer * buf)
         /* 1-23   NAL unit  Single NAL unit packet per H.264   5.6 */
         /* the entire payload is the output buffer */
         nalu_size = payload_len;
-        outsize = nalu_size + sizeof (sync_bytes);
-        outbuf = gst_buffer_new_and_alloc (outsize);
-
-        gst_buffer_map (outbuf, &map, GST_MAP_WRITE);
         if (rtph264depay->byte_stream) {
-          memcpy (map.data, sync_bytes, sizeof (sync_bytes));
+          memcpy (prefix, sync_bytes, sizeof (sync_bytes));
         } else {
-          map.data[0] = map.data[1] = 0;
-          map.data[2] = nalu_size >> 8;
-          map.data[3] = nalu_size & 0xff;
+          prefix[0] = prefix[1] = 0;
+          prefix[2] = nalu_size >> 8;
+          prefix[3] = nalu_size & 0xff;
         }
-        memcpy (map.data + sizeof (sync_bytes), payload, nalu_size);
-        gst_buffer_unmap (outbuf, &map);
+        outbuf = gst_rtp_h264_depay_wrap_payload (&rtp, prefix,
+            sizeof (sync_bytes), 0, nalu_size);
 
         outbuf = gst_rtp_h264_depay_handle_nal (rtph264depay, outbuf, timestamp,
             marker);
@@ -808,11 +808,13 @@ gst_rtp_h264_pay_decode_nal (GstRtpH264Pay * payloader,
 
 static GstFlowReturn
 gst_rtp_h264_pay_payload_nal (GstRTPBasePayload * basepayload,
-    GstBuffer * paybuf, GstClockTime dts, GstClockTime pts, gboolean end_of_au);
+    GstBuffer * paybuf, GstClockTime dts, GstClockTime pts, gboolean end_of_au,
+    GstBufferList * list);
 
 static GstFlowReturn
 gst_rtp_h264_pay_send_sps_pps (GstRTPBasePayload * basepayload,
-    GstRtpH264Pay * rtph264pay, GstClockTime dts, GstClockTime pts)
+    GstRtpH264Pay * rtph264pay, GstClockTime dts, GstClockTime pts,
+    GstBufferList * list)
 {
   GstFlowReturn ret = GST_FLOW_OK;
   GList *walk;
@@ -823,7 +825,7 @@ gst_rtp_h264_pay_send_sps_pps (GstRTPBasePayload * basepayload,
     GST_DEBUG_OBJECT (rtph264pay, "inserting SPS in the stream");
     /* resend SPS */
     ret = gst_rtp_h264_pay_payload_nal (basepayload, gst_buffer_ref (sps_buf),
-        dts, pts, FALSE);
+        dts, pts, FALSE, list);
     /* Not critical here; but throw a warning */
     if (ret != GST_FLOW_OK)
       GST_WARNING ("Problem pushing SPS");
@@ -834,7 +836,7 @@ gst_rtp_h264_pay_send_sps_pps (GstRTPBasePayload * basepayload,
     GST_DEBUG_OBJECT (rtph264pay, "inserting PPS in the stream");
     /* resend PPS */
     ret = gst_rtp_h264_pay_payload_nal (basepayload, gst_buffer_ref (pps_buf),
-        dts, pts, FALSE);
+        dts, pts, FALSE, list);
     /* Not critical here; but throw a warning */
     if (ret != GST_FLOW_OK)
       GST_WARNING ("Problem pushing PPS");
@@ -846,17 +848,18 @@ gst_rtp_h264_pay_send_sps_pps (GstRTPBasePayload * basepayload,
   return ret;
 }
 
+/* put the NAL in @paybuf in one or more RTP packets and add them to @list,
+ * the packets share the memory of @paybuf */
 static GstFlowReturn
 gst_rtp_h264_pay_payload_nal (GstRTPBasePayload * basepayload,
-    GstBuffer * paybuf, GstClockTime dts, GstClockTime pts, gboolean end_of_au)
+    GstBuffer * paybuf, GstClockTime dts, GstClockTime pts, gboolean end_of_au,
+    GstBufferList * list)
 {
   GstRtpH264Pay *rtph264pay;
-  GstFlowReturn ret;
+  GstFlowReturn ret = GST_FLOW_OK;
   guint8 nalType;
   guint packet_len, payload_len, mtu;
   GstBuffer *outbuf;
-  guint8 *payload;
-  GstBufferList *list = NULL;
   gboolean send_spspps;
   GstRTPBuffer rtp = { NULL };
   guint size = gst_buffer_get_size (paybuf);
@@ -912,9 +915,12 @@ gst_rtp_h264_pay_payload_nal (GstRTPBasePayload * basepayload,
     /* we need to send SPS/PPS now first. FIXME, don't use the pts for
      * checking when we need to send SPS/PPS but convert to running_time first. */
     rtph264pay->send_spspps = FALSE;
-    ret = gst_rtp_h264_pay_send_sps_pps (basepayload, rtph264pay, dts, pts);
-    if (ret != GST_FLOW_OK)
+    ret = gst_rtp_h264_pay_send_sps_pps (basepayload, rtph264pay, dts, pts,
+        list);
+    if (ret != GST_FLOW_OK) {
+      gst_buffer_unref (paybuf);
       return ret;
+    }
   }
 
   packet_len = gst_rtp_buffer_calc_packet_len (size, 0, 0);
@@ -924,37 +930,28 @@ gst_rtp_h264_pay_payload_nal (GstRTPBasePayload * basepayload,
         "NAL Unit fit in one packet datasize=%d mtu=%d", size, mtu);
     /* will fit in one packet */
 
-    /* use buffer lists
-     * create buffer without payload containing only the RTP header
-     * (memory block at index 0) */
-    outbuf = gst_rtp_buffer_new_allocate (0, 0, 0);
-
-    gst_rtp_buffer_map (outbuf, GST_MAP_WRITE, &rtp);
+    /* RTP header followed by the memory of the NAL */
+    outbuf = gst_rtp_base_payload_packet_new (basepayload, NULL, 0, paybuf, 0,
+        -1);
+    gst_buffer_unref (paybuf);
 
     /* only set the marker bit on packets containing access units */
     if (IS_ACCESS_UNIT (nalType) && end_of_au) {
+      gst_rtp_buffer_map (outbuf, GST_MAP_WRITE, &rtp);
       gst_rtp_buffer_set_marker (&rtp, 1);
+      gst_rtp_buffer_unmap (&rtp);
     }
 
     /* timestamp the outbuffer */
     GST_BUFFER_PTS (outbuf) = pts;
     GST_BUFFER_DTS (outbuf) = dts;
 
-    /* insert payload memory block */
-    outbuf = gst_buffer_append (outbuf, paybuf);
-
-    list = gst_buffer_list_new ();
-
     /* add the buffer to the buffer list */
     gst_buffer_list_add (list, outbuf);
-
-    gst_rtp_buffer_unmap (&rtp);
-
-    /* push the list to the next element in the pipe */
-    ret = gst_rtp_base_payload_push_list (basepayload, list);
   } else {
     /* fragmentation Units FU-A */
     guint8 nalHeader;
+    guint8 fu[2];
     guint limitedSize;
     int ii = 0, start = 1, end = 0, pos = 0;
 
@@ -965,65 +962,52 @@ gst_rtp_h264_pay_payload_nal (GstRTPBasePayload * basepayload,
     pos++;
     size--;
 
-    ret = GST_FLOW_OK;
-
     GST_DEBUG_OBJECT (basepayload, "Using FU-A fragmentation for data size=%d",
         size);
 
     /* We keep 2 bytes for FU indicator and FU Header */
     payload_len = gst_rtp_buffer_calc_payload_len (mtu - 2, 0, 0);
 
-    list = gst_buffer_list_new ();
-
     while (end == 0) {
       limitedSize = size < payload_len ? size : payload_len;
       GST_DEBUG_OBJECT (basepayload,
           "Inside  FU-A fragmentation limitedSize=%d iteration=%d", limitedSize,
           ii);
 
-      /* use buffer lists
-       * create buffer without payload containing only the RTP header
-       * (memory block at index 0) */
-      outbuf = gst_rtp_buffer_new_allocate (2, 0, 0);
-
-      gst_rtp_buffer_map (outbuf, GST_MAP_WRITE, &rtp);
-
-      GST_BUFFER_DTS (outbuf) = dts;
-      GST_BUFFER_PTS (outbuf) = pts;
-      payload = gst_rtp_buffer_get_payload (&rtp);
-
       if (limitedSize == size) {
         GST_DEBUG_OBJECT (basepayload, "end size=%d iteration=%d", size, ii);
         end = 1;
       }
-      if (IS_ACCESS_UNIT (nalType)) {
-        gst_rtp_buffer_set_marker (&rtp, end && end_of_au);
-      }
 
       /* FU indicator */
-      payload[0] = (nalHeader & 0x60) | 28;
+      fu[0] = (nalHeader & 0x60) | 28;
 
       /* FU Header */
-      payload[1] = (start << 7) | (end << 6) | (nalHeader & 0x1f);
+      fu[1] = (start << 7) | (end << 6) | (nalHeader & 0x1f);
 
-      gst_rtp_buffer_unmap (&rtp);
+      /* RTP header and FU indicator and header followed by the memory of
+       * the fragment */
+      outbuf = gst_rtp_base_payload_packet_new (basepayload, fu, 2, paybuf,
+          pos, limitedSize);
+
+      if (IS_ACCESS_UNIT (nalType)) {
+        gst_rtp_buffer_map (outbuf, GST_MAP_WRITE, &rtp);
+        gst_rtp_buffer_set_marker (&rtp, end && end_of_au);
+        gst_rtp_buffer_unmap (&rtp);
+      }
 
-      /* insert payload memory block */
-      gst_buffer_append (outbuf,
-          gst_buffer_copy_region (paybuf, GST_BUFFER_COPY_MEMORY, pos,
-              limitedSize));
+      GST_BUFFER_DTS (outbuf) = dts;
+      GST_BUFFER_PTS (outbuf) = pts;
 
       /* add the buffer to the buffer list */
       gst_buffer_list_add (list, outbuf);
 
-
       size -= limitedSize;
       pos += limitedSize;
       ii++;
       start = 0;
     }
 
-    ret = gst_rtp_base_payload_push_list (basepayload, list);
     gst_buffer_unref (paybuf);
   }
   return ret;
@@ -1043,6 +1027,7 @@ gst_rtp_h264_pay_handle_buffer (GstRTPBasePayload * basepayload,
   GArray *nal_queue;
   gboolean avc;
   GstBuffer *paybuf = NULL;
+  GstBufferList *list;
   gsize skip;
 
   rtph264pay = GST_RTP_H264_PAY (basepayload);
@@ -1081,6 +1066,9 @@ gst_rtp_h264_pay_handle_buffer (GstRTPBasePayload * basepayload,
 
   ret = GST_FLOW_OK;
 
+  /* all packets made from this buffer are pushed together */
+  list = gst_buffer_list_new ();
+
   /* now loop over all NAL units and put them in a packet
    * FIXME, we should really try to pack multiple NAL units into one RTP packet
    * if we can, especially for the config packets that wont't cause decoder 
@@ -1125,7 +1113,7 @@ gst_rtp_h264_pay_handle_buffer (GstRTPBasePayload * basepayload,
           nal_len);
       ret =
           gst_rtp_h264_pay_payload_nal (basepayload, paybuf, dts, pts,
-          end_of_au);
+          end_of_au, list);
       if (ret != GST_FLOW_OK)
         break;
 
@@ -1256,7 +1244,7 @@ gst_rtp_h264_pay_handle_buffer (GstRTPBasePayload * basepayload,
       /* put the data in one or more RTP packets */
       ret =
           gst_rtp_h264_pay_payload_nal (basepayload, paybuf, dts, pts,
-          end_of_au);
+          end_of_au, list);
       if (ret != GST_FLOW_OK) {
         break;
       }
@@ -1276,6 +1264,11 @@ done:
     gst_adapter_unmap (rtph264pay->adapter);
   }
 
+  if (ret == GST_FLOW_OK && gst_buffer_list_length (list) > 0)
+    ret = gst_rtp_base_payload_push_list (basepayload, list);
+  else
+    gst_buffer_list_unref (list);
+
   return ret;
 
 caps_rejected:
@@ -119,18 +119,20 @@ gst_rtp_mp2t_pay_flush (GstRTPMP2TPay * rtpmp2tpay)
 {
   guint avail, mtu;
   GstFlowReturn ret = GST_FLOW_OK;
+  GstBufferList *list;
   GstBuffer *outbuf;
 
   avail = gst_adapter_available (rtpmp2tpay->adapter);
 
   mtu = GST_RTP_BASE_PAYLOAD_MTU (rtpmp2tpay);
 
-  while (avail > 0 && (ret == GST_FLOW_OK)) {
+  list = gst_buffer_list_new ();
+
+  while (avail > 0) {
     guint towrite;
-    guint8 *payload;
     guint payload_len;
     guint packet_len;
-    GstRTPBuffer rtp = { NULL };
+    GList *buffers, *walk;
 
     /* this will be the total length of the packet */
     packet_len = gst_rtp_buffer_calc_packet_len (avail, 0, 0);
@@ -146,28 +148,33 @@ gst_rtp_mp2t_pay_flush (GstRTPMP2TPay * rtpmp2tpay)
     if (!payload_len)
       break;
 
-    /* create buffer to hold the payload */
-    outbuf = gst_rtp_buffer_new_allocate (payload_len, 0, 0);
-
-    /* get payload */
-    gst_rtp_buffer_map (outbuf, GST_MAP_WRITE, &rtp);
-    payload = gst_rtp_buffer_get_payload (&rtp);
+    /* create buffer with only the RTP header */
+    outbuf = gst_rtp_base_payload_packet_new (GST_RTP_BASE_PAYLOAD (rtpmp2tpay),
+        NULL, 0, NULL, 0, 0);
 
-    /* copy stuff from adapter to payload */
-    gst_adapter_copy (rtpmp2tpay->adapter, payload, 0, payload_len);
-    gst_rtp_buffer_unmap (&rtp);
-    gst_adapter_flush (rtpmp2tpay->adapter, payload_len);
+    /* add the memory of the buffers in the adapter as payload, this does not
+     * copy the data */
+    buffers = gst_adapter_take_list (rtpmp2tpay->adapter, payload_len);
+    for (walk = buffers; walk; walk = g_list_next (walk))
+      outbuf = gst_buffer_append (outbuf, walk->data);
+    g_list_free (buffers);
     avail -= payload_len;
 
     GST_BUFFER_TIMESTAMP (outbuf) = rtpmp2tpay->first_ts;
     GST_BUFFER_DURATION (outbuf) = rtpmp2tpay->duration;
 
-    GST_DEBUG_OBJECT (rtpmp2tpay, "pushing buffer of size %u",
+    GST_DEBUG_OBJECT (rtpmp2tpay, "queueing buffer of size %u",
         (guint) gst_buffer_get_size (outbuf));
 
-    ret = gst_rtp_base_payload_push (GST_RTP_BASE_PAYLOAD (rtpmp2tpay), outbuf);
+    gst_buffer_list_add (list, outbuf);
   }
 
+  if (gst_buffer_list_length (list) > 0)
+    ret = gst_rtp_base_payload_push_list (GST_RTP_BASE_PAYLOAD (rtpmp2tpay),
+        list);
+  else
+    gst_buffer_list_unref (list);
+
   return ret;
 }
 
@@ -247,6 +247,8 @@ gst_rtp_vraw_pay_handle_buffer (GstRTPBasePayload * payload, GstBuffer * buffer)
   gint field;
   GstVideoFrame frame;
   gint interlaced;
+  gboolean zero_copy;
+  GstBufferList *list = NULL;
   GstRTPBuffer rtp = { NULL, };
 
   rtpvrawpay = GST_RTP_VRAW_PAY (payload);
@@ -273,22 +275,49 @@ gst_rtp_vraw_pay_handle_buffer (GstRTPBasePayload * payload, GstBuffer * buffer)
 
   interlaced = GST_VIDEO_INFO_IS_INTERLACED (&rtpvrawpay->vinfo);
 
+  /* the lines of packed formats are sent as they are in memory, we can put
+   * them in the packets without copying when we know where they are in the
+   * buffer */
+  switch (GST_VIDEO_INFO_FORMAT (&rtpvrawpay->vinfo)) {
+    case GST_VIDEO_FORMAT_RGB:
+    case GST_VIDEO_FORMAT_RGBA:
+    case GST_VIDEO_FORMAT_BGR:
+    case GST_VIDEO_FORMAT_BGRA:
+    case GST_VIDEO_FORMAT_UYVY:
+      zero_copy = gst_buffer_n_memory (buffer) == 1;
+      break;
+    default:
+      zero_copy = FALSE;
+      break;
+  }
+
   /* start with line 0, offset 0 */
   for (field = 0; field < 1 + interlaced; field++) {
     line = field;
     offset = 0;
 
+    /* the packets of a field all have the same timestamp, push them
+     * together */
+    list = gst_buffer_list_new ();
+
     /* write all lines */
     while (line < height) {
-      guint left;
-      GstBuffer *out;
+      guint left, headers_len = 0;
+      GstBuffer *out, *data = NULL;
       guint8 *outdata, *headers;
       gboolean next_line;
       guint length, cont, pixels;
 
       /* get the max allowed payload length size, we try to fill the complete MTU */
       left = gst_rtp_buffer_calc_payload_len (mtu, 0, 0);
-      out = gst_rtp_buffer_new_allocate (left, 0, 0);
+      if (zero_copy) {
+        /* only room for the headers, every header is followed by at least one
+         * pgroup of data */
+        out = gst_rtp_buffer_new_allocate (2 + 6 * (left / (6 + pgroup)), 0, 0);
+        data = gst_buffer_new ();
+      } else {
+        out = gst_rtp_buffer_new_allocate (left, 0, 0);
+      }
 
       if (field == 0) {
         GST_BUFFER_TIMESTAMP (out) = GST_BUFFER_TIMESTAMP (buffer);
@@ -386,6 +415,7 @@ gst_rtp_vraw_pay_handle_buffer (GstRTPBasePayload * payload, GstBuffer * buffer)
       }
       GST_LOG_OBJECT (rtpvrawpay, "consumed %u bytes",
           (guint) (outdata - headers));
+      headers_len = 2 + (outdata - headers);
 
       /* second pass, read headers and write the data */
       while (TRUE) {
@@ -410,8 +440,15 @@ gst_rtp_vraw_pay_handle_buffer (GstRTPBasePayload * payload, GstBuffer * buffer)
           case GST_VIDEO_FORMAT_BGRA:
           case GST_VIDEO_FORMAT_UYVY:
             offs /= rtpvrawpay->xinc;
-            memcpy (outdata, yp + (lin * ystride) + (offs * pgroup), length);
-            outdata += length;
+            if (zero_copy) {
+              /* share the line with the input buffer */
+              data = gst_rtp_base_payload_packet_append (payload, data, buffer,
+                  yp + (lin * ystride) + (offs * pgroup) - frame.map[0].data,
+                  length);
+            } else {
+              memcpy (outdata, yp + (lin * ystride) + (offs * pgroup), length);
+              outdata += length;
+            }
             break;
           case GST_VIDEO_FORMAT_AYUV:
           {
@@ -476,6 +513,8 @@ gst_rtp_vraw_pay_handle_buffer (GstRTPBasePayload * payload, GstBuffer * buffer)
           default:
             gst_rtp_buffer_unmap (&rtp);
             gst_buffer_unref (out);
+            if (data)
+              gst_buffer_unref (data);
             goto unknown_sampling;
         }
 
@@ -488,15 +527,24 @@ gst_rtp_vraw_pay_handle_buffer (GstRTPBasePayload * payload, GstBuffer * buffer)
         gst_rtp_buffer_set_marker (&rtp, TRUE);
       }
       gst_rtp_buffer_unmap (&rtp);
-      if (left > 0) {
+      if (zero_copy) {
+        /* the packet has the headers, add the data after them */
+        gst_buffer_set_size (out,
+            gst_rtp_buffer_calc_packet_len (headers_len, 0, 0));
+        out = gst_buffer_append (out, data);
+      } else if (left > 0) {
         GST_LOG_OBJECT (rtpvrawpay, "we have %u bytes left", left);
         gst_buffer_resize (out, 0, gst_buffer_get_size (out) - left);
       }
 
-      /* push buffer */
-      ret = gst_rtp_base_payload_push (payload, out);
+      gst_buffer_list_add (list, out);
     }
 
+    /* push the packets of the field */
+    ret = gst_rtp_base_payload_push_list (payload, list);
+    list = NULL;
+    if (ret != GST_FLOW_OK)
+      break;
   }
 
   gst_video_frame_unmap (&frame);
@@ -509,6 +557,7 @@ unknown_sampling:
   {
     GST_ELEMENT_ERROR (payload, STREAM, FORMAT,
         (NULL), ("unimplemented sampling"));
+    gst_buffer_list_unref (list);
     gst_video_frame_unmap (&frame);
     gst_buffer_unref (buffer);
     return GST_FLOW_NOT_SUPPORTED;
@@ -58,6 +58,13 @@
  * mapping. One can clear the cached values with the #GstRtpSession::clear-pt-map
  * signal.
  *
+ * Elements that transform the packets of a session, like the srtpenc and
+ * srtpdec SRTP elements, are inserted between the session and its pads when
+ * the application returns them from the #GstRtpBin::request-rtp-encoder,
+ * #GstRtpBin::request-rtp-decoder, #GstRtpBin::request-rtcp-encoder and
+ * #GstRtpBin::request-rtcp-decoder signals. The signals are emitted when the
+ * matching pad is requested.
+ *
  * Access to the internal statistics of gstrtpbin is provided with the
  * get-internal-session property. This action signal gives access to the
  * RTPSession object which further provides action signals to retrieve the
@@ -139,14 +146,14 @@ static GstStaticPadTemplate rtpbin_recv_rtp_sink_template =
 GST_STATIC_PAD_TEMPLATE ("recv_rtp_sink_%u",
     GST_PAD_SINK,
     GST_PAD_REQUEST,
-    GST_STATIC_CAPS ("application/x-rtp")
+    GST_STATIC_CAPS ("application/x-rtp;application/x-srtp")
     );
 
 static GstStaticPadTemplate rtpbin_recv_rtcp_sink_template =
 GST_STATIC_PAD_TEMPLATE ("recv_rtcp_sink_%u",
     GST_PAD_SINK,
     GST_PAD_REQUEST,
-    GST_STATIC_CAPS ("application/x-rtcp")
+    GST_STATIC_CAPS ("application/x-rtcp;application/x-srtcp")
     );
 
 static GstStaticPadTemplate rtpbin_send_rtp_sink_template =
@@ -168,14 +175,14 @@ static GstStaticPadTemplate rtpbin_send_rtcp_src_template =
 GST_STATIC_PAD_TEMPLATE ("send_rtcp_src_%u",
     GST_PAD_SRC,
     GST_PAD_REQUEST,
-    GST_STATIC_CAPS ("application/x-rtcp")
+    GST_STATIC_CAPS ("application/x-rtcp;application/x-srtcp")
     );
 
 static GstStaticPadTemplate rtpbin_send_rtp_src_template =
 GST_STATIC_PAD_TEMPLATE ("send_rtp_src_%u",
     GST_PAD_SRC,
     GST_PAD_SOMETIMES,
-    GST_STATIC_CAPS ("application/x-rtp")
+    GST_STATIC_CAPS ("application/x-rtp;application/x-srtp")
     );
 
 #define GST_RTP_BIN_GET_PRIVATE(obj)  \
@@ -229,6 +236,11 @@ enum
   SIGNAL_RESET_SYNC,
   SIGNAL_GET_INTERNAL_SESSION,
 
+  SIGNAL_REQUEST_RTP_ENCODER,
+  SIGNAL_REQUEST_RTP_DECODER,
+  SIGNAL_REQUEST_RTCP_ENCODER,
+  SIGNAL_REQUEST_RTCP_DECODER,
+
   SIGNAL_ON_NEW_SSRC,
   SIGNAL_ON_SSRC_COLLISION,
   SIGNAL_ON_SSRC_VALIDATED,
@@ -239,6 +251,7 @@ enum
   SIGNAL_ON_TIMEOUT,
   SIGNAL_ON_SENDER_TIMEOUT,
   SIGNAL_ON_NPT_STOP,
+  SIGNAL_ON_TARGET_BITRATE,
   LAST_SIGNAL
 };
 
@@ -253,6 +266,8 @@ enum
 #define DEFAULT_USE_PIPELINE_CLOCK   FALSE
 #define DEFAULT_RTCP_SYNC            GST_RTP_BIN_RTCP_SYNC_ALWAYS
 #define DEFAULT_RTCP_SYNC_INTERVAL   0
+#define DEFAULT_DO_RETRANSMISSION    FALSE
+#define DEFAULT_BANDWIDTH_ESTIMATION RTP_BWE_MODE_NONE
 
 enum
 {
@@ -268,6 +283,8 @@ enum
   PROP_AUTOREMOVE,
   PROP_BUFFER_MODE,
   PROP_USE_PIPELINE_CLOCK,
+  PROP_DO_RETRANSMISSION,
+  PROP_BANDWIDTH_ESTIMATION,
   PROP_LAST
 };
 
@@ -303,6 +320,22 @@ typedef struct _GstRtpBinClient GstRtpBinClient;
 
 static guint gst_rtp_bin_signals[LAST_SIGNAL] = { 0 };
 
+/* stop the emission as soon as a handler returned an element */
+static gboolean
+_gst_element_accumulator (GSignalInvocationHint * ihint,
+    GValue * return_accu, const GValue * handler_return, gpointer dummy)
+{
+  GstElement *element;
+
+  element = g_value_get_object (handler_return);
+  GST_DEBUG ("got element %" GST_PTR_FORMAT, element);
+
+  if (!(ihint->run_type & G_SIGNAL_RUN_CLEANUP))
+    g_value_set_object (return_accu, element);
+
+  return (element == NULL);
+}
+
 static GstCaps *pt_map_requested (GstElement * element, guint pt,
     GstRtpBinSession * session);
 static void payload_type_change (GstElement * element, guint pt,
@@ -400,6 +433,12 @@ struct _GstRtpBinSession
   GstPad *send_rtp_src_ghost;
   GstPad *send_rtcp_src;
   GstPad *send_rtcp_src_ghost;
+
+  /* elements from the request-*-encoder/decoder signals, owned by the bin */
+  GstElement *rtp_encoder;
+  GstElement *rtp_decoder;
+  GstElement *rtcp_encoder;
+  GstElement *rtcp_decoder;
 };
 
 /* Manages the RTP streams that come from one client and should therefore be
@@ -518,6 +557,14 @@ on_sender_timeout (GstElement * session, guint32 ssrc, GstRtpBinSession * sess)
       sess->id, ssrc);
 }
 
+static void
+on_target_bitrate (GstElement * session, guint32 ssrc, guint bitrate,
+    GstRtpBinSession * sess)
+{
+  g_signal_emit (sess->bin, gst_rtp_bin_signals[SIGNAL_ON_TARGET_BITRATE], 0,
+      sess->id, ssrc, bitrate);
+}
+
 static void
 on_npt_stop (GstElement * jbuf, GstRtpBinStream * stream)
 {
@@ -582,7 +629,8 @@ create_session (GstRtpBin * rtpbin, gint id)
   /* configure SDES items */
   GST_OBJECT_LOCK (rtpbin);
   g_object_set (session, "sdes", rtpbin->sdes, "use-pipeline-clock",
-      rtpbin->use_pipeline_clock, NULL);
+      rtpbin->use_pipeline_clock, "bandwidth-estimation", rtpbin->bwe_mode,
+      NULL);
   GST_OBJECT_UNLOCK (rtpbin);
 
   /* provide clock_rate to the session manager when needed */
@@ -606,6 +654,8 @@ create_session (GstRtpBin * rtpbin, gint id)
   g_signal_connect (sess->session, "on-timeout", (GCallback) on_timeout, sess);
   g_signal_connect (sess->session, "on-sender-timeout",
       (GCallback) on_sender_timeout, sess);
+  g_signal_connect (sess->session, "on-target-bitrate",
+      (GCallback) on_target_bitrate, sess);
 
   gst_bin_add (GST_BIN_CAST (rtpbin), session);
   gst_bin_add (GST_BIN_CAST (rtpbin), demux);
@@ -1434,6 +1484,7 @@ create_stream (GstRtpBinSession * session, guint32 ssrc)
   g_object_set (buffer, "latency", rtpbin->latency_ms, NULL);
   g_object_set (buffer, "drop-on-latency", rtpbin->drop_on_latency, NULL);
   g_object_set (buffer, "do-lost", rtpbin->do_lost, NULL);
+  g_object_set (buffer, "do-retransmission", rtpbin->do_retransmission, NULL);
   g_object_set (buffer, "mode", rtpbin->buffer_mode, NULL);
 
   if (!rtpbin->ignore_pt)
@@ -1633,6 +1684,74 @@ gst_rtp_bin_class_init (GstRtpBinClass * klass)
           get_internal_session), NULL, NULL, gst_rtp_bin_marshal_OBJECT__UINT,
       RTP_TYPE_SESSION, 1, G_TYPE_UINT);
 
+  /**
+   * GstRtpBin::request-rtp-encoder:
+   * @rtpbin: the object which received the signal
+   * @session: the session
+   *
+   * Request an element to process the RTP packets that @session sends, for
+   * example a srtpenc. The element needs a "sink" and a "src" pad and is
+   * inserted between the session and the send_rtp_src_\%u pad.
+   *
+   * Returns: a new #GstElement or %NULL to send the packets unchanged.
+   */
+  gst_rtp_bin_signals[SIGNAL_REQUEST_RTP_ENCODER] =
+      g_signal_new ("request-rtp-encoder", G_TYPE_FROM_CLASS (klass),
+      G_SIGNAL_RUN_LAST, G_STRUCT_OFFSET (GstRtpBinClass,
+          request_rtp_encoder), _gst_element_accumulator, NULL,
+      gst_rtp_bin_marshal_OBJECT__UINT, GST_TYPE_ELEMENT, 1, G_TYPE_UINT);
+
+  /**
+   * GstRtpBin::request-rtp-decoder:
+   * @rtpbin: the object which received the signal
+   * @session: the session
+   *
+   * Request an element to process the RTP packets that @session receives, for
+   * example a srtpdec. The element needs a "sink" and a "src" pad and is
+   * inserted between the recv_rtp_sink_\%u pad and the session.
+   *
+   * Returns: a new #GstElement or %NULL to receive the packets unchanged.
+   */
+  gst_rtp_bin_signals[SIGNAL_REQUEST_RTP_DECODER] =
+      g_signal_new ("request-rtp-decoder", G_TYPE_FROM_CLASS (klass),
+      G_SIGNAL_RUN_LAST, G_STRUCT_OFFSET (GstRtpBinClass,
+          request_rtp_decoder), _gst_element_accumulator, NULL,
+      gst_rtp_bin_marshal_OBJECT__UINT, GST_TYPE_ELEMENT, 1, G_TYPE_UINT);
+
+  /**
+   * GstRtpBin::request-rtcp-encoder:
+   * @rtpbin: the object which received the signal
+   * @session: the session
+   *
+   * Request an element to process the RTCP packets that @session sends. The
+   * element needs a "sink" and a "src" pad and is inserted between the
+   * session and the send_rtcp_src_\%u pad.
+   *
+   * Returns: a new #GstElement or %NULL to send the packets unchanged.
+   */
+  gst_rtp_bin_signals[SIGNAL_REQUEST_RTCP_ENCODER] =
+      g_signal_new ("request-rtcp-encoder", G_TYPE_FROM_CLASS (klass),
+      G_SIGNAL_RUN_LAST, G_STRUCT_OFFSET (GstRtpBinClass,
+          request_rtcp_encoder), _gst_element_accumulator, NULL,
+      gst_rtp_bin_marshal_OBJECT__UINT, GST_TYPE_ELEMENT, 1, G_TYPE_UINT);
+
+  /**
+   * GstRtpBin::request-rtcp-decoder:
+   * @rtpbin: the object which received the signal
+   * @session: the session
+   *
+   * Request an element to process the RTCP packets that @session receives.
+   * The element needs a "sink" and a "src" pad and is inserted between the
+   * recv_rtcp_sink_\%u pad and the session.
+   *
+   * Returns: a new #GstElement or %NULL to receive the packets unchanged.
+   */
+  gst_rtp_bin_signals[SIGNAL_REQUEST_RTCP_DECODER] =
+      g_signal_new ("request-rtcp-decoder", G_TYPE_FROM_CLASS (klass),
+      G_SIGNAL_RUN_LAST, G_STRUCT_OFFSET (GstRtpBinClass,
+          request_rtcp_decoder), _gst_element_accumulator, NULL,
+      gst_rtp_bin_marshal_OBJECT__UINT, GST_TYPE_ELEMENT, 1, G_TYPE_UINT);
+
   /**
    * GstRtpBin::on-new-ssrc:
    * @rtpbin: the object which received the signal
@@ -1766,6 +1885,22 @@ gst_rtp_bin_class_init (GstRtpBinClass * klass)
       NULL, NULL, gst_rtp_bin_marshal_VOID__UINT_UINT, G_TYPE_NONE, 2,
       G_TYPE_UINT, G_TYPE_UINT);
 
+  /**
+   * GstRtpBin::on-target-bitrate:
+   * @rtpbin: the object which received the signal
+   * @session: the session
+   * @ssrc: the SSRC of our stream
+   * @bitrate: the target bitrate in bits per second
+   *
+   * Notify that the bandwidth estimation of @session changed the target
+   * bitrate of the stream we send. See #GstRtpBin:bandwidth-estimation.
+   */
+  gst_rtp_bin_signals[SIGNAL_ON_TARGET_BITRATE] =
+      g_signal_new ("on-target-bitrate", G_TYPE_FROM_CLASS (klass),
+      G_SIGNAL_RUN_LAST, G_STRUCT_OFFSET (GstRtpBinClass, on_target_bitrate),
+      NULL, NULL, gst_rtp_bin_marshal_VOID__UINT_UINT_UINT, G_TYPE_NONE, 3,
+      G_TYPE_UINT, G_TYPE_UINT, G_TYPE_UINT);
+
   g_object_class_install_property (gobject_class, PROP_SDES,
       g_param_spec_boxed ("sdes", "SDES",
           "The SDES items of this session",
@@ -1776,6 +1911,32 @@ gst_rtp_bin_class_init (GstRtpBinClass * klass)
           "Send an event downstream when a packet is lost", DEFAULT_DO_LOST,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstRtpBin::do-retransmission:
+   *
+   * Let the jitterbuffers request retransmission of missing packets. The
+   * requests are sent to the sender as RTCP Generic NACK feedback messages.
+   */
+  g_object_class_install_property (gobject_class, PROP_DO_RETRANSMISSION,
+      g_param_spec_boolean ("do-retransmission", "Do retransmission",
+          "Send retransmission events upstream when a packet is late",
+          DEFAULT_DO_RETRANSMISSION,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstRtpBin::bandwidth-estimation:
+   *
+   * Estimate the bitrate the network can carry for the streams we send from
+   * the packet loss, jitter and round trip time in the RTCP receiver reports.
+   * Changes are notified with the #GstRtpBin::on-target-bitrate signal. The
+   * limits can be configured on the internal sessions.
+   */
+  g_object_class_install_property (gobject_class, PROP_BANDWIDTH_ESTIMATION,
+      g_param_spec_enum ("bandwidth-estimation", "Bandwidth Estimation",
+          "Estimate the target bitrate of our streams from the receiver reports",
+          RTP_TYPE_BWE_MODE, DEFAULT_BANDWIDTH_ESTIMATION,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   g_object_class_install_property (gobject_class, PROP_AUTOREMOVE,
       g_param_spec_boolean ("autoremove", "Auto Remove",
           "Automatically remove timed out sources", DEFAULT_AUTOREMOVE,
@@ -1893,6 +2054,8 @@ gst_rtp_bin_init (GstRtpBin * rtpbin)
   rtpbin->latency_ns = DEFAULT_LATENCY_MS * GST_MSECOND;
   rtpbin->drop_on_latency = DEFAULT_DROP_ON_LATENCY;
   rtpbin->do_lost = DEFAULT_DO_LOST;
+  rtpbin->do_retransmission = DEFAULT_DO_RETRANSMISSION;
+  rtpbin->bwe_mode = DEFAULT_BANDWIDTH_ESTIMATION;
   rtpbin->ignore_pt = DEFAULT_IGNORE_PT;
   rtpbin->ntp_sync = DEFAULT_NTP_SYNC;
   rtpbin->rtcp_sync = DEFAULT_RTCP_SYNC;
@@ -2017,6 +2180,28 @@ gst_rtp_bin_set_property (GObject * object, guint prop_id,
       GST_RTP_BIN_UNLOCK (rtpbin);
       gst_rtp_bin_propagate_property_to_jitterbuffer (rtpbin, "do-lost", value);
       break;
+    case PROP_DO_RETRANSMISSION:
+      GST_RTP_BIN_LOCK (rtpbin);
+      rtpbin->do_retransmission = g_value_get_boolean (value);
+      GST_RTP_BIN_UNLOCK (rtpbin);
+      gst_rtp_bin_propagate_property_to_jitterbuffer (rtpbin,
+          "do-retransmission", value);
+      break;
+    case PROP_BANDWIDTH_ESTIMATION:
+    {
+      GSList *sessions;
+      GST_RTP_BIN_LOCK (rtpbin);
+      rtpbin->bwe_mode = g_value_get_enum (value);
+      for (sessions = rtpbin->sessions; sessions;
+          sessions = g_slist_next (sessions)) {
+        GstRtpBinSession *session = (GstRtpBinSession *) sessions->data;
+
+        g_object_set (G_OBJECT (session->session),
+            "bandwidth-estimation", rtpbin->bwe_mode, NULL);
+      }
+      GST_RTP_BIN_UNLOCK (rtpbin);
+    }
+      break;
     case PROP_NTP_SYNC:
       rtpbin->ntp_sync = g_value_get_boolean (value);
       break;
@@ -2087,6 +2272,16 @@ gst_rtp_bin_get_property (GObject * object, guint prop_id,
       g_value_set_boolean (value, rtpbin->do_lost);
       GST_RTP_BIN_UNLOCK (rtpbin);
       break;
+    case PROP_DO_RETRANSMISSION:
+      GST_RTP_BIN_LOCK (rtpbin);
+      g_value_set_boolean (value, rtpbin->do_retransmission);
+      GST_RTP_BIN_UNLOCK (rtpbin);
+      break;
+    case PROP_BANDWIDTH_ESTIMATION:
+      GST_RTP_BIN_LOCK (rtpbin);
+      g_value_set_enum (value, rtpbin->bwe_mode);
+      GST_RTP_BIN_UNLOCK (rtpbin);
+      break;
     case PROP_IGNORE_PT:
       g_value_set_boolean (value, rtpbin->ignore_pt);
       break;
@@ -2592,13 +2787,142 @@ no_stream:
   }
 }
 
+/* Ask the application for the element to insert behind or in front of the
+ * pad requested with @templ and @name. The signals are emitted without
+ * RTP_BIN_LOCK because the handlers usually configure rtpbin. */
+static GstElement *
+request_session_element (GstRtpBin * rtpbin, GstPadTemplate * templ,
+    const gchar * name)
+{
+  GstElementClass *klass = GST_ELEMENT_GET_CLASS (rtpbin);
+  GstElement *elem = NULL;
+  const gchar *format;
+  guint signal, sessid;
+
+  if (templ == gst_element_class_get_pad_template (klass, "recv_rtp_sink_%u"))
+    signal = SIGNAL_REQUEST_RTP_DECODER;
+  else if (templ == gst_element_class_get_pad_template (klass,
+          "recv_rtcp_sink_%u"))
+    signal = SIGNAL_REQUEST_RTCP_DECODER;
+  else if (templ == gst_element_class_get_pad_template (klass,
+          "send_rtp_sink_%u"))
+    signal = SIGNAL_REQUEST_RTP_ENCODER;
+  else if (templ == gst_element_class_get_pad_template (klass,
+          "send_rtcp_src_%u"))
+    signal = SIGNAL_REQUEST_RTCP_ENCODER;
+  else
+    return NULL;
+
+  format = GST_PAD_TEMPLATE_NAME_TEMPLATE (templ);
+  if (name == NULL || sscanf (name, format, &sessid) != 1)
+    return NULL;
+
+  g_signal_emit (rtpbin, gst_rtp_bin_signals[signal], 0, sessid, &elem);
+
+  return elem;
+}
+
+/* Drops an element returned by request_session_element() that was not
+ * inserted */
+static void
+drop_session_element (GstElement * elem)
+{
+  gst_object_ref_sink (elem);
+  gst_object_unref (elem);
+}
+
+/* Insert *@request, the element returned by request_session_element(), in
+ * front of the session sink pad @pad or behind the session source pad @pad.
+ * *@request is set to %NULL when it is used. Returns the pad to ghost, which
+ * is @pad when there is no element. Must be called with RTP_BIN_LOCK.
+ */
+static GstPad *
+session_insert_element (GstRtpBinSession * session, GstElement ** request,
+    GstPad * pad, GstElement ** element)
+{
+  GstRtpBin *rtpbin = session->bin;
+  GstElement *elem = *request;
+  GstPad *sinkpad = NULL, *srcpad = NULL, *result;
+  GstPadLinkReturn lres;
+
+  if (elem == NULL)
+    return gst_object_ref (pad);
+  *request = NULL;
+
+  GST_DEBUG_OBJECT (rtpbin, "inserting %" GST_PTR_FORMAT " in session %d",
+      elem, session->id);
+
+  /* the bin takes the floating reference */
+  if (!gst_bin_add (GST_BIN_CAST (rtpbin), elem))
+    goto add_failed;
+
+  sinkpad = gst_element_get_static_pad (elem, "sink");
+  srcpad = gst_element_get_static_pad (elem, "src");
+  if (sinkpad == NULL || srcpad == NULL)
+    goto no_pads;
+
+  if (GST_PAD_IS_SRC (pad)) {
+    lres = gst_pad_link (pad, sinkpad);
+    result = gst_object_ref (srcpad);
+  } else {
+    lres = gst_pad_link (srcpad, pad);
+    result = gst_object_ref (sinkpad);
+  }
+  gst_object_unref (sinkpad);
+  gst_object_unref (srcpad);
+  if (lres != GST_PAD_LINK_OK)
+    goto link_failed;
+
+  gst_element_sync_state_with_parent (elem);
+  *element = elem;
+
+  return result;
+
+  /* ERRORS */
+add_failed:
+  {
+    g_warning ("rtpbin: could not add %s to the bin", GST_ELEMENT_NAME (elem));
+    gst_object_unref (elem);
+    return NULL;
+  }
+no_pads:
+  {
+    g_warning ("rtpbin: %s has no sink or src pad", GST_ELEMENT_NAME (elem));
+    if (sinkpad)
+      gst_object_unref (sinkpad);
+    if (srcpad)
+      gst_object_unref (srcpad);
+    gst_bin_remove (GST_BIN_CAST (rtpbin), elem);
+    return NULL;
+  }
+link_failed:
+  {
+    g_warning ("rtpbin: failed to link %s", GST_ELEMENT_NAME (elem));
+    gst_object_unref (result);
+    gst_bin_remove (GST_BIN_CAST (rtpbin), elem);
+    return NULL;
+  }
+}
+
+static void
+session_remove_element (GstRtpBinSession * session, GstElement ** element)
+{
+  if (*element) {
+    gst_element_set_locked_state (*element, TRUE);
+    gst_element_set_state (*element, GST_STATE_NULL);
+    gst_bin_remove (GST_BIN_CAST (session->bin), *element);
+    *element = NULL;
+  }
+}
+
 /* Create a pad for receiving RTP for the session in @name. Must be called with
  * RTP_BIN_LOCK.
  */
 static GstPad *
-create_recv_rtp (GstRtpBin * rtpbin, GstPadTemplate * templ, const gchar * name)
+create_recv_rtp (GstRtpBin * rtpbin, GstPadTemplate * templ,
+    const gchar * name, GstElement ** request)
 {
-  GstPad *sinkdpad;
+  GstPad *sinkdpad, *target;
   guint sessid;
   GstRtpBinSession *session;
   GstPadLinkReturn lres;
@@ -2654,9 +2978,15 @@ create_recv_rtp (GstRtpBin * rtpbin, GstPadTemplate * templ, const gchar * name)
   session->demux_padremoved_sig = g_signal_connect (session->demux,
       "removed-ssrc-pad", (GCallback) ssrc_demux_pad_removed, session);
 
+  target = session_insert_element (session, request, session->recv_rtp_sink,
+      &session->rtp_decoder);
+  if (target == NULL)
+    goto insert_failed;
+
   GST_DEBUG_OBJECT (rtpbin, "ghosting session sink pad");
   session->recv_rtp_sink_ghost =
-      gst_ghost_pad_new_from_template (name, session->recv_rtp_sink, templ);
+      gst_ghost_pad_new_from_template (name, target, templ);
+  gst_object_unref (target);
   gst_pad_set_active (session->recv_rtp_sink_ghost, TRUE);
   gst_element_add_pad (GST_ELEMENT_CAST (rtpbin), session->recv_rtp_sink_ghost);
 
@@ -2683,6 +3013,15 @@ link_failed:
     g_warning ("rtpbin: failed to link pads");
     return NULL;
   }
+insert_failed:
+  {
+    /* session_insert_element already warned, undo the links made above */
+    sinkdpad = gst_element_get_static_pad (session->demux, "sink");
+    gst_pad_unlink (session->recv_rtp_src, sinkdpad);
+    gst_object_unref (sinkdpad);
+    remove_recv_rtp (rtpbin, session);
+    return NULL;
+  }
 }
 
 static void
@@ -2711,6 +3050,7 @@ remove_recv_rtp (GstRtpBin * rtpbin, GstRtpBinSession * session)
         session->recv_rtp_sink_ghost);
     session->recv_rtp_sink_ghost = NULL;
   }
+  session_remove_element (session, &session->rtp_decoder);
 }
 
 /* Create a pad for receiving RTCP for the session in @name. Must be called with
@@ -2718,11 +3058,11 @@ remove_recv_rtp (GstRtpBin * rtpbin, GstRtpBinSession * session)
  */
 static GstPad *
 create_recv_rtcp (GstRtpBin * rtpbin, GstPadTemplate * templ,
-    const gchar * name)
+    const gchar * name, GstElement ** request)
 {
   guint sessid;
   GstRtpBinSession *session;
-  GstPad *sinkdpad;
+  GstPad *sinkdpad, *target;
   GstPadLinkReturn lres;
 
   /* first get the session number */
@@ -2765,8 +3105,14 @@ create_recv_rtcp (GstRtpBin * rtpbin, GstPadTemplate * templ,
   if (lres != GST_PAD_LINK_OK)
     goto link_failed;
 
+  target = session_insert_element (session, request, session->recv_rtcp_sink,
+      &session->rtcp_decoder);
+  if (target == NULL)
+    goto insert_failed;
+
   session->recv_rtcp_sink_ghost =
-      gst_ghost_pad_new_from_template (name, session->recv_rtcp_sink, templ);
+      gst_ghost_pad_new_from_template (name, target, templ);
+  gst_object_unref (target);
   gst_pad_set_active (session->recv_rtcp_sink_ghost, TRUE);
   gst_element_add_pad (GST_ELEMENT_CAST (rtpbin),
       session->recv_rtcp_sink_ghost);
@@ -2794,6 +3140,15 @@ link_failed:
     g_warning ("rtpbin: failed to link pads");
     return NULL;
   }
+insert_failed:
+  {
+    /* session_insert_element already warned, undo the links made above */
+    sinkdpad = gst_element_get_static_pad (session->demux, "rtcp_sink");
+    gst_pad_unlink (session->sync_src, sinkdpad);
+    gst_object_unref (sinkdpad);
+    remove_recv_rtcp (rtpbin, session);
+    return NULL;
+  }
 }
 
 static void
@@ -2815,18 +3170,21 @@ remove_recv_rtcp (GstRtpBin * rtpbin, GstRtpBinSession * session)
     gst_object_unref (session->recv_rtcp_sink);
     session->recv_rtcp_sink = NULL;
   }
+  session_remove_element (session, &session->rtcp_decoder);
 }
 
 /* Create a pad for sending RTP for the session in @name. Must be called with
  * RTP_BIN_LOCK.
  */
 static GstPad *
-create_send_rtp (GstRtpBin * rtpbin, GstPadTemplate * templ, const gchar * name)
+create_send_rtp (GstRtpBin * rtpbin, GstPadTemplate * templ,
+    const gchar * name, GstElement ** request)
 {
   gchar *gname;
   guint sessid;
   GstRtpBinSession *session;
   GstElementClass *klass;
+  GstPad *target;
 
   /* first get the session number */
   if (name == NULL || sscanf (name, "send_rtp_sink_%u", &sessid) != 1)
@@ -2862,12 +3220,18 @@ create_send_rtp (GstRtpBin * rtpbin, GstPadTemplate * templ, const gchar * name)
   if (session->send_rtp_src == NULL)
     goto no_srcpad;
 
+  target = session_insert_element (session, request, session->send_rtp_src,
+      &session->rtp_encoder);
+  if (target == NULL)
+    goto insert_failed;
+
   /* ghost the new source pad */
   klass = GST_ELEMENT_GET_CLASS (rtpbin);
   gname = g_strdup_printf ("send_rtp_src_%u", sessid);
   templ = gst_element_class_get_pad_template (klass, "send_rtp_src_%u");
   session->send_rtp_src_ghost =
-      gst_ghost_pad_new_from_template (gname, session->send_rtp_src, templ);
+      gst_ghost_pad_new_from_template (gname, target, templ);
+  gst_object_unref (target);
   gst_pad_set_active (session->send_rtp_src_ghost, TRUE);
   gst_element_add_pad (GST_ELEMENT_CAST (rtpbin), session->send_rtp_src_ghost);
   g_free (gname);
@@ -2895,6 +3259,13 @@ no_srcpad:
     g_warning ("rtpbin: failed to get rtp source pad for session %d", sessid);
     return NULL;
   }
+insert_failed:
+  {
+    /* session_insert_element already warned, release the session pads and
+     * remove the sink ghost pad */
+    remove_send_rtp (rtpbin, session);
+    return NULL;
+  }
 }
 
 static void
@@ -2906,6 +3277,7 @@ remove_send_rtp (GstRtpBin * rtpbin, GstRtpBinSession * session)
         session->send_rtp_src_ghost);
     session->send_rtp_src_ghost = NULL;
   }
+  session_remove_element (session, &session->rtp_encoder);
   if (session->send_rtp_src) {
     gst_object_unref (session->send_rtp_src);
     session->send_rtp_src = NULL;
@@ -2928,10 +3300,12 @@ remove_send_rtp (GstRtpBin * rtpbin, GstRtpBinSession * session)
  * RTP_BIN_LOCK.
  */
 static GstPad *
-create_rtcp (GstRtpBin * rtpbin, GstPadTemplate * templ, const gchar * name)
+create_rtcp (GstRtpBin * rtpbin, GstPadTemplate * templ,
+    const gchar * name, GstElement ** request)
 {
   guint sessid;
   GstRtpBinSession *session;
+  GstPad *target;
 
   /* first get the session number */
   if (name == NULL || sscanf (name, "send_rtcp_src_%u", &sessid) != 1)
@@ -2952,8 +3326,14 @@ create_rtcp (GstRtpBin * rtpbin, GstPadTemplate * templ, const gchar * name)
   if (session->send_rtcp_src == NULL)
     goto pad_failed;
 
+  target = session_insert_element (session, request, session->send_rtcp_src,
+      &session->rtcp_encoder);
+  if (target == NULL)
+    goto insert_failed;
+
   session->send_rtcp_src_ghost =
-      gst_ghost_pad_new_from_template (name, session->send_rtcp_src, templ);
+      gst_ghost_pad_new_from_template (name, target, templ);
+  gst_object_unref (target);
   gst_pad_set_active (session->send_rtcp_src_ghost, TRUE);
   gst_element_add_pad (GST_ELEMENT_CAST (rtpbin), session->send_rtcp_src_ghost);
 
@@ -2975,6 +3355,12 @@ pad_failed:
     g_warning ("rtpbin: failed to get rtcp pad for session %d", sessid);
     return NULL;
   }
+insert_failed:
+  {
+    /* session_insert_element already warned */
+    remove_rtcp (rtpbin, session);
+    return NULL;
+  }
 }
 
 static void
@@ -2986,6 +3372,7 @@ remove_rtcp (GstRtpBin * rtpbin, GstRtpBinSession * session)
         session->send_rtcp_src_ghost);
     session->send_rtcp_src_ghost = NULL;
   }
+  session_remove_element (session, &session->rtcp_encoder);
   if (session->send_rtcp_src) {
     gst_element_release_request_pad (session->session, session->send_rtcp_src);
     gst_object_unref (session->send_rtcp_src);
@@ -3059,6 +3446,7 @@ gst_rtp_bin_request_new_pad (GstElement * element,
 {
   GstRtpBin *rtpbin;
   GstElementClass *klass;
+  GstElement *request;
   GstPad *result;
 
   gchar *pad_name = NULL;
@@ -3070,7 +3458,6 @@ gst_rtp_bin_request_new_pad (GstElement * element,
   klass = GST_ELEMENT_GET_CLASS (element);
 
   GST_RTP_BIN_LOCK (rtpbin);
-
   if (name == NULL) {
     /* use a free pad name */
     pad_name = gst_rtp_bin_get_free_pad_name (element, templ);
@@ -3078,34 +3465,41 @@ gst_rtp_bin_request_new_pad (GstElement * element,
     /* use the provided name */
     pad_name = g_strdup (name);
   }
+  GST_RTP_BIN_UNLOCK (rtpbin);
 
   GST_DEBUG_OBJECT (rtpbin, "Trying to request a pad with name %s", pad_name);
 
+  request = request_session_element (rtpbin, templ, pad_name);
+
+  GST_RTP_BIN_LOCK (rtpbin);
   /* figure out the template */
   if (templ == gst_element_class_get_pad_template (klass, "recv_rtp_sink_%u")) {
-    result = create_recv_rtp (rtpbin, templ, pad_name);
+    result = create_recv_rtp (rtpbin, templ, pad_name, &request);
   } else if (templ == gst_element_class_get_pad_template (klass,
           "recv_rtcp_sink_%u")) {
-    result = create_recv_rtcp (rtpbin, templ, pad_name);
+    result = create_recv_rtcp (rtpbin, templ, pad_name, &request);
   } else if (templ == gst_element_class_get_pad_template (klass,
           "send_rtp_sink_%u")) {
-    result = create_send_rtp (rtpbin, templ, pad_name);
+    result = create_send_rtp (rtpbin, templ, pad_name, &request);
   } else if (templ == gst_element_class_get_pad_template (klass,
           "send_rtcp_src_%u")) {
-    result = create_rtcp (rtpbin, templ, pad_name);
+    result = create_rtcp (rtpbin, templ, pad_name, &request);
   } else
     goto wrong_template;
+  GST_RTP_BIN_UNLOCK (rtpbin);
 
+  /* the pad already existed or could not be created */
+  if (request)
+    drop_session_element (request);
   g_free (pad_name);
-  GST_RTP_BIN_UNLOCK (rtpbin);
 
   return result;
 
   /* ERRORS */
 wrong_template:
   {
-    g_free (pad_name);
     GST_RTP_BIN_UNLOCK (rtpbin);
+    g_free (pad_name);
     g_warning ("rtpbin: this is not our template");
     return NULL;
   }
@@ -49,6 +49,8 @@ struct _GstRtpBin {
   guint64         latency_ns;
   gboolean        drop_on_latency;
   gboolean        do_lost;
+  gboolean        do_retransmission;
+  RTPBweMode      bwe_mode;
   gboolean        ignore_pt;
   gboolean        ntp_sync;
   gint            rtcp_sync;
@@ -83,6 +85,12 @@ struct _GstRtpBinClass {
   void        (*reset_sync)           (GstRtpBin *rtpbin);
   RTPSession* (*get_internal_session) (GstRtpBin *rtpbin, guint session_id);
 
+  /* elements inserted in the path of a session */
+  GstElement* (*request_rtp_encoder)  (GstRtpBin *rtpbin, guint session);
+  GstElement* (*request_rtp_decoder)  (GstRtpBin *rtpbin, guint session);
+  GstElement* (*request_rtcp_encoder) (GstRtpBin *rtpbin, guint session);
+  GstElement* (*request_rtcp_decoder) (GstRtpBin *rtpbin, guint session);
+
   /* session manager signals */
   void     (*on_new_ssrc)       (GstRtpBin *rtpbin, guint session, guint32 ssrc);
   void     (*on_ssrc_collision) (GstRtpBin *rtpbin, guint session, guint32 ssrc);
@@ -94,6 +102,8 @@ struct _GstRtpBinClass {
   void     (*on_timeout)        (GstRtpBin *rtpbin, guint session, guint32 ssrc);
   void     (*on_sender_timeout) (GstRtpBin *rtpbin, guint session, guint32 ssrc);
   void     (*on_npt_stop)       (GstRtpBin *rtpbin, guint session, guint32 ssrc);
+  void     (*on_target_bitrate) (GstRtpBin *rtpbin, guint session, guint32 ssrc,
+                                 guint bitrate);
 };
 
 GType gst_rtp_bin_get_type (void);
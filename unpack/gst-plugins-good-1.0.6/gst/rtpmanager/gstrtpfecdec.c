@@ -0,0 +1,616 @@
+/* RTP FEC decoder element for GStreamer
+ *
+ * gstrtpfecdec.c:
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/**
+ * SECTION:element-rtpfecdec
+ * @see_also: rtpfecenc, rtpjitterbuffer
+ *
+ * The rtpfecdec element recovers lost RTP packets with the XOR FEC packets
+ * made by #GstRtpFecEnc.
+ *
+ * The FEC packets are recognised by their payload type #GstRtpFecDec:pt and
+ * are not forwarded. Media packets are forwarded immediately and kept for
+ * some time. When all but one of the packets protected by a FEC packet are
+ * received, the missing packet is reconstructed and pushed downstream.
+ *
+ * The element is usually placed before the recv_rtp_sink pad of #GstRtpBin
+ * so that the recovered packets are reordered by the jitterbuffer and
+ * arrive there before the packet is considered lost.
+ *
+ * <refsect2>
+ * <title>Example pipeline</title>
+ * |[
+ * gst-launch-1.0 udpsrc port=5000 caps="application/x-rtp, media=video, clock-rate=90000, encoding-name=MP2T" ! \
+ *     rtpfecdec format=smpte-2022-1 pt=96 ! rtpjitterbuffer ! rtpmp2tdepay ! \
+ *     tsdemux ! h264parse ! avdec_h264 ! videoconvert ! autovideosink
+ * ]| Receive an MPEG-TS stream protected with SMPTE 2022-1 FEC.
+ * </refsect2>
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <string.h>
+
+#include <gst/rtp/gstrtpbuffer.h>
+
+#include "gstrtpfecdec.h"
+
+GST_DEBUG_CATEGORY_STATIC (gst_rtp_fec_dec_debug);
+#define GST_CAT_DEFAULT gst_rtp_fec_dec_debug
+
+#define DEFAULT_FORMAT   RTP_FEC_FORMAT_ULPFEC
+#define DEFAULT_PT       127
+
+/* keep at most this many FEC packets waiting for media packets */
+#define MAX_FEC_PACKETS  256
+
+enum
+{
+  PROP_0,
+  PROP_FORMAT,
+  PROP_PT,
+  PROP_NUM_RECOVERED,
+  PROP_NUM_UNRECOVERED,
+  PROP_LAST
+};
+
+typedef struct
+{
+  RTPFecHeader header;
+  RTPFecXor xor;
+  /* the number of protected packets we don't have */
+  guint missing;
+  /* our link in fec_packets */
+  GList *link;
+} FecPacket;
+
+static GstStaticPadTemplate src_factory = GST_STATIC_PAD_TEMPLATE ("src",
+    GST_PAD_SRC,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS ("application/x-rtp")
+    );
+
+static GstStaticPadTemplate sink_factory = GST_STATIC_PAD_TEMPLATE ("sink",
+    GST_PAD_SINK,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS ("application/x-rtp")
+    );
+
+static GstFlowReturn gst_rtp_fec_dec_chain (GstPad * pad, GstObject * parent,
+    GstBuffer * buffer);
+static gboolean gst_rtp_fec_dec_sink_event (GstPad * pad, GstObject * parent,
+    GstEvent * event);
+
+static GstStateChangeReturn gst_rtp_fec_dec_change_state (GstElement *
+    element, GstStateChange transition);
+
+static void gst_rtp_fec_dec_set_property (GObject * object, guint prop_id,
+    const GValue * value, GParamSpec * pspec);
+static void gst_rtp_fec_dec_get_property (GObject * object, guint prop_id,
+    GValue * value, GParamSpec * pspec);
+static void gst_rtp_fec_dec_finalize (GObject * object);
+
+G_DEFINE_TYPE (GstRtpFecDec, gst_rtp_fec_dec, GST_TYPE_ELEMENT);
+
+static void
+gst_rtp_fec_dec_class_init (GstRtpFecDecClass * klass)
+{
+  GObjectClass *gobject_class;
+  GstElementClass *gstelement_class;
+
+  gobject_class = (GObjectClass *) klass;
+  gstelement_class = (GstElementClass *) klass;
+
+  gobject_class->get_property = gst_rtp_fec_dec_get_property;
+  gobject_class->set_property = gst_rtp_fec_dec_set_property;
+  gobject_class->finalize = gst_rtp_fec_dec_finalize;
+
+  g_object_class_install_property (gobject_class, PROP_FORMAT,
+      g_param_spec_enum ("format", "Format", "The FEC header format",
+          RTP_TYPE_FEC_FORMAT, DEFAULT_FORMAT,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS |
+          GST_PARAM_MUTABLE_READY));
+
+  g_object_class_install_property (gobject_class, PROP_PT,
+      g_param_spec_uint ("pt", "Payload Type",
+          "The payload type of the FEC packets", 0, 127, DEFAULT_PT,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS |
+          GST_PARAM_MUTABLE_READY));
+
+  g_object_class_install_property (gobject_class, PROP_NUM_RECOVERED,
+      g_param_spec_uint ("num-recovered", "Num Recovered",
+          "Number of packets recovered", 0, G_MAXUINT, 0,
+          G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+
+  g_object_class_install_property (gobject_class, PROP_NUM_UNRECOVERED,
+      g_param_spec_uint ("num-unrecovered", "Num Unrecovered",
+          "Number of FEC packets that expired with too many packets missing",
+          0, G_MAXUINT, 0, G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+
+  gst_element_class_add_pad_template (gstelement_class,
+      gst_static_pad_template_get (&src_factory));
+  gst_element_class_add_pad_template (gstelement_class,
+      gst_static_pad_template_get (&sink_factory));
+
+  gst_element_class_set_static_metadata (gstelement_class,
+      "RTP FEC decoder", "Filter/Network/RTP",
+      "Recover lost RTP packets with XOR forward error correction packets",
+      "GStreamer maintainers <gstreamer-devel@lists.freedesktop.org>");
+
+  gstelement_class->change_state =
+      GST_DEBUG_FUNCPTR (gst_rtp_fec_dec_change_state);
+
+  GST_DEBUG_CATEGORY_INIT (gst_rtp_fec_dec_debug, "rtpfecdec", 0,
+      "RTP FEC decoder");
+}
+
+static void
+free_fec_packet (FecPacket * packet)
+{
+  rtp_fec_xor_clear (&packet->xor);
+  g_slice_free (FecPacket, packet);
+}
+
+static gboolean
+free_index_list (gpointer key, GList * list, gpointer user_data)
+{
+  g_list_free (list);
+  return TRUE;
+}
+
+static void
+gst_rtp_fec_dec_reset (GstRtpFecDec * dec)
+{
+  FecPacket *packet;
+  guint i;
+
+  for (i = 0; i < GST_RTP_FEC_DEC_MEDIA_SIZE; i++) {
+    if (dec->media[i]) {
+      gst_buffer_unref (dec->media[i]);
+      dec->media[i] = NULL;
+    }
+  }
+  g_hash_table_foreach_remove (dec->fec_index, (GHRFunc) free_index_list,
+      NULL);
+  while ((packet = g_queue_pop_head (&dec->fec_packets)))
+    free_fec_packet (packet);
+  dec->have_seqnum = FALSE;
+}
+
+static void
+gst_rtp_fec_dec_finalize (GObject * object)
+{
+  GstRtpFecDec *dec = GST_RTP_FEC_DEC (object);
+
+  gst_rtp_fec_dec_reset (dec);
+  g_hash_table_unref (dec->fec_index);
+
+  G_OBJECT_CLASS (gst_rtp_fec_dec_parent_class)->finalize (object);
+}
+
+static void
+gst_rtp_fec_dec_init (GstRtpFecDec * dec)
+{
+  GstElementClass *klass = GST_ELEMENT_GET_CLASS (dec);
+
+  dec->srcpad =
+      gst_pad_new_from_template (gst_element_class_get_pad_template (klass,
+          "src"), "src");
+  GST_PAD_SET_PROXY_CAPS (dec->srcpad);
+  GST_PAD_SET_PROXY_ALLOCATION (dec->srcpad);
+  gst_element_add_pad (GST_ELEMENT (dec), dec->srcpad);
+
+  dec->sinkpad =
+      gst_pad_new_from_template (gst_element_class_get_pad_template (klass,
+          "sink"), "sink");
+  GST_PAD_SET_PROXY_CAPS (dec->sinkpad);
+  GST_PAD_SET_PROXY_ALLOCATION (dec->sinkpad);
+  gst_pad_set_chain_function (dec->sinkpad,
+      GST_DEBUG_FUNCPTR (gst_rtp_fec_dec_chain));
+  gst_pad_set_event_function (dec->sinkpad,
+      GST_DEBUG_FUNCPTR (gst_rtp_fec_dec_sink_event));
+  gst_element_add_pad (GST_ELEMENT (dec), dec->sinkpad);
+
+  dec->format = DEFAULT_FORMAT;
+  dec->pt = DEFAULT_PT;
+  g_queue_init (&dec->fec_packets);
+  dec->fec_index = g_hash_table_new (g_direct_hash, g_direct_equal);
+}
+
+static GstBuffer *
+gst_rtp_fec_dec_get_media (GstRtpFecDec * dec, guint16 seqnum)
+{
+  guint idx = seqnum % GST_RTP_FEC_DEC_MEDIA_SIZE;
+
+  if (dec->media[idx] && dec->media_seqnum[idx] == seqnum)
+    return dec->media[idx];
+
+  return NULL;
+}
+
+static void
+gst_rtp_fec_dec_store_media (GstRtpFecDec * dec, GstBuffer * buffer,
+    guint16 seqnum)
+{
+  guint idx = seqnum % GST_RTP_FEC_DEC_MEDIA_SIZE;
+
+  if (dec->media[idx])
+    gst_buffer_unref (dec->media[idx]);
+  dec->media[idx] = gst_buffer_ref (buffer);
+  dec->media_seqnum[idx] = seqnum;
+
+  if (!dec->have_seqnum
+      || gst_rtp_buffer_compare_seqnum (dec->max_seqnum, seqnum) > 0) {
+    dec->max_seqnum = seqnum;
+    dec->have_seqnum = TRUE;
+  }
+}
+
+/* remove @packet from the lists of the seqnums it is waiting for */
+static void
+gst_rtp_fec_dec_unindex (GstRtpFecDec * dec, FecPacket * packet)
+{
+  guint i;
+
+  for (i = 0; i < packet->header.n_seqnums; i++) {
+    gpointer key = GUINT_TO_POINTER (packet->header.seqnums[i]);
+    GList *list, *link;
+
+    list = g_hash_table_lookup (dec->fec_index, key);
+    if ((link = g_list_find (list, packet)) == NULL)
+      continue;
+
+    list = g_list_delete_link (list, link);
+    if (list)
+      g_hash_table_insert (dec->fec_index, key, list);
+    else
+      g_hash_table_remove (dec->fec_index, key);
+  }
+}
+
+/* add @packet to the list of each protected seqnum we don't have. When it
+ * can already recover a packet it is added to @ready */
+static void
+gst_rtp_fec_dec_add_fec (GstRtpFecDec * dec, FecPacket * packet,
+    GQueue * ready)
+{
+  guint i;
+
+  packet->missing = 0;
+  for (i = 0; i < packet->header.n_seqnums; i++) {
+    gpointer key = GUINT_TO_POINTER (packet->header.seqnums[i]);
+
+    if (gst_rtp_fec_dec_get_media (dec, packet->header.seqnums[i]))
+      continue;
+
+    g_hash_table_insert (dec->fec_index, key,
+        g_list_prepend (g_hash_table_lookup (dec->fec_index, key), packet));
+    packet->missing++;
+  }
+  g_queue_push_tail (&dec->fec_packets, packet);
+  packet->link = dec->fec_packets.tail;
+
+  if (packet->missing <= 1)
+    g_queue_push_tail (ready, packet);
+}
+
+/* the media packet @seqnum arrived, update the FEC packets that were waiting
+ * for it. A FEC packet is added to @ready once, when it misses only one
+ * packet */
+static void
+gst_rtp_fec_dec_media_arrived (GstRtpFecDec * dec, guint16 seqnum,
+    GQueue * ready)
+{
+  gpointer key = GUINT_TO_POINTER (seqnum);
+  GList *list, *walk;
+
+  if ((list = g_hash_table_lookup (dec->fec_index, key)) == NULL)
+    return;
+
+  g_hash_table_remove (dec->fec_index, key);
+  for (walk = list; walk; walk = walk->next) {
+    FecPacket *packet = walk->data;
+
+    if (--packet->missing == 1)
+      g_queue_push_tail (ready, packet);
+  }
+  g_list_free (list);
+}
+
+/* drop the FEC packets that protect packets that are no longer kept. FEC
+ * packets arrive in about the order of the packets they protect so we only
+ * look at the oldest ones. Call when no FEC packet is waiting in a ready
+ * queue. */
+static void
+gst_rtp_fec_dec_expire (GstRtpFecDec * dec)
+{
+  FecPacket *packet;
+
+  while ((packet = g_queue_peek_head (&dec->fec_packets))) {
+    guint16 last;
+
+    last = packet->header.seqnums[packet->header.n_seqnums - 1];
+    if (g_queue_get_length (&dec->fec_packets) <= MAX_FEC_PACKETS &&
+        gst_rtp_buffer_compare_seqnum (last, dec->max_seqnum) <
+        GST_RTP_FEC_DEC_MEDIA_SIZE / 2)
+      break;
+
+    GST_DEBUG_OBJECT (dec, "FEC packet for #%u expired",
+        packet->header.sn_base);
+    g_queue_pop_head (&dec->fec_packets);
+    gst_rtp_fec_dec_unindex (dec, packet);
+    free_fec_packet (packet);
+    dec->num_unrecovered++;
+  }
+}
+
+/* use the FEC packets in @ready to recover their missing packet, the
+ * recovered packets are added to @recovered. Call with OBJECT_LOCK */
+static void
+gst_rtp_fec_dec_recover (GstRtpFecDec * dec, GstBuffer * trigger,
+    GQueue * ready, GQueue * recovered)
+{
+  FecPacket *packet;
+
+  while ((packet = g_queue_pop_head (ready))) {
+    RTPFecXor xor;
+    GstBuffer *buffer;
+    guint i, missing = 0;
+    guint16 lost = 0;
+
+    g_queue_delete_link (&dec->fec_packets, packet->link);
+    gst_rtp_fec_dec_unindex (dec, packet);
+
+    /* all protected packets arrived in the meantime */
+    if (packet->missing == 0) {
+      free_fec_packet (packet);
+      continue;
+    }
+
+    for (i = 0; i < packet->header.n_seqnums; i++) {
+      if (!gst_rtp_fec_dec_get_media (dec, packet->header.seqnums[i])) {
+        lost = packet->header.seqnums[i];
+        missing++;
+      }
+    }
+    /* a protected packet was pushed out of the media history */
+    if (missing != 1) {
+      GST_DEBUG_OBJECT (dec, "FEC packet for #%u expired",
+          packet->header.sn_base);
+      free_fec_packet (packet);
+      dec->num_unrecovered++;
+      continue;
+    }
+
+    xor = packet->xor;
+    xor.data = g_memdup (packet->xor.data, packet->xor.size);
+    for (i = 0; i < packet->header.n_seqnums; i++) {
+      if (packet->header.seqnums[i] != lost)
+        rtp_fec_xor_add_packet (&xor, gst_rtp_fec_dec_get_media (dec,
+                packet->header.seqnums[i]));
+    }
+
+    buffer = rtp_fec_xor_to_packet (&xor, packet->header.recover_header,
+        lost, dec->ssrc);
+    rtp_fec_xor_clear (&xor);
+    free_fec_packet (packet);
+
+    if (buffer) {
+      GST_DEBUG_OBJECT (dec, "recovered packet #%u", lost);
+      gst_buffer_copy_into (buffer, trigger, GST_BUFFER_COPY_TIMESTAMPS,
+          0, -1);
+      gst_rtp_fec_dec_store_media (dec, buffer, lost);
+      g_queue_push_tail (recovered, buffer);
+      dec->num_recovered++;
+      /* which can make other FEC packets usable */
+      gst_rtp_fec_dec_media_arrived (dec, lost, ready);
+    } else {
+      GST_WARNING_OBJECT (dec, "invalid recovered length for #%u", lost);
+      dec->num_unrecovered++;
+    }
+  }
+}
+
+static GstFlowReturn
+gst_rtp_fec_dec_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
+{
+  GstRtpFecDec *dec = GST_RTP_FEC_DEC (parent);
+  GstRTPBuffer rtp = GST_RTP_BUFFER_INIT;
+  GstFlowReturn ret = GST_FLOW_OK;
+  GQueue ready = G_QUEUE_INIT;
+  GQueue recovered = G_QUEUE_INIT;
+  GstBuffer *outbuf;
+  guint8 pt;
+  guint16 seqnum;
+  guint32 ssrc;
+
+  if (G_UNLIKELY (!gst_rtp_buffer_map (buffer, GST_MAP_READ, &rtp)))
+    goto invalid_buffer;
+
+  pt = gst_rtp_buffer_get_payload_type (&rtp);
+  seqnum = gst_rtp_buffer_get_seq (&rtp);
+  ssrc = gst_rtp_buffer_get_ssrc (&rtp);
+  gst_rtp_buffer_unmap (&rtp);
+
+  GST_OBJECT_LOCK (dec);
+  if (pt == dec->pt) {
+    FecPacket *packet = g_slice_new (FecPacket);
+
+    rtp_fec_xor_init (&packet->xor);
+    if (!rtp_fec_parse (buffer, dec->format, &packet->header, &packet->xor)) {
+      GST_OBJECT_UNLOCK (dec);
+      free_fec_packet (packet);
+      goto invalid_fec;
+    }
+    GST_LOG_OBJECT (dec, "FEC packet #%u for #%u, %u packets", seqnum,
+        packet->header.sn_base, packet->header.n_seqnums);
+    gst_rtp_fec_dec_add_fec (dec, packet, &ready);
+    gst_rtp_fec_dec_recover (dec, buffer, &ready, &recovered);
+    GST_OBJECT_UNLOCK (dec);
+
+    /* FEC packets are not forwarded */
+    gst_buffer_unref (buffer);
+  } else {
+    dec->ssrc = ssrc;
+    gst_rtp_fec_dec_store_media (dec, buffer, seqnum);
+    gst_rtp_fec_dec_expire (dec);
+    gst_rtp_fec_dec_media_arrived (dec, seqnum, &ready);
+    gst_rtp_fec_dec_recover (dec, buffer, &ready, &recovered);
+    GST_OBJECT_UNLOCK (dec);
+
+    ret = gst_pad_push (dec->srcpad, buffer);
+  }
+
+  while ((outbuf = g_queue_pop_head (&recovered))) {
+    if (ret == GST_FLOW_OK)
+      ret = gst_pad_push (dec->srcpad, outbuf);
+    else
+      gst_buffer_unref (outbuf);
+  }
+
+  return ret;
+
+  /* ERRORS */
+invalid_buffer:
+  {
+    GST_ELEMENT_WARNING (dec, STREAM, DECODE, (NULL),
+        ("Received invalid RTP payload, dropping"));
+    gst_buffer_unref (buffer);
+    return GST_FLOW_OK;
+  }
+invalid_fec:
+  {
+    GST_DEBUG_OBJECT (dec, "dropping invalid FEC packet #%u", seqnum);
+    gst_buffer_unref (buffer);
+    return GST_FLOW_OK;
+  }
+}
+
+static gboolean
+gst_rtp_fec_dec_sink_event (GstPad * pad, GstObject * parent,
+    GstEvent * event)
+{
+  GstRtpFecDec *dec = GST_RTP_FEC_DEC (parent);
+
+  switch (GST_EVENT_TYPE (event)) {
+    case GST_EVENT_FLUSH_STOP:
+      GST_OBJECT_LOCK (dec);
+      gst_rtp_fec_dec_reset (dec);
+      GST_OBJECT_UNLOCK (dec);
+      break;
+    default:
+      break;
+  }
+
+  return gst_pad_event_default (pad, parent, event);
+}
+
+static void
+gst_rtp_fec_dec_set_property (GObject * object,
+    guint prop_id, const GValue * value, GParamSpec * pspec)
+{
+  GstRtpFecDec *dec = GST_RTP_FEC_DEC (object);
+
+  switch (prop_id) {
+    case PROP_FORMAT:
+      GST_OBJECT_LOCK (dec);
+      dec->format = g_value_get_enum (value);
+      GST_OBJECT_UNLOCK (dec);
+      break;
+    case PROP_PT:
+      GST_OBJECT_LOCK (dec);
+      dec->pt = g_value_get_uint (value);
+      GST_OBJECT_UNLOCK (dec);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
+static void
+gst_rtp_fec_dec_get_property (GObject * object,
+    guint prop_id, GValue * value, GParamSpec * pspec)
+{
+  GstRtpFecDec *dec = GST_RTP_FEC_DEC (object);
+
+  switch (prop_id) {
+    case PROP_FORMAT:
+      GST_OBJECT_LOCK (dec);
+      g_value_set_enum (value, dec->format);
+      GST_OBJECT_UNLOCK (dec);
+      break;
+    case PROP_PT:
+      GST_OBJECT_LOCK (dec);
+      g_value_set_uint (value, dec->pt);
+      GST_OBJECT_UNLOCK (dec);
+      break;
+    case PROP_NUM_RECOVERED:
+      GST_OBJECT_LOCK (dec);
+      g_value_set_uint (value, dec->num_recovered);
+      GST_OBJECT_UNLOCK (dec);
+      break;
+    case PROP_NUM_UNRECOVERED:
+      GST_OBJECT_LOCK (dec);
+      g_value_set_uint (value, dec->num_unrecovered);
+      GST_OBJECT_UNLOCK (dec);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
+static GstStateChangeReturn
+gst_rtp_fec_dec_change_state (GstElement * element, GstStateChange transition)
+{
+  GstRtpFecDec *dec = GST_RTP_FEC_DEC (element);
+  GstStateChangeReturn ret;
+
+  switch (transition) {
+    case GST_STATE_CHANGE_READY_TO_PAUSED:
+      GST_OBJECT_LOCK (dec);
+      gst_rtp_fec_dec_reset (dec);
+      dec->num_recovered = 0;
+      dec->num_unrecovered = 0;
+      GST_OBJECT_UNLOCK (dec);
+      break;
+    default:
+      break;
+  }
+
+  ret =
+      GST_ELEMENT_CLASS (gst_rtp_fec_dec_parent_class)->change_state (element,
+      transition);
+
+  switch (transition) {
+    case GST_STATE_CHANGE_PAUSED_TO_READY:
+      GST_OBJECT_LOCK (dec);
+      gst_rtp_fec_dec_reset (dec);
+      GST_OBJECT_UNLOCK (dec);
+      break;
+    default:
+      break;
+  }
+
+  return ret;
+}
@@ -0,0 +1,79 @@
+/* RTP FEC decoder element for GStreamer
+ *
+ * gstrtpfecdec.h:
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#ifndef __GST_RTP_FEC_DEC_H__
+#define __GST_RTP_FEC_DEC_H__
+
+#include <gst/gst.h>
+
+#include "rtpfec.h"
+
+G_BEGIN_DECLS
+
+#define GST_TYPE_RTP_FEC_DEC (gst_rtp_fec_dec_get_type())
+#define GST_RTP_FEC_DEC(obj) (G_TYPE_CHECK_INSTANCE_CAST((obj),GST_TYPE_RTP_FEC_DEC,GstRtpFecDec))
+#define GST_RTP_FEC_DEC_CLASS(klass) (G_TYPE_CHECK_CLASS_CAST((klass),GST_TYPE_RTP_FEC_DEC,GstRtpFecDecClass))
+#define GST_IS_RTP_FEC_DEC(obj) (G_TYPE_CHECK_INSTANCE_TYPE((obj),GST_TYPE_RTP_FEC_DEC))
+#define GST_IS_RTP_FEC_DEC_CLASS(klass) (G_TYPE_CHECK_CLASS_TYPE((klass),GST_TYPE_RTP_FEC_DEC))
+
+typedef struct _GstRtpFecDec GstRtpFecDec;
+typedef struct _GstRtpFecDecClass GstRtpFecDecClass;
+
+/* number of media packets kept for recovery */
+#define GST_RTP_FEC_DEC_MEDIA_SIZE 1024
+
+struct _GstRtpFecDec
+{
+  GstElement element;
+
+  /* pad */
+  GstPad *sinkpad;
+  GstPad *srcpad;
+
+  RTPFecFormat format;
+  guint8 pt;
+
+  /* the last media packets, indexed by seqnum */
+  GstBuffer *media[GST_RTP_FEC_DEC_MEDIA_SIZE];
+  guint16 media_seqnum[GST_RTP_FEC_DEC_MEDIA_SIZE];
+  gboolean have_seqnum;
+  guint16 max_seqnum;
+  guint32 ssrc;
+
+  /* the FEC packets that can't recover anything yet */
+  GQueue fec_packets;
+  /* missing seqnum -> GList of the FEC packets protecting it */
+  GHashTable *fec_index;
+
+  /* statistics */
+  guint num_recovered;
+  guint num_unrecovered;
+};
+
+struct _GstRtpFecDecClass
+{
+  GstElementClass parent_class;
+};
+
+GType gst_rtp_fec_dec_get_type (void);
+
+G_END_DECLS
+
+#endif /* __GST_RTP_FEC_DEC_H__ */
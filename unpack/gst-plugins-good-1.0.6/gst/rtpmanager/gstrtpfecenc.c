@@ -0,0 +1,493 @@
+/* RTP FEC encoder element for GStreamer
+ *
+ * gstrtpfecenc.c:
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/**
+ * SECTION:element-rtpfecenc
+ * @see_also: rtpfecdec
+ *
+ * The rtpfecenc element adds XOR parity packets to an RTP stream so that
+ * the receiver can recover lost packets without retransmission.
+ *
+ * The media packets are arranged in a matrix of #GstRtpFecEnc:columns
+ * packets per row and #GstRtpFecEnc:rows rows. A row FEC packet protects
+ * the packets of one row and recovers a single lost packet in it. When
+ * there are at least 2 rows, a column FEC packet protects every column,
+ * which recovers burst losses of up to #GstRtpFecEnc:columns packets.
+ *
+ * The FEC packets are sent in the same stream as the media packets with
+ * payload type #GstRtpFecEnc:pt and their own sequence numbers, using
+ * either the RFC 5109 ULP FEC header or the SMPTE 2022-1 header. With
+ * RFC 5109 all packets protected by one FEC packet have to be within 48
+ * sequence numbers.
+ *
+ * The element is usually placed after the send_rtp_src pad of #GstRtpBin.
+ *
+ * <refsect2>
+ * <title>Example pipeline</title>
+ * |[
+ * gst-launch-1.0 videotestsrc ! x264enc ! mpegtsmux ! rtpmp2tpay ! \
+ *     rtpfecenc format=smpte-2022-1 columns=10 rows=5 pt=96 ! \
+ *     udpsink port=5000
+ * ]| Send an MPEG-TS stream with SMPTE 2022-1 row and column FEC.
+ * </refsect2>
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <gst/rtp/gstrtpbuffer.h>
+
+#include "gstrtpfecenc.h"
+
+GST_DEBUG_CATEGORY_STATIC (gst_rtp_fec_enc_debug);
+#define GST_CAT_DEFAULT gst_rtp_fec_enc_debug
+
+#define DEFAULT_FORMAT   RTP_FEC_FORMAT_ULPFEC
+#define DEFAULT_PT       127
+#define DEFAULT_COLUMNS  10
+#define DEFAULT_ROWS     0
+#define DEFAULT_ROW_FEC  TRUE
+
+enum
+{
+  PROP_0,
+  PROP_FORMAT,
+  PROP_PT,
+  PROP_COLUMNS,
+  PROP_ROWS,
+  PROP_ROW_FEC,
+  PROP_NUM_FEC_PACKETS,
+  PROP_LAST
+};
+
+static GstStaticPadTemplate src_factory = GST_STATIC_PAD_TEMPLATE ("src",
+    GST_PAD_SRC,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS ("application/x-rtp")
+    );
+
+static GstStaticPadTemplate sink_factory = GST_STATIC_PAD_TEMPLATE ("sink",
+    GST_PAD_SINK,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS ("application/x-rtp")
+    );
+
+static GstFlowReturn gst_rtp_fec_enc_chain (GstPad * pad, GstObject * parent,
+    GstBuffer * buffer);
+
+static GstStateChangeReturn gst_rtp_fec_enc_change_state (GstElement *
+    element, GstStateChange transition);
+
+static void gst_rtp_fec_enc_set_property (GObject * object, guint prop_id,
+    const GValue * value, GParamSpec * pspec);
+static void gst_rtp_fec_enc_get_property (GObject * object, guint prop_id,
+    GValue * value, GParamSpec * pspec);
+static void gst_rtp_fec_enc_finalize (GObject * object);
+
+G_DEFINE_TYPE (GstRtpFecEnc, gst_rtp_fec_enc, GST_TYPE_ELEMENT);
+
+static void
+gst_rtp_fec_enc_class_init (GstRtpFecEncClass * klass)
+{
+  GObjectClass *gobject_class;
+  GstElementClass *gstelement_class;
+
+  gobject_class = (GObjectClass *) klass;
+  gstelement_class = (GstElementClass *) klass;
+
+  gobject_class->get_property = gst_rtp_fec_enc_get_property;
+  gobject_class->set_property = gst_rtp_fec_enc_set_property;
+  gobject_class->finalize = gst_rtp_fec_enc_finalize;
+
+  g_object_class_install_property (gobject_class, PROP_FORMAT,
+      g_param_spec_enum ("format", "Format", "The FEC header format",
+          RTP_TYPE_FEC_FORMAT, DEFAULT_FORMAT,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS |
+          GST_PARAM_MUTABLE_READY));
+
+  g_object_class_install_property (gobject_class, PROP_PT,
+      g_param_spec_uint ("pt", "Payload Type",
+          "The payload type of the FEC packets", 0, 127, DEFAULT_PT,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS |
+          GST_PARAM_MUTABLE_READY));
+
+  g_object_class_install_property (gobject_class, PROP_COLUMNS,
+      g_param_spec_uint ("columns", "Columns",
+          "Number of packets in a row of the FEC matrix", 1, 255,
+          DEFAULT_COLUMNS,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS |
+          GST_PARAM_MUTABLE_READY));
+
+  g_object_class_install_property (gobject_class, PROP_ROWS,
+      g_param_spec_uint ("rows", "Rows",
+          "Number of rows of the FEC matrix, column FEC is generated with "
+          "at least 2 rows", 0, 255, DEFAULT_ROWS,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS |
+          GST_PARAM_MUTABLE_READY));
+
+  g_object_class_install_property (gobject_class, PROP_ROW_FEC,
+      g_param_spec_boolean ("row-fec", "Row FEC",
+          "Generate a FEC packet for every row", DEFAULT_ROW_FEC,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS |
+          GST_PARAM_MUTABLE_READY));
+
+  g_object_class_install_property (gobject_class, PROP_NUM_FEC_PACKETS,
+      g_param_spec_uint ("num-fec-packets", "Num FEC Packets",
+          "Number of FEC packets sent", 0, G_MAXUINT, 0,
+          G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+
+  gst_element_class_add_pad_template (gstelement_class,
+      gst_static_pad_template_get (&src_factory));
+  gst_element_class_add_pad_template (gstelement_class,
+      gst_static_pad_template_get (&sink_factory));
+
+  gst_element_class_set_static_metadata (gstelement_class,
+      "RTP FEC encoder", "Filter/Network/RTP",
+      "Add XOR forward error correction packets to an RTP stream",
+      "GStreamer maintainers <gstreamer-devel@lists.freedesktop.org>");
+
+  gstelement_class->change_state =
+      GST_DEBUG_FUNCPTR (gst_rtp_fec_enc_change_state);
+
+  GST_DEBUG_CATEGORY_INIT (gst_rtp_fec_enc_debug, "rtpfecenc", 0,
+      "RTP FEC encoder");
+}
+
+static void
+gst_rtp_fec_enc_clear_matrix (GstRtpFecEnc * fec)
+{
+  guint i;
+
+  rtp_fec_xor_clear (&fec->row_xor);
+  for (i = 0; i < fec->n_columns; i++)
+    rtp_fec_xor_clear (&fec->column_xor[i]);
+  fec->position = 0;
+}
+
+/* allocate the matrix for the configured size, call with OBJECT_LOCK */
+static void
+gst_rtp_fec_enc_setup (GstRtpFecEnc * fec)
+{
+  guint i;
+
+  gst_rtp_fec_enc_clear_matrix (fec);
+  g_free (fec->column_xor);
+  g_free (fec->column_base);
+  fec->column_xor = NULL;
+  fec->column_base = NULL;
+  fec->n_columns = 0;
+
+  if (fec->format == RTP_FEC_FORMAT_ULPFEC) {
+    /* the ULP FEC mask covers 48 seqnums */
+    if (fec->row_fec && fec->columns > RTP_FEC_ULPFEC_MAX_SPAN) {
+      GST_WARNING_OBJECT (fec, "rows of %u packets can't be protected with "
+          "ULP FEC, using %u", fec->columns, RTP_FEC_ULPFEC_MAX_SPAN);
+      fec->columns = RTP_FEC_ULPFEC_MAX_SPAN;
+    }
+    if (fec->rows >= 2 &&
+        (fec->rows - 1) * fec->columns >= RTP_FEC_ULPFEC_MAX_SPAN) {
+      GST_WARNING_OBJECT (fec, "columns of %u rows can't be protected with "
+          "ULP FEC, disabling column FEC", fec->rows);
+      fec->rows = 0;
+    }
+  }
+
+  if (fec->rows >= 2) {
+    fec->n_columns = fec->columns;
+    fec->column_xor = g_new0 (RTPFecXor, fec->n_columns);
+    fec->column_base = g_new0 (guint16, fec->n_columns);
+    for (i = 0; i < fec->n_columns; i++)
+      rtp_fec_xor_init (&fec->column_xor[i]);
+  }
+  fec->have_seqnum = FALSE;
+  fec->fec_seqnum = g_random_int_range (0, G_MAXUINT16);
+  fec->num_fec_packets = 0;
+}
+
+static void
+gst_rtp_fec_enc_finalize (GObject * object)
+{
+  GstRtpFecEnc *fec = GST_RTP_FEC_ENC (object);
+
+  gst_rtp_fec_enc_clear_matrix (fec);
+  g_free (fec->column_xor);
+  g_free (fec->column_base);
+
+  G_OBJECT_CLASS (gst_rtp_fec_enc_parent_class)->finalize (object);
+}
+
+static void
+gst_rtp_fec_enc_init (GstRtpFecEnc * fec)
+{
+  GstElementClass *klass = GST_ELEMENT_GET_CLASS (fec);
+
+  fec->srcpad =
+      gst_pad_new_from_template (gst_element_class_get_pad_template (klass,
+          "src"), "src");
+  GST_PAD_SET_PROXY_CAPS (fec->srcpad);
+  GST_PAD_SET_PROXY_ALLOCATION (fec->srcpad);
+  gst_element_add_pad (GST_ELEMENT (fec), fec->srcpad);
+
+  fec->sinkpad =
+      gst_pad_new_from_template (gst_element_class_get_pad_template (klass,
+          "sink"), "sink");
+  GST_PAD_SET_PROXY_CAPS (fec->sinkpad);
+  GST_PAD_SET_PROXY_ALLOCATION (fec->sinkpad);
+  gst_pad_set_chain_function (fec->sinkpad,
+      GST_DEBUG_FUNCPTR (gst_rtp_fec_enc_chain));
+  gst_element_add_pad (GST_ELEMENT (fec), fec->sinkpad);
+
+  fec->format = DEFAULT_FORMAT;
+  fec->pt = DEFAULT_PT;
+  fec->columns = DEFAULT_COLUMNS;
+  fec->rows = DEFAULT_ROWS;
+  fec->row_fec = DEFAULT_ROW_FEC;
+  rtp_fec_xor_init (&fec->row_xor);
+}
+
+/* make a FEC packet from @xor and reset @xor */
+static GstBuffer *
+gst_rtp_fec_enc_make_fec (GstRtpFecEnc * fec, RTPFecXor * xor,
+    guint16 sn_base, guint offset, guint na, gboolean row, GstBuffer * media,
+    guint32 timestamp, guint32 ssrc)
+{
+  RTPFecHeader header;
+  GstBuffer *buffer;
+
+  header.format = fec->format;
+  header.sn_base = sn_base;
+  header.offset = offset;
+  header.na = na;
+  header.row = row;
+
+  /* SMPTE 2022-1 FEC streams use SSRC 0 */
+  if (fec->format == RTP_FEC_FORMAT_SMPTE_2022_1)
+    ssrc = 0;
+
+  buffer = rtp_fec_xor_to_fec (xor, &header, fec->pt, fec->fec_seqnum++,
+      timestamp, ssrc);
+  gst_buffer_copy_into (buffer, media, GST_BUFFER_COPY_TIMESTAMPS, 0, -1);
+  rtp_fec_xor_clear (xor);
+  fec->num_fec_packets++;
+
+  GST_LOG_OBJECT (fec, "%s FEC for #%u, offset %u, %u packets",
+      row ? "row" : "column", sn_base, offset, na);
+
+  return buffer;
+}
+
+static GstFlowReturn
+gst_rtp_fec_enc_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
+{
+  GstRtpFecEnc *fec = GST_RTP_FEC_ENC (parent);
+  GstRTPBuffer rtp = GST_RTP_BUFFER_INIT;
+  GstBuffer *row_fec = NULL, *column_fec = NULL;
+  GstFlowReturn ret;
+  guint16 seqnum;
+  guint32 timestamp, ssrc;
+  guint col, row;
+
+  if (G_UNLIKELY (!gst_rtp_buffer_map (buffer, GST_MAP_READ, &rtp)))
+    goto invalid_buffer;
+
+  seqnum = gst_rtp_buffer_get_seq (&rtp);
+  timestamp = gst_rtp_buffer_get_timestamp (&rtp);
+  ssrc = gst_rtp_buffer_get_ssrc (&rtp);
+  gst_rtp_buffer_unmap (&rtp);
+
+  GST_OBJECT_LOCK (fec);
+  /* the matrix is made of consecutive packets, start a new one when packets
+   * are missing */
+  if (fec->have_seqnum && seqnum != fec->next_seqnum) {
+    GST_DEBUG_OBJECT (fec, "expected #%u, got #%u, restart matrix",
+        fec->next_seqnum, seqnum);
+    gst_rtp_fec_enc_clear_matrix (fec);
+  }
+  fec->have_seqnum = TRUE;
+  fec->next_seqnum = seqnum + 1;
+
+  col = fec->position % fec->columns;
+  row = fec->position / fec->columns;
+
+  if (fec->row_fec) {
+    if (col == 0)
+      fec->row_base = seqnum;
+    rtp_fec_xor_add_packet (&fec->row_xor, buffer);
+    if (col == fec->columns - 1)
+      row_fec = gst_rtp_fec_enc_make_fec (fec, &fec->row_xor, fec->row_base,
+          1, fec->columns, TRUE, buffer, timestamp, ssrc);
+  }
+
+  if (fec->n_columns) {
+    if (row == 0)
+      fec->column_base[col] = seqnum;
+    rtp_fec_xor_add_packet (&fec->column_xor[col], buffer);
+    if (row == fec->rows - 1)
+      column_fec = gst_rtp_fec_enc_make_fec (fec, &fec->column_xor[col],
+          fec->column_base[col], fec->columns, fec->rows, FALSE, buffer,
+          timestamp, ssrc);
+  }
+
+  fec->position++;
+  if (fec->position == fec->columns * (fec->n_columns ? fec->rows : 1))
+    fec->position = 0;
+  GST_OBJECT_UNLOCK (fec);
+
+  /* the media packet first, the FEC packets protect it */
+  ret = gst_pad_push (fec->srcpad, buffer);
+  if (column_fec) {
+    if (ret == GST_FLOW_OK)
+      ret = gst_pad_push (fec->srcpad, column_fec);
+    else
+      gst_buffer_unref (column_fec);
+  }
+  if (row_fec) {
+    if (ret == GST_FLOW_OK)
+      ret = gst_pad_push (fec->srcpad, row_fec);
+    else
+      gst_buffer_unref (row_fec);
+  }
+
+  return ret;
+
+  /* ERRORS */
+invalid_buffer:
+  {
+    GST_ELEMENT_WARNING (fec, STREAM, DECODE, (NULL),
+        ("Received invalid RTP payload, dropping"));
+    gst_buffer_unref (buffer);
+    return GST_FLOW_OK;
+  }
+}
+
+static void
+gst_rtp_fec_enc_set_property (GObject * object,
+    guint prop_id, const GValue * value, GParamSpec * pspec)
+{
+  GstRtpFecEnc *fec = GST_RTP_FEC_ENC (object);
+
+  switch (prop_id) {
+    case PROP_FORMAT:
+      GST_OBJECT_LOCK (fec);
+      fec->format = g_value_get_enum (value);
+      GST_OBJECT_UNLOCK (fec);
+      break;
+    case PROP_PT:
+      GST_OBJECT_LOCK (fec);
+      fec->pt = g_value_get_uint (value);
+      GST_OBJECT_UNLOCK (fec);
+      break;
+    case PROP_COLUMNS:
+      GST_OBJECT_LOCK (fec);
+      fec->columns = g_value_get_uint (value);
+      GST_OBJECT_UNLOCK (fec);
+      break;
+    case PROP_ROWS:
+      GST_OBJECT_LOCK (fec);
+      fec->rows = g_value_get_uint (value);
+      GST_OBJECT_UNLOCK (fec);
+      break;
+    case PROP_ROW_FEC:
+      GST_OBJECT_LOCK (fec);
+      fec->row_fec = g_value_get_boolean (value);
+      GST_OBJECT_UNLOCK (fec);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
+static void
+gst_rtp_fec_enc_get_property (GObject * object,
+    guint prop_id, GValue * value, GParamSpec * pspec)
+{
+  GstRtpFecEnc *fec = GST_RTP_FEC_ENC (object);
+
+  switch (prop_id) {
+    case PROP_FORMAT:
+      GST_OBJECT_LOCK (fec);
+      g_value_set_enum (value, fec->format);
+      GST_OBJECT_UNLOCK (fec);
+      break;
+    case PROP_PT:
+      GST_OBJECT_LOCK (fec);
+      g_value_set_uint (value, fec->pt);
+      GST_OBJECT_UNLOCK (fec);
+      break;
+    case PROP_COLUMNS:
+      GST_OBJECT_LOCK (fec);
+      g_value_set_uint (value, fec->columns);
+      GST_OBJECT_UNLOCK (fec);
+      break;
+    case PROP_ROWS:
+      GST_OBJECT_LOCK (fec);
+      g_value_set_uint (value, fec->rows);
+      GST_OBJECT_UNLOCK (fec);
+      break;
+    case PROP_ROW_FEC:
+      GST_OBJECT_LOCK (fec);
+      g_value_set_boolean (value, fec->row_fec);
+      GST_OBJECT_UNLOCK (fec);
+      break;
+    case PROP_NUM_FEC_PACKETS:
+      GST_OBJECT_LOCK (fec);
+      g_value_set_uint (value, fec->num_fec_packets);
+      GST_OBJECT_UNLOCK (fec);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
+static GstStateChangeReturn
+gst_rtp_fec_enc_change_state (GstElement * element, GstStateChange transition)
+{
+  GstRtpFecEnc *fec = GST_RTP_FEC_ENC (element);
+  GstStateChangeReturn ret;
+
+  switch (transition) {
+    case GST_STATE_CHANGE_READY_TO_PAUSED:
+      GST_OBJECT_LOCK (fec);
+      gst_rtp_fec_enc_setup (fec);
+      GST_OBJECT_UNLOCK (fec);
+      break;
+    default:
+      break;
+  }
+
+  ret =
+      GST_ELEMENT_CLASS (gst_rtp_fec_enc_parent_class)->change_state (element,
+      transition);
+
+  switch (transition) {
+    case GST_STATE_CHANGE_PAUSED_TO_READY:
+      GST_OBJECT_LOCK (fec);
+      gst_rtp_fec_enc_clear_matrix (fec);
+      GST_OBJECT_UNLOCK (fec);
+      break;
+    default:
+      break;
+  }
+
+  return ret;
+}
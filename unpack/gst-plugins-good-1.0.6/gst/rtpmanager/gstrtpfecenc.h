@@ -0,0 +1,79 @@
+/* RTP FEC encoder element for GStreamer
+ *
+ * gstrtpfecenc.h:
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#ifndef __GST_RTP_FEC_ENC_H__
+#define __GST_RTP_FEC_ENC_H__
+
+#include <gst/gst.h>
+
+#include "rtpfec.h"
+
+G_BEGIN_DECLS
+
+#define GST_TYPE_RTP_FEC_ENC (gst_rtp_fec_enc_get_type())
+#define GST_RTP_FEC_ENC(obj) (G_TYPE_CHECK_INSTANCE_CAST((obj),GST_TYPE_RTP_FEC_ENC,GstRtpFecEnc))
+#define GST_RTP_FEC_ENC_CLASS(klass) (G_TYPE_CHECK_CLASS_CAST((klass),GST_TYPE_RTP_FEC_ENC,GstRtpFecEncClass))
+#define GST_IS_RTP_FEC_ENC(obj) (G_TYPE_CHECK_INSTANCE_TYPE((obj),GST_TYPE_RTP_FEC_ENC))
+#define GST_IS_RTP_FEC_ENC_CLASS(klass) (G_TYPE_CHECK_CLASS_TYPE((klass),GST_TYPE_RTP_FEC_ENC))
+
+typedef struct _GstRtpFecEnc GstRtpFecEnc;
+typedef struct _GstRtpFecEncClass GstRtpFecEncClass;
+
+struct _GstRtpFecEnc
+{
+  GstElement element;
+
+  /* pad */
+  GstPad *sinkpad;
+  GstPad *srcpad;
+
+  RTPFecFormat format;
+  guint8 pt;
+  guint columns;
+  guint rows;
+  gboolean row_fec;
+
+  /* the matrix of the current packets */
+  gboolean have_seqnum;
+  guint16 next_seqnum;
+  guint position;
+  RTPFecXor row_xor;
+  guint16 row_base;
+  RTPFecXor *column_xor;
+  guint16 *column_base;
+  guint n_columns;
+
+  /* FEC stream */
+  guint16 fec_seqnum;
+
+  /* statistics */
+  guint num_fec_packets;
+};
+
+struct _GstRtpFecEncClass
+{
+  GstElementClass parent_class;
+};
+
+GType gst_rtp_fec_enc_get_type (void);
+
+G_END_DECLS
+
+#endif /* __GST_RTP_FEC_ENC_H__ */
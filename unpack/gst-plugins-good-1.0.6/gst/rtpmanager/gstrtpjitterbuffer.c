@@ -41,6 +41,16 @@
  *
  * This element will automatically be used inside gstrtpbin.
  *
+ * When #GstRtpJitterBuffer:do-retransmission is enabled, the jitterbuffer
+ * estimates the expected arrival time of every missing packet from the
+ * spacing of the packets around the gap. When a packet did not arrive
+ * #GstRtpJitterBuffer:rtx-delay after its expected arrival time, a
+ * GstRTPRetransmissionRequest event is sent upstream. The request is repeated
+ * every #GstRtpJitterBuffer:rtx-retry-timeout until the packet arrives or
+ * #GstRtpJitterBuffer:rtx-retry-period expired. The event is handled by
+ * gstrtpsession, which turns it into a Generic NACK RTCP feedback message
+ * (RFC 4585).
+ *
  * <refsect2>
  * <title>Example pipelines</title>
  * |[
@@ -89,6 +99,13 @@ enum
 #define DEFAULT_DO_LOST         FALSE
 #define DEFAULT_MODE            RTP_JITTER_BUFFER_MODE_SLAVE
 #define DEFAULT_PERCENT         0
+#define DEFAULT_DO_RETRANSMISSION FALSE
+#define DEFAULT_RTX_DELAY       -1
+#define DEFAULT_RTX_RETRY_TIMEOUT -1
+#define DEFAULT_RTX_RETRY_PERIOD -1
+
+#define DEFAULT_AUTO_RTX_DELAY   (20 * GST_MSECOND)
+#define DEFAULT_AUTO_RTX_TIMEOUT (40 * GST_MSECOND)
 
 enum
 {
@@ -99,6 +116,11 @@ enum
   PROP_DO_LOST,
   PROP_MODE,
   PROP_PERCENT,
+  PROP_DO_RETRANSMISSION,
+  PROP_RTX_DELAY,
+  PROP_RTX_RETRY_TIMEOUT,
+  PROP_RTX_RETRY_PERIOD,
+  PROP_STATS,
   PROP_LAST
 };
 
@@ -121,6 +143,28 @@ enum
 
 #define JBUF_SIGNAL(priv) (g_cond_signal (&(priv)->jbuf_cond))
 
+#define JBUF_WAIT_RTX(priv)   (g_cond_wait (&(priv)->rtx_cond, &(priv)->jbuf_lock))
+#define JBUF_SIGNAL_RTX(priv) (g_cond_signal (&(priv)->rtx_cond))
+
+/* a pending retransmission request for a missing packet */
+typedef struct
+{
+  guint16 seqnum;
+  /* the estimated arrival time of the packet */
+  GstClockTime expected;
+  /* when to send the next request */
+  GstClockTime timeout;
+  guint num_rtx_retry;
+  /* position in the timeout-sorted queue */
+  GSequenceIter *iter;
+} RtxTimer;
+
+static void
+rtx_timer_free (RtxTimer * timer)
+{
+  g_slice_free (RtxTimer, timer);
+}
+
 struct _GstRtpJitterBufferPrivate
 {
   GstPad *sinkpad, *srcpad;
@@ -140,6 +184,10 @@ struct _GstRtpJitterBufferPrivate
   gboolean drop_on_latency;
   gint64 ts_offset;
   gboolean do_lost;
+  gboolean do_retransmission;
+  gint rtx_delay;
+  gint rtx_retry_timeout;
+  gint rtx_retry_period;
 
   /* the last seqnum we pushed out */
   guint32 last_popped_seqnum;
@@ -149,6 +197,23 @@ struct _GstRtpJitterBufferPrivate
   GstClockTime last_out_time;
   /* the next expected seqnum we receive */
   guint32 next_in_seqnum;
+  /* arrival time and SSRC of the last in-order packet and the estimated
+   * spacing between packets */
+  GstClockTime last_in_dts;
+  guint32 last_in_ssrc;
+  GstClockTime packet_spacing;
+
+  /* seqnum -> RtxTimer, handled by the rtx thread */
+  GHashTable *rtx_timers;
+  /* the same RtxTimers sorted by timeout, owns the timers */
+  GSequence *rtx_queue;
+  GThread *rtx_thread;
+  GCond rtx_cond;
+  gboolean rtx_running;
+  /* TRUE between READY_TO_PAUSED and PAUSED_TO_READY, the rtx thread only
+   * runs in that time and when do-retransmission is enabled */
+  gboolean rtx_allowed;
+  GstClockID rtx_clock_id;
 
   /* start and stop ranges */
   GstClockTime npt_start;
@@ -182,7 +247,10 @@ struct _GstRtpJitterBufferPrivate
 
   /* some accounting */
   guint64 num_late;
+  guint64 num_lost;
   guint64 num_duplicates;
+  guint64 num_rtx_requests;
+  guint64 num_rtx_success;
 };
 
 #define GST_RTP_JITTER_BUFFER_GET_PRIVATE(o) \
@@ -273,6 +341,11 @@ static GstClockTime
 gst_rtp_jitter_buffer_set_active (GstRtpJitterBuffer * jitterbuffer,
     gboolean active, guint64 base_time);
 
+static GstStructure *gst_rtp_jitter_buffer_create_stats (GstRtpJitterBuffer *
+    jitterbuffer);
+
+static void clear_rtx_timers (GstRtpJitterBufferPrivate * priv);
+
 static void
 gst_rtp_jitter_buffer_class_init (GstRtpJitterBufferClass * klass)
 {
@@ -352,6 +425,104 @@ gst_rtp_jitter_buffer_class_init (GstRtpJitterBufferClass * klass)
       g_param_spec_int ("percent", "percent",
           "The buffer filled percent", 0, 100,
           0, G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+  /**
+   * GstRtpJitterBuffer::do-retransmission:
+   *
+   * Send out a GstRTPRetransmission event upstream when a packet is considered
+   * late and should be retransmitted.
+   */
+  g_object_class_install_property (gobject_class, PROP_DO_RETRANSMISSION,
+      g_param_spec_boolean ("do-retransmission", "Do Retransmission",
+          "Send retransmission events upstream when a packet is late",
+          DEFAULT_DO_RETRANSMISSION,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  /**
+   * GstRtpJitterBuffer::rtx-delay:
+   *
+   * When a packet did not arrive at the expected time, wait this extra amount
+   * of time before sending a retransmission event.
+   *
+   * When -1 is used, the delay is derived from the observed packet spacing.
+   */
+  g_object_class_install_property (gobject_class, PROP_RTX_DELAY,
+      g_param_spec_int ("rtx-delay", "RTX Delay",
+          "Extra time in ms to wait before sending retransmission "
+          "event (-1 automatic)", -1, G_MAXINT, DEFAULT_RTX_DELAY,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  /**
+   * GstRtpJitterBuffer::rtx-retry-timeout:
+   *
+   * When no packet has been received after sending a retransmission event
+   * for this time, retry sending a retransmission event.
+   *
+   * When -1 is used, a default timeout of 40 milliseconds is used.
+   */
+  g_object_class_install_property (gobject_class, PROP_RTX_RETRY_TIMEOUT,
+      g_param_spec_int ("rtx-retry-timeout", "RTX Retry Timeout",
+          "Retry sending a transmission event after this timeout in "
+          "ms (-1 automatic)", -1, G_MAXINT, DEFAULT_RTX_RETRY_TIMEOUT,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  /**
+   * GstRtpJitterBuffer::rtx-retry-period:
+   *
+   * The amount of time to try to get a retransmission.
+   *
+   * When -1 is used, the value will be estimated based on the jitterbuffer
+   * latency.
+   */
+  g_object_class_install_property (gobject_class, PROP_RTX_RETRY_PERIOD,
+      g_param_spec_int ("rtx-retry-period", "RTX Retry Period",
+          "Try to get a retransmission for this many ms "
+          "(-1 automatic)", -1, G_MAXINT, DEFAULT_RTX_RETRY_PERIOD,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  /**
+   * GstRtpJitterBuffer::stats:
+   *
+   * Various jitterbuffer statistics. This property returns a GstStructure
+   * with name application/x-rtp-jitterbuffer-stats with the following fields:
+   *
+   * <itemizedlist>
+   * <listitem>
+   *   <para>
+   *   #guint64
+   *   <classname>&quot;num-lost&quot;</classname>:
+   *   the number of packets considered lost.
+   *   </para>
+   * </listitem>
+   * <listitem>
+   *   <para>
+   *   #guint64
+   *   <classname>&quot;num-late&quot;</classname>:
+   *   the number of packets arriving too late.
+   *   </para>
+   * </listitem>
+   * <listitem>
+   *   <para>
+   *   #guint64
+   *   <classname>&quot;num-duplicates&quot;</classname>:
+   *   the number of duplicate packets.
+   *   </para>
+   * </listitem>
+   * <listitem>
+   *   <para>
+   *   #guint64
+   *   <classname>&quot;rtx-count&quot;</classname>:
+   *   the number of retransmission events sent.
+   *   </para>
+   * </listitem>
+   * <listitem>
+   *   <para>
+   *   #guint64
+   *   <classname>&quot;rtx-success-count&quot;</classname>:
+   *   the number of requested packets that arrived.
+   *   </para>
+   * </listitem>
+   * </itemizedlist>
+   */
+  g_object_class_install_property (gobject_class, PROP_STATS,
+      g_param_spec_boxed ("stats", "Statistics",
+          "Various statistics", GST_TYPE_STRUCTURE,
+          G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
   /**
    * GstRtpJitterBuffer::request-pt-map:
    * @buffer: the object which received the signal
@@ -462,10 +633,18 @@ gst_rtp_jitter_buffer_init (GstRtpJitterBuffer * jitterbuffer)
   priv->latency_ns = priv->latency_ms * GST_MSECOND;
   priv->drop_on_latency = DEFAULT_DROP_ON_LATENCY;
   priv->do_lost = DEFAULT_DO_LOST;
+  priv->do_retransmission = DEFAULT_DO_RETRANSMISSION;
+  priv->rtx_delay = DEFAULT_RTX_DELAY;
+  priv->rtx_retry_timeout = DEFAULT_RTX_RETRY_TIMEOUT;
+  priv->rtx_retry_period = DEFAULT_RTX_RETRY_PERIOD;
 
   priv->jbuf = rtp_jitter_buffer_new ();
   g_mutex_init (&priv->jbuf_lock);
   g_cond_init (&priv->jbuf_cond);
+  g_cond_init (&priv->rtx_cond);
+  priv->rtx_timers = g_hash_table_new (g_direct_hash, g_direct_equal);
+  priv->rtx_queue = g_sequence_new ((GDestroyNotify) rtx_timer_free);
+  priv->last_in_dts = -1;
 
   /* reset skew detection initialy */
   rtp_jitter_buffer_reset_skew (priv->jbuf);
@@ -510,6 +689,9 @@ gst_rtp_jitter_buffer_finalize (GObject * object)
 
   g_mutex_clear (&jitterbuffer->priv->jbuf_lock);
   g_cond_clear (&jitterbuffer->priv->jbuf_cond);
+  g_cond_clear (&jitterbuffer->priv->rtx_cond);
+  g_hash_table_unref (jitterbuffer->priv->rtx_timers);
+  g_sequence_free (jitterbuffer->priv->rtx_queue);
 
   g_object_unref (jitterbuffer->priv->jbuf);
 
@@ -855,6 +1037,8 @@ gst_rtp_jitter_buffer_flush_start (GstRtpJitterBuffer * jitterbuffer)
     gst_clock_id_unschedule (priv->clock_id);
     priv->unscheduled = TRUE;
   }
+  if (priv->rtx_clock_id)
+    gst_clock_id_unschedule (priv->rtx_clock_id);
   JBUF_UNLOCK (priv);
 }
 
@@ -880,6 +1064,9 @@ gst_rtp_jitter_buffer_flush_stop (GstRtpJitterBuffer * jitterbuffer)
   priv->last_elapsed = 0;
   priv->reached_npt_stop = FALSE;
   priv->ext_timestamp = -1;
+  priv->last_in_dts = -1;
+  priv->packet_spacing = 0;
+  clear_rtx_timers (priv);
   GST_DEBUG_OBJECT (jitterbuffer, "flush and reset jitterbuffer");
   rtp_jitter_buffer_flush (priv->jbuf);
   rtp_jitter_buffer_reset_skew (priv->jbuf);
@@ -922,6 +1109,294 @@ gst_rtp_jitter_buffer_src_activate_mode (GstPad * pad, GstObject * parent,
   return result;
 }
 
+/* call with JBUF_LOCK */
+static GstClockTime
+get_rtx_delay (GstRtpJitterBufferPrivate * priv)
+{
+  if (priv->rtx_delay == -1)
+    return MAX (DEFAULT_AUTO_RTX_DELAY, 2 * priv->packet_spacing);
+
+  return priv->rtx_delay * GST_MSECOND;
+}
+
+static GstClockTime
+get_rtx_retry_timeout (GstRtpJitterBufferPrivate * priv)
+{
+  if (priv->rtx_retry_timeout == -1)
+    return DEFAULT_AUTO_RTX_TIMEOUT;
+
+  return priv->rtx_retry_timeout * GST_MSECOND;
+}
+
+static GstClockTime
+get_rtx_retry_period (GstRtpJitterBufferPrivate * priv)
+{
+  if (priv->rtx_retry_period == -1)
+    return priv->latency_ns;
+
+  return priv->rtx_retry_period * GST_MSECOND;
+}
+
+/* wake up the rtx thread so that it picks up changed timers, call with
+ * JBUF_LOCK */
+static void
+rtx_timers_changed (GstRtpJitterBufferPrivate * priv)
+{
+  if (priv->rtx_clock_id)
+    gst_clock_id_unschedule (priv->rtx_clock_id);
+  JBUF_SIGNAL_RTX (priv);
+}
+
+/* call with JBUF_LOCK */
+static void
+clear_rtx_timers (GstRtpJitterBufferPrivate * priv)
+{
+  g_hash_table_remove_all (priv->rtx_timers);
+  g_sequence_remove_range (g_sequence_get_begin_iter (priv->rtx_queue),
+      g_sequence_get_end_iter (priv->rtx_queue));
+}
+
+static RtxTimer *
+find_rtx_timer (GstRtpJitterBufferPrivate * priv, guint16 seqnum)
+{
+  return g_hash_table_lookup (priv->rtx_timers, GUINT_TO_POINTER (seqnum));
+}
+
+static gint
+compare_rtx_timeout (const RtxTimer * a, const RtxTimer * b,
+    gpointer user_data)
+{
+  if (a->timeout < b->timeout)
+    return -1;
+  if (a->timeout > b->timeout)
+    return 1;
+  return 0;
+}
+
+/* frees @timer */
+static void
+remove_rtx_timer (GstRtpJitterBufferPrivate * priv, RtxTimer * timer)
+{
+  g_hash_table_remove (priv->rtx_timers, GUINT_TO_POINTER (timer->seqnum));
+  g_sequence_remove (timer->iter);
+}
+
+static void
+add_rtx_timer (GstRtpJitterBuffer * jitterbuffer, guint16 seqnum,
+    GstClockTime expected)
+{
+  GstRtpJitterBufferPrivate *priv = jitterbuffer->priv;
+  RtxTimer *timer;
+
+  if (find_rtx_timer (priv, seqnum) != NULL)
+    return;
+
+  timer = g_slice_new (RtxTimer);
+  timer->seqnum = seqnum;
+  timer->expected = expected;
+  timer->timeout = expected + get_rtx_delay (priv);
+  timer->num_rtx_retry = 0;
+
+  GST_DEBUG_OBJECT (jitterbuffer, "add rtx timer #%d, expected %"
+      GST_TIME_FORMAT ", timeout %" GST_TIME_FORMAT, seqnum,
+      GST_TIME_ARGS (expected), GST_TIME_ARGS (timer->timeout));
+
+  g_hash_table_insert (priv->rtx_timers, GUINT_TO_POINTER (seqnum), timer);
+  timer->iter = g_sequence_insert_sorted (priv->rtx_queue, timer,
+      (GCompareDataFunc) compare_rtx_timeout, NULL);
+}
+
+/* a packet arrived at @dts after a gap of @gap packets. Schedule a timer for
+ * each of the missing packets at the time they should have arrived, assuming
+ * equidistant packet spacing. */
+static void
+schedule_rtx_timers (GstRtpJitterBuffer * jitterbuffer, guint16 seqnum,
+    gint gap, GstClockTime dts)
+{
+  GstRtpJitterBufferPrivate *priv = jitterbuffer->priv;
+  GstClockTime spacing, expected;
+  guint16 missing;
+  gint i;
+
+  if (priv->last_in_dts != -1 && dts != -1 && dts >= priv->last_in_dts)
+    spacing = (dts - priv->last_in_dts) / (gap + 1);
+  else
+    spacing = priv->packet_spacing;
+
+  missing = (seqnum - gap) & 0xffff;
+  for (i = 0; i < gap; i++) {
+    if (priv->last_in_dts != -1)
+      expected = priv->last_in_dts + (i + 1) * spacing;
+    else
+      expected = dts;
+
+    if (expected != -1)
+      add_rtx_timer (jitterbuffer, (missing + i) & 0xffff, expected);
+  }
+  rtx_timers_changed (priv);
+}
+
+/* send a retransmission request for @timer and reschedule or remove it.
+ * Call with JBUF_LOCK, the lock is released while pushing the event. */
+static void
+do_rtx_timeout (GstRtpJitterBuffer * jitterbuffer, RtxTimer * timer,
+    GstClockTime now)
+{
+  GstRtpJitterBufferPrivate *priv = jitterbuffer->priv;
+  GstClockTime retry_timeout, retry_period, delay;
+  GstEvent *event;
+  guint16 seqnum;
+
+  seqnum = timer->seqnum;
+
+  /* the packet was already pushed or considered lost, nothing to request */
+  if (priv->last_popped_seqnum != -1 &&
+      gst_rtp_buffer_compare_seqnum (priv->last_popped_seqnum, seqnum) <= 0) {
+    GST_DEBUG_OBJECT (jitterbuffer, "#%d already popped, remove timer",
+        seqnum);
+    remove_rtx_timer (priv, timer);
+    return;
+  }
+
+  retry_timeout = get_rtx_retry_timeout (priv);
+  retry_period = get_rtx_retry_period (priv);
+  delay = now > timer->expected ? now - timer->expected : 0;
+
+  GST_DEBUG_OBJECT (jitterbuffer, "request retransmission of #%d, retry %u, "
+      "delay %" GST_TIME_FORMAT, seqnum, timer->num_rtx_retry,
+      GST_TIME_ARGS (delay));
+
+  event = gst_event_new_custom (GST_EVENT_CUSTOM_UPSTREAM,
+      gst_structure_new ("GstRTPRetransmissionRequest",
+          "seqnum", G_TYPE_UINT, (guint) seqnum,
+          "ssrc", G_TYPE_UINT, (guint) priv->last_in_ssrc,
+          "running-time", G_TYPE_UINT64, timer->expected,
+          "delay", G_TYPE_UINT, (guint) GST_TIME_AS_MSECONDS (delay),
+          "retry", G_TYPE_UINT, timer->num_rtx_retry,
+          "frequency", G_TYPE_UINT,
+          (guint) GST_TIME_AS_MSECONDS (retry_timeout), "period", G_TYPE_UINT,
+          (guint) GST_TIME_AS_MSECONDS (retry_period), "deadline",
+          G_TYPE_UINT, (guint) GST_TIME_AS_MSECONDS (priv->latency_ns), NULL));
+
+  priv->num_rtx_requests++;
+  timer->num_rtx_retry++;
+  timer->timeout = now + retry_timeout;
+
+  /* give up when the next request would be past the retry period */
+  if (timer->timeout > timer->expected + retry_period) {
+    GST_DEBUG_OBJECT (jitterbuffer, "retry period for #%d expired", seqnum);
+    remove_rtx_timer (priv, timer);
+  } else {
+    g_sequence_sort_changed (timer->iter,
+        (GCompareDataFunc) compare_rtx_timeout, NULL);
+  }
+
+  JBUF_UNLOCK (priv);
+  gst_pad_push_event (priv->sinkpad, event);
+  JBUF_LOCK (priv);
+}
+
+/* The rtx thread waits on the clock for the earliest retransmission timer
+ * and sends out the retransmission requests. */
+static gpointer
+rtx_timer_thread (GstRtpJitterBuffer * jitterbuffer)
+{
+  GstRtpJitterBufferPrivate *priv = jitterbuffer->priv;
+
+  GST_DEBUG_OBJECT (jitterbuffer, "rtx thread started");
+
+  JBUF_LOCK (priv);
+  while (priv->rtx_running) {
+    GstClock *clock;
+    GstClockTime base_time, now, timeout;
+    GstClockID id;
+    GSequenceIter *iter;
+    RtxTimer *earliest;
+
+    /* the queue is sorted, the earliest timer is the first one */
+    earliest = NULL;
+    timeout = -1;
+    iter = g_sequence_get_begin_iter (priv->rtx_queue);
+    if (!g_sequence_iter_is_end (iter)) {
+      earliest = g_sequence_get (iter);
+      timeout = earliest->timeout;
+    }
+
+    GST_OBJECT_LOCK (jitterbuffer);
+    clock = GST_ELEMENT_CLOCK (jitterbuffer);
+    if (earliest == NULL || clock == NULL) {
+      GST_OBJECT_UNLOCK (jitterbuffer);
+      /* nothing to do, wait for new timers */
+      JBUF_WAIT_RTX (priv);
+      continue;
+    }
+    base_time = GST_ELEMENT_CAST (jitterbuffer)->base_time;
+    gst_object_ref (clock);
+    GST_OBJECT_UNLOCK (jitterbuffer);
+
+    now = gst_clock_get_time (clock);
+    now = now > base_time ? now - base_time : 0;
+
+    if (timeout <= now) {
+      gst_object_unref (clock);
+      do_rtx_timeout (jitterbuffer, earliest, now);
+      continue;
+    }
+
+    /* wait for the timeout, we get unscheduled when the timers change */
+    id = priv->rtx_clock_id =
+        gst_clock_new_single_shot_id (clock, timeout + base_time);
+    JBUF_UNLOCK (priv);
+
+    gst_clock_id_wait (id, NULL);
+
+    JBUF_LOCK (priv);
+    priv->rtx_clock_id = NULL;
+    gst_clock_id_unref (id);
+    gst_object_unref (clock);
+  }
+  JBUF_UNLOCK (priv);
+
+  GST_DEBUG_OBJECT (jitterbuffer, "rtx thread stopped");
+
+  return NULL;
+}
+
+/* start the thread that sends out the retransmission requests if it is not
+ * running yet, call with JBUF_LOCK */
+static void
+start_rtx_thread (GstRtpJitterBuffer * jitterbuffer)
+{
+  GstRtpJitterBufferPrivate *priv = jitterbuffer->priv;
+
+  if (priv->rtx_thread)
+    return;
+
+  priv->rtx_running = TRUE;
+  priv->rtx_thread = g_thread_new ("rtpjitterbuffer-rtx",
+      (GThreadFunc) rtx_timer_thread, jitterbuffer);
+}
+
+/* call with JBUF_LOCK, the lock is released while joining the thread */
+static void
+stop_rtx_thread (GstRtpJitterBuffer * jitterbuffer)
+{
+  GstRtpJitterBufferPrivate *priv = jitterbuffer->priv;
+  GThread *thread;
+
+  if ((thread = priv->rtx_thread) == NULL)
+    return;
+
+  priv->rtx_running = FALSE;
+  priv->rtx_thread = NULL;
+  if (priv->rtx_clock_id)
+    gst_clock_id_unschedule (priv->rtx_clock_id);
+  JBUF_SIGNAL_RTX (priv);
+  JBUF_UNLOCK (priv);
+  g_thread_join (thread);
+  JBUF_LOCK (priv);
+}
+
 static GstStateChangeReturn
 gst_rtp_jitter_buffer_change_state (GstElement * element,
     GstStateChange transition)
@@ -945,6 +1420,9 @@ gst_rtp_jitter_buffer_change_state (GstElement * element,
       priv->last_pt = -1;
       /* block until we go to PLAYING */
       priv->blocked = TRUE;
+      priv->rtx_allowed = TRUE;
+      if (priv->do_retransmission)
+        start_rtx_thread (jitterbuffer);
       JBUF_UNLOCK (priv);
       break;
     case GST_STATE_CHANGE_PAUSED_TO_PLAYING:
@@ -952,6 +1430,8 @@ gst_rtp_jitter_buffer_change_state (GstElement * element,
       /* unblock to allow streaming in PLAYING */
       priv->blocked = FALSE;
       JBUF_SIGNAL (priv);
+      /* the rtx thread can now wait on the clock */
+      JBUF_SIGNAL_RTX (priv);
       JBUF_UNLOCK (priv);
       break;
     default:
@@ -976,6 +1456,11 @@ gst_rtp_jitter_buffer_change_state (GstElement * element,
         ret = GST_STATE_CHANGE_NO_PREROLL;
       break;
     case GST_STATE_CHANGE_PAUSED_TO_READY:
+      JBUF_LOCK (priv);
+      priv->rtx_allowed = FALSE;
+      stop_rtx_thread (jitterbuffer);
+      clear_rtx_timers (priv);
+      JBUF_UNLOCK (priv);
       break;
     case GST_STATE_CHANGE_READY_TO_NULL:
       break;
@@ -1245,12 +1730,15 @@ gst_rtp_jitter_buffer_chain (GstPad * pad, GstObject * parent,
   GstRtpJitterBuffer *jitterbuffer;
   GstRtpJitterBufferPrivate *priv;
   guint16 seqnum;
+  guint32 ssrc;
   GstFlowReturn ret = GST_FLOW_OK;
   GstClockTime timestamp;
   guint64 latency_ts;
   gboolean tail;
   gint percent = -1;
   guint8 pt;
+  gint gap = 0;
+  gboolean reset = FALSE;
   GstRTPBuffer rtp = GST_RTP_BUFFER_INIT;
 
   jitterbuffer = GST_RTP_JITTER_BUFFER (parent);
@@ -1262,6 +1750,7 @@ gst_rtp_jitter_buffer_chain (GstPad * pad, GstObject * parent,
 
   pt = gst_rtp_buffer_get_payload_type (&rtp);
   seqnum = gst_rtp_buffer_get_seq (&rtp);
+  ssrc = gst_rtp_buffer_get_ssrc (&rtp);
   gst_rtp_buffer_unmap (&rtp);
 
   /* take the timestamp of the buffer. This is the time when the packet was
@@ -1311,11 +1800,23 @@ gst_rtp_jitter_buffer_chain (GstPad * pad, GstObject * parent,
   if (G_UNLIKELY (priv->eos))
     goto have_eos;
 
+  if (priv->do_retransmission) {
+    RtxTimer *timer;
+
+    /* the packet arrived, we don't need to request it anymore */
+    if ((timer = find_rtx_timer (priv, seqnum)) != NULL) {
+      if (timer->num_rtx_retry > 0) {
+        GST_DEBUG_OBJECT (jitterbuffer, "retransmitted packet #%d arrived",
+            seqnum);
+        priv->num_rtx_success++;
+      }
+      remove_rtx_timer (priv, timer);
+      rtx_timers_changed (priv);
+    }
+  }
+
   /* now check against our expected seqnum */
   if (G_LIKELY (priv->next_in_seqnum != -1)) {
-    gint gap;
-    gboolean reset = FALSE;
-
     gap = gst_rtp_buffer_compare_seqnum (priv->next_in_seqnum, seqnum);
     if (G_UNLIKELY (gap != 0)) {
       GST_DEBUG_OBJECT (jitterbuffer, "expected #%d, got #%d, gap of %d",
@@ -1341,9 +1842,28 @@ gst_rtp_jitter_buffer_chain (GstPad * pad, GstObject * parent,
       rtp_jitter_buffer_reset_skew (priv->jbuf);
       priv->last_popped_seqnum = -1;
       priv->next_seqnum = seqnum;
+      clear_rtx_timers (priv);
+    }
+  }
+
+  if (priv->do_retransmission && !reset) {
+    if (gap > 0) {
+      /* packets are missing, schedule retransmission requests for them */
+      schedule_rtx_timers (jitterbuffer, seqnum, gap, timestamp);
+    } else if (gap == 0 && priv->last_in_dts != -1 && timestamp != -1 &&
+        timestamp > priv->last_in_dts) {
+      /* keep track of the packet spacing to estimate the arrival time of
+       * missing packets */
+      priv->packet_spacing = timestamp - priv->last_in_dts;
     }
   }
-  priv->next_in_seqnum = (seqnum + 1) & 0xffff;
+
+  /* a retransmitted or reordered packet does not move the expected seqnum */
+  if (priv->next_in_seqnum == -1 || gap >= 0 || reset) {
+    priv->next_in_seqnum = (seqnum + 1) & 0xffff;
+    priv->last_in_dts = timestamp;
+    priv->last_in_ssrc = ssrc;
+  }
 
   /* let's check if this buffer is too late, we can only accept packets with
    * bigger seqnum than the one we last pushed. */
@@ -1383,10 +1903,13 @@ gst_rtp_jitter_buffer_chain (GstPad * pad, GstObject * parent,
 
   /* now insert the packet into the queue in sorted order. This function returns
    * FALSE if a packet with the same seqnum was already in the queue, meaning we
-   * have a duplicate. */
+   * have a duplicate, or if the packet is too far from the queued packets. */
   if (G_UNLIKELY (!rtp_jitter_buffer_insert (priv->jbuf, buffer, timestamp,
-              priv->clock_rate, &tail, &percent)))
-    goto duplicate;
+              priv->clock_rate, &tail, &percent))) {
+    if (rtp_jitter_buffer_has_packet (priv->jbuf, seqnum))
+      goto duplicate;
+    goto too_far;
+  }
 
   /* signal addition of new buffer when the _loop is waiting. */
   if (priv->waiting)
@@ -1460,6 +1983,13 @@ duplicate:
     gst_buffer_unref (buffer);
     goto finished;
   }
+too_far:
+  {
+    GST_WARNING_OBJECT (jitterbuffer, "Packet #%d too far from the queued "
+        "packets, dropping", seqnum);
+    gst_buffer_unref (buffer);
+    goto finished;
+  }
 }
 
 static GstClockTime
@@ -1804,7 +2334,7 @@ again:
 
       /* we had a gap and thus we lost a packet. Create an event for this.  */
       GST_DEBUG_OBJECT (jitterbuffer, "Packet #%d lost", next_seqnum);
-      priv->num_late++;
+      priv->num_lost++;
       discont = TRUE;
 
       /* update our expected next packet */
@@ -2275,6 +2805,34 @@ gst_rtp_jitter_buffer_set_property (GObject * object,
       rtp_jitter_buffer_set_mode (priv->jbuf, g_value_get_enum (value));
       JBUF_UNLOCK (priv);
       break;
+    case PROP_DO_RETRANSMISSION:
+      JBUF_LOCK (priv);
+      priv->do_retransmission = g_value_get_boolean (value);
+      if (!priv->do_retransmission) {
+        clear_rtx_timers (priv);
+        rtx_timers_changed (priv);
+      } else if (priv->rtx_allowed) {
+        /* enabled while PAUSED or PLAYING, the thread stays around until
+         * PAUSED_TO_READY */
+        start_rtx_thread (jitterbuffer);
+      }
+      JBUF_UNLOCK (priv);
+      break;
+    case PROP_RTX_DELAY:
+      JBUF_LOCK (priv);
+      priv->rtx_delay = g_value_get_int (value);
+      JBUF_UNLOCK (priv);
+      break;
+    case PROP_RTX_RETRY_TIMEOUT:
+      JBUF_LOCK (priv);
+      priv->rtx_retry_timeout = g_value_get_int (value);
+      JBUF_UNLOCK (priv);
+      break;
+    case PROP_RTX_RETRY_PERIOD:
+      JBUF_LOCK (priv);
+      priv->rtx_retry_period = g_value_get_int (value);
+      JBUF_UNLOCK (priv);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -2331,8 +2889,48 @@ gst_rtp_jitter_buffer_get_property (GObject * object,
       JBUF_UNLOCK (priv);
       break;
     }
+    case PROP_DO_RETRANSMISSION:
+      JBUF_LOCK (priv);
+      g_value_set_boolean (value, priv->do_retransmission);
+      JBUF_UNLOCK (priv);
+      break;
+    case PROP_RTX_DELAY:
+      JBUF_LOCK (priv);
+      g_value_set_int (value, priv->rtx_delay);
+      JBUF_UNLOCK (priv);
+      break;
+    case PROP_RTX_RETRY_TIMEOUT:
+      JBUF_LOCK (priv);
+      g_value_set_int (value, priv->rtx_retry_timeout);
+      JBUF_UNLOCK (priv);
+      break;
+    case PROP_RTX_RETRY_PERIOD:
+      JBUF_LOCK (priv);
+      g_value_set_int (value, priv->rtx_retry_period);
+      JBUF_UNLOCK (priv);
+      break;
+    case PROP_STATS:
+      JBUF_LOCK (priv);
+      g_value_take_boxed (value, gst_rtp_jitter_buffer_create_stats (
+              jitterbuffer));
+      JBUF_UNLOCK (priv);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
   }
 }
+
+/* call with JBUF_LOCK */
+static GstStructure *
+gst_rtp_jitter_buffer_create_stats (GstRtpJitterBuffer * jbuf)
+{
+  GstRtpJitterBufferPrivate *priv = jbuf->priv;
+
+  return gst_structure_new ("application/x-rtp-jitterbuffer-stats",
+      "num-lost", G_TYPE_UINT64, priv->num_lost,
+      "num-late", G_TYPE_UINT64, priv->num_late,
+      "num-duplicates", G_TYPE_UINT64, priv->num_duplicates,
+      "rtx-count", G_TYPE_UINT64, priv->num_rtx_requests,
+      "rtx-success-count", G_TYPE_UINT64, priv->num_rtx_success, NULL);
+}
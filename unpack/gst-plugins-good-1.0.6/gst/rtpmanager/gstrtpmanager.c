@@ -22,8 +22,12 @@
 #endif
 
 #include "gstrtpbin.h"
+#include "gstrtpfecdec.h"
+#include "gstrtpfecenc.h"
 #include "gstrtpjitterbuffer.h"
 #include "gstrtpptdemux.h"
+#include "gstrtprtxreceive.h"
+#include "gstrtprtxsend.h"
 #include "gstrtpsession.h"
 #include "gstrtpssrcdemux.h"
 
@@ -33,6 +37,14 @@ plugin_init (GstPlugin * plugin)
   if (!gst_element_register (plugin, "rtpbin", GST_RANK_NONE, GST_TYPE_RTP_BIN))
     return FALSE;
 
+  if (!gst_element_register (plugin, "rtpfecdec", GST_RANK_NONE,
+          GST_TYPE_RTP_FEC_DEC))
+    return FALSE;
+
+  if (!gst_element_register (plugin, "rtpfecenc", GST_RANK_NONE,
+          GST_TYPE_RTP_FEC_ENC))
+    return FALSE;
+
   if (!gst_element_register (plugin, "rtpjitterbuffer", GST_RANK_NONE,
           GST_TYPE_RTP_JITTER_BUFFER))
     return FALSE;
@@ -41,6 +53,14 @@ plugin_init (GstPlugin * plugin)
           GST_TYPE_RTP_PT_DEMUX))
     return FALSE;
 
+  if (!gst_element_register (plugin, "rtprtxreceive", GST_RANK_NONE,
+          GST_TYPE_RTP_RTX_RECEIVE))
+    return FALSE;
+
+  if (!gst_element_register (plugin, "rtprtxsend", GST_RANK_NONE,
+          GST_TYPE_RTP_RTX_SEND))
+    return FALSE;
+
   if (!gst_element_register (plugin, "rtpsession", GST_RANK_NONE,
           GST_TYPE_RTP_SESSION))
     return FALSE;
@@ -129,6 +129,8 @@ static gboolean gst_rtp_pt_demux_sink_event (GstPad * pad, GstObject * parent,
     GstEvent * event);
 static GstFlowReturn gst_rtp_pt_demux_chain (GstPad * pad, GstObject * parent,
     GstBuffer * buf);
+static GstFlowReturn gst_rtp_pt_demux_chain_list (GstPad * pad,
+    GstObject * parent, GstBufferList * list);
 static GstStateChangeReturn gst_rtp_pt_demux_change_state (GstElement * element,
     GstStateChange transition);
 static void gst_rtp_pt_demux_clear_pt_map (GstRtpPtDemux * rtpdemux);
@@ -235,6 +237,7 @@ gst_rtp_pt_demux_init (GstRtpPtDemux * ptdemux)
   g_assert (ptdemux->sink != NULL);
 
   gst_pad_set_chain_function (ptdemux->sink, gst_rtp_pt_demux_chain);
+  gst_pad_set_chain_list_function (ptdemux->sink, gst_rtp_pt_demux_chain_list);
   gst_pad_set_event_function (ptdemux->sink, gst_rtp_pt_demux_sink_event);
 
   gst_element_add_pad (GST_ELEMENT (ptdemux), ptdemux->sink);
@@ -298,17 +301,12 @@ gst_rtp_pt_demux_clear_pt_map (GstRtpPtDemux * rtpdemux)
 static gboolean
 need_caps_for_pt (GstRtpPtDemux * rtpdemux, guint8 pt)
 {
-  GSList *walk;
+  GstRtpPtDemuxPad *pad;
   gboolean ret = FALSE;
 
   GST_OBJECT_LOCK (rtpdemux);
-  for (walk = rtpdemux->srcpads; walk; walk = g_slist_next (walk)) {
-    GstRtpPtDemuxPad *pad = walk->data;
-
-    if (pad->pt == pt) {
-      ret = pad->newcaps;
-    }
-  }
+  if ((pad = rtpdemux->pt_pads[pt]))
+    ret = pad->newcaps;
   GST_OBJECT_UNLOCK (rtpdemux);
 
   return ret;
@@ -318,17 +316,11 @@ need_caps_for_pt (GstRtpPtDemux * rtpdemux, guint8 pt)
 static void
 clear_newcaps_for_pt (GstRtpPtDemux * rtpdemux, guint8 pt)
 {
-  GSList *walk;
+  GstRtpPtDemuxPad *pad;
 
   GST_OBJECT_LOCK (rtpdemux);
-  for (walk = rtpdemux->srcpads; walk; walk = g_slist_next (walk)) {
-    GstRtpPtDemuxPad *pad = walk->data;
-
-    if (pad->pt == pt) {
-      pad->newcaps = FALSE;
-      break;
-    }
-  }
+  if ((pad = rtpdemux->pt_pads[pt]))
+    pad->newcaps = FALSE;
   GST_OBJECT_UNLOCK (rtpdemux);
 }
 
@@ -342,25 +334,13 @@ forward_sticky_events (GstPad * pad, GstEvent ** event, gpointer user_data)
   return TRUE;
 }
 
-static GstFlowReturn
-gst_rtp_pt_demux_chain (GstPad * pad, GstObject * parent, GstBuffer * buf)
+/* returns the src pad for pt, creating it and updating its caps when needed,
+ * or NULL when there are no caps for pt */
+static GstPad *
+gst_rtp_pt_demux_get_src_pad (GstRtpPtDemux * rtpdemux, guint8 pt)
 {
-  GstFlowReturn ret = GST_FLOW_OK;
-  GstRtpPtDemux *rtpdemux;
-  guint8 pt;
   GstPad *srcpad;
   GstCaps *caps;
-  GstRTPBuffer rtp = { NULL };
-
-  rtpdemux = GST_RTP_PT_DEMUX (parent);
-
-  if (!gst_rtp_buffer_map (buf, GST_MAP_READ, &rtp))
-    goto invalid_buffer;
-
-  pt = gst_rtp_buffer_get_payload_type (&rtp);
-  gst_rtp_buffer_unmap (&rtp);
-
-  GST_DEBUG_OBJECT (rtpdemux, "received buffer for pt %d", pt);
 
   srcpad = find_pad_for_pt (rtpdemux, pt);
   if (srcpad == NULL) {
@@ -387,9 +367,11 @@ gst_rtp_pt_demux_chain (GstPad * pad, GstObject * parent, GstBuffer * buf)
     rtpdemuxpad->pt = pt;
     rtpdemuxpad->newcaps = FALSE;
     rtpdemuxpad->pad = srcpad;
+    gst_pad_set_element_private (srcpad, rtpdemuxpad);
     gst_object_ref (srcpad);
     GST_OBJECT_LOCK (rtpdemux);
     rtpdemux->srcpads = g_slist_append (rtpdemux->srcpads, rtpdemuxpad);
+    rtpdemux->pt_pads[pt] = rtpdemuxpad;
     GST_OBJECT_UNLOCK (rtpdemux);
 
     gst_pad_set_active (srcpad, TRUE);
@@ -435,6 +417,42 @@ gst_rtp_pt_demux_chain (GstPad * pad, GstObject * parent, GstBuffer * buf)
     gst_caps_unref (caps);
   }
 
+  return srcpad;
+
+  /* ERRORS */
+no_caps:
+  {
+    GST_ELEMENT_ERROR (rtpdemux, STREAM, DECODE, (NULL),
+        ("Could not get caps for payload"));
+    if (srcpad)
+      gst_object_unref (srcpad);
+    return NULL;
+  }
+}
+
+static GstFlowReturn
+gst_rtp_pt_demux_chain (GstPad * pad, GstObject * parent, GstBuffer * buf)
+{
+  GstFlowReturn ret = GST_FLOW_OK;
+  GstRtpPtDemux *rtpdemux;
+  guint8 pt;
+  GstPad *srcpad;
+  GstRTPBuffer rtp = { NULL };
+
+  rtpdemux = GST_RTP_PT_DEMUX (parent);
+
+  if (!gst_rtp_buffer_map (buf, GST_MAP_READ, &rtp))
+    goto invalid_buffer;
+
+  pt = gst_rtp_buffer_get_payload_type (&rtp);
+  gst_rtp_buffer_unmap (&rtp);
+
+  GST_DEBUG_OBJECT (rtpdemux, "received buffer for pt %d", pt);
+
+  srcpad = gst_rtp_pt_demux_get_src_pad (rtpdemux, pt);
+  if (srcpad == NULL)
+    goto no_caps;
+
   /* push to srcpad */
   ret = gst_pad_push (srcpad, buf);
 
@@ -453,12 +471,94 @@ invalid_buffer:
   }
 no_caps:
   {
-    GST_ELEMENT_ERROR (rtpdemux, STREAM, DECODE, (NULL),
-        ("Could not get caps for payload"));
     gst_buffer_unref (buf);
+    return GST_FLOW_ERROR;
+  }
+}
+
+/* pushes the runs of packets with the same pt as one list, the packets stay
+ * in order so the payload-type-change signal is emitted as for buffers */
+static GstFlowReturn
+gst_rtp_pt_demux_chain_list (GstPad * pad, GstObject * parent,
+    GstBufferList * list)
+{
+  GstFlowReturn ret = GST_FLOW_OK;
+  GstRtpPtDemux *rtpdemux;
+  GstBufferList *run = NULL;
+  GstPad *srcpad = NULL;
+  guint8 pt, run_pt = 0;
+  guint i, len;
+
+  rtpdemux = GST_RTP_PT_DEMUX (parent);
+
+  len = gst_buffer_list_length (list);
+  for (i = 0; i < len; i++) {
+    GstBuffer *buf = gst_buffer_list_get (list, i);
+    GstRTPBuffer rtp = { NULL };
+
+    if (!gst_rtp_buffer_map (buf, GST_MAP_READ, &rtp))
+      goto invalid_buffer;
+
+    pt = gst_rtp_buffer_get_payload_type (&rtp);
+    gst_rtp_buffer_unmap (&rtp);
+
+    if (run == NULL || pt != run_pt) {
+      if (run) {
+        GST_LOG_OBJECT (rtpdemux, "pushing %u packets for pt %d",
+            gst_buffer_list_length (run), run_pt);
+        ret = gst_pad_push_list (srcpad, run);
+        run = NULL;
+        gst_object_unref (srcpad);
+        srcpad = NULL;
+        if (ret != GST_FLOW_OK)
+          goto done;
+      }
+
+      GST_DEBUG_OBJECT (rtpdemux, "received list packets for pt %d", pt);
+      srcpad = gst_rtp_pt_demux_get_src_pad (rtpdemux, pt);
+      if (srcpad == NULL)
+        goto no_caps;
+
+      run = gst_buffer_list_new ();
+      run_pt = pt;
+    }
+    gst_buffer_list_add (run, gst_buffer_ref (buf));
+  }
+
+  if (run) {
+    GST_LOG_OBJECT (rtpdemux, "pushing %u packets for pt %d",
+        gst_buffer_list_length (run), run_pt);
+    ret = gst_pad_push_list (srcpad, run);
+    gst_object_unref (srcpad);
+  }
+
+done:
+  gst_buffer_list_unref (list);
+
+  return ret;
+
+  /* ERRORS */
+invalid_buffer:
+  {
+    /* this is fatal and should be filtered earlier */
+    GST_ELEMENT_ERROR (rtpdemux, STREAM, DECODE, (NULL),
+        ("Dropping invalid RTP payload"));
+    ret = GST_FLOW_ERROR;
+    goto error;
+  }
+no_caps:
+  {
+    ret = GST_FLOW_ERROR;
+    goto error;
+  }
+error:
+  {
+    if (run)
+      gst_buffer_list_unref (run);
     if (srcpad)
       gst_object_unref (srcpad);
-    return GST_FLOW_ERROR;
+    gst_buffer_list_unref (list);
+    return ret;
   }
 }
 
@@ -466,17 +566,14 @@ static GstPad *
 find_pad_for_pt (GstRtpPtDemux * rtpdemux, guint8 pt)
 {
   GstPad *respad = NULL;
-  GSList *walk;
 
-  GST_OBJECT_LOCK (rtpdemux);
-  for (walk = rtpdemux->srcpads; walk; walk = g_slist_next (walk)) {
-    GstRtpPtDemuxPad *pad = walk->data;
+  /* last_pt is 0xFFFF when there was no packet yet */
+  if (pt >= G_N_ELEMENTS (rtpdemux->pt_pads))
+    return NULL;
 
-    if (pad->pt == pt) {
-      respad = gst_object_ref (pad->pad);
-      break;
-    }
-  }
+  GST_OBJECT_LOCK (rtpdemux);
+  if (rtpdemux->pt_pads[pt])
+    respad = gst_object_ref (rtpdemux->pt_pads[pt]->pad);
   GST_OBJECT_UNLOCK (rtpdemux);
 
   return respad;
@@ -544,22 +641,18 @@ gst_rtp_pt_demux_src_event (GstPad * pad, GstObject * parent, GstEvent * event)
     case GST_EVENT_CUSTOM_BOTH_OOB:
       s = gst_event_get_structure (event);
       if (s && !gst_structure_has_field (s, "payload")) {
-        GSList *walk;
+        GstRtpPtDemuxPad *dpad;
 
         GST_OBJECT_LOCK (demux);
-        for (walk = demux->srcpads; walk; walk = g_slist_next (walk)) {
-          GstRtpPtDemuxPad *dpad = (GstRtpPtDemuxPad *) walk->data;
-
-          if (dpad->pad == pad) {
-            GstStructure *ws;
-
-            event =
-                GST_EVENT_CAST (gst_mini_object_make_writable
-                (GST_MINI_OBJECT_CAST (event)));
-            ws = gst_event_writable_structure (event);
-            gst_structure_set (ws, "payload", G_TYPE_UINT, dpad->pt, NULL);
-            break;
-          }
+        dpad = gst_pad_get_element_private (pad);
+        if (dpad && dpad->pad == pad) {
+          GstStructure *ws;
+
+          event =
+              GST_EVENT_CAST (gst_mini_object_make_writable
+              (GST_MINI_OBJECT_CAST (event)));
+          ws = gst_event_writable_structure (event);
+          gst_structure_set (ws, "payload", G_TYPE_UINT, dpad->pt, NULL);
         }
         GST_OBJECT_UNLOCK (demux);
       }
@@ -595,6 +688,14 @@ gst_rtp_pt_demux_release (GstRtpPtDemux * ptdemux)
   GST_OBJECT_LOCK (ptdemux);
   tmppads = ptdemux->srcpads;
   ptdemux->srcpads = NULL;
+  memset (ptdemux->pt_pads, 0, sizeof (ptdemux->pt_pads));
+  /* the src event handler looks at the element_private with the object
+   * lock, after this it can't find the GstRtpPtDemuxPads we free below */
+  for (walk = tmppads; walk; walk = g_slist_next (walk)) {
+    GstRtpPtDemuxPad *pad = walk->data;
+
+    gst_pad_set_element_private (pad->pad, NULL);
+  }
   GST_OBJECT_UNLOCK (ptdemux);
 
   for (walk = tmppads; walk; walk = g_slist_next (walk)) {
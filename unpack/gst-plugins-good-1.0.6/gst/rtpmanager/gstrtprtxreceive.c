@@ -0,0 +1,419 @@
+/* RTP Retransmission receiver element for GStreamer
+ *
+ * gstrtprtxreceive.c:
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/**
+ * SECTION:element-rtprtxreceive
+ *
+ * The rtprtxreceive element restores the original packets from the
+ * retransmission packets sent by #GstRtpRtxSend, as described in RFC 4588.
+ * Packets with a payload type that is not a retransmission payload type in
+ * #GstRtpRtxReceive:payload-type-map are passed through unchanged.
+ *
+ * A retransmission stream is associated with the last original stream that
+ * was seen with the matching original payload type. This is enough for the
+ * common case of one stream per payload type.
+ *
+ * The element is placed in front of the recv_rtp_sink pad of #GstRtpBin,
+ * where it also passes the retransmission requests of the jitterbuffer
+ * upstream.
+ *
+ * <refsect2>
+ * <title>Example pipeline</title>
+ * |[
+ * gst-launch-1.0 rtpbin name=rtpbin do-retransmission=true \
+ *     udpsrc port=5000 caps="application/x-rtp, media=video, clock-rate=90000, encoding-name=H264, payload=96" ! \
+ *     rtprtxreceive payload-type-map="application/x-rtp-pt-map, 96=(uint)97" ! \
+ *     rtpbin.recv_rtp_sink_0 \
+ *     rtpbin. ! rtph264depay ! avdec_h264 ! xvimagesink \
+ *     udpsrc port=5001 ! rtpbin.recv_rtcp_sink_0 \
+ *     rtpbin.send_rtcp_src_0 ! udpsink port=5005 sync=false async=false
+ * ]| Receive H264 video and restore the retransmitted packets with payload
+ * type 97.
+ * </refsect2>
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <string.h>
+#include <stdlib.h>
+#include <gst/rtp/gstrtpbuffer.h>
+
+#include "gstrtprtxreceive.h"
+
+GST_DEBUG_CATEGORY_STATIC (gst_rtp_rtx_receive_debug);
+#define GST_CAT_DEFAULT gst_rtp_rtx_receive_debug
+
+enum
+{
+  PROP_0,
+  PROP_PAYLOAD_TYPE_MAP,
+  PROP_NUM_RTX_PACKETS,
+  PROP_NUM_RTX_ASSOC_FAILED,
+  PROP_LAST
+};
+
+static GstStaticPadTemplate src_factory = GST_STATIC_PAD_TEMPLATE ("src",
+    GST_PAD_SRC,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS ("application/x-rtp")
+    );
+
+static GstStaticPadTemplate sink_factory = GST_STATIC_PAD_TEMPLATE ("sink",
+    GST_PAD_SINK,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS ("application/x-rtp")
+    );
+
+static GstFlowReturn gst_rtp_rtx_receive_chain (GstPad * pad,
+    GstObject * parent, GstBuffer * buffer);
+
+static GstStateChangeReturn gst_rtp_rtx_receive_change_state (GstElement *
+    element, GstStateChange transition);
+
+static void gst_rtp_rtx_receive_set_property (GObject * object, guint prop_id,
+    const GValue * value, GParamSpec * pspec);
+static void gst_rtp_rtx_receive_get_property (GObject * object, guint prop_id,
+    GValue * value, GParamSpec * pspec);
+static void gst_rtp_rtx_receive_finalize (GObject * object);
+
+G_DEFINE_TYPE (GstRtpRtxReceive, gst_rtp_rtx_receive, GST_TYPE_ELEMENT);
+
+static void
+gst_rtp_rtx_receive_class_init (GstRtpRtxReceiveClass * klass)
+{
+  GObjectClass *gobject_class;
+  GstElementClass *gstelement_class;
+
+  gobject_class = (GObjectClass *) klass;
+  gstelement_class = (GstElementClass *) klass;
+
+  gobject_class->get_property = gst_rtp_rtx_receive_get_property;
+  gobject_class->set_property = gst_rtp_rtx_receive_set_property;
+  gobject_class->finalize = gst_rtp_rtx_receive_finalize;
+
+  /**
+   * GstRtpRtxReceive::payload-type-map:
+   *
+   * A #GstStructure mapping the payload types of the original streams to
+   * the payload types of their retransmission streams, for example
+   * "application/x-rtp-pt-map, 96=(uint)97".
+   */
+  g_object_class_install_property (gobject_class, PROP_PAYLOAD_TYPE_MAP,
+      g_param_spec_boxed ("payload-type-map", "Payload Type Map",
+          "Map of original payload types to their retransmission payload types",
+          GST_TYPE_STRUCTURE, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  g_object_class_install_property (gobject_class, PROP_NUM_RTX_PACKETS,
+      g_param_spec_uint ("num-rtx-packets", "Num RTX Packets",
+          "Number of retransmission packets received", 0, G_MAXUINT,
+          0, G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+
+  g_object_class_install_property (gobject_class, PROP_NUM_RTX_ASSOC_FAILED,
+      g_param_spec_uint ("num-rtx-assoc-failed",
+          "Num RTX Associated Failed Packets",
+          "Number of retransmission packets that could not be associated with "
+          "an original stream", 0, G_MAXUINT, 0,
+          G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+
+  gst_element_class_add_pad_template (gstelement_class,
+      gst_static_pad_template_get (&src_factory));
+  gst_element_class_add_pad_template (gstelement_class,
+      gst_static_pad_template_get (&sink_factory));
+
+  gst_element_class_set_static_metadata (gstelement_class,
+      "RTP Retransmission receiver", "Filter/Network/RTP",
+      "Receive retransmitted RTP packets according to RFC4588",
+      "GStreamer maintainers <gstreamer-devel@lists.freedesktop.org>");
+
+  gstelement_class->change_state =
+      GST_DEBUG_FUNCPTR (gst_rtp_rtx_receive_change_state);
+
+  GST_DEBUG_CATEGORY_INIT (gst_rtp_rtx_receive_debug, "rtprtxreceive", 0,
+      "rtp retransmission receiver");
+}
+
+static void
+gst_rtp_rtx_receive_reset (GstRtpRtxReceive * rtx)
+{
+  GST_OBJECT_LOCK (rtx);
+  g_hash_table_remove_all (rtx->ssrc2_ssrc1_map);
+  g_hash_table_remove_all (rtx->pt_ssrc_map);
+  rtx->num_rtx_packets = 0;
+  rtx->num_rtx_assoc_failed = 0;
+  GST_OBJECT_UNLOCK (rtx);
+}
+
+static void
+gst_rtp_rtx_receive_finalize (GObject * object)
+{
+  GstRtpRtxReceive *rtx = GST_RTP_RTX_RECEIVE (object);
+
+  g_hash_table_unref (rtx->ssrc2_ssrc1_map);
+  g_hash_table_unref (rtx->pt_ssrc_map);
+  g_hash_table_unref (rtx->rtx_pt_map);
+  if (rtx->pt_map_structure)
+    gst_structure_free (rtx->pt_map_structure);
+
+  G_OBJECT_CLASS (gst_rtp_rtx_receive_parent_class)->finalize (object);
+}
+
+static void
+gst_rtp_rtx_receive_init (GstRtpRtxReceive * rtx)
+{
+  GstElementClass *klass = GST_ELEMENT_GET_CLASS (rtx);
+
+  rtx->srcpad =
+      gst_pad_new_from_template (gst_element_class_get_pad_template (klass,
+          "src"), "src");
+  GST_PAD_SET_PROXY_CAPS (rtx->srcpad);
+  GST_PAD_SET_PROXY_ALLOCATION (rtx->srcpad);
+  gst_element_add_pad (GST_ELEMENT (rtx), rtx->srcpad);
+
+  rtx->sinkpad =
+      gst_pad_new_from_template (gst_element_class_get_pad_template (klass,
+          "sink"), "sink");
+  GST_PAD_SET_PROXY_CAPS (rtx->sinkpad);
+  GST_PAD_SET_PROXY_ALLOCATION (rtx->sinkpad);
+  gst_pad_set_chain_function (rtx->sinkpad,
+      GST_DEBUG_FUNCPTR (gst_rtp_rtx_receive_chain));
+  gst_element_add_pad (GST_ELEMENT (rtx), rtx->sinkpad);
+
+  rtx->ssrc2_ssrc1_map = g_hash_table_new (g_direct_hash, g_direct_equal);
+  rtx->pt_ssrc_map = g_hash_table_new (g_direct_hash, g_direct_equal);
+  rtx->rtx_pt_map = g_hash_table_new (g_direct_hash, g_direct_equal);
+}
+
+/* unwrap the retransmission packet in @buffer, the payload starts with the
+ * original sequence number. */
+static GstBuffer *
+gst_rtp_rtx_buffer_restore (GstBuffer * buffer, guint32 ssrc, guint8 pt)
+{
+  GstRTPBuffer rtp = GST_RTP_BUFFER_INIT;
+  GstRTPBuffer new_rtp = GST_RTP_BUFFER_INIT;
+  GstBuffer *new_buffer;
+  guint payload_len, csrc_count, i;
+  guint8 *payload;
+  guint16 seqnum;
+
+  gst_rtp_buffer_map (buffer, GST_MAP_READ, &rtp);
+
+  payload = gst_rtp_buffer_get_payload (&rtp);
+  payload_len = gst_rtp_buffer_get_payload_len (&rtp) - 2;
+  csrc_count = gst_rtp_buffer_get_csrc_count (&rtp);
+  seqnum = GST_READ_UINT16_BE (payload);
+
+  new_buffer = gst_rtp_buffer_new_allocate (payload_len, 0, csrc_count);
+  gst_rtp_buffer_map (new_buffer, GST_MAP_WRITE, &new_rtp);
+
+  gst_rtp_buffer_set_ssrc (&new_rtp, ssrc);
+  gst_rtp_buffer_set_seq (&new_rtp, seqnum);
+  gst_rtp_buffer_set_payload_type (&new_rtp, pt);
+  gst_rtp_buffer_set_timestamp (&new_rtp, gst_rtp_buffer_get_timestamp (&rtp));
+  gst_rtp_buffer_set_marker (&new_rtp, gst_rtp_buffer_get_marker (&rtp));
+  for (i = 0; i < csrc_count; i++)
+    gst_rtp_buffer_set_csrc (&new_rtp, i, gst_rtp_buffer_get_csrc (&rtp, i));
+
+  memcpy (gst_rtp_buffer_get_payload (&new_rtp), payload + 2, payload_len);
+
+  gst_rtp_buffer_unmap (&new_rtp);
+  gst_rtp_buffer_unmap (&rtp);
+
+  gst_buffer_copy_into (new_buffer, buffer,
+      GST_BUFFER_COPY_FLAGS | GST_BUFFER_COPY_TIMESTAMPS, 0, -1);
+
+  return new_buffer;
+}
+
+static GstFlowReturn
+gst_rtp_rtx_receive_chain (GstPad * pad, GstObject * parent,
+    GstBuffer * buffer)
+{
+  GstRtpRtxReceive *rtx = GST_RTP_RTX_RECEIVE (parent);
+  GstRTPBuffer rtp = GST_RTP_BUFFER_INIT;
+  gpointer master_pt, master_ssrc;
+  GstBuffer *new_buffer;
+  guint payload_len;
+  guint32 ssrc;
+  guint8 pt;
+
+  if (G_UNLIKELY (!gst_rtp_buffer_map (buffer, GST_MAP_READ, &rtp)))
+    goto invalid_buffer;
+
+  ssrc = gst_rtp_buffer_get_ssrc (&rtp);
+  pt = gst_rtp_buffer_get_payload_type (&rtp);
+  payload_len = gst_rtp_buffer_get_payload_len (&rtp);
+  gst_rtp_buffer_unmap (&rtp);
+
+  GST_OBJECT_LOCK (rtx);
+  if (!g_hash_table_lookup_extended (rtx->rtx_pt_map, GUINT_TO_POINTER (pt),
+          NULL, &master_pt)) {
+    /* an original packet, remember its ssrc for the association */
+    g_hash_table_insert (rtx->pt_ssrc_map, GUINT_TO_POINTER (pt),
+        GUINT_TO_POINTER (ssrc));
+    GST_OBJECT_UNLOCK (rtx);
+
+    return gst_pad_push (rtx->srcpad, buffer);
+  }
+
+  if (payload_len < 2)
+    goto invalid_rtx;
+
+  if (!g_hash_table_lookup_extended (rtx->ssrc2_ssrc1_map,
+          GUINT_TO_POINTER (ssrc), NULL, &master_ssrc)) {
+    if (!g_hash_table_lookup_extended (rtx->pt_ssrc_map, master_pt, NULL,
+            &master_ssrc))
+      goto no_association;
+
+    GST_DEBUG_OBJECT (rtx, "associate rtx ssrc %08x with ssrc %08x", ssrc,
+        GPOINTER_TO_UINT (master_ssrc));
+    g_hash_table_insert (rtx->ssrc2_ssrc1_map, GUINT_TO_POINTER (ssrc),
+        master_ssrc);
+  }
+  rtx->num_rtx_packets++;
+  GST_OBJECT_UNLOCK (rtx);
+
+  new_buffer = gst_rtp_rtx_buffer_restore (buffer,
+      GPOINTER_TO_UINT (master_ssrc), (guint8) GPOINTER_TO_UINT (master_pt));
+  gst_buffer_unref (buffer);
+
+  return gst_pad_push (rtx->srcpad, new_buffer);
+
+  /* ERRORS */
+invalid_buffer:
+  {
+    GST_ELEMENT_WARNING (rtx, STREAM, DECODE, (NULL),
+        ("Received invalid RTP payload, dropping"));
+    gst_buffer_unref (buffer);
+    return GST_FLOW_OK;
+  }
+invalid_rtx:
+  {
+    GST_OBJECT_UNLOCK (rtx);
+    GST_DEBUG_OBJECT (rtx, "retransmission packet without OSN, dropping");
+    gst_buffer_unref (buffer);
+    return GST_FLOW_OK;
+  }
+no_association:
+  {
+    rtx->num_rtx_assoc_failed++;
+    GST_OBJECT_UNLOCK (rtx);
+    GST_DEBUG_OBJECT (rtx, "no original stream for rtx ssrc %08x, dropping",
+        ssrc);
+    gst_buffer_unref (buffer);
+    return GST_FLOW_OK;
+  }
+}
+
+/* the map is given as master pt -> rtx pt, we need the reverse */
+static gboolean
+structure_to_hash_table_inv (GQuark field_id, const GValue * value,
+    gpointer hash)
+{
+  const gchar *field_str;
+  guint field_uint;
+  guint value_uint;
+
+  if (!G_VALUE_HOLDS_UINT (value))
+    return TRUE;
+
+  field_str = g_quark_to_string (field_id);
+  field_uint = atoi (field_str);
+  value_uint = g_value_get_uint (value);
+  g_hash_table_insert ((GHashTable *) hash, GUINT_TO_POINTER (value_uint),
+      GUINT_TO_POINTER (field_uint));
+
+  return TRUE;
+}
+
+static void
+gst_rtp_rtx_receive_set_property (GObject * object,
+    guint prop_id, const GValue * value, GParamSpec * pspec)
+{
+  GstRtpRtxReceive *rtx = GST_RTP_RTX_RECEIVE (object);
+
+  switch (prop_id) {
+    case PROP_PAYLOAD_TYPE_MAP:
+      GST_OBJECT_LOCK (rtx);
+      if (rtx->pt_map_structure)
+        gst_structure_free (rtx->pt_map_structure);
+      rtx->pt_map_structure = g_value_dup_boxed (value);
+      g_hash_table_remove_all (rtx->rtx_pt_map);
+      if (rtx->pt_map_structure)
+        gst_structure_foreach (rtx->pt_map_structure,
+            structure_to_hash_table_inv, rtx->rtx_pt_map);
+      GST_OBJECT_UNLOCK (rtx);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
+static void
+gst_rtp_rtx_receive_get_property (GObject * object,
+    guint prop_id, GValue * value, GParamSpec * pspec)
+{
+  GstRtpRtxReceive *rtx = GST_RTP_RTX_RECEIVE (object);
+
+  switch (prop_id) {
+    case PROP_PAYLOAD_TYPE_MAP:
+      GST_OBJECT_LOCK (rtx);
+      g_value_set_boxed (value, rtx->pt_map_structure);
+      GST_OBJECT_UNLOCK (rtx);
+      break;
+    case PROP_NUM_RTX_PACKETS:
+      GST_OBJECT_LOCK (rtx);
+      g_value_set_uint (value, rtx->num_rtx_packets);
+      GST_OBJECT_UNLOCK (rtx);
+      break;
+    case PROP_NUM_RTX_ASSOC_FAILED:
+      GST_OBJECT_LOCK (rtx);
+      g_value_set_uint (value, rtx->num_rtx_assoc_failed);
+      GST_OBJECT_UNLOCK (rtx);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
+static GstStateChangeReturn
+gst_rtp_rtx_receive_change_state (GstElement * element,
+    GstStateChange transition)
+{
+  GstRtpRtxReceive *rtx = GST_RTP_RTX_RECEIVE (element);
+  GstStateChangeReturn ret;
+
+  ret =
+      GST_ELEMENT_CLASS (gst_rtp_rtx_receive_parent_class)->change_state
+      (element, transition);
+
+  switch (transition) {
+    case GST_STATE_CHANGE_PAUSED_TO_READY:
+      gst_rtp_rtx_receive_reset (rtx);
+      break;
+    default:
+      break;
+  }
+
+  return ret;
+}
@@ -0,0 +1,656 @@
+/* RTP Retransmission sender element for GStreamer
+ *
+ * gstrtprtxsend.c:
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/**
+ * SECTION:element-rtprtxsend
+ *
+ * The rtprtxsend element keeps a history of the RTP packets it sent and
+ * retransmits them on request, as described in RFC 4588. Retransmission
+ * requests are received as GstRTPRetransmissionRequest events travelling
+ * upstream, as emitted by #GstRtpSession when it receives a Generic NACK
+ * feedback message from a receiver.
+ *
+ * The retransmitted packets use SSRC-multiplexing: they are sent with their
+ * own SSRC and sequence numbers and with the retransmission payload type
+ * configured in #GstRtpRtxSend:payload-type-map. The payload of a
+ * retransmission packet is the original sequence number followed by the
+ * original payload.
+ *
+ * The element is placed in front of the send_rtp_sink pad of #GstRtpBin.
+ *
+ * <refsect2>
+ * <title>Example pipeline</title>
+ * |[
+ * gst-launch-1.0 rtpbin name=rtpbin \
+ *     videotestsrc ! x264enc ! rtph264pay pt=96 ! \
+ *     rtprtxsend payload-type-map="application/x-rtp-pt-map, 96=(uint)97" ! \
+ *     rtpbin.send_rtp_sink_0 \
+ *     rtpbin.send_rtp_src_0 ! udpsink port=5000 \
+ *     rtpbin.send_rtcp_src_0 ! udpsink port=5001 sync=false async=false \
+ *     udpsrc port=5005 ! rtpbin.recv_rtcp_sink_0
+ * ]| Send H264 video and retransmit lost packets with payload type 97.
+ * </refsect2>
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <string.h>
+#include <stdlib.h>
+#include <gst/rtp/gstrtpbuffer.h>
+
+#include "gstrtprtxsend.h"
+
+GST_DEBUG_CATEGORY_STATIC (gst_rtp_rtx_send_debug);
+#define GST_CAT_DEFAULT gst_rtp_rtx_send_debug
+
+#define DEFAULT_RTX_PAYLOAD_TYPE_MAP NULL
+#define DEFAULT_MAX_SIZE_PACKETS     100
+
+enum
+{
+  PROP_0,
+  PROP_PAYLOAD_TYPE_MAP,
+  PROP_MAX_SIZE_PACKETS,
+  PROP_NUM_RTX_REQUESTS,
+  PROP_NUM_RTX_PACKETS,
+  PROP_LAST
+};
+
+static GstStaticPadTemplate src_factory = GST_STATIC_PAD_TEMPLATE ("src",
+    GST_PAD_SRC,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS ("application/x-rtp")
+    );
+
+static GstStaticPadTemplate sink_factory = GST_STATIC_PAD_TEMPLATE ("sink",
+    GST_PAD_SINK,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS ("application/x-rtp")
+    );
+
+static gboolean gst_rtp_rtx_send_src_event (GstPad * pad, GstObject * parent,
+    GstEvent * event);
+static gboolean gst_rtp_rtx_send_src_activate_mode (GstPad * pad,
+    GstObject * parent, GstPadMode mode, gboolean active);
+static GstFlowReturn gst_rtp_rtx_send_chain (GstPad * pad, GstObject * parent,
+    GstBuffer * buffer);
+
+static GstStateChangeReturn gst_rtp_rtx_send_change_state (GstElement *
+    element, GstStateChange transition);
+
+static void gst_rtp_rtx_send_set_property (GObject * object, guint prop_id,
+    const GValue * value, GParamSpec * pspec);
+static void gst_rtp_rtx_send_get_property (GObject * object, guint prop_id,
+    GValue * value, GParamSpec * pspec);
+static void gst_rtp_rtx_send_finalize (GObject * object);
+
+G_DEFINE_TYPE (GstRtpRtxSend, gst_rtp_rtx_send, GST_TYPE_ELEMENT);
+
+typedef struct
+{
+  guint16 seqnum;
+  GstBuffer *buffer;
+} BufferQueueItem;
+
+typedef struct
+{
+  guint32 rtx_ssrc;
+  guint16 next_seqnum;
+  /* history of BufferQueueItem, oldest first */
+  GQueue queue;
+  /* seqnum -> BufferQueueItem in queue */
+  GHashTable *seqnums;
+} SSRCRtxData;
+
+static void
+buffer_queue_item_free (BufferQueueItem * item)
+{
+  gst_buffer_unref (item->buffer);
+  g_slice_free (BufferQueueItem, item);
+}
+
+static SSRCRtxData *
+ssrc_rtx_data_new (guint32 rtx_ssrc)
+{
+  SSRCRtxData *data = g_slice_new0 (SSRCRtxData);
+
+  data->rtx_ssrc = rtx_ssrc;
+  data->next_seqnum = g_random_int_range (0, G_MAXUINT16);
+  g_queue_init (&data->queue);
+  data->seqnums = g_hash_table_new (g_direct_hash, g_direct_equal);
+
+  return data;
+}
+
+static void
+ssrc_rtx_data_free (SSRCRtxData * data)
+{
+  g_queue_foreach (&data->queue, (GFunc) buffer_queue_item_free, NULL);
+  g_queue_clear (&data->queue);
+  g_hash_table_unref (data->seqnums);
+  g_slice_free (SSRCRtxData, data);
+}
+
+static void
+gst_rtp_rtx_send_class_init (GstRtpRtxSendClass * klass)
+{
+  GObjectClass *gobject_class;
+  GstElementClass *gstelement_class;
+
+  gobject_class = (GObjectClass *) klass;
+  gstelement_class = (GstElementClass *) klass;
+
+  gobject_class->get_property = gst_rtp_rtx_send_get_property;
+  gobject_class->set_property = gst_rtp_rtx_send_set_property;
+  gobject_class->finalize = gst_rtp_rtx_send_finalize;
+
+  /**
+   * GstRtpRtxSend::payload-type-map:
+   *
+   * A #GstStructure mapping the payload types of the original streams to
+   * the payload types of their retransmission streams, for example
+   * "application/x-rtp-pt-map, 96=(uint)97". Only packets with a payload
+   * type in this map are kept for retransmission.
+   */
+  g_object_class_install_property (gobject_class, PROP_PAYLOAD_TYPE_MAP,
+      g_param_spec_boxed ("payload-type-map", "Payload Type Map",
+          "Map of original payload types to their retransmission payload types",
+          GST_TYPE_STRUCTURE, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  g_object_class_install_property (gobject_class, PROP_MAX_SIZE_PACKETS,
+      g_param_spec_uint ("max-size-packets", "Max Size in Packets",
+          "Amount of packets to queue per SSRC for retransmission (0 = unlimited)",
+          0, G_MAXINT16, DEFAULT_MAX_SIZE_PACKETS,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  g_object_class_install_property (gobject_class, PROP_NUM_RTX_REQUESTS,
+      g_param_spec_uint ("num-rtx-requests", "Num RTX Requests",
+          "Number of retransmission events received", 0, G_MAXUINT,
+          0, G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+
+  g_object_class_install_property (gobject_class, PROP_NUM_RTX_PACKETS,
+      g_param_spec_uint ("num-rtx-packets", "Num RTX Packets",
+          "Number of retransmission packets sent", 0, G_MAXUINT,
+          0, G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+
+  gst_element_class_add_pad_template (gstelement_class,
+      gst_static_pad_template_get (&src_factory));
+  gst_element_class_add_pad_template (gstelement_class,
+      gst_static_pad_template_get (&sink_factory));
+
+  gst_element_class_set_static_metadata (gstelement_class,
+      "RTP Retransmission Sender", "Filter/Network/RTP",
+      "Retransmit RTP packets when needed, according to RFC4588",
+      "GStreamer maintainers <gstreamer-devel@lists.freedesktop.org>");
+
+  gstelement_class->change_state =
+      GST_DEBUG_FUNCPTR (gst_rtp_rtx_send_change_state);
+
+  GST_DEBUG_CATEGORY_INIT (gst_rtp_rtx_send_debug, "rtprtxsend", 0,
+      "rtp retransmission sender");
+}
+
+static void
+gst_rtp_rtx_send_reset (GstRtpRtxSend * rtx)
+{
+  GST_OBJECT_LOCK (rtx);
+  g_hash_table_remove_all (rtx->ssrc_data);
+  rtx->num_rtx_requests = 0;
+  rtx->num_rtx_packets = 0;
+  GST_OBJECT_UNLOCK (rtx);
+}
+
+static void
+gst_rtp_rtx_send_finalize (GObject * object)
+{
+  GstRtpRtxSend *rtx = GST_RTP_RTX_SEND (object);
+
+  g_queue_foreach (&rtx->pending, (GFunc) gst_buffer_unref, NULL);
+  g_queue_clear (&rtx->pending);
+  g_cond_clear (&rtx->pending_cond);
+  g_mutex_clear (&rtx->push_lock);
+  g_hash_table_unref (rtx->ssrc_data);
+  g_hash_table_unref (rtx->rtx_pt_map);
+  if (rtx->pt_map_structure)
+    gst_structure_free (rtx->pt_map_structure);
+
+  G_OBJECT_CLASS (gst_rtp_rtx_send_parent_class)->finalize (object);
+}
+
+static void
+gst_rtp_rtx_send_init (GstRtpRtxSend * rtx)
+{
+  GstElementClass *klass = GST_ELEMENT_GET_CLASS (rtx);
+
+  rtx->srcpad =
+      gst_pad_new_from_template (gst_element_class_get_pad_template (klass,
+          "src"), "src");
+  GST_PAD_SET_PROXY_CAPS (rtx->srcpad);
+  GST_PAD_SET_PROXY_ALLOCATION (rtx->srcpad);
+  gst_pad_set_event_function (rtx->srcpad,
+      GST_DEBUG_FUNCPTR (gst_rtp_rtx_send_src_event));
+  gst_pad_set_activatemode_function (rtx->srcpad,
+      GST_DEBUG_FUNCPTR (gst_rtp_rtx_send_src_activate_mode));
+  gst_element_add_pad (GST_ELEMENT (rtx), rtx->srcpad);
+
+  rtx->sinkpad =
+      gst_pad_new_from_template (gst_element_class_get_pad_template (klass,
+          "sink"), "sink");
+  GST_PAD_SET_PROXY_CAPS (rtx->sinkpad);
+  GST_PAD_SET_PROXY_ALLOCATION (rtx->sinkpad);
+  gst_pad_set_chain_function (rtx->sinkpad,
+      GST_DEBUG_FUNCPTR (gst_rtp_rtx_send_chain));
+  gst_element_add_pad (GST_ELEMENT (rtx), rtx->sinkpad);
+
+  rtx->ssrc_data = g_hash_table_new_full (g_direct_hash, g_direct_equal, NULL,
+      (GDestroyNotify) ssrc_rtx_data_free);
+  rtx->rtx_pt_map = g_hash_table_new (g_direct_hash, g_direct_equal);
+
+  rtx->max_size_packets = DEFAULT_MAX_SIZE_PACKETS;
+
+  g_queue_init (&rtx->pending);
+  g_cond_init (&rtx->pending_cond);
+  rtx->flushing = TRUE;
+  g_mutex_init (&rtx->push_lock);
+}
+
+/* pick a random SSRC for the retransmission stream that does not collide
+ * with any of the known streams. Call with OBJECT_LOCK */
+static guint32
+choose_ssrc (GstRtpRtxSend * rtx, guint32 master_ssrc)
+{
+  GHashTableIter iter;
+  gpointer key, value;
+  guint32 ssrc;
+  gboolean collision;
+
+  do {
+    ssrc = g_random_int ();
+    collision = (ssrc == master_ssrc);
+
+    g_hash_table_iter_init (&iter, rtx->ssrc_data);
+    while (!collision && g_hash_table_iter_next (&iter, &key, &value)) {
+      SSRCRtxData *data = value;
+
+      collision = (GPOINTER_TO_UINT (key) == ssrc || data->rtx_ssrc == ssrc);
+    }
+  } while (collision);
+
+  return ssrc;
+}
+
+/* add @buffer to the history of @data, dropping the oldest packets when
+ * there are more than @max_size. Call with OBJECT_LOCK */
+static void
+ssrc_rtx_data_push (SSRCRtxData * data, guint16 seqnum, GstBuffer * buffer,
+    guint max_size)
+{
+  BufferQueueItem *item;
+
+  item = g_slice_new (BufferQueueItem);
+  item->seqnum = seqnum;
+  item->buffer = gst_buffer_ref (buffer);
+  g_queue_push_tail (&data->queue, item);
+  g_hash_table_insert (data->seqnums, GUINT_TO_POINTER (seqnum), item);
+
+  while (max_size > 0 && g_queue_get_length (&data->queue) > max_size) {
+    item = g_queue_pop_head (&data->queue);
+    /* a later packet may have reused the seqnum after a wraparound */
+    if (g_hash_table_lookup (data->seqnums,
+            GUINT_TO_POINTER (item->seqnum)) == item)
+      g_hash_table_remove (data->seqnums, GUINT_TO_POINTER (item->seqnum));
+    buffer_queue_item_free (item);
+  }
+}
+
+/* wrap @buffer in a retransmission packet as described in RFC 4588
+ * section 4, call with OBJECT_LOCK */
+static GstBuffer *
+gst_rtp_rtx_buffer_new (GstRtpRtxSend * rtx, GstBuffer * buffer,
+    guint8 rtx_pt, SSRCRtxData * data)
+{
+  GstRTPBuffer rtp = GST_RTP_BUFFER_INIT;
+  GstRTPBuffer new_rtp = GST_RTP_BUFFER_INIT;
+  GstBuffer *new_buffer;
+  guint payload_len, csrc_count, i;
+  guint8 *payload;
+
+  if (!gst_rtp_buffer_map (buffer, GST_MAP_READ, &rtp))
+    return NULL;
+
+  payload_len = gst_rtp_buffer_get_payload_len (&rtp);
+  csrc_count = gst_rtp_buffer_get_csrc_count (&rtp);
+
+  new_buffer = gst_rtp_buffer_new_allocate (payload_len + 2, 0, csrc_count);
+  gst_rtp_buffer_map (new_buffer, GST_MAP_WRITE, &new_rtp);
+
+  gst_rtp_buffer_set_ssrc (&new_rtp, data->rtx_ssrc);
+  gst_rtp_buffer_set_seq (&new_rtp, data->next_seqnum++);
+  gst_rtp_buffer_set_payload_type (&new_rtp, rtx_pt);
+  gst_rtp_buffer_set_timestamp (&new_rtp, gst_rtp_buffer_get_timestamp (&rtp));
+  gst_rtp_buffer_set_marker (&new_rtp, gst_rtp_buffer_get_marker (&rtp));
+  for (i = 0; i < csrc_count; i++)
+    gst_rtp_buffer_set_csrc (&new_rtp, i, gst_rtp_buffer_get_csrc (&rtp, i));
+
+  /* the original sequence number followed by the original payload */
+  payload = gst_rtp_buffer_get_payload (&new_rtp);
+  GST_WRITE_UINT16_BE (payload, gst_rtp_buffer_get_seq (&rtp));
+  memcpy (payload + 2, gst_rtp_buffer_get_payload (&rtp), payload_len);
+
+  gst_rtp_buffer_unmap (&new_rtp);
+  gst_rtp_buffer_unmap (&rtp);
+
+  gst_buffer_copy_into (new_buffer, buffer,
+      GST_BUFFER_COPY_FLAGS | GST_BUFFER_COPY_TIMESTAMPS, 0, -1);
+
+  return new_buffer;
+}
+
+static gboolean
+gst_rtp_rtx_send_src_event (GstPad * pad, GstObject * parent, GstEvent * event)
+{
+  GstRtpRtxSend *rtx = GST_RTP_RTX_SEND (parent);
+  const GstStructure *s;
+  SSRCRtxData *data;
+  BufferQueueItem *item;
+  guint seqnum = 0, ssrc = 0;
+  gpointer rtx_pt;
+  GstRTPBuffer rtp = GST_RTP_BUFFER_INIT;
+  GstBuffer *rtx_buf = NULL;
+  guint8 pt;
+
+  if (GST_EVENT_TYPE (event) != GST_EVENT_CUSTOM_UPSTREAM)
+    return gst_pad_event_default (pad, parent, event);
+
+  s = gst_event_get_structure (event);
+  if (!gst_structure_has_name (s, "GstRTPRetransmissionRequest"))
+    return gst_pad_event_default (pad, parent, event);
+
+  if (!gst_structure_get_uint (s, "seqnum", &seqnum) ||
+      !gst_structure_get_uint (s, "ssrc", &ssrc))
+    goto invalid_request;
+
+  GST_DEBUG_OBJECT (rtx, "request retransmission of #%u, ssrc %08x", seqnum,
+      ssrc);
+
+  GST_OBJECT_LOCK (rtx);
+  rtx->num_rtx_requests++;
+
+  data = g_hash_table_lookup (rtx->ssrc_data, GUINT_TO_POINTER (ssrc));
+  if (data == NULL || (item = g_hash_table_lookup (data->seqnums,
+              GUINT_TO_POINTER (seqnum))) == NULL) {
+    GST_DEBUG_OBJECT (rtx, "packet #%u is not in the history", seqnum);
+    GST_OBJECT_UNLOCK (rtx);
+    goto done;
+  }
+
+  gst_rtp_buffer_map (item->buffer, GST_MAP_READ, &rtp);
+  pt = gst_rtp_buffer_get_payload_type (&rtp);
+  gst_rtp_buffer_unmap (&rtp);
+
+  if (g_hash_table_lookup_extended (rtx->rtx_pt_map, GUINT_TO_POINTER (pt),
+          NULL, &rtx_pt)) {
+    rtx_buf = gst_rtp_rtx_buffer_new (rtx, item->buffer,
+        (guint8) GPOINTER_TO_UINT (rtx_pt), data);
+  }
+
+  /* the retransmission is late already, the src pad task pushes it right
+   * away, also when no new packets arrive. Pushing it from here could
+   * block the RTCP thread behind a blocked downstream. */
+  if (rtx_buf) {
+    if (rtx->flushing) {
+      gst_buffer_unref (rtx_buf);
+    } else {
+      rtx->num_rtx_packets++;
+      g_queue_push_tail (&rtx->pending, rtx_buf);
+      g_cond_signal (&rtx->pending_cond);
+    }
+  }
+  GST_OBJECT_UNLOCK (rtx);
+
+done:
+  gst_event_unref (event);
+  return TRUE;
+
+  /* ERRORS */
+invalid_request:
+  {
+    GST_WARNING_OBJECT (rtx, "invalid retransmission request %" GST_PTR_FORMAT,
+        s);
+    gst_event_unref (event);
+    return FALSE;
+  }
+}
+
+static GstFlowReturn
+gst_rtp_rtx_send_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
+{
+  GstRtpRtxSend *rtx = GST_RTP_RTX_SEND (parent);
+  GstRTPBuffer rtp = GST_RTP_BUFFER_INIT;
+  SSRCRtxData *data;
+  GstFlowReturn ret;
+  guint16 seqnum;
+  guint8 pt;
+  guint32 ssrc;
+
+  if (G_UNLIKELY (!gst_rtp_buffer_map (buffer, GST_MAP_READ, &rtp)))
+    goto invalid_buffer;
+
+  seqnum = gst_rtp_buffer_get_seq (&rtp);
+  pt = gst_rtp_buffer_get_payload_type (&rtp);
+  ssrc = gst_rtp_buffer_get_ssrc (&rtp);
+  gst_rtp_buffer_unmap (&rtp);
+
+  GST_OBJECT_LOCK (rtx);
+  /* only keep the packets we are able to retransmit */
+  if (g_hash_table_lookup_extended (rtx->rtx_pt_map, GUINT_TO_POINTER (pt),
+          NULL, NULL)) {
+    data = g_hash_table_lookup (rtx->ssrc_data, GUINT_TO_POINTER (ssrc));
+    if (data == NULL) {
+      data = ssrc_rtx_data_new (choose_ssrc (rtx, ssrc));
+      g_hash_table_insert (rtx->ssrc_data, GUINT_TO_POINTER (ssrc), data);
+    }
+
+    ssrc_rtx_data_push (data, seqnum, buffer, rtx->max_size_packets);
+  }
+  GST_OBJECT_UNLOCK (rtx);
+
+  g_mutex_lock (&rtx->push_lock);
+  ret = gst_pad_push (rtx->srcpad, buffer);
+  g_mutex_unlock (&rtx->push_lock);
+
+  return ret;
+
+  /* ERRORS */
+invalid_buffer:
+  {
+    GST_ELEMENT_WARNING (rtx, STREAM, DECODE, (NULL),
+        ("Received invalid RTP payload, dropping"));
+    gst_buffer_unref (buffer);
+    return GST_FLOW_OK;
+  }
+}
+
+/* pushes the retransmission packets queued by the src event handler */
+static void
+gst_rtp_rtx_send_src_loop (GstRtpRtxSend * rtx)
+{
+  GstBuffer *buffer;
+
+  GST_OBJECT_LOCK (rtx);
+  while (!rtx->flushing && g_queue_is_empty (&rtx->pending))
+    g_cond_wait (&rtx->pending_cond, GST_OBJECT_GET_LOCK (rtx));
+  if (rtx->flushing)
+    goto flushing;
+  buffer = g_queue_pop_head (&rtx->pending);
+  GST_OBJECT_UNLOCK (rtx);
+
+  GST_LOG_OBJECT (rtx, "pushing retransmission %" GST_PTR_FORMAT, buffer);
+
+  g_mutex_lock (&rtx->push_lock);
+  gst_pad_push (rtx->srcpad, buffer);
+  g_mutex_unlock (&rtx->push_lock);
+  return;
+
+flushing:
+  {
+    GST_DEBUG_OBJECT (rtx, "we are flushing");
+    GST_OBJECT_UNLOCK (rtx);
+    gst_pad_pause_task (rtx->srcpad);
+    return;
+  }
+}
+
+static gboolean
+gst_rtp_rtx_send_src_activate_mode (GstPad * pad, GstObject * parent,
+    GstPadMode mode, gboolean active)
+{
+  GstRtpRtxSend *rtx = GST_RTP_RTX_SEND (parent);
+  gboolean result;
+
+  switch (mode) {
+    case GST_PAD_MODE_PUSH:
+      GST_OBJECT_LOCK (rtx);
+      rtx->flushing = !active;
+      if (!active) {
+        g_queue_foreach (&rtx->pending, (GFunc) gst_buffer_unref, NULL);
+        g_queue_clear (&rtx->pending);
+        g_cond_signal (&rtx->pending_cond);
+      }
+      GST_OBJECT_UNLOCK (rtx);
+
+      if (active) {
+        result = gst_pad_start_task (pad,
+            (GstTaskFunction) gst_rtp_rtx_send_src_loop, rtx, NULL);
+      } else {
+        result = gst_pad_stop_task (pad);
+      }
+      break;
+    default:
+      result = FALSE;
+      break;
+  }
+  return result;
+}
+
+static gboolean
+structure_to_hash_table (GQuark field_id, const GValue * value,
+    gpointer hash)
+{
+  const gchar *field_str;
+  guint field_uint;
+  guint value_uint;
+
+  if (!G_VALUE_HOLDS_UINT (value))
+    return TRUE;
+
+  field_str = g_quark_to_string (field_id);
+  field_uint = atoi (field_str);
+  value_uint = g_value_get_uint (value);
+  g_hash_table_insert ((GHashTable *) hash, GUINT_TO_POINTER (field_uint),
+      GUINT_TO_POINTER (value_uint));
+
+  return TRUE;
+}
+
+static void
+gst_rtp_rtx_send_set_property (GObject * object,
+    guint prop_id, const GValue * value, GParamSpec * pspec)
+{
+  GstRtpRtxSend *rtx = GST_RTP_RTX_SEND (object);
+
+  switch (prop_id) {
+    case PROP_PAYLOAD_TYPE_MAP:
+      GST_OBJECT_LOCK (rtx);
+      if (rtx->pt_map_structure)
+        gst_structure_free (rtx->pt_map_structure);
+      rtx->pt_map_structure = g_value_dup_boxed (value);
+      g_hash_table_remove_all (rtx->rtx_pt_map);
+      if (rtx->pt_map_structure)
+        gst_structure_foreach (rtx->pt_map_structure, structure_to_hash_table,
+            rtx->rtx_pt_map);
+      GST_OBJECT_UNLOCK (rtx);
+      break;
+    case PROP_MAX_SIZE_PACKETS:
+      GST_OBJECT_LOCK (rtx);
+      rtx->max_size_packets = g_value_get_uint (value);
+      GST_OBJECT_UNLOCK (rtx);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
+static void
+gst_rtp_rtx_send_get_property (GObject * object,
+    guint prop_id, GValue * value, GParamSpec * pspec)
+{
+  GstRtpRtxSend *rtx = GST_RTP_RTX_SEND (object);
+
+  switch (prop_id) {
+    case PROP_PAYLOAD_TYPE_MAP:
+      GST_OBJECT_LOCK (rtx);
+      g_value_set_boxed (value, rtx->pt_map_structure);
+      GST_OBJECT_UNLOCK (rtx);
+      break;
+    case PROP_MAX_SIZE_PACKETS:
+      GST_OBJECT_LOCK (rtx);
+      g_value_set_uint (value, rtx->max_size_packets);
+      GST_OBJECT_UNLOCK (rtx);
+      break;
+    case PROP_NUM_RTX_REQUESTS:
+      GST_OBJECT_LOCK (rtx);
+      g_value_set_uint (value, rtx->num_rtx_requests);
+      GST_OBJECT_UNLOCK (rtx);
+      break;
+    case PROP_NUM_RTX_PACKETS:
+      GST_OBJECT_LOCK (rtx);
+      g_value_set_uint (value, rtx->num_rtx_packets);
+      GST_OBJECT_UNLOCK (rtx);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
+static GstStateChangeReturn
+gst_rtp_rtx_send_change_state (GstElement * element, GstStateChange transition)
+{
+  GstRtpRtxSend *rtx = GST_RTP_RTX_SEND (element);
+  GstStateChangeReturn ret;
+
+  ret =
+      GST_ELEMENT_CLASS (gst_rtp_rtx_send_parent_class)->change_state (element,
+      transition);
+
+  switch (transition) {
+    case GST_STATE_CHANGE_PAUSED_TO_READY:
+      gst_rtp_rtx_send_reset (rtx);
+      break;
+    default:
+      break;
+  }
+
+  return ret;
+}
@@ -0,0 +1,76 @@
+/* RTP Retransmission sender element for GStreamer
+ *
+ * gstrtprtxsend.h:
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#ifndef __GST_RTP_RTX_SEND_H__
+#define __GST_RTP_RTX_SEND_H__
+
+#include <gst/gst.h>
+
+G_BEGIN_DECLS
+
+#define GST_TYPE_RTP_RTX_SEND (gst_rtp_rtx_send_get_type())
+#define GST_RTP_RTX_SEND(obj) (G_TYPE_CHECK_INSTANCE_CAST((obj),GST_TYPE_RTP_RTX_SEND,GstRtpRtxSend))
+#define GST_RTP_RTX_SEND_CLASS(klass) (G_TYPE_CHECK_CLASS_CAST((klass),GST_TYPE_RTP_RTX_SEND,GstRtpRtxSendClass))
+#define GST_IS_RTP_RTX_SEND(obj) (G_TYPE_CHECK_INSTANCE_TYPE((obj),GST_TYPE_RTP_RTX_SEND))
+#define GST_IS_RTP_RTX_SEND_CLASS(klass) (G_TYPE_CHECK_CLASS_TYPE((klass),GST_TYPE_RTP_RTX_SEND))
+
+typedef struct _GstRtpRtxSend GstRtpRtxSend;
+typedef struct _GstRtpRtxSendClass GstRtpRtxSendClass;
+
+struct _GstRtpRtxSend
+{
+  GstElement element;
+
+  /* pad */
+  GstPad *sinkpad;
+  GstPad *srcpad;
+
+  /* master ssrc -> SSRCRtxData with the history of sent packets */
+  GHashTable *ssrc_data;
+  /* master pt -> rtx pt */
+  GHashTable *rtx_pt_map;
+  GstStructure *pt_map_structure;
+
+  guint max_size_packets;
+
+  /* retransmission packets waiting to be pushed by the src pad task,
+   * protected by OBJECT_LOCK */
+  GQueue pending;
+  GCond pending_cond;
+  gboolean flushing;
+
+  /* serializes the pushes of the chain function and of the task */
+  GMutex push_lock;
+
+  /* statistics */
+  guint num_rtx_requests;
+  guint num_rtx_packets;
+};
+
+struct _GstRtpRtxSendClass
+{
+  GstElementClass parent_class;
+};
+
+GType gst_rtp_rtx_send_get_type (void);
+
+G_END_DECLS
+
+#endif /* __GST_RTP_RTX_SEND_H__ */
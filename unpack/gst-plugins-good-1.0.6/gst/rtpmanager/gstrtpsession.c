@@ -189,6 +189,7 @@ enum
   SIGNAL_ON_BYE_TIMEOUT,
   SIGNAL_ON_TIMEOUT,
   SIGNAL_ON_SENDER_TIMEOUT,
+  SIGNAL_ON_TARGET_BITRATE,
   LAST_SIGNAL
 };
 
@@ -202,6 +203,7 @@ enum
 #define DEFAULT_USE_PIPELINE_CLOCK   FALSE
 #define DEFAULT_RTCP_MIN_INTERVAL    (RTP_STATS_MIN_INTERVAL * GST_SECOND)
 #define DEFAULT_PROBATION            RTP_DEFAULT_PROBATION
+#define DEFAULT_BANDWIDTH_ESTIMATION RTP_BWE_MODE_NONE
 
 enum
 {
@@ -217,6 +219,8 @@ enum
   PROP_USE_PIPELINE_CLOCK,
   PROP_RTCP_MIN_INTERVAL,
   PROP_PROBATION,
+  PROP_BANDWIDTH_ESTIMATION,
+  PROP_TARGET_BITRATE,
   PROP_LAST
 };
 
@@ -261,6 +265,8 @@ static void gst_rtp_session_request_key_unit (RTPSession * sess,
     gboolean all_headers, gpointer user_data);
 static GstClockTime gst_rtp_session_request_time (RTPSession * session,
     gpointer user_data);
+static void gst_rtp_session_notify_nack (RTPSession * sess,
+    guint16 seqnum, guint16 blp, guint32 ssrc, gpointer user_data);
 
 static RTPSessionCallbacks callbacks = {
   gst_rtp_session_process_rtp,
@@ -270,7 +276,8 @@ static RTPSessionCallbacks callbacks = {
   gst_rtp_session_clock_rate,
   gst_rtp_session_reconsider,
   gst_rtp_session_request_key_unit,
-  gst_rtp_session_request_time
+  gst_rtp_session_request_time,
+  gst_rtp_session_notify_nack
 };
 
 /* GObject vmethods */
@@ -370,6 +377,13 @@ on_sender_timeout (RTPSession * session, RTPSource * src, GstRtpSession * sess)
       src->ssrc);
 }
 
+static void
+on_target_bitrate (RTPSession * session, guint bitrate, GstRtpSession * sess)
+{
+  g_signal_emit (sess, gst_rtp_session_signals[SIGNAL_ON_TARGET_BITRATE], 0,
+      rtp_session_get_internal_ssrc (session), bitrate);
+}
+
 #define gst_rtp_session_parent_class parent_class
 G_DEFINE_TYPE (GstRtpSession, gst_rtp_session, GST_TYPE_ELEMENT);
 
@@ -515,6 +529,20 @@ gst_rtp_session_class_init (GstRtpSessionClass * klass)
       G_SIGNAL_RUN_LAST, G_STRUCT_OFFSET (GstRtpSessionClass,
           on_sender_timeout), NULL, NULL, g_cclosure_marshal_VOID__UINT,
       G_TYPE_NONE, 1, G_TYPE_UINT);
+  /**
+   * GstRtpSession::on-target-bitrate:
+   * @sess: the object which received the signal
+   * @ssrc: the SSRC of our stream
+   * @bitrate: the target bitrate in bits per second
+   *
+   * Notify that the bandwidth estimation changed the target bitrate of our
+   * stream. Encoders can use this to adapt their bitrate.
+   */
+  gst_rtp_session_signals[SIGNAL_ON_TARGET_BITRATE] =
+      g_signal_new ("on-target-bitrate", G_TYPE_FROM_CLASS (klass),
+      G_SIGNAL_RUN_LAST, G_STRUCT_OFFSET (GstRtpSessionClass,
+          on_target_bitrate), NULL, NULL, gst_rtp_bin_marshal_VOID__UINT_UINT,
+      G_TYPE_NONE, 2, G_TYPE_UINT, G_TYPE_UINT);
 
   g_object_class_install_property (gobject_class, PROP_BANDWIDTH,
       g_param_spec_double ("bandwidth", "Bandwidth",
@@ -580,6 +608,18 @@ gst_rtp_session_class_init (GstRtpSessionClass * klass)
           0, G_MAXUINT, DEFAULT_PROBATION,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  g_object_class_install_property (gobject_class, PROP_BANDWIDTH_ESTIMATION,
+      g_param_spec_enum ("bandwidth-estimation", "Bandwidth Estimation",
+          "Estimate the target bitrate of our stream from the receiver reports",
+          RTP_TYPE_BWE_MODE, DEFAULT_BANDWIDTH_ESTIMATION,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  g_object_class_install_property (gobject_class, PROP_TARGET_BITRATE,
+      g_param_spec_uint ("target-bitrate", "Target Bitrate",
+          "The estimated target bitrate of our stream (in bits/s)", 0,
+          G_MAXUINT, RTP_BWE_DEFAULT_START_BITRATE,
+          G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+
   gstelement_class->change_state =
       GST_DEBUG_FUNCPTR (gst_rtp_session_change_state);
   gstelement_class->request_new_pad =
@@ -645,6 +685,8 @@ gst_rtp_session_init (GstRtpSession * rtpsession)
       (GCallback) on_timeout, rtpsession);
   g_signal_connect (rtpsession->priv->session, "on-sender-timeout",
       (GCallback) on_sender_timeout, rtpsession);
+  g_signal_connect (rtpsession->priv->session, "on-target-bitrate",
+      (GCallback) on_target_bitrate, rtpsession);
   rtpsession->priv->ptmap = g_hash_table_new_full (NULL, NULL, NULL,
       (GDestroyNotify) gst_caps_unref);
 
@@ -707,6 +749,10 @@ gst_rtp_session_set_property (GObject * object, guint prop_id,
     case PROP_PROBATION:
       g_object_set_property (G_OBJECT (priv->session), "probation", value);
       break;
+    case PROP_BANDWIDTH_ESTIMATION:
+      g_object_set_property (G_OBJECT (priv->session), "bandwidth-estimation",
+          value);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -761,6 +807,14 @@ gst_rtp_session_get_property (GObject * object, guint prop_id,
     case PROP_PROBATION:
       g_object_get_property (G_OBJECT (priv->session), "probation", value);
       break;
+    case PROP_BANDWIDTH_ESTIMATION:
+      g_object_get_property (G_OBJECT (priv->session), "bandwidth-estimation",
+          value);
+      break;
+    case PROP_TARGET_BITRATE:
+      g_object_get_property (G_OBJECT (priv->session), "target-bitrate",
+          value);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -1428,6 +1482,29 @@ gst_rtp_session_event_recv_rtp_src (GstPad * pad, GstObject * parent,
         if (gst_rtp_session_request_remote_key_unit (rtpsession, ssrc, pt,
                 all_headers, count))
           forward = FALSE;
+      } else if (gst_structure_has_name (s, "GstRTPRetransmissionRequest")) {
+        guint seqnum, delay, deadline, max_delay;
+
+        if (!gst_structure_get_uint (s, "ssrc", &ssrc))
+          ssrc = -1;
+        if (!gst_structure_get_uint (s, "seqnum", &seqnum))
+          seqnum = -1;
+        if (!gst_structure_get_uint (s, "delay", &delay))
+          delay = 0;
+        if (!gst_structure_get_uint (s, "deadline", &deadline))
+          deadline = 100;
+
+        /* remaining time to receive the packet */
+        max_delay = deadline;
+        if (max_delay > delay)
+          max_delay -= delay;
+        else
+          max_delay = 0;
+
+        if (rtp_session_request_nack (rtpsession->priv->session, ssrc, seqnum,
+                gst_clock_get_time (rtpsession->priv->sysclock),
+                max_delay * GST_MSECOND))
+          forward = FALSE;
       }
       break;
     default:
@@ -1436,6 +1513,8 @@ gst_rtp_session_event_recv_rtp_src (GstPad * pad, GstObject * parent,
 
   if (forward)
     ret = gst_pad_push_event (rtpsession->recv_rtp_sink, event);
+  else
+    gst_event_unref (event);
 
   return ret;
 }
@@ -2191,3 +2270,41 @@ gst_rtp_session_request_time (RTPSession * session, gpointer user_data)
 
   return gst_clock_get_time (rtpsession->priv->sysclock);
 }
+
+static void
+gst_rtp_session_notify_nack (RTPSession * sess, guint16 seqnum,
+    guint16 blp, guint32 ssrc, gpointer user_data)
+{
+  GstRtpSession *rtpsession = GST_RTP_SESSION (user_data);
+  GstEvent *event;
+  GstPad *send_rtp_sink;
+
+  GST_RTP_SESSION_LOCK (rtpsession);
+  if ((send_rtp_sink = rtpsession->send_rtp_sink))
+    gst_object_ref (send_rtp_sink);
+  GST_RTP_SESSION_UNLOCK (rtpsession);
+
+  if (send_rtp_sink == NULL)
+    return;
+
+  /* ask upstream (usually rtprtxsend) to retransmit the packet and every
+   * packet flagged in the bitmask of lost packets */
+  while (TRUE) {
+    event = gst_event_new_custom (GST_EVENT_CUSTOM_UPSTREAM,
+        gst_structure_new ("GstRTPRetransmissionRequest",
+            "seqnum", G_TYPE_UINT, (guint) seqnum,
+            "ssrc", G_TYPE_UINT, (guint) ssrc, NULL));
+    gst_pad_push_event (send_rtp_sink, event);
+
+    if (blp == 0)
+      break;
+
+    seqnum++;
+    while ((blp & 1) == 0) {
+      seqnum++;
+      blp >>= 1;
+    }
+    blp >>= 1;
+  }
+  gst_object_unref (send_rtp_sink);
+}
@@ -72,6 +72,7 @@ struct _GstRtpSessionClass {
   void     (*on_bye_timeout)    (GstRtpSession *sess, guint32 ssrc);
   void     (*on_timeout)        (GstRtpSession *sess, guint32 ssrc);
   void     (*on_sender_timeout) (GstRtpSession *sess, guint32 ssrc);
+  void     (*on_target_bitrate) (GstRtpSession *sess, guint32 ssrc, guint bitrate);
 };
 
 GType gst_rtp_session_get_type (void);
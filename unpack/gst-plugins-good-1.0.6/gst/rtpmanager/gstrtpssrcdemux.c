@@ -118,6 +118,8 @@ static void gst_rtp_ssrc_demux_clear_ssrc (GstRtpSsrcDemux * demux,
 /* sinkpad stuff */
 static GstFlowReturn gst_rtp_ssrc_demux_chain (GstPad * pad, GstObject * parent,
     GstBuffer * buf);
+static GstFlowReturn gst_rtp_ssrc_demux_chain_list (GstPad * pad,
+    GstObject * parent, GstBufferList * list);
 static gboolean gst_rtp_ssrc_demux_sink_event (GstPad * pad, GstObject * parent,
     GstEvent * event);
 
@@ -149,20 +151,13 @@ struct _GstRtpSsrcDemuxPad
   GstPad *rtcp_pad;
 };
 
-/* find a src pad for a given SSRC, returns NULL if the SSRC was not found
+/* find a src pad for a given SSRC, returns NULL if the SSRC was not found.
+ * Must be called with the padlock
  */
 static GstRtpSsrcDemuxPad *
 find_demux_pad_for_ssrc (GstRtpSsrcDemux * demux, guint32 ssrc)
 {
-  GSList *walk;
-
-  for (walk = demux->srcpads; walk; walk = g_slist_next (walk)) {
-    GstRtpSsrcDemuxPad *pad = (GstRtpSsrcDemuxPad *) walk->data;
-
-    if (pad->ssrc == ssrc)
-      return pad;
-  }
-  return NULL;
+  return g_hash_table_lookup (demux->ssrc_pads, GUINT_TO_POINTER (ssrc));
 }
 
 static GstEvent *
@@ -271,6 +266,7 @@ find_or_create_demux_pad_for_ssrc (GstRtpSsrcDemux * demux, guint32 ssrc,
   gst_pad_set_element_private (rtcp_pad, demuxpad);
 
   demux->srcpads = g_slist_prepend (demux->srcpads, demuxpad);
+  g_hash_table_insert (demux->ssrc_pads, GUINT_TO_POINTER (ssrc), demuxpad);
 
   gst_pad_set_query_function (rtp_pad, gst_rtp_ssrc_demux_src_query);
   gst_pad_set_iterate_internal_links_function (rtp_pad,
@@ -426,6 +422,8 @@ gst_rtp_ssrc_demux_init (GstRtpSsrcDemux * demux)
       gst_pad_new_from_template (gst_element_class_get_pad_template (klass,
           "sink"), "sink");
   gst_pad_set_chain_function (demux->rtp_sink, gst_rtp_ssrc_demux_chain);
+  gst_pad_set_chain_list_function (demux->rtp_sink,
+      gst_rtp_ssrc_demux_chain_list);
   gst_pad_set_event_function (demux->rtp_sink, gst_rtp_ssrc_demux_sink_event);
   gst_pad_set_iterate_internal_links_function (demux->rtp_sink,
       gst_rtp_ssrc_demux_iterate_internal_links_sink);
@@ -442,6 +440,7 @@ gst_rtp_ssrc_demux_init (GstRtpSsrcDemux * demux)
   gst_element_add_pad (GST_ELEMENT_CAST (demux), demux->rtcp_sink);
 
   g_rec_mutex_init (&demux->padlock);
+  demux->ssrc_pads = g_hash_table_new (NULL, NULL);
 
   gst_segment_init (&demux->segment, GST_FORMAT_UNDEFINED);
 }
@@ -454,6 +453,8 @@ gst_rtp_ssrc_demux_reset (GstRtpSsrcDemux * demux)
   for (walk = demux->srcpads; walk; walk = g_slist_next (walk)) {
     GstRtpSsrcDemuxPad *dpad = (GstRtpSsrcDemuxPad *) walk->data;
 
+    gst_pad_set_element_private (dpad->rtp_pad, NULL);
+    gst_pad_set_element_private (dpad->rtcp_pad, NULL);
     gst_pad_set_active (dpad->rtp_pad, FALSE);
     gst_pad_set_active (dpad->rtcp_pad, FALSE);
 
@@ -463,6 +464,7 @@ gst_rtp_ssrc_demux_reset (GstRtpSsrcDemux * demux)
   }
   g_slist_free (demux->srcpads);
   demux->srcpads = NULL;
+  g_hash_table_remove_all (demux->ssrc_pads);
 }
 
 static void
@@ -483,6 +485,7 @@ gst_rtp_ssrc_demux_finalize (GObject * object)
   GstRtpSsrcDemux *demux;
 
   demux = GST_RTP_SSRC_DEMUX (object);
+  g_hash_table_destroy (demux->ssrc_pads);
   g_rec_mutex_clear (&demux->padlock);
 
   G_OBJECT_CLASS (parent_class)->finalize (object);
@@ -503,6 +506,9 @@ gst_rtp_ssrc_demux_clear_ssrc (GstRtpSsrcDemux * demux, guint32 ssrc)
   GST_DEBUG_OBJECT (demux, "clearing pad for SSRC %08x", ssrc);
 
   demux->srcpads = g_slist_remove (demux->srcpads, dpad);
+  g_hash_table_remove (demux->ssrc_pads, GUINT_TO_POINTER (ssrc));
+  gst_pad_set_element_private (dpad->rtp_pad, NULL);
+  gst_pad_set_element_private (dpad->rtcp_pad, NULL);
   GST_PAD_UNLOCK (demux);
 
   gst_pad_set_active (dpad->rtp_pad, FALSE);
@@ -666,6 +672,122 @@ create_failed:
   }
 }
 
+typedef struct
+{
+  guint32 ssrc;
+  GstPad *pad;
+  GstBufferList *list;
+} SsrcDemuxOutput;
+
+/* splits the list in one list per SSRC, keeping the order of the packets of
+ * each SSRC, and pushes them on their pads */
+static GstFlowReturn
+gst_rtp_ssrc_demux_chain_list (GstPad * pad, GstObject * parent,
+    GstBufferList * list)
+{
+  GstFlowReturn ret = GST_FLOW_OK, res;
+  GstRtpSsrcDemux *demux;
+  GArray *outputs;
+  GHashTable *index;
+  SsrcDemuxOutput *out;
+  guint i, len, last = 0, n_not_linked = 0;
+
+  demux = GST_RTP_SSRC_DEMUX (parent);
+
+  len = gst_buffer_list_length (list);
+  outputs = g_array_new (FALSE, FALSE, sizeof (SsrcDemuxOutput));
+  /* SSRC -> index in outputs + 1 */
+  index = g_hash_table_new (NULL, NULL);
+
+  for (i = 0; i < len; i++) {
+    GstBuffer *buf = gst_buffer_list_get (list, i);
+    GstRTPBuffer rtp = { NULL };
+    guint32 ssrc;
+
+    if (!gst_rtp_buffer_map (buf, GST_MAP_READ, &rtp))
+      goto invalid_payload;
+
+    ssrc = gst_rtp_buffer_get_ssrc (&rtp);
+    gst_rtp_buffer_unmap (&rtp);
+
+    /* packets mostly come in runs of the same SSRC */
+    if (last == 0 ||
+        g_array_index (outputs, SsrcDemuxOutput, last - 1).ssrc != ssrc) {
+      last = GPOINTER_TO_UINT (g_hash_table_lookup (index,
+              GUINT_TO_POINTER (ssrc)));
+      if (last == 0) {
+        SsrcDemuxOutput new_out;
+
+        GST_DEBUG_OBJECT (demux, "received list packets of SSRC %08x", ssrc);
+
+        new_out.ssrc = ssrc;
+        new_out.pad = find_or_create_demux_pad_for_ssrc (demux, ssrc, RTP_PAD);
+        if (new_out.pad == NULL)
+          goto create_failed;
+        new_out.list = gst_buffer_list_new ();
+
+        g_array_append_val (outputs, new_out);
+        last = outputs->len;
+        g_hash_table_insert (index, GUINT_TO_POINTER (ssrc),
+            GUINT_TO_POINTER (last));
+      }
+    }
+    out = &g_array_index (outputs, SsrcDemuxOutput, last - 1);
+    gst_buffer_list_add (out->list, gst_buffer_ref (buf));
+  }
+  gst_buffer_list_unref (list);
+  g_hash_table_destroy (index);
+
+  /* the SSRCs are independent, one of them not linked or flushing does not
+   * stop the others */
+  for (i = 0; i < outputs->len; i++) {
+    out = &g_array_index (outputs, SsrcDemuxOutput, i);
+
+    GST_LOG_OBJECT (demux, "pushing %u packets of SSRC %08x",
+        gst_buffer_list_length (out->list), out->ssrc);
+    res = gst_pad_push_list (out->pad, out->list);
+    gst_object_unref (out->pad);
+
+    if (res == GST_FLOW_NOT_LINKED)
+      n_not_linked++;
+    else if (ret == GST_FLOW_OK)
+      ret = res;
+  }
+  if (outputs->len > 0 && n_not_linked == outputs->len)
+    ret = GST_FLOW_NOT_LINKED;
+
+  g_array_free (outputs, TRUE);
+
+  return ret;
+
+  /* ERRORS */
+invalid_payload:
+  {
+    /* this is fatal and should be filtered earlier */
+    GST_ELEMENT_ERROR (demux, STREAM, DECODE, (NULL),
+        ("Dropping invalid RTP payload"));
+    goto error;
+  }
+create_failed:
+  {
+    GST_ELEMENT_ERROR (demux, STREAM, DECODE, (NULL),
+        ("Could not create new pad"));
+    goto error;
+  }
+error:
+  {
+    for (i = 0; i < outputs->len; i++) {
+      out = &g_array_index (outputs, SsrcDemuxOutput, i);
+      gst_buffer_list_unref (out->list);
+      gst_object_unref (out->pad);
+    }
+    g_array_free (outputs, TRUE);
+    g_hash_table_destroy (index);
+    gst_buffer_list_unref (list);
+    return GST_FLOW_ERROR;
+  }
+}
+
 static GstFlowReturn
 gst_rtp_ssrc_demux_rtcp_chain (GstPad * pad, GstObject * parent,
     GstBuffer * buf)
@@ -737,19 +859,19 @@ create_failed:
   }
 }
 
+/* Must be called with the padlock */
 static GstRtpSsrcDemuxPad *
 find_demux_pad_for_pad (GstRtpSsrcDemux * demux, GstPad * pad)
 {
-  GSList *walk;
+  GstRtpSsrcDemuxPad *dpad;
 
-  for (walk = demux->srcpads; walk; walk = g_slist_next (walk)) {
-    GstRtpSsrcDemuxPad *dpad = (GstRtpSsrcDemuxPad *) walk->data;
-    if (dpad->rtp_pad == pad || dpad->rtcp_pad == pad) {
-      return dpad;
-    }
-  }
+  dpad = gst_pad_get_element_private (pad);
+
+  /* the pad can have been removed */
+  if (dpad == NULL || find_demux_pad_for_ssrc (demux, dpad->ssrc) != dpad)
+    return NULL;
 
-  return NULL;
+  return dpad;
 }
 
 
@@ -768,8 +890,10 @@ gst_rtp_ssrc_demux_src_event (GstPad * pad, GstObject * parent,
     case GST_EVENT_CUSTOM_BOTH_OOB:
       s = gst_event_get_structure (event);
       if (s && !gst_structure_has_field (s, "ssrc")) {
-        GstRtpSsrcDemuxPad *dpad = find_demux_pad_for_pad (demux, pad);
+        GstRtpSsrcDemuxPad *dpad;
 
+        GST_PAD_LOCK (demux);
+        dpad = find_demux_pad_for_pad (demux, pad);
         if (dpad) {
           GstStructure *ws;
 
@@ -777,6 +901,7 @@ gst_rtp_ssrc_demux_src_event (GstPad * pad, GstObject * parent,
           ws = gst_event_writable_structure (event);
           gst_structure_set (ws, "ssrc", G_TYPE_UINT, dpad->ssrc, NULL);
         }
+        GST_PAD_UNLOCK (demux);
       }
       break;
     default:
@@ -792,21 +917,17 @@ gst_rtp_ssrc_demux_iterate_internal_links_src (GstPad * pad, GstObject * parent)
   GstRtpSsrcDemux *demux;
   GstPad *otherpad = NULL;
   GstIterator *it = NULL;
-  GSList *current;
+  GstRtpSsrcDemuxPad *dpad;
 
   demux = GST_RTP_SSRC_DEMUX (parent);
 
   GST_PAD_LOCK (demux);
-  for (current = demux->srcpads; current; current = g_slist_next (current)) {
-    GstRtpSsrcDemuxPad *dpad = (GstRtpSsrcDemuxPad *) current->data;
-
-    if (pad == dpad->rtp_pad) {
+  dpad = find_demux_pad_for_pad (demux, pad);
+  if (dpad) {
+    if (pad == dpad->rtp_pad)
       otherpad = demux->rtp_sink;
-      break;
-    } else if (pad == dpad->rtcp_pad) {
+    else if (pad == dpad->rtcp_pad)
       otherpad = demux->rtcp_sink;
-      break;
-    }
   }
   if (otherpad) {
     GValue val = { 0, };
@@ -880,14 +1001,15 @@ gst_rtp_ssrc_demux_src_query (GstPad * pad, GstObject * parent,
         GstClockTime min_latency, max_latency;
         GstRtpSsrcDemuxPad *demuxpad;
 
-        demuxpad = gst_pad_get_element_private (pad);
-
         gst_query_parse_latency (query, &live, &min_latency, &max_latency);
 
         GST_DEBUG_OBJECT (demux, "peer min latency %" GST_TIME_FORMAT,
             GST_TIME_ARGS (min_latency));
 
-        GST_DEBUG_OBJECT (demux, "latency for SSRC %08x", demuxpad->ssrc);
+        GST_PAD_LOCK (demux);
+        if ((demuxpad = find_demux_pad_for_pad (demux, pad)))
+          GST_DEBUG_OBJECT (demux, "latency for SSRC %08x", demuxpad->ssrc);
+        GST_PAD_UNLOCK (demux);
 
         gst_query_set_latency (query, live, min_latency, max_latency);
       }
@@ -43,6 +43,8 @@ struct _GstRtpSsrcDemux
 
   GRecMutex padlock;
   GSList *srcpads;
+  /* SSRC -> GstRtpSsrcDemuxPad */
+  GHashTable *ssrc_pads;
 };
 
 struct _GstRtpSsrcDemuxClass
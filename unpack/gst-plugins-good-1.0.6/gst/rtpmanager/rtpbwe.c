@@ -0,0 +1,224 @@
+/* GStreamer
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#include "rtpbwe.h"
+
+GST_DEBUG_CATEGORY_STATIC (rtp_bwe_debug);
+#define GST_CAT_DEFAULT rtp_bwe_debug
+
+/* below this loss the bitrate is increased, above the high mark it is
+ * decreased in proportion to the loss, in between it is kept */
+#define LOSS_LOW              0.02
+#define LOSS_HIGH             0.10
+
+#define INCREASE_FACTOR       1.05
+#define INCREASE_STEP         1000
+#define DELAY_DECREASE_FACTOR 0.85
+
+/* don't go too far above the bitrate that is actually sent */
+#define SEND_BITRATE_HEADROOM 1.5
+
+/* queuing delay on top of the lowest round trip time that we consider as
+ * congestion */
+#define QUEUE_DELAY_THRESHOLD (50 * GST_MSECOND)
+/* the lowest round trip time is taken over two periods of this length, so
+ * that a longer path after a route change becomes the new minimum */
+#define MIN_RTT_PERIOD        (30 * GST_SECOND)
+/* jitter above this that doubles the average is considered as congestion */
+#define JITTER_THRESHOLD      (30 * GST_MSECOND)
+
+GType
+rtp_bwe_mode_get_type (void)
+{
+  static GType bwe_mode_type = 0;
+  static const GEnumValue bwe_modes[] = {
+    {RTP_BWE_MODE_NONE, "No bandwidth estimation", "none"},
+    {RTP_BWE_MODE_LOSS, "Loss based", "loss"},
+    {RTP_BWE_MODE_LOSS_DELAY, "Loss and delay based", "loss-delay"},
+    {0, NULL, NULL},
+  };
+
+  if (!bwe_mode_type) {
+    bwe_mode_type = g_enum_register_static ("RTPBweMode", bwe_modes);
+  }
+  return bwe_mode_type;
+}
+
+/**
+ * rtp_bwe_init:
+ * @bwe: an #RTPBandwidthEstimator
+ * @mode: the estimation mode
+ * @start_bitrate: the initial target bitrate
+ * @min_bitrate: the lowest target bitrate
+ * @max_bitrate: the highest target bitrate
+ *
+ * Initialize @bwe.
+ */
+void
+rtp_bwe_init (RTPBandwidthEstimator * bwe, RTPBweMode mode,
+    guint start_bitrate, guint min_bitrate, guint max_bitrate)
+{
+  static gsize init = 0;
+
+  if (g_once_init_enter (&init)) {
+    GST_DEBUG_CATEGORY_INIT (rtp_bwe_debug, "rtpbwe", 0,
+        "RTP bandwidth estimation");
+    g_once_init_leave (&init, 1);
+  }
+
+  bwe->mode = mode;
+  bwe->min_bitrate = min_bitrate;
+  bwe->max_bitrate = MAX (min_bitrate, max_bitrate);
+  bwe->bitrate = CLAMP (start_bitrate, bwe->min_bitrate, bwe->max_bitrate);
+  bwe->have_report = FALSE;
+  bwe->rtt = GST_CLOCK_TIME_NONE;
+  bwe->min_rtt = GST_CLOCK_TIME_NONE;
+  bwe->cur_min_rtt = GST_CLOCK_TIME_NONE;
+  bwe->prev_min_rtt = GST_CLOCK_TIME_NONE;
+  bwe->min_rtt_start = GST_CLOCK_TIME_NONE;
+  bwe->jitter = GST_CLOCK_TIME_NONE;
+  bwe->loss = 0.0;
+  bwe->last_decrease = GST_CLOCK_TIME_NONE;
+}
+
+/* keep the minimum of the round trip times of the current and the previous
+ * period, older ones are forgotten */
+static void
+update_min_rtt (RTPBandwidthEstimator * bwe, GstClockTime current_time,
+    GstClockTime rtt)
+{
+  if (!GST_CLOCK_TIME_IS_VALID (bwe->min_rtt_start) ||
+      current_time >= bwe->min_rtt_start + MIN_RTT_PERIOD) {
+    /* no report for a whole period leaves nothing from the previous one */
+    if (GST_CLOCK_TIME_IS_VALID (bwe->min_rtt_start) &&
+        current_time < bwe->min_rtt_start + 2 * MIN_RTT_PERIOD)
+      bwe->prev_min_rtt = bwe->cur_min_rtt;
+    else
+      bwe->prev_min_rtt = GST_CLOCK_TIME_NONE;
+    bwe->cur_min_rtt = rtt;
+    bwe->min_rtt_start = current_time;
+  } else if (rtt < bwe->cur_min_rtt) {
+    bwe->cur_min_rtt = rtt;
+  }
+
+  bwe->min_rtt = bwe->cur_min_rtt;
+  if (GST_CLOCK_TIME_IS_VALID (bwe->prev_min_rtt))
+    bwe->min_rtt = MIN (bwe->min_rtt, bwe->prev_min_rtt);
+}
+
+/* check if the round trip time or the jitter show that packets are queued
+ * in the network */
+static gboolean
+detect_overuse (RTPBandwidthEstimator * bwe, GstClockTime jitter)
+{
+  if (GST_CLOCK_TIME_IS_VALID (bwe->rtt) &&
+      bwe->rtt > bwe->min_rtt + QUEUE_DELAY_THRESHOLD) {
+    GST_DEBUG ("round trip %" GST_TIME_FORMAT " above minimum %"
+        GST_TIME_FORMAT, GST_TIME_ARGS (bwe->rtt),
+        GST_TIME_ARGS (bwe->min_rtt));
+    return TRUE;
+  }
+  if (GST_CLOCK_TIME_IS_VALID (jitter) && jitter > JITTER_THRESHOLD &&
+      jitter > 2 * bwe->jitter) {
+    GST_DEBUG ("jitter %" GST_TIME_FORMAT " above average %" GST_TIME_FORMAT,
+        GST_TIME_ARGS (jitter), GST_TIME_ARGS (bwe->jitter));
+    return TRUE;
+  }
+  return FALSE;
+}
+
+/**
+ * rtp_bwe_process_rb:
+ * @bwe: an #RTPBandwidthEstimator
+ * @current_time: the current time
+ * @fractionlost: the fraction lost of the report block
+ * @jitter: the jitter of the report block in clock rate units
+ * @clock_rate: the clock rate of the stream or -1 when unknown
+ * @round_trip: the round trip time in 16.16 seconds or 0 when unknown
+ * @send_bitrate: the bitrate that is currently sent or 0 when unknown
+ *
+ * Update the target bitrate with a report block about our stream.
+ *
+ * Returns: %TRUE when the target bitrate changed.
+ */
+gboolean
+rtp_bwe_process_rb (RTPBandwidthEstimator * bwe, GstClockTime current_time,
+    guint8 fractionlost, guint32 jitter, gint clock_rate, guint32 round_trip,
+    guint64 send_bitrate)
+{
+  GstClockTime jitter_ns = GST_CLOCK_TIME_NONE;
+  gboolean overuse = FALSE;
+  gdouble target;
+  guint prev;
+
+  if (bwe->mode == RTP_BWE_MODE_NONE)
+    return FALSE;
+
+  bwe->loss = fractionlost / 256.0;
+
+  if (round_trip > 0) {
+    GstClockTime rtt = gst_util_uint64_scale (round_trip, GST_SECOND, 65536);
+
+    if (GST_CLOCK_TIME_IS_VALID (bwe->rtt))
+      bwe->rtt = (7 * bwe->rtt + rtt) / 8;
+    else
+      bwe->rtt = rtt;
+    update_min_rtt (bwe, current_time, rtt);
+  }
+
+  if (clock_rate > 0) {
+    jitter_ns = gst_util_uint64_scale_int (jitter, GST_SECOND, clock_rate);
+    if (!GST_CLOCK_TIME_IS_VALID (bwe->jitter))
+      bwe->jitter = jitter_ns;
+  }
+
+  if (bwe->mode == RTP_BWE_MODE_LOSS_DELAY)
+    overuse = detect_overuse (bwe, jitter_ns);
+
+  if (GST_CLOCK_TIME_IS_VALID (jitter_ns))
+    bwe->jitter = (7 * bwe->jitter + jitter_ns) / 8;
+
+  prev = bwe->bitrate;
+  target = prev;
+
+  if (bwe->loss > LOSS_HIGH || overuse) {
+    /* react to congestion at most once per round trip, the reports of the
+     * previous round trip don't show the effect of the last decrease yet */
+    if (!GST_CLOCK_TIME_IS_VALID (bwe->last_decrease) ||
+        !GST_CLOCK_TIME_IS_VALID (bwe->rtt) ||
+        current_time >= bwe->last_decrease + bwe->rtt) {
+      if (bwe->loss > LOSS_HIGH)
+        target = prev * (1.0 - 0.5 * bwe->loss);
+      else
+        target = prev * DELAY_DECREASE_FACTOR;
+      bwe->last_decrease = current_time;
+    }
+  } else if (bwe->loss < LOSS_LOW) {
+    target = prev * INCREASE_FACTOR + INCREASE_STEP;
+    if (send_bitrate > 0)
+      target = MIN (target, MAX (prev, send_bitrate * SEND_BITRATE_HEADROOM));
+  }
+
+  bwe->bitrate = CLAMP (target, bwe->min_bitrate, bwe->max_bitrate);
+  bwe->have_report = TRUE;
+
+  GST_LOG ("loss %f, rtt %" GST_TIME_FORMAT ", overuse %d, bitrate %u -> %u",
+      bwe->loss, GST_TIME_ARGS (bwe->rtt), overuse, prev, bwe->bitrate);
+
+  return bwe->bitrate != prev;
+}
@@ -0,0 +1,93 @@
+/* GStreamer
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#ifndef __RTP_BWE_H__
+#define __RTP_BWE_H__
+
+#include <gst/gst.h>
+
+/**
+ * RTPBweMode:
+ * @RTP_BWE_MODE_NONE: no bandwidth estimation
+ * @RTP_BWE_MODE_LOSS: adapt the bitrate to the reported packet loss
+ * @RTP_BWE_MODE_LOSS_DELAY: also lower the bitrate when the round trip time
+ *   and jitter show that queues are building up
+ *
+ * How the sender bitrate is estimated from the receiver reports.
+ */
+typedef enum {
+  RTP_BWE_MODE_NONE       = 0,
+  RTP_BWE_MODE_LOSS       = 1,
+  RTP_BWE_MODE_LOSS_DELAY = 2
+} RTPBweMode;
+
+#define RTP_TYPE_BWE_MODE (rtp_bwe_mode_get_type())
+GType rtp_bwe_mode_get_type (void);
+
+#define RTP_BWE_DEFAULT_START_BITRATE  300000
+#define RTP_BWE_DEFAULT_MIN_BITRATE    30000
+#define RTP_BWE_DEFAULT_MAX_BITRATE    20000000
+
+/**
+ * RTPBandwidthEstimator:
+ * @mode: the estimation mode
+ * @min_bitrate: the lowest target bitrate
+ * @max_bitrate: the highest target bitrate
+ * @have_report: if a report block was processed
+ * @bitrate: the current target bitrate in bits per second
+ * @rtt: the smoothed round trip time
+ * @min_rtt: the lowest round trip time of the last 30 to 60 seconds
+ * @cur_min_rtt: the lowest round trip time since @min_rtt_start
+ * @prev_min_rtt: the lowest round trip time of the period before
+ *   @min_rtt_start
+ * @min_rtt_start: the start of the current period of @cur_min_rtt
+ * @jitter: the smoothed interarrival jitter
+ * @loss: the last reported fraction of lost packets
+ * @last_decrease: the time of the last bitrate decrease
+ *
+ * The bandwidth estimation state for the receiver of a stream, updated with
+ * the report blocks of the receiver.
+ */
+typedef struct {
+  RTPBweMode   mode;
+  guint        min_bitrate;
+  guint        max_bitrate;
+
+  gboolean     have_report;
+  guint        bitrate;
+  GstClockTime rtt;
+  GstClockTime min_rtt;
+  GstClockTime cur_min_rtt;
+  GstClockTime prev_min_rtt;
+  GstClockTime min_rtt_start;
+  GstClockTime jitter;
+  gdouble      loss;
+  GstClockTime last_decrease;
+} RTPBandwidthEstimator;
+
+void        rtp_bwe_init         (RTPBandwidthEstimator *bwe, RTPBweMode mode,
+                                  guint start_bitrate, guint min_bitrate,
+                                  guint max_bitrate);
+
+gboolean    rtp_bwe_process_rb   (RTPBandwidthEstimator *bwe,
+                                  GstClockTime current_time,
+                                  guint8 fractionlost, guint32 jitter,
+                                  gint clock_rate, guint32 round_trip,
+                                  guint64 send_bitrate);
+
+#endif /* __RTP_BWE_H__ */
@@ -0,0 +1,352 @@
+/* GStreamer
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+#include <string.h>
+
+#include <gst/rtp/gstrtpbuffer.h>
+
+#include "rtpfec.h"
+
+/* the fixed RTP header, the FEC protects everything after it */
+#define RTP_HEADER_LEN          12
+
+/* RFC 5109 FEC header and level 0 header with a short or long mask */
+#define ULPFEC_HEADER_LEN       10
+#define ULPFEC_LEVEL_LEN_SHORT  4
+#define ULPFEC_LEVEL_LEN_LONG   8
+
+/* SMPTE 2022-1 FEC header */
+#define SMPTE_2022_HEADER_LEN   16
+
+GType
+rtp_fec_format_get_type (void)
+{
+  static GType fec_format_type = 0;
+  static const GEnumValue fec_formats[] = {
+    {RTP_FEC_FORMAT_ULPFEC, "RFC 5109 ULP FEC", "ulpfec"},
+    {RTP_FEC_FORMAT_SMPTE_2022_1, "SMPTE 2022-1 row/column FEC",
+        "smpte-2022-1"},
+    {0, NULL, NULL},
+  };
+
+  if (!fec_format_type) {
+    fec_format_type = g_enum_register_static ("RTPFecFormat", fec_formats);
+  }
+  return fec_format_type;
+}
+
+void
+rtp_fec_xor_init (RTPFecXor * xor)
+{
+  memset (xor, 0, sizeof (RTPFecXor));
+}
+
+void
+rtp_fec_xor_clear (RTPFecXor * xor)
+{
+  g_free (xor->data);
+  rtp_fec_xor_init (xor);
+}
+
+static void
+xor_data (RTPFecXor * xor, const guint8 * data, guint size)
+{
+  guint i;
+
+  if (size > xor->size) {
+    xor->data = g_realloc (xor->data, size);
+    memset (xor->data + xor->size, 0, size - xor->size);
+    xor->size = size;
+  }
+  for (i = 0; i < size; i++)
+    xor->data[i] ^= data[i];
+}
+
+/**
+ * rtp_fec_xor_add_packet:
+ * @xor: a #RTPFecXor
+ * @buffer: an RTP packet
+ *
+ * Add the recovery fields of @buffer to @xor.
+ *
+ * Returns: %FALSE if @buffer is not an RTP packet.
+ */
+gboolean
+rtp_fec_xor_add_packet (RTPFecXor * xor, GstBuffer * buffer)
+{
+  GstMapInfo map;
+  guint len;
+
+  if (!gst_buffer_map (buffer, &map, GST_MAP_READ))
+    return FALSE;
+
+  if (map.size < RTP_HEADER_LEN || (map.data[0] >> 6) != 2) {
+    gst_buffer_unmap (buffer, &map);
+    return FALSE;
+  }
+
+  len = map.size - RTP_HEADER_LEN;
+  xor->hdr0 ^= map.data[0] & 0x3f;
+  xor->hdr1 ^= map.data[1];
+  xor->ts ^= GST_READ_UINT32_BE (map.data + 4);
+  xor->length ^= len;
+  xor_data (xor, map.data + RTP_HEADER_LEN, len);
+  xor->count++;
+
+  gst_buffer_unmap (buffer, &map);
+
+  return TRUE;
+}
+
+/**
+ * rtp_fec_xor_to_fec:
+ * @xor: a #RTPFecXor with the protected packets
+ * @header: the protected packets
+ * @pt: payload type of the FEC packet
+ * @seqnum: seqnum of the FEC packet
+ * @timestamp: timestamp of the FEC packet
+ * @ssrc: SSRC of the FEC packet
+ *
+ * Make a FEC packet in the format of @header from @xor.
+ *
+ * Returns: a new FEC packet.
+ */
+GstBuffer *
+rtp_fec_xor_to_fec (RTPFecXor * xor, const RTPFecHeader * header, guint8 pt,
+    guint16 seqnum, guint32 timestamp, guint32 ssrc)
+{
+  GstRTPBuffer rtp = GST_RTP_BUFFER_INIT;
+  GstBuffer *buffer;
+  guint8 *data;
+  guint hdr_len;
+
+  if (header->format == RTP_FEC_FORMAT_ULPFEC) {
+    gboolean long_mask;
+
+    long_mask = (header->na - 1) * header->offset >= 16;
+    hdr_len = ULPFEC_HEADER_LEN +
+        (long_mask ? ULPFEC_LEVEL_LEN_LONG : ULPFEC_LEVEL_LEN_SHORT);
+
+    buffer = gst_rtp_buffer_new_allocate (hdr_len + xor->size, 0, 0);
+    gst_rtp_buffer_map (buffer, GST_MAP_WRITE, &rtp);
+    data = gst_rtp_buffer_get_payload (&rtp);
+
+    data[0] = (long_mask ? 0x40 : 0x00) | (xor->hdr0 & 0x3f);
+    data[1] = xor->hdr1;
+    GST_WRITE_UINT16_BE (data + 2, header->sn_base);
+    GST_WRITE_UINT32_BE (data + 4, xor->ts);
+    GST_WRITE_UINT16_BE (data + 8, xor->length);
+
+    /* level 0 header, we protect the complete packets */
+    GST_WRITE_UINT16_BE (data + 10, xor->size);
+    {
+      guint64 mask = 0;
+      guint i;
+
+      for (i = 0; i < header->na; i++)
+        mask |= G_GUINT64_CONSTANT (1) << (47 - i * header->offset);
+
+      GST_WRITE_UINT16_BE (data + 12, mask >> 32);
+      if (long_mask)
+        GST_WRITE_UINT32_BE (data + 14, mask & 0xffffffff);
+    }
+  } else {
+    hdr_len = SMPTE_2022_HEADER_LEN;
+
+    buffer = gst_rtp_buffer_new_allocate (hdr_len + xor->size, 0, 0);
+    gst_rtp_buffer_map (buffer, GST_MAP_WRITE, &rtp);
+    data = gst_rtp_buffer_get_payload (&rtp);
+
+    GST_WRITE_UINT16_BE (data, header->sn_base);
+    GST_WRITE_UINT16_BE (data + 2, xor->length);
+    /* E bit and PT recovery, the mask is unused */
+    data[4] = 0x80 | (xor->hdr1 & 0x7f);
+    data[5] = data[6] = data[7] = 0;
+    GST_WRITE_UINT32_BE (data + 8, xor->ts);
+    /* N = 0, D, type = XOR, index = 0 */
+    data[12] = header->row ? 0x40 : 0x00;
+    data[13] = header->offset;
+    data[14] = header->na;
+    data[15] = 0;
+  }
+  if (xor->size)
+    memcpy (data + hdr_len, xor->data, xor->size);
+
+  gst_rtp_buffer_set_payload_type (&rtp, pt);
+  gst_rtp_buffer_set_seq (&rtp, seqnum);
+  gst_rtp_buffer_set_timestamp (&rtp, timestamp);
+  gst_rtp_buffer_set_ssrc (&rtp, ssrc);
+  gst_rtp_buffer_unmap (&rtp);
+
+  return buffer;
+}
+
+/**
+ * rtp_fec_parse:
+ * @buffer: a FEC packet
+ * @format: the expected format
+ * @header: the result protection info
+ * @xor: the result XOR fields, initialized with rtp_fec_xor_init()
+ *
+ * Parse the FEC packet in @buffer. The recovery fields of the packet are
+ * stored in @xor so that the missing packet can be recovered by adding all
+ * other protected packets to it.
+ *
+ * Returns: %FALSE if @buffer is not a valid FEC packet.
+ */
+gboolean
+rtp_fec_parse (GstBuffer * buffer, RTPFecFormat format, RTPFecHeader * header,
+    RTPFecXor * xor)
+{
+  GstRTPBuffer rtp = GST_RTP_BUFFER_INIT;
+  guint8 *data;
+  guint len, hdr_len, i;
+
+  if (!gst_rtp_buffer_map (buffer, GST_MAP_READ, &rtp))
+    return FALSE;
+
+  data = gst_rtp_buffer_get_payload (&rtp);
+  len = gst_rtp_buffer_get_payload_len (&rtp);
+
+  header->format = format;
+  header->n_seqnums = 0;
+
+  if (format == RTP_FEC_FORMAT_ULPFEC) {
+    gboolean long_mask;
+    guint64 mask;
+    guint prot_len;
+
+    if (len < ULPFEC_HEADER_LEN + ULPFEC_LEVEL_LEN_SHORT)
+      goto too_short;
+
+    long_mask = (data[0] & 0x40) != 0;
+    hdr_len = ULPFEC_HEADER_LEN +
+        (long_mask ? ULPFEC_LEVEL_LEN_LONG : ULPFEC_LEVEL_LEN_SHORT);
+    if (len < hdr_len)
+      goto too_short;
+
+    xor->hdr0 = data[0] & 0x3f;
+    xor->hdr1 = data[1];
+    header->sn_base = GST_READ_UINT16_BE (data + 2);
+    xor->ts = GST_READ_UINT32_BE (data + 4);
+    xor->length = GST_READ_UINT16_BE (data + 8);
+    prot_len = GST_READ_UINT16_BE (data + 10);
+    mask = (guint64) GST_READ_UINT16_BE (data + 12) << 32;
+    if (long_mask)
+      mask |= GST_READ_UINT32_BE (data + 14);
+
+    /* we can only recover complete packets */
+    if (prot_len != len - hdr_len)
+      goto unsupported;
+
+    header->offset = 0;
+    header->row = FALSE;
+    header->recover_header = TRUE;
+    for (i = 0; i < RTP_FEC_ULPFEC_MAX_SPAN; i++) {
+      if (mask & (G_GUINT64_CONSTANT (1) << (47 - i)))
+        header->seqnums[header->n_seqnums++] = header->sn_base + i;
+    }
+    header->na = header->n_seqnums;
+  } else {
+    hdr_len = SMPTE_2022_HEADER_LEN;
+    if (len < hdr_len)
+      goto too_short;
+
+    header->sn_base = GST_READ_UINT16_BE (data);
+    xor->length = GST_READ_UINT16_BE (data + 2);
+    xor->hdr0 = 0;
+    xor->hdr1 = data[4] & 0x7f;
+    xor->ts = GST_READ_UINT32_BE (data + 8);
+    /* only the XOR type is defined */
+    if ((data[12] & 0x38) != 0)
+      goto unsupported;
+    header->row = (data[12] & 0x40) != 0;
+    header->offset = data[13];
+    header->na = data[14];
+    header->recover_header = FALSE;
+
+    if (header->offset == 0)
+      goto unsupported;
+
+    for (i = 0; i < header->na; i++)
+      header->seqnums[header->n_seqnums++] =
+          header->sn_base + i * header->offset;
+  }
+
+  if (header->n_seqnums == 0)
+    goto unsupported;
+
+  xor_data (xor, data + hdr_len, len - hdr_len);
+  gst_rtp_buffer_unmap (&rtp);
+
+  return TRUE;
+
+  /* ERRORS */
+too_short:
+  {
+    GST_DEBUG ("FEC packet too short");
+    gst_rtp_buffer_unmap (&rtp);
+    return FALSE;
+  }
+unsupported:
+  {
+    GST_DEBUG ("unsupported FEC packet");
+    gst_rtp_buffer_unmap (&rtp);
+    return FALSE;
+  }
+}
+
+/**
+ * rtp_fec_xor_to_packet:
+ * @xor: a #RTPFecXor with the FEC packet and all but one protected packet
+ * @recover_header: if the P, X, CC and M fields are recovered
+ * @seqnum: the seqnum of the missing packet
+ * @ssrc: the SSRC of the missing packet
+ *
+ * Make the missing packet from @xor.
+ *
+ * Returns: the recovered packet or %NULL when the recovered length is invalid.
+ */
+GstBuffer *
+rtp_fec_xor_to_packet (RTPFecXor * xor, gboolean recover_header,
+    guint16 seqnum, guint32 ssrc)
+{
+  GstBuffer *buffer;
+  GstMapInfo map;
+
+  if (xor->length > xor->size)
+    return NULL;
+
+  buffer = gst_buffer_new_allocate (NULL, RTP_HEADER_LEN + xor->length, NULL);
+  gst_buffer_map (buffer, &map, GST_MAP_WRITE);
+
+  if (recover_header) {
+    map.data[0] = 0x80 | (xor->hdr0 & 0x3f);
+    map.data[1] = xor->hdr1;
+  } else {
+    map.data[0] = 0x80;
+    map.data[1] = xor->hdr1 & 0x7f;
+  }
+  GST_WRITE_UINT16_BE (map.data + 2, seqnum);
+  GST_WRITE_UINT32_BE (map.data + 4, xor->ts);
+  GST_WRITE_UINT32_BE (map.data + 8, ssrc);
+  memcpy (map.data + RTP_HEADER_LEN, xor->data, xor->length);
+
+  gst_buffer_unmap (buffer, &map);
+
+  return buffer;
+}
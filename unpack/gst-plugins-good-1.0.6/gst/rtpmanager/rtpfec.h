@@ -0,0 +1,108 @@
+/* GStreamer
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#ifndef __RTP_FEC_H__
+#define __RTP_FEC_H__
+
+#include <gst/gst.h>
+
+/**
+ * RTPFecFormat:
+ * @RTP_FEC_FORMAT_ULPFEC: RFC 5109 ULP FEC with a single protection level
+ *    protecting the complete packets.
+ * @RTP_FEC_FORMAT_SMPTE_2022_1: SMPTE 2022-1 row/column FEC, usually used
+ *    for MPEG-TS streams.
+ *
+ * The FEC header format.
+ */
+typedef enum {
+  RTP_FEC_FORMAT_ULPFEC       = 0,
+  RTP_FEC_FORMAT_SMPTE_2022_1 = 1
+} RTPFecFormat;
+
+#define RTP_TYPE_FEC_FORMAT (rtp_fec_format_get_type())
+GType rtp_fec_format_get_type (void);
+
+/* maximum number of packets protected by one FEC packet */
+#define RTP_FEC_MAX_PROTECTED 255
+/* largest distance between SN base and a protected packet with ULPFEC */
+#define RTP_FEC_ULPFEC_MAX_SPAN 48
+
+/**
+ * RTPFecXor:
+ * @hdr0: XOR of the P, X and CC fields
+ * @hdr1: XOR of the M and PT fields
+ * @ts: XOR of the timestamps
+ * @length: XOR of the lengths of the packets without the fixed header
+ * @data: XOR of the packets without the fixed header
+ * @size: the size of @data
+ * @count: number of packets in the XOR
+ *
+ * The XOR of the recovery fields of a set of RTP packets. Adding all packets
+ * of the protected set but one to the XOR of a FEC packet leaves the fields
+ * of the missing packet.
+ */
+typedef struct {
+  guint8   hdr0;
+  guint8   hdr1;
+  guint32  ts;
+  guint16  length;
+  guint8  *data;
+  guint    size;
+  guint    count;
+} RTPFecXor;
+
+/**
+ * RTPFecHeader:
+ * @format: the header format
+ * @sn_base: the first protected seqnum
+ * @offset: the distance between protected seqnums
+ * @na: the number of protected packets
+ * @row: %TRUE for a row FEC packet, %FALSE for a column FEC packet
+ * @recover_header: %TRUE when the FEC packet protects the P, X, CC and M
+ *    fields.
+ * @seqnums: the protected seqnums, filled in by rtp_fec_parse()
+ * @n_seqnums: the number of protected seqnums
+ *
+ * The protection info of a FEC packet. When generating a FEC packet the
+ * protected packets are described with @sn_base, @offset and @na.
+ */
+typedef struct {
+  RTPFecFormat format;
+  guint16      sn_base;
+  guint        offset;
+  guint        na;
+  gboolean     row;
+  gboolean     recover_header;
+  guint16      seqnums[RTP_FEC_MAX_PROTECTED];
+  guint        n_seqnums;
+} RTPFecHeader;
+
+void        rtp_fec_xor_init        (RTPFecXor *xor);
+void        rtp_fec_xor_clear       (RTPFecXor *xor);
+gboolean    rtp_fec_xor_add_packet  (RTPFecXor *xor, GstBuffer *buffer);
+
+GstBuffer * rtp_fec_xor_to_fec      (RTPFecXor *xor, const RTPFecHeader *header,
+                                     guint8 pt, guint16 seqnum,
+                                     guint32 timestamp, guint32 ssrc);
+gboolean    rtp_fec_parse           (GstBuffer *buffer, RTPFecFormat format,
+                                     RTPFecHeader *header, RTPFecXor *xor);
+GstBuffer * rtp_fec_xor_to_packet   (RTPFecXor *xor, gboolean recover_header,
+                                     guint16 seqnum, guint32 ssrc);
+
+#endif /* __RTP_FEC_H__ */
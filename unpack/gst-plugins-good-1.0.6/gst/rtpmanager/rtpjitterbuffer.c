@@ -30,6 +30,14 @@ GST_DEBUG_CATEGORY_STATIC (rtp_jitter_buffer_debug);
 #define MAX_WINDOW	RTP_JITTER_BUFFER_MAX_WINDOW
 #define MAX_TIME	(2 * GST_SECOND)
 
+/* initial and maximum number of slots in the packet array, the array always
+ * has a power of 2 size so that a seqnum can be masked into a slot index */
+#define MIN_PACKETS_SIZE	64
+#define MAX_PACKETS_SIZE	32768
+
+#define PACKET_SLOT(jbuf,seqnum) \
+    ((jbuf)->packets[(seqnum) & ((jbuf)->packets_size - 1)])
+
 /* signals and args */
 enum
 {
@@ -83,7 +91,11 @@ rtp_jitter_buffer_class_init (RTPJitterBufferClass * klass)
 static void
 rtp_jitter_buffer_init (RTPJitterBuffer * jbuf)
 {
-  jbuf->packets = g_queue_new ();
+  jbuf->packets_size = MIN_PACKETS_SIZE;
+  jbuf->packets = g_new0 (GstBuffer *, jbuf->packets_size);
+  jbuf->packets_first = 0;
+  jbuf->packets_span = 0;
+  jbuf->packets_count = 0;
   jbuf->mode = RTP_JITTER_BUFFER_MODE_SLAVE;
 
   rtp_jitter_buffer_reset_skew (jbuf);
@@ -97,7 +109,7 @@ rtp_jitter_buffer_finalize (GObject * object)
   jbuf = RTP_JITTER_BUFFER_CAST (object);
 
   rtp_jitter_buffer_flush (jbuf);
-  g_queue_free (jbuf->packets);
+  g_free (jbuf->packets);
 
   G_OBJECT_CLASS (rtp_jitter_buffer_parent_class)->finalize (object);
 }
@@ -214,27 +226,23 @@ get_buffer_level (RTPJitterBuffer * jbuf)
 {
   GstBuffer *high_buf = NULL, *low_buf = NULL;
   guint64 level;
-  GList *find;
+  guint i;
 
-  /* first first buffer with timestamp */
-  find = g_queue_peek_head_link (jbuf->packets);
-  while (find) {
-    high_buf = find->data;
-    if (GST_BUFFER_TIMESTAMP (high_buf) != -1)
+  /* first first buffer with timestamp, starting from the newest packet */
+  for (i = jbuf->packets_span; i > 0; i--) {
+    high_buf = PACKET_SLOT (jbuf, jbuf->packets_first + i - 1);
+    if (high_buf && GST_BUFFER_TIMESTAMP (high_buf) != -1)
       break;
 
     high_buf = NULL;
-    find = g_list_next (find);
   }
 
-  find = g_queue_peek_tail_link (jbuf->packets);
-  while (find) {
-    low_buf = find->data;
-    if (GST_BUFFER_TIMESTAMP (low_buf) != -1)
+  for (i = 0; i < jbuf->packets_span; i++) {
+    low_buf = PACKET_SLOT (jbuf, jbuf->packets_first + i);
+    if (low_buf && GST_BUFFER_TIMESTAMP (low_buf) != -1)
       break;
 
     low_buf = NULL;
-    find = g_list_previous (find);
   }
 
   if (!high_buf || !low_buf || high_buf == low_buf) {
@@ -585,6 +593,39 @@ no_skew:
   return out_time;
 }
 
+/* make room for @span seqnums in the packet array. The slot of a packet
+ * depends on the array size so all packets are moved to their new slot. */
+static gboolean
+ensure_packets_size (RTPJitterBuffer * jbuf, guint span)
+{
+  GstBuffer **packets;
+  guint size, i;
+
+  if (G_LIKELY (span <= jbuf->packets_size))
+    return TRUE;
+
+  if (span > MAX_PACKETS_SIZE)
+    return FALSE;
+
+  size = jbuf->packets_size;
+  while (size < span)
+    size <<= 1;
+
+  GST_DEBUG ("resize packet array from %u to %u", jbuf->packets_size, size);
+
+  packets = g_new0 (GstBuffer *, size);
+  for (i = 0; i < jbuf->packets_span; i++) {
+    guint16 seqnum = jbuf->packets_first + i;
+
+    packets[seqnum & (size - 1)] = PACKET_SLOT (jbuf, seqnum);
+  }
+  g_free (jbuf->packets);
+  jbuf->packets = packets;
+  jbuf->packets_size = size;
+
+  return TRUE;
+}
+
 /**
  * rtp_jitter_buffer_insert:
  * @jbuf: an #RTPJitterBuffer
@@ -595,19 +636,24 @@ no_skew:
  * @tail: TRUE when the tail element changed.
  *
  * Inserts @buf into the packet queue of @jbuf. The sequence number of the
- * packet will be used to sort the packets. This function takes ownerhip of
- * @buf when the function returns %TRUE.
+ * packet is used as the index in the packet array so that inserting, finding
+ * duplicates and finding gaps does not depend on the amount of queued
+ * packets. This function takes ownerhip of @buf when the function returns
+ * %TRUE.
  * @buf should have writable metadata when calling this function.
  *
- * Returns: %FALSE if a packet with the same number already existed.
+ * Returns: %FALSE if a packet with the same number already existed or if
+ * the packet is too far away from the queued packets.
  */
 gboolean
 rtp_jitter_buffer_insert (RTPJitterBuffer * jbuf, GstBuffer * buf,
     GstClockTime time, guint32 clock_rate, gboolean * tail, gint * percent)
 {
-  GList *list;
   guint32 rtptime;
   guint16 seqnum;
+  gint gap;
+  guint span;
+  gboolean is_first;
   GstRTPBuffer rtp = { NULL };
 
   g_return_val_if_fail (jbuf != NULL, FALSE);
@@ -617,28 +663,31 @@ rtp_jitter_buffer_insert (RTPJitterBuffer * jbuf, GstBuffer * buf,
 
   seqnum = gst_rtp_buffer_get_seq (&rtp);
 
-  /* loop the list to skip strictly smaller seqnum buffers */
-  for (list = jbuf->packets->head; list; list = g_list_next (list)) {
-    guint16 qseq;
-    gint gap;
-    GstRTPBuffer rtpb = { NULL };
-
-    gst_rtp_buffer_map (GST_BUFFER_CAST (list->data), GST_MAP_READ, &rtpb);
-    qseq = gst_rtp_buffer_get_seq (&rtpb);
-    gst_rtp_buffer_unmap (&rtpb);
-
-    /* compare the new seqnum to the one in the buffer */
-    gap = gst_rtp_buffer_compare_seqnum (seqnum, qseq);
-
-    /* we hit a packet with the same seqnum, notify a duplicate */
-    if (G_UNLIKELY (gap == 0))
-      goto duplicate;
+  /* position of the new packet relative to the oldest packet */
+  if (jbuf->packets_count == 0) {
+    gap = 0;
+    span = 1;
+    is_first = TRUE;
+  } else {
+    gap = gst_rtp_buffer_compare_seqnum (jbuf->packets_first, seqnum);
+    if (gap < 0) {
+      /* older than the oldest packet */
+      span = jbuf->packets_span - gap;
+      is_first = TRUE;
+    } else {
+      /* we hit a packet with the same seqnum, notify a duplicate */
+      if (G_UNLIKELY (gap < jbuf->packets_span &&
+              PACKET_SLOT (jbuf, seqnum) != NULL))
+        goto duplicate;
 
-    /* seqnum > qseq, we can stop looking */
-    if (G_LIKELY (gap < 0))
-      break;
+      span = MAX (jbuf->packets_span, (guint) gap + 1);
+      is_first = FALSE;
+    }
   }
 
+  if (G_UNLIKELY (!ensure_packets_size (jbuf, span)))
+    goto too_far;
+
   rtptime = gst_rtp_buffer_get_timestamp (&rtp);
   /* rtp time jumps are checked for during skew calculation, but bypassed
    * in other mode, so mind those here and reset jb if needed.
@@ -683,11 +732,11 @@ rtp_jitter_buffer_insert (RTPJitterBuffer * jbuf, GstBuffer * buf,
   GST_BUFFER_PTS (buf) = time;
   GST_BUFFER_DTS (buf) = time;
 
-  /* It's more likely that the packet was inserted in the front of the buffer */
-  if (G_LIKELY (list))
-    g_queue_insert_before (jbuf->packets, list, buf);
-  else
-    g_queue_push_tail (jbuf->packets, buf);
+  PACKET_SLOT (jbuf, seqnum) = buf;
+  if (is_first)
+    jbuf->packets_first = seqnum;
+  jbuf->packets_span = span;
+  jbuf->packets_count++;
 
   /* buffering mode, update buffer stats */
   if (jbuf->mode == RTP_JITTER_BUFFER_MODE_BUFFER)
@@ -695,10 +744,10 @@ rtp_jitter_buffer_insert (RTPJitterBuffer * jbuf, GstBuffer * buf,
   else
     *percent = -1;
 
-  /* tail was changed when we did not find a previous packet, we set the return
-   * flag when requested. */
+  /* tail was changed when the packet is the new oldest packet, we set the
+   * return flag when requested. */
   if (G_LIKELY (tail))
-    *tail = (list == NULL);
+    *tail = is_first;
 
   gst_rtp_buffer_unmap (&rtp);
 
@@ -711,6 +760,12 @@ duplicate:
     GST_WARNING ("duplicate packet %d found", (gint) seqnum);
     return FALSE;
   }
+too_far:
+  {
+    gst_rtp_buffer_unmap (&rtp);
+    GST_WARNING ("packet %d too far from queued packets", (gint) seqnum);
+    return FALSE;
+  }
 }
 
 /**
@@ -731,7 +786,23 @@ rtp_jitter_buffer_pop (RTPJitterBuffer * jbuf, gint * percent)
 
   g_return_val_if_fail (jbuf != NULL, NULL);
 
-  buf = g_queue_pop_tail (jbuf->packets);
+  if (jbuf->packets_count == 0) {
+    buf = NULL;
+  } else {
+    buf = PACKET_SLOT (jbuf, jbuf->packets_first);
+    PACKET_SLOT (jbuf, jbuf->packets_first) = NULL;
+    jbuf->packets_count--;
+
+    if (jbuf->packets_count == 0) {
+      jbuf->packets_span = 0;
+    } else {
+      /* skip over the gap to the next oldest packet */
+      do {
+        jbuf->packets_first++;
+        jbuf->packets_span--;
+      } while (PACKET_SLOT (jbuf, jbuf->packets_first) == NULL);
+    }
+  }
 
   /* buffering mode, update buffer stats */
   if (jbuf->mode == RTP_JITTER_BUFFER_MODE_BUFFER)
@@ -759,11 +830,40 @@ rtp_jitter_buffer_peek (RTPJitterBuffer * jbuf)
 
   g_return_val_if_fail (jbuf != NULL, NULL);
 
-  buf = g_queue_peek_tail (jbuf->packets);
+  if (jbuf->packets_count == 0)
+    return NULL;
+
+  buf = PACKET_SLOT (jbuf, jbuf->packets_first);
 
   return buf;
 }
 
+/**
+ * rtp_jitter_buffer_has_packet:
+ * @jbuf: an #RTPJitterBuffer
+ * @seqnum: a sequence number
+ *
+ * Check if a packet with @seqnum is in the packet queue of @jbuf.
+ *
+ * Returns: %TRUE if a packet with @seqnum is queued.
+ */
+gboolean
+rtp_jitter_buffer_has_packet (RTPJitterBuffer * jbuf, guint16 seqnum)
+{
+  gint gap;
+
+  g_return_val_if_fail (jbuf != NULL, FALSE);
+
+  if (jbuf->packets_count == 0)
+    return FALSE;
+
+  gap = gst_rtp_buffer_compare_seqnum (jbuf->packets_first, seqnum);
+  if (gap < 0 || gap >= jbuf->packets_span)
+    return FALSE;
+
+  return PACKET_SLOT (jbuf, seqnum) != NULL;
+}
+
 /**
  * rtp_jitter_buffer_flush:
  * @jbuf: an #RTPJitterBuffer
@@ -773,12 +873,20 @@ rtp_jitter_buffer_peek (RTPJitterBuffer * jbuf)
 void
 rtp_jitter_buffer_flush (RTPJitterBuffer * jbuf)
 {
-  GstBuffer *buffer;
+  guint i;
 
   g_return_if_fail (jbuf != NULL);
 
-  while ((buffer = g_queue_pop_head (jbuf->packets)))
-    gst_buffer_unref (buffer);
+  for (i = 0; i < jbuf->packets_span; i++) {
+    GstBuffer **slot = &PACKET_SLOT (jbuf, jbuf->packets_first + i);
+
+    if (*slot) {
+      gst_buffer_unref (*slot);
+      *slot = NULL;
+    }
+  }
+  jbuf->packets_span = 0;
+  jbuf->packets_count = 0;
 }
 
 /**
@@ -846,7 +954,7 @@ rtp_jitter_buffer_num_packets (RTPJitterBuffer * jbuf)
 {
   g_return_val_if_fail (jbuf != NULL, 0);
 
-  return jbuf->packets->length;
+  return jbuf->packets_count;
 }
 
 /**
@@ -868,8 +976,11 @@ rtp_jitter_buffer_get_ts_diff (RTPJitterBuffer * jbuf)
 
   g_return_val_if_fail (jbuf != NULL, 0);
 
-  high_buf = g_queue_peek_head (jbuf->packets);
-  low_buf = g_queue_peek_tail (jbuf->packets);
+  if (jbuf->packets_count == 0)
+    return 0;
+
+  high_buf = PACKET_SLOT (jbuf, jbuf->packets_first + jbuf->packets_span - 1);
+  low_buf = PACKET_SLOT (jbuf, jbuf->packets_first);
 
   if (!high_buf || !low_buf || high_buf == low_buf)
     return 0;
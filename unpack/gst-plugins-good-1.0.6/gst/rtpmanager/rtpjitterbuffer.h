@@ -67,7 +67,13 @@ GType rtp_jitter_buffer_mode_get_type (void);
 struct _RTPJitterBuffer {
   GObject        object;
 
-  GQueue        *packets;
+  /* the packets in a circular array indexed by seqnum, the oldest packet is
+   * at packets_first and all packets are within packets_span seqnums */
+  GstBuffer    **packets;
+  guint          packets_size;
+  guint16        packets_first;
+  guint          packets_span;
+  guint          packets_count;
 
   RTPJitterBufferMode mode;
 
@@ -118,6 +124,7 @@ gboolean              rtp_jitter_buffer_insert           (RTPJitterBuffer *jbuf,
                                                           gboolean *tail, gint *percent);
 GstBuffer *           rtp_jitter_buffer_peek             (RTPJitterBuffer *jbuf);
 GstBuffer *           rtp_jitter_buffer_pop              (RTPJitterBuffer *jbuf, gint *percent);
+gboolean              rtp_jitter_buffer_has_packet       (RTPJitterBuffer *jbuf, guint16 seqnum);
 
 void                  rtp_jitter_buffer_flush            (RTPJitterBuffer *jbuf);
 
@@ -50,6 +50,7 @@ enum
   SIGNAL_ON_SENDING_RTCP,
   SIGNAL_ON_FEEDBACK_RTCP,
   SIGNAL_SEND_RTCP,
+  SIGNAL_ON_TARGET_BITRATE,
   LAST_SIGNAL
 };
 
@@ -67,6 +68,10 @@ enum
 #define DEFAULT_RTCP_FEEDBACK_RETENTION_WINDOW (2 * GST_SECOND)
 #define DEFAULT_RTCP_IMMEDIATE_FEEDBACK_THRESHOLD (3)
 #define DEFAULT_PROBATION            RTP_DEFAULT_PROBATION
+#define DEFAULT_BANDWIDTH_ESTIMATION RTP_BWE_MODE_NONE
+#define DEFAULT_START_BITRATE        RTP_BWE_DEFAULT_START_BITRATE
+#define DEFAULT_MIN_BITRATE          RTP_BWE_DEFAULT_MIN_BITRATE
+#define DEFAULT_MAX_BITRATE          RTP_BWE_DEFAULT_MAX_BITRATE
 
 enum
 {
@@ -87,6 +92,11 @@ enum
   PROP_RTCP_FEEDBACK_RETENTION_WINDOW,
   PROP_RTCP_IMMEDIATE_FEEDBACK_THRESHOLD,
   PROP_PROBATION,
+  PROP_BANDWIDTH_ESTIMATION,
+  PROP_START_BITRATE,
+  PROP_MIN_BITRATE,
+  PROP_MAX_BITRATE,
+  PROP_TARGET_BITRATE,
   PROP_LAST
 };
 
@@ -327,6 +337,19 @@ rtp_session_class_init (RTPSessionClass * klass)
       G_STRUCT_OFFSET (RTPSessionClass, send_rtcp), NULL, NULL,
       gst_rtp_bin_marshal_VOID__UINT64, G_TYPE_NONE, 1, G_TYPE_UINT64);
 
+  /**
+   * RTPSession::on-target-bitrate:
+   * @session: the object which received the signal
+   * @bitrate: the new target bitrate in bits per second
+   *
+   * Notify that the bandwidth estimation changed the target bitrate of our
+   * stream. The target bitrate is the lowest estimate of all receivers.
+   */
+  rtp_session_signals[SIGNAL_ON_TARGET_BITRATE] =
+      g_signal_new ("on-target-bitrate", G_TYPE_FROM_CLASS (klass),
+      G_SIGNAL_RUN_LAST, G_STRUCT_OFFSET (RTPSessionClass, on_target_bitrate),
+      NULL, NULL, g_cclosure_marshal_VOID__UINT, G_TYPE_NONE, 1, G_TYPE_UINT);
+
   g_object_class_install_property (gobject_class, PROP_INTERNAL_SSRC,
       g_param_spec_uint ("internal-ssrc", "Internal SSRC",
           "The internal SSRC used for the session",
@@ -447,6 +470,34 @@ rtp_session_class_init (RTPSessionClass * klass)
           0, G_MAXUINT, DEFAULT_PROBATION,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  g_object_class_install_property (gobject_class, PROP_BANDWIDTH_ESTIMATION,
+      g_param_spec_enum ("bandwidth-estimation", "Bandwidth Estimation",
+          "Estimate the target bitrate of our stream from the receiver reports",
+          RTP_TYPE_BWE_MODE, DEFAULT_BANDWIDTH_ESTIMATION,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  g_object_class_install_property (gobject_class, PROP_START_BITRATE,
+      g_param_spec_uint ("start-bitrate", "Start Bitrate",
+          "The target bitrate before the first receiver report (in bits/s)",
+          0, G_MAXUINT, DEFAULT_START_BITRATE,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  g_object_class_install_property (gobject_class, PROP_MIN_BITRATE,
+      g_param_spec_uint ("min-bitrate", "Min Bitrate",
+          "The lowest target bitrate (in bits/s)", 0, G_MAXUINT,
+          DEFAULT_MIN_BITRATE, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  g_object_class_install_property (gobject_class, PROP_MAX_BITRATE,
+      g_param_spec_uint ("max-bitrate", "Max Bitrate",
+          "The highest target bitrate (in bits/s)", 0, G_MAXUINT,
+          DEFAULT_MAX_BITRATE, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  g_object_class_install_property (gobject_class, PROP_TARGET_BITRATE,
+      g_param_spec_uint ("target-bitrate", "Target Bitrate",
+          "The estimated target bitrate of our stream (in bits/s)", 0,
+          G_MAXUINT, DEFAULT_START_BITRATE,
+          G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+
   klass->get_source_by_ssrc =
       GST_DEBUG_FUNCPTR (rtp_session_get_source_by_ssrc);
   klass->on_sending_rtcp = GST_DEBUG_FUNCPTR (rtp_session_on_sending_rtcp);
@@ -499,6 +550,12 @@ rtp_session_init (RTPSession * sess)
 
   sess->probation = DEFAULT_PROBATION;
 
+  sess->bwe_mode = DEFAULT_BANDWIDTH_ESTIMATION;
+  sess->start_bitrate = DEFAULT_START_BITRATE;
+  sess->min_bitrate = DEFAULT_MIN_BITRATE;
+  sess->max_bitrate = DEFAULT_MAX_BITRATE;
+  sess->target_bitrate = DEFAULT_START_BITRATE;
+
   /* some default SDES entries */
 
   /* we do not want to leak details like the username or hostname here */
@@ -630,6 +687,28 @@ rtp_session_set_property (GObject * object, guint prop_id,
       sess->probation = g_value_get_uint (value);
       g_object_set_property (G_OBJECT (sess->source), "probation", value);
       break;
+    case PROP_BANDWIDTH_ESTIMATION:
+      RTP_SESSION_LOCK (sess);
+      sess->bwe_mode = g_value_get_enum (value);
+      /* start over, the receivers are reinitialized with their next report */
+      sess->target_bitrate = sess->start_bitrate;
+      RTP_SESSION_UNLOCK (sess);
+      break;
+    case PROP_START_BITRATE:
+      RTP_SESSION_LOCK (sess);
+      sess->start_bitrate = g_value_get_uint (value);
+      RTP_SESSION_UNLOCK (sess);
+      break;
+    case PROP_MIN_BITRATE:
+      RTP_SESSION_LOCK (sess);
+      sess->min_bitrate = g_value_get_uint (value);
+      RTP_SESSION_UNLOCK (sess);
+      break;
+    case PROP_MAX_BITRATE:
+      RTP_SESSION_LOCK (sess);
+      sess->max_bitrate = g_value_get_uint (value);
+      RTP_SESSION_UNLOCK (sess);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -691,6 +770,31 @@ rtp_session_get_property (GObject * object, guint prop_id,
       g_value_set_uint (value, sess->probation);
       g_object_get_property (G_OBJECT (sess->source), "probation", value);
       break;
+    case PROP_BANDWIDTH_ESTIMATION:
+      RTP_SESSION_LOCK (sess);
+      g_value_set_enum (value, sess->bwe_mode);
+      RTP_SESSION_UNLOCK (sess);
+      break;
+    case PROP_START_BITRATE:
+      RTP_SESSION_LOCK (sess);
+      g_value_set_uint (value, sess->start_bitrate);
+      RTP_SESSION_UNLOCK (sess);
+      break;
+    case PROP_MIN_BITRATE:
+      RTP_SESSION_LOCK (sess);
+      g_value_set_uint (value, sess->min_bitrate);
+      RTP_SESSION_UNLOCK (sess);
+      break;
+    case PROP_MAX_BITRATE:
+      RTP_SESSION_LOCK (sess);
+      g_value_set_uint (value, sess->max_bitrate);
+      RTP_SESSION_UNLOCK (sess);
+      break;
+    case PROP_TARGET_BITRATE:
+      RTP_SESSION_LOCK (sess);
+      g_value_set_uint (value, sess->target_bitrate);
+      RTP_SESSION_UNLOCK (sess);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -854,6 +958,10 @@ rtp_session_set_callbacks (RTPSession * sess, RTPSessionCallbacks * callbacks,
     sess->callbacks.request_time = callbacks->request_time;
     sess->request_time_user_data = user_data;
   }
+  if (callbacks->notify_nack) {
+    sess->callbacks.notify_nack = callbacks->notify_nack;
+    sess->notify_nack_user_data = user_data;
+  }
 }
 
 /**
@@ -1846,6 +1954,54 @@ collision:
   }
 }
 
+static void
+on_target_bitrate (RTPSession * sess, guint bitrate)
+{
+  RTP_SESSION_UNLOCK (sess);
+  g_signal_emit (sess, rtp_session_signals[SIGNAL_ON_TARGET_BITRATE], 0,
+      bitrate);
+  RTP_SESSION_LOCK (sess);
+}
+
+static void
+find_min_bitrate (gpointer key, RTPSource * source, guint * bitrate)
+{
+  if (source->bwe.have_report && source->bwe.bitrate < *bitrate)
+    *bitrate = source->bwe.bitrate;
+}
+
+/* update the estimate of @source with its report block about our stream and
+ * notify when the target bitrate of the session changes. The target is the
+ * lowest estimate of all receivers. */
+static void
+update_target_bitrate (RTPSession * sess, RTPSource * source,
+    RTPArrivalStats * arrival, guint8 fractionlost, guint32 jitter)
+{
+  guint32 round_trip = 0;
+  guint bitrate = G_MAXUINT;
+
+  if (sess->bwe_mode == RTP_BWE_MODE_NONE)
+    return;
+
+  if (source->bwe.mode != sess->bwe_mode)
+    rtp_bwe_init (&source->bwe, sess->bwe_mode, sess->target_bitrate,
+        sess->min_bitrate, sess->max_bitrate);
+
+  rtp_source_get_last_rb (source, NULL, NULL, NULL, NULL, NULL, NULL,
+      &round_trip);
+  rtp_bwe_process_rb (&source->bwe, arrival->current_time, fractionlost,
+      jitter, sess->source->clock_rate, round_trip, sess->source->bitrate);
+
+  g_hash_table_foreach (sess->ssrcs[sess->mask_idx],
+      (GHFunc) find_min_bitrate, &bitrate);
+
+  if (bitrate != G_MAXUINT && bitrate != sess->target_bitrate) {
+    GST_DEBUG ("target bitrate %u -> %u", sess->target_bitrate, bitrate);
+    sess->target_bitrate = bitrate;
+    on_target_bitrate (sess, bitrate);
+  }
+}
+
 static void
 rtp_session_process_rb (RTPSession * sess, RTPSource * source,
     GstRTCPPacket * packet, RTPArrivalStats * arrival)
@@ -1869,6 +2025,7 @@ rtp_session_process_rb (RTPSession * sess, RTPSource * source,
        * the other sender to see if we are better or worse. */
       rtp_source_process_rb (source, arrival->ntpnstime, fractionlost,
           packetslost, exthighestseq, jitter, lsr, dlsr);
+      update_target_bitrate (sess, source, arrival, fractionlost, jitter);
     }
   }
   on_ssrc_active (sess, source);
@@ -2256,6 +2413,33 @@ rtp_session_process_fir (RTPSession * sess, guint32 sender_ssrc,
   rtp_session_request_local_key_unit (sess, src, TRUE, current_time);
 }
 
+static void
+rtp_session_process_nack (RTPSession * sess, guint32 sender_ssrc,
+    guint32 media_ssrc, guint8 * fci_data, guint fci_length,
+    GstClockTime current_time)
+{
+  if (!sess->callbacks.notify_nack)
+    return;
+
+  /* each FCI entry is a PID with a bitmask of following lost packets (BLP) */
+  while (fci_length >= 4) {
+    guint16 seqnum, blp;
+
+    seqnum = GST_READ_UINT16_BE (fci_data);
+    blp = GST_READ_UINT16_BE (fci_data + 2);
+
+    GST_DEBUG ("NACK #%u, blp %04x, SSRC 0x%08x", seqnum, blp, media_ssrc);
+
+    RTP_SESSION_UNLOCK (sess);
+    sess->callbacks.notify_nack (sess, seqnum, blp, media_ssrc,
+        sess->notify_nack_user_data);
+    RTP_SESSION_LOCK (sess);
+
+    fci_data += 4;
+    fci_length -= 4;
+  }
+}
+
 static void
 rtp_session_process_feedback (RTPSession * sess, GstRTCPPacket * packet,
     RTPArrivalStats * arrival, GstClockTime current_time)
@@ -2317,6 +2501,15 @@ rtp_session_process_feedback (RTPSession * sess, GstRTCPPacket * packet,
         }
         break;
       case GST_RTCP_TYPE_RTPFB:
+        switch (fbtype) {
+          case GST_RTCP_RTPFB_TYPE_NACK:
+            rtp_session_process_nack (sess, sender_ssrc, media_ssrc,
+                fci_data, fci_length, current_time);
+            break;
+          default:
+            break;
+        }
+        break;
       default:
         break;
     }
@@ -3336,6 +3529,45 @@ rtp_session_request_key_unit (RTPSession * sess, guint32 ssrc, GstClockTime now,
   return TRUE;
 }
 
+/**
+ * rtp_session_request_nack:
+ * @sess: a #RTPSession
+ * @ssrc: the SSRC
+ * @seqnum: the missing seqnum
+ * @now: the current time
+ * @max_delay: max delay to request NACK
+ *
+ * Request scheduling of a NACK feedback packet for @seqnum in @ssrc.
+ *
+ * Returns: %TRUE if the NACK feedback could be scheduled
+ */
+gboolean
+rtp_session_request_nack (RTPSession * sess, guint32 ssrc, guint16 seqnum,
+    GstClockTime now, GstClockTime max_delay)
+{
+  RTPSource *source;
+
+  RTP_SESSION_LOCK (sess);
+  source = g_hash_table_lookup (sess->ssrcs[sess->mask_idx],
+      GUINT_TO_POINTER (ssrc));
+  if (source == NULL)
+    goto no_source;
+
+  GST_DEBUG ("request NACK for %08x, #%u", ssrc, seqnum);
+  rtp_source_register_nack (source, seqnum);
+  RTP_SESSION_UNLOCK (sess);
+
+  rtp_session_request_early_rtcp (sess, now, max_delay);
+
+  return TRUE;
+
+no_source:
+  {
+    RTP_SESSION_UNLOCK (sess);
+    return FALSE;
+  }
+}
+
 static gboolean
 has_pli_compare_func (gconstpointer a, gconstpointer ignored)
 {
@@ -3356,6 +3588,68 @@ has_pli_compare_func (gconstpointer a, gconstpointer ignored)
   return ret;
 }
 
+/* Add a Generic NACK packet for the seqnums registered on @media_src. Seqnums
+ * within 16 packets of each other are folded into one PID/BLP pair. */
+static gboolean
+session_add_nack (RTPSession * sess, GstRTCPBuffer * rtcp, guint32 media_ssrc,
+    RTPSource * media_src)
+{
+  GstRTCPPacket nack;
+  guint16 *nacks;
+  guint n_nacks, i, n_fci;
+  guint8 *fci_data;
+
+  if (!gst_rtcp_buffer_add_packet (rtcp, GST_RTCP_TYPE_RTPFB, &nack))
+    return FALSE;
+
+  gst_rtcp_packet_fb_set_type (&nack, GST_RTCP_RTPFB_TYPE_NACK);
+  gst_rtcp_packet_fb_set_sender_ssrc (&nack,
+      rtp_source_get_ssrc (sess->source));
+  gst_rtcp_packet_fb_set_media_ssrc (&nack, media_ssrc);
+
+  nacks = rtp_source_get_nacks (media_src, &n_nacks);
+
+  /* first count the number of FCI entries we need */
+  n_fci = 0;
+  for (i = 0; i < n_nacks;) {
+    guint16 pid = nacks[i++];
+
+    while (i < n_nacks && gst_rtp_buffer_compare_seqnum (pid, nacks[i]) > 0
+        && gst_rtp_buffer_compare_seqnum (pid, nacks[i]) <= 16)
+      i++;
+    n_fci++;
+  }
+
+  if (!gst_rtcp_packet_fb_set_fci_length (&nack, n_fci)) {
+    gst_rtcp_packet_remove (&nack);
+    return FALSE;
+  }
+
+  fci_data = gst_rtcp_packet_fb_get_fci (&nack);
+  for (i = 0; i < n_nacks;) {
+    guint16 pid = nacks[i++];
+    guint16 blp = 0;
+    gint diff;
+
+    while (i < n_nacks) {
+      diff = gst_rtp_buffer_compare_seqnum (pid, nacks[i]);
+      if (diff <= 0 || diff > 16)
+        break;
+      blp |= 1 << (diff - 1);
+      i++;
+    }
+    GST_DEBUG ("sending NACK #%u, blp %04x, SSRC 0x%08x", pid, blp,
+        media_ssrc);
+
+    GST_WRITE_UINT16_BE (fci_data, pid);
+    GST_WRITE_UINT16_BE (fci_data + 2, blp);
+    fci_data += 4;
+  }
+  rtp_source_clear_nacks (media_src);
+
+  return TRUE;
+}
+
 static gboolean
 rtp_session_on_sending_rtcp (RTPSession * sess, GstBuffer * buffer,
     gboolean early)
@@ -3431,6 +3725,20 @@ rtp_session_on_sending_rtcp (RTPSession * sess, GstBuffer * buffer,
     }
     media_src->send_pli = FALSE;
   }
+
+  g_hash_table_iter_init (&iter, sess->ssrcs[sess->mask_idx]);
+  while (g_hash_table_iter_next (&iter, &key, &value)) {
+    guint media_ssrc = GPOINTER_TO_UINT (key);
+    RTPSource *media_src = value;
+
+    if (media_src->nacks->len > 0) {
+      if (!session_add_nack (sess, &rtcp, media_ssrc, media_src))
+        /* Break because the packet is full, remaining NACKs go in a
+         * further packet */
+        break;
+      ret = TRUE;
+    }
+  }
   gst_rtcp_buffer_unmap (&rtcp);
 
   RTP_SESSION_UNLOCK (sess);
@@ -143,6 +143,19 @@ typedef void (*RTPSessionRequestKeyUnit) (RTPSession *sess,
 typedef GstClockTime (*RTPSessionRequestTime) (RTPSession *sess,
     gpointer user_data);
 
+/**
+ * RTPSessionNotifyNACK:
+ * @sess: an #RTPSession
+ * @seqnum: the missing seqnum
+ * @blp: other missing seqnums
+ * @ssrc: SSRC of requested stream
+ * @user_data: user data specified when registering
+ *
+ * Notifies of NACKed frames.
+ */
+typedef void (*RTPSessionNotifyNACK) (RTPSession *sess,
+    guint16 seqnum, guint16 blp, guint32 ssrc, gpointer user_data);
+
 /**
  * RTPSessionCallbacks:
  * @RTPSessionProcessRTP: callback to process RTP packets
@@ -151,6 +164,7 @@ typedef GstClockTime (*RTPSessionRequestTime) (RTPSession *sess,
  * @RTPSessionSyncRTCP: callback for handling SR packets
  * @RTPSessionReconsider: callback for reconsidering the timeout
  * @RTPSessionRequestKeyUnit: callback for requesting a new key unit
+ * @RTPSessionNotifyNACK: callback for notifying NACK
  *
  * These callbacks can be installed on the session manager to get notification
  * when RTP and RTCP packets are ready for further processing. These callbacks
@@ -165,6 +179,7 @@ typedef struct {
   RTPSessionReconsider  reconsider;
   RTPSessionRequestKeyUnit request_key_unit;
   RTPSessionRequestTime request_time;
+  RTPSessionNotifyNACK  notify_nack;
 } RTPSessionCallbacks;
 
 /**
@@ -228,6 +243,7 @@ struct _RTPSession {
   gpointer              reconsider_user_data;
   gpointer              request_key_unit_user_data;
   gpointer              request_time_user_data;
+  gpointer              notify_nack_user_data;
 
   RTPSessionStats stats;
 
@@ -238,6 +254,13 @@ struct _RTPSession {
 
   GstClockTime last_keyframe_request;
   gboolean     last_keyframe_all_headers;
+
+  /* bandwidth estimation */
+  RTPBweMode    bwe_mode;
+  guint         start_bitrate;
+  guint         min_bitrate;
+  guint         max_bitrate;
+  guint         target_bitrate;
 };
 
 /**
@@ -268,6 +291,7 @@ struct _RTPSessionClass {
   void (*on_feedback_rtcp)  (RTPSession *sess, guint type, guint fbtype,
       guint sender_ssrc, guint media_ssrc, GstBuffer *fci);
   void (*send_rtcp)         (RTPSession *sess, GstClockTimeDiff max_delay);
+  void (*on_target_bitrate) (RTPSession *sess, guint bitrate);
 };
 
 GType rtp_session_get_type (void);
@@ -357,4 +381,11 @@ gboolean        rtp_session_request_key_unit       (RTPSession * sess,
                                                     gboolean fir,
                                                     gint count);
 
+/* Notify session of a lost packet that should be retransmitted */
+gboolean        rtp_session_request_nack           (RTPSession * sess,
+                                                    guint32 ssrc,
+                                                    guint16 seqnum,
+                                                    GstClockTime now,
+                                                    GstClockTime max_delay);
+
 #endif /* __RTP_SESSION_H__ */
@@ -195,6 +195,11 @@ rtp_source_class_init (RTPSourceClass * klass)
    * non-internal sources.
    *
    *  "rb-round-trip"    G_TYPE_UINT     the round trip time in nanoseconds
+   *
+   * The target bitrate for our stream estimated from the RB packets of this
+   * source. Only present when bandwidth estimation is enabled on the session.
+   *
+   *  "bwe-bitrate"      G_TYPE_UINT     target bitrate in bits per second
    */
   g_object_class_install_property (gobject_class, PROP_STATS,
       g_param_spec_boxed ("stats", "Stats",
@@ -248,6 +253,9 @@ rtp_source_init (RTPSource * src)
   src->last_rtptime = -1;
 
   src->retained_feedback = g_queue_new ();
+  src->nacks = g_array_new (FALSE, FALSE, sizeof (guint16));
+  rtp_bwe_init (&src->bwe, RTP_BWE_MODE_NONE, RTP_BWE_DEFAULT_START_BITRATE,
+      RTP_BWE_DEFAULT_MIN_BITRATE, RTP_BWE_DEFAULT_MAX_BITRATE);
 
   rtp_source_reset (src);
 }
@@ -285,6 +293,8 @@ rtp_source_finalize (GObject * object)
     gst_buffer_unref (buffer);
   g_queue_free (src->retained_feedback);
 
+  g_array_free (src->nacks, TRUE);
+
   if (src->rtp_from)
     g_object_unref (src->rtp_from);
   if (src->rtcp_from)
@@ -384,6 +394,10 @@ rtp_source_create_stats (RTPSource * src)
         "rb-lsr", G_TYPE_UINT, (guint) lsr,
         "rb-dlsr", G_TYPE_UINT, (guint) dlsr,
         "rb-round-trip", G_TYPE_UINT, (guint) round_trip, NULL);
+
+    if (src->bwe.have_report)
+      gst_structure_set (s,
+          "bwe-bitrate", G_TYPE_UINT, src->bwe.bitrate, NULL);
   }
 
   return s;
@@ -1872,3 +1886,54 @@ rtp_source_has_retained (RTPSource * src, GCompareFunc func, gconstpointer data)
   else
     return FALSE;
 }
+
+/**
+ * rtp_source_register_nack:
+ * @src: The #RTPSource
+ * @seqnum: a seqnum
+ *
+ * Register that @seqnum has not been received from @src. The seqnum will be
+ * reported in the next Generic NACK feedback packet for @src.
+ */
+void
+rtp_source_register_nack (RTPSource * src, guint16 seqnum)
+{
+  guint i;
+
+  /* don't request the same packet twice in one feedback message */
+  for (i = 0; i < src->nacks->len; i++) {
+    if (g_array_index (src->nacks, guint16, i) == seqnum)
+      return;
+  }
+  g_array_append_val (src->nacks, seqnum);
+}
+
+/**
+ * rtp_source_get_nacks:
+ * @src: The #RTPSource
+ * @n_nacks: result number of nacks
+ *
+ * Get the registered NACKS since the last rtp_source_clear_nacks().
+ *
+ * Returns: an array of @n_nacks seqnum values.
+ */
+guint16 *
+rtp_source_get_nacks (RTPSource * src, guint * n_nacks)
+{
+  if (n_nacks)
+    *n_nacks = src->nacks->len;
+
+  return (guint16 *) src->nacks->data;
+}
+
+/**
+ * rtp_source_clear_nacks:
+ * @src: The #RTPSource
+ *
+ * Clear the list of registered NACKs.
+ */
+void
+rtp_source_clear_nacks (RTPSource * src)
+{
+  g_array_set_size (src->nacks, 0);
+}
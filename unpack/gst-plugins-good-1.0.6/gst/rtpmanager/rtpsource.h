@@ -26,6 +26,7 @@
 #include <gio/gio.h>
 
 #include "rtpstats.h"
+#include "rtpbwe.h"
 
 /* the default number of consecutive RTP packets we need to receive before the
  * source is considered valid */
@@ -177,6 +178,11 @@ struct _RTPSource {
   gboolean     send_fir;
   guint8       current_send_fir_seqnum;
   gint         last_fir_count;
+
+  GArray      *nacks;
+
+  /* bandwidth estimation for our stream from the reports of this source */
+  RTPBandwidthEstimator bwe;
 };
 
 struct _RTPSourceClass {
@@ -266,5 +272,10 @@ gboolean        rtp_source_has_retained        (RTPSource * src,
                                                 GCompareFunc func,
                                                 gconstpointer data);
 
+void            rtp_source_register_nack       (RTPSource * src,
+                                                guint16 seqnum);
+guint16 *       rtp_source_get_nacks           (RTPSource * src, guint *n_nacks);
+void            rtp_source_clear_nacks         (RTPSource * src);
+
 
 #endif /* __RTP_SOURCE_H__ */
@@ -1767,6 +1767,21 @@ gst_rtspsrc_connection_receive (GstRTSPSrc * src, GstRTSPConnection * conn,
   return ret;
 }
 
+static GstRTSPResult
+gst_rtspsrc_connection_receive_data (GstRTSPSrc * src,
+    GstRTSPConnection * conn, guint8 * channel, GstBuffer ** buffer,
+    GTimeVal * timeout)
+{
+  GstRTSPResult ret;
+
+  if (conn)
+    ret = gst_rtsp_connection_receive_data (conn, channel, buffer, timeout);
+  else
+    ret = GST_RTSP_ERROR;
+
+  return ret;
+}
+
 static void
 gst_rtspsrc_get_position (GstRTSPSrc * src)
 {
@@ -3575,8 +3590,9 @@ gst_rtspsrc_loop_interleaved (GstRTSPSrc * src)
   GstPad *outpad = NULL;
   guint8 *data;
   guint size;
+  guint8 type, data_channel;
   GstFlowReturn ret = GST_FLOW_OK;
-  GstBuffer *buf;
+  GstBuffer *buf = NULL;
   gboolean is_rtcp, have_data;
   GstEvent *event;
 
@@ -3602,11 +3618,23 @@ gst_rtspsrc_loop_interleaved (GstRTSPSrc * src)
     GST_DEBUG_OBJECT (src, "doing receive with timeout %ld seconds, %ld usec",
         tv_timeout.tv_sec, tv_timeout.tv_usec);
 
+    /* data messages are taken directly from the receive buffer of the
+     * connection, other messages are parsed into a message below */
+    res =
+        gst_rtspsrc_connection_receive_data (src, src->conninfo.connection,
+        &data_channel, &buf, src->ptcp_timeout);
+    if (res == GST_RTSP_OK && buf != NULL) {
+      channel = data_channel;
+      have_data = TRUE;
+      break;
+    }
+
     /* protect the connection with the connection lock so that we can see when
      * we are finished doing server communication */
-    res =
-        gst_rtspsrc_connection_receive (src, src->conninfo.connection,
-        &message, src->ptcp_timeout);
+    if (res == GST_RTSP_OK)
+      res =
+          gst_rtspsrc_connection_receive (src, src->conninfo.connection,
+          &message, src->ptcp_timeout);
 
     switch (res) {
       case GST_RTSP_OK:
@@ -3647,6 +3675,17 @@ gst_rtspsrc_loop_interleaved (GstRTSPSrc * src)
         break;
       case GST_RTSP_MESSAGE_DATA:
         GST_DEBUG_OBJECT (src, "got data message");
+        channel = message.type_data.data.channel;
+
+        /* take the message body for further processing */
+        gst_rtsp_message_steal_body (&message, &data, &size);
+
+        /* strip the trailing \0 */
+        size -= 1;
+
+        buf = gst_buffer_new ();
+        gst_buffer_append_memory (buf,
+            gst_memory_new_wrapped (0, data, size, 0, size, data, g_free));
         have_data = TRUE;
         break;
       default:
@@ -3654,11 +3693,11 @@ gst_rtspsrc_loop_interleaved (GstRTSPSrc * src)
             message.type);
         break;
     }
+    /* don't need message anymore */
+    gst_rtsp_message_unset (&message);
   }
   while (!have_data);
 
-  channel = message.type_data.data.channel;
-
   stream = find_stream (src, &channel, (gpointer) find_stream_by_channel);
   if (!stream)
     goto unknown_stream;
@@ -3673,13 +3712,14 @@ gst_rtspsrc_loop_interleaved (GstRTSPSrc * src)
     is_rtcp = FALSE;
   }
 
-  /* take a look at the body to figure out what we have */
-  gst_rtsp_message_get_body (&message, &data, &size);
+  /* take a look at the payload type to figure out what we have */
+  size = gst_buffer_get_size (buf);
   if (size < 2)
     goto invalid_length;
+  gst_buffer_extract (buf, 1, &type, 1);
 
   /* channels are not correct on some servers, do extra check */
-  if (data[1] >= 200 && data[1] <= 204) {
+  if (type >= 200 && type <= 204) {
     /* hmm RTCP message switch to the RTCP pad of the same stream. */
     outpad = stream->channelpad[1];
     is_rtcp = TRUE;
@@ -3689,19 +3729,6 @@ gst_rtspsrc_loop_interleaved (GstRTSPSrc * src)
   if (outpad == NULL)
     goto unknown_stream;
 
-  /* take the message body for further processing */
-  gst_rtsp_message_steal_body (&message, &data, &size);
-
-  /* strip the trailing \0 */
-  size -= 1;
-
-  buf = gst_buffer_new ();
-  gst_buffer_append_memory (buf,
-      gst_memory_new_wrapped (0, data, size, 0, size, data, g_free));
-
-  /* don't need message anymore */
-  gst_rtsp_message_unset (&message);
-
   GST_DEBUG_OBJECT (src, "pushing data of size %d on channel %d", size,
       channel);
 
@@ -3766,7 +3793,7 @@ gst_rtspsrc_loop_interleaved (GstRTSPSrc * src)
 unknown_stream:
   {
     GST_DEBUG_OBJECT (src, "unknown stream on channel %d, ignored", channel);
-    gst_rtsp_message_unset (&message);
+    gst_buffer_unref (buf);
     return GST_FLOW_OK;
   }
 server_eof:
@@ -3810,7 +3837,7 @@ invalid_length:
   {
     GST_ELEMENT_WARNING (src, RESOURCE, READ, (NULL),
         ("Short message received, ignoring."));
-    gst_rtsp_message_unset (&message);
+    gst_buffer_unref (buf);
     return GST_FLOW_OK;
   }
 }
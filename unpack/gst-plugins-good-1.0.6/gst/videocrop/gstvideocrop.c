@@ -33,6 +33,14 @@
  *
  * If there is nothing to crop, the element will operate in pass-through mode.
  *
+ * When downstream supports #GstVideoMeta, the pixels are not copied at all:
+ * if downstream also supports #GstVideoCropMeta, the input buffer is pushed
+ * with a crop meta describing the visible region, otherwise the plane offsets
+ * of the #GstVideoMeta are moved to the first visible pixel. The latter is
+ * only possible when the left and top crop values fall on a chroma sample of
+ * the format. In all other cases the visible part of the picture is copied
+ * into a new buffer.
+ *
  * Note that no special efforts are made to handle chroma-subsampled formats
  * in the case of odd-valued cropping and compensate for sub-unit chroma plane
  * shifts for such formats in the case where the #GstVideoCrop:left or
@@ -47,12 +55,6 @@
  * </refsect2>
  */
 
-/* TODO:
- *  - for packed formats, we could avoid memcpy() in case crop_left
- *    and crop_right are 0 and just create a sub-buffer of the input
- *    buffer
- */
-
 #ifdef HAVE_CONFIG_H
 #include "config.h"
 #endif
@@ -108,6 +110,12 @@ static GstCaps *gst_video_crop_transform_caps (GstBaseTransform * trans,
     GstPadDirection direction, GstCaps * caps, GstCaps * filter_caps);
 static gboolean gst_video_crop_src_event (GstBaseTransform * trans,
     GstEvent * event);
+static gboolean gst_video_crop_decide_allocation (GstBaseTransform * trans,
+    GstQuery * query);
+static GstFlowReturn gst_video_crop_prepare_output_buffer (GstBaseTransform *
+    trans, GstBuffer * inbuf, GstBuffer ** outbuf);
+static GstFlowReturn gst_video_crop_transform (GstBaseTransform * trans,
+    GstBuffer * inbuf, GstBuffer * outbuf);
 
 static gboolean gst_video_crop_set_info (GstVideoFilter * vfilter, GstCaps * in,
     GstVideoInfo * in_info, GstCaps * out, GstVideoInfo * out_info);
@@ -203,6 +211,12 @@ gst_video_crop_class_init (GstVideoCropClass * klass)
   basetransform_class->transform_caps =
       GST_DEBUG_FUNCPTR (gst_video_crop_transform_caps);
   basetransform_class->src_event = GST_DEBUG_FUNCPTR (gst_video_crop_src_event);
+  basetransform_class->decide_allocation =
+      GST_DEBUG_FUNCPTR (gst_video_crop_decide_allocation);
+  basetransform_class->prepare_output_buffer =
+      GST_DEBUG_FUNCPTR (gst_video_crop_prepare_output_buffer);
+  basetransform_class->transform =
+      GST_DEBUG_FUNCPTR (gst_video_crop_transform);
 
   vfilter_class->set_info = GST_DEBUG_FUNCPTR (gst_video_crop_set_info);
   vfilter_class->transform_frame =
@@ -216,6 +230,8 @@ gst_video_crop_init (GstVideoCrop * vcrop)
   vcrop->crop_left = 0;
   vcrop->crop_top = 0;
   vcrop->crop_bottom = 0;
+  vcrop->downstream_video_meta = FALSE;
+  vcrop->downstream_crop_meta = FALSE;
 
   g_mutex_init (&vcrop->lock);
 }
@@ -394,6 +410,167 @@ gst_video_crop_transform_frame (GstVideoFilter * vfilter,
   return GST_FLOW_OK;
 }
 
+static gboolean
+gst_video_crop_decide_allocation (GstBaseTransform * trans, GstQuery * query)
+{
+  GstVideoCrop *vcrop = GST_VIDEO_CROP (trans);
+  gboolean video_meta, crop_meta;
+
+  video_meta = gst_query_find_allocation_meta (query, GST_VIDEO_META_API_TYPE,
+      NULL);
+  crop_meta = video_meta && gst_query_find_allocation_meta (query,
+      GST_VIDEO_CROP_META_API_TYPE, NULL);
+
+  GST_DEBUG_OBJECT (vcrop, "downstream video meta %d, crop meta %d",
+      video_meta, crop_meta);
+
+  g_mutex_lock (&vcrop->lock);
+  vcrop->downstream_video_meta = video_meta;
+  vcrop->downstream_crop_meta = crop_meta;
+  g_mutex_unlock (&vcrop->lock);
+
+  return GST_BASE_TRANSFORM_CLASS (parent_class)->decide_allocation (trans,
+      query);
+}
+
+/* called with the lock */
+static VideoCropMode
+gst_video_crop_get_mode (GstVideoCrop * vcrop)
+{
+  if (!vcrop->downstream_video_meta)
+    return VIDEO_CROP_MODE_COPY;
+
+  if (vcrop->downstream_crop_meta)
+    return VIDEO_CROP_MODE_CROP_META;
+
+  /* the offsets can only point at a whole macro-pixel and chroma sample */
+  switch (vcrop->packing) {
+    case VIDEO_CROP_PIXEL_FORMAT_PACKED_SIMPLE:
+      return VIDEO_CROP_MODE_VIDEO_META;
+    case VIDEO_CROP_PIXEL_FORMAT_PACKED_COMPLEX:
+      if ((vcrop->crop_left % 2) == 0)
+        return VIDEO_CROP_MODE_VIDEO_META;
+      break;
+    case VIDEO_CROP_PIXEL_FORMAT_PLANAR:
+      if ((vcrop->crop_left % 2) == 0 && (vcrop->crop_top % 2) == 0)
+        return VIDEO_CROP_MODE_VIDEO_META;
+      break;
+    default:
+      break;
+  }
+  return VIDEO_CROP_MODE_COPY;
+}
+
+/* makes sure @buffer has a video meta describing the complete input frame */
+static GstVideoMeta *
+gst_video_crop_ensure_video_meta (GstVideoCrop * vcrop, GstBuffer * buffer)
+{
+  GstVideoInfo *info = &GST_VIDEO_FILTER (vcrop)->in_info;
+  GstVideoMeta *meta;
+
+  meta = gst_buffer_get_video_meta (buffer);
+  if (meta == NULL) {
+    meta = gst_buffer_add_video_meta_full (buffer, GST_VIDEO_FRAME_FLAG_NONE,
+        GST_VIDEO_INFO_FORMAT (info), GST_VIDEO_INFO_WIDTH (info),
+        GST_VIDEO_INFO_HEIGHT (info), GST_VIDEO_INFO_N_PLANES (info),
+        info->offset, info->stride);
+  }
+  return meta;
+}
+
+/* called with the lock */
+static void
+gst_video_crop_apply_video_meta (GstVideoCrop * vcrop, GstBuffer * buffer)
+{
+  GstVideoInfo *out_info = &GST_VIDEO_FILTER (vcrop)->out_info;
+  const GstVideoFormatInfo *finfo = out_info->finfo;
+  GstVideoMeta *meta;
+  guint i;
+
+  meta = gst_video_crop_ensure_video_meta (vcrop, buffer);
+
+  /* the formats we handle have one component per plane, or only one plane */
+  for (i = 0; i < meta->n_planes; i++) {
+    meta->offset[i] +=
+        GST_VIDEO_FORMAT_INFO_SCALE_HEIGHT (finfo, i, vcrop->crop_top) *
+        meta->stride[i] +
+        GST_VIDEO_FORMAT_INFO_SCALE_WIDTH (finfo, i, vcrop->crop_left) *
+        GST_VIDEO_FORMAT_INFO_PSTRIDE (finfo, i);
+  }
+  meta->width = GST_VIDEO_INFO_WIDTH (out_info);
+  meta->height = GST_VIDEO_INFO_HEIGHT (out_info);
+}
+
+/* called with the lock */
+static void
+gst_video_crop_apply_crop_meta (GstVideoCrop * vcrop, GstBuffer * buffer)
+{
+  GstVideoInfo *out_info = &GST_VIDEO_FILTER (vcrop)->out_info;
+  GstVideoCropMeta *crop;
+
+  gst_video_crop_ensure_video_meta (vcrop, buffer);
+
+  /* upstream might have cropped already, add our region to it */
+  crop = gst_buffer_get_video_crop_meta (buffer);
+  if (crop == NULL) {
+    crop = gst_buffer_add_video_crop_meta (buffer);
+    crop->x = 0;
+    crop->y = 0;
+  }
+  crop->x += vcrop->crop_left;
+  crop->y += vcrop->crop_top;
+  crop->width = GST_VIDEO_INFO_WIDTH (out_info);
+  crop->height = GST_VIDEO_INFO_HEIGHT (out_info);
+}
+
+static GstFlowReturn
+gst_video_crop_prepare_output_buffer (GstBaseTransform * trans,
+    GstBuffer * inbuf, GstBuffer ** outbuf)
+{
+  GstVideoCrop *vcrop = GST_VIDEO_CROP (trans);
+  VideoCropMode mode;
+
+  if (gst_base_transform_is_passthrough (trans) ||
+      gst_buffer_n_memory (inbuf) == 0)
+    goto copy;
+
+  g_mutex_lock (&vcrop->lock);
+  mode = gst_video_crop_get_mode (vcrop);
+  if (mode == VIDEO_CROP_MODE_COPY) {
+    g_mutex_unlock (&vcrop->lock);
+    goto copy;
+  }
+
+  /* a new buffer sharing the memory of the input, only the metadata is
+   * changed so no pixel is touched */
+  *outbuf = gst_buffer_copy (inbuf);
+  if (mode == VIDEO_CROP_MODE_CROP_META)
+    gst_video_crop_apply_crop_meta (vcrop, *outbuf);
+  else
+    gst_video_crop_apply_video_meta (vcrop, *outbuf);
+  g_mutex_unlock (&vcrop->lock);
+
+  GST_LOG_OBJECT (vcrop, "cropped without copy, mode %d", mode);
+
+  return GST_FLOW_OK;
+
+copy:
+  return GST_BASE_TRANSFORM_CLASS (parent_class)->prepare_output_buffer (trans,
+      inbuf, outbuf);
+}
+
+static GstFlowReturn
+gst_video_crop_transform (GstBaseTransform * trans, GstBuffer * inbuf,
+    GstBuffer * outbuf)
+{
+  /* prepare_output_buffer already cropped by sharing the input memory */
+  if (gst_buffer_peek_memory (outbuf, 0) == gst_buffer_peek_memory (inbuf, 0))
+    return GST_FLOW_OK;
+
+  return GST_BASE_TRANSFORM_CLASS (parent_class)->transform (trans, inbuf,
+      outbuf);
+}
+
 static gint
 gst_video_crop_transform_dimension (gint val, gint delta)
 {
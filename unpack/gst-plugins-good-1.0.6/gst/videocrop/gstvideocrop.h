@@ -41,6 +41,12 @@ typedef enum {
   VIDEO_CROP_PIXEL_FORMAT_PLANAR              /* I420, YV12 */
 } VideoCropPixelFormat;
 
+typedef enum {
+  VIDEO_CROP_MODE_COPY = 0,       /* copy the visible rows */
+  VIDEO_CROP_MODE_VIDEO_META,     /* move the GstVideoMeta plane offsets */
+  VIDEO_CROP_MODE_CROP_META       /* attach a GstVideoCropMeta */
+} VideoCropMode;
+
 typedef struct _GstVideoCropImageDetails GstVideoCropImageDetails;
 
 typedef struct _GstVideoCrop GstVideoCrop;
@@ -59,6 +65,10 @@ struct _GstVideoCrop
   VideoCropPixelFormat  packing;
   gint macro_y_off;
 
+  /* what downstream told us in the allocation query */
+  gboolean downstream_video_meta;
+  gboolean downstream_crop_meta;
+
   GMutex lock;
 };
 
@@ -76,6 +76,15 @@
  *   timeoverlay ! queue2 ! mixer.
  * ]| A pipeline to demonstrate synchronized mixing (the second stream starts after 3 seconds)
  * </refsect2>
+ *
+ * The output frame is blended in tiles of 64x64 pixels. With
+ * #GstVideoMixer2:n-threads larger than 1 the tiles are shared between the
+ * streaming thread and a set of worker threads. With
+ * #GstVideoMixer2:damage-tracking enabled, only the tiles covered by an input
+ * that got a new buffer, moved, resized, changed alpha, appeared or
+ * disappeared since the previous output frame are blended again, the other
+ * tiles are copied from the previous output frame, and when nothing changed
+ * at all the previous frame is pushed again without copying.
  */
 
 #ifdef HAVE_CONFIG_H
@@ -143,8 +152,46 @@ struct _GstVideoMixer2Collect
   GstBuffer *buffer;            /* buffer that should be blended now */
   GstClockTime start_time;
   GstClockTime end_time;
+
+  /* damage tracking: whether buffer changed and what was blended in the
+   * previous output frame */
+  gboolean new_buffer;
+  gboolean blended;
+  gint blend_xpos, blend_ypos;
+  gint blend_width, blend_height;
+  gdouble blend_alpha;
 };
 
+/* a pad to blend in the current output frame */
+typedef struct
+{
+  GstVideoFrame frame;
+  gint xpos, ypos;
+  gint width, height;
+  gdouble alpha;
+} GstVideoMixer2Input;
+
+/* the blending of one output frame, shared by all threads */
+typedef struct
+{
+  GstVideoMixer2 *mix;
+
+  GstVideoFrame *outframe;
+  GstVideoFrame *prevframe;
+
+  GstVideoMixer2Input *inputs;
+  guint n_inputs;
+
+  GstVideoMixer2Background background;
+  BlendFunction composite;
+
+  const guint8 *damage;
+  gint n_tiles;
+  volatile gint next_tile;
+} GstVideoMixer2Job;
+
+#define TILE_SIZE 64
+
 #define DEFAULT_PAD_ZORDER 0
 #define DEFAULT_PAD_XPOS   0
 #define DEFAULT_PAD_YPOS   0
@@ -484,6 +531,7 @@ gst_videomixer2_pad_set_property (GObject * object, guint prop_id,
 
       mix->sinkpads = g_slist_sort (mix->sinkpads,
           (GCompareFunc) pad_zorder_compare);
+      mix->damage_all = TRUE;
       GST_VIDEO_MIXER2_UNLOCK (mix);
       break;
     case PROP_PAD_XPOS:
@@ -540,10 +588,14 @@ gst_videomixer2_pad_init (GstVideoMixer2Pad * mixerpad)
 
 /* GstVideoMixer2 */
 #define DEFAULT_BACKGROUND VIDEO_MIXER2_BACKGROUND_CHECKER
+#define DEFAULT_N_THREADS 1
+#define DEFAULT_DAMAGE_TRACKING FALSE
 enum
 {
   PROP_0,
-  PROP_BACKGROUND
+  PROP_BACKGROUND,
+  PROP_N_THREADS,
+  PROP_DAMAGE_TRACKING
 };
 
 #define GST_TYPE_VIDEO_MIXER2_BACKGROUND (gst_videomixer2_background_get_type())
@@ -636,10 +688,14 @@ gst_videomixer2_reset (GstVideoMixer2 * mix)
     gst_buffer_replace (&mixcol->buffer, NULL);
     mixcol->start_time = -1;
     mixcol->end_time = -1;
+    mixcol->blended = FALSE;
 
     gst_video_info_init (&p->info);
   }
 
+  gst_buffer_replace (&mix->last_outbuf, NULL);
+  mix->damage_all = TRUE;
+
   mix->newseg_pending = TRUE;
   mix->flush_stop_pending = FALSE;
 }
@@ -760,6 +816,7 @@ gst_videomixer2_fill_queues (GstVideoMixer2 * mix,
         gst_buffer_replace (&mixcol->buffer, buf);
         mixcol->start_time = start_time;
         mixcol->end_time = end_time;
+        mixcol->new_buffer = TRUE;
 
         if (buf == mixcol->queued) {
           gst_buffer_unref (buf);
@@ -812,93 +869,356 @@ gst_videomixer2_fill_queues (GstVideoMixer2 * mix,
   return 1;
 }
 
-static GstFlowReturn
-gst_videomixer2_blend_buffers (GstVideoMixer2 * mix,
-    GstClockTime output_start_time, GstClockTime output_end_time,
-    GstBuffer ** outbuf)
+/* the number of threads to blend the next frame with */
+static guint
+gst_videomixer2_get_n_threads (GstVideoMixer2 * mix)
 {
-  GSList *l;
-  guint outsize;
-  BlendFunction composite;
-  GstVideoFrame outframe;
-  static GstAllocationParams params = { 0, 15, 0, 0, };
+  guint n_threads;
 
-  outsize = GST_VIDEO_INFO_SIZE (&mix->info);
+  GST_OBJECT_LOCK (mix);
+  n_threads = mix->n_threads;
+  mix->n_threads_changed = FALSE;
+  GST_OBJECT_UNLOCK (mix);
 
-  *outbuf = gst_buffer_new_allocate (NULL, outsize, &params);
-  GST_BUFFER_TIMESTAMP (*outbuf) = output_start_time;
-  GST_BUFFER_DURATION (*outbuf) = output_end_time - output_start_time;
+  if (n_threads == 0)
+    n_threads = gst_worker_pool_get_n_cpus ();
+  return CLAMP (n_threads, 1, VIDEO_MIXER2_MAX_THREADS);
+}
 
-  gst_video_frame_map (&outframe, &mix->info, *outbuf, GST_MAP_READWRITE);
+/* makes @sub a view on the @width x @height rectangle of @frame at @x,@y.
+ * @x and @y are multiples of TILE_SIZE so that they fall on a whole
+ * macro-pixel, chroma sample and square of the checker pattern */
+static void
+gst_videomixer2_sub_frame (const GstVideoFrame * frame, gint x, gint y,
+    gint width, gint height, GstVideoFrame * sub)
+{
+  const GstVideoFormatInfo *finfo = frame->info.finfo;
+  guint c, plane, done = 0;
+
+  *sub = *frame;
+  sub->info.width = width;
+  sub->info.height = height;
 
-  /* default to blending */
-  composite = mix->blend;
-  switch (mix->background) {
+  for (c = 0; c < GST_VIDEO_FORMAT_INFO_N_COMPONENTS (finfo); c++) {
+    plane = GST_VIDEO_FORMAT_INFO_PLANE (finfo, c);
+    if (done & (1 << plane))
+      continue;
+    done |= 1 << plane;
+
+    sub->data[plane] = (guint8 *) frame->data[plane] +
+        GST_VIDEO_FORMAT_INFO_SCALE_HEIGHT (finfo, c, y) *
+        GST_VIDEO_FRAME_PLANE_STRIDE (frame, plane) +
+        GST_VIDEO_FORMAT_INFO_SCALE_WIDTH (finfo, c, x) *
+        GST_VIDEO_FORMAT_INFO_PSTRIDE (finfo, c);
+  }
+}
+
+static void
+gst_videomixer2_copy_frame (const GstVideoFrame * src, GstVideoFrame * dest)
+{
+  const GstVideoFormatInfo *finfo = dest->info.finfo;
+  guint c, plane, done = 0;
+  gint i, rowsize, height;
+
+  for (c = 0; c < GST_VIDEO_FORMAT_INFO_N_COMPONENTS (finfo); c++) {
+    const guint8 *s;
+    guint8 *d;
+
+    plane = GST_VIDEO_FORMAT_INFO_PLANE (finfo, c);
+    if (done & (1 << plane))
+      continue;
+    done |= 1 << plane;
+
+    s = src->data[plane];
+    d = dest->data[plane];
+    rowsize = GST_VIDEO_FRAME_COMP_WIDTH (dest, c) *
+        GST_VIDEO_FRAME_COMP_PSTRIDE (dest, c);
+    height = GST_VIDEO_FRAME_COMP_HEIGHT (dest, c);
+    for (i = 0; i < height; i++) {
+      memcpy (d, s, rowsize);
+      s += GST_VIDEO_FRAME_PLANE_STRIDE (src, plane);
+      d += GST_VIDEO_FRAME_PLANE_STRIDE (dest, plane);
+    }
+  }
+}
+
+static void
+gst_videomixer2_fill_background (GstVideoMixer2 * mix,
+    GstVideoMixer2Background background, GstVideoFrame * frame)
+{
+  switch (background) {
     case VIDEO_MIXER2_BACKGROUND_CHECKER:
-      mix->fill_checker (&outframe);
+      mix->fill_checker (frame);
       break;
     case VIDEO_MIXER2_BACKGROUND_BLACK:
-      mix->fill_color (&outframe, 16, 128, 128);
+      mix->fill_color (frame, 16, 128, 128);
       break;
     case VIDEO_MIXER2_BACKGROUND_WHITE:
-      mix->fill_color (&outframe, 240, 128, 128);
+      mix->fill_color (frame, 240, 128, 128);
       break;
     case VIDEO_MIXER2_BACKGROUND_TRANSPARENT:
     {
       guint i, plane, num_planes, height;
 
-      num_planes = GST_VIDEO_FRAME_N_PLANES (&outframe);
+      num_planes = GST_VIDEO_FRAME_N_PLANES (frame);
       for (plane = 0; plane < num_planes; ++plane) {
         guint8 *pdata;
         gsize rowsize, plane_stride;
 
-        pdata = GST_VIDEO_FRAME_PLANE_DATA (&outframe, plane);
-        plane_stride = GST_VIDEO_FRAME_PLANE_STRIDE (&outframe, plane);
-        rowsize = GST_VIDEO_FRAME_COMP_WIDTH (&outframe, plane)
-            * GST_VIDEO_FRAME_COMP_PSTRIDE (&outframe, plane);
-        height = GST_VIDEO_FRAME_COMP_HEIGHT (&outframe, plane);
+        pdata = GST_VIDEO_FRAME_PLANE_DATA (frame, plane);
+        plane_stride = GST_VIDEO_FRAME_PLANE_STRIDE (frame, plane);
+        rowsize = GST_VIDEO_FRAME_COMP_WIDTH (frame, plane)
+            * GST_VIDEO_FRAME_COMP_PSTRIDE (frame, plane);
+        height = GST_VIDEO_FRAME_COMP_HEIGHT (frame, plane);
         for (i = 0; i < height; ++i) {
           memset (pdata, 0, rowsize);
           pdata += plane_stride;
         }
       }
-
-      /* use overlay to keep background transparent */
-      composite = mix->overlay;
       break;
     }
   }
+}
+
+static void
+gst_videomixer2_blend_tile (GstVideoMixer2 * mix, GstVideoMixer2Job * job,
+    gint tile)
+{
+  GstVideoFrame *outframe = job->outframe;
+  GstVideoFrame dest;
+  gint x, y, width, height;
+  guint i;
+
+  x = (tile % mix->tiles_x) * TILE_SIZE;
+  y = (tile / mix->tiles_x) * TILE_SIZE;
+  width = MIN (TILE_SIZE, GST_VIDEO_FRAME_WIDTH (outframe) - x);
+  height = MIN (TILE_SIZE, GST_VIDEO_FRAME_HEIGHT (outframe) - y);
+
+  gst_videomixer2_sub_frame (outframe, x, y, width, height, &dest);
+
+  if (!job->damage[tile]) {
+    GstVideoFrame prev;
+
+    gst_videomixer2_sub_frame (job->prevframe, x, y, width, height, &prev);
+    gst_videomixer2_copy_frame (&prev, &dest);
+    return;
+  }
+
+  gst_videomixer2_fill_background (mix, job->background, &dest);
+
+  for (i = 0; i < job->n_inputs; i++) {
+    GstVideoMixer2Input *input = &job->inputs[i];
+
+    if (input->xpos >= x + width || input->xpos + input->width <= x ||
+        input->ypos >= y + height || input->ypos + input->height <= y)
+      continue;
+
+    job->composite (&input->frame, input->xpos - x, input->ypos - y,
+        input->alpha, &dest);
+  }
+}
+
+static void
+gst_videomixer2_blend_tiles (GstVideoMixer2Job * job)
+{
+  gint tile;
+
+  while ((tile = g_atomic_int_add (&job->next_tile, 1)) < job->n_tiles)
+    gst_videomixer2_blend_tile (job->mix, job, tile);
+}
+
+
+/* marks the tiles covered by the rectangle, returns TRUE if there was any */
+static gboolean
+gst_videomixer2_damage_rect (GstVideoMixer2 * mix, gint x, gint y,
+    gint width, gint height)
+{
+  gint x1, y1, tx, ty;
+
+  x1 = MIN (x + width, GST_VIDEO_INFO_WIDTH (&mix->info));
+  y1 = MIN (y + height, GST_VIDEO_INFO_HEIGHT (&mix->info));
+  x = MAX (x, 0);
+  y = MAX (y, 0);
+  if (x >= x1 || y >= y1)
+    return FALSE;
+
+  for (ty = y / TILE_SIZE; ty <= (y1 - 1) / TILE_SIZE; ty++)
+    for (tx = x / TILE_SIZE; tx <= (x1 - 1) / TILE_SIZE; tx++)
+      mix->damage[ty * mix->tiles_x + tx] = TRUE;
+
+  return TRUE;
+}
+
+/* the blend functions move the picture to a whole chroma sample */
+static gint
+gst_videomixer2_round_pos (gint pos, gint sub)
+{
+  return (pos + (1 << sub) - 1) & ~((1 << sub) - 1);
+}
+
+static GstFlowReturn
+gst_videomixer2_blend_buffers (GstVideoMixer2 * mix,
+    GstClockTime output_start_time, GstClockTime output_end_time,
+    GstBuffer ** outbuf)
+{
+  GSList *l;
+  guint outsize;
+  GstVideoFrame outframe, prevframe;
+  GstVideoMixer2Job job;
+  GstVideoMixer2Input *inputs;
+  guint i, n_inputs;
+  gint tiles_x, tiles_y, w_sub, h_sub;
+  gboolean damage_tracking, full, damaged;
+  const GstVideoFormatInfo *finfo = mix->info.finfo;
+  static GstAllocationParams params = { 0, 15, 0, 0, };
+
+  GST_OBJECT_LOCK (mix);
+  damage_tracking = mix->damage_tracking;
+  if (G_UNLIKELY (mix->n_threads_changed)) {
+    guint n_threads;
+
+    GST_OBJECT_UNLOCK (mix);
+    n_threads = gst_videomixer2_get_n_threads (mix);
+    GST_DEBUG_OBJECT (mix, "blending with %u threads", n_threads);
+    gst_worker_pool_set_n_threads (&mix->workers, n_threads);
+  } else {
+    GST_OBJECT_UNLOCK (mix);
+  }
+
+  tiles_x = (GST_VIDEO_INFO_WIDTH (&mix->info) + TILE_SIZE - 1) / TILE_SIZE;
+  tiles_y = (GST_VIDEO_INFO_HEIGHT (&mix->info) + TILE_SIZE - 1) / TILE_SIZE;
+  if (tiles_x != mix->tiles_x || tiles_y != mix->tiles_y) {
+    g_free (mix->damage);
+    mix->damage = g_malloc (tiles_x * tiles_y);
+    mix->tiles_x = tiles_x;
+    mix->tiles_y = tiles_y;
+    mix->damage_all = TRUE;
+  }
 
+  if (!damage_tracking)
+    gst_buffer_replace (&mix->last_outbuf, NULL);
+
+  full = mix->last_outbuf == NULL || mix->damage_all;
+  memset (mix->damage, full, tiles_x * tiles_y);
+  mix->damage_all = FALSE;
+  damaged = full;
+
+  w_sub = GST_VIDEO_FORMAT_INFO_W_SUB (finfo, 1);
+  h_sub = GST_VIDEO_FORMAT_INFO_H_SUB (finfo, 1);
+
+  /* collect the pictures to blend, and the tiles that changed since the
+   * previous output frame */
+  inputs = g_new (GstVideoMixer2Input, mix->numpads);
+  n_inputs = 0;
   for (l = mix->sinkpads; l; l = l->next) {
     GstVideoMixer2Pad *pad = l->data;
     GstVideoMixer2Collect *mixcol = pad->mixcol;
+    GstVideoMixer2Input *input = &inputs[n_inputs];
+    GstClockTime timestamp;
+    gint64 stream_time;
+    GstSegment *seg;
+
+    if (mixcol->buffer == NULL) {
+      if (mixcol->blended) {
+        damaged |= gst_videomixer2_damage_rect (mix, mixcol->blend_xpos,
+            mixcol->blend_ypos, mixcol->blend_width, mixcol->blend_height);
+        mixcol->blended = FALSE;
+      }
+      continue;
+    }
 
-    if (mixcol->buffer != NULL) {
-      GstClockTime timestamp;
-      gint64 stream_time;
-      GstSegment *seg;
-      GstVideoFrame frame;
+    seg = &mixcol->collect.segment;
 
-      seg = &mixcol->collect.segment;
+    timestamp = GST_BUFFER_TIMESTAMP (mixcol->buffer);
 
-      timestamp = GST_BUFFER_TIMESTAMP (mixcol->buffer);
+    stream_time = gst_segment_to_stream_time (seg, GST_FORMAT_TIME, timestamp);
 
-      stream_time =
-          gst_segment_to_stream_time (seg, GST_FORMAT_TIME, timestamp);
+    /* sync object properties on stream time */
+    if (GST_CLOCK_TIME_IS_VALID (stream_time))
+      gst_object_sync_values (GST_OBJECT (pad), stream_time);
 
-      /* sync object properties on stream time */
-      if (GST_CLOCK_TIME_IS_VALID (stream_time))
-        gst_object_sync_values (GST_OBJECT (pad), stream_time);
+    if (!gst_video_frame_map (&input->frame, &pad->info, mixcol->buffer,
+            GST_MAP_READ))
+      continue;
 
-      gst_video_frame_map (&frame, &pad->info, mixcol->buffer, GST_MAP_READ);
+    input->xpos = gst_videomixer2_round_pos (pad->xpos, w_sub);
+    input->ypos = gst_videomixer2_round_pos (pad->ypos, h_sub);
+    input->width = GST_VIDEO_INFO_WIDTH (&pad->info);
+    input->height = GST_VIDEO_INFO_HEIGHT (&pad->info);
+    input->alpha = pad->alpha;
+    n_inputs++;
+
+    if (!mixcol->blended || mixcol->new_buffer ||
+        mixcol->blend_xpos != input->xpos || mixcol->blend_ypos != input->ypos
+        || mixcol->blend_width != input->width
+        || mixcol->blend_height != input->height
+        || mixcol->blend_alpha != input->alpha) {
+      if (mixcol->blended)
+        damaged |= gst_videomixer2_damage_rect (mix, mixcol->blend_xpos,
+            mixcol->blend_ypos, mixcol->blend_width, mixcol->blend_height);
+      damaged |= gst_videomixer2_damage_rect (mix, input->xpos, input->ypos,
+          input->width, input->height);
+    }
 
-      composite (&frame, pad->xpos, pad->ypos, pad->alpha, &outframe);
+    mixcol->new_buffer = FALSE;
+    mixcol->blended = TRUE;
+    mixcol->blend_xpos = input->xpos;
+    mixcol->blend_ypos = input->ypos;
+    mixcol->blend_width = input->width;
+    mixcol->blend_height = input->height;
+    mixcol->blend_alpha = input->alpha;
+  }
 
-      gst_video_frame_unmap (&frame);
-    }
+  if (!damaged) {
+    /* nothing changed, push the previous frame again without copying */
+    GST_LOG_OBJECT (mix, "no damage, repeating the previous frame");
+    *outbuf = gst_buffer_copy (mix->last_outbuf);
+    GST_BUFFER_TIMESTAMP (*outbuf) = output_start_time;
+    GST_BUFFER_DURATION (*outbuf) = output_end_time - output_start_time;
+    goto done;
   }
+
+  outsize = GST_VIDEO_INFO_SIZE (&mix->info);
+
+  *outbuf = gst_buffer_new_allocate (NULL, outsize, &params);
+  GST_BUFFER_TIMESTAMP (*outbuf) = output_start_time;
+  GST_BUFFER_DURATION (*outbuf) = output_end_time - output_start_time;
+
+  gst_video_frame_map (&outframe, &mix->info, *outbuf, GST_MAP_READWRITE);
+  if (!full)
+    gst_video_frame_map (&prevframe, &mix->info, mix->last_outbuf,
+        GST_MAP_READ);
+
+  job.outframe = &outframe;
+  job.prevframe = full ? NULL : &prevframe;
+  job.inputs = inputs;
+  job.n_inputs = n_inputs;
+  job.background = mix->background;
+  /* use overlay to keep background transparent */
+  if (job.background == VIDEO_MIXER2_BACKGROUND_TRANSPARENT)
+    job.composite = mix->overlay;
+  else
+    job.composite = mix->blend;
+  job.damage = mix->damage;
+  job.n_tiles = tiles_x * tiles_y;
+  job.next_tile = 0;
+
+  job.mix = mix;
+  gst_worker_pool_run (&mix->workers,
+      (GstWorkerPoolFunc) gst_videomixer2_blend_tiles, &job);
+
+  if (!full)
+    gst_video_frame_unmap (&prevframe);
   gst_video_frame_unmap (&outframe);
 
+  if (damage_tracking)
+    gst_buffer_replace (&mix->last_outbuf, *outbuf);
+
+done:
+  for (i = 0; i < n_inputs; i++)
+    gst_video_frame_unmap (&inputs[i].frame);
+  g_free (inputs);
+
   return GST_FLOW_OK;
 }
 
@@ -1444,6 +1764,9 @@ gst_videomixer2_src_setcaps (GstPad * pad, GstVideoMixer2 * mix, GstCaps * caps)
   }
 
   mix->info = info;
+  /* the previous frame can't be reused with other caps */
+  gst_buffer_replace (&mix->last_outbuf, NULL);
+  mix->damage_all = TRUE;
 
   switch (GST_VIDEO_INFO_FORMAT (&mix->info)) {
     case GST_VIDEO_FORMAT_AYUV:
@@ -1773,6 +2096,10 @@ gst_videomixer2_change_state (GstElement * element, GstStateChange transition)
   switch (transition) {
     case GST_STATE_CHANGE_PAUSED_TO_READY:
       gst_videomixer2_reset (mix);
+      gst_worker_pool_stop (&mix->workers);
+      GST_OBJECT_LOCK (mix);
+      mix->n_threads_changed = TRUE;
+      GST_OBJECT_UNLOCK (mix);
       break;
     default:
       break;
@@ -1869,6 +2196,7 @@ gst_videomixer2_release_pad (GstElement * element, GstPad * pad)
   gst_child_proxy_child_removed (GST_CHILD_PROXY (mix), G_OBJECT (mixpad),
       GST_OBJECT_NAME (mixpad));
   mix->numpads--;
+  mix->damage_all = TRUE;
 
   update_caps = GST_VIDEO_INFO_FORMAT (&mix->info) != GST_VIDEO_FORMAT_UNKNOWN;
   GST_VIDEO_MIXER2_UNLOCK (mix);
@@ -1890,6 +2218,10 @@ gst_videomixer2_finalize (GObject * o)
 {
   GstVideoMixer2 *mix = GST_VIDEO_MIXER2 (o);
 
+  gst_worker_pool_clear (&mix->workers);
+  gst_buffer_replace (&mix->last_outbuf, NULL);
+  g_free (mix->damage);
+
   gst_object_unref (mix->collect);
   g_mutex_clear (&mix->lock);
   g_mutex_clear (&mix->setcaps_lock);
@@ -1907,6 +2239,16 @@ gst_videomixer2_get_property (GObject * object,
     case PROP_BACKGROUND:
       g_value_set_enum (value, mix->background);
       break;
+    case PROP_N_THREADS:
+      GST_OBJECT_LOCK (mix);
+      g_value_set_uint (value, mix->n_threads);
+      GST_OBJECT_UNLOCK (mix);
+      break;
+    case PROP_DAMAGE_TRACKING:
+      GST_OBJECT_LOCK (mix);
+      g_value_set_boolean (value, mix->damage_tracking);
+      GST_OBJECT_UNLOCK (mix);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -1921,7 +2263,21 @@ gst_videomixer2_set_property (GObject * object,
 
   switch (prop_id) {
     case PROP_BACKGROUND:
+      GST_VIDEO_MIXER2_LOCK (mix);
       mix->background = g_value_get_enum (value);
+      mix->damage_all = TRUE;
+      GST_VIDEO_MIXER2_UNLOCK (mix);
+      break;
+    case PROP_N_THREADS:
+      GST_OBJECT_LOCK (mix);
+      mix->n_threads = g_value_get_uint (value);
+      mix->n_threads_changed = TRUE;
+      GST_OBJECT_UNLOCK (mix);
+      break;
+    case PROP_DAMAGE_TRACKING:
+      GST_OBJECT_LOCK (mix);
+      mix->damage_tracking = g_value_get_boolean (value);
+      GST_OBJECT_UNLOCK (mix);
       break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
@@ -1983,6 +2339,29 @@ gst_videomixer2_class_init (GstVideoMixer2Class * klass)
       g_param_spec_enum ("background", "Background", "Background type",
           GST_TYPE_VIDEO_MIXER2_BACKGROUND,
           DEFAULT_BACKGROUND, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  /**
+   * GstVideoMixer2:n-threads
+   *
+   * The number of threads that blend the tiles of an output frame, including
+   * the streaming thread. 0 uses one thread per CPU.
+   */
+  g_object_class_install_property (gobject_class, PROP_N_THREADS,
+      g_param_spec_uint ("n-threads", "Threads",
+          "Number of threads to blend with (0 = one per CPU)", 0,
+          VIDEO_MIXER2_MAX_THREADS, DEFAULT_N_THREADS,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  /**
+   * GstVideoMixer2:damage-tracking
+   *
+   * Only blend the tiles of the output frame that changed since the previous
+   * frame and copy the others from it. The previous frame is kept, so
+   * downstream elements that work in place have to copy the frames that
+   * videomixer pushes.
+   */
+  g_object_class_install_property (gobject_class, PROP_DAMAGE_TRACKING,
+      g_param_spec_boolean ("damage-tracking", "Damage tracking",
+          "Only blend the parts of the frame that changed",
+          DEFAULT_DAMAGE_TRACKING, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
   gstelement_class->request_new_pad =
       GST_DEBUG_FUNCPTR (gst_videomixer2_request_new_pad);
@@ -2021,6 +2400,9 @@ gst_videomixer2_init (GstVideoMixer2 * mix)
 
   mix->collect = gst_collect_pads_new ();
   mix->background = DEFAULT_BACKGROUND;
+  mix->n_threads = DEFAULT_N_THREADS;
+  mix->n_threads_changed = TRUE;
+  mix->damage_tracking = DEFAULT_DAMAGE_TRACKING;
 
   gst_collect_pads_set_function (mix->collect,
       (GstCollectPadsFunction) GST_DEBUG_FUNCPTR (gst_videomixer2_collected),
@@ -2034,6 +2416,7 @@ gst_videomixer2_init (GstVideoMixer2 * mix)
 
   g_mutex_init (&mix->lock);
   g_mutex_init (&mix->setcaps_lock);
+  gst_worker_pool_init (&mix->workers, "videomixer");
   /* initialize variables */
   gst_videomixer2_reset (mix);
 }
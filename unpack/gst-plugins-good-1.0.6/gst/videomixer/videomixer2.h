@@ -25,6 +25,7 @@
 #include <gst/video/video.h>
 
 #include "blend.h"
+#include "gst/gst-worker-pool-private.h"
 #include <gst/base/gstcollectpads.h>
 
 G_BEGIN_DECLS
@@ -42,6 +43,8 @@ G_BEGIN_DECLS
 typedef struct _GstVideoMixer2 GstVideoMixer2;
 typedef struct _GstVideoMixer2Class GstVideoMixer2Class;
 
+#define VIDEO_MIXER2_MAX_THREADS 64
+
 /**
  * GstVideoMixer2Background:
  * @VIDEO_MIXER2_BACKGROUND_CHECKER: checker pattern background
@@ -110,6 +113,20 @@ struct _GstVideoMixer2
   BlendFunction blend, overlay;
   FillCheckerFunction fill_checker;
   FillColorFunction fill_color;
+
+  /* protected by the object lock */
+  guint n_threads;
+  gboolean n_threads_changed;
+  gboolean damage_tracking;
+
+  /* tiles of the output frame that need to be blended again */
+  guint8 *damage;
+  gint tiles_x, tiles_y;
+  gboolean damage_all;
+  GstBuffer *last_outbuf;
+
+  /* threads blending tiles with the streaming thread */
+  GstWorkerPool workers;
 };
 
 struct _GstVideoMixer2Class
@@ -22,6 +22,7 @@
 #endif
 
 #include <stdio.h>
+#include <string.h>
 #include <gst/check/gstcheck.h>
 #include <gst/video/video.h>
 
@@ -430,6 +431,105 @@ GST_START_TEST (test_mode_auto_deinterlaced_passthrough)
 
 GST_END_TEST;
 
+static void
+handoff (GstElement * sink, GstBuffer * buffer, GstPad * pad, GList ** frames)
+{
+  *frames = g_list_append (*frames, gst_buffer_ref (buffer));
+}
+
+/* deinterlaces a moving ball, mode=interlaced forces deinterlacing of the
+ * progressive frames of videotestsrc */
+static GList *
+deinterlace_frames (const gchar * format, const gchar * method,
+    guint n_threads)
+{
+  GstElement *pipeline, *sink;
+  GstMessage *msg;
+  GstBus *bus;
+  GList *frames = NULL;
+  gchar *desc;
+
+  desc = g_strdup_printf ("videotestsrc num-buffers=10 pattern=ball ! "
+      "video/x-raw,format=%s,width=318,height=240,framerate=25/1 ! "
+      "deinterlace mode=interlaced method=%s n-threads=%u ! "
+      "fakesink name=sink signal-handoffs=true sync=false", format, method,
+      n_threads);
+  pipeline = gst_parse_launch (desc, NULL);
+  g_free (desc);
+  fail_unless (pipeline != NULL);
+
+  sink = gst_bin_get_by_name (GST_BIN (pipeline), "sink");
+  g_signal_connect (sink, "handoff", G_CALLBACK (handoff), &frames);
+  gst_object_unref (sink);
+
+  fail_unless (gst_element_set_state (pipeline, GST_STATE_PLAYING) !=
+      GST_STATE_CHANGE_FAILURE);
+
+  bus = gst_element_get_bus (pipeline);
+  msg = gst_bus_timed_pop_filtered (bus, GST_CLOCK_TIME_NONE,
+      GST_MESSAGE_EOS | GST_MESSAGE_ERROR);
+  fail_unless_equals_int (GST_MESSAGE_TYPE (msg), GST_MESSAGE_EOS);
+  gst_message_unref (msg);
+  gst_object_unref (bus);
+
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+  gst_object_unref (pipeline);
+
+  fail_unless (frames != NULL);
+
+  return frames;
+}
+
+static const struct
+{
+  const gchar *format;
+  const gchar *method;
+} threaded_cases[] = {
+  {
+  "I420", "yadif"}, {
+  "Y42B", "yadif"}, {
+  "NV12", "yadif"}, {
+  "YUY2", "yadif"}, {
+  "AYUV", "yadif"}, {
+  "RGB", "yadif"}, {
+  "I420", "linear"}, {
+  "YUY2", "vfir"}
+};
+
+/* deinterlacing bands of lines in several threads gives the same frames
+ * as deinterlacing in one thread */
+GST_START_TEST (test_threaded_method)
+{
+  const gchar *format = threaded_cases[__i__].format;
+  const gchar *method = threaded_cases[__i__].method;
+  GList *expected, *frames, *e, *f;
+
+  expected = deinterlace_frames (format, method, 1);
+  frames = deinterlace_frames (format, method, 3);
+
+  for (e = expected, f = frames; e && f; e = e->next, f = f->next) {
+    GstBuffer *a = e->data, *b = f->data;
+    GstMapInfo ma, mb;
+
+    fail_unless_equals_uint64 (GST_BUFFER_TIMESTAMP (a),
+        GST_BUFFER_TIMESTAMP (b));
+    gst_buffer_map (a, &ma, GST_MAP_READ);
+    gst_buffer_map (b, &mb, GST_MAP_READ);
+    fail_unless_equals_int (ma.size, mb.size);
+    fail_unless (memcmp (ma.data, mb.data, ma.size) == 0,
+        "frame at %" GST_TIME_FORMAT " differs",
+        GST_TIME_ARGS (GST_BUFFER_TIMESTAMP (a)));
+    gst_buffer_unmap (a, &ma);
+    gst_buffer_unmap (b, &mb);
+  }
+  fail_unless (e == NULL && f == NULL);
+
+  g_list_free_full (expected, (GDestroyNotify) gst_buffer_unref);
+  g_list_free_full (frames, (GDestroyNotify) gst_buffer_unref);
+}
+
+GST_END_TEST;
+
 static Suite *
 deinterlace_suite (void)
 {
@@ -451,6 +551,8 @@ deinterlace_suite (void)
   tcase_add_test (tc_chain, test_mode_disabled_accept_caps);
   tcase_add_test (tc_chain, test_mode_disabled_passthrough);
   tcase_add_test (tc_chain, test_mode_auto_deinterlaced_passthrough);
+  tcase_add_loop_test (tc_chain, test_threaded_method, 0,
+      G_N_ELEMENTS (threaded_cases));
 
   return s;
 }
@@ -0,0 +1,359 @@
+/* GStreamer
+ *
+ * unit test for the bandwidth estimation of rtpsession
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/* Simulates receivers of our stream by feeding synthetic RTCP receiver
+ * reports to rtpsession and checks how the target bitrate follows the
+ * reported packet loss. The round trip times are fed to the estimator
+ * directly, with the times of the reports. */
+
+#include <gst/check/gstcheck.h>
+#include <gst/rtp/gstrtcpbuffer.h>
+
+#include "rtpbwe.h"
+
+#define START_BITRATE 300000
+#define MIN_BITRATE   100000
+#define MAX_BITRATE   400000
+#define CLOCK_RATE    8000
+
+static GstStaticPadTemplate srctemplate = GST_STATIC_PAD_TEMPLATE ("src",
+    GST_PAD_SRC,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS ("application/x-rtcp")
+    );
+static GstStaticPadTemplate rtpsrctemplate = GST_STATIC_PAD_TEMPLATE ("src",
+    GST_PAD_SRC,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS ("application/x-rtp")
+    );
+
+typedef struct
+{
+  GstElement *session;
+  GstPad *srcpad;
+  GstPad *rtcp_sink;
+  GstPad *rtp_srcpad;
+  GstPad *rtp_sink;
+  guint32 ssrc;
+  guint32 extseq;
+
+  guint num_changes;
+  guint bitrate;
+} BweTest;
+
+static void
+on_target_bitrate (GstElement * session, guint32 ssrc, guint bitrate,
+    BweTest * test)
+{
+  fail_unless_equals_int (ssrc, test->ssrc);
+  test->num_changes++;
+  test->bitrate = bitrate;
+}
+
+static void
+setup_bwe_test (BweTest * test, const gchar * mode)
+{
+  GObject *internal;
+  GstCaps *caps;
+
+  test->session = gst_check_setup_element ("rtpsession");
+  gst_util_set_object_arg (G_OBJECT (test->session), "bandwidth-estimation",
+      mode);
+
+  g_object_get (test->session, "internal-session", &internal, NULL);
+  g_object_set (internal, "start-bitrate", START_BITRATE, "min-bitrate",
+      MIN_BITRATE, "max-bitrate", MAX_BITRATE, NULL);
+  g_object_get (internal, "internal-ssrc", &test->ssrc, NULL);
+  g_object_unref (internal);
+
+  g_signal_connect (test->session, "on-target-bitrate",
+      (GCallback) on_target_bitrate, test);
+
+  test->rtcp_sink = gst_element_get_request_pad (test->session,
+      "recv_rtcp_sink");
+  fail_unless (test->rtcp_sink != NULL);
+  test->srcpad = gst_pad_new_from_static_template (&srctemplate, "src");
+  fail_unless (gst_pad_link (test->srcpad, test->rtcp_sink) ==
+      GST_PAD_LINK_OK);
+  gst_pad_set_active (test->srcpad, TRUE);
+
+  /* the caps of our stream give the clock rate of the reported jitter */
+  test->rtp_sink = gst_element_get_request_pad (test->session,
+      "send_rtp_sink");
+  fail_unless (test->rtp_sink != NULL);
+  test->rtp_srcpad = gst_pad_new_from_static_template (&rtpsrctemplate, "src");
+  fail_unless (gst_pad_link (test->rtp_srcpad, test->rtp_sink) ==
+      GST_PAD_LINK_OK);
+  gst_pad_set_active (test->rtp_srcpad, TRUE);
+
+  fail_unless (gst_element_set_state (test->session, GST_STATE_PLAYING) ==
+      GST_STATE_CHANGE_SUCCESS);
+
+  gst_pad_push_event (test->rtp_srcpad, gst_event_new_stream_start ("bwe"));
+  caps = gst_caps_new_simple ("application/x-rtp",
+      "media", G_TYPE_STRING, "audio", "clock-rate", G_TYPE_INT, CLOCK_RATE,
+      "payload", G_TYPE_INT, 0, NULL);
+  fail_unless (gst_pad_set_caps (test->rtp_srcpad, caps));
+  gst_caps_unref (caps);
+
+  test->extseq = 1000;
+  test->num_changes = 0;
+  test->bitrate = START_BITRATE;
+}
+
+static void
+teardown_bwe_test (BweTest * test)
+{
+  fail_unless (gst_element_set_state (test->session, GST_STATE_NULL) ==
+      GST_STATE_CHANGE_SUCCESS);
+  gst_pad_set_active (test->srcpad, FALSE);
+  gst_pad_unlink (test->srcpad, test->rtcp_sink);
+  gst_element_release_request_pad (test->session, test->rtcp_sink);
+  gst_object_unref (test->rtcp_sink);
+  gst_object_unref (test->srcpad);
+  gst_pad_set_active (test->rtp_srcpad, FALSE);
+  gst_pad_unlink (test->rtp_srcpad, test->rtp_sink);
+  gst_element_release_request_pad (test->session, test->rtp_sink);
+  gst_object_unref (test->rtp_sink);
+  gst_object_unref (test->rtp_srcpad);
+  gst_check_teardown_element (test->session);
+}
+
+/* send a receiver report from @reporter about our stream with
+ * @fractionlost / 256 of the packets lost and @jitter in clock rate units */
+static void
+push_rr_full (BweTest * test, guint32 reporter, guint8 fractionlost,
+    guint32 jitter)
+{
+  GstRTCPBuffer rtcp = GST_RTCP_BUFFER_INIT;
+  GstRTCPPacket packet;
+  GstBuffer *buffer;
+
+  test->extseq += 50;
+
+  buffer = gst_rtcp_buffer_new (1000);
+  gst_rtcp_buffer_map (buffer, GST_MAP_READWRITE, &rtcp);
+  fail_unless (gst_rtcp_buffer_add_packet (&rtcp, GST_RTCP_TYPE_RR, &packet));
+  gst_rtcp_packet_rr_set_ssrc (&packet, reporter);
+  fail_unless (gst_rtcp_packet_add_rb (&packet, test->ssrc, fractionlost, 0,
+          test->extseq, jitter, 0, 0));
+  gst_rtcp_buffer_unmap (&rtcp);
+
+  fail_unless (gst_pad_push (test->srcpad, buffer) == GST_FLOW_OK);
+}
+
+/* a report with a steady jitter of 1 ms */
+static void
+push_rr (BweTest * test, guint32 reporter, guint8 fractionlost)
+{
+  push_rr_full (test, reporter, fractionlost, CLOCK_RATE / 1000);
+}
+
+GST_START_TEST (test_bwe_loss)
+{
+  BweTest test;
+  guint i, prev;
+
+  setup_bwe_test (&test, "loss");
+
+  /* no loss, the bitrate increases up to the maximum */
+  prev = START_BITRATE;
+  for (i = 0; i < 5; i++) {
+    push_rr (&test, 0xdeadbeef, 0);
+    fail_unless_equals_int (test.num_changes, i + 1);
+    fail_unless (test.bitrate > prev);
+    prev = test.bitrate;
+  }
+  for (i = 0; i < 10; i++)
+    push_rr (&test, 0xdeadbeef, 0);
+  fail_unless_equals_int (test.bitrate, MAX_BITRATE);
+
+  /* moderate loss keeps the bitrate */
+  test.num_changes = 0;
+  for (i = 0; i < 5; i++)
+    push_rr (&test, 0xdeadbeef, 13);
+  fail_unless_equals_int (test.num_changes, 0);
+
+  /* 25% loss makes the bitrate drop by 12.5% for every report */
+  prev = test.bitrate;
+  push_rr (&test, 0xdeadbeef, 64);
+  fail_unless_equals_int (test.num_changes, 1);
+  fail_unless_equals_int (test.bitrate, prev * 7 / 8);
+
+  /* down to the minimum */
+  for (i = 0; i < 20; i++)
+    push_rr (&test, 0xdeadbeef, 64);
+  fail_unless_equals_int (test.bitrate, MIN_BITRATE);
+
+  teardown_bwe_test (&test);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_bwe_multiple_receivers)
+{
+  BweTest test;
+  GObject *internal;
+  guint bitrate, i;
+
+  setup_bwe_test (&test, "loss");
+
+  /* a good receiver increases the target */
+  for (i = 0; i < 3; i++)
+    push_rr (&test, 0x11111111, 0);
+  fail_unless (test.bitrate > START_BITRATE);
+  bitrate = test.bitrate;
+
+  /* a receiver with loss pulls the target down */
+  push_rr (&test, 0x22222222, 64);
+  fail_unless (test.bitrate < bitrate);
+  bitrate = test.bitrate;
+
+  /* more good reports of the first receiver don't raise the target */
+  for (i = 0; i < 3; i++)
+    push_rr (&test, 0x11111111, 0);
+  fail_unless_equals_int (test.bitrate, bitrate);
+
+  g_object_get (test.session, "target-bitrate", &bitrate, NULL);
+  fail_unless_equals_int (bitrate, test.bitrate);
+
+  /* the estimate of each receiver is in its stats */
+  g_object_get (test.session, "internal-session", &internal, NULL);
+  {
+    GObject *source;
+    GstStructure *stats;
+    guint bwe_bitrate;
+
+    g_signal_emit_by_name (internal, "get-source-by-ssrc", 0x22222222,
+        &source);
+    fail_unless (source != NULL);
+    g_object_get (source, "stats", &stats, NULL);
+    fail_unless (gst_structure_get_uint (stats, "bwe-bitrate", &bwe_bitrate));
+    fail_unless_equals_int (bwe_bitrate, test.bitrate);
+    gst_structure_free (stats);
+    g_object_unref (source);
+  }
+  g_object_unref (internal);
+
+  teardown_bwe_test (&test);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_bwe_loss_delay)
+{
+  BweTest test;
+  guint i, prev;
+
+  setup_bwe_test (&test, "loss-delay");
+
+  /* no loss and a steady jitter, the bitrate increases */
+  prev = START_BITRATE;
+  for (i = 0; i < 3; i++) {
+    push_rr (&test, 0xdeadbeef, 0);
+    fail_unless_equals_int (test.num_changes, i + 1);
+    fail_unless (test.bitrate > prev);
+    prev = test.bitrate;
+  }
+
+  /* a jitter spike of 100 ms shows queues building up, the bitrate drops
+   * by 15% even without loss */
+  push_rr_full (&test, 0xdeadbeef, 0, CLOCK_RATE / 10);
+  fail_unless_equals_int (test.num_changes, 4);
+  fail_unless_equals_int (test.bitrate, (guint) (prev * 0.85));
+
+  /* back to a steady jitter, the bitrate increases again */
+  prev = test.bitrate;
+  for (i = 0; i < 10; i++)
+    push_rr (&test, 0xdeadbeef, 0);
+  fail_unless (test.bitrate > prev);
+
+  teardown_bwe_test (&test);
+
+  /* the loss mode ignores the jitter spike */
+  setup_bwe_test (&test, "loss");
+  push_rr (&test, 0xdeadbeef, 0);
+  prev = test.bitrate;
+  push_rr_full (&test, 0xdeadbeef, 0, CLOCK_RATE / 10);
+  fail_unless (test.bitrate > prev);
+  teardown_bwe_test (&test);
+}
+
+GST_END_TEST;
+
+/* round trip times in 16.16 seconds */
+#define RTT_100MS (65536 / 10)
+#define RTT_300MS (3 * 65536 / 10)
+
+GST_START_TEST (test_bwe_min_rtt_window)
+{
+  RTPBandwidthEstimator bwe;
+  GstClockTime t;
+  guint prev;
+
+  rtp_bwe_init (&bwe, RTP_BWE_MODE_LOSS_DELAY, START_BITRATE, MIN_BITRATE,
+      MAX_BITRATE);
+
+  /* a report every 5 seconds without loss, the bitrate increases */
+  for (t = 0; t < 20 * GST_SECOND; t += 5 * GST_SECOND)
+    rtp_bwe_process_rb (&bwe, t, 0, 8, CLOCK_RATE, RTT_100MS, 0);
+  fail_unless (bwe.bitrate > START_BITRATE);
+  fail_unless_equals_uint64 (bwe.min_rtt,
+      gst_util_uint64_scale (RTT_100MS, GST_SECOND, 65536));
+
+  /* the path gets 200 ms longer, this looks like queuing as long as the
+   * round trip times before the change are in the window */
+  prev = bwe.bitrate;
+  for (; t < 60 * GST_SECOND; t += 5 * GST_SECOND)
+    rtp_bwe_process_rb (&bwe, t, 0, 8, CLOCK_RATE, RTT_300MS, 0);
+  fail_unless (bwe.bitrate < prev);
+
+  /* then the old round trip times are forgotten and the longer path is the
+   * new minimum, the bitrate increases again */
+  prev = bwe.bitrate;
+  fail_unless (rtp_bwe_process_rb (&bwe, t, 0, 8, CLOCK_RATE, RTT_300MS, 0));
+  fail_unless_equals_uint64 (bwe.min_rtt,
+      gst_util_uint64_scale (RTT_300MS, GST_SECOND, 65536));
+  fail_unless (bwe.bitrate > prev);
+  for (t += 5 * GST_SECOND; t < 90 * GST_SECOND; t += 5 * GST_SECOND) {
+    prev = bwe.bitrate;
+    rtp_bwe_process_rb (&bwe, t, 0, 8, CLOCK_RATE, RTT_300MS, 0);
+    fail_unless (bwe.bitrate > prev || bwe.bitrate == MAX_BITRATE);
+  }
+}
+
+GST_END_TEST;
+
+static Suite *
+rtpbwe_suite (void)
+{
+  Suite *s = suite_create ("rtpbwe");
+  TCase *tc_chain = tcase_create ("general");
+
+  suite_add_tcase (s, tc_chain);
+  tcase_add_test (tc_chain, test_bwe_loss);
+  tcase_add_test (tc_chain, test_bwe_multiple_receivers);
+  tcase_add_test (tc_chain, test_bwe_loss_delay);
+  tcase_add_test (tc_chain, test_bwe_min_rtt_window);
+
+  return s;
+}
+
+GST_CHECK_MAIN (rtpbwe);
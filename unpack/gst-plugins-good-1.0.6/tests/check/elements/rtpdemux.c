@@ -0,0 +1,269 @@
+/* GStreamer unit test for the buffer list handling of rtpssrcdemux and
+ * rtpptdemux
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#include <gst/check/gstcheck.h>
+#include <gst/rtp/gstrtpbuffer.h>
+
+/* what arrived on one src pad of the demuxer */
+typedef struct
+{
+  GstPad *sinkpad;
+  guint n_lists;
+  guint n_buffers;
+  GList *seqnums;
+} Output;
+
+static GList *outputs;
+static GstPad *srcpad;
+
+static GstStaticPadTemplate srctemplate = GST_STATIC_PAD_TEMPLATE ("src",
+    GST_PAD_SRC, GST_PAD_ALWAYS,
+    GST_STATIC_CAPS ("application/x-rtp, clock-rate = (int) 90000"));
+
+static GstStaticPadTemplate sinktemplate = GST_STATIC_PAD_TEMPLATE ("sink",
+    GST_PAD_SINK, GST_PAD_ALWAYS, GST_STATIC_CAPS ("application/x-rtp"));
+
+static GstBuffer *
+create_rtp_buffer (guint32 ssrc, guint8 pt, guint16 seqnum)
+{
+  GstBuffer *buf;
+  GstRTPBuffer rtp = { NULL };
+
+  buf = gst_rtp_buffer_new_allocate (4, 0, 0);
+  gst_rtp_buffer_map (buf, GST_MAP_WRITE, &rtp);
+  gst_rtp_buffer_set_ssrc (&rtp, ssrc);
+  gst_rtp_buffer_set_payload_type (&rtp, pt);
+  gst_rtp_buffer_set_seq (&rtp, seqnum);
+  gst_rtp_buffer_unmap (&rtp);
+
+  return buf;
+}
+
+static guint16
+get_seqnum (GstBuffer * buf)
+{
+  GstRTPBuffer rtp = { NULL };
+  guint16 seqnum;
+
+  gst_rtp_buffer_map (buf, GST_MAP_READ, &rtp);
+  seqnum = gst_rtp_buffer_get_seq (&rtp);
+  gst_rtp_buffer_unmap (&rtp);
+
+  return seqnum;
+}
+
+static gboolean
+add_seqnum (GstBuffer ** buf, guint idx, gpointer user_data)
+{
+  Output *output = user_data;
+
+  output->seqnums = g_list_append (output->seqnums,
+      GUINT_TO_POINTER (get_seqnum (*buf)));
+  output->n_buffers++;
+
+  return TRUE;
+}
+
+static GstFlowReturn
+output_chain (GstPad * pad, GstObject * parent, GstBuffer * buf)
+{
+  Output *output = gst_pad_get_element_private (pad);
+
+  add_seqnum (&buf, 0, output);
+  gst_buffer_unref (buf);
+
+  return GST_FLOW_OK;
+}
+
+static GstFlowReturn
+output_chain_list (GstPad * pad, GstObject * parent, GstBufferList * list)
+{
+  Output *output = gst_pad_get_element_private (pad);
+
+  output->n_lists++;
+  gst_buffer_list_foreach (list, add_seqnum, output);
+  gst_buffer_list_unref (list);
+
+  return GST_FLOW_OK;
+}
+
+static void
+pad_added (GstElement * element, GstPad * pad, gpointer user_data)
+{
+  Output *output;
+
+  if (!g_str_has_prefix (GST_PAD_NAME (pad), "src_"))
+    return;
+
+  output = g_new0 (Output, 1);
+  output->sinkpad = gst_pad_new_from_static_template (&sinktemplate, "sink");
+  gst_pad_set_element_private (output->sinkpad, output);
+  gst_pad_set_chain_function (output->sinkpad, output_chain);
+  gst_pad_set_chain_list_function (output->sinkpad, output_chain_list);
+  gst_pad_set_active (output->sinkpad, TRUE);
+  fail_unless (gst_pad_link (pad, output->sinkpad) == GST_PAD_LINK_OK);
+
+  outputs = g_list_append (outputs, output);
+}
+
+static GstCaps *
+request_pt_map (GstElement * demux, guint pt, gpointer user_data)
+{
+  return gst_caps_new_simple ("application/x-rtp",
+      "clock-rate", G_TYPE_INT, 90000, NULL);
+}
+
+static GstElement *
+setup_demux (const gchar * name)
+{
+  GstElement *demux;
+  GstSegment segment;
+  GstCaps *caps;
+
+  demux = gst_check_setup_element (name);
+  g_signal_connect (demux, "pad-added", G_CALLBACK (pad_added), NULL);
+  srcpad = gst_check_setup_src_pad (demux, &srctemplate);
+  gst_pad_set_active (srcpad, TRUE);
+  fail_unless (gst_element_set_state (demux,
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_SUCCESS);
+
+  gst_pad_push_event (srcpad, gst_event_new_stream_start ("rtpdemux"));
+  caps = gst_pad_get_pad_template_caps (srcpad);
+  gst_pad_set_caps (srcpad, caps);
+  gst_caps_unref (caps);
+  gst_segment_init (&segment, GST_FORMAT_TIME);
+  gst_pad_push_event (srcpad, gst_event_new_segment (&segment));
+
+  return demux;
+}
+
+static void
+cleanup_demux (GstElement * demux)
+{
+  GList *walk;
+
+  gst_element_set_state (demux, GST_STATE_NULL);
+  gst_check_teardown_src_pad (demux);
+  gst_check_teardown_element (demux);
+
+  for (walk = outputs; walk; walk = walk->next) {
+    Output *output = walk->data;
+
+    gst_object_unref (output->sinkpad);
+    g_list_free (output->seqnums);
+    g_free (output);
+  }
+  g_list_free (outputs);
+  outputs = NULL;
+}
+
+static void
+check_output (guint idx, guint n_lists, guint n_buffers, const guint * seqnums)
+{
+  Output *output = g_list_nth_data (outputs, idx);
+  GList *walk;
+  guint i;
+
+  fail_unless (output != NULL);
+  fail_unless_equals_int (output->n_lists, n_lists);
+  fail_unless_equals_int (output->n_buffers, n_buffers);
+  for (walk = output->seqnums, i = 0; walk; walk = walk->next, i++)
+    fail_unless_equals_int (GPOINTER_TO_UINT (walk->data), seqnums[i]);
+}
+
+GST_START_TEST (test_ssrc_demux_list)
+{
+  static const guint ssrcs[] = { 1, 1, 2, 3, 2, 1, 3, 3 };
+  static const guint seqnums1[] = { 0, 1, 5 };
+  static const guint seqnums2[] = { 2, 4 };
+  static const guint seqnums3[] = { 3, 6, 7 };
+  GstElement *demux;
+  GstBufferList *list;
+  guint i;
+
+  demux = setup_demux ("rtpssrcdemux");
+
+  list = gst_buffer_list_new ();
+  for (i = 0; i < G_N_ELEMENTS (ssrcs); i++)
+    gst_buffer_list_add (list, create_rtp_buffer (ssrcs[i], 96, i));
+  fail_unless_equals_int (gst_pad_push_list (srcpad, list), GST_FLOW_OK);
+
+  /* one list per SSRC, with the packets in order */
+  fail_unless_equals_int (g_list_length (outputs), 3);
+  check_output (0, 1, 3, seqnums1);
+  check_output (1, 1, 2, seqnums2);
+  check_output (2, 1, 3, seqnums3);
+
+  /* known SSRCs go to the existing pads */
+  list = gst_buffer_list_new ();
+  gst_buffer_list_add (list, create_rtp_buffer (3, 96, 8));
+  fail_unless_equals_int (gst_pad_push_list (srcpad, list), GST_FLOW_OK);
+  fail_unless_equals_int (g_list_length (outputs), 3);
+  fail_unless_equals_int (((Output *) g_list_nth_data (outputs, 2))->n_lists,
+      2);
+
+  cleanup_demux (demux);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_pt_demux_list)
+{
+  static const guint pts[] = { 96, 96, 97, 97, 96, 98 };
+  static const guint seqnums96[] = { 0, 1, 4 };
+  static const guint seqnums97[] = { 2, 3 };
+  static const guint seqnums98[] = { 5 };
+  GstElement *demux;
+  GstBufferList *list;
+  guint i;
+
+  demux = setup_demux ("rtpptdemux");
+  g_signal_connect (demux, "request-pt-map", G_CALLBACK (request_pt_map),
+      NULL);
+
+  list = gst_buffer_list_new ();
+  for (i = 0; i < G_N_ELEMENTS (pts); i++)
+    gst_buffer_list_add (list, create_rtp_buffer (1, pts[i], i));
+  fail_unless_equals_int (gst_pad_push_list (srcpad, list), GST_FLOW_OK);
+
+  /* the runs of the same payload type are pushed as lists */
+  fail_unless_equals_int (g_list_length (outputs), 3);
+  check_output (0, 2, 3, seqnums96);
+  check_output (1, 1, 2, seqnums97);
+  check_output (2, 1, 1, seqnums98);
+
+  cleanup_demux (demux);
+}
+
+GST_END_TEST;
+
+static Suite *
+rtpdemux_suite (void)
+{
+  Suite *s = suite_create ("rtpdemux");
+  TCase *tc_chain = tcase_create ("general");
+
+  suite_add_tcase (s, tc_chain);
+  tcase_add_test (tc_chain, test_ssrc_demux_list);
+  tcase_add_test (tc_chain, test_pt_demux_list);
+
+  return s;
+}
+
+GST_CHECK_MAIN (rtpdemux);
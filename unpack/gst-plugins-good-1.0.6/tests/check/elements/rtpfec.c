@@ -0,0 +1,256 @@
+/* GStreamer
+ *
+ * unit test for rtpfecenc and rtpfecdec
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#include <gst/check/gstcheck.h>
+#include <gst/rtp/gstrtpbuffer.h>
+
+#define MEDIA_SSRC 0x11223344
+#define MEDIA_PT   33
+#define FEC_PT     96
+
+static GstPad *mysrcpad, *mysinkpad;
+
+static GstStaticPadTemplate sinktemplate = GST_STATIC_PAD_TEMPLATE ("sink",
+    GST_PAD_SINK,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS ("application/x-rtp")
+    );
+static GstStaticPadTemplate srctemplate = GST_STATIC_PAD_TEMPLATE ("src",
+    GST_PAD_SRC,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS ("application/x-rtp")
+    );
+
+/* packets of different sizes, every 4th packet has the marker bit */
+static guint
+payload_len (guint16 seqnum)
+{
+  return 20 + (seqnum % 7) * 3;
+}
+
+static GstBuffer *
+create_rtp_buffer (guint16 seqnum)
+{
+  GstRTPBuffer rtp = GST_RTP_BUFFER_INIT;
+  GstBuffer *buffer;
+  guint8 *payload;
+  guint i, len = payload_len (seqnum);
+
+  buffer = gst_rtp_buffer_new_allocate (len, 0, 0);
+  gst_rtp_buffer_map (buffer, GST_MAP_WRITE, &rtp);
+  gst_rtp_buffer_set_ssrc (&rtp, MEDIA_SSRC);
+  gst_rtp_buffer_set_seq (&rtp, seqnum);
+  gst_rtp_buffer_set_payload_type (&rtp, MEDIA_PT);
+  gst_rtp_buffer_set_timestamp (&rtp, seqnum * 3000);
+  gst_rtp_buffer_set_marker (&rtp, (seqnum % 4) == 3);
+  payload = gst_rtp_buffer_get_payload (&rtp);
+  for (i = 0; i < len; i++)
+    payload[i] = seqnum * 7 + i;
+  gst_rtp_buffer_unmap (&rtp);
+
+  return buffer;
+}
+
+static void
+check_rtp_buffer (GstBuffer * buffer, guint16 seqnum, gboolean check_marker)
+{
+  GstRTPBuffer rtp = GST_RTP_BUFFER_INIT;
+  guint8 *payload;
+  guint i, len = payload_len (seqnum);
+
+  fail_unless (gst_rtp_buffer_map (buffer, GST_MAP_READ, &rtp));
+  fail_unless_equals_int (gst_rtp_buffer_get_ssrc (&rtp), MEDIA_SSRC);
+  fail_unless_equals_int (gst_rtp_buffer_get_payload_type (&rtp), MEDIA_PT);
+  fail_unless_equals_int (gst_rtp_buffer_get_timestamp (&rtp), seqnum * 3000);
+  if (check_marker)
+    fail_unless_equals_int (gst_rtp_buffer_get_marker (&rtp),
+        (seqnum % 4) == 3);
+  fail_unless_equals_int (gst_rtp_buffer_get_payload_len (&rtp), len);
+  payload = gst_rtp_buffer_get_payload (&rtp);
+  for (i = 0; i < len; i++)
+    fail_unless_equals_int (payload[i], (guint8) (seqnum * 7 + i));
+  gst_rtp_buffer_unmap (&rtp);
+}
+
+static void
+get_rtp_info (GstBuffer * buffer, guint8 * pt, guint16 * seqnum)
+{
+  GstRTPBuffer rtp = GST_RTP_BUFFER_INIT;
+
+  fail_unless (gst_rtp_buffer_map (buffer, GST_MAP_READ, &rtp));
+  *pt = gst_rtp_buffer_get_payload_type (&rtp);
+  *seqnum = gst_rtp_buffer_get_seq (&rtp);
+  gst_rtp_buffer_unmap (&rtp);
+}
+
+static GstElement *
+setup_element (const gchar * factory, const gchar * format)
+{
+  GstElement *element;
+
+  element = gst_check_setup_element (factory);
+  gst_util_set_object_arg (G_OBJECT (element), "format", format);
+  g_object_set (element, "pt", FEC_PT, NULL);
+  mysrcpad = gst_check_setup_src_pad (element, &srctemplate);
+  mysinkpad = gst_check_setup_sink_pad (element, &sinktemplate);
+  gst_pad_set_active (mysrcpad, TRUE);
+  gst_pad_set_active (mysinkpad, TRUE);
+
+  return element;
+}
+
+static void
+cleanup_element (GstElement * element)
+{
+  gst_pad_set_active (mysrcpad, FALSE);
+  gst_pad_set_active (mysinkpad, FALSE);
+  gst_check_teardown_src_pad (element);
+  gst_check_teardown_sink_pad (element);
+  gst_check_teardown_element (element);
+}
+
+/* encode @num_packets packets, drop the media packets in @lost and check
+ * that the decoder recovers them all */
+static void
+run_fec_test (const gchar * format, guint columns, guint rows,
+    gboolean row_fec, guint num_packets, const guint16 * lost, guint n_lost,
+    guint expected_fec)
+{
+  GstElement *enc, *dec;
+  GList *encoded, *walk;
+  gboolean *seen;
+  guint num_fec, num_recovered, i;
+
+  /* encode */
+  enc = setup_element ("rtpfecenc", format);
+  g_object_set (enc, "columns", columns, "rows", rows, "row-fec", row_fec,
+      NULL);
+  fail_unless (gst_element_set_state (enc, GST_STATE_PLAYING) ==
+      GST_STATE_CHANGE_SUCCESS);
+
+  for (i = 0; i < num_packets; i++)
+    fail_unless (gst_pad_push (mysrcpad, create_rtp_buffer (i)) ==
+        GST_FLOW_OK);
+
+  g_object_get (enc, "num-fec-packets", &num_fec, NULL);
+  fail_unless_equals_int (num_fec, expected_fec);
+  fail_unless_equals_int (g_list_length (buffers), num_packets + num_fec);
+
+  encoded = buffers;
+  buffers = NULL;
+  fail_unless (gst_element_set_state (enc, GST_STATE_NULL) ==
+      GST_STATE_CHANGE_SUCCESS);
+  cleanup_element (enc);
+
+  /* decode with losses */
+  dec = setup_element ("rtpfecdec", format);
+  fail_unless (gst_element_set_state (dec, GST_STATE_PLAYING) ==
+      GST_STATE_CHANGE_SUCCESS);
+
+  for (walk = encoded; walk; walk = walk->next) {
+    GstBuffer *buffer = walk->data;
+    gboolean drop = FALSE;
+    guint16 seqnum;
+    guint8 pt;
+
+    get_rtp_info (buffer, &pt, &seqnum);
+    if (pt == MEDIA_PT) {
+      for (i = 0; i < n_lost; i++)
+        drop |= (lost[i] == seqnum);
+    }
+    if (drop)
+      gst_buffer_unref (buffer);
+    else
+      fail_unless (gst_pad_push (mysrcpad, buffer) == GST_FLOW_OK);
+  }
+  g_list_free (encoded);
+
+  /* all media packets and no FEC packets come out */
+  fail_unless_equals_int (g_list_length (buffers), num_packets);
+  seen = g_new0 (gboolean, num_packets);
+  for (walk = buffers; walk; walk = walk->next) {
+    guint16 seqnum;
+    guint8 pt;
+
+    get_rtp_info (walk->data, &pt, &seqnum);
+    fail_unless (seqnum < num_packets);
+    fail_if (seen[seqnum]);
+    seen[seqnum] = TRUE;
+    /* SMPTE 2022-1 doesn't protect the marker bit */
+    check_rtp_buffer (walk->data, seqnum, g_str_equal (format, "ulpfec"));
+  }
+  g_free (seen);
+
+  g_object_get (dec, "num-recovered", &num_recovered, NULL);
+  fail_unless_equals_int (num_recovered, n_lost);
+
+  gst_check_drop_buffers ();
+  fail_unless (gst_element_set_state (dec, GST_STATE_NULL) ==
+      GST_STATE_CHANGE_SUCCESS);
+  cleanup_element (dec);
+}
+
+GST_START_TEST (test_ulpfec_row)
+{
+  /* one loss in each row of 5 packets */
+  static const guint16 lost[] = { 2, 5, 14 };
+
+  run_fec_test ("ulpfec", 5, 0, TRUE, 20, lost, G_N_ELEMENTS (lost), 4);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_ulpfec_column)
+{
+  /* a burst of 4 packets is recovered by the column FEC */
+  static const guint16 lost[] = { 5, 6, 7, 8 };
+
+  run_fec_test ("ulpfec", 4, 4, FALSE, 32, lost, G_N_ELEMENTS (lost), 8);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_smpte_2022_1)
+{
+  /* a lost row and a loss in another row: the row FEC recovers packet 13
+   * and the column FEC the complete row */
+  static const guint16 lost[] = { 4, 5, 6, 7, 13 };
+
+  run_fec_test ("smpte-2022-1", 4, 4, TRUE, 16, lost, G_N_ELEMENTS (lost),
+      8);
+}
+
+GST_END_TEST;
+
+static Suite *
+rtpfec_suite (void)
+{
+  Suite *s = suite_create ("rtpfec");
+  TCase *tc_chain = tcase_create ("general");
+
+  suite_add_tcase (s, tc_chain);
+  tcase_add_test (tc_chain, test_ulpfec_row);
+  tcase_add_test (tc_chain, test_ulpfec_column);
+  tcase_add_test (tc_chain, test_smpte_2022_1);
+
+  return s;
+}
+
+GST_CHECK_MAIN (rtpfec);
@@ -0,0 +1,397 @@
+/* GStreamer
+ *
+ * unit test for rtph264depay
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#include <gst/check/gstcheck.h>
+#include <gst/rtp/gstrtpbuffer.h>
+
+static GstPad *mysrcpad, *mysinkpad;
+
+/* the depayloader outputs one buffer per NAL in byte-stream and one buffer
+ * per access unit in AVC */
+static GstStaticPadTemplate bytestream_sinktemplate =
+GST_STATIC_PAD_TEMPLATE ("sink",
+    GST_PAD_SINK,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS ("video/x-h264, stream-format = (string) byte-stream, "
+        "alignment = (string) nal")
+    );
+static GstStaticPadTemplate avc_sinktemplate = GST_STATIC_PAD_TEMPLATE ("sink",
+    GST_PAD_SINK,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS ("video/x-h264, stream-format = (string) avc, "
+        "alignment = (string) au")
+    );
+static GstStaticPadTemplate srctemplate = GST_STATIC_PAD_TEMPLATE ("src",
+    GST_PAD_SRC,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS ("application/x-rtp")
+    );
+
+/* baseline profile SPS and PPS, both with id 0 */
+static const guint8 sps[] = { 0x67, 0x42, 0xc0, 0x1e, 0x80 };
+static const guint8 pps[] = { 0x68, 0xce };
+
+static const guint8 sync_bytes[] = { 0, 0, 0, 1 };
+
+enum
+{
+  FORMAT_BYTE_STREAM,
+  FORMAT_AVC
+};
+
+static GstElement *
+setup_rtph264depay (gint format)
+{
+  GstElement *depay;
+  GstSegment segment;
+  GstCaps *caps;
+
+  depay = gst_check_setup_element ("rtph264depay");
+  mysrcpad = gst_check_setup_src_pad (depay, &srctemplate);
+  if (format == FORMAT_AVC)
+    mysinkpad = gst_check_setup_sink_pad (depay, &avc_sinktemplate);
+  else
+    mysinkpad = gst_check_setup_sink_pad (depay, &bytestream_sinktemplate);
+  gst_pad_set_active (mysrcpad, TRUE);
+  gst_pad_set_active (mysinkpad, TRUE);
+
+  fail_unless (gst_element_set_state (depay, GST_STATE_PLAYING) ==
+      GST_STATE_CHANGE_SUCCESS);
+
+  caps = gst_caps_new_simple ("application/x-rtp",
+      "media", G_TYPE_STRING, "video", "clock-rate", G_TYPE_INT, 90000,
+      "encoding-name", G_TYPE_STRING, "H264", NULL);
+  if (format == FORMAT_AVC) {
+    gchar *sps_str, *pps_str, *sprop;
+
+    /* AVC needs the parameter sets for the codec_data */
+    sps_str = g_base64_encode (sps, sizeof (sps));
+    pps_str = g_base64_encode (pps, sizeof (pps));
+    sprop = g_strdup_printf ("%s,%s", sps_str, pps_str);
+    gst_caps_set_simple (caps, "sprop-parameter-sets", G_TYPE_STRING, sprop,
+        NULL);
+    g_free (sprop);
+    g_free (pps_str);
+    g_free (sps_str);
+  }
+
+  gst_pad_push_event (mysrcpad, gst_event_new_stream_start ("test"));
+  fail_unless (gst_pad_set_caps (mysrcpad, caps));
+  gst_caps_unref (caps);
+  gst_segment_init (&segment, GST_FORMAT_TIME);
+  gst_pad_push_event (mysrcpad, gst_event_new_segment (&segment));
+
+  return depay;
+}
+
+static void
+cleanup_rtph264depay (GstElement * depay)
+{
+  gst_check_drop_buffers ();
+
+  fail_unless (gst_element_set_state (depay, GST_STATE_NULL) ==
+      GST_STATE_CHANGE_SUCCESS);
+  gst_pad_set_active (mysrcpad, FALSE);
+  gst_pad_set_active (mysinkpad, FALSE);
+  gst_check_teardown_src_pad (depay);
+  gst_check_teardown_sink_pad (depay);
+  gst_check_teardown_element (depay);
+}
+
+/* make a NAL of @size bytes with @header. The byte after the header has
+ * the top bit set, which makes first_mb_in_slice 0 for slices. */
+static guint8 *
+create_nal (guint8 header, gsize size)
+{
+  guint8 *nal;
+  gsize i;
+
+  nal = g_malloc (size);
+  nal[0] = header;
+  for (i = 1; i < size; i++)
+    nal[i] = 0x80 | (i & 0x7f);
+
+  return nal;
+}
+
+static void
+push_rtp (guint16 seqnum, gboolean marker, const guint8 * data1, gsize size1,
+    const guint8 * data2, gsize size2)
+{
+  GstRTPBuffer rtp = GST_RTP_BUFFER_INIT;
+  GstBuffer *buffer;
+  guint8 *payload;
+
+  buffer = gst_rtp_buffer_new_allocate (size1 + size2, 0, 0);
+  gst_rtp_buffer_map (buffer, GST_MAP_WRITE, &rtp);
+  gst_rtp_buffer_set_payload_type (&rtp, 96);
+  gst_rtp_buffer_set_seq (&rtp, seqnum);
+  gst_rtp_buffer_set_timestamp (&rtp, 3000);
+  gst_rtp_buffer_set_marker (&rtp, marker);
+  payload = gst_rtp_buffer_get_payload (&rtp);
+  memcpy (payload, data1, size1);
+  if (size2)
+    memcpy (payload + size1, data2, size2);
+  gst_rtp_buffer_unmap (&rtp);
+
+  fail_unless (gst_pad_push (mysrcpad, buffer) == GST_FLOW_OK);
+}
+
+/* push @nal as FU-A packets of @frag_size bytes starting at @seqnum.
+ * Packets that have their index in the @lost bitmask are not pushed.
+ * Returns the next seqnum. */
+static guint16
+push_fu_a (guint16 seqnum, const guint8 * nal, gsize size, gsize frag_size,
+    guint lost)
+{
+  guint8 fu[2];
+  gsize offset, len;
+  guint i;
+
+  /* FU indicator with the NRI of the NAL, FU header with its type */
+  fu[0] = (nal[0] & 0xe0) | 28;
+  for (offset = 1, i = 0; offset < size; offset += len, i++) {
+    len = MIN (frag_size, size - offset);
+
+    fu[1] = nal[0] & 0x1f;
+    if (offset == 1)
+      fu[1] |= 0x80;
+    if (offset + len == size)
+      fu[1] |= 0x40;
+
+    if (!(lost & (1 << i)))
+      push_rtp (seqnum, offset + len == size, fu, 2, nal + offset, len);
+    seqnum++;
+  }
+
+  return seqnum;
+}
+
+/* append @nal with the start code or the AVC length in front of it */
+static void
+append_nal (GByteArray * expected, gint format, const guint8 * nal,
+    gsize size)
+{
+  guint8 len[4];
+
+  if (format == FORMAT_AVC) {
+    GST_WRITE_UINT32_BE (len, size);
+    g_byte_array_append (expected, len, 4);
+  } else {
+    g_byte_array_append (expected, sync_bytes, 4);
+  }
+  g_byte_array_append (expected, nal, size);
+}
+
+static void
+check_buffer (GstBuffer * buffer, GByteArray * expected)
+{
+  GstMapInfo map;
+
+  gst_buffer_map (buffer, &map, GST_MAP_READ);
+  fail_unless_equals_int (map.size, expected->len);
+  fail_unless (memcmp (map.data, expected->data, map.size) == 0);
+  gst_buffer_unmap (buffer, &map);
+}
+
+static void
+check_src_caps (gint format)
+{
+  GstCaps *caps;
+  GstStructure *s;
+  const GValue *codec_data;
+
+  caps = gst_pad_get_current_caps (mysinkpad);
+  fail_unless (caps != NULL);
+  s = gst_caps_get_structure (caps, 0);
+  fail_unless (gst_structure_has_name (s, "video/x-h264"));
+  if (format == FORMAT_AVC) {
+    fail_unless_equals_string (gst_structure_get_string (s, "stream-format"),
+        "avc");
+    codec_data = gst_structure_get_value (s, "codec_data");
+    fail_unless (codec_data != NULL);
+  } else {
+    fail_unless_equals_string (gst_structure_get_string (s, "stream-format"),
+        "byte-stream");
+  }
+  gst_caps_unref (caps);
+}
+
+GST_START_TEST (test_depay_single_nal)
+{
+  GstElement *depay;
+  GByteArray *expected;
+  guint8 *idr, *slice;
+  GstBuffer *buffer;
+
+  depay = setup_rtph264depay (__i__);
+  idr = create_nal (0x65, 100);
+  slice = create_nal (0x41, 60);
+
+  /* every packet is a complete picture */
+  push_rtp (0, TRUE, idr, 100, NULL, 0);
+  push_rtp (1, TRUE, slice, 60, NULL, 0);
+  fail_unless_equals_int (g_list_length (buffers), 2);
+  check_src_caps (__i__);
+
+  expected = g_byte_array_new ();
+  append_nal (expected, __i__, idr, 100);
+  buffer = buffers->data;
+  check_buffer (buffer, expected);
+  fail_if (GST_BUFFER_FLAG_IS_SET (buffer, GST_BUFFER_FLAG_DELTA_UNIT));
+
+  g_byte_array_set_size (expected, 0);
+  append_nal (expected, __i__, slice, 60);
+  buffer = buffers->next->data;
+  check_buffer (buffer, expected);
+  fail_unless (GST_BUFFER_FLAG_IS_SET (buffer, GST_BUFFER_FLAG_DELTA_UNIT));
+
+  g_byte_array_free (expected, TRUE);
+  g_free (slice);
+  g_free (idr);
+  cleanup_rtph264depay (depay);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_depay_stap_a)
+{
+  GstElement *depay;
+  GByteArray *packet, *expected;
+  guint8 *idr1, *idr2;
+  guint8 header[2];
+
+  depay = setup_rtph264depay (__i__);
+  idr1 = create_nal (0x65, 40);
+  idr2 = create_nal (0x65, 70);
+
+  /* STAP-A header with the highest NRI followed by the sizes and NALs */
+  packet = g_byte_array_new ();
+  header[0] = 0x60 | 24;
+  g_byte_array_append (packet, header, 1);
+  GST_WRITE_UINT16_BE (header, 40);
+  g_byte_array_append (packet, header, 2);
+  g_byte_array_append (packet, idr1, 40);
+  GST_WRITE_UINT16_BE (header, 70);
+  g_byte_array_append (packet, header, 2);
+  g_byte_array_append (packet, idr2, 70);
+
+  push_rtp (0, TRUE, packet->data, packet->len, NULL, 0);
+
+  /* both NALs come out in one buffer */
+  fail_unless_equals_int (g_list_length (buffers), 1);
+  check_src_caps (__i__);
+  expected = g_byte_array_new ();
+  append_nal (expected, __i__, idr1, 40);
+  append_nal (expected, __i__, idr2, 70);
+  check_buffer (buffers->data, expected);
+  fail_if (GST_BUFFER_FLAG_IS_SET (buffers->data,
+          GST_BUFFER_FLAG_DELTA_UNIT));
+
+  g_byte_array_free (expected, TRUE);
+  g_byte_array_free (packet, TRUE);
+  g_free (idr2);
+  g_free (idr1);
+  cleanup_rtph264depay (depay);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_depay_fu_a)
+{
+  GstElement *depay;
+  GByteArray *expected;
+  guint16 seqnum;
+  guint8 *idr;
+
+  depay = setup_rtph264depay (__i__);
+  idr = create_nal (0x65, 1000);
+
+  /* 1000 bytes in 400 byte fragments make start, middle and end */
+  seqnum = push_fu_a (0, idr, 1000, 400, 0);
+  fail_unless_equals_int (seqnum, 3);
+
+  fail_unless_equals_int (g_list_length (buffers), 1);
+  check_src_caps (__i__);
+  expected = g_byte_array_new ();
+  append_nal (expected, __i__, idr, 1000);
+  check_buffer (buffers->data, expected);
+  fail_if (GST_BUFFER_FLAG_IS_SET (buffers->data,
+          GST_BUFFER_FLAG_DELTA_UNIT));
+
+  g_byte_array_free (expected, TRUE);
+  g_free (idr);
+  cleanup_rtph264depay (depay);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_depay_fu_a_loss)
+{
+  GstElement *depay;
+  GByteArray *expected;
+  guint16 seqnum;
+  guint8 *idr1, *idr2;
+
+  depay = setup_rtph264depay (__i__);
+  idr1 = create_nal (0x65, 1000);
+  idr2 = create_nal (0x65, 900);
+
+  /* the middle fragment of the first NAL is lost, the rest of it is dropped
+   * and the depayloader restarts at the next start fragment */
+  seqnum = push_fu_a (0, idr1, 1000, 400, 1 << 1);
+  fail_unless_equals_int (g_list_length (buffers), 0);
+  push_fu_a (seqnum, idr2, 900, 400, 0);
+
+  fail_unless_equals_int (g_list_length (buffers), 1);
+  expected = g_byte_array_new ();
+  append_nal (expected, __i__, idr2, 900);
+  check_buffer (buffers->data, expected);
+  fail_unless (GST_BUFFER_FLAG_IS_SET (buffers->data,
+          GST_BUFFER_FLAG_DISCONT));
+
+  g_byte_array_free (expected, TRUE);
+  g_free (idr2);
+  g_free (idr1);
+  cleanup_rtph264depay (depay);
+}
+
+GST_END_TEST;
+
+static Suite *
+rtph264depay_suite (void)
+{
+  Suite *s = suite_create ("rtph264depay");
+  TCase *tc_chain = tcase_create ("general");
+
+  suite_add_tcase (s, tc_chain);
+  tcase_add_loop_test (tc_chain, test_depay_single_nal, FORMAT_BYTE_STREAM,
+      FORMAT_AVC + 1);
+  tcase_add_loop_test (tc_chain, test_depay_stap_a, FORMAT_BYTE_STREAM,
+      FORMAT_AVC + 1);
+  tcase_add_loop_test (tc_chain, test_depay_fu_a, FORMAT_BYTE_STREAM,
+      FORMAT_AVC + 1);
+  tcase_add_loop_test (tc_chain, test_depay_fu_a_loss, FORMAT_BYTE_STREAM,
+      FORMAT_AVC + 1);
+
+  return s;
+}
+
+GST_CHECK_MAIN (rtph264depay);
@@ -0,0 +1,284 @@
+/* GStreamer
+ *
+ * unit test for rtph264pay
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#include <gst/check/gstcheck.h>
+#include <gst/rtp/gstrtpbuffer.h>
+
+#define TEST_SSRC 0x11223344
+#define TEST_MTU  1024
+
+static GstPad *mysrcpad, *mysinkpad;
+
+static GstStaticPadTemplate sinktemplate = GST_STATIC_PAD_TEMPLATE ("sink",
+    GST_PAD_SINK,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS ("application/x-rtp")
+    );
+static GstStaticPadTemplate srctemplate = GST_STATIC_PAD_TEMPLATE ("src",
+    GST_PAD_SRC,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS ("video/x-h264")
+    );
+
+/* avcC with 4 byte NAL lengths, one baseline SPS and one PPS */
+static const guint8 codec_data[] = {
+  0x01, 0x42, 0xc0, 0x1e, 0xff, 0xe1,
+  0x00, 0x05, 0x67, 0x42, 0xc0, 0x1e, 0x80,
+  0x01, 0x00, 0x02, 0x68, 0xce
+};
+
+static GstElement *
+setup_rtph264pay (void)
+{
+  GstElement *pay;
+  GstBuffer *buffer;
+  GstSegment segment;
+  GstCaps *caps;
+
+  pay = gst_check_setup_element ("rtph264pay");
+  g_object_set (pay, "mtu", TEST_MTU, "pt", 96, "ssrc", TEST_SSRC,
+      "seqnum-offset", 0, "timestamp-offset", 0, NULL);
+  mysrcpad = gst_check_setup_src_pad (pay, &srctemplate);
+  mysinkpad = gst_check_setup_sink_pad (pay, &sinktemplate);
+  gst_pad_set_active (mysrcpad, TRUE);
+  gst_pad_set_active (mysinkpad, TRUE);
+
+  fail_unless (gst_element_set_state (pay, GST_STATE_PLAYING) ==
+      GST_STATE_CHANGE_SUCCESS);
+
+  buffer = gst_buffer_new_and_alloc (sizeof (codec_data));
+  gst_buffer_fill (buffer, 0, codec_data, sizeof (codec_data));
+  caps = gst_caps_new_simple ("video/x-h264",
+      "stream-format", G_TYPE_STRING, "avc",
+      "alignment", G_TYPE_STRING, "au",
+      "codec_data", GST_TYPE_BUFFER, buffer, NULL);
+  gst_buffer_unref (buffer);
+
+  gst_pad_push_event (mysrcpad, gst_event_new_stream_start ("test"));
+  fail_unless (gst_pad_set_caps (mysrcpad, caps));
+  gst_caps_unref (caps);
+  gst_segment_init (&segment, GST_FORMAT_TIME);
+  gst_pad_push_event (mysrcpad, gst_event_new_segment (&segment));
+
+  return pay;
+}
+
+static void
+cleanup_rtph264pay (GstElement * pay)
+{
+  gst_check_drop_buffers ();
+
+  fail_unless (gst_element_set_state (pay, GST_STATE_NULL) ==
+      GST_STATE_CHANGE_SUCCESS);
+  gst_pad_set_active (mysrcpad, FALSE);
+  gst_pad_set_active (mysinkpad, FALSE);
+  gst_check_teardown_src_pad (pay);
+  gst_check_teardown_sink_pad (pay);
+  gst_check_teardown_element (pay);
+}
+
+/* make a NAL of @size bytes with @header */
+static guint8 *
+create_nal (guint8 header, gsize size)
+{
+  guint8 *nal;
+  gsize i;
+
+  nal = g_malloc (size);
+  nal[0] = header;
+  for (i = 1; i < size; i++)
+    nal[i] = 0x80 | (i & 0x7f);
+
+  return nal;
+}
+
+/* push an access unit with the NALs in the NULL terminated list of
+ * NAL and size pairs */
+static void
+push_au (GstClockTime pts, const guint8 * nal, guint size, ...)
+{
+  GstBuffer *buffer;
+  guint8 len[4];
+  va_list args;
+
+  buffer = gst_buffer_new ();
+  va_start (args, size);
+  while (nal) {
+    GstBuffer *part;
+
+    part = gst_buffer_new_and_alloc (4 + size);
+    GST_WRITE_UINT32_BE (len, size);
+    gst_buffer_fill (part, 0, len, 4);
+    gst_buffer_fill (part, 4, nal, size);
+    buffer = gst_buffer_append (buffer, part);
+
+    nal = va_arg (args, const guint8 *);
+    if (nal)
+      size = va_arg (args, guint);
+  }
+  va_end (args);
+
+  GST_BUFFER_PTS (buffer) = pts;
+  GST_BUFFER_DTS (buffer) = pts;
+  fail_unless (gst_pad_push (mysrcpad, buffer) == GST_FLOW_OK);
+}
+
+/* check the RTP header of @buffer and return its payload */
+static GBytes *
+check_rtp_packet (GstBuffer * buffer, guint16 seqnum, guint32 rtptime,
+    gboolean marker)
+{
+  GstRTPBuffer rtp = GST_RTP_BUFFER_INIT;
+  GBytes *payload;
+
+  fail_unless (gst_buffer_get_size (buffer) <= TEST_MTU);
+  fail_unless (gst_rtp_buffer_map (buffer, GST_MAP_READ, &rtp));
+  fail_unless_equals_int (gst_rtp_buffer_get_version (&rtp), 2);
+  fail_unless_equals_int (gst_rtp_buffer_get_payload_type (&rtp), 96);
+  fail_unless_equals_int (gst_rtp_buffer_get_ssrc (&rtp), TEST_SSRC);
+  fail_unless_equals_int (gst_rtp_buffer_get_seq (&rtp), seqnum);
+  fail_unless_equals_int (gst_rtp_buffer_get_timestamp (&rtp), rtptime);
+  fail_unless_equals_int (gst_rtp_buffer_get_marker (&rtp), marker);
+  payload = g_bytes_new (gst_rtp_buffer_get_payload (&rtp),
+      gst_rtp_buffer_get_payload_len (&rtp));
+  gst_rtp_buffer_unmap (&rtp);
+
+  return payload;
+}
+
+GST_START_TEST (test_h264pay_single_nal)
+{
+  GstElement *pay;
+  GBytes *payload;
+  guint8 *idr;
+
+  pay = setup_rtph264pay ();
+  idr = create_nal (0x65, 100);
+
+  push_au (0, idr, 100, NULL);
+
+  /* the NAL fits in one packet that ends the access unit */
+  fail_unless_equals_int (g_list_length (buffers), 1);
+  payload = check_rtp_packet (buffers->data, 0, 0, TRUE);
+  fail_unless_equals_int (g_bytes_get_size (payload), 100);
+  fail_unless (memcmp (g_bytes_get_data (payload, NULL), idr, 100) == 0);
+  fail_unless_equals_uint64 (GST_BUFFER_PTS (buffers->data), 0);
+  g_bytes_unref (payload);
+
+  g_free (idr);
+  cleanup_rtph264pay (pay);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_h264pay_au_marker)
+{
+  GstElement *pay;
+  GBytes *payload;
+  guint8 *slice1, *slice2;
+
+  pay = setup_rtph264pay ();
+  slice1 = create_nal (0x41, 50);
+  slice2 = create_nal (0x41, 60);
+
+  /* two slices in one access unit 1/10th second in, only the last packet
+   * has the marker and both have the RTP time of the access unit */
+  push_au (GST_SECOND / 10, slice1, 50, slice2, 60, NULL);
+
+  fail_unless_equals_int (g_list_length (buffers), 2);
+  payload = check_rtp_packet (buffers->data, 0, 9000, FALSE);
+  fail_unless_equals_int (g_bytes_get_size (payload), 50);
+  fail_unless (memcmp (g_bytes_get_data (payload, NULL), slice1, 50) == 0);
+  g_bytes_unref (payload);
+  payload = check_rtp_packet (buffers->next->data, 1, 9000, TRUE);
+  fail_unless_equals_int (g_bytes_get_size (payload), 60);
+  fail_unless (memcmp (g_bytes_get_data (payload, NULL), slice2, 60) == 0);
+  g_bytes_unref (payload);
+
+  g_free (slice2);
+  g_free (slice1);
+  cleanup_rtph264pay (pay);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_h264pay_fu_a)
+{
+  GstElement *pay;
+  GBytes *payload;
+  const guint8 *data;
+  guint8 *idr;
+  gsize size, offset, max_frag;
+  GList *node;
+  guint i;
+
+  pay = setup_rtph264pay ();
+  idr = create_nal (0x65, 2500);
+
+  push_au (GST_SECOND, idr, 2500, NULL);
+
+  /* the 2499 bytes after the NAL header go in fragments of at most the
+   * MTU minus the RTP header and the FU indicator and header */
+  max_frag = TEST_MTU - 12 - 2;
+  fail_unless_equals_int (g_list_length (buffers), 3);
+
+  offset = 1;
+  for (node = buffers, i = 0; node; node = node->next, i++) {
+    gboolean last = node->next == NULL;
+
+    payload = check_rtp_packet (node->data, i, 90000, last);
+    data = g_bytes_get_data (payload, &size);
+
+    /* FU indicator with the NRI of the NAL, FU header with start, end and
+     * the NAL type */
+    fail_unless (size > 2);
+    fail_unless_equals_int (data[0], (0x65 & 0x60) | 28);
+    fail_unless_equals_int (data[1], (i == 0 ? 0x80 : 0) | (last ? 0x40 : 0)
+        | 5);
+    if (!last)
+      fail_unless_equals_int (size - 2, max_frag);
+    fail_unless (memcmp (data + 2, idr + offset, size - 2) == 0);
+    offset += size - 2;
+
+    g_bytes_unref (payload);
+  }
+  fail_unless_equals_int (offset, 2500);
+
+  g_free (idr);
+  cleanup_rtph264pay (pay);
+}
+
+GST_END_TEST;
+
+static Suite *
+rtph264pay_suite (void)
+{
+  Suite *s = suite_create ("rtph264pay");
+  TCase *tc_chain = tcase_create ("general");
+
+  suite_add_tcase (s, tc_chain);
+  tcase_add_test (tc_chain, test_h264pay_single_nal);
+  tcase_add_test (tc_chain, test_h264pay_au_marker);
+  tcase_add_test (tc_chain, test_h264pay_fu_a);
+
+  return s;
+}
+
+GST_CHECK_MAIN (rtph264pay);
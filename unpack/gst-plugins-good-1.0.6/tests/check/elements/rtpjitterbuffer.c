@@ -319,6 +319,79 @@ GST_START_TEST (test_basetime)
 
 GST_END_TEST;
 
+static GMutex rtx_lock;
+static GCond rtx_cond;
+static GstStructure *rtx_request = NULL;
+
+static gboolean
+rtx_src_event (GstPad * pad, GstObject * parent, GstEvent * event)
+{
+  if (GST_EVENT_TYPE (event) == GST_EVENT_CUSTOM_UPSTREAM &&
+      gst_event_has_name (event, "GstRTPRetransmissionRequest")) {
+    g_mutex_lock (&rtx_lock);
+    if (rtx_request == NULL)
+      rtx_request = gst_structure_copy (gst_event_get_structure (event));
+    g_cond_signal (&rtx_cond);
+    g_mutex_unlock (&rtx_lock);
+  }
+  gst_event_unref (event);
+
+  return TRUE;
+}
+
+GST_START_TEST (test_rtx_request)
+{
+  GstElement *jitterbuffer;
+  const guint num_buffers = 4;
+  GstBuffer *buffer;
+  GList *node;
+  gint64 end_time;
+  guint seqnum, ssrc, retry;
+
+  jitterbuffer = setup_jitterbuffer (num_buffers);
+  gst_pad_set_event_function (mysrcpad, rtx_src_event);
+  g_object_set (jitterbuffer, "rtx-delay", 10, NULL);
+  /* enable retransmission before starting or while PLAYING */
+  if (__i__ == 0)
+    g_object_set (jitterbuffer, "do-retransmission", TRUE, NULL);
+  fail_unless (start_jitterbuffer (jitterbuffer)
+      == GST_STATE_CHANGE_SUCCESS, "could not set to playing");
+  if (__i__ == 1)
+    g_object_set (jitterbuffer, "do-retransmission", TRUE, NULL);
+
+  /* push buffers 0,1,3, packet 2 is lost */
+  for (node = inbuffers; node; node = g_list_next (node)) {
+    buffer = (GstBuffer *) node->data;
+    if (node == g_list_nth (inbuffers, 2)) {
+      gst_buffer_unref (buffer);
+      continue;
+    }
+    fail_unless (gst_pad_push (mysrcpad, buffer) == GST_FLOW_OK);
+  }
+
+  /* the missing packet should be requested well within the latency */
+  end_time = g_get_monotonic_time () + G_TIME_SPAN_SECOND;
+  g_mutex_lock (&rtx_lock);
+  while (rtx_request == NULL)
+    if (!g_cond_wait_until (&rtx_cond, &rtx_lock, end_time))
+      break;
+  g_mutex_unlock (&rtx_lock);
+
+  fail_unless (rtx_request != NULL, "no retransmission request");
+  fail_unless (gst_structure_get_uint (rtx_request, "seqnum", &seqnum));
+  fail_unless (gst_structure_get_uint (rtx_request, "ssrc", &ssrc));
+  fail_unless (gst_structure_get_uint (rtx_request, "retry", &retry));
+  fail_unless_equals_int (seqnum, 2);
+  fail_unless_equals_int (ssrc, 0x3c3a7c5b);
+  fail_unless_equals_int (retry, 0);
+
+  /* cleanup */
+  gst_structure_free (rtx_request);
+  rtx_request = NULL;
+  cleanup_jitterbuffer (jitterbuffer);
+}
+
+GST_END_TEST;
 
 static Suite *
 rtpjitterbuffer_suite (void)
@@ -331,6 +404,7 @@ rtpjitterbuffer_suite (void)
   tcase_add_test (tc_chain, test_push_backward_seq);
   tcase_add_test (tc_chain, test_push_unordered);
   tcase_add_test (tc_chain, test_basetime);
+  tcase_add_loop_test (tc_chain, test_rtx_request, 0, 2);
 
   /* FIXME: test buffer lists */
 
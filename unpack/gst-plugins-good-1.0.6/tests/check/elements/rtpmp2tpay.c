@@ -0,0 +1,178 @@
+/* GStreamer
+ *
+ * unit test for rtpmp2tpay
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#include <gst/check/gstcheck.h>
+#include <gst/rtp/gstrtpbuffer.h>
+
+#define TEST_SSRC 0x11223344
+#define TS_PACKET_SIZE 188
+/* room for the RTP header and 7 TS packets */
+#define TEST_MTU (12 + 7 * TS_PACKET_SIZE)
+
+static GstPad *mysrcpad, *mysinkpad;
+
+static GstStaticPadTemplate sinktemplate = GST_STATIC_PAD_TEMPLATE ("sink",
+    GST_PAD_SINK,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS ("application/x-rtp")
+    );
+static GstStaticPadTemplate srctemplate = GST_STATIC_PAD_TEMPLATE ("src",
+    GST_PAD_SRC,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS ("video/mpegts")
+    );
+
+static GstElement *
+setup_rtpmp2tpay (void)
+{
+  GstElement *pay;
+  GstSegment segment;
+  GstCaps *caps;
+
+  pay = gst_check_setup_element ("rtpmp2tpay");
+  g_object_set (pay, "mtu", TEST_MTU, "pt", 33, "ssrc", TEST_SSRC,
+      "seqnum-offset", 0, "timestamp-offset", 0, NULL);
+  mysrcpad = gst_check_setup_src_pad (pay, &srctemplate);
+  mysinkpad = gst_check_setup_sink_pad (pay, &sinktemplate);
+  gst_pad_set_active (mysrcpad, TRUE);
+  gst_pad_set_active (mysinkpad, TRUE);
+
+  fail_unless (gst_element_set_state (pay, GST_STATE_PLAYING) ==
+      GST_STATE_CHANGE_SUCCESS);
+
+  caps = gst_caps_new_simple ("video/mpegts",
+      "packetsize", G_TYPE_INT, TS_PACKET_SIZE,
+      "systemstream", G_TYPE_BOOLEAN, TRUE, NULL);
+  gst_pad_push_event (mysrcpad, gst_event_new_stream_start ("test"));
+  fail_unless (gst_pad_set_caps (mysrcpad, caps));
+  gst_caps_unref (caps);
+  gst_segment_init (&segment, GST_FORMAT_TIME);
+  gst_pad_push_event (mysrcpad, gst_event_new_segment (&segment));
+
+  return pay;
+}
+
+static void
+cleanup_rtpmp2tpay (GstElement * pay)
+{
+  gst_check_drop_buffers ();
+
+  fail_unless (gst_element_set_state (pay, GST_STATE_NULL) ==
+      GST_STATE_CHANGE_SUCCESS);
+  gst_pad_set_active (mysrcpad, FALSE);
+  gst_pad_set_active (mysinkpad, FALSE);
+  gst_check_teardown_src_pad (pay);
+  gst_check_teardown_sink_pad (pay);
+  gst_check_teardown_element (pay);
+}
+
+/* make @n TS packets, packet i is filled with @first + i after the sync
+ * byte */
+static GstBuffer *
+create_ts_packets (guint first, guint n, GstClockTime pts)
+{
+  GstBuffer *buffer;
+  GstMapInfo map;
+  guint i;
+
+  buffer = gst_buffer_new_and_alloc (n * TS_PACKET_SIZE);
+  gst_buffer_map (buffer, &map, GST_MAP_WRITE);
+  for (i = 0; i < n; i++) {
+    map.data[i * TS_PACKET_SIZE] = 0x47;
+    memset (map.data + i * TS_PACKET_SIZE + 1, first + i, TS_PACKET_SIZE - 1);
+  }
+  gst_buffer_unmap (buffer, &map);
+  GST_BUFFER_PTS (buffer) = pts;
+
+  return buffer;
+}
+
+/* check the RTP header of @buffer and that it carries @n TS packets made by
+ * create_ts_packets() starting at @first */
+static void
+check_rtp_packet (GstBuffer * buffer, guint16 seqnum, guint32 rtptime,
+    guint first, guint n)
+{
+  GstRTPBuffer rtp = GST_RTP_BUFFER_INIT;
+  guint8 *payload;
+  guint i, j;
+
+  fail_unless (gst_buffer_get_size (buffer) <= TEST_MTU);
+  fail_unless (gst_rtp_buffer_map (buffer, GST_MAP_READ, &rtp));
+  fail_unless_equals_int (gst_rtp_buffer_get_payload_type (&rtp), 33);
+  fail_unless_equals_int (gst_rtp_buffer_get_ssrc (&rtp), TEST_SSRC);
+  fail_unless_equals_int (gst_rtp_buffer_get_seq (&rtp), seqnum);
+  fail_unless_equals_int (gst_rtp_buffer_get_timestamp (&rtp), rtptime);
+  fail_if (gst_rtp_buffer_get_marker (&rtp));
+
+  fail_unless_equals_int (gst_rtp_buffer_get_payload_len (&rtp),
+      n * TS_PACKET_SIZE);
+  payload = gst_rtp_buffer_get_payload (&rtp);
+  for (i = 0; i < n; i++) {
+    fail_unless_equals_int (payload[0], 0x47);
+    for (j = 1; j < TS_PACKET_SIZE; j++)
+      fail_unless_equals_int (payload[j], (guint8) (first + i));
+    payload += TS_PACKET_SIZE;
+  }
+  gst_rtp_buffer_unmap (&rtp);
+}
+
+GST_START_TEST (test_mp2tpay_mtu)
+{
+  GstElement *pay;
+
+  pay = setup_rtpmp2tpay ();
+
+  /* 10 TS packets do not fit in the MTU, they are split in a full packet
+   * of 7 and one with the remaining 3, both with the same RTP time */
+  fail_unless (gst_pad_push (mysrcpad, create_ts_packets (0, 10,
+              0)) == GST_FLOW_OK);
+  fail_unless_equals_int (g_list_length (buffers), 2);
+  check_rtp_packet (g_list_nth_data (buffers, 0), 0, 0, 0, 7);
+  check_rtp_packet (g_list_nth_data (buffers, 1), 1, 0, 7, 3);
+  fail_unless_equals_uint64 (GST_BUFFER_PTS (g_list_nth_data (buffers, 1)),
+      0);
+
+  /* a buffer of more than one TS packet is sent out right away */
+  fail_unless (gst_pad_push (mysrcpad, create_ts_packets (10, 2,
+              GST_SECOND)) == GST_FLOW_OK);
+  fail_unless_equals_int (g_list_length (buffers), 3);
+  check_rtp_packet (g_list_nth_data (buffers, 2), 2, 90000, 10, 2);
+  fail_unless_equals_uint64 (GST_BUFFER_PTS (g_list_nth_data (buffers, 2)),
+      GST_SECOND);
+
+  cleanup_rtpmp2tpay (pay);
+}
+
+GST_END_TEST;
+
+static Suite *
+rtpmp2tpay_suite (void)
+{
+  Suite *s = suite_create ("rtpmp2tpay");
+  TCase *tc_chain = tcase_create ("general");
+
+  suite_add_tcase (s, tc_chain);
+  tcase_add_test (tc_chain, test_mp2tpay_mtu);
+
+  return s;
+}
+
+GST_CHECK_MAIN (rtpmp2tpay);
@@ -0,0 +1,550 @@
+/* GStreamer
+ *
+ * unit test for rtprtxsend and rtprtxreceive
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#include <gst/check/gstcheck.h>
+#include <gst/rtp/gstrtpbuffer.h>
+#include <gst/rtp/gstrtcpbuffer.h>
+
+#define MASTER_SSRC 0x11223344
+#define MASTER_PT   96
+#define RTX_PT      97
+
+static GstPad *mysrcpad, *mysinkpad;
+
+/* drops packets before they go out over UDP from the sender to the
+ * receiver */
+static GstPad *net_sinkpad, *net_srcpad;
+/* the RTCP packets sent by the receiver */
+static GstPad *rtcp_sinkpad, *rtcp_srcpad;
+static GList *rtcp_buffers;
+static GMutex rtcp_lock;
+static GCond rtcp_cond;
+
+static GstStaticPadTemplate sinktemplate = GST_STATIC_PAD_TEMPLATE ("sink",
+    GST_PAD_SINK,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS ("application/x-rtp")
+    );
+static GstStaticPadTemplate srctemplate = GST_STATIC_PAD_TEMPLATE ("src",
+    GST_PAD_SRC,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS ("application/x-rtp")
+    );
+static GstStaticPadTemplate rtcpsinktemplate = GST_STATIC_PAD_TEMPLATE ("sink",
+    GST_PAD_SINK,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS ("application/x-rtcp")
+    );
+static GstStaticPadTemplate rtcpsrctemplate = GST_STATIC_PAD_TEMPLATE ("src",
+    GST_PAD_SRC,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS ("application/x-rtcp")
+    );
+
+static GstBuffer *
+create_rtp_buffer (guint16 seqnum)
+{
+  GstRTPBuffer rtp = GST_RTP_BUFFER_INIT;
+  GstBuffer *buffer;
+  guint8 *payload;
+  guint i;
+
+  buffer = gst_rtp_buffer_new_allocate (20, 0, 0);
+  gst_rtp_buffer_map (buffer, GST_MAP_WRITE, &rtp);
+  gst_rtp_buffer_set_ssrc (&rtp, MASTER_SSRC);
+  gst_rtp_buffer_set_seq (&rtp, seqnum);
+  gst_rtp_buffer_set_payload_type (&rtp, MASTER_PT);
+  gst_rtp_buffer_set_timestamp (&rtp, seqnum * 160);
+  payload = gst_rtp_buffer_get_payload (&rtp);
+  for (i = 0; i < 20; i++)
+    payload[i] = seqnum + i;
+  gst_rtp_buffer_unmap (&rtp);
+
+  return buffer;
+}
+
+static void
+check_rtp_buffer (GstBuffer * buffer, guint16 seqnum)
+{
+  GstRTPBuffer rtp = GST_RTP_BUFFER_INIT;
+  guint8 *payload;
+  guint i;
+
+  fail_unless (gst_rtp_buffer_map (buffer, GST_MAP_READ, &rtp));
+  fail_unless_equals_int (gst_rtp_buffer_get_ssrc (&rtp), MASTER_SSRC);
+  fail_unless_equals_int (gst_rtp_buffer_get_seq (&rtp), seqnum);
+  fail_unless_equals_int (gst_rtp_buffer_get_payload_type (&rtp), MASTER_PT);
+  fail_unless_equals_int (gst_rtp_buffer_get_timestamp (&rtp), seqnum * 160);
+  fail_unless_equals_int (gst_rtp_buffer_get_payload_len (&rtp), 20);
+  payload = gst_rtp_buffer_get_payload (&rtp);
+  for (i = 0; i < 20; i++)
+    fail_unless_equals_int (payload[i], (guint8) (seqnum + i));
+  gst_rtp_buffer_unmap (&rtp);
+}
+
+/* retransmissions are pushed from the src pad task of rtprtxsend */
+static void
+wait_for_buffers (guint n)
+{
+  g_mutex_lock (&check_mutex);
+  while (g_list_length (buffers) < n)
+    g_cond_wait (&check_cond, &check_mutex);
+  g_mutex_unlock (&check_mutex);
+}
+
+static GstEvent *
+create_rtx_request (guint seqnum)
+{
+  return gst_event_new_custom (GST_EVENT_CUSTOM_UPSTREAM,
+      gst_structure_new ("GstRTPRetransmissionRequest",
+          "seqnum", G_TYPE_UINT, seqnum,
+          "ssrc", G_TYPE_UINT, (guint) MASTER_SSRC, NULL));
+}
+
+GST_START_TEST (test_rtx_roundtrip)
+{
+  GstElement *rtxsend, *rtxreceive;
+  GstStructure *pt_map;
+  GstPad *srcpad, *sinkpad;
+  GstRTPBuffer rtp = GST_RTP_BUFFER_INIT;
+  guint num_requests, num_rtx_sent, num_rtx_received, num_assoc_failed;
+  guint16 seqnum;
+
+  rtxsend = gst_check_setup_element ("rtprtxsend");
+  rtxreceive = gst_check_setup_element ("rtprtxreceive");
+
+  pt_map = gst_structure_new ("application/x-rtp-pt-map",
+      "96", G_TYPE_UINT, RTX_PT, NULL);
+  g_object_set (rtxsend, "payload-type-map", pt_map, NULL);
+  g_object_set (rtxreceive, "payload-type-map", pt_map, NULL);
+  gst_structure_free (pt_map);
+
+  /* mysrcpad ! rtprtxsend ! rtprtxreceive ! mysinkpad */
+  mysrcpad = gst_check_setup_src_pad (rtxsend, &srctemplate);
+  mysinkpad = gst_check_setup_sink_pad (rtxreceive, &sinktemplate);
+  srcpad = gst_element_get_static_pad (rtxsend, "src");
+  sinkpad = gst_element_get_static_pad (rtxreceive, "sink");
+  fail_unless (gst_pad_link (srcpad, sinkpad) == GST_PAD_LINK_OK);
+  gst_pad_set_active (mysrcpad, TRUE);
+  gst_pad_set_active (mysinkpad, TRUE);
+
+  fail_unless (gst_element_set_state (rtxsend, GST_STATE_PLAYING) ==
+      GST_STATE_CHANGE_SUCCESS);
+  fail_unless (gst_element_set_state (rtxreceive, GST_STATE_PLAYING) ==
+      GST_STATE_CHANGE_SUCCESS);
+
+  for (seqnum = 0; seqnum < 5; seqnum++)
+    fail_unless (gst_pad_push (mysrcpad, create_rtp_buffer (seqnum)) ==
+        GST_FLOW_OK);
+  fail_unless_equals_int (g_list_length (buffers), 5);
+
+  /* request packet 2, it is retransmitted right away, without waiting for
+   * the next packet, and the receiver restores the original packet */
+  fail_unless (gst_pad_push_event (mysinkpad, create_rtx_request (2)));
+  wait_for_buffers (6);
+  /* packet 100 was never sent and can't be retransmitted */
+  fail_unless (gst_pad_push_event (mysinkpad, create_rtx_request (100)));
+  fail_unless (gst_pad_push (mysrcpad, create_rtp_buffer (5)) == GST_FLOW_OK);
+
+  wait_for_buffers (7);
+  fail_unless_equals_int (g_list_length (buffers), 7);
+  check_rtp_buffer (g_list_nth_data (buffers, 5), 2);
+  check_rtp_buffer (g_list_nth_data (buffers, 6), 5);
+
+  g_object_get (rtxsend, "num-rtx-requests", &num_requests,
+      "num-rtx-packets", &num_rtx_sent, NULL);
+  g_object_get (rtxreceive, "num-rtx-packets", &num_rtx_received, NULL);
+  fail_unless_equals_int (num_requests, 2);
+  fail_unless_equals_int (num_rtx_sent, 1);
+  fail_unless_equals_int (num_rtx_received, 1);
+
+  /* a retransmission packet of an unknown stream can't be associated */
+  {
+    GstBuffer *buffer = create_rtp_buffer (0);
+
+    gst_rtp_buffer_map (buffer, GST_MAP_WRITE, &rtp);
+    gst_rtp_buffer_set_payload_type (&rtp, RTX_PT);
+    gst_rtp_buffer_set_ssrc (&rtp, 0x55667788);
+    gst_rtp_buffer_unmap (&rtp);
+
+    fail_unless (gst_element_set_state (rtxreceive, GST_STATE_READY) ==
+        GST_STATE_CHANGE_SUCCESS);
+    fail_unless (gst_element_set_state (rtxreceive, GST_STATE_PLAYING) ==
+        GST_STATE_CHANGE_SUCCESS);
+    fail_unless (gst_pad_chain (sinkpad, buffer) == GST_FLOW_OK);
+    fail_unless_equals_int (g_list_length (buffers), 7);
+    g_object_get (rtxreceive, "num-rtx-packets", &num_rtx_received,
+        "num-rtx-assoc-failed", &num_assoc_failed, NULL);
+    fail_unless_equals_int (num_rtx_received, 0);
+    fail_unless_equals_int (num_assoc_failed, 1);
+  }
+
+  /* cleanup */
+  gst_check_drop_buffers ();
+  gst_object_unref (srcpad);
+  gst_object_unref (sinkpad);
+  gst_pad_set_active (mysrcpad, FALSE);
+  gst_pad_set_active (mysinkpad, FALSE);
+  gst_check_teardown_src_pad (rtxsend);
+  gst_check_teardown_sink_pad (rtxreceive);
+  gst_check_teardown_element (rtxsend);
+  gst_check_teardown_element (rtxreceive);
+}
+
+GST_END_TEST;
+
+/* forwards everything from the sender to udpsink except the original
+ * packets 3 and 4 */
+static GstFlowReturn
+lossy_link_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
+{
+  GstRTPBuffer rtp = GST_RTP_BUFFER_INIT;
+  guint16 seqnum;
+  guint8 pt;
+
+  fail_unless (gst_rtp_buffer_map (buffer, GST_MAP_READ, &rtp));
+  seqnum = gst_rtp_buffer_get_seq (&rtp);
+  pt = gst_rtp_buffer_get_payload_type (&rtp);
+  gst_rtp_buffer_unmap (&rtp);
+
+  if (pt == MASTER_PT && (seqnum == 3 || seqnum == 4)) {
+    gst_buffer_unref (buffer);
+    return GST_FLOW_OK;
+  }
+  return gst_pad_push (net_srcpad, buffer);
+}
+
+static gboolean
+lossy_link_event (GstPad * pad, GstObject * parent, GstEvent * event)
+{
+  return gst_pad_push_event (net_srcpad, event);
+}
+
+static GstFlowReturn
+rtcp_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
+{
+  g_mutex_lock (&rtcp_lock);
+  rtcp_buffers = g_list_append (rtcp_buffers, buffer);
+  g_cond_signal (&rtcp_cond);
+  g_mutex_unlock (&rtcp_lock);
+
+  return GST_FLOW_OK;
+}
+
+/* get the PID and BLP of the Generic NACK in @buffer */
+static gboolean
+parse_nack (GstBuffer * buffer, guint16 * pid, guint16 * blp)
+{
+  GstRTCPBuffer rtcp = GST_RTCP_BUFFER_INIT;
+  GstRTCPPacket packet;
+  gboolean more, found = FALSE;
+  guint8 *fci;
+
+  fail_unless (gst_rtcp_buffer_validate (buffer));
+  gst_rtcp_buffer_map (buffer, GST_MAP_READ, &rtcp);
+  for (more = gst_rtcp_buffer_get_first_packet (&rtcp, &packet);
+      more && !found; more = gst_rtcp_packet_move_to_next (&packet)) {
+    if (gst_rtcp_packet_get_type (&packet) != GST_RTCP_TYPE_RTPFB ||
+        gst_rtcp_packet_fb_get_type (&packet) != GST_RTCP_RTPFB_TYPE_NACK)
+      continue;
+
+    fail_unless_equals_int (gst_rtcp_packet_fb_get_media_ssrc (&packet),
+        MASTER_SSRC);
+    fail_unless_equals_int (gst_rtcp_packet_fb_get_fci_length (&packet), 1);
+    fci = gst_rtcp_packet_fb_get_fci (&packet);
+    *pid = GST_READ_UINT16_BE (fci);
+    *blp = GST_READ_UINT16_BE (fci + 2);
+    found = TRUE;
+  }
+  gst_rtcp_buffer_unmap (&rtcp);
+
+  return found;
+}
+
+/* wait for an RTCP packet of the receiver with a Generic NACK */
+static GstBuffer *
+wait_for_nack (guint16 * pid, guint16 * blp)
+{
+  GstBuffer *buffer, *nack = NULL;
+
+  g_mutex_lock (&rtcp_lock);
+  while (nack == NULL) {
+    while (rtcp_buffers == NULL)
+      g_cond_wait (&rtcp_cond, &rtcp_lock);
+
+    buffer = rtcp_buffers->data;
+    rtcp_buffers = g_list_delete_link (rtcp_buffers, rtcp_buffers);
+    if (parse_nack (buffer, pid, blp))
+      nack = buffer;
+    else
+      gst_buffer_unref (buffer);
+  }
+  g_mutex_unlock (&rtcp_lock);
+
+  return nack;
+}
+
+static GstPad *
+link_request_pad (GstPad * srcpad, GstElement * element, const gchar * name)
+{
+  GstPad *pad;
+
+  pad = gst_element_get_request_pad (element, name);
+  fail_unless (pad != NULL);
+  fail_unless (gst_pad_link (srcpad, pad) == GST_PAD_LINK_OK);
+
+  return pad;
+}
+
+static void
+link_static_pads (GstElement * src, const gchar * srcname, GstPad * sinkpad)
+{
+  GstPad *srcpad;
+
+  srcpad = gst_element_get_static_pad (src, srcname);
+  fail_unless (srcpad != NULL);
+  fail_unless (gst_pad_link (srcpad, sinkpad) == GST_PAD_LINK_OK);
+  gst_object_unref (srcpad);
+}
+
+static void
+release_request_pad (GstElement * element, GstPad * pad)
+{
+  GstPad *peer;
+
+  if ((peer = gst_pad_get_peer (pad))) {
+    gst_pad_unlink (peer, pad);
+    gst_object_unref (peer);
+  }
+  gst_element_release_request_pad (element, pad);
+  gst_object_unref (pad);
+}
+
+GST_START_TEST (test_rtx_nack_roundtrip)
+{
+  GstElement *rtxsend, *sender, *rtxreceive, *receiver, *udpsink, *udpsrc;
+  GstPad *rtxsend_src, *rtxreceive_sink, *send_rtp_sink, *recv_rtcp_sink;
+  GstPad *udpsink_sink, *udpsrc_src;
+  GstPad *recv_rtp_sink, *send_rtcp_src;
+  GstStructure *pt_map;
+  GObject *internal;
+  GstSegment segment;
+  GstCaps *caps;
+  GstBuffer *nack;
+  guint num_rtx_sent, num_rtx_received;
+  guint16 seqnum, pid, blp;
+  gint port;
+
+  /* mysrcpad ! rtprtxsend ! sender -> lossy link -> udpsink, udpsrc !
+   * rtprtxreceive ! receiver ! mysinkpad, the RTCP of the receiver goes
+   * back to the sender */
+  rtxsend = gst_check_setup_element ("rtprtxsend");
+  rtxreceive = gst_check_setup_element ("rtprtxreceive");
+  sender = gst_check_setup_element ("rtpsession");
+  receiver = gst_check_setup_element ("rtpsession");
+  udpsink = gst_check_setup_element ("udpsink");
+  udpsrc = gst_check_setup_element ("udpsrc");
+
+  caps = gst_caps_new_simple ("application/x-rtp",
+      "media", G_TYPE_STRING, "audio", "clock-rate", G_TYPE_INT, 8000,
+      "payload", G_TYPE_INT, MASTER_PT, NULL);
+
+  /* let udpsrc pick a free port and send to that */
+  g_object_set (udpsrc, "port", 0, "caps", caps, NULL);
+  fail_unless (gst_element_set_state (udpsrc, GST_STATE_PAUSED) ==
+      GST_STATE_CHANGE_NO_PREROLL);
+  g_object_get (udpsrc, "port", &port, NULL);
+  fail_unless (port != 0);
+  g_object_set (udpsink, "host", "127.0.0.1", "port", port, "sync", FALSE,
+      "async", FALSE, NULL);
+
+  pt_map = gst_structure_new ("application/x-rtp-pt-map",
+      "96", G_TYPE_UINT, RTX_PT, NULL);
+  g_object_set (rtxsend, "payload-type-map", pt_map, NULL);
+  g_object_set (rtxreceive, "payload-type-map", pt_map, NULL);
+  gst_structure_free (pt_map);
+
+  /* the NACKs are about the SSRC the sender uses */
+  g_object_get (sender, "internal-session", &internal, NULL);
+  g_object_set (internal, "internal-ssrc", MASTER_SSRC, NULL);
+  g_object_unref (internal);
+  g_object_set (receiver, "probation", 0, NULL);
+
+  mysrcpad = gst_check_setup_src_pad (rtxsend, &srctemplate);
+  rtxsend_src = gst_element_get_static_pad (rtxsend, "src");
+  send_rtp_sink = link_request_pad (rtxsend_src, sender, "send_rtp_sink");
+
+  net_sinkpad = gst_pad_new_from_static_template (&sinktemplate, "net_sink");
+  gst_pad_set_chain_function (net_sinkpad, lossy_link_chain);
+  gst_pad_set_event_function (net_sinkpad, lossy_link_event);
+  link_static_pads (sender, "send_rtp_src", net_sinkpad);
+
+  net_srcpad = gst_pad_new_from_static_template (&srctemplate, "net_src");
+  udpsink_sink = gst_element_get_static_pad (udpsink, "sink");
+  fail_unless (gst_pad_link (net_srcpad, udpsink_sink) == GST_PAD_LINK_OK);
+  udpsrc_src = gst_element_get_static_pad (udpsrc, "src");
+  rtxreceive_sink = gst_element_get_static_pad (rtxreceive, "sink");
+  fail_unless (gst_pad_link (udpsrc_src, rtxreceive_sink) == GST_PAD_LINK_OK);
+  recv_rtp_sink = gst_element_get_request_pad (receiver, "recv_rtp_sink");
+  link_static_pads (rtxreceive, "src", recv_rtp_sink);
+
+  mysinkpad = gst_pad_new_from_static_template (&sinktemplate, "sink");
+  gst_pad_set_chain_function (mysinkpad, gst_check_chain_func);
+  link_static_pads (receiver, "recv_rtp_src", mysinkpad);
+
+  rtcp_sinkpad = gst_pad_new_from_static_template (&rtcpsinktemplate,
+      "rtcp_sink");
+  gst_pad_set_chain_function (rtcp_sinkpad, rtcp_chain);
+  send_rtcp_src = gst_element_get_request_pad (receiver, "send_rtcp_src");
+  fail_unless (gst_pad_link (send_rtcp_src, rtcp_sinkpad) == GST_PAD_LINK_OK);
+
+  rtcp_srcpad = gst_pad_new_from_static_template (&rtcpsrctemplate,
+      "rtcp_src");
+  recv_rtcp_sink = link_request_pad (rtcp_srcpad, sender, "recv_rtcp_sink");
+
+  gst_pad_set_active (mysrcpad, TRUE);
+  gst_pad_set_active (mysinkpad, TRUE);
+  gst_pad_set_active (net_srcpad, TRUE);
+  gst_pad_set_active (net_sinkpad, TRUE);
+  gst_pad_set_active (rtcp_srcpad, TRUE);
+  gst_pad_set_active (rtcp_sinkpad, TRUE);
+
+  fail_unless (gst_element_set_state (rtxsend, GST_STATE_PLAYING) ==
+      GST_STATE_CHANGE_SUCCESS);
+  fail_unless (gst_element_set_state (sender, GST_STATE_PLAYING) ==
+      GST_STATE_CHANGE_SUCCESS);
+  fail_unless (gst_element_set_state (rtxreceive, GST_STATE_PLAYING) ==
+      GST_STATE_CHANGE_SUCCESS);
+  fail_unless (gst_element_set_state (receiver, GST_STATE_PLAYING) ==
+      GST_STATE_CHANGE_SUCCESS);
+  fail_unless (gst_element_set_state (udpsink, GST_STATE_PLAYING) ==
+      GST_STATE_CHANGE_SUCCESS);
+  fail_unless (gst_element_set_state (udpsrc, GST_STATE_PLAYING) ==
+      GST_STATE_CHANGE_SUCCESS);
+
+  gst_pad_push_event (mysrcpad, gst_event_new_stream_start ("test"));
+  gst_pad_set_caps (mysrcpad, caps);
+  gst_caps_unref (caps);
+  gst_segment_init (&segment, GST_FORMAT_TIME);
+  gst_pad_push_event (mysrcpad, gst_event_new_segment (&segment));
+
+  /* packets 3 and 4 get lost on the way */
+  for (seqnum = 0; seqnum < 10; seqnum++)
+    fail_unless (gst_pad_push (mysrcpad, create_rtp_buffer (seqnum)) ==
+        GST_FLOW_OK);
+  wait_for_buffers (8);
+  fail_unless_equals_int (g_list_length (buffers), 8);
+
+  /* request them like the jitterbuffer does. The deadline is far enough
+   * for both requests to go out in the next regular RTCP packet */
+  for (seqnum = 3; seqnum < 5; seqnum++) {
+    fail_unless (gst_pad_push_event (mysinkpad,
+            gst_event_new_custom (GST_EVENT_CUSTOM_UPSTREAM,
+                gst_structure_new ("GstRTPRetransmissionRequest",
+                    "seqnum", G_TYPE_UINT, (guint) seqnum,
+                    "ssrc", G_TYPE_UINT, (guint) MASTER_SSRC,
+                    "deadline", G_TYPE_UINT, 60000, NULL))));
+  }
+
+  /* the receiver asks for packet 3 and, with bit 0 of the bitmask,
+   * packet 4 */
+  nack = wait_for_nack (&pid, &blp);
+  fail_unless_equals_int (pid, 3);
+  fail_unless_equals_int (blp, 0x0001);
+
+  /* the sender retransmits both and the receiver restores them */
+  fail_unless (gst_pad_push (rtcp_srcpad, nack) == GST_FLOW_OK);
+  wait_for_buffers (10);
+  fail_unless_equals_int (g_list_length (buffers), 10);
+  check_rtp_buffer (g_list_nth_data (buffers, 8), 3);
+  check_rtp_buffer (g_list_nth_data (buffers, 9), 4);
+
+  g_object_get (rtxsend, "num-rtx-packets", &num_rtx_sent, NULL);
+  g_object_get (rtxreceive, "num-rtx-packets", &num_rtx_received, NULL);
+  fail_unless_equals_int (num_rtx_sent, 2);
+  fail_unless_equals_int (num_rtx_received, 2);
+
+  /* cleanup */
+  fail_unless (gst_element_set_state (udpsrc, GST_STATE_NULL) ==
+      GST_STATE_CHANGE_SUCCESS);
+  fail_unless (gst_element_set_state (udpsink, GST_STATE_NULL) ==
+      GST_STATE_CHANGE_SUCCESS);
+  fail_unless (gst_element_set_state (receiver, GST_STATE_NULL) ==
+      GST_STATE_CHANGE_SUCCESS);
+  fail_unless (gst_element_set_state (rtxreceive, GST_STATE_NULL) ==
+      GST_STATE_CHANGE_SUCCESS);
+  fail_unless (gst_element_set_state (sender, GST_STATE_NULL) ==
+      GST_STATE_CHANGE_SUCCESS);
+  fail_unless (gst_element_set_state (rtxsend, GST_STATE_NULL) ==
+      GST_STATE_CHANGE_SUCCESS);
+
+  gst_check_drop_buffers ();
+  g_list_free_full (rtcp_buffers, (GDestroyNotify) gst_buffer_unref);
+  rtcp_buffers = NULL;
+
+  gst_pad_set_active (mysinkpad, FALSE);
+  gst_pad_set_active (net_srcpad, FALSE);
+  gst_pad_set_active (net_sinkpad, FALSE);
+  gst_pad_set_active (rtcp_srcpad, FALSE);
+  gst_pad_set_active (rtcp_sinkpad, FALSE);
+
+  release_request_pad (receiver, send_rtcp_src);
+  release_request_pad (receiver, recv_rtp_sink);
+  release_request_pad (sender, recv_rtcp_sink);
+  release_request_pad (sender, send_rtp_sink);
+  gst_pad_unlink (net_srcpad, udpsink_sink);
+  gst_pad_unlink (udpsrc_src, rtxreceive_sink);
+  gst_object_unref (udpsink_sink);
+  gst_object_unref (udpsrc_src);
+  gst_object_unref (rtxreceive_sink);
+  gst_object_unref (rtxsend_src);
+  gst_object_unref (mysinkpad);
+  gst_object_unref (net_srcpad);
+  gst_object_unref (net_sinkpad);
+  gst_object_unref (rtcp_srcpad);
+  gst_object_unref (rtcp_sinkpad);
+
+  gst_pad_set_active (mysrcpad, FALSE);
+  gst_check_teardown_src_pad (rtxsend);
+  gst_check_teardown_element (rtxsend);
+  gst_check_teardown_element (sender);
+  gst_check_teardown_element (rtxreceive);
+  gst_check_teardown_element (receiver);
+  gst_check_teardown_element (udpsink);
+  gst_check_teardown_element (udpsrc);
+  gst_caps_unref (caps);
+}
+
+GST_END_TEST;
+
+static Suite *
+rtprtx_suite (void)
+{
+  Suite *s = suite_create ("rtprtx");
+  TCase *tc_chain = tcase_create ("general");
+
+  suite_add_tcase (s, tc_chain);
+  tcase_add_test (tc_chain, test_rtx_roundtrip);
+  tcase_add_test (tc_chain, test_rtx_nack_roundtrip);
+
+  return s;
+}
+
+GST_CHECK_MAIN (rtprtx);
@@ -0,0 +1,220 @@
+/* GStreamer
+ *
+ * unit test for rtpvrawpay
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#include <gst/check/gstcheck.h>
+#include <gst/rtp/gstrtpbuffer.h>
+
+#define TEST_SSRC   0x11223344
+/* small enough to split lines over packets */
+#define TEST_MTU    100
+#define TEST_WIDTH  16
+#define TEST_HEIGHT 8
+/* RGBA, 4 bytes per pixel and no padding */
+#define TEST_STRIDE (TEST_WIDTH * 4)
+#define TEST_SIZE   (TEST_STRIDE * TEST_HEIGHT)
+
+static GstPad *mysrcpad, *mysinkpad;
+
+static GstStaticPadTemplate sinktemplate = GST_STATIC_PAD_TEMPLATE ("sink",
+    GST_PAD_SINK,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS ("application/x-rtp")
+    );
+static GstStaticPadTemplate srctemplate = GST_STATIC_PAD_TEMPLATE ("src",
+    GST_PAD_SRC,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS ("video/x-raw")
+    );
+
+static GstElement *
+setup_rtpvrawpay (void)
+{
+  GstElement *pay;
+  GstSegment segment;
+  GstCaps *caps;
+
+  pay = gst_check_setup_element ("rtpvrawpay");
+  g_object_set (pay, "mtu", TEST_MTU, "pt", 96, "ssrc", TEST_SSRC,
+      "seqnum-offset", 0, "timestamp-offset", 0, NULL);
+  mysrcpad = gst_check_setup_src_pad (pay, &srctemplate);
+  mysinkpad = gst_check_setup_sink_pad (pay, &sinktemplate);
+  gst_pad_set_active (mysrcpad, TRUE);
+  gst_pad_set_active (mysinkpad, TRUE);
+
+  fail_unless (gst_element_set_state (pay, GST_STATE_PLAYING) ==
+      GST_STATE_CHANGE_SUCCESS);
+
+  caps = gst_caps_new_simple ("video/x-raw",
+      "format", G_TYPE_STRING, "RGBA",
+      "width", G_TYPE_INT, TEST_WIDTH, "height", G_TYPE_INT, TEST_HEIGHT,
+      "framerate", GST_TYPE_FRACTION, 25, 1, NULL);
+  gst_pad_push_event (mysrcpad, gst_event_new_stream_start ("test"));
+  fail_unless (gst_pad_set_caps (mysrcpad, caps));
+  gst_caps_unref (caps);
+  gst_segment_init (&segment, GST_FORMAT_TIME);
+  gst_pad_push_event (mysrcpad, gst_event_new_segment (&segment));
+
+  return pay;
+}
+
+static void
+cleanup_rtpvrawpay (GstElement * pay)
+{
+  gst_check_drop_buffers ();
+
+  fail_unless (gst_element_set_state (pay, GST_STATE_NULL) ==
+      GST_STATE_CHANGE_SUCCESS);
+  gst_pad_set_active (mysrcpad, FALSE);
+  gst_pad_set_active (mysinkpad, FALSE);
+  gst_check_teardown_src_pad (pay);
+  gst_check_teardown_sink_pad (pay);
+  gst_check_teardown_element (pay);
+}
+
+/* parse the RFC 4175 payload of @buffer and write the line segments it
+ * carries to @frame. Returns the number of segments. */
+static guint
+depayload_packet (GstBuffer * buffer, guint8 * frame)
+{
+  GstRTPBuffer rtp = GST_RTP_BUFFER_INIT;
+  guint8 *payload, *headers, *data;
+  guint payload_len, n_segments = 0;
+  gboolean cont;
+
+  fail_unless (gst_rtp_buffer_map (buffer, GST_MAP_READ, &rtp));
+  payload = gst_rtp_buffer_get_payload (&rtp);
+  payload_len = gst_rtp_buffer_get_payload_len (&rtp);
+
+  /* skip the extended sequence number and find the end of the headers */
+  headers = payload + 2;
+  data = headers;
+  do {
+    fail_unless (data + 6 <= payload + payload_len);
+    cont = (data[4] & 0x80) != 0;
+    data += 6;
+  } while (cont);
+
+  do {
+    guint length, line, offset;
+
+    length = GST_READ_UINT16_BE (headers);
+    fail_if (headers[2] & 0x80, "progressive video has no second field");
+    line = GST_READ_UINT16_BE (headers + 2) & 0x7fff;
+    offset = GST_READ_UINT16_BE (headers + 4) & 0x7fff;
+    cont = (headers[4] & 0x80) != 0;
+    headers += 6;
+
+    fail_unless (line < TEST_HEIGHT);
+    fail_unless_equals_int (length % 4, 0);
+    fail_unless (offset + length / 4 <= TEST_WIDTH);
+    fail_unless (data + length <= payload + payload_len);
+
+    memcpy (frame + line * TEST_STRIDE + offset * 4, data, length);
+    data += length;
+    n_segments++;
+  } while (cont);
+
+  fail_unless (data == payload + payload_len);
+  gst_rtp_buffer_unmap (&rtp);
+
+  return n_segments;
+}
+
+GST_START_TEST (test_vrawpay_lines)
+{
+  GstElement *pay;
+  GstBuffer *buffer, *frame;
+  guint8 *input, *output;
+  guint n_segments, i;
+  GList *node;
+
+  pay = setup_rtpvrawpay ();
+
+  input = g_malloc (TEST_SIZE);
+  for (i = 0; i < TEST_SIZE; i++)
+    input[i] = i * 7;
+
+  frame = gst_buffer_new_and_alloc (TEST_SIZE);
+  gst_buffer_fill (frame, 0, input, TEST_SIZE);
+  if (__i__ == 1) {
+    /* a frame in two memory blocks can't be shared line by line and goes
+     * through the copying path */
+    buffer = gst_buffer_copy_region (frame, GST_BUFFER_COPY_MEMORY, 0,
+        TEST_SIZE / 2 + 10);
+    buffer = gst_buffer_append (buffer, gst_buffer_copy_region (frame,
+            GST_BUFFER_COPY_MEMORY, TEST_SIZE / 2 + 10,
+            TEST_SIZE / 2 - 10));
+    gst_buffer_unref (frame);
+    frame = buffer;
+    fail_unless_equals_int (gst_buffer_n_memory (frame), 2);
+  }
+  GST_BUFFER_PTS (frame) = GST_SECOND;
+  GST_BUFFER_DURATION (frame) = GST_SECOND / 25;
+
+  fail_unless (gst_pad_push (mysrcpad, frame) == GST_FLOW_OK);
+  fail_unless (g_list_length (buffers) > 1);
+
+  /* all packets of the frame have consecutive seqnums and the RTP time of
+   * the frame, only the last one has the marker */
+  output = g_malloc0 (TEST_SIZE);
+  n_segments = 0;
+  for (node = buffers, i = 0; node; node = node->next, i++) {
+    GstRTPBuffer rtp = GST_RTP_BUFFER_INIT;
+
+    buffer = node->data;
+    fail_unless (gst_buffer_get_size (buffer) <= TEST_MTU);
+    fail_unless_equals_uint64 (GST_BUFFER_PTS (buffer), GST_SECOND);
+
+    fail_unless (gst_rtp_buffer_map (buffer, GST_MAP_READ, &rtp));
+    fail_unless_equals_int (gst_rtp_buffer_get_payload_type (&rtp), 96);
+    fail_unless_equals_int (gst_rtp_buffer_get_ssrc (&rtp), TEST_SSRC);
+    fail_unless_equals_int (gst_rtp_buffer_get_seq (&rtp), i);
+    fail_unless_equals_int (gst_rtp_buffer_get_timestamp (&rtp), 90000);
+    fail_unless_equals_int (gst_rtp_buffer_get_marker (&rtp),
+        node->next == NULL);
+    gst_rtp_buffer_unmap (&rtp);
+
+    n_segments += depayload_packet (buffer, output);
+  }
+
+  /* lines were split over packets and the frame comes out unchanged */
+  fail_unless (n_segments > TEST_HEIGHT);
+  fail_unless (memcmp (input, output, TEST_SIZE) == 0);
+
+  g_free (output);
+  g_free (input);
+  cleanup_rtpvrawpay (pay);
+}
+
+GST_END_TEST;
+
+static Suite *
+rtpvrawpay_suite (void)
+{
+  Suite *s = suite_create ("rtpvrawpay");
+  TCase *tc_chain = tcase_create ("general");
+
+  suite_add_tcase (s, tc_chain);
+  tcase_add_loop_test (tc_chain, test_vrawpay_lines, 0, 2);
+
+  return s;
+}
+
+GST_CHECK_MAIN (rtpvrawpay);
@@ -495,6 +495,149 @@ GST_START_TEST (test_passthrough)
 
 GST_END_TEST;
 
+static GstStaticPadTemplate zero_copy_src_template =
+GST_STATIC_PAD_TEMPLATE ("src", GST_PAD_SRC, GST_PAD_ALWAYS,
+    GST_STATIC_CAPS (GST_VIDEO_CAPS_MAKE ("I420")));
+
+static GstStaticPadTemplate zero_copy_sink_template =
+GST_STATIC_PAD_TEMPLATE ("sink", GST_PAD_SINK, GST_PAD_ALWAYS,
+    GST_STATIC_CAPS (GST_VIDEO_CAPS_MAKE ("I420")));
+
+static gboolean sink_video_meta;
+static gboolean sink_crop_meta;
+
+static gboolean
+zero_copy_sink_query (GstPad * pad, GstObject * parent, GstQuery * query)
+{
+  if (GST_QUERY_TYPE (query) == GST_QUERY_ALLOCATION) {
+    if (sink_video_meta)
+      gst_query_add_allocation_meta (query, GST_VIDEO_META_API_TYPE, NULL);
+    if (sink_crop_meta)
+      gst_query_add_allocation_meta (query, GST_VIDEO_CROP_META_API_TYPE,
+          NULL);
+    return TRUE;
+  }
+  return gst_pad_query_default (pad, parent, query);
+}
+
+/* crops 64x48 I420 and checks whether the output shares the input memory
+ * and shows the right pixels */
+static void
+videocrop_test_zero_copy (gint left, gint top, gboolean video_meta,
+    gboolean crop_meta, gboolean expect_zero_copy)
+{
+  GstElement *videocrop;
+  GstPad *srcpad, *sinkpad;
+  GstVideoInfo in_info, out_info;
+  GstVideoFrame in_frame, out_frame;
+  GstBuffer *inbuf, *outbuf;
+  GstCaps *caps;
+  GstSegment segment;
+  gint c, x, y;
+
+  sink_video_meta = video_meta;
+  sink_crop_meta = crop_meta;
+
+  videocrop = gst_check_setup_element ("videocrop");
+  g_object_set (videocrop, "left", left, "right", 6, "top", top, "bottom", 4,
+      NULL);
+  srcpad = gst_check_setup_src_pad (videocrop, &zero_copy_src_template);
+  sinkpad = gst_check_setup_sink_pad (videocrop, &zero_copy_sink_template);
+  gst_pad_set_query_function (sinkpad, zero_copy_sink_query);
+  gst_pad_set_active (srcpad, TRUE);
+  gst_pad_set_active (sinkpad, TRUE);
+  fail_unless (gst_element_set_state (videocrop,
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_SUCCESS);
+
+  gst_video_info_init (&in_info);
+  gst_video_info_set_format (&in_info, GST_VIDEO_FORMAT_I420, 64, 48);
+  gst_video_info_init (&out_info);
+  gst_video_info_set_format (&out_info, GST_VIDEO_FORMAT_I420,
+      64 - left - 6, 48 - top - 4);
+
+  caps = gst_video_info_to_caps (&in_info);
+  fail_unless (gst_pad_push_event (srcpad, gst_event_new_caps (caps)));
+  gst_caps_unref (caps);
+  gst_segment_init (&segment, GST_FORMAT_TIME);
+  fail_unless (gst_pad_push_event (srcpad, gst_event_new_segment (&segment)));
+
+  inbuf = gst_buffer_new_allocate (NULL, in_info.size, NULL);
+  fail_unless (gst_video_frame_map (&in_frame, &in_info, inbuf,
+          GST_MAP_WRITE));
+  for (c = 0; c < 3; c++) {
+    for (y = 0; y < GST_VIDEO_FRAME_COMP_HEIGHT (&in_frame, c); y++) {
+      guint8 *data = GST_VIDEO_FRAME_COMP_DATA (&in_frame, c);
+
+      data += y * GST_VIDEO_FRAME_COMP_STRIDE (&in_frame, c);
+      for (x = 0; x < GST_VIDEO_FRAME_COMP_WIDTH (&in_frame, c); x++)
+        data[x] = x + 3 * y + 50 * c;
+    }
+  }
+  gst_video_frame_unmap (&in_frame);
+
+  fail_unless_equals_int (gst_pad_push (srcpad, gst_buffer_ref (inbuf)),
+      GST_FLOW_OK);
+  fail_unless_equals_int (g_list_length (buffers), 1);
+  outbuf = GST_BUFFER (buffers->data);
+
+  fail_unless_equals_int (gst_buffer_peek_memory (outbuf, 0) ==
+      gst_buffer_peek_memory (inbuf, 0), expect_zero_copy);
+
+  if (crop_meta) {
+    GstVideoCropMeta *meta = gst_buffer_get_video_crop_meta (outbuf);
+
+    fail_unless (meta != NULL);
+    fail_unless_equals_int (meta->x, left);
+    fail_unless_equals_int (meta->y, top);
+    fail_unless_equals_int (meta->width, GST_VIDEO_INFO_WIDTH (&out_info));
+    fail_unless_equals_int (meta->height, GST_VIDEO_INFO_HEIGHT (&out_info));
+  } else {
+    fail_unless (gst_video_frame_map (&in_frame, &in_info, inbuf,
+            GST_MAP_READ));
+    fail_unless (gst_video_frame_map (&out_frame, &out_info, outbuf,
+            GST_MAP_READ));
+    for (c = 0; c < 3; c++) {
+      gint sub = c > 0 ? 1 : 0;
+
+      for (y = 0; y < GST_VIDEO_FRAME_COMP_HEIGHT (&out_frame, c); y++) {
+        guint8 *in_data = GST_VIDEO_FRAME_COMP_DATA (&in_frame, c);
+        guint8 *out_data = GST_VIDEO_FRAME_COMP_DATA (&out_frame, c);
+
+        in_data += (y + (top >> sub)) *
+            GST_VIDEO_FRAME_COMP_STRIDE (&in_frame, c) + (left >> sub);
+        out_data += y * GST_VIDEO_FRAME_COMP_STRIDE (&out_frame, c);
+        for (x = 0; x < GST_VIDEO_FRAME_COMP_WIDTH (&out_frame, c); x++)
+          fail_unless_equals_int (out_data[x], in_data[x]);
+      }
+    }
+    gst_video_frame_unmap (&out_frame);
+    gst_video_frame_unmap (&in_frame);
+  }
+
+  gst_buffer_unref (inbuf);
+  gst_check_drop_buffers ();
+  gst_element_set_state (videocrop, GST_STATE_NULL);
+  gst_pad_set_active (srcpad, FALSE);
+  gst_pad_set_active (sinkpad, FALSE);
+  gst_check_teardown_src_pad (videocrop);
+  gst_check_teardown_sink_pad (videocrop);
+  gst_check_teardown_element (videocrop);
+}
+
+GST_START_TEST (test_zero_copy)
+{
+  /* downstream can't handle strides, copy */
+  videocrop_test_zero_copy (16, 10, FALSE, FALSE, FALSE);
+  /* offsets moved to the first visible pixel */
+  videocrop_test_zero_copy (16, 10, TRUE, FALSE, TRUE);
+  /* odd left can't be expressed with offsets for I420, copy */
+  videocrop_test_zero_copy (15, 10, TRUE, FALSE, FALSE);
+  /* crop meta works for any region */
+  videocrop_test_zero_copy (15, 9, TRUE, TRUE, TRUE);
+}
+
+GST_END_TEST;
+
 static gint
 notgst_value_list_get_nth_int (const GValue * list_val, guint n)
 {
@@ -772,6 +915,7 @@ videocrop_suite (void)
   tcase_add_test (tc_chain, test_crop_to_1x1);
   tcase_add_test (tc_chain, test_caps_transform);
   tcase_add_test (tc_chain, test_passthrough);
+  tcase_add_test (tc_chain, test_zero_copy);
   tcase_add_test (tc_chain, test_unit_sizes);
   tcase_add_loop_test (tc_chain, test_cropping, 0, 25);
 
@@ -0,0 +1,375 @@
+/* GStreamer
+ *
+ * videomixer.c: unit test for the videomixer element
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <string.h>
+
+#include <gst/check/gstcheck.h>
+#include <gst/video/video.h>
+
+static void
+handoff (GstElement * sink, GstBuffer * buffer, GstPad * pad, GList ** frames)
+{
+  *frames = g_list_append (*frames, gst_buffer_ref (buffer));
+}
+
+/* mixes a moving ball at 30 frames/s over two pictures that change less
+ * often, partly outside of the output frame */
+static GList *
+mix_frames (const gchar * format, const gchar * background, guint n_threads,
+    gboolean damage_tracking)
+{
+  GstElement *pipeline, *sink;
+  GstMessage *msg;
+  GstBus *bus;
+  GList *frames = NULL;
+  gchar *desc;
+
+  desc = g_strdup_printf ("videomixer name=mix background=%s n-threads=%u "
+      "damage-tracking=%d sink_1::xpos=-37 sink_1::ypos=-21 "
+      "sink_2::xpos=150 sink_2::ypos=97 sink_2::alpha=0.6 ! "
+      "video/x-raw,format=%s,width=200,height=150 ! "
+      "fakesink name=sink signal-handoffs=true sync=false "
+      "videotestsrc num-buffers=30 pattern=ball ! "
+      "video/x-raw,format=%s,width=48,height=48,framerate=30/1 ! mix.sink_0 "
+      "videotestsrc num-buffers=5 pattern=smpte ! "
+      "video/x-raw,format=%s,width=160,height=120,framerate=5/1 ! mix.sink_1 "
+      "videotestsrc num-buffers=3 pattern=zone-plate ! "
+      "video/x-raw,format=%s,width=64,height=64,framerate=3/1 ! mix.sink_2",
+      background, n_threads, damage_tracking, format, format, format, format);
+  pipeline = gst_parse_launch (desc, NULL);
+  g_free (desc);
+  fail_unless (pipeline != NULL);
+
+  sink = gst_bin_get_by_name (GST_BIN (pipeline), "sink");
+  g_signal_connect (sink, "handoff", G_CALLBACK (handoff), &frames);
+  gst_object_unref (sink);
+
+  fail_unless (gst_element_set_state (pipeline, GST_STATE_PLAYING) !=
+      GST_STATE_CHANGE_FAILURE);
+
+  bus = gst_element_get_bus (pipeline);
+  msg = gst_bus_timed_pop_filtered (bus, GST_CLOCK_TIME_NONE,
+      GST_MESSAGE_EOS | GST_MESSAGE_ERROR);
+  fail_unless_equals_int (GST_MESSAGE_TYPE (msg), GST_MESSAGE_EOS);
+  gst_message_unref (msg);
+  gst_object_unref (bus);
+
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+  gst_object_unref (pipeline);
+
+  fail_unless (frames != NULL);
+
+  return frames;
+}
+
+static void
+compare_frames (GList * expected, GList * frames)
+{
+  for (; expected && frames; expected = expected->next, frames = frames->next) {
+    GstBuffer *a = expected->data, *b = frames->data;
+    GstMapInfo ma, mb;
+
+    fail_unless_equals_uint64 (GST_BUFFER_TIMESTAMP (a),
+        GST_BUFFER_TIMESTAMP (b));
+    gst_buffer_map (a, &ma, GST_MAP_READ);
+    gst_buffer_map (b, &mb, GST_MAP_READ);
+    fail_unless_equals_int (ma.size, mb.size);
+    fail_unless (memcmp (ma.data, mb.data, ma.size) == 0,
+        "frame at %" GST_TIME_FORMAT " differs",
+        GST_TIME_ARGS (GST_BUFFER_TIMESTAMP (a)));
+    gst_buffer_unmap (a, &ma);
+    gst_buffer_unmap (b, &mb);
+  }
+  fail_unless (expected == NULL && frames == NULL);
+}
+
+static const struct
+{
+  const gchar *format;
+  const gchar *background;
+} tiled_cases[] = {
+  {
+  "I420", "checker"}, {
+  "I420", "black"}, {
+  "NV12", "white"}, {
+  "Y41B", "black"}, {
+  "YUY2", "checker"}, {
+  "AYUV", "transparent"}, {
+  "BGRA", "checker"}, {
+  "RGB", "white"}
+};
+
+/* blending the tiles from several threads and only blending the damaged
+ * tiles gives the same frames as blending all tiles in one thread */
+GST_START_TEST (test_tiled_blend)
+{
+  const gchar *format = tiled_cases[__i__].format;
+  const gchar *background = tiled_cases[__i__].background;
+  GList *expected, *frames;
+
+  expected = mix_frames (format, background, 1, FALSE);
+
+  frames = mix_frames (format, background, 4, FALSE);
+  compare_frames (expected, frames);
+  g_list_free_full (frames, (GDestroyNotify) gst_buffer_unref);
+
+  frames = mix_frames (format, background, 1, TRUE);
+  compare_frames (expected, frames);
+  g_list_free_full (frames, (GDestroyNotify) gst_buffer_unref);
+
+  frames = mix_frames (format, background, 3, TRUE);
+  compare_frames (expected, frames);
+  g_list_free_full (frames, (GDestroyNotify) gst_buffer_unref);
+
+  g_list_free_full (expected, (GDestroyNotify) gst_buffer_unref);
+}
+
+GST_END_TEST;
+
+static GList *
+capture_frames (const gchar * desc)
+{
+  GstElement *pipeline, *sink;
+  GstMessage *msg;
+  GList *frames = NULL;
+  gchar *full;
+
+  full = g_strdup_printf ("%s ! fakesink name=sink signal-handoffs=true "
+      "sync=false", desc);
+  pipeline = gst_parse_launch (full, NULL);
+  g_free (full);
+  fail_unless (pipeline != NULL);
+
+  sink = gst_bin_get_by_name (GST_BIN (pipeline), "sink");
+  g_signal_connect (sink, "handoff", G_CALLBACK (handoff), &frames);
+  gst_object_unref (sink);
+
+  fail_unless (gst_element_set_state (pipeline, GST_STATE_PLAYING) !=
+      GST_STATE_CHANGE_FAILURE);
+  msg = gst_bus_timed_pop_filtered (GST_ELEMENT_BUS (pipeline),
+      GST_CLOCK_TIME_NONE, GST_MESSAGE_EOS | GST_MESSAGE_ERROR);
+  fail_unless_equals_int (GST_MESSAGE_TYPE (msg), GST_MESSAGE_EOS);
+  gst_message_unref (msg);
+
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+  gst_object_unref (pipeline);
+
+  return frames;
+}
+
+static const struct
+{
+  const gchar *pattern;
+  gint width, height;
+  gint xpos, ypos;
+  gdouble alpha;
+} golden_inputs[] = {
+  {
+  "ball", 48, 48, 100, 80, 1.0}, {
+  "smpte", 160, 120, -38, -22, 1.0}, {
+  "zone-plate", 64, 64, 150, 96, 0.6}
+};
+
+/* blends @src over @dest the way the I420 blend function does it on the
+ * whole frame, the positions are even so there is no rounding */
+static void
+golden_blend (GstVideoFrame * src, gint xpos, gint ypos, gdouble alpha,
+    GstVideoFrame * dest)
+{
+  gint b_alpha = CLAMP ((gint) (alpha * 256), 0, 256);
+  gint c, x, y;
+
+  for (c = 0; c < 3; c++) {
+    gint sub = (c == 0) ? 0 : 1;
+
+    for (y = 0; y < GST_VIDEO_FRAME_COMP_HEIGHT (src, c); y++) {
+      gint dy = (ypos >> sub) + y;
+      const guint8 *s;
+      guint8 *d;
+
+      if (dy < 0 || dy >= GST_VIDEO_FRAME_COMP_HEIGHT (dest, c))
+        continue;
+
+      s = GST_VIDEO_FRAME_COMP_DATA (src, c);
+      s += y * GST_VIDEO_FRAME_COMP_STRIDE (src, c);
+      d = GST_VIDEO_FRAME_COMP_DATA (dest, c);
+      d += dy * GST_VIDEO_FRAME_COMP_STRIDE (dest, c);
+
+      for (x = 0; x < GST_VIDEO_FRAME_COMP_WIDTH (src, c); x++) {
+        gint dx = (xpos >> sub) + x;
+
+        if (dx < 0 || dx >= GST_VIDEO_FRAME_COMP_WIDTH (dest, c))
+          continue;
+
+        if (alpha == 1.0)
+          d[dx] = s[x];
+        else
+          d[dx] = (d[dx] * 256 + (s[x] - d[dx]) * b_alpha) >> 8;
+      }
+    }
+  }
+}
+
+/* the tiled output, with and without threads and damage tracking, is the
+ * same as blending the inputs over the whole frame one after the other */
+GST_START_TEST (test_tiled_blend_golden)
+{
+  static const struct
+  {
+    guint n_threads;
+    gboolean damage_tracking;
+  } configs[] = { {
+  1, FALSE}, {
+  4, FALSE}, {
+  3, TRUE}};
+  GList *inputs[G_N_ELEMENTS (golden_inputs)];
+  GstVideoInfo out_info;
+  guint i, j, c;
+
+  for (i = 0; i < G_N_ELEMENTS (golden_inputs); i++) {
+    gchar *desc;
+
+    desc = g_strdup_printf ("videotestsrc num-buffers=10 pattern=%s ! "
+        "video/x-raw,format=I420,width=%d,height=%d,framerate=30/1",
+        golden_inputs[i].pattern, golden_inputs[i].width,
+        golden_inputs[i].height);
+    inputs[i] = capture_frames (desc);
+    g_free (desc);
+    fail_unless_equals_int (g_list_length (inputs[i]), 10);
+  }
+
+  gst_video_info_set_format (&out_info, GST_VIDEO_FORMAT_I420, 200, 150);
+
+  for (c = 0; c < G_N_ELEMENTS (configs); c++) {
+    GList *frames, *l;
+    gchar *desc, *tmp;
+
+    desc = g_strdup_printf ("videomixer name=mix background=black "
+        "n-threads=%u damage-tracking=%d",
+        configs[c].n_threads, configs[c].damage_tracking);
+    for (i = 0; i < G_N_ELEMENTS (golden_inputs); i++) {
+      gchar alpha[G_ASCII_DTOSTR_BUF_SIZE];
+
+      g_ascii_dtostr (alpha, sizeof (alpha), golden_inputs[i].alpha);
+      tmp = desc;
+      desc = g_strdup_printf ("%s sink_%u::xpos=%d sink_%u::ypos=%d "
+          "sink_%u::alpha=%s sink_%u::zorder=%u", tmp, i,
+          golden_inputs[i].xpos, i, golden_inputs[i].ypos, i, alpha, i, i);
+      g_free (tmp);
+    }
+    for (i = 0; i < G_N_ELEMENTS (golden_inputs); i++) {
+      tmp = desc;
+      desc = g_strdup_printf ("%s videotestsrc num-buffers=10 pattern=%s ! "
+          "video/x-raw,format=I420,width=%d,height=%d,framerate=30/1 ! "
+          "mix.sink_%u", tmp, golden_inputs[i].pattern,
+          golden_inputs[i].width, golden_inputs[i].height, i);
+      g_free (tmp);
+    }
+    /* capture_frames() links the last branch to the sink, put the mixer
+     * output there */
+    tmp = desc;
+    desc = g_strdup_printf ("%s mix. ! "
+        "video/x-raw,format=I420,width=200,height=150", tmp);
+    g_free (tmp);
+    frames = capture_frames (desc);
+    g_free (desc);
+    fail_unless_equals_int (g_list_length (frames), 10);
+
+    for (l = frames, j = 0; l; l = l->next, j++) {
+      GstBuffer *expected;
+      GstVideoFrame golden, out;
+      gint y;
+
+      /* black background */
+      expected = gst_buffer_new_and_alloc (GST_VIDEO_INFO_SIZE (&out_info));
+      fail_unless (gst_video_frame_map (&golden, &out_info, expected,
+              GST_MAP_WRITE));
+      for (i = 0; i < 3; i++) {
+        for (y = 0; y < GST_VIDEO_FRAME_COMP_HEIGHT (&golden, i); y++)
+          memset (GST_VIDEO_FRAME_COMP_DATA (&golden, i) +
+              y * GST_VIDEO_FRAME_COMP_STRIDE (&golden, i), (i == 0) ? 16 : 128,
+              GST_VIDEO_FRAME_COMP_WIDTH (&golden, i));
+      }
+
+      for (i = 0; i < G_N_ELEMENTS (golden_inputs); i++) {
+        GstVideoInfo in_info;
+        GstVideoFrame in;
+
+        gst_video_info_set_format (&in_info, GST_VIDEO_FORMAT_I420,
+            golden_inputs[i].width, golden_inputs[i].height);
+        fail_unless (gst_video_frame_map (&in, &in_info,
+                g_list_nth_data (inputs[i], j), GST_MAP_READ));
+        golden_blend (&in, golden_inputs[i].xpos, golden_inputs[i].ypos,
+            golden_inputs[i].alpha, &golden);
+        gst_video_frame_unmap (&in);
+      }
+
+      fail_unless (gst_video_frame_map (&out, &out_info, l->data,
+              GST_MAP_READ));
+      for (i = 0; i < 3; i++) {
+        for (y = 0; y < GST_VIDEO_FRAME_COMP_HEIGHT (&out, i); y++) {
+          const guint8 *o, *g;
+          gint x;
+
+          o = GST_VIDEO_FRAME_COMP_DATA (&out, i);
+          o += y * GST_VIDEO_FRAME_COMP_STRIDE (&out, i);
+          g = GST_VIDEO_FRAME_COMP_DATA (&golden, i);
+          g += y * GST_VIDEO_FRAME_COMP_STRIDE (&golden, i);
+          for (x = 0; x < GST_VIDEO_FRAME_COMP_WIDTH (&out, i); x++) {
+            fail_unless (o[x] == g[x],
+                "frame %u, %u threads, damage tracking %d: component %u "
+                "at %d,%d is %u instead of %u", j, configs[c].n_threads,
+                configs[c].damage_tracking, i, x, y, o[x], g[x]);
+          }
+        }
+      }
+      gst_video_frame_unmap (&out);
+      gst_video_frame_unmap (&golden);
+      gst_buffer_unref (expected);
+    }
+
+    g_list_free_full (frames, (GDestroyNotify) gst_buffer_unref);
+  }
+
+  for (i = 0; i < G_N_ELEMENTS (golden_inputs); i++)
+    g_list_free_full (inputs[i], (GDestroyNotify) gst_buffer_unref);
+}
+
+GST_END_TEST;
+
+static Suite *
+videomixer_suite (void)
+{
+  Suite *s = suite_create ("videomixer");
+  TCase *tc_chain = tcase_create ("general");
+
+  suite_add_tcase (s, tc_chain);
+  tcase_add_loop_test (tc_chain, test_tiled_blend, 0,
+      G_N_ELEMENTS (tiled_cases));
+  tcase_add_test (tc_chain, test_tiled_blend_golden);
+
+  return s;
+}
+
+GST_CHECK_MAIN (videomixer);
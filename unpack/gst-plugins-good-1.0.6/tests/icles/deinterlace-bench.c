@@ -0,0 +1,189 @@
+/* GStreamer
+ *
+ * deinterlace-bench.c: measure the deinterlace methods on 1080i video with
+ * one and several threads
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/* Pushes 1920x1080 interlaced frames at 30000/1001 frames/s into deinterlace
+ * and reports output frames/s for every method, with one thread and with
+ * one thread per CPU. Every input frame gives two output frames, so 59.94
+ * output frames/s are needed for real time. greedyh only ever uses one
+ * thread.
+ *
+ * Usage: deinterlace-bench [num-frames]
+ */
+
+#include <stdlib.h>
+#include <gst/gst.h>
+#include <gst/video/video.h>
+
+static guint num_frames = 100;
+
+static const gchar *formats[] = { "I420", "YUY2" };
+
+static const gchar *methods[] = { "linear", "greedyh", "yadif" };
+
+static const guint threads[] = { 1, 0 };
+
+static guint received;
+
+static GstFlowReturn
+chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
+{
+  received++;
+  gst_buffer_unref (buffer);
+  return GST_FLOW_OK;
+}
+
+/* a pattern that moves between the frames, with fine horizontal detail */
+static GstBuffer *
+make_frame (GstVideoInfo * info, guint n)
+{
+  GstVideoFrame frame;
+  GstBuffer *buffer;
+  gint x, y, c;
+
+  buffer = gst_buffer_new_allocate (NULL, info->size, NULL);
+  gst_video_frame_map (&frame, info, buffer, GST_MAP_WRITE);
+  for (c = 0; c < GST_VIDEO_FRAME_N_COMPONENTS (&frame); c++) {
+    gint w = GST_VIDEO_FRAME_COMP_WIDTH (&frame, c);
+    gint h = GST_VIDEO_FRAME_COMP_HEIGHT (&frame, c);
+    gint pstride = GST_VIDEO_FRAME_COMP_PSTRIDE (&frame, c);
+
+    for (y = 0; y < h; y++) {
+      guint8 *data = GST_VIDEO_FRAME_COMP_DATA (&frame, c);
+
+      data += y * GST_VIDEO_FRAME_COMP_STRIDE (&frame, c);
+      for (x = 0; x < w; x++)
+        data[x * pstride] = c == 0 ? ((x + 8 * n) ^ (y + 3 * n)) & 0xff :
+            128 + ((x + y) & 31);
+    }
+  }
+  gst_video_frame_unmap (&frame);
+
+  return buffer;
+}
+
+static void
+push_frame (GstPad * srcpad, GstBuffer * frame, guint n)
+{
+  GstBuffer *buffer = gst_buffer_copy (frame);
+
+  GST_BUFFER_TIMESTAMP (buffer) = gst_util_uint64_scale (n, 1001 * GST_SECOND,
+      30000);
+  GST_BUFFER_DURATION (buffer) = gst_util_uint64_scale (1, 1001 * GST_SECOND,
+      30000);
+  gst_pad_push (srcpad, buffer);
+}
+
+static gdouble
+run_bench (const gchar * format, const gchar * method, guint n_threads)
+{
+  GstElement *deinterlace;
+  GstPad *srcpad, *sinkpad, *pad;
+  GstVideoInfo info;
+  GstCaps *caps;
+  GstBuffer *frames[2];
+  GstSegment segment;
+  GstClockTime start, elapsed;
+  guint i;
+
+  deinterlace = gst_element_factory_make ("deinterlace", NULL);
+  if (deinterlace == NULL)
+    g_error ("no deinterlace element");
+  gst_util_set_object_arg (G_OBJECT (deinterlace), "method", method);
+  g_object_set (deinterlace, "n-threads", n_threads, NULL);
+  gst_object_ref_sink (deinterlace);
+
+  srcpad = gst_pad_new ("src", GST_PAD_SRC);
+  sinkpad = gst_pad_new ("sink", GST_PAD_SINK);
+  gst_pad_set_chain_function (sinkpad, chain);
+
+  pad = gst_element_get_static_pad (deinterlace, "sink");
+  gst_pad_link (srcpad, pad);
+  gst_object_unref (pad);
+  pad = gst_element_get_static_pad (deinterlace, "src");
+  gst_pad_link (pad, sinkpad);
+  gst_object_unref (pad);
+
+  gst_pad_set_active (srcpad, TRUE);
+  gst_pad_set_active (sinkpad, TRUE);
+  gst_element_set_state (deinterlace, GST_STATE_PLAYING);
+
+  gst_video_info_init (&info);
+  gst_video_info_set_format (&info, gst_video_format_from_string (format),
+      1920, 1080);
+  info.interlace_mode = GST_VIDEO_INTERLACE_MODE_INTERLEAVED;
+  info.fps_n = 30000;
+  info.fps_d = 1001;
+  caps = gst_video_info_to_caps (&info);
+  gst_pad_push_event (srcpad, gst_event_new_stream_start ("deinterlace-bench"));
+  gst_pad_push_event (srcpad, gst_event_new_caps (caps));
+  gst_caps_unref (caps);
+  gst_segment_init (&segment, GST_FORMAT_TIME);
+  gst_pad_push_event (srcpad, gst_event_new_segment (&segment));
+
+  frames[0] = make_frame (&info, 0);
+  frames[1] = make_frame (&info, 1);
+
+  /* fill the field history and start the threads outside of the
+   * measurement */
+  for (i = 0; i < 4; i++)
+    push_frame (srcpad, frames[i & 1], i);
+
+  received = 0;
+  start = gst_util_get_timestamp ();
+  for (i = 4; i < num_frames + 4; i++)
+    push_frame (srcpad, frames[i & 1], i);
+  elapsed = gst_util_get_timestamp () - start;
+
+  gst_buffer_unref (frames[0]);
+  gst_buffer_unref (frames[1]);
+  gst_element_set_state (deinterlace, GST_STATE_NULL);
+  gst_object_unref (deinterlace);
+  gst_object_unref (srcpad);
+  gst_object_unref (sinkpad);
+
+  return received * (gdouble) GST_SECOND / MAX (elapsed, 1);
+}
+
+int
+main (int argc, char *argv[])
+{
+  guint i, j, k;
+
+  gst_init (&argc, &argv);
+
+  if (argc > 1)
+    num_frames = atoi (argv[1]);
+
+  g_print ("%u frames of 1920x1080 interlaced, output frames/s\n",
+      num_frames);
+  g_print ("%-8s %-8s %12s %12s\n", "", "", "1 thread", "all CPUs");
+
+  for (i = 0; i < G_N_ELEMENTS (formats); i++) {
+    for (j = 0; j < G_N_ELEMENTS (methods); j++) {
+      g_print ("%-8s %-8s", formats[i], methods[j]);
+      for (k = 0; k < G_N_ELEMENTS (threads); k++)
+        g_print (" %12.1f", run_bench (formats[i], methods[j], threads[k]));
+      g_print ("\n");
+    }
+  }
+
+  return 0;
+}
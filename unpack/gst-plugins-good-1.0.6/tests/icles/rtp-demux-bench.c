@@ -0,0 +1,198 @@
+/* GStreamer
+ *
+ * rtp-demux-bench.c: measure the packet rate of rtpssrcdemux and rtpbin with
+ * many SSRCs
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/* Pushes buffer lists of RTP packets from many SSRCs, interleaved, into a
+ * bare rtpssrcdemux and into the receive side of rtpbin, and reports the
+ * packets per second arriving on the src pads.
+ *
+ * Usage: rtp-demux-bench [num-ssrcs] [num-lists] [list-length]
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <gst/gst.h>
+#include <gst/rtp/gstrtpbuffer.h>
+
+static guint num_ssrcs = 200;
+static guint num_lists = 5000;
+static guint list_length = 64;
+
+static gint received;
+static GList *sinkpads;
+static GMutex lock;
+
+static GstStaticPadTemplate srctemplate = GST_STATIC_PAD_TEMPLATE ("src",
+    GST_PAD_SRC, GST_PAD_ALWAYS, GST_STATIC_CAPS ("application/x-rtp"));
+
+static GstStaticPadTemplate sinktemplate = GST_STATIC_PAD_TEMPLATE ("sink",
+    GST_PAD_SINK, GST_PAD_ALWAYS, GST_STATIC_CAPS ("application/x-rtp"));
+
+static GstFlowReturn
+sink_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
+{
+  g_atomic_int_inc (&received);
+  gst_buffer_unref (buffer);
+  return GST_FLOW_OK;
+}
+
+static GstFlowReturn
+sink_chain_list (GstPad * pad, GstObject * parent, GstBufferList * list)
+{
+  g_atomic_int_add (&received, gst_buffer_list_length (list));
+  gst_buffer_list_unref (list);
+  return GST_FLOW_OK;
+}
+
+static void
+pad_added (GstElement * element, GstPad * pad, const gchar * prefix)
+{
+  GstPad *sinkpad;
+
+  if (!g_str_has_prefix (GST_PAD_NAME (pad), prefix))
+    return;
+
+  sinkpad = gst_pad_new_from_static_template (&sinktemplate, "sink");
+  gst_pad_set_chain_function (sinkpad, sink_chain);
+  gst_pad_set_chain_list_function (sinkpad, sink_chain_list);
+  gst_pad_set_active (sinkpad, TRUE);
+  gst_pad_link (pad, sinkpad);
+
+  g_mutex_lock (&lock);
+  sinkpads = g_list_prepend (sinkpads, sinkpad);
+  g_mutex_unlock (&lock);
+}
+
+/* all lists are prepared before, only the pushing is measured */
+static GstBufferList **
+create_lists (void)
+{
+  GstBufferList **lists;
+  guint i, j, n = 0;
+
+  lists = g_new (GstBufferList *, num_lists);
+  for (i = 0; i < num_lists; i++) {
+    lists[i] = gst_buffer_list_new ();
+    for (j = 0; j < list_length; j++, n++) {
+      GstRTPBuffer rtp = { NULL };
+      GstBuffer *buf;
+
+      buf = gst_rtp_buffer_new_allocate (160, 0, 0);
+      gst_rtp_buffer_map (buf, GST_MAP_WRITE, &rtp);
+      gst_rtp_buffer_set_payload_type (&rtp, 96);
+      gst_rtp_buffer_set_ssrc (&rtp, 0x1000 + n % num_ssrcs);
+      gst_rtp_buffer_set_seq (&rtp, (n / num_ssrcs) & 0xffff);
+      gst_rtp_buffer_set_timestamp (&rtp, (n / num_ssrcs) * 160);
+      gst_rtp_buffer_unmap (&rtp);
+
+      gst_buffer_list_add (lists[i], buf);
+    }
+  }
+
+  return lists;
+}
+
+static void
+run_bench (const gchar * name, GstElement * element, const gchar * sinkname,
+    const gchar * prefix)
+{
+  GstBufferList **lists;
+  GstPad *srcpad, *sinkpad;
+  GstClockTime start, elapsed;
+  GstSegment segment;
+  GstCaps *caps;
+  guint i, total;
+
+  gst_object_ref_sink (element);
+  received = 0;
+  lists = create_lists ();
+  total = num_lists * list_length;
+
+  g_signal_connect (element, "pad-added", G_CALLBACK (pad_added),
+      (gpointer) prefix);
+
+  srcpad = gst_pad_new_from_static_template (&srctemplate, "src");
+  sinkpad = gst_element_get_request_pad (element, sinkname);
+  if (sinkpad == NULL)
+    sinkpad = gst_element_get_static_pad (element, sinkname);
+  gst_pad_link (srcpad, sinkpad);
+  gst_pad_set_active (srcpad, TRUE);
+
+  gst_element_set_state (element, GST_STATE_PLAYING);
+
+  caps = gst_caps_new_simple ("application/x-rtp", "media", G_TYPE_STRING,
+      "audio", "clock-rate", G_TYPE_INT, 8000, "encoding-name", G_TYPE_STRING,
+      "PCMU", "payload", G_TYPE_INT, 96, NULL);
+  gst_pad_push_event (srcpad, gst_event_new_stream_start ("rtp-demux-bench"));
+  gst_pad_push_event (srcpad, gst_event_new_caps (caps));
+  gst_caps_unref (caps);
+  gst_segment_init (&segment, GST_FORMAT_TIME);
+  gst_pad_push_event (srcpad, gst_event_new_segment (&segment));
+
+  start = gst_util_get_timestamp ();
+  for (i = 0; i < num_lists; i++)
+    gst_pad_push_list (srcpad, lists[i]);
+
+  /* rtpbin outputs from the jitterbuffer threads */
+  while (g_atomic_int_get (&received) < total &&
+      gst_util_get_timestamp () - start < 30 * GST_SECOND)
+    g_usleep (1000);
+  elapsed = gst_util_get_timestamp () - start;
+
+  g_print ("%s: %d of %u packets from %u SSRCs in %.3f s: %.0f packets/s\n",
+      name, g_atomic_int_get (&received), total, num_ssrcs,
+      (gdouble) elapsed / GST_SECOND,
+      g_atomic_int_get (&received) * (gdouble) GST_SECOND / MAX (elapsed, 1));
+
+  gst_element_set_state (element, GST_STATE_NULL);
+  gst_pad_unlink (srcpad, sinkpad);
+  gst_object_unref (sinkpad);
+  gst_object_unref (srcpad);
+  gst_object_unref (element);
+
+  g_list_free_full (sinkpads, gst_object_unref);
+  sinkpads = NULL;
+  g_free (lists);
+}
+
+int
+main (int argc, char *argv[])
+{
+  GstElement *rtpbin;
+
+  gst_init (&argc, &argv);
+
+  if (argc > 1)
+    num_ssrcs = atoi (argv[1]);
+  if (argc > 2)
+    num_lists = atoi (argv[2]);
+  if (argc > 3)
+    list_length = atoi (argv[3]);
+
+  run_bench ("rtpssrcdemux", gst_element_factory_make ("rtpssrcdemux", NULL),
+      "sink", "src_");
+
+  rtpbin = gst_element_factory_make ("rtpbin", NULL);
+  g_object_set (rtpbin, "latency", 0, "ignore-pt", TRUE, "do-lost", FALSE,
+      NULL);
+  run_bench ("rtpbin", rtpbin, "recv_rtp_sink_0", "recv_rtp_src_");
+
+  return 0;
+}
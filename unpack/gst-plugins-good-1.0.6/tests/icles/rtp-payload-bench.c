@@ -0,0 +1,225 @@
+/* GStreamer
+ *
+ * rtp-payload-bench.c: measure the packet rate of RTP payloaders
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/* Pushes synthetic MPEG-TS, H264 and raw video frames into rtpmp2tpay,
+ * rtph264pay and rtpvrawpay and reports the packets per second and how many
+ * of the payload bytes were in memory allocated by the payloader.
+ *
+ * Usage: rtp-payload-bench [num-frames]
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <gst/gst.h>
+
+typedef struct
+{
+  guint64 packets;
+  guint64 bytes;
+  guint64 copied_bytes;
+} Stats;
+
+static Stats stats;
+
+static GstStaticPadTemplate sinktemplate = GST_STATIC_PAD_TEMPLATE ("sink",
+    GST_PAD_SINK, GST_PAD_ALWAYS, GST_STATIC_CAPS ("application/x-rtp"));
+
+static void
+count_packet (GstBuffer * buffer)
+{
+  guint i, n;
+
+  /* the first memory is the RTP header, count all payload memory that is not
+   * shared with the input frames */
+  n = gst_buffer_n_memory (buffer);
+  for (i = 0; i < n; i++) {
+    GstMemory *mem = gst_buffer_peek_memory (buffer, i);
+
+    if (mem->parent == NULL)
+      stats.copied_bytes += mem->size - (i == 0 ? 12 : 0);
+  }
+  stats.packets++;
+  stats.bytes += gst_buffer_get_size (buffer);
+}
+
+static gboolean
+count_list_packet (GstBuffer ** buffer, guint idx, gpointer user_data)
+{
+  count_packet (*buffer);
+  return TRUE;
+}
+
+static GstFlowReturn
+sink_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
+{
+  count_packet (buffer);
+  gst_buffer_unref (buffer);
+  return GST_FLOW_OK;
+}
+
+static GstFlowReturn
+sink_chain_list (GstPad * pad, GstObject * parent, GstBufferList * list)
+{
+  gst_buffer_list_foreach (list, count_list_packet, NULL);
+  gst_buffer_list_unref (list);
+  return GST_FLOW_OK;
+}
+
+static GstBuffer *
+make_mp2t_frame (void)
+{
+  GstBuffer *buffer;
+  GstMapInfo map;
+  guint i;
+
+  /* 7 TS packets, a common size for TS over UDP */
+  buffer = gst_buffer_new_allocate (NULL, 7 * 188, NULL);
+  gst_buffer_map (buffer, &map, GST_MAP_WRITE);
+  memset (map.data, 0xff, map.size);
+  for (i = 0; i < 7; i++)
+    map.data[i * 188] = 0x47;
+  gst_buffer_unmap (buffer, &map);
+
+  return buffer;
+}
+
+static GstBuffer *
+make_h264_frame (void)
+{
+  static const guint8 start[] = { 0, 0, 0, 1, 0x65 };
+  GstBuffer *buffer;
+  GstMapInfo map;
+
+  /* one 64KB IDR slice, like a frame of a 15 Mbit/s stream */
+  buffer = gst_buffer_new_allocate (NULL, 64 * 1024, NULL);
+  gst_buffer_map (buffer, &map, GST_MAP_WRITE);
+  memset (map.data, 0x55, map.size);
+  memcpy (map.data, start, sizeof (start));
+  gst_buffer_unmap (buffer, &map);
+
+  return buffer;
+}
+
+static GstBuffer *
+make_vraw_frame (void)
+{
+  GstBuffer *buffer;
+  GstMapInfo map;
+
+  /* 720p UYVY */
+  buffer = gst_buffer_new_allocate (NULL, 1280 * 720 * 2, NULL);
+  gst_buffer_map (buffer, &map, GST_MAP_WRITE);
+  memset (map.data, 0x80, map.size);
+  gst_buffer_unmap (buffer, &map);
+
+  return buffer;
+}
+
+static void
+run_bench (const gchar * name, const gchar * caps_str,
+    GstBuffer * (*make_frame) (void), guint num_frames)
+{
+  GstElement *pay;
+  GstPad *srcpad, *sinkpad, *paysink, *paysrc;
+  GstSegment segment;
+  GstCaps *caps;
+  GstBuffer *frame;
+  GTimer *timer;
+  gdouble elapsed;
+  guint i;
+
+  memset (&stats, 0, sizeof (stats));
+
+  pay = gst_element_factory_make (name, NULL);
+  if (pay == NULL) {
+    g_print ("%-12s not available\n", name);
+    return;
+  }
+
+  srcpad = gst_pad_new ("src", GST_PAD_SRC);
+  sinkpad = gst_pad_new_from_static_template (&sinktemplate, "sink");
+  gst_pad_set_chain_function (sinkpad, sink_chain);
+  gst_pad_set_chain_list_function (sinkpad, sink_chain_list);
+
+  paysink = gst_element_get_static_pad (pay, "sink");
+  paysrc = gst_element_get_static_pad (pay, "src");
+  gst_pad_link (srcpad, paysink);
+  gst_pad_link (paysrc, sinkpad);
+  gst_object_unref (paysink);
+  gst_object_unref (paysrc);
+
+  gst_pad_set_active (srcpad, TRUE);
+  gst_pad_set_active (sinkpad, TRUE);
+  gst_element_set_state (pay, GST_STATE_PLAYING);
+
+  gst_pad_push_event (srcpad, gst_event_new_stream_start (name));
+  caps = gst_caps_from_string (caps_str);
+  gst_pad_push_event (srcpad, gst_event_new_caps (caps));
+  gst_caps_unref (caps);
+  gst_segment_init (&segment, GST_FORMAT_TIME);
+  gst_pad_push_event (srcpad, gst_event_new_segment (&segment));
+
+  frame = make_frame ();
+
+  timer = g_timer_new ();
+  for (i = 0; i < num_frames; i++) {
+    GstBuffer *buf = gst_buffer_copy (frame);
+
+    GST_BUFFER_PTS (buf) = i * GST_SECOND / 30;
+    GST_BUFFER_DURATION (buf) = GST_SECOND / 30;
+    if (gst_pad_push (srcpad, buf) != GST_FLOW_OK)
+      break;
+  }
+  elapsed = g_timer_elapsed (timer, NULL);
+
+  g_print ("%-12s %8" G_GUINT64_FORMAT " packets: %10.0f packets/s, "
+      "%.1f%% of the bytes copied\n", name, stats.packets,
+      stats.packets / elapsed,
+      stats.bytes ? 100.0 * stats.copied_bytes / stats.bytes : 0.0);
+
+  g_timer_destroy (timer);
+  gst_buffer_unref (frame);
+  gst_element_set_state (pay, GST_STATE_NULL);
+  gst_object_unref (pay);
+  gst_object_unref (srcpad);
+  gst_object_unref (sinkpad);
+}
+
+int
+main (int argc, char *argv[])
+{
+  guint num_frames = 2000;
+
+  gst_init (&argc, &argv);
+
+  if (argc > 1)
+    num_frames = atoi (argv[1]);
+
+  run_bench ("rtpmp2tpay", "video/mpegts,packetsize=188,systemstream=true",
+      make_mp2t_frame, num_frames * 100);
+  run_bench ("rtph264pay",
+      "video/x-h264,stream-format=byte-stream,alignment=au",
+      make_h264_frame, num_frames);
+  run_bench ("rtpvrawpay",
+      "video/x-raw,format=UYVY,width=1280,height=720,framerate=30/1",
+      make_vraw_frame, num_frames / 10);
+
+  return 0;
+}
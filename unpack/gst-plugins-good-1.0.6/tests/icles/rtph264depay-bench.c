@@ -0,0 +1,121 @@
+/* GStreamer
+ *
+ * rtph264depay-bench.c: measure the copies made by rtph264depay
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/* Feeds the H264 RTP packets of a pcap capture through rtph264depay and
+ * reports, per output frame, how many bytes are in memory that was allocated
+ * by the depayloader (start codes, lengths and copied payload) versus memory
+ * that still refers to the received RTP packets.
+ *
+ * Usage: rtph264depay-bench capture.pcap [dst-port] [byte-stream|avc]
+ */
+
+#include <stdlib.h>
+#include <gst/gst.h>
+
+typedef struct
+{
+  guint64 frames;
+  guint64 bytes;
+  guint64 copied_bytes;
+  guint64 memories;
+} Stats;
+
+static void
+handoff (GstElement * sink, GstBuffer * buffer, GstPad * pad, Stats * stats)
+{
+  guint i, n;
+
+  n = gst_buffer_n_memory (buffer);
+  for (i = 0; i < n; i++) {
+    GstMemory *mem = gst_buffer_peek_memory (buffer, i);
+
+    /* memory shared from the RTP packets has the packet memory as parent */
+    if (mem->parent == NULL)
+      stats->copied_bytes += mem->size;
+  }
+  stats->frames++;
+  stats->memories += n;
+  stats->bytes += gst_buffer_get_size (buffer);
+}
+
+int
+main (int argc, char *argv[])
+{
+  GstElement *pipeline, *sink;
+  GstMessage *msg;
+  GTimer *timer;
+  gdouble elapsed;
+  gchar *desc;
+  Stats stats = { 0, };
+  gint port = 5000;
+  const gchar *format = "byte-stream";
+
+  gst_init (&argc, &argv);
+
+  if (argc < 2) {
+    g_print ("usage: %s capture.pcap [dst-port] [byte-stream|avc]\n",
+        argv[0]);
+    return 1;
+  }
+  if (argc > 2)
+    port = atoi (argv[2]);
+  if (argc > 3)
+    format = argv[3];
+
+  desc = g_strdup_printf ("filesrc location=\"%s\" ! pcapparse dst-port=%d "
+      "caps=\"application/x-rtp,media=video,clock-rate=90000,"
+      "encoding-name=H264\" ! rtph264depay ! "
+      "video/x-h264,stream-format=%s ! fakesink name=sink "
+      "signal-handoffs=true sync=false", argv[1], port, format);
+  pipeline = gst_parse_launch (desc, NULL);
+  g_free (desc);
+  if (pipeline == NULL) {
+    g_print ("could not create the pipeline\n");
+    return 1;
+  }
+
+  sink = gst_bin_get_by_name (GST_BIN (pipeline), "sink");
+  g_signal_connect (sink, "handoff", G_CALLBACK (handoff), &stats);
+  gst_object_unref (sink);
+
+  timer = g_timer_new ();
+  gst_element_set_state (pipeline, GST_STATE_PLAYING);
+  msg = gst_bus_timed_pop_filtered (GST_ELEMENT_BUS (pipeline),
+      GST_CLOCK_TIME_NONE, GST_MESSAGE_EOS | GST_MESSAGE_ERROR);
+  elapsed = g_timer_elapsed (timer, NULL);
+  gst_message_unref (msg);
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+
+  if (stats.frames > 0) {
+    g_print ("%" G_GUINT64_FORMAT " frames, %.1f bytes/frame, "
+        "%.1f bytes copied/frame, %.1f memories/frame, %.1f us/frame\n",
+        stats.frames, (gdouble) stats.bytes / stats.frames,
+        (gdouble) stats.copied_bytes / stats.frames,
+        (gdouble) stats.memories / stats.frames,
+        elapsed * 1e6 / stats.frames);
+  } else {
+    g_print ("no frames were depayloaded\n");
+  }
+
+  g_timer_destroy (timer);
+  gst_object_unref (pipeline);
+
+  return 0;
+}
@@ -0,0 +1,153 @@
+/* GStreamer
+ *
+ * rtpjitterbuffer-bench.c: measure the insert/pop cost of RTPJitterBuffer
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/* Feeds synthetic RTP streams through an RTPJitterBuffer that holds a
+ * configurable amount of packets, like a jitterbuffer with a large latency
+ * on a high bitrate stream, and reports the average time per packet.
+ *
+ * Usage: rtpjitterbuffer-bench [queued-packets] [num-packets]
+ */
+
+#include <stdlib.h>
+#include <gst/gst.h>
+#include <gst/rtp/gstrtpbuffer.h>
+
+#include "rtpjitterbuffer.h"
+
+#define CLOCK_RATE 90000
+
+typedef enum
+{
+  STREAM_IN_ORDER,
+  STREAM_REORDERED,
+  STREAM_LOSSY,
+  STREAM_REORDERED_LOSSY
+} StreamType;
+
+static const gchar *stream_names[] = {
+  "in order", "reordered", "5% loss", "reordered + 5% loss"
+};
+
+/* create the packets in arrival order */
+static GPtrArray *
+create_stream (StreamType type, guint num_packets)
+{
+  GPtrArray *packets;
+  GRand *rand;
+  guint i;
+
+  packets = g_ptr_array_sized_new (num_packets);
+  rand = g_rand_new_with_seed (42);
+
+  for (i = 0; i < num_packets; i++) {
+    GstRTPBuffer rtp = GST_RTP_BUFFER_INIT;
+    GstBuffer *buf;
+
+    if ((type == STREAM_LOSSY || type == STREAM_REORDERED_LOSSY) &&
+        g_rand_int_range (rand, 0, 100) < 5)
+      continue;
+
+    buf = gst_rtp_buffer_new_allocate (0, 0, 0);
+    gst_rtp_buffer_map (buf, GST_MAP_WRITE, &rtp);
+    gst_rtp_buffer_set_seq (&rtp, i & 0xffff);
+    /* 4 packets per frame at 30 fps */
+    gst_rtp_buffer_set_timestamp (&rtp, (i / 4) * (CLOCK_RATE / 30));
+    gst_rtp_buffer_unmap (&rtp);
+
+    g_ptr_array_add (packets, buf);
+  }
+
+  if (type == STREAM_REORDERED || type == STREAM_REORDERED_LOSSY) {
+    /* move packets up to 16 places back */
+    for (i = 0; i + 16 < packets->len; i++) {
+      if (g_rand_int_range (rand, 0, 10) == 0) {
+        guint j = i + g_rand_int_range (rand, 1, 16);
+        gpointer tmp = packets->pdata[i];
+
+        packets->pdata[i] = packets->pdata[j];
+        packets->pdata[j] = tmp;
+      }
+    }
+  }
+  g_rand_free (rand);
+
+  return packets;
+}
+
+static void
+run_bench (StreamType type, guint queued, guint num_packets)
+{
+  RTPJitterBuffer *jbuf;
+  GPtrArray *packets;
+  GstBuffer *buf;
+  GTimer *timer;
+  gdouble elapsed;
+  gboolean tail;
+  gint percent;
+  guint i, dups = 0;
+
+  packets = create_stream (type, num_packets);
+  jbuf = rtp_jitter_buffer_new ();
+  rtp_jitter_buffer_set_mode (jbuf, RTP_JITTER_BUFFER_MODE_NONE);
+
+  timer = g_timer_new ();
+  for (i = 0; i < packets->len; i++) {
+    buf = packets->pdata[i];
+
+    if (!rtp_jitter_buffer_insert (jbuf, buf, i * GST_MSECOND, CLOCK_RATE,
+            &tail, &percent)) {
+      gst_buffer_unref (buf);
+      dups++;
+    }
+    while (rtp_jitter_buffer_num_packets (jbuf) > queued) {
+      buf = rtp_jitter_buffer_pop (jbuf, &percent);
+      gst_buffer_unref (buf);
+    }
+  }
+  elapsed = g_timer_elapsed (timer, NULL);
+
+  g_print ("%-20s %8u packets, %6u queued: %8.1f ns/packet (%u rejected)\n",
+      stream_names[type], packets->len, queued,
+      elapsed * 1e9 / packets->len, dups);
+
+  rtp_jitter_buffer_flush (jbuf);
+  g_object_unref (jbuf);
+  g_timer_destroy (timer);
+  g_ptr_array_free (packets, TRUE);
+}
+
+int
+main (int argc, char *argv[])
+{
+  guint queued = 5000, num_packets = 500000;
+  StreamType type;
+
+  gst_init (&argc, &argv);
+
+  if (argc > 1)
+    queued = atoi (argv[1]);
+  if (argc > 2)
+    num_packets = atoi (argv[2]);
+
+  for (type = STREAM_IN_ORDER; type <= STREAM_REORDERED_LOSSY; type++)
+    run_bench (type, queued, num_packets);
+
+  return 0;
+}
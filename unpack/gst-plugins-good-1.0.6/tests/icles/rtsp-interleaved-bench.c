@@ -0,0 +1,249 @@
+/* GStreamer
+ *
+ * rtsp-interleaved-bench.c: measure the packet rate of rtspsrc over TCP
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/* Runs a minimal RTSP server on the loopback interface that answers the
+ * requests of rtspsrc with a single stream in TCP interleaved mode and sends
+ * RTP packets as fast as the connection allows after PLAY, then closes the
+ * connection. Reports the packets per second arriving in the sink.
+ *
+ * Usage: rtsp-interleaved-bench [num-packets] [payload-size]
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <gst/gst.h>
+#include <gio/gio.h>
+
+#define PACKETS_PER_WRITE 64
+
+static guint num_packets = 200000;
+static guint payload_size = 1400;
+
+static guint64 received;
+static GstClockTime first_time = GST_CLOCK_TIME_NONE;
+
+static const gchar *sdp =
+    "v=0\r\n"
+    "o=- 0 0 IN IP4 127.0.0.1\r\n"
+    "s=bench\r\n"
+    "c=IN IP4 127.0.0.1\r\n"
+    "t=0 0\r\n"
+    "m=audio 0 RTP/AVP 96\r\n"
+    "a=rtpmap:96 L16/8000/1\r\n" "a=control:stream=0\r\n";
+
+/* read one request, we only need the method and the CSeq */
+static gboolean
+read_request (GSocket * socket, GString * str, gchar ** method, gint * cseq)
+{
+  gchar buf[1024];
+  gchar *end, *hdr;
+  gssize r;
+
+  while ((end = strstr (str->str, "\r\n\r\n")) == NULL) {
+    r = g_socket_receive (socket, buf, sizeof (buf), NULL, NULL);
+    if (r <= 0)
+      return FALSE;
+    g_string_append_len (str, buf, r);
+  }
+  *end = '\0';
+
+  *method = g_strndup (str->str, strcspn (str->str, " "));
+  *cseq = 0;
+  if ((hdr = strstr (str->str, "CSeq:")) != NULL)
+    *cseq = atoi (hdr + 5);
+
+  g_string_erase (str, 0, end + 4 - str->str);
+
+  return TRUE;
+}
+
+static void
+send_all (GSocket * socket, const gchar * data, gsize size)
+{
+  while (size > 0) {
+    gssize r = g_socket_send (socket, data, size, NULL, NULL);
+
+    if (r <= 0)
+      return;
+    data += r;
+    size -= r;
+  }
+}
+
+static void
+send_response (GSocket * socket, gint cseq, const gchar * headers,
+    const gchar * body)
+{
+  gchar *resp;
+
+  resp = g_strdup_printf ("RTSP/1.0 200 OK\r\nCSeq: %d\r\n%s"
+      "Content-Length: %u\r\n\r\n%s", cseq, headers,
+      (guint) (body ? strlen (body) : 0), body ? body : "");
+  send_all (socket, resp, strlen (resp));
+  g_free (resp);
+}
+
+static void
+stream_packets (GSocket * socket)
+{
+  guint frame_size = 4 + 12 + payload_size;
+  guint8 *data, *p;
+  guint seq = 0, i, n;
+
+  data = g_malloc0 (frame_size * PACKETS_PER_WRITE);
+
+  while (seq < num_packets) {
+    n = MIN (PACKETS_PER_WRITE, num_packets - seq);
+    p = data;
+    for (i = 0; i < n; i++, seq++) {
+      p[0] = '$';
+      p[1] = 0;
+      GST_WRITE_UINT16_BE (p + 2, 12 + payload_size);
+      p[4] = 0x80;
+      p[5] = 96;
+      GST_WRITE_UINT16_BE (p + 6, seq & 0xffff);
+      GST_WRITE_UINT32_BE (p + 8, seq * (payload_size / 2));
+      GST_WRITE_UINT32_BE (p + 12, 0x12345678);
+      p += frame_size;
+    }
+    send_all (socket, (gchar *) data, p - data);
+  }
+  g_free (data);
+}
+
+static gpointer
+server_thread (gpointer user_data)
+{
+  GSocket *listener = user_data;
+  GSocket *socket;
+  GString *str;
+  gchar *method;
+  gint cseq;
+
+  socket = g_socket_accept (listener, NULL, NULL);
+  if (socket == NULL)
+    return NULL;
+
+  str = g_string_new (NULL);
+  while (read_request (socket, str, &method, &cseq)) {
+    if (!strcmp (method, "OPTIONS")) {
+      send_response (socket, cseq,
+          "Public: OPTIONS, DESCRIBE, SETUP, PLAY, TEARDOWN\r\n", NULL);
+    } else if (!strcmp (method, "DESCRIBE")) {
+      send_response (socket, cseq, "Content-Type: application/sdp\r\n", sdp);
+    } else if (!strcmp (method, "SETUP")) {
+      send_response (socket, cseq,
+          "Transport: RTP/AVP/TCP;unicast;interleaved=0-1\r\n"
+          "Session: 12345678\r\n", NULL);
+    } else if (!strcmp (method, "PLAY")) {
+      send_response (socket, cseq, "Session: 12345678\r\n", NULL);
+      stream_packets (socket);
+      g_free (method);
+      break;
+    } else {
+      send_response (socket, cseq, "", NULL);
+    }
+    g_free (method);
+  }
+  g_string_free (str, TRUE);
+
+  /* the client goes EOS when we close the connection */
+  g_socket_close (socket, NULL);
+  g_object_unref (socket);
+
+  return NULL;
+}
+
+static void
+handoff (GstElement * sink, GstBuffer * buffer, GstPad * pad,
+    gpointer user_data)
+{
+  if (received++ == 0)
+    first_time = gst_util_get_timestamp ();
+}
+
+int
+main (int argc, char *argv[])
+{
+  GSocket *listener;
+  GSocketAddress *addr;
+  GInetAddress *iaddr;
+  GThread *thread;
+  GstElement *pipeline, *sink;
+  GstMessage *msg;
+  GstClockTime elapsed;
+  gchar *desc;
+  guint16 port;
+
+  gst_init (&argc, &argv);
+
+  if (argc > 1)
+    num_packets = atoi (argv[1]);
+  if (argc > 2)
+    payload_size = atoi (argv[2]);
+
+  listener = g_socket_new (G_SOCKET_FAMILY_IPV4, G_SOCKET_TYPE_STREAM,
+      G_SOCKET_PROTOCOL_TCP, NULL);
+  iaddr = g_inet_address_new_loopback (G_SOCKET_FAMILY_IPV4);
+  addr = g_inet_socket_address_new (iaddr, 0);
+  g_object_unref (iaddr);
+  if (!g_socket_bind (listener, addr, TRUE, NULL) ||
+      !g_socket_listen (listener, NULL))
+    g_error ("could not listen on the loopback interface");
+  g_object_unref (addr);
+
+  addr = g_socket_get_local_address (listener, NULL);
+  port = g_inet_socket_address_get_port (G_INET_SOCKET_ADDRESS (addr));
+  g_object_unref (addr);
+
+  thread = g_thread_new ("server", server_thread, listener);
+
+  desc = g_strdup_printf ("rtspsrc location=rtsp://127.0.0.1:%u/bench "
+      "protocols=tcp latency=0 ! fakesink name=sink sync=false "
+      "signal-handoffs=true", port);
+  pipeline = gst_parse_launch (desc, NULL);
+  g_free (desc);
+  if (pipeline == NULL)
+    g_error ("could not create the pipeline");
+
+  sink = gst_bin_get_by_name (GST_BIN (pipeline), "sink");
+  g_signal_connect (sink, "handoff", G_CALLBACK (handoff), NULL);
+  gst_object_unref (sink);
+
+  gst_element_set_state (pipeline, GST_STATE_PLAYING);
+  msg = gst_bus_timed_pop_filtered (GST_ELEMENT_BUS (pipeline),
+      GST_CLOCK_TIME_NONE, GST_MESSAGE_EOS | GST_MESSAGE_ERROR);
+  elapsed = gst_util_get_timestamp () - first_time;
+  if (GST_MESSAGE_TYPE (msg) == GST_MESSAGE_ERROR)
+    g_printerr ("got an error before the end of the stream\n");
+  gst_message_unref (msg);
+
+  g_print ("%" G_GUINT64_FORMAT " of %u packets of %u bytes in %.3f s: "
+      "%.0f packets/s\n", received, num_packets, payload_size,
+      (gdouble) elapsed / GST_SECOND,
+      received * (gdouble) GST_SECOND / MAX (elapsed, 1));
+
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+  gst_object_unref (pipeline);
+  g_thread_join (thread);
+  g_object_unref (listener);
+
+  return 0;
+}
@@ -0,0 +1,137 @@
+/* GStreamer
+ *
+ * videomixer-bench.c: measure videomixer with many inputs, with and without
+ * blending threads and damage tracking
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/* Mixes 4, 16 and 64 I420 inputs laid out in a grid into a 1920x1080 frame
+ * and reports output frames/s. One input is a moving ball at 30 frames/s,
+ * the others only change once per second, like the tiles of a video wall or
+ * the thumbnails of a conference call.
+ *
+ * Usage: videomixer-bench [num-frames]
+ */
+
+#include <stdlib.h>
+#include <gst/gst.h>
+
+#define WIDTH 1920
+#define HEIGHT 1080
+
+static guint num_frames = 150;
+
+static const guint grids[] = { 2, 4, 8 };
+
+static const struct
+{
+  const gchar *name;
+  guint n_threads;
+  gboolean damage_tracking;
+} modes[] = {
+  {
+  "1 thread", 1, FALSE}, {
+  "threads", 0, FALSE}, {
+  "damage", 1, TRUE}, {
+  "threads+damage", 0, TRUE}
+};
+
+static gdouble
+run_bench (guint grid, guint mode)
+{
+  GstElement *pipeline;
+  GstMessage *msg;
+  GstBus *bus;
+  GString *desc;
+  GstClockTime start, elapsed;
+  GError *error = NULL;
+  gint width, height;
+  guint i;
+
+  width = GST_ROUND_DOWN_2 (WIDTH / grid);
+  height = GST_ROUND_DOWN_2 (HEIGHT / grid);
+
+  desc = g_string_new (NULL);
+  g_string_append_printf (desc, "videomixer name=mix background=black "
+      "n-threads=%u damage-tracking=%d", modes[mode].n_threads,
+      modes[mode].damage_tracking);
+  for (i = 0; i < grid * grid; i++)
+    g_string_append_printf (desc, " sink_%u::xpos=%d sink_%u::ypos=%d", i,
+        (i % grid) * width, i, (i / grid) * height);
+  g_string_append_printf (desc, " ! video/x-raw,width=%d,height=%d ! "
+      "fakesink sync=false", WIDTH, HEIGHT);
+
+  for (i = 0; i < grid * grid; i++) {
+    if (i == 0)
+      g_string_append_printf (desc, " videotestsrc pattern=ball "
+          "num-buffers=%u ! video/x-raw,format=I420,width=%d,height=%d,"
+          "framerate=30/1 ! mix.sink_0", num_frames, width, height);
+    else
+      g_string_append_printf (desc, " videotestsrc pattern=%u "
+          "num-buffers=%u ! video/x-raw,format=I420,width=%d,height=%d,"
+          "framerate=1/1 ! mix.sink_%u", i % 10, (num_frames + 29) / 30,
+          width, height, i);
+  }
+
+  pipeline = gst_parse_launch (desc->str, &error);
+  if (pipeline == NULL)
+    g_error ("could not make the pipeline: %s", error->message);
+  g_string_free (desc, TRUE);
+
+  start = gst_util_get_timestamp ();
+  gst_element_set_state (pipeline, GST_STATE_PLAYING);
+
+  bus = gst_element_get_bus (pipeline);
+  msg = gst_bus_timed_pop_filtered (bus, GST_CLOCK_TIME_NONE,
+      GST_MESSAGE_EOS | GST_MESSAGE_ERROR);
+  elapsed = gst_util_get_timestamp () - start;
+  if (GST_MESSAGE_TYPE (msg) == GST_MESSAGE_ERROR)
+    g_printerr ("%u inputs %s: error\n", grid * grid, modes[mode].name);
+  gst_message_unref (msg);
+  gst_object_unref (bus);
+
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+  gst_object_unref (pipeline);
+
+  return num_frames * (gdouble) GST_SECOND / MAX (elapsed, 1);
+}
+
+int
+main (int argc, char *argv[])
+{
+  guint i, j;
+
+  gst_init (&argc, &argv);
+
+  if (argc > 1)
+    num_frames = atoi (argv[1]);
+
+  g_print ("%u frames of %dx%d I420, frames/s\n", num_frames, WIDTH, HEIGHT);
+  g_print ("%-10s", "");
+  for (j = 0; j < G_N_ELEMENTS (modes); j++)
+    g_print (" %15s", modes[j].name);
+  g_print ("\n");
+
+  for (i = 0; i < G_N_ELEMENTS (grids); i++) {
+    g_print ("%2u inputs ", grids[i] * grids[i]);
+    for (j = 0; j < G_N_ELEMENTS (modes); j++)
+      g_print (" %15.1f", run_bench (grids[i], j));
+    g_print ("\n");
+  }
+
+  return 0;
+}